@@ -14,7 +14,6 @@
 
 from .interfaces import (
     HandoverAlgorithm,
-    RLHandoverAlgorithm,
     HandoverContext,
     HandoverDecision,
     AlgorithmInfo,
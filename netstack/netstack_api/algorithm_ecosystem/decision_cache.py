@@ -0,0 +1,239 @@
+"""
+🗃️ 量化換手決策緩存
+
+以量化後的上下文作為緩存鍵，讓鄰近、由同一顆衛星服務且信號相近的 UE 共用決策：
+- UE 地理網格 (geo_cell_deg)
+- 服務衛星與其 RSRP / 仰角分桶
+- 前 K 顆候選衛星 (依 RSRP 排序) 的 ID、RSRP 分桶與仰角分桶
+
+容量有上限 (LRU 淘汰)，並以衛星 → 緩存鍵反向索引支援衛星可見性變化時的失效。
+可設定每 N 次命中抽樣重算一次，統計緩存決策與實際決策的一致率。
+命中返回的是副本：決策耗時歸零、建議執行時間順延緩存時長，並移除原請求 UE 專屬的 metadata。
+"""
+
+import logging
+import math
+import time
+from collections import OrderedDict
+from dataclasses import dataclass, replace
+from datetime import timedelta
+from typing import Any, Dict, Hashable, Iterable, List, Optional, Set, Tuple
+
+from .interfaces import GeoCoordinate, HandoverContext, HandoverDecision, SatelliteInfo
+
+logger = logging.getLogger(__name__)
+
+EARTH_RADIUS_KM = 6371.0
+# 屬於原請求 UE 的 metadata，不隨緩存決策交給其他 UE
+PER_UE_METADATA_KEYS = ("ue_id", "request_id")
+
+
+@dataclass
+class DecisionCacheConfig:
+    """量化決策緩存配置"""
+    geo_cell_deg: float = 0.01          # 約 1 km 網格
+    rsrp_bucket_db: float = 3.0
+    elevation_bucket_deg: float = 5.0
+    top_candidates: int = 3
+    max_entries: int = 10000
+    ttl_seconds: float = 60.0
+    validation_interval: int = 0        # 每 N 次命中抽樣重算一次；0 表示不驗證
+
+
+def _bucket(value: Optional[float], size: float) -> Optional[int]:
+    if value is None or size <= 0 or not math.isfinite(value):
+        return None
+    return math.floor(value / size)
+
+
+def _to_ecef(coordinate: GeoCoordinate) -> Tuple[float, float, float]:
+    """球面地球 ECEF (km)，altitude 以米計"""
+    radius = EARTH_RADIUS_KM + (coordinate.altitude or 0.0) / 1000.0
+    lat, lon = math.radians(coordinate.latitude), math.radians(coordinate.longitude)
+    return (radius * math.cos(lat) * math.cos(lon),
+            radius * math.cos(lat) * math.sin(lon),
+            radius * math.sin(lat))
+
+
+def elevation_deg(observer: GeoCoordinate, satellite: GeoCoordinate) -> float:
+    """觀測點看衛星的仰角 (度)"""
+    ox, oy, oz = _to_ecef(observer)
+    sx, sy, sz = _to_ecef(satellite)
+    dx, dy, dz = sx - ox, sy - oy, sz - oz
+    distance = math.sqrt(dx * dx + dy * dy + dz * dz)
+    norm = math.sqrt(ox * ox + oy * oy + oz * oz)
+    if distance == 0 or norm == 0:
+        return 90.0
+    return math.degrees(math.asin(max(-1.0, min(1.0, (dx * ox + dy * oy + dz * oz) / (distance * norm)))))
+
+
+class QuantizedDecisionCache:
+    """量化鍵、容量受限的 LRU 決策緩存"""
+
+    def __init__(self, config: Optional[DecisionCacheConfig] = None):
+        self.config = config or DecisionCacheConfig()
+        self._entries: "OrderedDict[Hashable, Tuple[HandoverDecision, float, Tuple[str, ...]]]" = OrderedDict()
+        self._by_satellite: Dict[str, Set[Hashable]] = {}
+        self._visible_satellites: Optional[Set[str]] = None
+        self._stats = {
+            "hits": 0, "misses": 0, "insertions": 0, "evictions": 0,
+            "expirations": 0, "invalidations": 0, "validated": 0, "agreements": 0
+        }
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    # === 鍵 ===
+
+    def key_for(self, context: HandoverContext) -> Hashable:
+        """量化上下文 → 緩存鍵"""
+        cfg = self.config
+        location = context.ue_location
+        geo_cell = (math.floor(location.latitude / cfg.geo_cell_deg),
+                    math.floor(location.longitude / cfg.geo_cell_deg))
+
+        serving_rsrp = context.current_signal_metrics.rsrp if context.current_signal_metrics else None
+        serving_info = next((sat for sat in context.candidate_satellites
+                             if sat.satellite_id == context.current_satellite), None)
+        serving_elevation = elevation_deg(location, serving_info.position) if serving_info else None
+
+        candidates = sorted(
+            (sat for sat in context.candidate_satellites if sat.satellite_id != context.current_satellite),
+            key=lambda sat: sat.signal_metrics.rsrp if sat.signal_metrics else -math.inf,
+            reverse=True
+        )[:cfg.top_candidates]
+
+        return (
+            geo_cell,
+            context.current_satellite,
+            _bucket(serving_rsrp, cfg.rsrp_bucket_db),
+            _bucket(serving_elevation, cfg.elevation_bucket_deg),
+            tuple(
+                (sat.satellite_id,
+                 _bucket(sat.signal_metrics.rsrp if sat.signal_metrics else None, cfg.rsrp_bucket_db),
+                 _bucket(elevation_deg(location, sat.position), cfg.elevation_bucket_deg))
+                for sat in candidates
+            )
+        )
+
+    @staticmethod
+    def _satellites_of(key: Hashable, decision: HandoverDecision) -> Tuple[str, ...]:
+        _, serving, _, _, candidates = key
+        satellites = {sat_id for sat_id, _, _ in candidates}
+        if serving:
+            satellites.add(serving)
+        if decision.target_satellite:
+            satellites.add(decision.target_satellite)
+        return tuple(satellites)
+
+    # === 讀寫 ===
+
+    def get(self, context: HandoverContext, key: Optional[Hashable] = None) -> Optional[HandoverDecision]:
+        key = self.key_for(context) if key is None else key
+        entry = self._entries.get(key)
+        if entry is None:
+            self._stats["misses"] += 1
+            return None
+
+        decision, stored_at, _ = entry
+        if time.monotonic() - stored_at >= self.config.ttl_seconds:
+            self._remove(key)
+            self._stats["expirations"] += 1
+            self._stats["misses"] += 1
+            return None
+
+        self._entries.move_to_end(key)
+        self._stats["hits"] += 1
+        return self._copy_for_hit(decision, time.monotonic() - stored_at)
+
+    @staticmethod
+    def _copy_for_hit(decision: HandoverDecision, age_seconds: float) -> HandoverDecision:
+        metadata = {k: v for k, v in decision.metadata.items() if k not in PER_UE_METADATA_KEYS}
+        metadata["cache_hit"] = True
+        metadata["cache_age_seconds"] = age_seconds
+        return replace(
+            decision,
+            timing=decision.timing + timedelta(seconds=age_seconds) if decision.timing else None,
+            decision_time=0.0,
+            metadata=metadata,
+        )
+
+    def put(self, context: HandoverContext, decision: HandoverDecision, key: Optional[Hashable] = None) -> None:
+        key = self.key_for(context) if key is None else key
+        if key in self._entries:
+            self._remove(key)
+
+        satellites = self._satellites_of(key, decision)
+        # 已不可見的衛星不寫入
+        if self._visible_satellites is not None and not self._visible_satellites.issuperset(
+                s for s in satellites if s):
+            return
+
+        # 與呼叫端持有的決策物件脫鉤
+        self._entries[key] = (replace(decision, metadata=dict(decision.metadata)), time.monotonic(), satellites)
+        for sat_id in satellites:
+            self._by_satellite.setdefault(sat_id, set()).add(key)
+        self._stats["insertions"] += 1
+
+        while len(self._entries) > self.config.max_entries:
+            oldest = next(iter(self._entries))
+            self._remove(oldest)
+            self._stats["evictions"] += 1
+
+    def _remove(self, key: Hashable) -> None:
+        _, _, satellites = self._entries.pop(key)
+        for sat_id in satellites:
+            keys = self._by_satellite.get(sat_id)
+            if keys is not None:
+                keys.discard(key)
+                if not keys:
+                    del self._by_satellite[sat_id]
+
+    def clear(self) -> None:
+        self._entries.clear()
+        self._by_satellite.clear()
+
+    # === 失效 ===
+
+    def invalidate_satellite(self, satellite_id: str) -> int:
+        """移除所有涉及該衛星 (服務、候選或目標) 的緩存決策"""
+        keys = list(self._by_satellite.get(satellite_id, ()))
+        for key in keys:
+            self._remove(key)
+        self._stats["invalidations"] += len(keys)
+        return len(keys)
+
+    def update_visible_satellites(self, visible_satellite_ids: Iterable[str]) -> int:
+        """更新可見衛星集合，離開可見範圍的衛星相關決策全部失效"""
+        visible = set(visible_satellite_ids)
+        previous = self._visible_satellites
+        self._visible_satellites = visible
+
+        stale = (previous - visible) if previous is not None else set(self._by_satellite) - visible
+        removed = sum(self.invalidate_satellite(sat_id) for sat_id in stale)
+        if removed:
+            logger.debug(f"衛星可見性變化，失效 {removed} 筆緩存決策 ({len(stale)} 顆衛星)")
+        return removed
+
+    # === 品質驗證 ===
+
+    def should_validate(self) -> bool:
+        """命中時是否抽樣重算 (每 validation_interval 次命中一次)"""
+        interval = self.config.validation_interval
+        return interval > 0 and self._stats["hits"] % interval == 0
+
+    def record_validation(self, cached: HandoverDecision, fresh: HandoverDecision) -> bool:
+        """比較緩存決策與重算決策 (決策類型與目標衛星)"""
+        agreed = (cached.handover_decision == fresh.handover_decision
+                  and cached.target_satellite == fresh.target_satellite)
+        self._stats["validated"] += 1
+        self._stats["agreements"] += int(agreed)
+        return agreed
+
+    def get_stats(self) -> Dict[str, Any]:
+        stats = dict(self._stats)
+        lookups = stats["hits"] + stats["misses"]
+        stats["entries"] = len(self._entries)
+        stats["hit_rate"] = stats["hits"] / lookups if lookups else 0.0
+        stats["agreement_rate"] = stats["agreements"] / stats["validated"] if stats["validated"] else None
+        return stats
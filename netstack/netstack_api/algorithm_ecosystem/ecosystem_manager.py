@@ -600,7 +600,7 @@ class AlgorithmEcosystemManager:
             await self.algorithm_registry.cleanup()
 
         if self.environment_manager:
-            self.environment_manager.cleanup()
+            await self.environment_manager.cleanup()
 
         if self.training_pipeline:
             self.training_pipeline.cleanup()
@@ -0,0 +1,49 @@
+"""
+🌍 環境管理器
+
+Gymnasium 訓練環境已隨 RL 功能移除，本管理器只保留生態系統需要的
+環境配置與生命週期 (初始化、統計、清理)，供協調器與 API 共用。
+"""
+
+import logging
+from datetime import datetime
+from typing import Any, Dict, Optional
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_ENVIRONMENT_CONFIG: Dict[str, Any] = {
+    "env_name": "LEOSatelliteHandoverEnv-v1",
+    "max_episode_steps": 1000,
+}
+
+
+class EnvironmentManager:
+    """換手研究環境配置管理"""
+
+    def __init__(self, config: Optional[Dict[str, Any]] = None):
+        self.config = {**DEFAULT_ENVIRONMENT_CONFIG, **(config or {})}
+        self._initialized = False
+        self._initialized_at: Optional[datetime] = None
+
+    async def initialize(self, config: Optional[Dict[str, Any]] = None) -> None:
+        if config:
+            self.config.update(config)
+        self._initialized = True
+        self._initialized_at = datetime.now()
+        logger.info(f"環境管理器初始化完成: {self.config['env_name']}")
+
+    @property
+    def is_initialized(self) -> bool:
+        return self._initialized
+
+    def get_stats(self) -> Dict[str, Any]:
+        return {
+            "initialized": self._initialized,
+            "initialized_at": self._initialized_at.isoformat() if self._initialized_at else None,
+            "config": dict(self.config),
+            "gymnasium_available": False,
+        }
+
+    async def cleanup(self) -> None:
+        self._initialized = False
+        logger.info("環境管理器已清理")
@@ -4,6 +4,7 @@
 定義換手算法生態系統的核心接口和數據結構。
 """
 
+import asyncio
 from abc import ABC, abstractmethod
 from dataclasses import dataclass
 from datetime import datetime
@@ -141,6 +142,19 @@ class HandoverAlgorithm(ABC):
         """
         pass
     
+    async def predict_handover_batch(self, contexts: List[HandoverContext]) -> List[HandoverDecision]:
+        """批次換手預測 - 子類可重寫為向量化實作
+        
+        預設併發呼叫 predict_handover，結果順序與輸入一致。
+        
+        Args:
+            contexts: 換手決策上下文列表
+            
+        Returns:
+            List[HandoverDecision]: 與 contexts 一一對應的決策結果
+        """
+        return list(await asyncio.gather(*(self.predict_handover(context) for context in contexts)))
+    
     @abstractmethod
     def get_algorithm_info(self) -> AlgorithmInfo:
         """獲取算法信息
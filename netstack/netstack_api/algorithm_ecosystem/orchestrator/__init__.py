@@ -0,0 +1,18 @@
+"""
+🎭 換手協調器套件
+
+- config: 協調模式、決策策略與協調器配置
+- handover_orchestrator: 協調器主體與微批次收集器
+- algorithm_selection / performance_monitoring / ab_testing / ensemble_voting: 協調器委派的專門模組
+"""
+
+from .config import DecisionStrategy, OrchestratorConfig, OrchestratorMode
+from .handover_orchestrator import DecisionMicroBatcher, HandoverOrchestrator
+
+__all__ = [
+    "DecisionMicroBatcher",
+    "DecisionStrategy",
+    "HandoverOrchestrator",
+    "OrchestratorConfig",
+    "OrchestratorMode",
+]
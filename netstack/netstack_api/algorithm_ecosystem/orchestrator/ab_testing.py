@@ -0,0 +1,90 @@
+"""
+🧪 A/B 測試管理
+
+依流量分配比例把 UE 穩定地分派給測試中的算法 (同一 UE 永遠落在同一組)，
+並按測試與算法彙總決策結果。
+"""
+
+import hashlib
+import logging
+from collections import defaultdict
+from datetime import datetime
+from typing import Any, Dict, Optional
+
+from ..interfaces import HandoverContext, HandoverDecision, HandoverDecisionType
+
+logger = logging.getLogger(__name__)
+
+
+class ABTestManager:
+    """A/B 測試流量分配與結果統計"""
+
+    def __init__(self):
+        self._tests: Dict[str, Dict[str, float]] = {}
+        self._started_at: Dict[str, datetime] = {}
+        self._results: Dict[str, Dict[str, Dict[str, float]]] = {}
+        self._active_test: Optional[str] = None
+
+    async def initialize_ab_testing(self, ab_test_config: Dict[str, Any]) -> None:
+        """以配置啟動測試：{"test_id": ..., "traffic_split": {算法: 比例}}"""
+        traffic_split = ab_test_config.get("traffic_split")
+        if traffic_split:
+            self.set_ab_test_config(ab_test_config.get("test_id", "default"), traffic_split)
+
+    def set_ab_test_config(self, test_id: str, traffic_split: Dict[str, float]) -> None:
+        total = sum(weight for weight in traffic_split.values() if weight > 0)
+        if total <= 0:
+            raise ValueError(f"A/B 測試 '{test_id}' 的流量分配必須有正值")
+        self._tests[test_id] = {name: weight / total for name, weight in traffic_split.items() if weight > 0}
+        self._started_at[test_id] = datetime.now()
+        self._results.setdefault(test_id, defaultdict(lambda: {
+            "decisions": 0, "handovers": 0, "total_confidence": 0.0
+        }))
+        self._active_test = test_id
+        logger.info(f"A/B 測試 '{test_id}' 流量分配: {self._tests[test_id]}")
+
+    def clear_ab_test_config(self, test_id: str) -> None:
+        self._tests.pop(test_id, None)
+        if self._active_test == test_id:
+            self._active_test = next(reversed(self._tests), None) if self._tests else None
+
+    def select_algorithm(self, context: HandoverContext) -> Optional[str]:
+        """依 UE ID 雜湊落點選擇目前測試的算法；無進行中的測試時返回 None"""
+        split = self._tests.get(self._active_test) if self._active_test else None
+        if not split:
+            return None
+        digest = hashlib.md5(context.ue_id.encode()).digest()
+        point = int.from_bytes(digest[:8], "big") / 2 ** 64
+        cumulative = 0.0
+        for name, share in split.items():
+            cumulative += share
+            if point < cumulative:
+                return name
+        return name
+
+    async def record_ab_test_result(self, algorithm_name: str, decision: HandoverDecision) -> None:
+        if self._active_test is None or algorithm_name not in self._tests.get(self._active_test, {}):
+            return
+        result = self._results[self._active_test][algorithm_name]
+        result["decisions"] += 1
+        result["handovers"] += int(decision.handover_decision != HandoverDecisionType.NO_HANDOVER)
+        result["total_confidence"] += decision.confidence
+
+    def get_ab_test_performance(self, test_id: str) -> Dict[str, Any]:
+        if test_id not in self._results:
+            return {"test_id": test_id, "error": "test not found"}
+        return {
+            "test_id": test_id,
+            "active": test_id in self._tests,
+            "traffic_split": self._tests.get(test_id, {}),
+            "started_at": self._started_at[test_id].isoformat(),
+            "algorithms": {
+                name: {
+                    "decisions": result["decisions"],
+                    "handover_rate": result["handovers"] / result["decisions"] if result["decisions"] else 0.0,
+                    "average_confidence": result["total_confidence"] / result["decisions"]
+                    if result["decisions"] else 0.0,
+                }
+                for name, result in self._results[test_id].items()
+            },
+        }
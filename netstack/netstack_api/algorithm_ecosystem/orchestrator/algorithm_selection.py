@@ -0,0 +1,90 @@
+"""
+🎯 算法選擇
+
+依協調模式與決策策略，從註冊中心的已啟用算法中選出本次決策使用的算法。
+"""
+
+import itertools
+import logging
+import random
+from typing import Dict, List, Optional, Tuple
+
+from ..interfaces import HandoverAlgorithm, HandoverContext
+from ..registry import AlgorithmRegistry
+from .ab_testing import ABTestManager
+from .config import DecisionStrategy, OrchestratorMode
+from .performance_monitoring import AlgorithmMetrics
+
+logger = logging.getLogger(__name__)
+
+# 性能策略至少需要的樣本數，不足時以優先級排序
+MIN_PERFORMANCE_SAMPLES = 10
+
+
+class AlgorithmSelector:
+    """協調器的算法選擇器"""
+
+    def __init__(self, algorithm_registry: AlgorithmRegistry,
+                 algorithm_metrics: Dict[str, AlgorithmMetrics],
+                 ab_test_manager: Optional[ABTestManager] = None,
+                 failover_algorithm: Optional[str] = None):
+        self.algorithm_registry = algorithm_registry
+        self._algorithm_metrics = algorithm_metrics
+        self._ab_test_manager = ab_test_manager
+        self.failover_algorithm = failover_algorithm
+        self._round_robin = itertools.count()
+
+    async def select_algorithm(self, context: HandoverContext, mode: OrchestratorMode,
+                               strategy: DecisionStrategy,
+                               default_algorithm: Optional[str] = None
+                               ) -> Tuple[Optional[HandoverAlgorithm], Optional[str]]:
+        """返回 (算法實例, 註冊名稱)；無可用算法時返回 (None, None)"""
+        name = None
+        if mode == OrchestratorMode.A_B_TESTING and self._ab_test_manager is not None:
+            name = self._ab_test_manager.select_algorithm(context)
+        elif mode in (OrchestratorMode.SINGLE_ALGORITHM, OrchestratorMode.MANUAL):
+            name = default_algorithm
+        else:
+            name = self._select_by_strategy(strategy)
+
+        for candidate in (name, default_algorithm, self.failover_algorithm):
+            if candidate and candidate in self.algorithm_registry.list_enabled_algorithms():
+                return self.algorithm_registry.get_algorithm(candidate), candidate
+
+        name = self._select_by_priority(self.algorithm_registry.list_enabled_algorithms())
+        if name is None:
+            return None, None
+        return self.algorithm_registry.get_algorithm(name), name
+
+    def _select_by_strategy(self, strategy: DecisionStrategy) -> Optional[str]:
+        enabled = sorted(self.algorithm_registry.list_enabled_algorithms())
+        if not enabled:
+            return None
+        if strategy == DecisionStrategy.ROUND_ROBIN:
+            return enabled[next(self._round_robin) % len(enabled)]
+        if strategy in (DecisionStrategy.PERFORMANCE_BASED, DecisionStrategy.ADAPTIVE):
+            return self._select_by_performance(enabled)
+        if strategy in (DecisionStrategy.WEIGHTED_AVERAGE, DecisionStrategy.ENSEMBLE_VOTING):
+            weights = [0.1 + self._score(name) for name in enabled]
+            return random.choices(enabled, weights=weights)[0]
+        return self._select_by_priority(enabled)
+
+    def _select_by_priority(self, names: List[str]) -> Optional[str]:
+        if not names:
+            return None
+        return max(names, key=self.algorithm_registry.get_algorithm_priority)
+
+    def _select_by_performance(self, names: List[str]) -> Optional[str]:
+        measured = [name for name in names
+                    if name in self._algorithm_metrics
+                    and self._algorithm_metrics[name].total_requests >= MIN_PERFORMANCE_SAMPLES]
+        if not measured:
+            return self._select_by_priority(names)
+        return max(measured, key=self._score)
+
+    def _score(self, name: str) -> float:
+        """成功率 × 平均信心度，按平均耗時 (每 100 ms) 折減"""
+        metrics = self._algorithm_metrics.get(name)
+        if metrics is None or metrics.total_requests == 0:
+            return 0.0
+        return metrics.success_rate * metrics.average_confidence / (1.0 + metrics.average_response_time_ms / 100.0)
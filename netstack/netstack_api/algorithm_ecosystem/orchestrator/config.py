@@ -0,0 +1,64 @@
+"""
+⚙️ 協調器配置
+
+協調模式、決策策略與協調器配置。枚舉同時繼承 str，
+API 請求與配置檔中的字串值可直接與枚舉比較。
+"""
+
+from dataclasses import dataclass
+from enum import Enum
+from typing import Dict, Optional
+
+
+class OrchestratorMode(str, Enum):
+    """協調模式"""
+    SINGLE_ALGORITHM = "single_algorithm"   # 固定使用預設算法
+    MANUAL = "manual"                       # 同 SINGLE_ALGORITHM，由呼叫端指定算法
+    AUTOMATIC = "automatic"                 # 依決策策略自動選擇
+    HYBRID = "hybrid"
+    LEARNING = "learning"
+    A_B_TESTING = "ab_testing"              # 依 A/B 測試流量分配選擇
+    ENSEMBLE = "ensemble"                   # 多算法集成投票
+
+
+class DecisionStrategy(str, Enum):
+    """自動模式下的算法選擇策略"""
+    PRIORITY_BASED = "priority_based"
+    PERFORMANCE_BASED = "performance_based"
+    ROUND_ROBIN = "round_robin"
+    WEIGHTED_AVERAGE = "weighted_average"
+    ENSEMBLE_VOTING = "ensemble_voting"
+    ADAPTIVE = "adaptive"
+
+
+@dataclass
+class OrchestratorConfig:
+    """協調器配置"""
+    mode: OrchestratorMode = OrchestratorMode.SINGLE_ALGORITHM
+    decision_strategy: DecisionStrategy = DecisionStrategy.PRIORITY_BASED
+    default_algorithm: Optional[str] = None
+    enable_caching: bool = True
+    cache_ttl_seconds: int = 60
+    decision_cache_config: Optional[Dict] = None
+    max_concurrent_requests: int = 100
+    ab_test_config: Optional[Dict] = None
+    ensemble_config: Optional[Dict] = None
+    enable_micro_batching: bool = False
+    batch_window_ms: float = 1.0
+    max_batch_size: int = 256
+    # 生態系統管理器配置檔欄位
+    failover_algorithm: Optional[str] = None
+    monitoring_enabled: bool = True
+    monitoring_interval: float = 5.0
+    performance_window: int = 100
+    ab_testing_enabled: bool = False
+    ensemble_enabled: bool = False
+    learning_enabled: bool = False
+    failover_enabled: bool = True
+    failover_threshold: float = 0.3
+    logging_level: str = "INFO"
+    metrics_collection_enabled: bool = True
+
+    def __post_init__(self):
+        self.mode = OrchestratorMode(self.mode)
+        self.decision_strategy = DecisionStrategy(self.decision_strategy)
@@ -0,0 +1,78 @@
+"""
+🗳️ 集成投票
+
+多個成員算法對同一請求的決策，以信心度 × 權重投票選出決策類型，
+再取該類型中加權信心度最高的成員決策。未設定權重的成員以其歷史成功率為權重。
+"""
+
+import logging
+from collections import defaultdict
+from dataclasses import replace
+from typing import Any, Dict, Optional
+
+from ..interfaces import HandoverContext, HandoverDecision, HandoverDecisionType
+from .performance_monitoring import AlgorithmMetrics
+
+logger = logging.getLogger(__name__)
+
+
+class EnsembleVotingManager:
+    """集成投票與集成統計"""
+
+    def __init__(self, algorithm_metrics: Dict[str, AlgorithmMetrics]):
+        self._algorithm_metrics = algorithm_metrics
+        self._stats = {"votes": 0, "unanimous": 0}
+
+    async def initialize_ensemble(self) -> None:
+        """重置集成統計"""
+        self._stats = {"votes": 0, "unanimous": 0}
+
+    def member_weight(self, algorithm_name: str, weights: Dict[str, float]) -> float:
+        if algorithm_name in weights:
+            return weights[algorithm_name]
+        metrics = self._algorithm_metrics.get(algorithm_name)
+        return metrics.success_rate if metrics is not None and metrics.total_requests else 1.0
+
+    def vote(self, member_decisions: Dict[str, HandoverDecision],
+             weights: Optional[Dict[str, float]] = None) -> Optional[HandoverDecision]:
+        """信心度加權投票，返回的決策 algorithm_name 為 "ensemble" 並附投票明細"""
+        if not member_decisions:
+            return None
+        weights = weights or {}
+
+        votes: Dict[HandoverDecisionType, float] = defaultdict(float)
+        for name, decision in member_decisions.items():
+            votes[decision.handover_decision] += self.member_weight(name, weights) * decision.confidence
+
+        winner = max(votes, key=votes.get)
+        best_name, best = max(
+            ((name, d) for name, d in member_decisions.items() if d.handover_decision == winner),
+            key=lambda item: self.member_weight(item[0], weights) * item[1].confidence
+        )
+        total = sum(votes.values())
+        self._stats["votes"] += 1
+        self._stats["unanimous"] += int(len(votes) == 1)
+        return replace(
+            best,
+            confidence=votes[winner] / total if total > 0 else best.confidence,
+            algorithm_name="ensemble",
+            metadata={
+                **best.metadata,
+                "ensemble_source": best_name,
+                "ensemble_votes": {name: d.handover_decision.name for name, d in member_decisions.items()}
+            }
+        )
+
+    async def handle_ensemble_decision(self, context: HandoverContext, decision: HandoverDecision,
+                                       algorithm_name: str,
+                                       ensemble_config: Optional[Dict[str, Any]]) -> HandoverDecision:
+        """未設定成員時無從投票：保留原決策與信心度，只標記集成來源"""
+        return replace(
+            decision,
+            algorithm_name="ensemble",
+            metadata={**decision.metadata, "ensemble_source": algorithm_name,
+                      "ensemble_votes": {algorithm_name: decision.handover_decision.name}}
+        )
+
+    def get_stats(self) -> Dict[str, Any]:
+        return dict(self._stats)
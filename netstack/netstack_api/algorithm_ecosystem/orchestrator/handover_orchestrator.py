@@ -0,0 +1,595 @@
+"""
+🎭 換手協調器 - 重構後的簡化版本
+
+算法生態系統的主控制器，負責協調多個算法的執行。
+重構後職責專注於協調，具體功能委派給專門模組。
+"""
+
+import asyncio
+import logging
+import time
+from typing import Dict, List, Optional, Any, Tuple, Callable, Awaitable
+from dataclasses import dataclass, field
+from collections import defaultdict
+
+from ..interfaces import (
+    HandoverAlgorithm,
+    HandoverContext,
+    HandoverDecision,
+    HandoverDecisionType
+)
+from ..registry import AlgorithmRegistry
+from ..decision_cache import QuantizedDecisionCache, DecisionCacheConfig
+from ..environment_manager import EnvironmentManager
+
+# 導入重構後的模組
+from .config import OrchestratorConfig, OrchestratorMode
+from .algorithm_selection import AlgorithmSelector
+from .performance_monitoring import PerformanceMonitor
+from .ab_testing import ABTestManager
+from .ensemble_voting import EnsembleVotingManager
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class _PendingDecision:
+    """等待批次處理的請求"""
+    context: HandoverContext
+    algorithm_name: Optional[str]
+    use_cache: bool
+    future: Optional[asyncio.Future] = field(default=None, repr=False)  # 僅微批次路徑需要
+
+
+class DecisionMicroBatcher:
+    """微批次收集器
+    
+    將 batch_window_ms 內到達的請求合併為一批交給處理函數，
+    批次達到 max_batch_size 時立即送出。每個請求以 Future 取回自己的結果。
+    """
+    
+    def __init__(self, handler: Callable[[List[_PendingDecision]], Awaitable[List[HandoverDecision]]],
+                 window_ms: float = 1.0, max_batch_size: int = 256):
+        self._handler = handler
+        self.window_seconds = max(0.0, window_ms) / 1000.0
+        self.max_batch_size = max(1, max_batch_size)
+        self._pending: List[_PendingDecision] = []
+        self._flush_handle: Optional[asyncio.TimerHandle] = None
+        self._running: set = set()
+        self._stats = {"batches": 0, "decisions": 0, "max_batch_size": 0}
+    
+    async def submit(self, context: HandoverContext, algorithm_name: Optional[str],
+                     use_cache: bool) -> HandoverDecision:
+        """加入批次並等待結果"""
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+        self._pending.append(_PendingDecision(context, algorithm_name, use_cache, future))
+        
+        if len(self._pending) >= self.max_batch_size:
+            self._flush()
+        elif self._flush_handle is None:
+            self._flush_handle = loop.call_later(self.window_seconds, self._flush)
+        
+        return await future
+    
+    def _flush(self) -> None:
+        if self._flush_handle is not None:
+            self._flush_handle.cancel()
+            self._flush_handle = None
+        
+        batch, self._pending = self._pending, []
+        if not batch:
+            return
+        
+        self._stats["batches"] += 1
+        self._stats["decisions"] += len(batch)
+        self._stats["max_batch_size"] = max(self._stats["max_batch_size"], len(batch))
+        
+        task = asyncio.ensure_future(self._run(batch))
+        self._running.add(task)
+        task.add_done_callback(self._running.discard)
+    
+    async def _run(self, batch: List[_PendingDecision]) -> None:
+        try:
+            decisions = await self._handler(batch)
+        except Exception as e:
+            for pending in batch:
+                if pending.future is not None and not pending.future.done():
+                    pending.future.set_exception(e)
+            return
+        
+        for pending, decision in zip(batch, decisions):
+            if pending.future is not None and not pending.future.done():  # 呼叫端可能已取消
+                pending.future.set_result(decision)
+    
+    async def drain(self) -> None:
+        """送出剩餘請求並等待所有批次完成"""
+        self._flush()
+        if self._running:
+            await asyncio.gather(*list(self._running), return_exceptions=True)
+    
+    def get_stats(self) -> Dict[str, Any]:
+        stats = dict(self._stats)
+        stats["average_batch_size"] = stats["decisions"] / stats["batches"] if stats["batches"] else 0.0
+        stats["pending"] = len(self._pending)
+        return stats
+
+
+class HandoverOrchestrator:
+    """換手協調器 - 重構後的簡化版本
+    
+    主要職責：
+    1. 協調各個專門模組
+    2. 管理請求流程
+    3. 提供統一的API接口
+    """
+    
+    def __init__(self, algorithm_registry: AlgorithmRegistry, 
+                 environment_manager: EnvironmentManager, 
+                 config: OrchestratorConfig):
+        self.algorithm_registry = algorithm_registry
+        self.environment_manager = environment_manager
+        self.config = config
+        
+        # 初始化專門模組
+        self._performance_monitor = PerformanceMonitor(config.performance_window)
+        self._ab_test_manager = ABTestManager()
+        self._algorithm_selector = AlgorithmSelector(
+            algorithm_registry, 
+            self._performance_monitor._algorithm_metrics,
+            self._ab_test_manager,
+            config.failover_algorithm
+        )
+        self._ensemble_voting_manager = EnsembleVotingManager(
+            self._performance_monitor._algorithm_metrics
+        )
+        
+        # 決策緩存 (量化上下文鍵、LRU 容量上限)
+        self._decision_cache = self._create_decision_cache(config)
+        
+        # 併發控制
+        self._concurrent_requests = 0
+        self._request_semaphore = asyncio.Semaphore(config.max_concurrent_requests)
+        
+        # 微批次前端
+        self._micro_batcher = self._create_micro_batcher(config)
+        
+        # 批次路徑的逐決策彙總 (監控器每批只寫入一次)
+        self._batch_metrics: Dict[str, Dict[str, float]] = defaultdict(
+            lambda: {"batches": 0, "decisions": 0, "successes": 0, "total_confidence": 0.0, "total_time_ms": 0.0}
+        )
+        
+        # 初始化狀態
+        self._initialized = False
+
+    async def initialize(self) -> None:
+        """初始化協調器"""
+        try:
+            # 初始化專門模組
+            if self.config.ab_test_config:
+                await self._ab_test_manager.initialize_ab_testing(self.config.ab_test_config)
+            
+            if self.config.ensemble_config:
+                await self._ensemble_voting_manager.initialize_ensemble()
+            
+            self._initialized = True
+            logger.info("HandoverOrchestrator 初始化完成")
+            
+        except Exception as e:
+            logger.error(f"HandoverOrchestrator 初始化失敗: {e}")
+            raise
+
+    async def predict_handover(self, context: HandoverContext, 
+                             algorithm_name: Optional[str] = None, 
+                             use_cache: bool = None) -> Optional[HandoverDecision]:
+        """預測換手決策 - 主要協調方法"""
+        if use_cache is None:
+            use_cache = self.config.enable_caching
+        
+        # 微批次：命中緩存直接返回，其餘交由批次處理
+        if self._micro_batcher is not None:
+            cached_decision = self._get_cached_decision(context) if use_cache else None
+            if cached_decision and not self._decision_cache.should_validate():
+                return cached_decision
+            decision = await self._micro_batcher.submit(context, algorithm_name, use_cache)
+            if cached_decision:
+                self._decision_cache.record_validation(cached_decision, decision)
+            return decision
+        
+        # 併發控制
+        async with self._request_semaphore:
+            self._concurrent_requests += 1
+            
+            try:
+                start_time = time.time()
+                
+                # 檢查緩存 (抽樣驗證時仍重算並比對)
+                cached_decision = self._get_cached_decision(context) if use_cache else None
+                if cached_decision and not self._decision_cache.should_validate():
+                    return cached_decision
+
+                # 已設定成員的集成模式與批次路徑相同：全部成員投票
+                ensemble_members = (self.config.ensemble_config or {}).get("algorithms") \
+                    if self.config.mode == OrchestratorMode.ENSEMBLE and not algorithm_name else None
+                if ensemble_members:
+                    decision = (await self._run_ensemble_batch(ensemble_members, [context]))[0]
+                    if decision is None:
+                        return self._get_fallback_decision(context)
+                    if cached_decision:
+                        self._decision_cache.record_validation(cached_decision, decision)
+                    if use_cache:
+                        self._cache_decision(context, decision)
+                    return decision
+
+                # 選擇算法
+                if not algorithm_name:
+                    algorithm, selected_algorithm_name = await self._algorithm_selector.select_algorithm(
+                        context, self.config.mode, self.config.decision_strategy, self.config.default_algorithm
+                    )
+                else:
+                    algorithm = self.algorithm_registry.get_algorithm(algorithm_name)
+                    selected_algorithm_name = algorithm_name
+                
+                if not algorithm:
+                    return self._get_fallback_decision(context)
+                
+                # 執行算法
+                try:
+                    decision = await algorithm.predict_handover(context)
+                    execution_time = (time.time() - start_time) * 1000
+                    
+                    # 記錄性能指標
+                    await self._performance_monitor.record_algorithm_metrics(
+                        selected_algorithm_name, execution_time, True, decision.confidence
+                    )
+                    
+                    # 處理A/B測試
+                    if self.config.mode == OrchestratorMode.A_B_TESTING:
+                        await self._ab_test_manager.record_ab_test_result(selected_algorithm_name, decision)
+                    
+                    # 處理集成投票
+                    if self.config.mode == OrchestratorMode.ENSEMBLE:
+                        decision = await self._ensemble_voting_manager.handle_ensemble_decision(
+                            context, decision, selected_algorithm_name, self.config.ensemble_config
+                        )
+                    
+                    # 緩存決策
+                    if cached_decision:
+                        self._decision_cache.record_validation(cached_decision, decision)
+                    if use_cache:
+                        self._cache_decision(context, decision)
+                    
+                    return decision
+                    
+                except Exception as e:
+                    execution_time = (time.time() - start_time) * 1000
+                    await self._performance_monitor.record_algorithm_metrics(
+                        selected_algorithm_name, execution_time, False, 0.0
+                    )
+                    logger.error(f"算法執行失敗 {selected_algorithm_name}: {e}")
+                    return self._get_fallback_decision(context)
+                    
+            except Exception as e:
+                logger.error(f"預測換手決策失敗: {e}")
+                return self._get_fallback_decision(context)
+                
+            finally:
+                self._concurrent_requests -= 1
+
+    async def predict_handover_batch(self, contexts: List[HandoverContext],
+                                   algorithm_name: Optional[str] = None,
+                                   use_cache: bool = None) -> List[HandoverDecision]:
+        """批次預測換手決策，結果順序與 contexts 一致"""
+        if use_cache is None:
+            use_cache = self.config.enable_caching
+        
+        decisions: List[Optional[HandoverDecision]] = [None] * len(contexts)
+        validations: Dict[int, HandoverDecision] = {}
+        pending = []
+        for i, context in enumerate(contexts):
+            cached_decision = self._get_cached_decision(context) if use_cache else None
+            if cached_decision and not self._decision_cache.should_validate():
+                decisions[i] = cached_decision
+                continue
+            if cached_decision:
+                validations[i] = cached_decision
+            pending.append((i, _PendingDecision(context, algorithm_name, use_cache)))
+        
+        if pending:
+            batch_decisions = await self._process_decision_batch([p for _, p in pending])
+            for (i, _), decision in zip(pending, batch_decisions):
+                decisions[i] = decision
+                if i in validations:
+                    self._decision_cache.record_validation(validations[i], decision)
+        
+        return decisions
+    
+    async def _process_decision_batch(self, batch: List[_PendingDecision]) -> List[HandoverDecision]:
+        """批次處理：算法選擇、按算法分組批次推論、批量記錄指標與緩存"""
+        async with self._request_semaphore:
+            self._concurrent_requests += len(batch)
+            decisions: List[Optional[HandoverDecision]] = [None] * len(batch)
+            
+            try:
+                # 選擇算法 (未指定算法的請求併發選擇)
+                groups: Dict[str, Tuple[Any, List[int]]] = {}
+                unselected = [i for i, p in enumerate(batch) if not p.algorithm_name]
+                selections = await asyncio.gather(*(
+                    self._algorithm_selector.select_algorithm(
+                        batch[i].context, self.config.mode, self.config.decision_strategy,
+                        self.config.default_algorithm
+                    )
+                    for i in unselected
+                ), return_exceptions=True)
+                selected = dict(zip(unselected, selections))
+                
+                for i, pending in enumerate(batch):
+                    if pending.algorithm_name:
+                        algorithm = self.algorithm_registry.get_algorithm(pending.algorithm_name)
+                        name = pending.algorithm_name
+                    elif isinstance(selected[i], Exception):
+                        logger.error(f"算法選擇失敗: {selected[i]}")
+                        continue
+                    else:
+                        algorithm, name = selected[i]
+                    if algorithm:
+                        groups.setdefault(name, (algorithm, []))[1].append(i)
+                
+                # 各算法分組併發執行
+                ensemble_members = (self.config.ensemble_config or {}).get("algorithms") \
+                    if self.config.mode == OrchestratorMode.ENSEMBLE else None
+                
+                if ensemble_members:
+                    indices = sorted(i for _, members in groups.values() for i in members)
+                    results = await self._run_ensemble_batch(ensemble_members, [batch[i].context for i in indices])
+                    for i, decision in zip(indices, results):
+                        decisions[i] = decision
+                else:
+                    group_results = await asyncio.gather(*(
+                        self._run_algorithm_batch(name, algorithm, [batch[i].context for i in members])
+                        for name, (algorithm, members) in groups.items()
+                    ))
+                    for (name, (_, members)), results in zip(groups.items(), group_results):
+                        for i, decision in zip(members, results):
+                            decisions[i] = decision
+                    
+                    if self.config.mode == OrchestratorMode.ENSEMBLE:
+                        # 未指定成員時沿用逐請求的集成投票
+                        handled = await asyncio.gather(*(
+                            self._ensemble_voting_manager.handle_ensemble_decision(
+                                batch[i].context, decisions[i], name, self.config.ensemble_config
+                            )
+                            for name, (_, members) in groups.items() for i in members if decisions[i]
+                        ))
+                        targets = [i for _, (_, members) in groups.items() for i in members if decisions[i]]
+                        for i, decision in zip(targets, handled):
+                            decisions[i] = decision
+                
+            except Exception as e:
+                logger.error(f"批次預測換手決策失敗: {e}")
+            
+            finally:
+                self._concurrent_requests -= len(batch)
+        
+        for i, pending in enumerate(batch):
+            if decisions[i] is None:
+                decisions[i] = self._get_fallback_decision(pending.context)
+        
+        self._cache_decisions([
+            (pending.context, decision) for pending, decision in zip(batch, decisions)
+            if pending.use_cache and decision.algorithm_name not in ("fallback_random", "emergency_fallback")
+        ])
+        return decisions
+    
+    async def _run_algorithm_batch(self, algorithm_name: str, algorithm: HandoverAlgorithm,
+                                   contexts: List[HandoverContext]) -> List[Optional[HandoverDecision]]:
+        """單一算法的批次推論與批量指標記錄；失敗時整組返回 None 交由回退處理"""
+        start_time = time.time()
+        try:
+            if hasattr(algorithm, "predict_handover_batch"):
+                decisions = await algorithm.predict_handover_batch(contexts)
+            else:
+                decisions = await asyncio.gather(*(algorithm.predict_handover(c) for c in contexts))
+            if len(decisions) != len(contexts):
+                raise ValueError(f"批次結果數量 {len(decisions)} 與請求數量 {len(contexts)} 不符")
+        except Exception as e:
+            execution_time = (time.time() - start_time) * 1000 / len(contexts)
+            logger.error(f"算法批次執行失敗 {algorithm_name}: {e}")
+            await self._record_metrics_bulk(algorithm_name, execution_time, [None] * len(contexts))
+            return [None] * len(contexts)
+        
+        # 每筆決策分攤批次耗時
+        execution_time = (time.time() - start_time) * 1000 / len(contexts)
+        await self._record_metrics_bulk(algorithm_name, execution_time, decisions)
+        
+        if self.config.mode == OrchestratorMode.A_B_TESTING:
+            for decision in decisions:
+                await self._ab_test_manager.record_ab_test_result(algorithm_name, decision)
+        
+        return list(decisions)
+    
+    async def _run_ensemble_batch(self, member_names: List[str],
+                                  contexts: List[HandoverContext]) -> List[Optional[HandoverDecision]]:
+        """集成模式：所有成員併發跑完整批次，再逐請求以信心度加權投票"""
+        members = [(name, self.algorithm_registry.get_algorithm(name)) for name in member_names]
+        members = [(name, algorithm) for name, algorithm in members if algorithm]
+        if not members:
+            return [None] * len(contexts)
+        
+        member_results = await asyncio.gather(*(
+            self._run_algorithm_batch(name, algorithm, contexts) for name, algorithm in members
+        ))
+        weights = (self.config.ensemble_config or {}).get("weights", {})
+        
+        return [
+            self._ensemble_voting_manager.vote({
+                name: results[i] for (name, _), results in zip(members, member_results) if results[i]
+            }, weights)
+            for i in range(len(contexts))
+        ]
+    
+    async def _record_metrics_bulk(self, algorithm_name: str, execution_time_ms: float,
+                                   decisions: List[Optional[HandoverDecision]]) -> None:
+        """彙總一批決策後只寫入一次性能指標
+        
+        監控器提供 record_algorithm_metrics_batch 時直接寫入彙總值；
+        否則以批次平均寫入一筆，精確的逐決策計數保留在 _batch_metrics。
+        """
+        total = len(decisions)
+        if total == 0:
+            return
+        confidences = [d.confidence for d in decisions if d is not None]
+        successes = len(confidences)
+        total_confidence = float(sum(confidences))
+        
+        aggregate = self._batch_metrics[algorithm_name]
+        aggregate["batches"] += 1
+        aggregate["decisions"] += total
+        aggregate["successes"] += successes
+        aggregate["total_confidence"] += total_confidence
+        aggregate["total_time_ms"] += execution_time_ms * total
+        
+        record_batch = getattr(self._performance_monitor, "record_algorithm_metrics_batch", None)
+        if record_batch is not None:
+            await record_batch(algorithm_name, execution_time_ms, total, successes, total_confidence)
+        else:
+            await self._performance_monitor.record_algorithm_metrics(
+                algorithm_name, execution_time_ms, successes > 0,
+                total_confidence / successes if successes else 0.0
+            )
+    
+    def _get_batch_metrics_stats(self) -> Dict[str, Dict[str, float]]:
+        stats = {}
+        for name, aggregate in self._batch_metrics.items():
+            decisions = aggregate["decisions"]
+            stats[name] = {
+                "batches": aggregate["batches"],
+                "decisions": decisions,
+                "success_rate": aggregate["successes"] / decisions if decisions else 0.0,
+                "average_confidence": aggregate["total_confidence"] / aggregate["successes"]
+                if aggregate["successes"] else 0.0,
+                "average_time_ms": aggregate["total_time_ms"] / decisions if decisions else 0.0,
+            }
+        return stats
+    
+    def _create_micro_batcher(self, config: OrchestratorConfig) -> Optional[DecisionMicroBatcher]:
+        if not config.enable_micro_batching:
+            return None
+        return DecisionMicroBatcher(
+            self._process_decision_batch, config.batch_window_ms, config.max_batch_size
+        )
+
+    def _get_fallback_decision(self, context: HandoverContext) -> HandoverDecision:
+        """獲取回退決策"""
+        try:
+            fallback_algorithm = self.algorithm_registry.get_algorithm("random")
+            if fallback_algorithm:
+                try:
+                    decision = fallback_algorithm.predict_handover(context)
+                    decision.algorithm_name = "fallback_random"
+                    return decision
+                except Exception as e:
+                    logger.error(f"回退算法執行失敗: {e}")
+        except Exception:
+            pass
+        
+        # 最終回退：不換手
+        return HandoverDecision(
+            target_satellite=None,
+            handover_decision=HandoverDecisionType.NO_HANDOVER,
+            confidence=0.1,
+            timing=None,
+            decision_reason="all_algorithms_failed",
+            algorithm_name="emergency_fallback",
+            decision_time=0.0,
+            metadata={"reason": "all_algorithms_failed"}
+        )
+
+    def _create_decision_cache(self, config: OrchestratorConfig) -> QuantizedDecisionCache:
+        cache_config = DecisionCacheConfig(ttl_seconds=config.cache_ttl_seconds)
+        for key, value in (config.decision_cache_config or {}).items():
+            if hasattr(cache_config, key):
+                setattr(cache_config, key, value)
+            else:
+                logger.warning(f"未知的決策緩存配置項: {key}")
+        return QuantizedDecisionCache(cache_config)
+
+    def _get_cached_decision(self, context: HandoverContext) -> Optional[HandoverDecision]:
+        """獲取緩存決策"""
+        return self._decision_cache.get(context)
+
+    def _cache_decision(self, context: HandoverContext, decision: HandoverDecision) -> None:
+        """緩存決策"""
+        self._decision_cache.put(context, decision)
+
+    def _cache_decisions(self, entries: List[Tuple[HandoverContext, HandoverDecision]]) -> None:
+        """批量緩存決策"""
+        for context, decision in entries:
+            self._decision_cache.put(context, decision)
+
+    def _generate_cache_key(self, context: HandoverContext):
+        """生成緩存鍵 (量化上下文)"""
+        return self._decision_cache.key_for(context)
+
+    def invalidate_satellite(self, satellite_id: str) -> int:
+        """衛星狀態變化時失效相關緩存決策"""
+        return self._decision_cache.invalidate_satellite(satellite_id)
+
+    def update_visible_satellites(self, visible_satellite_ids: List[str]) -> int:
+        """更新可見衛星集合，離開可見範圍的衛星相關緩存決策失效"""
+        return self._decision_cache.update_visible_satellites(visible_satellite_ids)
+
+    # === 公共API方法 ===
+
+    def get_orchestrator_stats(self) -> Dict[str, Any]:
+        """獲取協調器統計信息"""
+        stats = self._performance_monitor.get_orchestrator_stats()
+        stats["decision_cache"] = self._decision_cache.get_stats()
+        stats["batch_metrics"] = self._get_batch_metrics_stats()
+        if self._micro_batcher is not None:
+            stats["micro_batching"] = self._micro_batcher.get_stats()
+        return stats
+
+    async def update_config(self, new_config: OrchestratorConfig) -> None:
+        """更新配置"""
+        if self._micro_batcher is not None:
+            await self._micro_batcher.drain()
+        self.config = new_config
+        self._micro_batcher = self._create_micro_batcher(new_config)
+        self._decision_cache = self._create_decision_cache(new_config)
+        
+        # 重新初始化相關模組
+        if new_config.ab_test_config:
+            await self._ab_test_manager.initialize_ab_testing(new_config.ab_test_config)
+        
+        logger.info("協調器配置已更新")
+
+    async def cleanup(self) -> None:
+        """清理資源"""
+        if self._micro_batcher is not None:
+            await self._micro_batcher.drain()
+        self._decision_cache.clear()
+        await self._ensemble_voting_manager.initialize_ensemble()  # 重置集成狀態
+        logger.info("協調器資源已清理")
+
+    # === A/B測試管理方法 ===
+
+    def set_ab_test_config(self, test_id: str, traffic_split: Dict[str, float]) -> None:
+        """設置 A/B 測試配置"""
+        self._ab_test_manager.set_ab_test_config(test_id, traffic_split)
+        
+        # 更新模式為 A/B 測試
+        if self.config.mode != OrchestratorMode.A_B_TESTING:
+            self.config.mode = OrchestratorMode.A_B_TESTING
+
+    def clear_ab_test_config(self, test_id: str) -> None:
+        """清除 A/B 測試配置"""
+        self._ab_test_manager.clear_ab_test_config(test_id)
+
+    def get_ab_test_performance(self, test_id: str) -> Dict[str, Any]:
+        """獲取 A/B 測試性能數據"""
+        return self._ab_test_manager.get_ab_test_performance(test_id)
+
+    def export_metrics_for_analysis(self) -> Dict[str, Any]:
+        """導出指標用於分析"""
+        return self._performance_monitor.export_metrics_for_analysis()
\ No newline at end of file
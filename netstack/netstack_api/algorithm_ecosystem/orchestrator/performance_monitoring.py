@@ -0,0 +1,112 @@
+"""
+📈 算法性能監控
+
+記錄各算法的請求數、成功率、平均耗時與信心度，
+供算法選擇 (性能策略)、集成投票權重與統計 API 使用。
+"""
+
+import logging
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from datetime import datetime
+from typing import Any, Deque, Dict
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class AlgorithmMetrics:
+    """單一算法的累計性能指標"""
+    total_requests: int = 0
+    successful_requests: int = 0
+    failed_requests: int = 0
+    total_time_ms: float = 0.0
+    total_confidence: float = 0.0
+    last_used: float = 0.0
+    recent_times_ms: Deque[float] = field(default_factory=lambda: deque(maxlen=100))
+
+    @property
+    def success_rate(self) -> float:
+        return self.successful_requests / self.total_requests if self.total_requests else 0.0
+
+    @property
+    def average_response_time_ms(self) -> float:
+        return self.total_time_ms / self.total_requests if self.total_requests else 0.0
+
+    @property
+    def average_confidence(self) -> float:
+        return self.total_confidence / self.successful_requests if self.successful_requests else 0.0
+
+    def to_dict(self) -> Dict[str, Any]:
+        recent = list(self.recent_times_ms)
+        return {
+            "total_requests": self.total_requests,
+            "successful_requests": self.successful_requests,
+            "failed_requests": self.failed_requests,
+            "success_rate": self.success_rate,
+            "average_response_time_ms": self.average_response_time_ms,
+            "recent_average_time_ms": sum(recent) / len(recent) if recent else 0.0,
+            "average_confidence": self.average_confidence,
+            "last_used": datetime.fromtimestamp(self.last_used).isoformat() if self.last_used else None,
+        }
+
+
+class PerformanceMonitor:
+    """協調器層級的算法性能監控"""
+
+    def __init__(self, window_size: int = 100):
+        self.window_size = window_size
+        self._algorithm_metrics: Dict[str, AlgorithmMetrics] = {}
+        self._started_at = time.time()
+
+    def _metrics_for(self, algorithm_name: str) -> AlgorithmMetrics:
+        metrics = self._algorithm_metrics.get(algorithm_name)
+        if metrics is None:
+            metrics = AlgorithmMetrics(recent_times_ms=deque(maxlen=self.window_size))
+            self._algorithm_metrics[algorithm_name] = metrics
+        return metrics
+
+    async def record_algorithm_metrics(self, algorithm_name: str, execution_time_ms: float,
+                                       success: bool, confidence: float) -> None:
+        """記錄單次決策"""
+        await self.record_algorithm_metrics_batch(
+            algorithm_name, execution_time_ms, 1, int(success), confidence if success else 0.0
+        )
+
+    async def record_algorithm_metrics_batch(self, algorithm_name: str, execution_time_ms: float,
+                                             total: int, successes: int, total_confidence: float) -> None:
+        """記錄一批決策的彙總值 (execution_time_ms 為每筆決策的平均耗時)"""
+        if total <= 0:
+            return
+        metrics = self._metrics_for(algorithm_name)
+        metrics.total_requests += total
+        metrics.successful_requests += successes
+        metrics.failed_requests += total - successes
+        metrics.total_time_ms += execution_time_ms * total
+        metrics.total_confidence += total_confidence
+        metrics.last_used = time.time()
+        metrics.recent_times_ms.append(execution_time_ms)
+
+    def get_orchestrator_stats(self) -> Dict[str, Any]:
+        total = sum(m.total_requests for m in self._algorithm_metrics.values())
+        successful = sum(m.successful_requests for m in self._algorithm_metrics.values())
+        return {
+            "total_requests": total,
+            "successful_requests": successful,
+            "failed_requests": total - successful,
+            "overall_success_rate": successful / total if total else 0.0,
+            "algorithm_count": len(self._algorithm_metrics),
+            "algorithm_stats": {name: m.to_dict() for name, m in self._algorithm_metrics.items()},
+            "uptime_seconds": time.time() - self._started_at,
+        }
+
+    def export_metrics_for_analysis(self) -> Dict[str, Any]:
+        return {
+            "exported_at": datetime.now().isoformat(),
+            "window_size": self.window_size,
+            "algorithms": {
+                name: {**m.to_dict(), "recent_times_ms": list(m.recent_times_ms)}
+                for name, m in self._algorithm_metrics.items()
+            },
+        }
@@ -214,6 +214,10 @@ class AlgorithmRegistry:
         """
         return [name for name, enabled in self._enabled_algorithms.items() if enabled]
 
+    def get_algorithm_priority(self, name: str) -> int:
+        """獲取算法優先級 (未註冊返回 0)"""
+        return self._algorithm_priorities.get(name, 0)
+
     def get_registered_algorithms(self) -> Dict[str, HandoverAlgorithm]:
         """獲取所有已註冊的算法
 
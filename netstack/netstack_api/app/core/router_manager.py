@@ -198,6 +198,30 @@ class RouterManager:
             except ImportError:
                 logger.warning("Phase 2 狀態路由器不可用，跳過註冊")
 
+            # 嘗試導入共享模擬時鐘路由器
+            try:
+                from ...routers.simulation_clock_router import (
+                    router as simulation_clock_router,
+                )
+
+                self.app.include_router(simulation_clock_router, tags=["模擬時鐘"])
+                self._track_router("simulation_clock_router", "模擬時鐘", True)
+                logger.info("✅ 模擬時鐘路由器註冊完成")
+            except ImportError:
+                logger.warning("模擬時鐘路由器不可用，跳過註冊")
+
+            # 嘗試導入多波束覆蓋路由器
+            try:
+                from ...routers.beam_footprint_router import (
+                    router as beam_footprint_router,
+                )
+
+                self.app.include_router(beam_footprint_router, tags=["多波束覆蓋"])
+                self._track_router("beam_footprint_router", "多波束覆蓋", True)
+                logger.info("✅ 多波束覆蓋路由器註冊完成")
+            except ImportError as e:
+                logger.warning(f"多波束覆蓋路由器不可用，跳過註冊: {e}")
+
             # 嘗試導入六階段管道統計路由器
             try:
                 from ...routers.pipeline_statistics_router import (
@@ -47,6 +47,8 @@ managers = {}
 
 # 背景衛星數據初始化標誌
 satellite_data_ready = False
+# 背景初始化任務的強引用 (事件循環只持有弱引用)
+_background_tasks = set()
 
 
 async def _background_satellite_data_init():
@@ -133,6 +135,13 @@ async def lifespan(app: FastAPI):
 
 async def _initialize_all_managers(app: FastAPI) -> None:
     """一鍵初始化所有管理器"""
+    global satellite_data_ready
+
+    # Warm-start 快照映射只需讀取 header，先於所有管理器完成，衛星查詢立即可用
+    from .services.warm_start_snapshot import load_warm_start_snapshot
+    if load_warm_start_snapshot() is not None:
+        satellite_data_ready = True
+
     # 適配器 → 服務 → 路由器 → 完成
     managers["adapter"] = AdapterManager()
     adapters = await managers["adapter"].initialize()
@@ -149,7 +158,15 @@ async def _initialize_all_managers(app: FastAPI) -> None:
     # 啟動背景衛星數據初始化任務
     logger.info("🛰️ 啟動背景衛星數據初始化...")
     import asyncio
-    asyncio.create_task(_background_satellite_data_init())
+    task = asyncio.create_task(_background_satellite_data_init())
+    _background_tasks.add(task)
+    task.add_done_callback(_background_tasks.discard)
+
+    # 共享衛星狀態表：背景 tick 傳播，路由器直接查詢；波束覆蓋隨每一代換代回呼投影
+    from .services.satellite_state_table import get_satellite_state_table
+    from .services.beam_footprint_engine import get_beam_footprint_engine
+    get_beam_footprint_engine().attach(get_satellite_state_table())
+    get_satellite_state_table().start()
 
     logger.info("✅ 所有管理器初始化完成")
 
@@ -166,6 +183,10 @@ async def _graceful_shutdown() -> None:
     logger.info("🔧 系統正在關閉...")
 
     try:
+        from .services.satellite_state_table import get_satellite_state_table
+        from .services.instant_satellite_loader import cancel_hydration
+        await get_satellite_state_table().stop()
+        await cancel_hydration()
         if managers.get("adapter"):
             await managers["adapter"].cleanup()
         logger.info("✅ 系統已優雅關閉")
@@ -292,6 +313,13 @@ async def health_check():
             "satellite_data_ready": satellite_data_ready,  # 衛星數據狀態
         }
 
+        # 快照可服務查詢但 PostgreSQL 水合失敗時標記為降級
+        from .services.instant_satellite_loader import get_hydration_status
+        hydration = get_hydration_status()
+        health_data["satellite_db_hydration"] = hydration
+        if hydration["state"] == "failed":
+            health_data["status"] = "degraded"
+
         # 基礎檢查
         if managers.get("adapter"):
             adapter_health = await managers["adapter"].health_check()
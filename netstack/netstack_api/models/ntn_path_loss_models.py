@@ -19,8 +19,17 @@ from dataclasses import dataclass
 from enum import Enum
 import structlog
 
+try:
+    from scipy.special import j1 as _bessel_j1
+    SCIPY_AVAILABLE = True
+except ImportError:
+    SCIPY_AVAILABLE = False
+
 logger = structlog.get_logger(__name__)
 
+# 3GPP TR 38.811 §6.4.1 圓形孔徑方向圖的半功率點: ka·sin(θ3dB) = 1.6163
+BESSEL_HALF_POWER_ARGUMENT = 1.6163
+
 
 class NTNScenario(Enum):
     """NTN 場景類型"""
@@ -59,6 +68,85 @@ class AntennaPattern:
     cross_pol_discrimination_db: float = 30.0  # 交叉極化鑑別度
 
 
+def _bessel_j1_integral(x: np.ndarray, nodes: int = 1024) -> np.ndarray:
+    """J1(x) = (1/π)∫₀^π cos(τ - x·sinτ) dτ；被積函數為週期函數，梯形積分收斂極快 (無 scipy 時使用)"""
+    tau = np.linspace(0.0, math.pi, nodes + 1)
+    weights = np.full(tau.size, 1.0 / nodes)
+    weights[[0, -1]] *= 0.5
+    out = np.empty_like(x, dtype=np.float64)
+    for start in range(0, x.size, 2048):
+        chunk = x[start:start + 2048, None]
+        out[start:start + 2048] = np.cos(tau - chunk * np.sin(tau)) @ weights
+    return out
+
+
+class TabulatedBeamPattern:
+    """
+    3GPP TR 38.811 §6.4.1 衛星波束方向圖 (查表版)
+
+    G(θ) = Gmax · 4|J1(ka·sinθ) / (ka·sinθ)|²，θ = 0 時為 Gmax。
+    方向圖在 [0°, 90°] 以固定步長預先計算，增益查詢以線性內插向量化完成，
+    供波束覆蓋引擎對大量 (UE, 波束) 組合求增益。
+    """
+
+    def __init__(self, max_gain_dbi: float, half_power_beamwidth_deg: float,
+                 resolution_deg: float = 0.01, floor_db: float = 60.0):
+        """
+        Args:
+            max_gain_dbi: 波束中心增益
+            half_power_beamwidth_deg: 半功率波束寬度 (決定 ka)
+            resolution_deg: 查表步長
+            floor_db: 零點處的最低相對增益 (避免 -inf)
+        """
+        self.max_gain_dbi = float(max_gain_dbi)
+        self.half_power_beamwidth_deg = float(half_power_beamwidth_deg)
+        self.ka = BESSEL_HALF_POWER_ARGUMENT / math.sin(math.radians(half_power_beamwidth_deg / 2))
+        self.resolution_deg = float(resolution_deg)
+
+        self.angles_deg = np.arange(0.0, 90.0 + resolution_deg / 2, resolution_deg)
+        u = self.ka * np.sin(np.radians(self.angles_deg))
+        j1 = _bessel_j1(u[1:]) if SCIPY_AVAILABLE else _bessel_j1_integral(u[1:])
+        relative = np.ones_like(u)
+        relative[1:] = 4.0 * (j1 / u[1:]) ** 2
+        self.gain_table_db = self.max_gain_dbi + np.maximum(10 * np.log10(np.maximum(relative, 1e-30)), -floor_db)
+
+    @classmethod
+    def from_antenna_pattern(cls, antenna_pattern: AntennaPattern, **kwargs) -> "TabulatedBeamPattern":
+        return cls(antenna_pattern.max_gain_dbi, antenna_pattern.half_power_beamwidth_deg, **kwargs)
+
+    @classmethod
+    def from_aperture(cls, max_gain_dbi: float, aperture_radius_m: float, frequency_ghz: float,
+                      **kwargs) -> "TabulatedBeamPattern":
+        """由孔徑半徑與頻率建立 (TR 38.811 表 6.4.1-1 的參數形式)"""
+        ka = 2 * math.pi * frequency_ghz * 1e9 / 299792458.0 * aperture_radius_m
+        hpbw = 2 * math.degrees(math.asin(min(BESSEL_HALF_POWER_ARGUMENT / ka, 1.0)))
+        return cls(max_gain_dbi, hpbw, **kwargs)
+
+    def edge_angle_deg(self, edge_db: float) -> float:
+        """主瓣增益首次降到峰值以下 edge_db 的偏軸角 (波束覆蓋邊緣)"""
+        below = np.flatnonzero(self.gain_table_db < self.max_gain_dbi - edge_db)
+        return float(self.angles_deg[below[0]]) if below.size else 90.0
+
+    def gain_db(self, off_boresight_angle_deg) -> np.ndarray:
+        """偏離波束中心角度 (度，任意形狀) → 增益 dBi；超過 90° 取 90° 的值"""
+        angles = np.abs(np.asarray(off_boresight_angle_deg, dtype=np.float64))
+        return np.interp(angles, self.angles_deg, self.gain_table_db)
+
+
+_pattern_cache: Dict[Tuple[float, float, float], TabulatedBeamPattern] = {}
+
+
+def get_tabulated_beam_pattern(antenna_pattern: AntennaPattern,
+                               resolution_deg: float = 0.01) -> TabulatedBeamPattern:
+    """相同增益 / 波束寬度的方向圖只建表一次"""
+    key = (antenna_pattern.max_gain_dbi, antenna_pattern.half_power_beamwidth_deg, resolution_deg)
+    pattern = _pattern_cache.get(key)
+    if pattern is None:
+        pattern = TabulatedBeamPattern.from_antenna_pattern(antenna_pattern, resolution_deg=resolution_deg)
+        _pattern_cache[key] = pattern
+    return pattern
+
+
 @dataclass
 class NTNPathLossResult:
     """NTN 路徑損耗計算結果"""
@@ -0,0 +1,104 @@
+"""
+多波束覆蓋 API
+以共享衛星狀態表目前一代的波束覆蓋回答「哪個波束服務此位置」，並追蹤 UE 的波束切換
+"""
+
+from typing import Any, Dict, List, Optional
+
+import numpy as np
+import structlog
+from fastapi import APIRouter, HTTPException, Query
+from pydantic import BaseModel, Field
+
+from ..services.beam_footprint_engine import (
+    BeamFootprintFrame,
+    get_beam_assignment_tracker,
+    get_beam_footprint_engine,
+)
+
+logger = structlog.get_logger(__name__)
+
+router = APIRouter(prefix="/api/v1/beams", tags=["多波束覆蓋"])
+
+
+# === Request Models ===
+
+class UEPosition(BaseModel):
+    """UE 位置"""
+    ue_id: str
+    latitude: float = Field(..., ge=-90, le=90)
+    longitude: float = Field(..., ge=-180, le=180)
+    altitude_km: float = Field(0.0, ge=0)
+
+
+class TrackRequest(BaseModel):
+    """以目前一代波束覆蓋更新一批 UE 的服務波束"""
+    ues: List[UEPosition] = Field(..., min_length=1, max_length=10000)
+
+
+def _current_frame() -> BeamFootprintFrame:
+    frame = get_beam_footprint_engine().current_frame()
+    if frame is None:
+        raise HTTPException(status_code=503, detail="衛星狀態表尚未就緒，無波束覆蓋")
+    return frame
+
+
+@router.get("/serving")
+async def get_serving_beam(
+    latitude: float = Query(..., ge=-90, le=90),
+    longitude: float = Query(..., ge=-180, le=180),
+    altitude_km: float = Query(0.0, ge=0),
+) -> Dict[str, Any]:
+    """指定位置 RSRP 最強的服務波束 (無覆蓋時 beam 為 null)"""
+    frame = _current_frame()
+    assignment = get_beam_footprint_engine().assign(
+        frame, np.array([latitude]), np.array([longitude]), np.array([altitude_km])
+    )
+    return {
+        "generation": assignment.generation,
+        "timestamp": assignment.timestamp,
+        **assignment.as_dict(0),
+    }
+
+
+@router.post("/track")
+async def track_ues(request: TrackRequest) -> Dict[str, Any]:
+    """
+    更新 UE 服務波束 (含遲滯)，回傳各 UE 的服務波束與本次產生的切換事件
+    """
+    frame = _current_frame()
+    ue_ids = [ue.ue_id for ue in request.ues]
+    assignment, events = get_beam_assignment_tracker().update(
+        frame,
+        ue_ids,
+        np.array([ue.latitude for ue in request.ues]),
+        np.array([ue.longitude for ue in request.ues]),
+        np.array([ue.altitude_km for ue in request.ues]),
+    )
+    return {
+        "generation": assignment.generation,
+        "timestamp": assignment.timestamp,
+        "assignments": {ue_id: assignment.as_dict(i) for i, ue_id in enumerate(ue_ids)},
+        "events": events,
+    }
+
+
+@router.delete("/track/{ue_id}")
+async def forget_ue(ue_id: str) -> Dict[str, Any]:
+    get_beam_assignment_tracker().forget(ue_id)
+    return {"ue_id": ue_id, "forgotten": True}
+
+
+@router.get("/stats")
+async def get_beam_stats() -> Dict[str, Any]:
+    """波束覆蓋引擎與 UE 波束追蹤統計"""
+    engine = get_beam_footprint_engine()
+    frame: Optional[BeamFootprintFrame] = engine.current_frame()
+    tracker = get_beam_assignment_tracker()
+    return {
+        "engine": engine.get_stats(),
+        "current_generation": frame.generation if frame else None,
+        "beams": len(frame) if frame else 0,
+        "search_radius_km": frame.search_radius_km if frame else None,
+        "tracker": {**tracker.statistics, "tracked_ues": len(tracker.serving)},
+    }
@@ -7,13 +7,15 @@
 
 from datetime import datetime, timezone
 from typing import List, Optional, Dict, Any, Union
-from fastapi import APIRouter, HTTPException, Query, Path
+from fastapi import APIRouter, HTTPException, Query, Path, Response
 from pydantic import BaseModel, Field
 import structlog
 import asyncio
 import json
 from pathlib import Path as PathLib
 
+from ..services.satellite_state_table import encode_json, get_satellite_state_table
+
 logger = structlog.get_logger(__name__)
 
 
@@ -536,68 +538,131 @@ async def get_precomputed_orbit_data(
     )
 
 
+@router.get("/current/{location}")
+async def get_current_satellite_states(
+    location: str = Path(..., description="觀測位置 ID"),
+    constellation: str = Query("starlink", description="衛星星座 (starlink/oneweb/both)"),
+    elevation_threshold: float = Query(10.0, description="仰角門檻"),
+    count: int = Query(15, ge=1, le=1000, description="返回衛星數量"),
+):
+    """從共享衛星狀態表取得觀測位置目前的可見衛星 (不觸發軌道計算)"""
+    table = get_satellite_state_table()
+    snapshot = table.snapshot_for()
+    if snapshot is None:
+        raise HTTPException(status_code=503, detail="衛星狀態表尚未就緒")
+    if location not in snapshot.observers:
+        raise HTTPException(status_code=404, detail=f"未註冊的觀測位置: {location}")
+
+    view = snapshot.observer_view(location)
+    indices = snapshot.select(view, constellation=constellation,
+                              min_elevation_deg=elevation_threshold, limit=count)
+    latitude, longitude, altitude_km = snapshot.observer_locations[location]
+    return Response(content=encode_json({
+        "location": {
+            "id": location,
+            "latitude": latitude,
+            "longitude": longitude,
+            "altitude": altitude_km * 1000,
+        },
+        "timestamp": snapshot.time.isoformat(),
+        "state_generation": snapshot.generation,
+        "constellation": constellation,
+        "elevation_threshold": elevation_threshold,
+        "satellites": snapshot.rows(indices, view, fields=(
+            "norad_id", "name", "constellation", "latitude", "longitude", ("altitude", "altitude_km"),
+            "elevation_deg", "azimuth_deg", "range_km", "rsrp_dbm", "is_visible",
+        )),
+    }), media_type="application/json")
+
+
+def _search_precomputed_window(satellites_data: Dict[str, Any], observer_location: Dict[str, Any],
+                                window_hours: int, elevation_threshold: float) -> Dict[str, Any]:
+    """以預計算 positions 的滑動窗口搜尋找出最佳時間窗口 (CPU 密集，於執行緒中執行)"""
+    from src.services.satellite.coordinate_specific_orbit_engine import CoordinateSpecificOrbitEngine
+
+    satellites = [
+        {
+            "norad_id": sat_data.get("norad_id", _extract_norad_id(sat_id)),
+            "name": sat_data.get("name", sat_id),
+            "positions": [p for p in sat_data.get("positions", []) if "time_offset_seconds" in p],
+        }
+        for sat_id, sat_data in satellites_data.items()
+    ]
+    engine = CoordinateSpecificOrbitEngine(
+        observer_location.get("lat", 24.94417),
+        observer_location.get("lon", 121.37139),
+        observer_location.get("alt", 50.0),
+        min_elevation=elevation_threshold,
+    )
+    # 時間步長依預計算資料的取樣間隔
+    for satellite in satellites:
+        offsets = [p["time_offset_seconds"] for p in satellite["positions"][:2]]
+        if len(offsets) == 2 and offsets[1] > offsets[0]:
+            engine.time_step_seconds = int(offsets[1] - offsets[0])
+            break
+    return engine.search_time_windows(
+        satellites, window_minutes=[window_hours * 60], top_k=1, describe_best=True
+    )
+
+
 @router.get("/optimal-window/{location}")
 async def get_optimal_timewindow(
     location: str = Path(..., description="觀測位置 ID"),
     constellation: str = Query("starlink", description="衛星星座"),
-    window_hours: int = Query(6, description="時間窗口長度(小時)"),
+    window_hours: int = Query(6, ge=1, le=24, description="時間窗口長度(小時)"),
+    elevation_threshold: float = Query(10.0, description="仰角門檻"),
 ):
-    """獲取最佳時間窗口"""
+    """以預計算軌道數據的滑動窗口搜尋取得最佳時間窗口"""
     logger.info(
         f"API: 取得 {location} 最佳時間窗口",
         constellation=constellation,
         window_hours=window_hours,
     )
 
-    # 模擬最佳時間窗口數據
+    constellation_data = enhanced_loader.get_constellation_data(constellation)
+    if not constellation_data:
+        raise HTTPException(
+            status_code=503,
+            detail=f"Phase 0 precomputed orbital data unavailable for {constellation}. Real SGP4 data required.",
+        )
+
+    observer_location = enhanced_loader.get_observer_location()
+    satellites_data = constellation_data.get("orbit_data", {}).get("satellites", {})
+    result = await asyncio.to_thread(
+        _search_precomputed_window, satellites_data, observer_location, window_hours, elevation_threshold
+    )
+    best = result["best"]
+    if best is None:
+        raise HTTPException(
+            status_code=404,
+            detail=f"預計算數據時間範圍不足 {window_hours} 小時或無可見衛星",
+        )
+
     return {
         "location": {
             "id": location,
-            "name": "國立臺北大學" if location == "ntpu" else location,
-            "latitude": 24.9434,
-            "longitude": 121.3709,
-            "altitude": 50.0,
+            "name": observer_location.get("name", "NTPU"),
+            "latitude": observer_location.get("lat", 24.94417),
+            "longitude": observer_location.get("lon", 121.37139),
+            "altitude": observer_location.get("alt", 50.0),
             "environment": "urban",
         },
         "optimal_window": {
-            "start_time": datetime.now(timezone.utc).isoformat(),
-            "end_time": (
-                datetime.now(timezone.utc).replace(hour=23, minute=59)
-            ).isoformat(),
-            "duration_hours": window_hours,
-            "avg_visible_satellites": 12.5,
-            "max_visible_satellites": 18,
-            "handover_opportunities": 45,
+            "start_time": best["start_time"],
+            "end_time": best["end_time"],
+            "duration_hours": best["duration_minutes"] / 60,
+            "avg_visible_satellites": best["mean_visible"],
+            "max_visible_satellites": int(best["max_visible"]),
+            "handover_opportunities": int(best["handover_opportunities"]),
+            "coverage_ratio": best["coverage_ratio"],
+            "worst_elevation": best["worst_elevation"],
+            "windows_evaluated": result["evaluated"],
         },
         "satellite_trajectories": [
-            {
-                "norad_id": 44713 + i,
-                "name": f"STARLINK-{1007 + i}",
-                "visibility_windows": [
-                    {
-                        "start_time": datetime.now(timezone.utc).isoformat(),
-                        "end_time": (
-                            datetime.now(timezone.utc).replace(minute=30)
-                        ).isoformat(),
-                        "max_elevation": 25.0 + i * 5,
-                        "duration_minutes": 8 + i,
-                    }
-                ],
-                "elevation_profile": [],
-            }
-            for i in range(5)
-        ],
-        "handover_events": [
-            {
-                "timestamp": datetime.now(timezone.utc).isoformat(),
-                "from_satellite": f"STARLINK-{1007 + i}",
-                "to_satellite": f"STARLINK-{1008 + i}",
-                "trigger_reason": "elevation_threshold",
-                "elevation_change": 5.0,
-            }
-            for i in range(3)
+            {**satellite, "elevation_profile": []} for satellite in best["satellites"]
         ],
-        "quality_score": 0.85,
+        "handover_events": best["handover_events"],
+        "quality_score": best["score"] / 100,
     }
 
 
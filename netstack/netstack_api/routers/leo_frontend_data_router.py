@@ -9,10 +9,12 @@ from datetime import datetime
 from typing import Dict, List, Optional, Any
 from pathlib import Path
 
-from fastapi import APIRouter, HTTPException, Query
+from fastapi import APIRouter, HTTPException, Query, Request, Response
 from pydantic import BaseModel
 import structlog
 
+from ..services.response_encoding import get_response_encoder
+
 # Import format converter
 import sys
 sys.path.append('/app/config')
@@ -96,12 +98,16 @@ async def get_conversion_status():
 
 @router.get("/data", response_model=FrontendDataResponse)
 async def get_frontend_data(
+    request: Request,
     constellation: Optional[str] = Query(None, description="過濾特定星座 (starlink/oneweb)"),
     force_convert: bool = Query(False, description="強制重新轉換")
 ):
     """
     獲取前端立體圖數據
     P0.3: 核心端點 - 將 LEO Restructure 數據轉換為前端格式
+
+    轉換結果以 Stage 6 輸出檔案版本 (路徑、修改時間、大小) 為 ETag 緩存編碼後位元組，
+    Accept 可選 application/msgpack 或 application/vnd.apache.arrow.stream (satellites 表格)。
     """
     try:
         # Find Stage 6 dynamic pool planning output
@@ -122,43 +128,60 @@ async def get_frontend_data(
                 detail="LEO final report not found. Run F1→F2→F3→A1 LEO processing first."
             )
         
-        # Load LEO final report
-        with open(final_report_path, 'r', encoding='utf-8') as f:
-            leo_final_report = json.load(f)
-        
-        # Convert to frontend format
-        converter = create_leo_to_frontend_converter()
-        frontend_data = converter.convert_phase1_report_to_frontend(leo_final_report)  # 使用同樣的轉換函數保持兼容性
-        
-        # Filter by constellation if specified
-        if constellation:
-            if constellation not in ['starlink', 'oneweb']:
-                raise HTTPException(
-                    status_code=400,
-                    detail="Invalid constellation. Use 'starlink' or 'oneweb'"
-                )
-            frontend_data = converter.convert_to_constellation_specific(frontend_data, constellation)
-        
-        # Validate format
-        if not converter.validate_frontend_format(frontend_data):
+        if constellation and constellation not in ['starlink', 'oneweb']:
             raise HTTPException(
-                status_code=500,
-                detail="Frontend format validation failed"
+                status_code=400,
+                detail="Invalid constellation. Use 'starlink' or 'oneweb'"
             )
-        
-        logger.info("Successfully served frontend data",
-                   constellation=constellation,
-                   satellites_count=len(frontend_data['satellites']))
-        
-        return FrontendDataResponse(
-            success=True,
-            data_source="leo_f1_f2_f3_a1_system",
-            constellation=constellation,
-            satellites_count=len(frontend_data['satellites']),
-            timestamp=datetime.utcnow().isoformat(),
-            metadata=frontend_data['metadata'],
-            satellites=frontend_data['satellites']
+
+        def build_frontend_data() -> Dict[str, Any]:
+            # Load LEO final report
+            with open(final_report_path, 'r', encoding='utf-8') as f:
+                leo_final_report = json.load(f)
+
+            # Convert to frontend format
+            converter = create_leo_to_frontend_converter()
+            frontend_data = converter.convert_phase1_report_to_frontend(leo_final_report)  # 使用同樣的轉換函數保持兼容性
+
+            # Filter by constellation if specified
+            if constellation:
+                frontend_data = converter.convert_to_constellation_specific(frontend_data, constellation)
+
+            # Validate format
+            if not converter.validate_frontend_format(frontend_data):
+                raise HTTPException(
+                    status_code=500,
+                    detail="Frontend format validation failed"
+                )
+
+            logger.info("Successfully converted frontend data",
+                       constellation=constellation,
+                       satellites_count=len(frontend_data['satellites']))
+
+            return {
+                "success": True,
+                "data_source": "leo_f1_f2_f3_a1_system",
+                "constellation": constellation,
+                "satellites_count": len(frontend_data['satellites']),
+                "timestamp": datetime.utcnow().isoformat(),
+                "metadata": frontend_data['metadata'],
+                "satellites": frontend_data['satellites']
+            }
+
+        # Stage 6 輸出在同一版本下不變；force_convert 時不使用編碼緩存
+        report_stat = os.stat(final_report_path)
+        encoded = await get_response_encoder().respond(
+            build_frontend_data,
+            accept=request.headers.get("accept"),
+            if_none_match=request.headers.get("if-none-match"),
+            etag_parts=None if force_convert else (
+                "leo_frontend_data", final_report_path, report_stat.st_mtime_ns,
+                report_stat.st_size, constellation
+            ),
+            table_key="satellites",
+            cache_control="no-cache"
         )
+        return encoded.to_response(Response)
         
     except HTTPException:
         raise
@@ -167,12 +190,12 @@ async def get_frontend_data(
         raise HTTPException(status_code=500, detail=f"Data conversion error: {str(e)}")
 
 @router.get("/constellations/{constellation}", response_model=FrontendDataResponse) 
-async def get_constellation_data(constellation: str):
+async def get_constellation_data(request: Request, constellation: str):
     """
     獲取特定星座的前端數據
     兼容舊版 API 端點
     """
-    return await get_frontend_data(constellation=constellation)
+    return await get_frontend_data(request, constellation=constellation, force_convert=False)
 
 @router.post("/convert")
 async def convert_leo_to_frontend(
@@ -10,10 +10,12 @@ import os
 from datetime import datetime, timedelta
 from typing import List, Optional, Dict, Any
 import math
-from fastapi import APIRouter, HTTPException, Query
+from fastapi import APIRouter, HTTPException, Query, Response
 from pydantic import BaseModel
 import structlog
 
+from ..services.satellite_state_table import encode_json, get_satellite_state_table
+
 # 添加預處理系統路徑
 sys.path.append('/home/sat/ntn-stack/netstack/src/services/satellite')
 sys.path.append('/home/sat/ntn-stack/netstack/src/services/satellite/preprocessing')
@@ -160,6 +162,13 @@ async def get_visible_satellites(
         logger.info(f"📅 用戶請求時間: {current_time}")
         logger.info(f"🛰️ 智能衛星選擇: {constellation} 星座, 請求 {count} 顆")
         
+        # 目前時刻的查詢直接讀共享衛星狀態表
+        snapshot = get_satellite_state_table().snapshot_for(current_time if utc_timestamp else None)
+        if snapshot is not None:
+            return _state_table_visible_response(
+                snapshot, count, constellation, min_elevation_deg, observer_lat, observer_lon, global_view
+            )
+        
         # 2. 載入Stage 6預計算數據
         stage6_data = await load_stage6_precomputed_data()
         if not stage6_data:
@@ -256,6 +265,32 @@ async def get_constellations_info():
         logger.error(f"❌ 獲取星座信息失敗: {e}")
         raise HTTPException(status_code=500, detail=f"獲取星座信息失敗: {str(e)}")
 
+def _state_table_visible_response(snapshot, count, constellation, min_elevation_deg,
+                                  observer_lat, observer_lon, global_view) -> Response:
+    """由共享衛星狀態表組裝 VisibleSatellitesResponse 格式的回應"""
+    view = snapshot.observer_view(latitude=observer_lat, longitude=observer_lon)
+    indices = snapshot.select(view, constellation=constellation, min_elevation_deg=min_elevation_deg, limit=count)
+    satellites = snapshot.rows(indices, view, fields=(
+        "name", "norad_id", "elevation_deg", "azimuth_deg", ("distance_km", "range_km"),
+        ("orbit_altitude_km", "altitude_km"), "constellation", ("signal_strength", "rsrp_dbm"), "is_visible",
+    ))
+    payload = {
+        "satellites": satellites,
+        "total_count": len(satellites),
+        "requested_count": count,
+        "constellation": constellation,
+        "global_view": global_view,
+        "timestamp": snapshot.time.isoformat().replace("+00:00", "Z"),
+        "observer_location": {"lat": observer_lat, "lon": observer_lon, "alt": 0.024},
+        "data_source": {
+            "type": "satellite_state_table",
+            "description": f"共享衛星狀態表: 第 {snapshot.generation} 代, {len(snapshot)} satellites",
+            "is_simulation": False
+        },
+        "preprocessing_stats": None
+    }
+    return Response(content=encode_json(payload), media_type="application/json")
+
 # === Stage 6 預計算數據查詢函數 ===
 
 async def load_stage6_precomputed_data():
@@ -8,13 +8,14 @@
 
 from datetime import datetime, timezone, timedelta
 from typing import List, Optional, Dict, Any
-from fastapi import APIRouter, HTTPException, BackgroundTasks, Query, Path
+from fastapi import APIRouter, HTTPException, BackgroundTasks, Query, Path, Request, Response
 from pydantic import BaseModel, Field, validator
 import structlog
 
 from ..services.precompute_job_manager import job_manager, JobStatus
 from ..services.batch_processor import HistoryBatchProcessor
 from ..services.tle_data_manager import TLEDataManager
+from ..services.response_encoding import ColumnarPayload, get_response_encoder
 
 logger = structlog.get_logger(__name__)
 
@@ -174,6 +175,76 @@ async def get_precompute_status(job_id: str = Path(..., description="作業 ID")
         raise HTTPException(status_code=500, detail=f"狀態查詢失敗: {str(e)}")
 
 
+@router.get("/precompute/{job_id}/results")
+async def get_precompute_results(
+    request: Request,
+    job_id: str = Path(..., description="作業 ID"),
+    orient: str = Query("records", description="records=逐筆記錄, columns=欄位陣列")
+):
+    """
+    獲取已完成作業的預計算結果
+
+    完成的作業窗口不再變動：結果以欄位陣列讀出後直接編碼，編碼後位元組以
+    (作業 ID, 完成時間, orient) 為 ETag 緩存。Accept 可選 application/msgpack
+    或 application/vnd.apache.arrow.stream。
+    """
+    try:
+        if orient not in ("records", "columns"):
+            raise HTTPException(status_code=400, detail="orient 必須是 records 或 columns")
+
+        job_status = await job_manager.get_job_status(job_id)
+
+        if not job_status:
+            raise HTTPException(status_code=404, detail=f"作業 {job_id} 不存在")
+        if job_status["status"] != JobStatus.COMPLETED.value:
+            raise HTTPException(status_code=409, detail=f"作業 {job_id} 尚未完成 ({job_status['status']})")
+
+        config = job_status["config"]
+
+        async def build_results() -> ColumnarPayload:
+            processor = HistoryBatchProcessor(postgres_url=job_manager.db_url)
+            await processor.initialize()
+            try:
+                columns = await processor.fetch_window_columns(
+                    config["constellation"],
+                    tuple(config["observer_coords"][:2]),
+                    datetime.fromisoformat(config["start_time"]),
+                    datetime.fromisoformat(config["end_time"])
+                )
+            finally:
+                await processor.close()
+
+            return ColumnarPayload(
+                columns=columns,
+                metadata={
+                    "job_id": job_id,
+                    "constellation": config["constellation"],
+                    "observer_coords": config["observer_coords"],
+                    "time_range": {"start": config["start_time"], "end": config["end_time"]},
+                    "time_step_seconds": config["time_step_seconds"],
+                    "completed_at": job_status["completed_at"],
+                    "total_records": len(columns["timestamp"])
+                },
+                records_key="results",
+                orient=orient
+            )
+
+        encoded = await get_response_encoder().respond(
+            build_results,
+            accept=request.headers.get("accept"),
+            if_none_match=request.headers.get("if-none-match"),
+            etag_parts=("precompute_results", job_id, job_status["completed_at"], orient),
+            cache_control="public, max-age=3600"
+        )
+        return encoded.to_response(Response)
+
+    except HTTPException:
+        raise
+    except Exception as e:
+        logger.error("預計算結果查詢失敗", job_id=job_id, error=str(e))
+        raise HTTPException(status_code=500, detail=f"結果查詢失敗: {str(e)}")
+
+
 @router.delete("/precompute/{job_id}")
 async def cancel_precompute_job(job_id: str = Path(..., description="作業 ID")):
     """
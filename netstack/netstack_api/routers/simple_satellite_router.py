@@ -11,11 +11,14 @@ import os
 from datetime import datetime, timedelta, timezone
 from typing import List, Optional, Dict, Any
 import math
-from fastapi import APIRouter, HTTPException, Query
+from fastapi import APIRouter, HTTPException, Query, Response
 from pydantic import BaseModel
 import json
 import logging
 
+from ..services.simulation_clock import ReplayWindowPrefetcher, get_simulation_clock
+from ..services.satellite_state_table import encode_json, get_satellite_state_table
+
 # 添加預處理系統路徑
 sys.path.append('/home/sat/ntn-stack/netstack/src/services/satellite')
 sys.path.append('/home/sat/ntn-stack/netstack/src/services/satellite/preprocessing')
@@ -405,17 +408,25 @@ async def get_visible_satellites(
     try:
         logger.info("🎯 新架構：直接查詢Stage 6預計算結果")
         
-        # 1. 解析用戶請求的時間戳
+        # 1. 解析用戶請求的時間戳 (未指定時使用共享模擬時鐘)
+        clock = get_simulation_clock()
         if utc_timestamp:
             try:
                 request_time = datetime.fromisoformat(utc_timestamp.replace('Z', '+00:00'))
             except:
-                request_time = datetime.utcnow()
+                request_time = clock.utcnow()
         else:
-            request_time = datetime.utcnow()
+            request_time = clock.utcnow()
         
         logger.info(f"📅 用戶請求時間: {request_time}")
         
+        # 目前時刻的查詢直接讀共享衛星狀態表，不載入 Stage 6 數據
+        snapshot = get_satellite_state_table().snapshot_for(request_time if utc_timestamp else None)
+        if snapshot is not None:
+            return _state_table_visible_response(
+                snapshot, count, min_elevation_deg, observer_lat, observer_lon, global_view, constellation
+            )
+        
         # 2. 載入Stage 6預計算數據
         stage6_data = await load_stage6_precomputed_data()
         if not stage6_data:
@@ -423,13 +434,19 @@ async def get_visible_satellites(
             return await get_emergency_backup_satellites(count, min_elevation_deg)
         
         # 3. 查詢Stage 6預計算結果
-        visible_satellites = await query_stage6_satellites_at_time(
-            stage6_data, 
-            request_time, 
-            min_elevation_deg,
-            count,
-            constellation
-        )
+        #    回放模式下跟隨游標的請求走預取時間窗，高倍速時不逐次重算
+        if not utc_timestamp and clock.is_replay:
+            visible_satellites = await get_replay_window_satellites(
+                stage6_data, request_time, min_elevation_deg, count, constellation
+            )
+        else:
+            visible_satellites = await query_stage6_satellites_at_time(
+                stage6_data, 
+                request_time, 
+                min_elevation_deg,
+                count,
+                constellation
+            )
         
         logger.info(f"✅ 從Stage 6找到 {len(visible_satellites)} 顆可見衛星")
         
@@ -456,6 +473,34 @@ async def get_visible_satellites(
         logger.error(f"❌ Stage 6查詢失敗: {e}")
         return await get_emergency_backup_satellites(count, min_elevation_deg)
 
+def _state_table_visible_response(snapshot, count, min_elevation_deg, observer_lat, observer_lon,
+                                  global_view, constellation) -> Response:
+    """由共享衛星狀態表組裝 /visible_satellites 回應 (欄位與 Stage 6 查詢結果相同)"""
+    view = snapshot.observer_view(latitude=observer_lat, longitude=observer_lon)
+    indices = snapshot.select(view, constellation=constellation, min_elevation_deg=min_elevation_deg, limit=count)
+    satellites = snapshot.rows(indices, view, fields=(
+        "name", "norad_id", "constellation", "satellite_id", "elevation_deg", "azimuth_deg",
+        ("distance_km", "range_km"), "range_km", ("orbit_altitude_km", "altitude_km"),
+        ("signal_strength", "rsrp_dbm"), "is_visible",
+    ))
+    payload = {
+        "satellites": satellites,
+        "total_count": len(satellites),
+        "metadata": {
+            "observer_location": {
+                "latitude": observer_lat,
+                "longitude": observer_lon
+            },
+            "timestamp": snapshot.time.isoformat(),
+            "min_elevation_deg": min_elevation_deg,
+            "global_view": global_view,
+            "data_source": "satellite_state_table",
+            "state_generation": snapshot.generation
+        }
+    }
+    return Response(content=encode_json(payload), media_type="application/json")
+
+
 async def load_stage6_precomputed_data():
     """載入Stage 6預計算數據"""
     try:
@@ -638,7 +683,7 @@ async def get_constellation_timeline(
 ):
     """獲取星座時間軸數據"""
     try:
-        current_time = datetime.utcnow()
+        current_time = get_simulation_clock().utcnow()
         timeline_data = []
         
         # 生成時間點
@@ -672,6 +717,54 @@ async def get_constellation_timeline(
         logger.error(f"❌ 獲取時間軸數據失敗: {e}")
         raise HTTPException(status_code=500, detail=f"獲取時間軸數據失敗: {str(e)}")
 
+@router.get(
+    "/warm-start/visible",
+    summary="從 warm-start 快照查詢可見衛星",
+    description="直接讀取 mmap 映射的預計算快照，不觸發計算或數據庫查詢"
+)
+async def get_warm_start_visible_satellites(
+    constellation: Optional[str] = Query(None, description="星座過濾"),
+    min_elevation_deg: float = Query(10.0, ge=-10, le=90, description="最低仰角"),
+    count: int = Query(20, ge=1, le=500, description="返回數量上限"),
+    utc_timestamp: Optional[str] = Query(None, description="查詢時間 (ISO 8601)，預設為當前時間")
+):
+    """從 warm-start 快照查詢可見衛星"""
+    from ..services.warm_start_snapshot import get_warm_start_snapshot
+
+    snapshot = get_warm_start_snapshot()
+    if snapshot is None:
+        raise HTTPException(status_code=503, detail="Warm-start 快照未載入")
+
+    query_time = get_simulation_clock().timestamp()
+    if utc_timestamp:
+        try:
+            query_time = datetime.fromisoformat(utc_timestamp.replace('Z', '+00:00')).timestamp()
+        except ValueError:
+            raise HTTPException(status_code=400, detail=f"無效的時間格式: {utc_timestamp}")
+
+    states = snapshot.get_satellites_at(
+        timestamp=query_time,
+        constellation=constellation,
+        min_elevation_deg=min_elevation_deg,
+        limit=count
+    )
+    if states is None:
+        start, end = snapshot.time_range
+        raise HTTPException(
+            status_code=404,
+            detail=(f"查詢時間不在 warm-start 快照範圍內 "
+                    f"({datetime.fromtimestamp(start, tz=timezone.utc).isoformat()} ~ "
+                    f"{datetime.fromtimestamp(end, tz=timezone.utc).isoformat()})")
+        )
+    return {
+        "satellites": [state.to_dict() for state in states],
+        "total_count": len(states),
+        "metadata": {
+            "data_source": "warm_start_snapshot",
+            "dataset_version": snapshot.dataset_version
+        }
+    }
+
 @router.get(
     "/health",
     summary="智能預處理系統健康檢查",
@@ -694,8 +787,10 @@ async def health_check():
         "endpoints": [
             "/api/v1/satellite-simple/visible_satellites",
             "/api/v1/satellite-simple/timeline/{constellation}", 
+            "/api/v1/satellite-simple/warm-start/visible",
             "/api/v1/satellite-simple/health"
         ],
+        "simulation_clock": get_simulation_clock().status(),
         "supported_constellations": ["starlink", "oneweb"],
         "intelligent_selection": {
             "starlink_target": 651,
@@ -709,19 +804,29 @@ async def health_check():
 
 # === Stage 6 預計算數據查詢支援函數 ===
 
+STAGE6_OUTPUT_PATH = "/app/data/leo_outputs/dynamic_pool_planning_outputs/enhanced_dynamic_pools_output.json"
+
+# Stage 6 輸出快取 (依檔案 mtime 失效)：回放高倍速時每秒多次查詢不重讀整個 JSON
+_stage6_cache: Dict[str, Any] = {"mtime": None, "data": None}
+
+
 async def load_stage6_precomputed_data():
     """載入Stage 6預計算數據"""
     try:
-        import json
-        stage6_path = "/app/data/leo_outputs/dynamic_pool_planning_outputs/enhanced_dynamic_pools_output.json"
+        stage6_path = STAGE6_OUTPUT_PATH
         
         if not os.path.exists(stage6_path):
             logger.error(f"❌ Stage 6文件不存在: {stage6_path}")
             return None
+        
+        mtime = os.path.getmtime(stage6_path)
+        if _stage6_cache["data"] is not None and _stage6_cache["mtime"] == mtime:
+            return _stage6_cache["data"]
             
         with open(stage6_path, 'r') as f:
             data = json.load(f)
-            
+        
+        _stage6_cache.update(mtime=mtime, data=data)
         logger.info(f"✅ 成功載入Stage 6數據: {data['dynamic_satellite_pool']['total_selected']} 顆衛星")
         return data
         
@@ -879,3 +984,76 @@ async def get_emergency_backup_satellites(count, min_elevation_deg):
             "warning": "Stage 6預計算數據不可用"
         }
     }
+
+
+# === 回放游標預取 ===
+
+STAGE6_TIME_STEP_SECONDS = 30
+REPLAY_CONSTELLATIONS = ("starlink", "oneweb")
+
+_replay_prefetcher: Optional[ReplayWindowPrefetcher] = None
+# 預取器建立時綁定的 Stage 6 數據；請求端載入到不同物件 (檔案 mtime 變更) 時重建預取器
+_replay_prefetcher_data: Optional[Dict[str, Any]] = None
+
+
+def _reset_replay_prefetcher():
+    """Stage 6 數據更新後丟棄已預取的時間窗 (下次回放查詢時重建)"""
+    global _replay_prefetcher, _replay_prefetcher_data
+    if _replay_prefetcher is not None:
+        _replay_prefetcher.detach()
+        _replay_prefetcher = None
+    _replay_prefetcher_data = None
+
+
+def _stage6_window_origin(stage6_data) -> float:
+    """以 Stage 6 第一個取樣點為切窗原點，使每個時間窗對應一個時間點索引"""
+    try:
+        first_time_str = stage6_data["dynamic_satellite_pool"]["selection_details"][0]["position_timeseries"][0].get("time", "")
+        if first_time_str:
+            origin = datetime.fromisoformat(first_time_str.replace('Z', '+00:00'))
+            if origin.tzinfo is None:
+                origin = origin.replace(tzinfo=timezone.utc)
+            return origin.timestamp()
+    except (KeyError, IndexError, ValueError):
+        pass
+    return 0.0
+
+
+def _get_replay_prefetcher(stage6_data) -> ReplayWindowPrefetcher:
+    """
+    取得綁定 stage6_data 的回放預取器
+
+    數據失效只在請求路徑上判斷：預取回呼只讀取建立時綁定的數據，
+    不會重新載入檔案，也就不會在預取任務內部取消自己。
+    """
+    global _replay_prefetcher, _replay_prefetcher_data
+    if _replay_prefetcher is not None and _replay_prefetcher_data is not stage6_data:
+        _reset_replay_prefetcher()
+    if _replay_prefetcher is None:
+        async def load_window(window_start: datetime) -> Dict[str, List[Dict]]:
+            # 以最寬條件查詢各星座，請求端再依仰角門檻與數量過濾
+            return {
+                name: await query_stage6_satellites_at_time(stage6_data, window_start, 0.0, 10**6, name)
+                for name in REPLAY_CONSTELLATIONS
+            }
+
+        _replay_prefetcher = ReplayWindowPrefetcher(
+            name="stage6_visible_satellites",
+            loader=load_window,
+            window_seconds=STAGE6_TIME_STEP_SECONDS,
+            window_origin=_stage6_window_origin(stage6_data),
+        )
+        _replay_prefetcher_data = stage6_data
+    _replay_prefetcher.start()
+    return _replay_prefetcher
+
+
+async def get_replay_window_satellites(stage6_data, request_time, min_elevation_deg, count, constellation="starlink"):
+    """從回放預取時間窗取得可見衛星 (未預取的星座退回即時查詢)"""
+    window = await _get_replay_prefetcher(stage6_data).get(request_time)
+    satellites = window.get(constellation.lower())
+    if satellites is None:
+        return await query_stage6_satellites_at_time(
+            stage6_data, request_time, min_elevation_deg, count, constellation
+        )
+    return [s for s in satellites if s["elevation_deg"] >= min_elevation_deg][:count]
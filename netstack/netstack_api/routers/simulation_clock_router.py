@@ -0,0 +1,82 @@
+"""
+共享模擬時鐘 API
+提供回放 (N 倍速)、暫停、跳轉與回到即時的控制，以及預取器統計
+"""
+
+from datetime import datetime
+from typing import Any, Dict, Optional
+
+import structlog
+from fastapi import APIRouter, HTTPException
+from pydantic import BaseModel, Field
+
+from ..services.simulation_clock import get_simulation_clock
+
+logger = structlog.get_logger(__name__)
+
+router = APIRouter(prefix="/api/v1/simulation-clock", tags=["模擬時鐘"])
+
+
+# === Request Models ===
+
+class PlayRequest(BaseModel):
+    """開始回放"""
+    rate: Optional[float] = Field(None, gt=0, description="回放倍速，省略則沿用目前倍速")
+    start_time: Optional[datetime] = Field(None, description="回放起始時刻，省略則從目前模擬時刻繼續")
+
+
+class SeekRequest(BaseModel):
+    """跳轉至指定模擬時刻"""
+    time: datetime
+
+
+class RateRequest(BaseModel):
+    """調整回放倍速"""
+    rate: float = Field(..., gt=0)
+
+
+@router.get("/status")
+async def get_clock_status() -> Dict[str, Any]:
+    """目前模擬時鐘狀態與各預取器命中統計"""
+    clock = get_simulation_clock()
+    return {
+        **clock.status(),
+        "prefetchers": {name: p.stats() for name, p in clock.prefetchers.items()},
+    }
+
+
+@router.post("/play")
+async def play(request: PlayRequest) -> Dict[str, Any]:
+    try:
+        return get_simulation_clock().play(rate=request.rate, start_time=request.start_time)
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+
+
+@router.post("/pause")
+async def pause() -> Dict[str, Any]:
+    return get_simulation_clock().pause()
+
+
+@router.post("/resume")
+async def resume() -> Dict[str, Any]:
+    return get_simulation_clock().resume()
+
+
+@router.post("/seek")
+async def seek(request: SeekRequest) -> Dict[str, Any]:
+    return get_simulation_clock().seek(request.time)
+
+
+@router.post("/rate")
+async def set_rate(request: RateRequest) -> Dict[str, Any]:
+    try:
+        return get_simulation_clock().set_rate(request.rate)
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+
+
+@router.post("/live")
+async def go_live() -> Dict[str, Any]:
+    """結束回放，回到牆鐘時間"""
+    return get_simulation_clock().go_live()
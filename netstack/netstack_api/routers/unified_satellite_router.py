@@ -3,17 +3,29 @@
 為前端提供統一的衛星數據API，基於真實TLE和SGP4軌道計算
 """
 
+import json
 from datetime import datetime, timezone
 from typing import List, Dict, Any
-from fastapi import APIRouter, Query, HTTPException
+from fastapi import APIRouter, Query, HTTPException, Response
 import structlog
 
 from .simple_satellite_router import get_visible_satellites
+from ..services.satellite_state_table import encode_json, get_satellite_state_table
 
 logger = structlog.get_logger(__name__)
 
 router = APIRouter(prefix="/api/v1/satellite", tags=["Unified Satellite Data"])
 
+async def _get_visible_satellites(**kwargs) -> Dict[str, Any]:
+    """直接呼叫 simple_satellite_router 端點函數 (補齊觀測點參數，狀態表回應解回字典)"""
+    result = await get_visible_satellites(
+        observer_lat=24.9441667, observer_lon=121.3713889, global_view=False, **kwargs
+    )
+    if isinstance(result, Response):
+        return json.loads(result.body)
+    return result
+
+
 @router.get("/unified")
 async def get_unified_satellite_data(
     time: str = Query("", description="ISO時間戳，空字符串使用當前時間"),
@@ -30,6 +42,30 @@ async def get_unified_satellite_data(
     try:
         logger.info(f"🛰️ 統一衛星數據請求: constellation={constellation}, time={time}")
         
+        # 目前時刻的查詢直接讀共享衛星狀態表
+        if not time:
+            snapshot = get_satellite_state_table().snapshot_for()
+            if snapshot is not None:
+                indices = snapshot.select(constellation=constellation, min_elevation_deg=min_elevation_deg, limit=count)
+                satellites = snapshot.rows(indices, fields=(
+                    ("id", "norad_id"), "norad_id", "name", "elevation_deg", "azimuth_deg",
+                    ("distance_km", "range_km"), "is_visible", "constellation",
+                ))
+                last_updated = snapshot.time.isoformat()
+                for sat in satellites:
+                    sat["last_updated"] = last_updated
+                return Response(content=encode_json({
+                    "satellites": satellites,
+                    "total_count": len(satellites),
+                    "metadata": {
+                        "timestamp": last_updated,
+                        "constellation": constellation,
+                        "min_elevation_deg": min_elevation_deg,
+                        "data_source": "satellite_state_table",
+                        "state_generation": snapshot.generation
+                    }
+                }), media_type="application/json")
+        
         # 處理時間參數
         current_time = datetime.now(timezone.utc).isoformat() + 'Z' if not time else time
         
@@ -37,7 +73,7 @@ async def get_unified_satellite_data(
         
         # 根據星座選擇獲取數據
         if constellation in ["starlink", "both"]:
-            starlink_satellites = await get_visible_satellites(
+            starlink_satellites = await _get_visible_satellites(
                 count=max(15, count//2) if constellation == "both" else count,
                 constellation="starlink",
                 min_elevation_deg=min_elevation_deg,
@@ -59,7 +95,7 @@ async def get_unified_satellite_data(
                 all_satellites.append(unified_sat)
         
         if constellation in ["oneweb", "both"]:
-            oneweb_satellites = await get_visible_satellites(
+            oneweb_satellites = await _get_visible_satellites(
                 count=max(8, count//3) if constellation == "both" else count,
                 constellation="oneweb",
                 min_elevation_deg=min_elevation_deg,
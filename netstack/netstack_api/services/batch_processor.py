@@ -8,6 +8,7 @@
 
 import asyncio
 import asyncpg
+import numpy as np
 import structlog
 from datetime import datetime, timezone, timedelta
 from typing import List, Dict, Any, Optional, Tuple
@@ -452,6 +453,52 @@ class HistoryBatchProcessor:
                 self.logger.error("統計信息獲取失敗", error=str(e))
                 return {"error": str(e)}
     
+    # 預計算窗口欄位：(輸出欄位, 數據表欄位)
+    WINDOW_COLUMNS = (
+        ("timestamp", "timestamp"),
+        ("satellite_id", "satellite_id"),
+        ("norad_id", "norad_id"),
+        ("latitude", "latitude"),
+        ("longitude", "longitude"),
+        ("altitude", "altitude"),
+        ("elevation", "elevation_angle"),
+        ("azimuth", "azimuth_angle"),
+        ("range", "range_rate"),
+        ("signal_strength", "signal_strength"),
+        ("path_loss_db", "path_loss_db"),
+        ("sinr", "sinr"),
+        ("link_margin", "link_margin"),
+        ("data_quality", "data_quality"),
+    )
+    _WINDOW_OBJECT_COLUMNS = {"timestamp", "satellite_id", "norad_id"}
+
+    async def fetch_window_columns(self, constellation: str, observer_coords: Tuple[float, float],
+                                   start_time: datetime, end_time: datetime) -> Dict[str, Any]:
+        """
+        讀取預計算窗口 (時間含端點)，以欄位陣列回傳
+
+        數值欄位為 float64 numpy 陣列 (NULL → NaN)，其餘為列表；
+        依 (時間, 衛星) 排序。
+        """
+        columns_sql = ", ".join(f"{column} AS {name}" for name, column in self.WINDOW_COLUMNS)
+        async with self.connection_pool.acquire() as conn:
+            rows = await conn.fetch(f"""
+                SELECT {columns_sql}
+                FROM satellite_orbital_cache
+                WHERE constellation = $1
+                  AND observer_latitude = $2 AND observer_longitude = $3
+                  AND timestamp BETWEEN $4 AND $5
+                ORDER BY timestamp, satellite_id
+            """, constellation, observer_coords[0], observer_coords[1], start_time, end_time)
+
+        names = [name for name, _ in self.WINDOW_COLUMNS]
+        values = list(zip(*(tuple(row) for row in rows))) if rows else [()] * len(names)
+        return {
+            name: list(column) if name in self._WINDOW_OBJECT_COLUMNS
+            else np.array(column, dtype=np.float64)
+            for name, column in zip(names, values)
+        }
+
     async def _ensure_tables_exist(self) -> None:
         """確保必要的數據表存在"""
         async with self.connection_pool.acquire() as conn:
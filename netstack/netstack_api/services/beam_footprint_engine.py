@@ -0,0 +1,564 @@
+#!/usr/bin/env python3
+"""
+多波束覆蓋引擎與 UE → 波束指派索引
+
+NTN 路徑損耗模型只對單一偏軸角計算衛星天線增益，堆疊中沒有衛星的波束佈局，
+也不知道哪個波束服務哪個 UE。本模組在共享衛星狀態表的每一代快照上：
+- 依星座設定的六角形波束格 (u-v 角度座標) 計算每個波束的指向，與地球交會得到波束中心
+- 以緯經度格網 (每列依緯度調整經度格數) 建立「地面格 → 候選波束」的 CSR 索引
+- UE 查詢只取鄰近格內的候選波束，以 TR 38.811 Bessel 查表方向圖與自由空間損耗計算 RSRP；
+  查詢半徑取本代最大的波束覆蓋半徑，因此與掃描全部波束的結果一致
+
+服務波束與波束切換因此是索引查詢，而不是掃描所有衛星與所有波束。
+attach() 將引擎註冊為狀態表的換代回呼，每代覆蓋在背景更新時即投影完成；
+/api/v1/beams 路由 (routers/beam_footprint_router.py) 提供服務波束查詢與 UE 波束追蹤。
+"""
+
+import math
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+import numpy as np
+import structlog
+
+from ..models.ntn_path_loss_models import (
+    AntennaPattern,
+    ONEWEB_ANTENNA_PATTERN,
+    STARLINK_ANTENNA_PATTERN,
+    TabulatedBeamPattern,
+    get_tabulated_beam_pattern,
+)
+from .satellite_state_table import SatelliteStateSnapshot, SatelliteStateTable, get_satellite_state_table
+
+logger = structlog.get_logger(__name__)
+
+# 波束投影使用球形地球
+EARTH_RADIUS_KM = 6371.0
+KM_PER_DEG = math.pi * EARTH_RADIUS_KM / 180.0
+
+
+@dataclass
+class BeamLayout:
+    """單顆衛星的波束佈局 (同星座共用)"""
+
+    antenna_pattern: AntennaPattern
+    rings: int = 3  # 六角形環數，波束數 = 1 + 3·rings·(rings + 1)
+    beam_spacing_deg: Optional[float] = None  # 相鄰波束指向夾角，預設為 √3/2 倍半功率波束寬度
+    frequency_ghz: float = 2.0
+    tx_power_dbm: float = 33.0  # 每波束發射功率
+    min_elevation_deg: float = 10.0  # UE 對衛星的最低仰角
+    edge_gain_db: float = 10.0  # 增益低於峰值此值以上視為在波束覆蓋外 (不以旁瓣服務)
+
+    @property
+    def spacing_deg(self) -> float:
+        if self.beam_spacing_deg is not None:
+            return self.beam_spacing_deg
+        return self.antenna_pattern.half_power_beamwidth_deg * math.sqrt(3) / 2
+
+    @property
+    def beam_count(self) -> int:
+        return 1 + 3 * self.rings * (self.rings + 1)
+
+    def boresight_offsets(self) -> np.ndarray:
+        """各波束相對天底的 (沿軌, 跨軌) 偏角 (弧度)，第 0 個為天底波束"""
+        offsets = [(0.0, 0.0)]
+        # 六角形格的軸座標 (q, r) 依環展開
+        directions = [(1, 0), (1, -1), (0, -1), (-1, 0), (-1, 1), (0, 1)]
+        for ring in range(1, self.rings + 1):
+            q, r = -ring, ring  # 自 (-1, 1) 方向的角點出發，沿六個方向各走 ring 步
+            for dq, dr in directions:
+                for _ in range(ring):
+                    offsets.append((q + 0.5 * r, r * math.sqrt(3) / 2))
+                    q, r = q + dq, r + dr
+        return np.radians(np.asarray(offsets) * self.spacing_deg)
+
+
+DEFAULT_BEAM_LAYOUTS: Dict[str, BeamLayout] = {
+    "starlink": BeamLayout(STARLINK_ANTENNA_PATTERN, rings=3),
+    "oneweb": BeamLayout(ONEWEB_ANTENNA_PATTERN, rings=2),
+}
+
+
+class BeamFootprintFrame:
+    """
+    某一代快照的波束覆蓋 (建立後唯讀)
+
+    波束以列儲存：所屬衛星列、佈局內編號、指向單位向量、地面中心。
+    beam_row[衛星列, 波束編號] 為波束列索引，指向未與地球交會或中心仰角過低時為 -1。
+    """
+
+    def __init__(self, snapshot: SatelliteStateSnapshot, layouts: Dict[str, BeamLayout],
+                 cell_deg: float = 1.0):
+        self.generation = snapshot.generation
+        self.timestamp = snapshot.timestamp
+        self.satellite_id = snapshot.satellite_id
+        self.cell_deg = float(cell_deg)
+        self._row_by_id: Optional[Dict[str, int]] = None
+
+        self.layout_names: List[str] = []
+        self.patterns: List[TabulatedBeamPattern] = []
+        self.tx_power_dbm: List[float] = []
+        self.frequency_ghz: List[float] = []
+        self.min_elevation_deg: List[float] = []
+        self.edge_gain_db: List[float] = []
+
+        max_beams = max((layout.beam_count for layout in layouts.values()), default=0)
+        self.beam_row = np.full((len(snapshot), max_beams), -1, dtype=np.int64)
+        parts: Dict[str, List[np.ndarray]] = {
+            "satellite": [], "beam_index": [], "layout": [], "boresight": [], "centre": [], "radius": [],
+        }
+        constellation = np.char.lower(snapshot.constellation.astype(str))
+        for name, layout in layouts.items():
+            rows = np.flatnonzero(constellation == name)
+            if rows.size == 0:
+                continue
+            layout_id = len(self.layout_names)
+            self.layout_names.append(name)
+            self.patterns.append(get_tabulated_beam_pattern(layout.antenna_pattern))
+            self.tx_power_dbm.append(layout.tx_power_dbm)
+            self.frequency_ghz.append(layout.frequency_ghz)
+            self.min_elevation_deg.append(layout.min_elevation_deg)
+            self.edge_gain_db.append(layout.edge_gain_db)
+
+            boresight, centre, valid = self._project(snapshot.ecef[rows], snapshot.velocity[rows],
+                                                     layout.boresight_offsets(), layout.min_elevation_deg)
+            sat_idx, beam_idx = np.nonzero(valid)
+            edge_angle = math.radians(self.patterns[-1].edge_angle_deg(layout.edge_gain_db))
+            parts["radius"].append(self._footprint_radius(snapshot.ecef[rows][sat_idx],
+                                                          boresight[sat_idx, beam_idx],
+                                                          centre[sat_idx, beam_idx], edge_angle))
+            parts["satellite"].append(rows[sat_idx])
+            parts["beam_index"].append(beam_idx)
+            parts["layout"].append(np.full(sat_idx.size, layout_id))
+            parts["boresight"].append(boresight[sat_idx, beam_idx])
+            parts["centre"].append(centre[sat_idx, beam_idx])
+
+        if parts["satellite"]:
+            self.beam_satellite = np.concatenate(parts["satellite"]).astype(np.int64)
+            self.beam_index = np.concatenate(parts["beam_index"]).astype(np.int64)
+            self.beam_layout = np.concatenate(parts["layout"]).astype(np.int64)
+            self.boresight = np.concatenate(parts["boresight"])
+            centre = np.concatenate(parts["centre"])
+            self.footprint_radius_km = np.concatenate(parts["radius"])
+        else:
+            self.beam_satellite = self.beam_index = self.beam_layout = np.zeros(0, dtype=np.int64)
+            self.boresight = centre = np.zeros((0, 3))
+            self.footprint_radius_km = np.zeros(0)
+        # UE 查詢半徑：距 UE 超過最大覆蓋半徑的波束不可能在其覆蓋邊緣內
+        self.search_radius_km = float(self.footprint_radius_km.max(initial=0.0))
+        self.beam_row[self.beam_satellite, self.beam_index] = np.arange(self.beam_satellite.size)
+        self.satellite_ecef = snapshot.ecef
+        self.centre_lat = np.degrees(np.arcsin(np.clip(centre[:, 2] / EARTH_RADIUS_KM, -1.0, 1.0)))
+        self.centre_lon = np.degrees(np.arctan2(centre[:, 1], centre[:, 0]))
+        self._build_index()
+
+    def __len__(self) -> int:
+        return int(self.beam_satellite.size)
+
+    def satellite_row(self, satellite_id: str) -> Optional[int]:
+        if self._row_by_id is None:
+            self._row_by_id = {sat_id: i for i, sat_id in enumerate(self.satellite_id.tolist())}
+        return self._row_by_id.get(satellite_id)
+
+    @staticmethod
+    def _project(ecef: np.ndarray, velocity: np.ndarray, offsets: np.ndarray,
+                 min_elevation_deg: float) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """
+        (衛星, 波束) 的指向單位向量、地面交點與有效遮罩
+
+        衛星座標系：天底 n、沿軌 a (速度去除天底分量)、跨軌 c = n × a；
+        波束指向為 n + tan(u)·a + tan(v)·c 正規化 (gnomonic 投影)。
+        """
+        radius = np.linalg.norm(ecef, axis=1, keepdims=True)
+        nadir = -ecef / radius
+        along = velocity - np.sum(velocity * nadir, axis=1, keepdims=True) * nadir
+        along /= np.maximum(np.linalg.norm(along, axis=1, keepdims=True), 1e-12)
+        cross = np.cross(nadir, along)
+
+        tan_u, tan_v = np.tan(offsets[:, 0]), np.tan(offsets[:, 1])
+        direction = (nadir[:, None, :] + tan_u[None, :, None] * along[:, None, :]
+                     + tan_v[None, :, None] * cross[:, None, :])
+        direction /= np.linalg.norm(direction, axis=2, keepdims=True)
+
+        # 射線 r + t·d 與球面 |x| = R 的近端交點
+        b = np.einsum("nk,nbk->nb", ecef, direction)
+        disc = b * b - (radius ** 2 - EARTH_RADIUS_KM ** 2)
+        hit = disc >= 0
+        t = -b - np.sqrt(np.where(hit, disc, 0.0))
+        centre = ecef[:, None, :] + t[..., None] * direction
+        # 波束中心對衛星的仰角：sin(el) = 地面法向 · (-d)
+        sin_el = -np.einsum("nbk,nbk->nb", centre, direction) / EARTH_RADIUS_KM
+        valid = hit & (sin_el >= math.sin(math.radians(min_elevation_deg)))
+        return direction, centre, valid
+
+    @staticmethod
+    def _footprint_radius(sat_ecef: np.ndarray, boresight: np.ndarray, centre: np.ndarray,
+                          edge_angle: float) -> np.ndarray:
+        """
+        波束覆蓋邊緣到中心的地面距離上界
+
+        邊緣錐面 (偏軸角 edge_angle) 與球面交會後，離中心最遠的點在斜向一側；
+        以斜距 × tan(edge) / sin(仰角) 估計並保留 1.5 倍餘量，低仰角波束限制在 2000 km。
+        """
+        slant = np.linalg.norm(centre - sat_ecef, axis=1)
+        sin_el = np.maximum(-np.sum(centre * boresight, axis=1) / EARTH_RADIUS_KM, 0.05)
+        return np.minimum(1.5 * slant * math.tan(edge_angle) / sin_el, 2000.0)
+
+    # ------------------------------------------------------------------
+    # 空間索引
+    # ------------------------------------------------------------------
+
+    def _cell_rows(self, lat: np.ndarray) -> np.ndarray:
+        return np.clip(((lat + 90.0) / self.cell_deg).astype(np.int64), 0, self.n_rows - 1)
+
+    def _build_index(self):
+        """以 CSR 形式儲存「格 → 波束列」：鍵 = 列 × 最大經度格數 + 欄，排序後二分搜尋"""
+        self.n_rows = int(math.ceil(180.0 / self.cell_deg))
+        row_lat = -90.0 + (np.arange(self.n_rows) + 0.5) * self.cell_deg
+        # 每列經度格數依緯度縮減，使各格東西寬度相近
+        self.row_cols = np.maximum(1, np.round(360.0 / self.cell_deg * np.cos(np.radians(row_lat)))).astype(np.int64)
+        self.max_cols = int(self.row_cols.max())
+
+        rows = self._cell_rows(self.centre_lat)
+        cols = (((self.centre_lon + 180.0) / 360.0) * self.row_cols[rows]).astype(np.int64) % self.row_cols[rows]
+        keys = rows * self.max_cols + cols
+        self.index_order = np.argsort(keys, kind="stable")
+        self.index_keys = keys[self.index_order]
+
+    def candidates(self, lat: np.ndarray, lon: np.ndarray,
+                   radius_km: float) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        各查詢點半徑內 (以格近似) 的候選波束
+
+        Returns:
+            (查詢點索引, 波束列)，查詢點索引遞增排序
+        """
+        lat = np.asarray(lat, dtype=np.float64)
+        lon = np.asarray(lon, dtype=np.float64)
+        span = int(math.ceil(radius_km / (self.cell_deg * KM_PER_DEG)))
+        row_offsets = np.arange(-span, span + 1)
+        rows = self._cell_rows(lat)[:, None] + row_offsets[None, :]              # (U, R)
+        in_range = (rows >= 0) & (rows < self.n_rows)
+        rows = np.clip(rows, 0, self.n_rows - 1)
+
+        ncols = self.row_cols[rows]
+        cell_width = 360.0 / ncols
+        centre_col = ((lon[:, None] + 180.0) / cell_width).astype(np.int64) % ncols
+        row_lat = -90.0 + (rows + 0.5) * self.cell_deg
+        half_width = radius_km / (KM_PER_DEG * np.maximum(np.cos(np.radians(np.abs(row_lat) + self.cell_deg / 2)), 1e-3))
+        col_span = np.ceil(half_width / cell_width).astype(np.int64)
+        full_row = 2 * col_span + 1 >= ncols
+        lo = np.where(full_row, 0, centre_col - col_span)
+        hi = np.where(full_row, ncols - 1, centre_col + col_span)
+
+        # 經度跨越 ±180° 時拆成兩段連續鍵區間 (第二段多數情況為空)
+        base = rows * self.max_cols
+        wrap_lo = np.where(lo < 0, lo + ncols, 0)
+        wrap_hi = np.where(lo < 0, ncols - 1, np.where(hi >= ncols, hi - ncols, -1))
+        ranges_lo = base[..., None] + np.stack([np.maximum(lo, 0), wrap_lo], axis=2)
+        ranges_hi = base[..., None] + np.stack([np.minimum(hi, ncols - 1), wrap_hi], axis=2)
+        valid = in_range[..., None] & (ranges_hi >= ranges_lo)
+
+        start = np.searchsorted(self.index_keys, ranges_lo, side="left")
+        end = np.searchsorted(self.index_keys, ranges_hi, side="right")
+        counts = np.where(valid & (end > start), end - start, 0).reshape(len(lat), -1)
+
+        flat_counts = counts.ravel()
+        total = int(flat_counts.sum())
+        owner = np.repeat(np.repeat(np.arange(len(lat)), counts.shape[1]), flat_counts)
+        offsets = np.cumsum(flat_counts) - flat_counts
+        positions = np.arange(total) - np.repeat(offsets, flat_counts) + np.repeat(start.ravel(), flat_counts)
+        return owner, self.index_order[positions]
+
+
+@dataclass
+class BeamAssignment:
+    """UE → 服務波束 (與查詢 UE 順序對齊；無服務時波束列為 -1)"""
+
+    generation: int
+    timestamp: float
+    beam: np.ndarray
+    satellite_id: np.ndarray
+    beam_index: np.ndarray
+    rsrp_dbm: np.ndarray
+    gain_dbi: np.ndarray
+    off_axis_deg: np.ndarray
+    elevation_deg: np.ndarray
+    candidate_count: np.ndarray
+
+    def as_dict(self, i: int) -> Dict[str, Any]:
+        if self.beam[i] < 0:
+            return {"beam": None, "candidates": int(self.candidate_count[i])}
+        return {
+            "satellite_id": str(self.satellite_id[i]),
+            "beam_index": int(self.beam_index[i]),
+            "rsrp_dbm": float(self.rsrp_dbm[i]),
+            "gain_dbi": float(self.gain_dbi[i]),
+            "off_axis_deg": float(self.off_axis_deg[i]),
+            "elevation_deg": float(self.elevation_deg[i]),
+            "candidates": int(self.candidate_count[i]),
+        }
+
+
+@dataclass
+class _CandidateLinks:
+    """(UE, 候選波束) 組合的鏈路量"""
+
+    owner: np.ndarray
+    beam: np.ndarray
+    rsrp_dbm: np.ndarray
+    gain_dbi: np.ndarray
+    off_axis_deg: np.ndarray
+    elevation_deg: np.ndarray
+
+
+class BeamFootprintEngine:
+    """依快照代數快取波束覆蓋，並以空間索引做 UE 波束指派"""
+
+    def __init__(self, layouts: Optional[Dict[str, BeamLayout]] = None, cell_deg: float = 1.0,
+                 search_radius_km: Optional[float] = None, max_cached_frames: int = 4):
+        """
+        Args:
+            layouts: 星座名稱 → 波束佈局
+            cell_deg: 索引格大小 (度)
+            search_radius_km: UE 查詢半徑；預設為本代最大的波束覆蓋半徑
+            max_cached_frames: 保留的快照代數
+        """
+        self.layouts = dict(layouts or DEFAULT_BEAM_LAYOUTS)
+        self.cell_deg = cell_deg
+        self.search_radius_km = search_radius_km
+        self.max_cached_frames = max_cached_frames
+        self._frames: "OrderedDict[int, BeamFootprintFrame]" = OrderedDict()
+        # 換代回呼在狀態表的執行緒池中建立覆蓋，查詢在事件迴圈中讀取
+        self._lock = threading.Lock()
+        self._table: Optional[SatelliteStateTable] = None
+        self._stats = {"frames_built": 0, "queries": 0, "candidate_links": 0}
+
+    def attach(self, table: Optional[SatelliteStateTable] = None) -> None:
+        """註冊為狀態表換代回呼，每一代快照換上時即投影波束覆蓋"""
+        table = table or get_satellite_state_table()
+        if self._table is not None and self._table is not table:
+            self._table.remove_listener(self.frame_for_snapshot)
+        table.add_listener(self.frame_for_snapshot)
+        self._table = table
+        logger.info("波束覆蓋引擎已掛上衛星狀態表", layouts=list(self.layouts))
+
+    def detach(self) -> None:
+        if self._table is not None:
+            self._table.remove_listener(self.frame_for_snapshot)
+            self._table = None
+
+    def frame_for_snapshot(self, snapshot: SatelliteStateSnapshot) -> BeamFootprintFrame:
+        with self._lock:
+            frame = self._frames.get(snapshot.generation)
+            if frame is None:
+                frame = BeamFootprintFrame(snapshot, self.layouts, self.cell_deg)
+                self._frames[snapshot.generation] = frame
+                while len(self._frames) > self.max_cached_frames:
+                    self._frames.popitem(last=False)
+                self._stats["frames_built"] += 1
+                logger.debug("波束覆蓋已更新", generation=snapshot.generation, beams=len(frame))
+            return frame
+
+    def current_frame(self) -> Optional[BeamFootprintFrame]:
+        """共享狀態表目前快照的波束覆蓋 (已 attach 時通常由換代回呼預先建立)"""
+        snapshot = (self._table or get_satellite_state_table()).snapshot
+        if snapshot is None or len(snapshot) == 0:
+            return None
+        return self.frame_for_snapshot(snapshot)
+
+    def candidate_links(self, frame: BeamFootprintFrame, lat: np.ndarray, lon: np.ndarray,
+                        alt_km: Optional[np.ndarray] = None) -> _CandidateLinks:
+        """查詢點鄰近格內的候選波束，計算仰角、偏軸角、增益與 RSRP"""
+        lat = np.atleast_1d(np.asarray(lat, dtype=np.float64))
+        lon = np.atleast_1d(np.asarray(lon, dtype=np.float64))
+        alt_km = np.zeros_like(lat) if alt_km is None else np.broadcast_to(np.asarray(alt_km, dtype=np.float64), lat.shape)
+        radius_km = frame.search_radius_km if self.search_radius_km is None else self.search_radius_km
+        owner, beam = frame.candidates(lat, lon, radius_km)
+
+        lat_r, lon_r = np.radians(lat), np.radians(lon)
+        up = np.stack([np.cos(lat_r) * np.cos(lon_r), np.cos(lat_r) * np.sin(lon_r), np.sin(lat_r)], axis=1)
+        ue_ecef = up * (EARTH_RADIUS_KM + alt_km)[:, None]
+
+        to_ue = ue_ecef[owner] - frame.satellite_ecef[frame.beam_satellite[beam]]
+        range_km = np.linalg.norm(to_ue, axis=1)
+        direction = to_ue / np.maximum(range_km, 1e-9)[:, None]
+        elevation = np.degrees(np.arcsin(np.clip(-np.sum(direction * up[owner], axis=1), -1.0, 1.0)))
+        off_axis = np.degrees(np.arccos(np.clip(np.sum(direction * frame.boresight[beam], axis=1), -1.0, 1.0)))
+
+        layout = frame.beam_layout[beam]
+        gain = np.empty(beam.size)
+        rsrp = np.empty(beam.size)
+        keep = np.zeros(beam.size, dtype=bool)
+        for layout_id, pattern in enumerate(frame.patterns):
+            mask = layout == layout_id
+            if not mask.any():
+                continue
+            gain[mask] = pattern.gain_db(off_axis[mask])
+            fspl = 20 * np.log10(range_km[mask]) + 20 * math.log10(frame.frequency_ghz[layout_id]) + 92.45
+            rsrp[mask] = frame.tx_power_dbm[layout_id] + gain[mask] - fspl
+            keep[mask] = ((elevation[mask] >= frame.min_elevation_deg[layout_id])
+                          & (gain[mask] >= pattern.max_gain_dbi - frame.edge_gain_db[layout_id]))
+
+        self._stats["queries"] += int(lat.size)
+        self._stats["candidate_links"] += int(keep.sum())
+        return _CandidateLinks(owner[keep], beam[keep], rsrp[keep], gain[keep], off_axis[keep], elevation[keep])
+
+    def assign(self, frame: BeamFootprintFrame, lat: np.ndarray, lon: np.ndarray,
+               alt_km: Optional[np.ndarray] = None) -> BeamAssignment:
+        """各查詢點 RSRP 最強的波束"""
+        lat = np.atleast_1d(np.asarray(lat, dtype=np.float64))
+        links = self.candidate_links(frame, lat, lon, alt_km)
+        best = _best_per_owner(links.owner, links.rsrp_dbm)
+        return _assignment_from_links(frame, links, best, lat.size)
+
+    def get_stats(self) -> Dict[str, Any]:
+        with self._lock:
+            cached = list(self._frames)
+        return {
+            **self._stats,
+            "attached": self._table is not None,
+            "cached_generations": cached,
+            "layouts": {name: layout.beam_count for name, layout in self.layouts.items()},
+        }
+
+
+def _best_per_owner(owner: np.ndarray, score: np.ndarray) -> np.ndarray:
+    """每個 owner 分數最高的組合位置 (owner 已遞增排序)"""
+    if owner.size == 0:
+        return np.zeros(0, dtype=np.int64)
+    order = np.lexsort((-score, owner))
+    first = np.r_[True, owner[order][1:] != owner[order][:-1]]
+    return order[first]
+
+
+def _assignment_from_links(frame: BeamFootprintFrame, links: _CandidateLinks, picks: np.ndarray,
+                           count: int) -> BeamAssignment:
+    beam = np.full(count, -1, dtype=np.int64)
+    rsrp = np.full(count, np.nan)
+    gain = np.full(count, np.nan)
+    off_axis = np.full(count, np.nan)
+    elevation = np.full(count, np.nan)
+    owners = links.owner[picks]
+    beam[owners] = links.beam[picks]
+    rsrp[owners] = links.rsrp_dbm[picks]
+    gain[owners] = links.gain_dbi[picks]
+    off_axis[owners] = links.off_axis_deg[picks]
+    elevation[owners] = links.elevation_deg[picks]
+
+    served = beam >= 0
+    satellite_id = np.full(count, None, dtype=object)
+    satellite_id[served] = frame.satellite_id[frame.beam_satellite[beam[served]]]
+    beam_index = np.full(count, -1, dtype=np.int64)
+    beam_index[served] = frame.beam_index[beam[served]]
+    return BeamAssignment(frame.generation, frame.timestamp, beam, satellite_id, beam_index, rsrp, gain,
+                          off_axis, elevation, np.bincount(links.owner, minlength=count))
+
+
+class BeamAssignmentTracker:
+    """
+    逐 UE 服務波束與波束切換
+
+    目前服務波束仍是候選且 RSRP 不低於最佳候選 hysteresis_db 以上時維持服務，
+    否則切換到最佳候選並產生切換事件 (同衛星換波束或換衛星)。
+    """
+
+    def __init__(self, engine: BeamFootprintEngine, hysteresis_db: float = 3.0):
+        self.engine = engine
+        self.hysteresis_db = hysteresis_db
+        self.serving: Dict[str, Tuple[str, int]] = {}
+        self.statistics = {"updates": 0, "beam_switches": 0, "satellite_switches": 0, "beam_losses": 0}
+
+    def update(self, frame: BeamFootprintFrame, ue_ids: Sequence[str], lat: np.ndarray, lon: np.ndarray,
+               alt_km: Optional[np.ndarray] = None) -> Tuple[BeamAssignment, List[Dict[str, Any]]]:
+        """
+        以新一代波束覆蓋更新 UE 服務波束
+
+        Returns:
+            (服務波束指派, 切換事件)
+        """
+        lat = np.atleast_1d(np.asarray(lat, dtype=np.float64))
+        count = lat.size
+        links = self.engine.candidate_links(frame, lat, lon, alt_km)
+        best = _best_per_owner(links.owner, links.rsrp_dbm)
+
+        # 目前服務波束在本代覆蓋中的波束列 (衛星不在快照或波束無覆蓋時為 -1)
+        current = np.full(count, -1, dtype=np.int64)
+        for i, ue_id in enumerate(ue_ids):
+            key = self.serving.get(ue_id)
+            if key is None:
+                continue
+            sat_row = frame.satellite_row(key[0])
+            if sat_row is not None and key[1] < frame.beam_row.shape[1]:
+                current[i] = frame.beam_row[sat_row, key[1]]
+        is_current = (current[links.owner] >= 0) & (links.beam == current[links.owner])
+        current_pos = np.full(count, -1, dtype=np.int64)
+        current_pos[links.owner[is_current]] = np.flatnonzero(is_current)
+
+        picks = np.full(count, -1, dtype=np.int64)
+        picks[links.owner[best]] = best
+        keep = (current_pos >= 0) & (picks >= 0)
+        keep[keep] = links.rsrp_dbm[current_pos[keep]] >= links.rsrp_dbm[picks[keep]] - self.hysteresis_db
+        picks = np.where(keep, current_pos, picks)
+        assignment = _assignment_from_links(frame, links, picks[picks >= 0], count)
+
+        events = []
+        for i, ue_id in enumerate(ue_ids):
+            previous = self.serving.get(ue_id)
+            if assignment.beam[i] < 0:
+                if previous is not None:
+                    self.serving.pop(ue_id)
+                    self.statistics["beam_losses"] += 1
+                    events.append(self._event("beam_lost", ue_id, previous, None, assignment, i))
+                continue
+            target = (str(assignment.satellite_id[i]), int(assignment.beam_index[i]))
+            if previous == target:
+                continue
+            self.serving[ue_id] = target
+            if previous is None:
+                events.append(self._event("beam_acquired", ue_id, None, target, assignment, i))
+                continue
+            inter_satellite = previous[0] != target[0]
+            self.statistics["beam_switches"] += 1
+            self.statistics["satellite_switches"] += int(inter_satellite)
+            events.append(self._event("inter_satellite" if inter_satellite else "intra_satellite",
+                                      ue_id, previous, target, assignment, i))
+        self.statistics["updates"] += 1
+        return assignment, events
+
+    @staticmethod
+    def _event(event_type: str, ue_id: str, source: Optional[Tuple[str, int]],
+               target: Optional[Tuple[str, int]], assignment: BeamAssignment, i: int) -> Dict[str, Any]:
+        return {
+            "type": event_type,
+            "ue_id": ue_id,
+            "source": {"satellite_id": source[0], "beam_index": source[1]} if source else None,
+            "target": {"satellite_id": target[0], "beam_index": target[1]} if target else None,
+            "rsrp_dbm": None if target is None else float(assignment.rsrp_dbm[i]),
+            "generation": assignment.generation,
+            "timestamp": assignment.timestamp,
+        }
+
+    def forget(self, ue_id: str) -> None:
+        self.serving.pop(ue_id, None)
+
+
+# 進程級波束覆蓋引擎與 UE 波束追蹤實例
+_beam_footprint_engine: Optional[BeamFootprintEngine] = None
+_beam_assignment_tracker: Optional[BeamAssignmentTracker] = None
+
+
+def get_beam_footprint_engine() -> BeamFootprintEngine:
+    global _beam_footprint_engine
+    if _beam_footprint_engine is None:
+        _beam_footprint_engine = BeamFootprintEngine()
+    return _beam_footprint_engine
+
+
+def get_beam_assignment_tracker() -> BeamAssignmentTracker:
+    global _beam_assignment_tracker
+    if _beam_assignment_tracker is None:
+        _beam_assignment_tracker = BeamAssignmentTracker(get_beam_footprint_engine())
+    return _beam_assignment_tracker
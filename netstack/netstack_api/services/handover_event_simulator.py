@@ -0,0 +1,601 @@
+#!/usr/bin/env python3
+"""
+換手方案離散事件模擬器 (Monte-Carlo)
+
+以虛擬時鐘與時間排序事件佇列模擬四種換手方案，取代即時抽樣固定常態分佈：
+- UE 量測：服務衛星仰角降到觸發門檻後，經 TTT 與週期報告對齊才送出量測報告
+- 信令延遲：每段訊息依當下衛星幾何計算傳播延遲 (服務鏈路 / 饋線 / ISL / 地面網路)，
+  加上節點處理延遲 (對數常態) 與空口 HARQ 重傳
+- 方案程序：NTN / NTN-GS / NTN-SMN / Proposed 各自的訊息序列
+- 失敗模式：重傳用盡 (FAILURE)、T304 逾時 (TIMEOUT)、源衛星仰角低於最低仰角 (RLF)
+
+每個 replication 使用獨立隨機種子，可在多個行程平行執行；結果以
+HandoverMeasurement.export_sketches() 相同格式返回，直接合併後
+交給 generate_comparison_report()。
+"""
+
+import heapq
+import itertools
+import math
+import os
+import time
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import asdict, dataclass
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+import numpy as np
+import structlog
+
+from .handover_measurement_service import (
+    HandoverMeasurement,
+    HandoverResult,
+    HandoverScheme,
+    SchemeAccumulator,
+)
+from .latency_sketch import WindowedLatencySketches
+
+logger = structlog.get_logger(__name__)
+
+EARTH_RADIUS_KM = 6371.0
+EARTH_MU_KM3_S2 = 398600.4418
+SPEED_OF_LIGHT_KM_S = 299792.458
+
+
+@dataclass
+class SimulationConfig:
+    """模擬配置 (時間單位：秒，延遲參數單位：毫秒)"""
+
+    duration_seconds: float = 86400.0
+    ue_count: int = 10
+    schemes: Tuple[str, ...] = tuple(s.value for s in HandoverScheme)
+    start_timestamp: float = 1_735_689_600.0  # 2025-01-01T00:00:00Z，虛擬時鐘起點
+
+    # 星座幾何 (圓軌道)
+    altitude_km: float = 550.0
+    trigger_elevation_deg: float = 20.0  # 服務衛星低於此仰角時鄰星條件成立
+    min_elevation_deg: float = 10.0  # 低於此仰角視為無線鏈路失敗
+    gs_min_elevation_deg: float = 25.0
+    isl_hop_km: float = 2000.0
+    max_isl_hops: int = 2
+    terrestrial_delay_ms: float = 5.0
+
+    # UE 量測 (3GPP TS 38.331)
+    time_to_trigger_ms: float = 100.0
+    report_interval_ms: float = 120.0
+    ssb_period_ms: float = 20.0
+    rach_period_ms: float = 10.0
+    t304_ms: float = 1000.0
+    reestablishment_ms: float = 800.0
+
+    # 節點處理延遲中位數與對數常態離散度
+    ue_processing_ms: float = 10.0
+    gnb_processing_ms: float = 4.0
+    sat_gnb_processing_ms: float = 6.0
+    core_processing_ms: float = 25.0
+    processing_sigma: float = 0.35
+
+    # 空口重傳
+    air_loss_probability: float = 0.05  # 天頂方向單次傳輸失敗機率，低仰角依餘割放大
+    harq_rtt_ms: float = 8.0
+    max_retransmissions: int = 2
+
+    # 本論文方案
+    prediction_accuracy: float = 0.96
+    prediction_precision_ms: float = 10.0
+
+    # 鏈路預算 (量測/吞吐量指標)
+    carrier_frequency_ghz: float = 2.0
+    eirp_dbm: float = 45.8
+    noise_floor_dbm: float = -125.0
+    bandwidth_mhz: float = 20.0
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> "SimulationConfig":
+        values = dict(data)
+        if "schemes" in values:
+            values["schemes"] = tuple(values["schemes"])
+        return cls(**values)
+
+
+# ----------------------------------------------------------------------
+# 離散事件核心
+# ----------------------------------------------------------------------
+
+
+class EventKernel:
+    """時間排序事件佇列 + 虛擬時鐘"""
+
+    def __init__(self, start_time: float = 0.0):
+        self.now = start_time
+        self._queue: List[Tuple[float, int, Callable, tuple]] = []
+        self._sequence = itertools.count()
+        self.processed = 0
+
+    def schedule_at(self, when: float, callback: Callable, *args):
+        heapq.heappush(self._queue, (when, next(self._sequence), callback, args))
+
+    def schedule(self, delay: float, callback: Callable, *args):
+        self.schedule_at(self.now + delay, callback, *args)
+
+    def run(self, until: float):
+        queue = self._queue
+        while queue and queue[0][0] <= until:
+            when, _, callback, args = heapq.heappop(queue)
+            self.now = when
+            callback(*args)
+            self.processed += 1
+        self.now = until
+
+
+# ----------------------------------------------------------------------
+# 衛星過境幾何
+# ----------------------------------------------------------------------
+
+
+class PassGeometry:
+    """
+    圓軌道單次過境幾何
+
+    以過境中心 (最高仰角) 的地心角 lambda_min 描述過境；
+    沿軌道地心角 x 的位置滿足 cos(lambda) = cos(lambda_min) * cos(x)。
+    """
+
+    def __init__(self, altitude_km: float):
+        self.orbit_radius = EARTH_RADIUS_KM + altitude_km
+        self.angular_rate = math.sqrt(EARTH_MU_KM3_S2 / self.orbit_radius ** 3)
+        self._ratio = EARTH_RADIUS_KM / self.orbit_radius
+
+    def central_angle(self, elevation_deg: float) -> float:
+        e = math.radians(elevation_deg)
+        return math.acos(self._ratio * math.cos(e)) - e
+
+    def along_track_angle(self, elevation_deg: float, lambda_min: float) -> float:
+        """仰角達到 elevation_deg 時距過境中心的沿軌道角 (rad)"""
+        ratio = math.cos(self.central_angle(elevation_deg)) / math.cos(lambda_min)
+        return math.acos(min(1.0, ratio))
+
+    def elevation_deg(self, lambda_min: float, x: float) -> float:
+        cos_lambda = math.cos(lambda_min) * math.cos(x)
+        sin_lambda = math.sqrt(max(0.0, 1.0 - cos_lambda * cos_lambda))
+        return math.degrees(math.atan2(cos_lambda - self._ratio, sin_lambda))
+
+    def slant_range_km(self, lambda_min: float, x: float) -> float:
+        cos_lambda = math.cos(lambda_min) * math.cos(x)
+        return math.sqrt(EARTH_RADIUS_KM ** 2 + self.orbit_radius ** 2
+                         - 2 * EARTH_RADIUS_KM * self.orbit_radius * cos_lambda)
+
+    def slant_range_at_elevation_km(self, elevation_deg: float) -> float:
+        return self.slant_range_km(self.central_angle(elevation_deg), 0.0)
+
+
+@dataclass
+class SatellitePass:
+    """UE 視角下的一次衛星過境 (x = x0 + angular_rate * (t - t0))"""
+
+    satellite_id: int
+    lambda_min: float
+    x0: float
+    t0: float
+
+    def x_at(self, t: float, angular_rate: float) -> float:
+        return self.x0 + angular_rate * (t - self.t0)
+
+
+# ----------------------------------------------------------------------
+# 方案程序
+# ----------------------------------------------------------------------
+
+
+@dataclass(frozen=True)
+class ProcedureStep:
+    """一個信令步驟：等待對齊 → 沿路徑傳送 → 節點處理"""
+
+    name: str
+    path: Tuple[str, ...] = ()  # service_src / service_tgt / feeder / isl / terrestrial
+    node: Optional[str] = None  # ue / gnb / sat_gnb / core
+    wait: Optional[str] = None  # ssb / rach
+    requires_source: bool = False  # 需要源鏈路仍存在
+    starts_t304: bool = False
+
+
+_BASELINE_PROCEDURE = (
+    ProcedureStep("measurement_report", ("service_src", "feeder"), "gnb", requires_source=True),
+    ProcedureStep("handover_request", ("terrestrial", "terrestrial"), "core"),
+    ProcedureStep("admission_control", ("terrestrial",), "gnb"),
+    ProcedureStep("handover_command", ("terrestrial", "terrestrial"), "core"),
+    ProcedureStep("rrc_reconfiguration", ("feeder", "service_src"), "ue",
+                  requires_source=True, starts_t304=True),
+    ProcedureStep("downlink_sync", wait="ssb"),
+    ProcedureStep("rach_msg1_msg2", ("service_tgt", "feeder", "feeder", "service_tgt"), "gnb", wait="rach"),
+    ProcedureStep("rach_msg3_msg4", ("service_tgt", "feeder", "feeder", "service_tgt"), "gnb"),
+    ProcedureStep("rrc_reconfiguration_complete", ("service_tgt", "feeder"), "gnb"),
+    ProcedureStep("path_switch", ("terrestrial", "terrestrial", "terrestrial", "terrestrial"), "core"),
+)
+
+_GS_PROCEDURE = (
+    ProcedureStep("measurement_report", ("service_src", "feeder"), "gnb", requires_source=True),
+    ProcedureStep("admission_control", (), "gnb"),
+    ProcedureStep("rrc_reconfiguration", ("feeder", "service_src"), "ue",
+                  requires_source=True, starts_t304=True),
+    ProcedureStep("downlink_sync", wait="ssb"),
+    ProcedureStep("rach_msg1_msg2", ("service_tgt", "feeder", "feeder", "service_tgt"), "gnb", wait="rach"),
+    ProcedureStep("rach_msg3_msg4", ("service_tgt", "feeder", "feeder", "service_tgt"), "gnb"),
+    ProcedureStep("rrc_reconfiguration_complete", ("service_tgt", "feeder"), "gnb"),
+    ProcedureStep("ground_station_context_update", ("terrestrial", "terrestrial"), "core"),
+)
+
+_SMN_PROCEDURE = (
+    ProcedureStep("measurement_report", ("service_src",), "sat_gnb", requires_source=True),
+    ProcedureStep("handover_request", ("isl",), "sat_gnb"),
+    ProcedureStep("handover_request_ack", ("isl",), "sat_gnb"),
+    ProcedureStep("rrc_reconfiguration", ("service_src",), "ue", requires_source=True, starts_t304=True),
+    ProcedureStep("downlink_sync", wait="ssb"),
+    ProcedureStep("rach_msg1_msg2", ("service_tgt", "service_tgt"), "sat_gnb", wait="rach"),
+    ProcedureStep("rach_msg3_msg4", ("service_tgt", "service_tgt"), "sat_gnb"),
+    ProcedureStep("rrc_reconfiguration_complete", ("service_tgt",), "sat_gnb"),
+    ProcedureStep("path_switch", ("feeder", "terrestrial", "terrestrial", "feeder"), "core"),
+)
+
+# 預測式換手：目標衛星與時間點事先算出並完成準備，觸發時免 RACH 同步
+_PROPOSED_PROCEDURE = (
+    ProcedureStep("downlink_sync", wait="ssb", starts_t304=True),
+    ProcedureStep("ue_target_switch", (), "ue"),
+    ProcedureStep("rrc_reconfiguration_complete", ("service_tgt",), "sat_gnb"),
+)
+
+# 預測錯誤時改走衛星網路內換手程序 (重新準備 + RACH)
+_PROPOSED_FALLBACK = _SMN_PROCEDURE[1:]
+
+SCHEME_PROCEDURES: Dict[HandoverScheme, Tuple[ProcedureStep, ...]] = {
+    HandoverScheme.NTN_BASELINE: _BASELINE_PROCEDURE,
+    HandoverScheme.NTN_GS: _GS_PROCEDURE,
+    HandoverScheme.NTN_SMN: _SMN_PROCEDURE,
+    HandoverScheme.PROPOSED: _PROPOSED_PROCEDURE,
+}
+
+_AIR_SEGMENTS = ("service_src", "service_tgt", "feeder")
+
+
+# ----------------------------------------------------------------------
+# UE 程序
+# ----------------------------------------------------------------------
+
+
+@dataclass
+class _HandoverAttempt:
+    start: float
+    steps: Tuple[ProcedureStep, ...]
+    target: SatellitePass
+    feeder_range_km: float
+    isl_range_km: float
+    step_index: int = 0
+    t304_start: Optional[float] = None
+    predicted: bool = True
+    binary_search_iterations: Optional[int] = None
+
+
+@dataclass
+class _UEProcess:
+    ue_index: int
+    scheme: HandoverScheme
+    serving: SatellitePass
+    attempt: Optional[_HandoverAttempt] = None
+    handovers: int = 0
+
+
+class HandoverEventSimulator:
+    """單一 replication：所有 (UE, 方案) 程序共用一個事件核心與虛擬時鐘"""
+
+    def __init__(self, config: SimulationConfig, seed: Any = None):
+        self.config = config
+        self.rng = np.random.default_rng(seed)
+        self.kernel = EventKernel(0.0)
+        self.geometry = PassGeometry(config.altitude_km)
+        self.schemes = [HandoverScheme(value) for value in config.schemes]
+
+        self.sketches = WindowedLatencySketches()
+        self.accumulators = {scheme: SchemeAccumulator() for scheme in self.schemes}
+        self.outcomes = {scheme: {r.value: 0 for r in HandoverResult} for scheme in self.schemes}
+        self._satellite_ids = itertools.count(1)
+
+        self._trigger_lambda = self.geometry.central_angle(config.trigger_elevation_deg + 5.0)
+        self._lognormal_mu = {
+            "ue": math.log(config.ue_processing_ms),
+            "gnb": math.log(config.gnb_processing_ms),
+            "sat_gnb": math.log(config.sat_gnb_processing_ms),
+            "core": math.log(config.core_processing_ms),
+        }
+        self._gs_lambda_max = self.geometry.central_angle(config.gs_min_elevation_deg)
+
+    # ------------------------------------------------------------------
+    # 隨機幾何
+    # ------------------------------------------------------------------
+
+    def _new_pass(self, attach_time: float) -> SatellitePass:
+        """新過境：最高仰角至少高於觸發門檻 5°，UE 於上升段跨過觸發門檻時附著"""
+        lambda_min = float(self.rng.uniform(0.0, self._trigger_lambda))
+        x_trigger = self.geometry.along_track_angle(self.config.trigger_elevation_deg, lambda_min)
+        return SatellitePass(next(self._satellite_ids), lambda_min, -x_trigger, attach_time)
+
+    def _time_at_elevation(self, sat: SatellitePass, elevation_deg: float) -> float:
+        """下降段到達指定仰角的時間"""
+        x = self.geometry.along_track_angle(elevation_deg, sat.lambda_min)
+        return sat.t0 + (x - sat.x0) / self.geometry.angular_rate
+
+    def _range_km(self, sat: SatellitePass, t: float) -> float:
+        return self.geometry.slant_range_km(sat.lambda_min, sat.x_at(t, self.geometry.angular_rate))
+
+    def _elevation(self, sat: SatellitePass, t: float) -> float:
+        return self.geometry.elevation_deg(sat.lambda_min, sat.x_at(t, self.geometry.angular_rate))
+
+    def _processing_ms(self, node: str) -> float:
+        return float(self.rng.lognormal(self._lognormal_mu[node], self.config.processing_sigma))
+
+    # ------------------------------------------------------------------
+    # 程序
+    # ------------------------------------------------------------------
+
+    def start(self):
+        for ue_index in range(self.config.ue_count):
+            for scheme in self.schemes:
+                # 錯開起始相位：第一次過境從隨機位置開始
+                first = self._new_pass(0.0)
+                elapsed = float(self.rng.uniform(0.0, self._time_at_elevation(first, self.config.trigger_elevation_deg)))
+                first.t0 -= elapsed
+                process = _UEProcess(ue_index, scheme, first)
+                self._schedule_trigger(process)
+
+    def _schedule_trigger(self, process: _UEProcess):
+        """觸發條件成立 + TTT + 週期報告對齊後送出量測報告"""
+        config = self.config
+        condition_time = max(self.kernel.now,
+                             self._time_at_elevation(process.serving, config.trigger_elevation_deg))
+        report_delay = (config.time_to_trigger_ms + self.rng.uniform(0.0, config.report_interval_ms)) / 1000.0
+        self.kernel.schedule_at(condition_time + report_delay, self._on_measurement_report, process)
+
+    def _on_measurement_report(self, process: _UEProcess):
+        config = self.config
+        now = self.kernel.now
+        target = self._new_pass(now)
+        gs_lambda = float(self.rng.uniform(0.0, self._gs_lambda_max))
+        attempt = _HandoverAttempt(
+            start=now,
+            steps=SCHEME_PROCEDURES[process.scheme],
+            target=target,
+            feeder_range_km=self.geometry.slant_range_km(gs_lambda, 0.0),
+            isl_range_km=config.isl_hop_km * int(self.rng.integers(1, config.max_isl_hops + 1)),
+        )
+        if process.scheme == HandoverScheme.PROPOSED:
+            # 二分搜尋預測換手時間點：迭代次數取決於預測窗口長度與精度
+            window_ms = (self._time_at_elevation(process.serving, config.min_elevation_deg) - process.serving.t0) * 1000
+            attempt.binary_search_iterations = max(1, math.ceil(math.log2(max(window_ms, 1.0)
+                                                                         / config.prediction_precision_ms)))
+            if self.rng.random() >= config.prediction_accuracy:
+                attempt.predicted = False
+                attempt.steps = attempt.steps + _PROPOSED_FALLBACK
+        process.attempt = attempt
+        self.kernel.schedule(0.0, self._run_step, process)
+
+    def _segment_ms(self, segment: str, process: _UEProcess, attempt: _HandoverAttempt,
+                    t: float) -> Tuple[float, bool]:
+        """單段傳播 (含 HARQ 重傳)；返回 (延遲 ms, 是否成功)"""
+        if segment == "terrestrial":
+            return self.config.terrestrial_delay_ms, True
+        if segment == "isl":
+            return attempt.isl_range_km / SPEED_OF_LIGHT_KM_S * 1000.0, True
+
+        if segment == "service_src":
+            sat = process.serving
+            range_km = self._range_km(sat, t)
+            elevation = self._elevation(sat, t)
+        elif segment == "service_tgt":
+            sat = attempt.target
+            range_km = self._range_km(sat, t)
+            elevation = self._elevation(sat, t)
+        else:
+            range_km = attempt.feeder_range_km
+            elevation = 90.0
+        one_way = range_km / SPEED_OF_LIGHT_KM_S * 1000.0
+
+        loss = min(0.5, self.config.air_loss_probability / max(math.sin(math.radians(max(elevation, 1.0))), 0.05))
+        delay = one_way
+        for _ in range(self.config.max_retransmissions):
+            if self.rng.random() >= loss:
+                return delay, True
+            delay += self.config.harq_rtt_ms + 2 * one_way
+        return delay, self.rng.random() >= loss
+
+    def _run_step(self, process: _UEProcess):
+        attempt = process.attempt
+        now = self.kernel.now
+        config = self.config
+
+        if attempt.step_index >= len(attempt.steps):
+            self._finish(process, HandoverResult.SUCCESS)
+            return
+
+        step = attempt.steps[attempt.step_index]
+        if step.requires_source and self._elevation(process.serving, now) < config.min_elevation_deg:
+            self._finish(process, HandoverResult.FAILURE, "radio_link_failure")
+            return
+        if step.starts_t304:
+            attempt.t304_start = now
+
+        delay_ms = 0.0
+        if step.wait == "ssb":
+            delay_ms += self.rng.uniform(0.0, config.ssb_period_ms)
+        elif step.wait == "rach":
+            delay_ms += self.rng.uniform(0.0, config.rach_period_ms)
+
+        for segment in step.path:
+            segment_ms, delivered = self._segment_ms(segment, process, attempt, now + delay_ms / 1000.0)
+            delay_ms += segment_ms
+            if not delivered:
+                self._finish_after(process, delay_ms, HandoverResult.FAILURE, "retransmissions_exhausted")
+                return
+        if step.node:
+            delay_ms += self._processing_ms(step.node)
+
+        attempt.step_index += 1
+        if attempt.t304_start is not None and (now + delay_ms / 1000.0 - attempt.t304_start) * 1000 > config.t304_ms:
+            timeout_at = attempt.t304_start + config.t304_ms / 1000.0
+            self.kernel.schedule_at(max(timeout_at, now), self._finish, process, HandoverResult.TIMEOUT, "t304_expiry")
+            return
+        self.kernel.schedule(delay_ms / 1000.0, self._run_step, process)
+
+    def _finish_after(self, process: _UEProcess, delay_ms: float, result: HandoverResult, reason: str):
+        self.kernel.schedule(delay_ms / 1000.0, self._finish, process, result, reason)
+
+    def _finish(self, process: _UEProcess, result: HandoverResult, reason: Optional[str] = None):
+        now = self.kernel.now
+        attempt = process.attempt
+        config = self.config
+        latency_ms = (now - attempt.start) * 1000.0
+
+        target = attempt.target
+        range_km = self._range_km(target, now)
+        rsrp = (config.eirp_dbm - 32.45 - 20 * math.log10(config.carrier_frequency_ghz * 1000.0)
+                - 20 * math.log10(range_km))
+        snr_db = rsrp - config.noise_floor_dbm
+        metrics = {
+            "signal_strength_dbm": rsrp,
+            "throughput_mbps": config.bandwidth_mhz * math.log2(1.0 + 10 ** (snr_db / 10.0)) * 0.75,
+            "packet_loss_rate": min(1.0, latency_ms / 1000.0 * 0.01),
+        }
+        if process.scheme == HandoverScheme.PROPOSED:
+            metrics["prediction_accuracy"] = config.prediction_accuracy if attempt.predicted else 0.0
+            metrics["binary_search_iterations"] = attempt.binary_search_iterations
+
+        scheme = process.scheme
+        self.sketches.record(scheme.value, latency_ms, config.start_timestamp + attempt.start)
+        self.accumulators[scheme].add_values(result == HandoverResult.SUCCESS, **metrics)
+        self.outcomes[scheme][result.value] += 1
+        process.handovers += 1
+        process.attempt = None
+
+        # 成功：切到目標衛星；失敗：RRC 重建後附著到目標衛星
+        if result == HandoverResult.SUCCESS:
+            process.serving = target
+            self._schedule_trigger(process)
+        else:
+            self.kernel.schedule(config.reestablishment_ms / 1000.0, self._reattach, process, target)
+
+    def _reattach(self, process: _UEProcess, target: SatellitePass):
+        process.serving = target
+        self._schedule_trigger(process)
+
+    def run(self) -> Dict[str, Any]:
+        started = time.perf_counter()
+        self.start()
+        self.kernel.run(self.config.duration_seconds)
+        elapsed = time.perf_counter() - started
+        return {
+            "latency_sketches": self.sketches.to_dict(),
+            "accumulators": {scheme.value: asdict(acc) for scheme, acc in self.accumulators.items()},
+            "total_events": sum(acc.total_handovers for acc in self.accumulators.values()),
+            "outcomes": {scheme.value: counts for scheme, counts in self.outcomes.items()},
+            "kernel_events": self.kernel.processed,
+            "wall_time_s": elapsed,
+        }
+
+
+# ----------------------------------------------------------------------
+# 平行 Monte-Carlo
+# ----------------------------------------------------------------------
+
+
+def _run_replication(config_data: Dict[str, Any], seed: np.random.SeedSequence) -> Dict[str, Any]:
+    """行程池工作函數 (需為模組層級以便序列化)"""
+    config = SimulationConfig.from_dict(config_data)
+    return HandoverEventSimulator(config, seed).run()
+
+
+def _replication_summary(results: List[Dict[str, Any]]) -> Dict[str, Any]:
+    """跨 replication 的方案平均延遲與 95% 信賴區間"""
+    summary = {}
+    for scheme in HandoverScheme:
+        means = []
+        for result in results:
+            totals = result["latency_sketches"]["totals"].get(scheme.value)
+            if totals and totals["count"]:
+                means.append(totals["total"] / totals["count"])
+        if not means:
+            continue
+        mean = float(np.mean(means))
+        half_width = 1.96 * float(np.std(means, ddof=1)) / math.sqrt(len(means)) if len(means) > 1 else 0.0
+        summary[scheme.value] = {
+            "replications": len(means),
+            "mean_latency_ms": mean,
+            "ci95_low_ms": mean - half_width,
+            "ci95_high_ms": mean + half_width,
+        }
+    return summary
+
+
+def run_monte_carlo(
+    config: SimulationConfig,
+    replications: int = 8,
+    seed: int = 0,
+    max_workers: Optional[int] = None,
+    measurement: Optional[HandoverMeasurement] = None,
+) -> Dict[str, Any]:
+    """
+    以獨立種子平行執行多個 replication，並合併到 HandoverMeasurement
+
+    Args:
+        config: 模擬配置
+        replications: replication 數量
+        seed: 主種子 (以 SeedSequence.spawn 派生各 replication 的獨立串流)
+        max_workers: 行程數 (None = CPU 核心數；1 = 在目前行程依序執行)
+        measurement: 合併目標；None 時建立不保留原始事件的新實例
+
+    Returns:
+        {"measurement": HandoverMeasurement, "replications": [...], "summary": {...}}
+    """
+    seeds = np.random.SeedSequence(seed).spawn(replications)
+    config_data = asdict(config)
+    workers = max_workers or min(replications, os.cpu_count() or 1)
+    started = time.perf_counter()
+
+    if workers <= 1:
+        results = [_run_replication(config_data, s) for s in seeds]
+    else:
+        with ProcessPoolExecutor(max_workers=workers) as executor:
+            results = list(executor.map(_run_replication, [config_data] * replications, seeds))
+
+    if measurement is None:
+        measurement = HandoverMeasurement(retain_events=False)
+    for result in results:
+        measurement.merge_sketches(result)
+
+    wall_time = time.perf_counter() - started
+    kernel_events = sum(r["kernel_events"] for r in results)
+    logger.info(
+        "換手離散事件模擬完成",
+        replications=replications,
+        workers=workers,
+        simulated_seconds=config.duration_seconds,
+        handovers=measurement.total_events,
+        kernel_events=kernel_events,
+        wall_time_s=round(wall_time, 2),
+    )
+
+    outcomes: Dict[str, Dict[str, int]] = {}
+    for result in results:
+        for scheme, counts in result["outcomes"].items():
+            merged = outcomes.setdefault(scheme, {})
+            for outcome, count in counts.items():
+                merged[outcome] = merged.get(outcome, 0) + count
+
+    return {
+        "measurement": measurement,
+        "replications": [
+            {"kernel_events": r["kernel_events"], "handovers": r["total_events"], "wall_time_s": r["wall_time_s"]}
+            for r in results
+        ],
+        "summary": _replication_summary(results),
+        "outcomes": outcomes,
+        "kernel_events": kernel_events,
+        "wall_time_s": wall_time,
+        "workers": workers,
+    }
@@ -11,6 +11,7 @@ HandoverMeasurement 類別，支援四種方案對比測試：
 """
 
 import asyncio
+import functools
 import json
 import time
 import logging
@@ -26,6 +27,8 @@ import statistics
 from pathlib import Path
 import structlog
 
+from .latency_sketch import WindowedLatencySketches
+
 logger = structlog.get_logger(__name__)
 
 
@@ -121,6 +124,55 @@ class SchemeStatistics:
     last_updated: datetime = field(default_factory=lambda: datetime.now(timezone.utc))
 
 
+# 串流累加的可選效能指標 (HandoverEvent 欄位名稱 → SchemeStatistics 欄位名稱)
+_RUNNING_METRICS = {
+    "throughput_mbps": "mean_throughput_mbps",
+    "packet_loss_rate": "mean_packet_loss_rate",
+    "signal_strength_dbm": "mean_signal_strength_dbm",
+    "prediction_accuracy": "mean_prediction_accuracy",
+    "binary_search_iterations": "mean_binary_search_iterations",
+}
+
+
+@dataclass
+class SchemeAccumulator:
+    """方案的串流累加器：成功/失敗計數與成功事件的指標總和，可跨節點合併"""
+
+    total_handovers: int = 0
+    successful_handovers: int = 0
+    metric_sums: Dict[str, float] = field(default_factory=dict)
+    metric_counts: Dict[str, int] = field(default_factory=dict)
+
+    def add(self, event: "HandoverEvent"):
+        self.add_values(
+            event.result == HandoverResult.SUCCESS,
+            **{attr: getattr(event, attr) for attr in _RUNNING_METRICS},
+        )
+
+    def add_values(self, success: bool, **metrics: Optional[float]):
+        """不建立 HandoverEvent 的累加路徑 (離散事件模擬使用)"""
+        self.total_handovers += 1
+        if not success:
+            return
+        self.successful_handovers += 1
+        for attr in _RUNNING_METRICS:
+            value = metrics.get(attr)
+            if value is not None:
+                self.metric_sums[attr] = self.metric_sums.get(attr, 0.0) + float(value)
+                self.metric_counts[attr] = self.metric_counts.get(attr, 0) + 1
+
+    def merge(self, other: "SchemeAccumulator"):
+        self.total_handovers += other.total_handovers
+        self.successful_handovers += other.successful_handovers
+        for attr, value in other.metric_sums.items():
+            self.metric_sums[attr] = self.metric_sums.get(attr, 0.0) + value
+            self.metric_counts[attr] = self.metric_counts.get(attr, 0) + other.metric_counts[attr]
+
+    def metric_mean(self, attr: str) -> float:
+        count = self.metric_counts.get(attr, 0)
+        return self.metric_sums[attr] / count if count else 0.0
+
+
 class HandoverMeasurement:
     """
     論文標準效能測量框架
@@ -130,14 +182,28 @@ class HandoverMeasurement:
     2. 生成統計分析報告
     3. 繪製 CDF 曲線圖
     4. 匯出論文級別數據
+
+    延遲統計以每方案、每時間窗的可合併直方圖串流更新，分位數與 CDF
+    查詢與事件數量無關；原始事件可改為寫入溢出檔 (retain_events=False)。
     """
 
-    def __init__(self, output_dir: str = "./measurement_results"):
+    def __init__(
+        self,
+        output_dir: str = "./measurement_results",
+        sketch_window_seconds: float = 60.0,
+        retain_events: bool = True,
+        spill_path: Optional[str] = None,
+        sketch_retention_seconds: Optional[float] = None,
+    ):
         """
         初始化效能測量框架
 
         Args:
             output_dir: 結果輸出目錄
+            sketch_window_seconds: 延遲直方圖時間窗長度
+            retain_events: 是否在記憶體保留原始事件
+            spill_path: 原始事件溢出檔 (JSON Lines)，None 表示不寫入
+            sketch_retention_seconds: 延遲時間窗保留期，None 表示保留全部時間窗
         """
         self.logger = structlog.get_logger(__name__)
         self.output_dir = Path(output_dir)
@@ -156,6 +222,21 @@ class HandoverMeasurement:
             scheme: [] for scheme in HandoverScheme
         }
 
+        # 串流統計：可合併延遲直方圖 + 每方案累加器
+        self.latency_sketches = WindowedLatencySketches(
+            window_seconds=sketch_window_seconds, retention_seconds=sketch_retention_seconds
+        )
+        self.scheme_accumulators: Dict[HandoverScheme, SchemeAccumulator] = {
+            scheme: SchemeAccumulator() for scheme in HandoverScheme
+        }
+        self.total_events = 0
+        self.last_event: Optional[HandoverEvent] = None
+
+        # 原始事件保留策略
+        self.retain_events = retain_events
+        self.spill_path = Path(spill_path) if spill_path else None
+        self._spill_file = None
+
         # 統計快取
         self.scheme_statistics: Dict[HandoverScheme, SchemeStatistics] = {}
         self.statistics_cache_valid = False
@@ -223,14 +304,23 @@ class HandoverMeasurement:
             **kwargs,
         )
 
+        # 串流更新統計 (O(1))
+        self.latency_sketches.record(handover_scheme.value, latency_ms, start_time)
+        self.scheme_accumulators[handover_scheme].add(event)
+        self.total_events += 1
+        self.last_event = event
+
         # 存儲事件
-        self.handover_events.append(event)
-        self.events_by_scheme[handover_scheme].append(event)
+        if self.retain_events:
+            self.handover_events.append(event)
+            self.events_by_scheme[handover_scheme].append(event)
+        if self.spill_path is not None:
+            self._spill_event(event)
 
         # 無效化統計快取
         self.statistics_cache_valid = False
 
-        self.logger.info(
+        self.logger.debug(
             "換手事件記錄完成",
             event_id=event.event_id,
             ue_id=ue_id,
@@ -339,95 +429,35 @@ class HandoverMeasurement:
         self.scheme_statistics = {}
 
         for scheme in HandoverScheme:
-            events = self.events_by_scheme[scheme]
-
-            if not events:
-                # 沒有事件，創建空統計，避免 JSON 序列化問題
-                self.scheme_statistics[scheme] = SchemeStatistics(
-                    scheme=scheme,
-                    total_handovers=0,
-                    successful_handovers=0,
-                    failed_handovers=0,
-                    mean_latency_ms=0.0,
-                    std_latency_ms=0.0,
-                    min_latency_ms=0.0,  # 改為 0.0，避免 float('inf')
-                    max_latency_ms=0.0,
-                    percentile_95_ms=0.0,
-                    percentile_99_ms=0.0,
-                    success_rate=0.0,
-                    mean_throughput_mbps=0.0,
-                    mean_packet_loss_rate=0.0,
-                    mean_signal_strength_dbm=0.0,
-                    mean_prediction_accuracy=0.0,
-                    mean_binary_search_iterations=0.0,
-                )
-                continue
+            accumulator = self.scheme_accumulators[scheme]
+            histogram = self.latency_sketches.total(scheme.value)
 
-            # 提取延遲數據
-            latencies = [event.latency_ms for event in events]
-            successful_events = [
-                event for event in events if event.result == HandoverResult.SUCCESS
-            ]
+            if accumulator.total_handovers == 0 or histogram.count == 0:
+                # 沒有事件，創建空統計，避免 JSON 序列化問題 (min 為 0.0 而非 inf)
+                self.scheme_statistics[scheme] = SchemeStatistics(scheme=scheme)
+                continue
 
-            # 計算基本統計
+            # 延遲分位數直接由直方圖查詢，不需排序原始事件
+            percentiles = histogram.percentiles((0.95, 0.99))
             stats = SchemeStatistics(
                 scheme=scheme,
-                total_handovers=len(events),
-                successful_handovers=len(successful_events),
-                failed_handovers=len(events) - len(successful_events),
-                mean_latency_ms=statistics.mean(latencies),
-                std_latency_ms=(
-                    statistics.stdev(latencies) if len(latencies) > 1 else 0.0
-                ),
-                min_latency_ms=min(latencies),
-                max_latency_ms=max(latencies),
-                percentile_95_ms=np.percentile(latencies, 95),
-                percentile_99_ms=np.percentile(latencies, 99),
-                success_rate=len(successful_events) / len(events),
+                total_handovers=accumulator.total_handovers,
+                successful_handovers=accumulator.successful_handovers,
+                failed_handovers=accumulator.total_handovers
+                - accumulator.successful_handovers,
+                mean_latency_ms=histogram.mean,
+                std_latency_ms=histogram.stdev,
+                min_latency_ms=histogram.min_value,
+                max_latency_ms=histogram.max_value,
+                percentile_95_ms=percentiles["p95"],
+                percentile_99_ms=percentiles["p99"],
+                success_rate=accumulator.successful_handovers
+                / accumulator.total_handovers,
             )
 
-            # 計算其他效能指標
-            if successful_events:
-                throughputs = [
-                    e.throughput_mbps
-                    for e in successful_events
-                    if e.throughput_mbps is not None
-                ]
-                packet_losses = [
-                    e.packet_loss_rate
-                    for e in successful_events
-                    if e.packet_loss_rate is not None
-                ]
-                signal_strengths = [
-                    e.signal_strength_dbm
-                    for e in successful_events
-                    if e.signal_strength_dbm is not None
-                ]
-                prediction_accuracies = [
-                    e.prediction_accuracy
-                    for e in successful_events
-                    if e.prediction_accuracy is not None
-                ]
-                binary_search_iterations = [
-                    e.binary_search_iterations
-                    for e in successful_events
-                    if e.binary_search_iterations is not None
-                ]
-
-                if throughputs:
-                    stats.mean_throughput_mbps = statistics.mean(throughputs)
-                if packet_losses:
-                    stats.mean_packet_loss_rate = statistics.mean(packet_losses)
-                if signal_strengths:
-                    stats.mean_signal_strength_dbm = statistics.mean(signal_strengths)
-                if prediction_accuracies:
-                    stats.mean_prediction_accuracy = statistics.mean(
-                        prediction_accuracies
-                    )
-                if binary_search_iterations:
-                    stats.mean_binary_search_iterations = statistics.mean(
-                        binary_search_iterations
-                    )
+            # 其他效能指標 (僅成功事件)
+            for attr, stats_field in _RUNNING_METRICS.items():
+                setattr(stats, stats_field, accumulator.metric_mean(attr))
 
             self.scheme_statistics[scheme] = stats
 
@@ -436,11 +466,88 @@ class HandoverMeasurement:
         self.logger.info(
             "延遲統計分析完成",
             schemes_analyzed=len(self.scheme_statistics),
-            total_events=len(self.handover_events),
+            total_events=self.total_events,
         )
 
         return self.scheme_statistics
 
+    def get_latency_percentiles(
+        self,
+        scheme: HandoverScheme,
+        start_time: Optional[float] = None,
+        end_time: Optional[float] = None,
+        quantiles: Tuple[float, ...] = (0.5, 0.95, 0.99),
+    ) -> Dict[str, float]:
+        """
+        查詢方案在指定時間範圍內的延遲分位數
+
+        Args:
+            scheme: 換手方案
+            start_time: 起始時間戳 (None 表示全期)
+            end_time: 結束時間戳 (None 表示全期)
+            quantiles: 分位數列表
+
+        Returns:
+            {"p50": ..., "p95": ..., "p99": ...}
+        """
+        if start_time is None and end_time is None:
+            histogram = self.latency_sketches.total(scheme.value)
+        else:
+            histogram = self.latency_sketches.range(scheme.value, start_time, end_time)
+        return histogram.percentiles(quantiles)
+
+    def export_sketches(self) -> Dict[str, Any]:
+        """匯出可合併的串流統計狀態 (直方圖 + 累加器)"""
+        return {
+            "latency_sketches": self.latency_sketches.to_dict(),
+            "accumulators": {
+                scheme.value: asdict(acc)
+                for scheme, acc in self.scheme_accumulators.items()
+            },
+            "total_events": self.total_events,
+        }
+
+    def merge_sketches(self, exported: Dict[str, Any]):
+        """合併其他節點或時間段匯出的串流統計狀態"""
+        self.latency_sketches.merge(
+            WindowedLatencySketches.from_dict(exported["latency_sketches"])
+        )
+        for scheme_value, acc_data in exported.get("accumulators", {}).items():
+            self.scheme_accumulators[HandoverScheme(scheme_value)].merge(
+                SchemeAccumulator(**acc_data)
+            )
+        self.total_events += exported.get("total_events", 0)
+        self.statistics_cache_valid = False
+
+    def _spill_event(self, event: HandoverEvent):
+        """將原始事件附加到溢出檔 (JSON Lines)"""
+        if self._spill_file is None:
+            self.spill_path.parent.mkdir(parents=True, exist_ok=True)
+            self._spill_file = open(self.spill_path, "a", encoding="utf-8")
+        record = asdict(event)
+        record["scheme"] = event.scheme.value
+        record["result"] = event.result.value
+        self._spill_file.write(json.dumps(record, ensure_ascii=False, default=str) + "\n")
+
+    def close(self):
+        """關閉溢出檔 (之後的事件會重新以附加模式開啟)"""
+        if self._spill_file is not None:
+            self._spill_file.close()
+            self._spill_file = None
+
+    def __enter__(self) -> "HandoverMeasurement":
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def _tested_schemes(self) -> List[HandoverScheme]:
+        return [
+            scheme
+            for scheme in HandoverScheme
+            if self.scheme_accumulators[scheme].total_handovers > 0
+        ]
+
     def plot_latency_cdf(self, save_path: Optional[str] = None) -> str:
         """
         繪製各方案換手延遲的 CDF 曲線
@@ -465,25 +572,21 @@ class HandoverMeasurement:
             }
 
             # 繪製每個方案的 CDF
+            max_latency = 0.0
             for scheme in HandoverScheme:
-                events = self.events_by_scheme[scheme]
-                if not events:
+                histogram = self.latency_sketches.total(scheme.value)
+                if not histogram.count:
                     continue
 
-                # 獲取延遲數據
-                latencies = [event.latency_ms for event in events]
-
-                # 計算 CDF
-                sorted_latencies = np.sort(latencies)
-                cdf_values = np.arange(1, len(sorted_latencies) + 1) / len(
-                    sorted_latencies
-                )
+                # CDF 直接由直方圖桶累積得到，無需排序原始延遲
+                cdf_latencies, cdf_values = histogram.cdf_points()
+                max_latency = max(max_latency, histogram.max_value)
 
                 # 繪製曲線
                 ax.plot(
-                    sorted_latencies,
+                    cdf_latencies,
                     cdf_values,
-                    label=f"{scheme.value} (n={len(latencies)})",
+                    label=f"{scheme.value} (n={histogram.count})",
                     color=scheme_colors.get(scheme, "#333333"),
                     linewidth=2,
                     marker="o",
@@ -505,9 +608,8 @@ class HandoverMeasurement:
             ax.legend(loc="lower right", fontsize=10)
 
             # 設置 X 軸範圍（聚焦在有意義的範圍）
-            if self.handover_events:
-                all_latencies = [event.latency_ms for event in self.handover_events]
-                ax.set_xlim(0, max(all_latencies) * 1.1)
+            if max_latency > 0:
+                ax.set_xlim(0, max_latency * 1.1)
 
             # 設置 Y 軸範圍
             ax.set_ylim(0, 1)
@@ -532,9 +634,7 @@ class HandoverMeasurement:
             self.logger.info(
                 "CDF 圖表生成完成",
                 save_path=str(save_path),
-                schemes_plotted=len(
-                    [s for s in HandoverScheme if self.events_by_scheme[s]]
-                ),
+                schemes_plotted=len(self._tested_schemes()),
             )
 
             return str(save_path)
@@ -619,10 +719,8 @@ class HandoverMeasurement:
             "experiment_info": {
                 "start_time": self.experiment_config["start_time"].isoformat(),
                 "generation_time": datetime.now(timezone.utc).isoformat(),
-                "total_events": len(self.handover_events),
-                "schemes_tested": len(
-                    [s for s in HandoverScheme if self.events_by_scheme[s]]
-                ),
+                "total_events": self.total_events,
+                "schemes_tested": len(self._tested_schemes()),
             },
             "comparison_table": comparison_table,
             "detailed_statistics": {
@@ -669,7 +767,7 @@ class HandoverMeasurement:
                         proposed_stats and proposed_stats.mean_latency_ms < 50.0,
                         proposed_stats
                         and proposed_stats.success_rate >= 0.95,  # 調整為較寬鬆的目標
-                        len(self.handover_events) >= 10,  # 至少有 10 個事件
+                        self.total_events >= 10,  # 至少有 10 個事件
                     ]
                 ),
             },
@@ -696,10 +794,13 @@ class HandoverMeasurement:
             export_data = {
                 "metadata": {
                     "export_time": datetime.now(timezone.utc).isoformat(),
-                    "total_events": len(self.handover_events),
+                    "total_events": self.total_events,
+                    "retained_events": len(self.handover_events),
+                    "spill_file": str(self.spill_path) if self.spill_path else None,
                     "measurement_framework_version": "1.4.0",
                 },
                 "events": [asdict(event) for event in self.handover_events],
+                "latency_sketches": self.export_sketches(),
                 "statistics": {
                     scheme.value: asdict(stats)
                     for scheme, stats in self.analyze_latency().items()
@@ -742,10 +843,8 @@ class HandoverMeasurement:
         statistics = self.analyze_latency()
 
         return {
-            "total_events": len(self.handover_events),
-            "schemes_tested": len(
-                [s for s in HandoverScheme if self.events_by_scheme[s]]
-            ),
+            "total_events": self.total_events,
+            "schemes_tested": len(self._tested_schemes()),
             "overall_success_rate": sum(
                 stats.successful_handovers for stats in statistics.values()
             )
@@ -934,6 +1033,108 @@ class HandoverMeasurement:
 
         return test_result
 
+    def run_simulated_comparison_test(
+        self,
+        duration_seconds: float = 86400.0,
+        ue_count: int = 10,
+        replications: int = 8,
+        seed: int = 0,
+        max_workers: Optional[int] = None,
+        **config_overrides,
+    ) -> Dict[str, Any]:
+        """
+        以離散事件模擬執行方案對比 (虛擬時鐘，不等待牆鐘時間)
+
+        會阻塞到所有 replication 完成；事件迴圈中請使用
+        run_simulated_comparison_test_async()。
+
+        Args:
+            duration_seconds: 模擬時長 (虛擬秒)
+            ue_count: 每個 replication 的 UE 數量
+            replications: 獨立種子數 (平行執行)
+            seed: 主種子
+            max_workers: 行程數 (None = CPU 核心數)
+            **config_overrides: SimulationConfig 其他欄位
+
+        Returns:
+            測試結果 (含 generate_comparison_report() 報告)
+        """
+        from .handover_event_simulator import run_monte_carlo
+
+        config = self._simulation_config(duration_seconds, ue_count, config_overrides)
+        simulation = run_monte_carlo(
+            config,
+            replications=replications,
+            seed=seed,
+            max_workers=max_workers,
+            measurement=self,
+        )
+        return self._simulated_comparison_result(config, replications, simulation)
+
+    async def run_simulated_comparison_test_async(
+        self,
+        duration_seconds: float = 86400.0,
+        ue_count: int = 10,
+        replications: int = 8,
+        seed: int = 0,
+        max_workers: Optional[int] = None,
+        **config_overrides,
+    ) -> Dict[str, Any]:
+        """
+        run_simulated_comparison_test() 的非同步版本
+
+        模擬在執行緒池中等待行程池，事件迴圈不被阻塞；結果累積在獨立實例，
+        完成後才於事件迴圈執行緒合併，不與進行中的 record_handover() 競爭。
+        """
+        from .handover_event_simulator import run_monte_carlo
+
+        config = self._simulation_config(duration_seconds, ue_count, config_overrides)
+        loop = asyncio.get_running_loop()
+        simulation = await loop.run_in_executor(
+            None,
+            functools.partial(
+                run_monte_carlo,
+                config,
+                replications=replications,
+                seed=seed,
+                max_workers=max_workers,
+            ),
+        )
+        self.merge_sketches(simulation["measurement"].export_sketches())
+        return self._simulated_comparison_result(config, replications, simulation)
+
+    @staticmethod
+    def _simulation_config(duration_seconds: float, ue_count: int, config_overrides: Dict[str, Any]):
+        from .handover_event_simulator import SimulationConfig
+
+        return SimulationConfig(
+            duration_seconds=duration_seconds, ue_count=ue_count, **config_overrides
+        )
+
+    def _simulated_comparison_result(
+        self, config, replications: int, simulation: Dict[str, Any]
+    ) -> Dict[str, Any]:
+        comparison_report = self.generate_comparison_report()
+
+        return {
+            "test_info": {
+                "mode": "discrete_event_simulation",
+                "simulated_seconds": config.duration_seconds,
+                "wall_time_seconds": simulation["wall_time_s"],
+                "ue_count": config.ue_count,
+                "replications": replications,
+                "workers": simulation["workers"],
+                "kernel_events": simulation["kernel_events"],
+                "total_handovers": self.total_events,
+            },
+            "replication_summary": simulation["summary"],
+            "outcomes": simulation["outcomes"],
+            "comparison_report": comparison_report,
+            "test_success": comparison_report["paper_reproduction_status"][
+                "overall_reproduction_success"
+            ],
+        }
+
 
 class HandoverMeasurementService:
     """
@@ -941,8 +1142,16 @@ class HandoverMeasurementService:
     提供異步 API 介面
     """
 
-    def __init__(self):
-        self.measurement = HandoverMeasurement()
+    def __init__(self, **measurement_options):
+        self.measurement = HandoverMeasurement(**measurement_options)
+
+    async def shutdown(self):
+        """服務關閉：寫出並關閉原始事件溢出檔"""
+        self.measurement.close()
+
+    async def run_simulated_comparison_test(self, **options) -> Dict[str, Any]:
+        """離散事件模擬方案對比 (不阻塞事件迴圈)"""
+        return await self.measurement.run_simulated_comparison_test_async(**options)
 
     async def record_handover_event(
         self,
@@ -972,10 +1181,10 @@ class HandoverMeasurementService:
             **kwargs,
         )
 
-        # 返回事件對象
-        for event in self.measurement.handover_events:
-            if event.event_id == event_id:
-                return event
+        # 返回事件對象 (剛記錄的事件即為最後一筆，無需掃描全部事件)
+        last_event = self.measurement.last_event
+        if last_event is not None and last_event.event_id == event_id:
+            return last_event
 
         # 如果找不到，創建一個基本事件對象
         return HandoverEvent(
@@ -1,22 +1,60 @@
 import os
+import asyncio
 import asyncpg
 import logging
 from datetime import datetime, timedelta
 from typing import Optional, Dict, Any
 
+from .warm_start_snapshot import load_warm_start_snapshot, HYDRATION_COLUMNS, WarmStartSnapshot
+
 logger = logging.getLogger(__name__)
 
+# 背景快照水合任務與狀態為進程級，不隨建立它的 loader 被回收
+_hydration_task: Optional[asyncio.Task] = None
+_hydration_status: Dict[str, Any] = {"state": "idle", "records": 0, "error": None, "dataset_version": None}
+
+
+def get_hydration_status() -> Dict[str, Any]:
+    """PostgreSQL 快照水合狀態 (idle / running / completed / skipped / failed)"""
+    return dict(_hydration_status)
+
+
+async def cancel_hydration() -> None:
+    """關閉時取消進行中的水合 (交易回滾)"""
+    global _hydration_task
+    task, _hydration_task = _hydration_task, None
+    if task is not None and not task.done():
+        task.cancel()
+        try:
+            await task
+        except asyncio.CancelledError:
+            pass
+
+
 class InstantSatelliteLoader:
     """容器啟動時立即載入衛星數據"""
     
     def __init__(self, postgres_url: str):
         self.postgres_url = postgres_url
         self.embedded_data_path = "/app/data/satellite_history_embedded.sql"
+
+    @property
+    def hydration_task(self) -> Optional[asyncio.Task]:
+        return _hydration_task
         
     async def ensure_data_available(self) -> bool:
         """確保衛星數據立即可用"""
+        global _hydration_task
         
         try:
+            # 0. 優先映射 warm-start 快照：API 立即可從快照提供查詢，PostgreSQL 水合移至背景
+            snapshot = load_warm_start_snapshot()
+            if snapshot is not None:
+                if _hydration_task is None or _hydration_task.done():
+                    _hydration_task = asyncio.create_task(self._hydrate_from_snapshot(snapshot))
+                logger.info("✅ Warm-start 快照可用，PostgreSQL 水合於背景執行")
+                return True
+                
             # 1. 檢查 PostgreSQL 中是否已有數據
             existing_data = await self._check_existing_data()
             
@@ -118,4 +156,48 @@ class InstantSatelliteLoader:
             return False
         except Exception as e:
             logger.error(f"❌ 緊急數據生成失敗: {e}")
-            return False
\ No newline at end of file
+            return False
+            
+    async def _hydrate_from_snapshot(self, snapshot: WarmStartSnapshot) -> bool:
+        """背景將快照內容水合至 PostgreSQL (數據已新鮮則跳過)；結果記錄於 get_hydration_status()"""
+        _hydration_status.update(state="running", records=0, error=None,
+                                 dataset_version=snapshot.dataset_version)
+        try:
+            existing_data = await self._check_existing_data()
+            if existing_data and self._is_data_fresh(existing_data):
+                logger.info(f"✅ PostgreSQL 已有 {existing_data['count']} 條新鮮數據，跳過快照水合")
+                _hydration_status.update(state="skipped", records=existing_data["count"])
+                return True
+                
+            conn = await asyncpg.connect(self.postgres_url)
+            try:
+                async with conn.transaction():
+                    await conn.execute("""
+                        DELETE FROM satellite_orbital_cache 
+                        WHERE constellation = 'precomputed'
+                    """)
+                    total = 0
+                    for batch in snapshot.iter_hydration_records():
+                        await conn.copy_records_to_table(
+                            "satellite_orbital_cache", records=batch, columns=HYDRATION_COLUMNS
+                        )
+                        total += len(batch)
+                        # 讓出事件循環，避免水合阻塞 API 請求
+                        await asyncio.sleep(0)
+                        
+                logger.info(f"✅ 快照水合完成: {total} 條記錄 (版本 {snapshot.dataset_version})")
+                if total == 0:
+                    _hydration_status.update(state="failed", error="快照沒有可水合的記錄")
+                    return False
+                _hydration_status.update(state="completed", records=total)
+                return True
+            finally:
+                await conn.close()
+                
+        except asyncio.CancelledError:
+            _hydration_status.update(state="failed", error="cancelled")
+            raise
+        except Exception as e:
+            logger.error(f"❌ 快照水合失敗: {e}")
+            _hydration_status.update(state="failed", error=str(e))
+            return False
@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""
+可合併延遲直方圖 (串流統計)
+
+固定對數分桶的延遲直方圖 (HDR / DDSketch 風格)：
+- record() 為 O(1)，只更新一個桶計數與累加值
+- 分位數與 CDF 查詢只掃描固定數量的桶，與樣本數無關
+- 相同分桶配置的直方圖可直接相加合併 (跨節點、跨時間窗)
+- 相對誤差上限為 relative_accuracy (預設 1%)
+"""
+
+import math
+from dataclasses import dataclass
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+import numpy as np
+
+
+@dataclass(frozen=True)
+class HistogramLayout:
+    """分桶配置：合併的兩個直方圖必須使用相同配置"""
+
+    min_value_ms: float = 0.01
+    max_value_ms: float = 600_000.0
+    relative_accuracy: float = 0.01
+
+    @property
+    def gamma(self) -> float:
+        return (1 + self.relative_accuracy) / (1 - self.relative_accuracy)
+
+    @property
+    def bucket_count(self) -> int:
+        # 桶 0 收集 <= min_value 的值，其餘為對數桶
+        return int(math.ceil(math.log(self.max_value_ms / self.min_value_ms, self.gamma))) + 2
+
+
+class LatencyHistogram:
+    """可合併的對數分桶延遲直方圖"""
+
+    def __init__(self, layout: Optional[HistogramLayout] = None):
+        self.layout = layout or HistogramLayout()
+        self._log_gamma = math.log(self.layout.gamma)
+        self._log_min = math.log(self.layout.min_value_ms)
+        self.counts = np.zeros(self.layout.bucket_count, dtype=np.int64)
+        self.count = 0
+        self.total = 0.0
+        self.total_squares = 0.0
+        self.min_value = math.inf
+        self.max_value = -math.inf
+
+    def _bucket_index(self, value_ms: float) -> int:
+        if value_ms <= self.layout.min_value_ms:
+            return 0
+        index = int(math.ceil((math.log(value_ms) - self._log_min) / self._log_gamma))
+        return min(index, self.layout.bucket_count - 1)
+
+    def _bucket_value(self, index: int) -> float:
+        """桶代表值 (桶上下界的幾何中點，保證相對誤差)"""
+        if index == 0:
+            return self.layout.min_value_ms
+        upper = math.exp(self._log_min + index * self._log_gamma)
+        return 2 * upper / (1 + self.layout.gamma)
+
+    def record(self, value_ms: float, count: int = 1):
+        """記錄一個延遲樣本"""
+        self.counts[self._bucket_index(value_ms)] += count
+        self.count += count
+        self.total += value_ms * count
+        self.total_squares += value_ms * value_ms * count
+        if value_ms < self.min_value:
+            self.min_value = value_ms
+        if value_ms > self.max_value:
+            self.max_value = value_ms
+
+    def record_many(self, values_ms: Iterable[float]):
+        """批次記錄 (向量化分桶)"""
+        values = np.asarray(list(values_ms), dtype=np.float64)
+        if not values.size:
+            return
+        clipped = np.maximum(values, self.layout.min_value_ms)
+        indices = np.ceil((np.log(clipped) - self._log_min) / self._log_gamma).astype(np.int64)
+        indices = np.clip(indices, 0, self.layout.bucket_count - 1)
+        indices[values <= self.layout.min_value_ms] = 0
+        self.counts += np.bincount(indices, minlength=self.layout.bucket_count)
+        self.count += int(values.size)
+        self.total += float(values.sum())
+        self.total_squares += float(np.square(values).sum())
+        self.min_value = min(self.min_value, float(values.min()))
+        self.max_value = max(self.max_value, float(values.max()))
+
+    def merge(self, other: "LatencyHistogram") -> "LatencyHistogram":
+        """就地合併另一個直方圖"""
+        if other.layout != self.layout:
+            raise ValueError("cannot merge histograms with different layouts")
+        self.counts += other.counts
+        self.count += other.count
+        self.total += other.total
+        self.total_squares += other.total_squares
+        self.min_value = min(self.min_value, other.min_value)
+        self.max_value = max(self.max_value, other.max_value)
+        return self
+
+    def copy(self) -> "LatencyHistogram":
+        return LatencyHistogram(self.layout).merge(self)
+
+    # ------------------------------------------------------------------
+    # 查詢
+    # ------------------------------------------------------------------
+
+    @property
+    def mean(self) -> float:
+        return self.total / self.count if self.count else 0.0
+
+    @property
+    def stdev(self) -> float:
+        """樣本標準差 (與 statistics.stdev 一致，n-1)"""
+        if self.count < 2:
+            return 0.0
+        variance = (self.total_squares - self.total * self.total / self.count) / (self.count - 1)
+        return math.sqrt(max(variance, 0.0))
+
+    def quantile(self, q: float) -> float:
+        """分位數 (q ∈ [0, 1])，結果夾在實際最小/最大值之間"""
+        if not self.count:
+            return 0.0
+        if q <= 0:
+            return self.min_value
+        if q >= 1:
+            return self.max_value
+        rank = q * (self.count - 1)
+        index = int(np.searchsorted(np.cumsum(self.counts), rank, side="right"))
+        return min(max(self._bucket_value(index), self.min_value), self.max_value)
+
+    def percentiles(self, qs: Iterable[float] = (0.5, 0.95, 0.99)) -> Dict[str, float]:
+        """一次累加計算多個分位數"""
+        if not self.count:
+            return {f"p{q * 100:g}": 0.0 for q in qs}
+        cumulative = np.cumsum(self.counts)
+        result = {}
+        for q in qs:
+            rank = q * (self.count - 1)
+            index = int(np.searchsorted(cumulative, rank, side="right"))
+            value = min(max(self._bucket_value(index), self.min_value), self.max_value)
+            result[f"p{q * 100:g}"] = value
+        return result
+
+    def cdf_points(self) -> Tuple[np.ndarray, np.ndarray]:
+        """CDF 曲線點 (僅非空桶)：返回 (延遲值, 累積機率)"""
+        nonzero = np.flatnonzero(self.counts)
+        if not nonzero.size:
+            return np.array([]), np.array([])
+        values = np.array([self._bucket_value(i) for i in nonzero])
+        values = np.clip(values, self.min_value, self.max_value)
+        cdf = np.cumsum(self.counts[nonzero]) / self.count
+        return values, cdf
+
+    # ------------------------------------------------------------------
+    # 匯出 / 匯入
+    # ------------------------------------------------------------------
+
+    def to_dict(self) -> Dict[str, Any]:
+        """稀疏匯出 (只含非空桶)，可用於跨節點傳輸與合併"""
+        nonzero = np.flatnonzero(self.counts)
+        return {
+            "layout": {
+                "min_value_ms": self.layout.min_value_ms,
+                "max_value_ms": self.layout.max_value_ms,
+                "relative_accuracy": self.layout.relative_accuracy,
+            },
+            "buckets": {str(int(i)): int(self.counts[i]) for i in nonzero},
+            "count": self.count,
+            "total": self.total,
+            "total_squares": self.total_squares,
+            "min_value": self.min_value if self.count else None,
+            "max_value": self.max_value if self.count else None,
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> "LatencyHistogram":
+        histogram = cls(HistogramLayout(**data["layout"]))
+        for index, count in data.get("buckets", {}).items():
+            histogram.counts[int(index)] = count
+        histogram.count = data.get("count", 0)
+        histogram.total = data.get("total", 0.0)
+        histogram.total_squares = data.get("total_squares", 0.0)
+        if histogram.count:
+            histogram.min_value = data["min_value"]
+            histogram.max_value = data["max_value"]
+        return histogram
+
+
+class WindowedLatencySketches:
+    """
+    按 (鍵, 時間窗) 分組的延遲直方圖
+
+    鍵通常為換手方案名稱；另外維護每個鍵的累計直方圖，
+    全期查詢不需要合併所有時間窗。
+    設定 retention_seconds 時，早於最新時間窗 retention_seconds 的時間窗會被丟棄
+    (累計直方圖不受影響)，長時間運行的記憶體用量維持固定。
+    """
+
+    def __init__(self, window_seconds: float = 60.0, layout: Optional[HistogramLayout] = None,
+                 retention_seconds: Optional[float] = None):
+        self.window_seconds = window_seconds
+        self.layout = layout or HistogramLayout()
+        self.retention_seconds = retention_seconds
+        self.windows: Dict[str, Dict[int, LatencyHistogram]] = {}
+        self.totals: Dict[str, LatencyHistogram] = {}
+        self._latest_window: Optional[int] = None
+
+    def _window_start(self, timestamp: float) -> int:
+        return int(timestamp // self.window_seconds * self.window_seconds)
+
+    def record(self, key: str, value_ms: float, timestamp: float):
+        window = self.windows.setdefault(key, {})
+        start = self._window_start(timestamp)
+        if start not in window:
+            window[start] = LatencyHistogram(self.layout)
+            if self._latest_window is None or start > self._latest_window:
+                self._latest_window = start
+                self.expire()
+        window[start].record(value_ms)
+        if key not in self.totals:
+            self.totals[key] = LatencyHistogram(self.layout)
+        self.totals[key].record(value_ms)
+
+    def expire(self, now: Optional[float] = None) -> int:
+        """丟棄超出保留期的時間窗 (now 預設為最新時間窗)，返回丟棄數量"""
+        if self.retention_seconds is None:
+            return 0
+        reference = self._window_start(now) if now is not None else self._latest_window
+        if reference is None:
+            return 0
+        cutoff = reference - self.retention_seconds
+        dropped = 0
+        for windows in self.windows.values():
+            for start in [s for s in windows if s < cutoff]:
+                del windows[start]
+                dropped += 1
+        return dropped
+
+    def total(self, key: str) -> LatencyHistogram:
+        return self.totals.get(key) or LatencyHistogram(self.layout)
+
+    def range(self, key: str, start_time: Optional[float] = None,
+              end_time: Optional[float] = None) -> LatencyHistogram:
+        """合併 [start_time, end_time) 範圍內的時間窗"""
+        merged = LatencyHistogram(self.layout)
+        for start, histogram in self.windows.get(key, {}).items():
+            if start_time is not None and start + self.window_seconds <= start_time:
+                continue
+            if end_time is not None and start >= end_time:
+                continue
+            merged.merge(histogram)
+        return merged
+
+    def merge(self, other: "WindowedLatencySketches") -> "WindowedLatencySketches":
+        """合併其他節點的直方圖集合 (時間窗大小需一致)"""
+        if other.window_seconds != self.window_seconds:
+            raise ValueError("cannot merge sketches with different window sizes")
+        for key, windows in other.windows.items():
+            target = self.windows.setdefault(key, {})
+            for start, histogram in windows.items():
+                if start in target:
+                    target[start].merge(histogram)
+                else:
+                    target[start] = histogram.copy()
+        for key, histogram in other.totals.items():
+            if key in self.totals:
+                self.totals[key].merge(histogram)
+            else:
+                self.totals[key] = histogram.copy()
+        starts = [start for windows in self.windows.values() for start in windows]
+        if starts:
+            self._latest_window = max(starts)
+            self.expire()
+        return self
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            "window_seconds": self.window_seconds,
+            "retention_seconds": self.retention_seconds,
+            "windows": {
+                key: {str(start): h.to_dict() for start, h in windows.items()}
+                for key, windows in self.windows.items()
+            },
+            "totals": {key: h.to_dict() for key, h in self.totals.items()},
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> "WindowedLatencySketches":
+        sketches = cls(window_seconds=data["window_seconds"],
+                       retention_seconds=data.get("retention_seconds"))
+        for key, windows in data.get("windows", {}).items():
+            sketches.windows[key] = {
+                int(start): LatencyHistogram.from_dict(h) for start, h in windows.items()
+            }
+        for key, h in data.get("totals", {}).items():
+            sketches.totals[key] = LatencyHistogram.from_dict(h)
+        if sketches.totals:
+            sketches.layout = next(iter(sketches.totals.values())).layout
+        starts = [start for windows in sketches.windows.values() for start in windows]
+        sketches._latest_window = max(starts) if starts else None
+        return sketches
+
+    def keys(self) -> List[str]:
+        return list(self.totals.keys())
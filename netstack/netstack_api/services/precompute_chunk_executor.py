@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""
+預計算分塊執行器 - Phase 2 核心組件
+
+將一個預計算作業切分為 (星座, 衛星分片, 時間區段) 分塊：
+- 分塊在工作進程池中執行，每個作業同時在途的分塊數有上限
+- 每個完成的分塊立即寫入本地檢查點，作業暫停、失敗重試或服務重啟後
+  只計算尚未完成的分塊
+- 時間區段沿作業的時間步長網格切分，分塊結果的聯集與單次
+  compute_history 完全相同 (不重複、不遺漏邊界時間點)
+"""
+
+import asyncio
+import hashlib
+import json
+import os
+import pickle
+import shutil
+import time
+from concurrent.futures import Executor
+from dataclasses import dataclass
+from datetime import datetime, timedelta
+from pathlib import Path
+from typing import Any, Callable, Dict, Iterator, List, Optional, Set, Tuple
+
+import structlog
+
+from .precompute_satellite_history import SatelliteHistoryPrecomputer, PrecomputeResult
+
+logger = structlog.get_logger(__name__)
+
+DEFAULT_CHECKPOINT_DIR = "/app/data/precompute_checkpoints"
+MANIFEST_FILE = "manifest.json"
+TLE_FILE = "tle_data.pkl"
+
+
+@dataclass
+class ChunkSpec:
+    """作業分塊"""
+    index: int
+    constellation: str
+    shard_index: int
+    shard_start: int            # 衛星分片在釘選 TLE 列表中的範圍 [shard_start, shard_end)
+    shard_end: int
+    time_start: datetime        # 含端點
+    time_end: datetime          # 含端點
+    time_points: int
+
+    @property
+    def calculations(self) -> int:
+        return (self.shard_end - self.shard_start) * self.time_points
+
+
+def plan_chunks(
+    constellation: str,
+    start_time: datetime,
+    end_time: datetime,
+    time_step_seconds: int,
+    satellite_count: int,
+    shard_size: int = 500,
+    chunk_hours: float = 1.0
+) -> List[ChunkSpec]:
+    """
+    規劃作業分塊
+
+    時間點為 start_time + k × time_step_seconds (≤ end_time)，
+    每個時間區段包含 chunk_hours 內的整數個時間點。
+    """
+    if satellite_count <= 0 or end_time < start_time:
+        return []
+
+    total_points = int((end_time - start_time).total_seconds() // time_step_seconds) + 1
+    points_per_chunk = max(1, int(chunk_hours * 3600 // time_step_seconds))
+    shard_size = max(1, shard_size)
+
+    chunks = []
+    for shard_index, shard_start in enumerate(range(0, satellite_count, shard_size)):
+        shard_end = min(shard_start + shard_size, satellite_count)
+        for first in range(0, total_points, points_per_chunk):
+            last = min(first + points_per_chunk, total_points) - 1
+            chunks.append(ChunkSpec(
+                index=len(chunks),
+                constellation=constellation,
+                shard_index=shard_index,
+                shard_start=shard_start,
+                shard_end=shard_end,
+                time_start=start_time + timedelta(seconds=first * time_step_seconds),
+                time_end=start_time + timedelta(seconds=last * time_step_seconds),
+                time_points=last - first + 1
+            ))
+    return chunks
+
+
+def compute_chunk(
+    tle_shard: List[Dict],
+    observer_coords: Tuple[float, float, float],
+    time_start: datetime,
+    time_end: datetime,
+    time_step_seconds: int
+) -> Tuple[List[PrecomputeResult], float]:
+    """工作進程入口：計算單一分塊，回傳 (結果, 計算秒數)"""
+    started = time.perf_counter()
+    precomputer = SatelliteHistoryPrecomputer(
+        tle_data=tle_shard,
+        observer_coords=observer_coords,
+        time_range=(time_start, time_end)
+    )
+    results = precomputer.compute_history(time_step_seconds)
+    return results, time.perf_counter() - started
+
+
+class ChunkCheckpointStore:
+    """
+    分塊檢查點存儲
+
+    目錄結構：
+        <root>/<job_id>/manifest.json     作業配置、分塊參數與狀態
+        <root>/<job_id>/tle_data.pkl      釘選的 TLE 數據 (恢復時不受 TLE 更新影響)
+        <root>/<job_id>/chunk_00042.pkl   已完成分塊的結果
+        <root>/<job_id>/chunk_00042.json  分塊統計，最後寫入，作為完成標記
+    所有寫入先寫暫存檔再 os.replace，中途崩潰不會留下半個檢查點。
+    """
+
+    def __init__(self, root_dir: Optional[str] = None):
+        self.root = Path(root_dir or os.getenv("PRECOMPUTE_CHECKPOINT_DIR", DEFAULT_CHECKPOINT_DIR))
+
+    def job_dir(self, job_id: str) -> Path:
+        return self.root / job_id
+
+    @staticmethod
+    def _atomic_write(path: Path, payload: bytes) -> None:
+        path.parent.mkdir(parents=True, exist_ok=True)
+        tmp_path = path.with_name(path.name + ".tmp")
+        with open(tmp_path, "wb") as f:
+            f.write(payload)
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp_path, path)
+
+    # === 作業層級 ===
+
+    def save_manifest(self, job_id: str, manifest: Dict[str, Any]) -> None:
+        self._atomic_write(self.job_dir(job_id) / MANIFEST_FILE,
+                           json.dumps(manifest, ensure_ascii=False, default=str).encode("utf-8"))
+
+    def load_manifest(self, job_id: str) -> Optional[Dict[str, Any]]:
+        path = self.job_dir(job_id) / MANIFEST_FILE
+        if not path.exists():
+            return None
+        return json.loads(path.read_text(encoding="utf-8"))
+
+    def save_tle_data(self, job_id: str, tle_data: List[Dict]) -> None:
+        self._atomic_write(self.job_dir(job_id) / TLE_FILE, pickle.dumps(tle_data, protocol=pickle.HIGHEST_PROTOCOL))
+
+    def load_tle_data(self, job_id: str) -> Optional[List[Dict]]:
+        path = self.job_dir(job_id) / TLE_FILE
+        if not path.exists():
+            return None
+        with open(path, "rb") as f:
+            return pickle.load(f)
+
+    def list_jobs(self) -> List[str]:
+        if not self.root.exists():
+            return []
+        return sorted(p.name for p in self.root.iterdir() if (p / MANIFEST_FILE).exists())
+
+    def clear(self, job_id: str) -> None:
+        shutil.rmtree(self.job_dir(job_id), ignore_errors=True)
+
+    # === 分塊層級 ===
+
+    def _chunk_path(self, job_id: str, index: int, suffix: str) -> Path:
+        return self.job_dir(job_id) / f"chunk_{index:05d}{suffix}"
+
+    def save_chunk(self, job_id: str, index: int, results: List[PrecomputeResult], stats: Dict[str, Any]) -> None:
+        self._atomic_write(self._chunk_path(job_id, index, ".pkl"),
+                           pickle.dumps(results, protocol=pickle.HIGHEST_PROTOCOL))
+        self._atomic_write(self._chunk_path(job_id, index, ".json"),
+                           json.dumps(stats, ensure_ascii=False).encode("utf-8"))
+
+    def load_chunk_results(self, job_id: str, index: int) -> List[PrecomputeResult]:
+        with open(self._chunk_path(job_id, index, ".pkl"), "rb") as f:
+            return pickle.load(f)
+
+    def load_chunk_stats(self, job_id: str) -> Dict[int, Dict[str, Any]]:
+        """所有已完成分塊的統計 (不載入結果)"""
+        job_dir = self.job_dir(job_id)
+        if not job_dir.exists():
+            return {}
+        return {int(p.stem.split("_")[1]): json.loads(p.read_text(encoding="utf-8"))
+                for p in job_dir.glob("chunk_*.json")}
+
+    def completed_chunks(self, job_id: str) -> Set[int]:
+        job_dir = self.job_dir(job_id)
+        if not job_dir.exists():
+            return set()
+        return {int(p.stem.split("_")[1]) for p in job_dir.glob("chunk_*.json")}
+
+    def clear_chunks(self, job_id: str) -> None:
+        for path in self.job_dir(job_id).glob("chunk_*"):
+            path.unlink(missing_ok=True)
+
+    def iter_chunk_results(self, job_id: str, indices: List[int]) -> Iterator[List[PrecomputeResult]]:
+        """逐塊讀回結果，避免一次載入整個作業"""
+        for index in indices:
+            yield self.load_chunk_results(job_id, index)
+
+
+def plan_fingerprint(config: Dict[str, Any], tle_data: List[Dict], shard_size: int, chunk_hours: float) -> str:
+    """分塊規劃指紋：配置、分塊參數或釘選 TLE 不同時檢查點不可沿用"""
+    digest = hashlib.sha1()
+    digest.update(json.dumps(config, sort_keys=True, default=str).encode("utf-8"))
+    digest.update(f"{shard_size}:{chunk_hours}".encode("utf-8"))
+    for tle in tle_data:
+        digest.update(f"{tle.get('line1', '')}\n{tle.get('line2', '')}\n".encode("utf-8"))
+    return digest.hexdigest()
+
+
+class ChunkedJobRunner:
+    """
+    在執行器上以有上限的在途隊列執行作業分塊
+
+    每完成一塊即寫入檢查點並回報；should_continue() 為 False 時停止提交新分塊，
+    等待在途分塊完成 (並寫入檢查點) 後返回，供暫停使用。
+    """
+
+    def __init__(self, executor: Executor, store: ChunkCheckpointStore, max_in_flight: int = 4):
+        self.executor = executor
+        self.store = store
+        self.max_in_flight = max(1, max_in_flight)
+
+    async def run(
+        self,
+        job_id: str,
+        chunks: List[ChunkSpec],
+        tle_data: List[Dict],
+        observer_coords: Tuple[float, float, float],
+        time_step_seconds: int,
+        should_continue: Callable[[], bool],
+        on_chunk_done: Callable[[ChunkSpec, Dict[str, Any]], None],
+        on_chunk_started: Optional[Callable[[ChunkSpec], None]] = None
+    ) -> bool:
+        """
+        執行尚未完成的分塊
+
+        Returns:
+            是否所有分塊皆已完成 (False 表示因暫停而提前停止)
+        """
+        loop = asyncio.get_running_loop()
+        done_indices = self.store.completed_chunks(job_id)
+        pending = [chunk for chunk in chunks if chunk.index not in done_indices]
+        in_flight: Dict[asyncio.Future, ChunkSpec] = {}
+
+        try:
+            while pending or in_flight:
+                while pending and len(in_flight) < self.max_in_flight and should_continue():
+                    chunk = pending.pop(0)
+                    future = loop.run_in_executor(
+                        self.executor, compute_chunk,
+                        tle_data[chunk.shard_start:chunk.shard_end], observer_coords,
+                        chunk.time_start, chunk.time_end, time_step_seconds
+                    )
+                    in_flight[future] = chunk
+                    if on_chunk_started:
+                        on_chunk_started(chunk)
+
+                if not in_flight:
+                    break   # 已暫停且沒有在途分塊
+
+                finished, _ = await asyncio.wait(in_flight, return_when=asyncio.FIRST_COMPLETED)
+                for future in finished:
+                    chunk = in_flight.pop(future)
+                    results, compute_seconds = future.result()
+                    stats = {
+                        "index": chunk.index,
+                        "constellation": chunk.constellation,
+                        "shard_index": chunk.shard_index,
+                        "satellites": chunk.shard_end - chunk.shard_start,
+                        "time_start": chunk.time_start.isoformat(),
+                        "time_end": chunk.time_end.isoformat(),
+                        "calculations": chunk.calculations,
+                        "records": len(results),
+                        "compute_seconds": compute_seconds,
+                        "calculations_per_second": chunk.calculations / compute_seconds if compute_seconds > 0 else 0.0,
+                        "completed_at": datetime.now().isoformat()
+                    }
+                    await loop.run_in_executor(None, self.store.save_chunk, job_id, chunk.index, results, stats)
+                    on_chunk_done(chunk, stats)
+        finally:
+            # 取消或失敗時不再等待在途分塊；已寫入的檢查點保留供重試
+            for future in in_flight:
+                future.cancel()
+
+        return not pending and not in_flight
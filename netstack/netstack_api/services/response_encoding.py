@@ -0,0 +1,29 @@
+"""
+大型衛星響應編碼層
+
+唯一實作位於 orbit-engine shared/utils/response_encoding.py (內容協商、
+ColumnarPayload、ETag 編碼緩存)，此處載入該檔案並重新匯出，供 NetStack 路由使用。
+"""
+
+from src.shared_core.orbit_engine_modules import load_orbit_engine_module
+
+_shared = load_orbit_engine_module("shared/utils/response_encoding.py")
+
+JSON_MEDIA_TYPE = _shared.JSON_MEDIA_TYPE
+MSGPACK_MEDIA_TYPE = _shared.MSGPACK_MEDIA_TYPE
+ARROW_MEDIA_TYPE = _shared.ARROW_MEDIA_TYPE
+MEDIA_TYPES = _shared.MEDIA_TYPES
+
+NotTabularError = _shared.NotTabularError
+ColumnarPayload = _shared.ColumnarPayload
+EncodedResponseCache = _shared.EncodedResponseCache
+EncodedResponse = _shared.EncodedResponse
+ResponseEncoder = _shared.ResponseEncoder
+
+format_available = _shared.format_available
+available_media_types = _shared.available_media_types
+negotiate_format = _shared.negotiate_format
+encode_payload = _shared.encode_payload
+make_etag = _shared.make_etag
+etag_matches = _shared.etag_matches
+get_response_encoder = _shared.get_response_encoder
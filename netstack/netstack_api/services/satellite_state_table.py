@@ -0,0 +1,534 @@
+#!/usr/bin/env python3
+"""
+進程級欄位式衛星狀態表
+
+各衛星路由器原本在每次請求時各自呼叫服務、逐顆衛星組裝回應字典。
+本模組維護一份進程內共享的「目前狀態」欄位表：
+- 衛星 ID、名稱、NORAD ID、星座
+- ECEF 位置 / 速度 (km, km/s)、WGS84 緯經度與高度
+- 每個已註冊觀測點的仰角、方位角、距離與 RSRP
+
+背景 tick 依共享模擬時鐘，以 SatrecArray 向量化 SGP4 傳播整個星座，
+建立新的唯讀快照後整體替換 (讀取端不加鎖，永遠看到完整的一代)。
+路由器以向量化遮罩 / 排序查詢快照，rows() 直接由欄位輸出純 Python 值，
+請求路徑上不做任何軌道傳播。
+"""
+
+import asyncio
+import json
+import math
+import os
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any, Awaitable, Callable, Dict, List, Optional, Sequence, Tuple, Union
+
+import numpy as np
+import structlog
+
+from .simulation_clock import get_simulation_clock
+
+try:
+    from sgp4.api import SatrecArray, Satrec, jday
+    SGP4_AVAILABLE = True
+except ImportError:
+    SGP4_AVAILABLE = False
+
+logger = structlog.get_logger(__name__)
+
+# WGS84
+WGS84_A_KM = 6378.137
+WGS84_F = 1 / 298.257223563
+WGS84_E2 = WGS84_F * (2 - WGS84_F)
+EARTH_ROTATION_RAD_S = 7.2921158553e-5
+
+STATE_TABLE_CONSTELLATIONS = ("starlink", "oneweb")
+# 觀測點 (緯度, 經度, 海拔 km)
+DEFAULT_OBSERVERS: Dict[str, Tuple[float, float, float]] = {
+    "ntpu": (24.9441667, 121.3713889, 0.024),
+}
+DEFAULT_OBSERVER = "ntpu"
+
+# rows() 預設輸出欄位
+ROW_FIELDS = (
+    "satellite_id", "name", "norad_id", "constellation",
+    "latitude", "longitude", "altitude_km",
+    "elevation_deg", "azimuth_deg", "range_km", "rsrp_dbm", "is_visible",
+)
+_METADATA_FIELDS = ("satellite_id", "name", "norad_id", "constellation")
+_OBSERVER_FIELDS = ("elevation_deg", "azimuth_deg", "range_km", "rsrp_dbm")
+
+SatelliteLoader = Callable[[], Awaitable[List[Dict[str, Any]]]]
+RowField = Union[str, Tuple[str, str]]      # 欄位名，或 (輸出名, 欄位名)
+SnapshotListener = Callable[["SatelliteStateSnapshot"], None]
+
+
+# ----------------------------------------------------------------------
+# 座標轉換 (向量化)
+# ----------------------------------------------------------------------
+
+def gmst_radians(jd: float, fr: float) -> float:
+    """格林威治平恆星時 (IAU 1982)"""
+    t = ((jd - 2451545.0) + fr) / 36525.0
+    seconds = (67310.54841 + (876600.0 * 3600 + 8640184.812866) * t
+               + 0.093104 * t * t - 6.2e-6 * t * t * t)
+    return math.radians((seconds % 86400.0) / 240.0)
+
+
+def teme_to_ecef(position: np.ndarray, velocity: np.ndarray, gmst: float) -> Tuple[np.ndarray, np.ndarray]:
+    """TEME → ECEF (忽略極移)；position / velocity 為 (N, 3)"""
+    c, s = math.cos(gmst), math.sin(gmst)
+    x = c * position[:, 0] + s * position[:, 1]
+    y = -s * position[:, 0] + c * position[:, 1]
+    ecef = np.stack([x, y, position[:, 2]], axis=1)
+    vx = c * velocity[:, 0] + s * velocity[:, 1] + EARTH_ROTATION_RAD_S * y
+    vy = -s * velocity[:, 0] + c * velocity[:, 1] - EARTH_ROTATION_RAD_S * x
+    return ecef, np.stack([vx, vy, velocity[:, 2]], axis=1)
+
+
+def ecef_to_geodetic(ecef: np.ndarray) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """ECEF (km) → WGS84 緯度、經度 (度) 與高度 (km)"""
+    x, y, z = ecef[:, 0], ecef[:, 1], ecef[:, 2]
+    p = np.hypot(x, y)
+    lat = np.arctan2(z, p * (1 - WGS84_E2))
+    for _ in range(4):
+        n = WGS84_A_KM / np.sqrt(1 - WGS84_E2 * np.sin(lat) ** 2)
+        lat = np.arctan2(z + WGS84_E2 * n * np.sin(lat), p)
+    n = WGS84_A_KM / np.sqrt(1 - WGS84_E2 * np.sin(lat) ** 2)
+    with np.errstate(invalid="ignore", divide="ignore"):
+        alt = np.where(np.abs(np.cos(lat)) > 1e-9, p / np.cos(lat) - n, np.abs(z) - n * (1 - WGS84_E2))
+    return np.degrees(lat), np.degrees(np.arctan2(y, x)), alt
+
+
+def geodetic_to_ecef(lat_deg: float, lon_deg: float, alt_km: float) -> np.ndarray:
+    lat, lon = math.radians(lat_deg), math.radians(lon_deg)
+    n = WGS84_A_KM / math.sqrt(1 - WGS84_E2 * math.sin(lat) ** 2)
+    return np.array([(n + alt_km) * math.cos(lat) * math.cos(lon),
+                     (n + alt_km) * math.cos(lat) * math.sin(lon),
+                     (n * (1 - WGS84_E2) + alt_km) * math.sin(lat)])
+
+
+def estimate_rsrp(range_km: np.ndarray, elevation_deg: np.ndarray, frequency_ghz: float = 2.0,
+                  tx_power_dbm: float = 43.0) -> np.ndarray:
+    """自由空間路徑損耗 + 仰角天線增益 (與向量化軌跡核心相同模型)"""
+    with np.errstate(divide="ignore", invalid="ignore"):
+        fspl = 20 * np.log10(range_km) + 20 * math.log10(frequency_ghz) + 92.45
+    return tx_power_dbm - fspl + np.clip(elevation_deg / 90.0, None, 1.0) * 15
+
+
+@dataclass(frozen=True)
+class ObserverView:
+    """單一觀測點對所有衛星的觀測欄位"""
+    elevation_deg: np.ndarray
+    azimuth_deg: np.ndarray
+    range_km: np.ndarray
+    rsrp_dbm: np.ndarray
+
+    @classmethod
+    def compute(cls, ecef: np.ndarray, lat_deg: float, lon_deg: float, alt_km: float) -> "ObserverView":
+        lat, lon = math.radians(lat_deg), math.radians(lon_deg)
+        d = ecef - geodetic_to_ecef(lat_deg, lon_deg, alt_km)
+        sin_lat, cos_lat, sin_lon, cos_lon = math.sin(lat), math.cos(lat), math.sin(lon), math.cos(lon)
+        east = -sin_lon * d[:, 0] + cos_lon * d[:, 1]
+        north = -sin_lat * cos_lon * d[:, 0] - sin_lat * sin_lon * d[:, 1] + cos_lat * d[:, 2]
+        up = cos_lat * cos_lon * d[:, 0] + cos_lat * sin_lon * d[:, 1] + sin_lat * d[:, 2]
+        range_km = np.sqrt(east ** 2 + north ** 2 + up ** 2)
+        elevation = np.degrees(np.arctan2(up, np.hypot(east, north)))
+        azimuth = np.degrees(np.arctan2(east, north)) % 360.0
+        azimuth[azimuth >= 360.0] = 0.0     # -ε % 360 捨入為 360
+        return cls(elevation, azimuth, range_km, estimate_rsrp(range_km, elevation))
+
+
+# ----------------------------------------------------------------------
+# 快照
+# ----------------------------------------------------------------------
+
+class SatelliteStateSnapshot:
+    """某一時刻的欄位式衛星狀態 (建立後唯讀)"""
+
+    MAX_ADHOC_OBSERVERS = 64
+
+    def __init__(self, generation: int, timestamp: float, metadata: Dict[str, np.ndarray],
+                 ecef: np.ndarray, velocity: np.ndarray, valid: np.ndarray,
+                 observers: Dict[str, Tuple[float, float, float]]):
+        """
+        Args:
+            metadata: _METADATA_FIELDS 欄位 (與 ecef 列對齊)
+            valid: 傳播成功的列，只保留這些列
+        """
+        self.generation = generation
+        self.timestamp = timestamp
+        keep = slice(None) if valid.all() else valid
+        self.ecef = ecef[keep]
+        self.velocity = velocity[keep]
+        self.satellite_id = metadata["satellite_id"][keep]
+        self.name = metadata["name"][keep]
+        self.norad_id = metadata["norad_id"][keep]
+        self.constellation = metadata["constellation"][keep]
+        self.latitude, self.longitude, self.altitude_km = ecef_to_geodetic(self.ecef)
+
+        self.observer_locations = dict(observers)
+        self.observers: Dict[str, ObserverView] = {
+            name: ObserverView.compute(self.ecef, *location) for name, location in observers.items()
+        }
+        self._adhoc: "OrderedDict[Tuple[float, float, float], ObserverView]" = OrderedDict()
+        self._index_by_id: Optional[Dict[str, int]] = None
+
+    def __len__(self) -> int:
+        return int(self.satellite_id.size)
+
+    @property
+    def time(self) -> datetime:
+        return datetime.fromtimestamp(self.timestamp, tz=timezone.utc)
+
+    def index_of(self, satellite_id: str) -> Optional[int]:
+        if self._index_by_id is None:
+            self._index_by_id = {sat_id: i for i, sat_id in enumerate(self.satellite_id.tolist())}
+        return self._index_by_id.get(satellite_id)
+
+    def observer_view(self, observer: Optional[str] = None, latitude: Optional[float] = None,
+                      longitude: Optional[float] = None, altitude_km: float = 0.0) -> ObserverView:
+        """
+        取得觀測欄位：已註冊觀測點直接返回；任意座標由快照中的 ECEF 計算
+        (僅座標轉換，不傳播軌道)，並以 1e-4 度網格緩存
+        """
+        if latitude is None or longitude is None:
+            return self.observers[observer or DEFAULT_OBSERVER]
+        for name, (lat, lon, _) in self.observer_locations.items():
+            if abs(lat - latitude) < 1e-4 and abs(lon - longitude) < 1e-4:
+                return self.observers[name]
+
+        key = (round(latitude, 4), round(longitude, 4), round(altitude_km, 3))
+        view = self._adhoc.get(key)
+        if view is None:
+            view = ObserverView.compute(self.ecef, *key)
+            self._adhoc[key] = view
+            while len(self._adhoc) > self.MAX_ADHOC_OBSERVERS:
+                self._adhoc.popitem(last=False)
+        return view
+
+    def select(self, view: Optional[ObserverView] = None, constellation: Optional[str] = None,
+               min_elevation_deg: Optional[float] = None, sort_by: str = "elevation_deg",
+               descending: bool = True, limit: Optional[int] = None) -> np.ndarray:
+        """
+        向量化過濾與排序
+
+        Args:
+            view: 觀測欄位 (預設為預設觀測點)
+            constellation: 星座過濾，"both" / None 表示全部
+            min_elevation_deg: 最低仰角
+            sort_by: 排序欄位 (觀測欄位或 latitude / longitude / altitude_km)
+            limit: 返回數量上限 (以部分排序取前 K)
+
+        Returns:
+            快照列索引
+        """
+        view = view or self.observer_view()
+        mask = np.ones(len(self), dtype=bool)
+        if constellation and constellation.lower() not in ("both", "all"):
+            mask &= self.constellation == constellation.lower()
+        if min_elevation_deg is not None:
+            mask &= view.elevation_deg >= min_elevation_deg
+        indices = np.flatnonzero(mask)
+
+        key = getattr(view, sort_by) if sort_by in _OBSERVER_FIELDS else getattr(self, sort_by)
+        key = -key[indices] if descending else key[indices]
+        if limit is not None and limit < indices.size:
+            top = np.argpartition(key, limit)[:limit]
+            return indices[top[np.argsort(key[top], kind="stable")]]
+        return indices[np.argsort(key, kind="stable")]
+
+    def column(self, field: str, indices: np.ndarray, view: Optional[ObserverView] = None) -> List[Any]:
+        """單一欄位的純 Python 值"""
+        if field == "is_visible":
+            return ((view or self.observer_view()).elevation_deg[indices] >= 0.0).tolist()
+        if field in _OBSERVER_FIELDS:
+            return getattr(view or self.observer_view(), field)[indices].tolist()
+        if field == "position_ecef":
+            return self.ecef[indices].tolist()
+        if field == "velocity_ecef":
+            return self.velocity[indices].tolist()
+        return getattr(self, field)[indices].tolist()
+
+    def rows(self, indices: np.ndarray, view: Optional[ObserverView] = None,
+             fields: Sequence[RowField] = ROW_FIELDS) -> List[Dict[str, Any]]:
+        """
+        由欄位直接輸出回應列 (每欄一次 tolist，不逐值轉換)
+
+        Args:
+            fields: 欄位名，或 (輸出名, 欄位名) 以配合各路由器既有的回應鍵名
+        """
+        view = view or self.observer_view()
+        pairs = [(field, field) if isinstance(field, str) else field for field in fields]
+        columns = [self.column(field, indices, view) for _, field in pairs]
+        return [dict(zip([name for name, _ in pairs], values)) for values in zip(*columns)]
+
+
+def encode_json(payload: Any) -> bytes:
+    """回應序列化：rows() 已是純 Python 值，可跳過框架的逐值轉換"""
+    return json.dumps(payload, ensure_ascii=False, separators=(",", ":"), allow_nan=False).encode("utf-8")
+
+
+# ----------------------------------------------------------------------
+# 傳播器與背景更新
+# ----------------------------------------------------------------------
+
+class SGP4StatePropagator:
+    """以 SatrecArray 一次傳播整個衛星集合到單一時刻"""
+
+    def __init__(self, satellites: Sequence[Dict[str, Any]]):
+        if not SGP4_AVAILABLE:
+            raise RuntimeError("sgp4 未安裝，無法建立衛星狀態表")
+        self.satellites: List[Dict[str, Any]] = []
+        satrecs = []
+        for sat in satellites:
+            try:
+                satrecs.append(Satrec.twoline2rv(sat["line1"], sat["line2"]))
+                self.satellites.append(sat)
+            except Exception as e:
+                logger.warning("TLE 解析失敗", satellite_id=sat.get("satellite_id"), error=str(e))
+        self._array = SatrecArray(satrecs) if satrecs else None
+
+        # 衛星屬性欄位只在衛星集合變更時建立一次
+        self.metadata: Dict[str, np.ndarray] = {
+            "satellite_id": np.array([sat["satellite_id"] for sat in self.satellites], dtype=object),
+            "name": np.array([sat.get("name", sat["satellite_id"]) for sat in self.satellites], dtype=object),
+            "norad_id": np.array([sat.get("norad_id") for sat in self.satellites], dtype=object),
+            "constellation": np.array([sat.get("constellation", "unknown").lower() for sat in self.satellites],
+                                      dtype=object),
+        }
+
+    def propagate(self, timestamp: float) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """返回 ECEF 位置 (N, 3)、ECEF 速度 (N, 3) 與成功遮罩"""
+        n = len(self.satellites)
+        if self._array is None:
+            return np.empty((0, 3)), np.empty((0, 3)), np.zeros(0, dtype=bool)
+        when = datetime.fromtimestamp(timestamp, tz=timezone.utc)
+        jd, fr = jday(when.year, when.month, when.day, when.hour, when.minute,
+                      when.second + when.microsecond / 1e6)
+        errors, r, v = self._array.sgp4(np.array([jd]), np.array([fr]))
+        position = np.asarray(r, dtype=float).reshape(n, 3)
+        velocity = np.asarray(v, dtype=float).reshape(n, 3)
+        valid = (np.asarray(errors).reshape(n) == 0) & np.isfinite(position).all(axis=1)
+        ecef, ecef_velocity = teme_to_ecef(position, velocity, gmst_radians(jd, fr))
+        return ecef, ecef_velocity, valid
+
+
+def default_tle_data_dir() -> Optional[Path]:
+    """
+    TLE 數據根目錄：環境變數 TLE_DATA_DIR、容器掛載 /app/tle_data、原始碼樹 netstack/tle_data
+    中第一個存在者
+    """
+    candidates = [Path(os.environ["TLE_DATA_DIR"])] if os.getenv("TLE_DATA_DIR") else []
+    candidates += [Path("/app/tle_data"), Path(__file__).resolve().parents[2] / "tle_data"]
+    return next((path for path in candidates if path.is_dir()), None)
+
+
+def latest_tle_file(tle_data_dir: Path, constellation: str) -> Optional[Path]:
+    """星座最新日期的 TLE 檔 (<星座>/tle/<星座>_YYYYMMDD.tle)，不存在時返回 None"""
+    files = [path for path in (tle_data_dir / constellation / "tle").glob(f"{constellation}_*.tle")
+             if path.stem.rsplit("_", 1)[-1].isdigit() and path.stat().st_size > 0]
+    return max(files, key=lambda path: path.stem.rsplit("_", 1)[-1], default=None)
+
+
+def parse_tle_file(path: Path, constellation: str) -> List[Dict[str, Any]]:
+    """解析三行格式 TLE 檔 (名稱 / 第一行 / 第二行)"""
+    lines = [line.strip() for line in path.read_text(encoding="utf-8", errors="ignore").splitlines() if line.strip()]
+    satellites = []
+    i = 0
+    while i + 2 < len(lines):
+        name, line1, line2 = lines[i:i + 3]
+        if not (line1.startswith("1 ") and line2.startswith("2 ")):
+            i += 1
+            continue
+        norad_id = line1[2:7].strip()
+        satellites.append({
+            "satellite_id": f"{constellation}_{norad_id}",
+            "name": name,
+            "norad_id": int(norad_id) if norad_id.isdigit() else norad_id,
+            "constellation": constellation,
+            "line1": line1,
+            "line2": line2,
+        })
+        i += 3
+    return satellites
+
+
+async def load_tle_satellites(constellations: Sequence[str] = STATE_TABLE_CONSTELLATIONS,
+                              tle_data_dir: Optional[Union[str, Path]] = None) -> List[Dict[str, Any]]:
+    """
+    預設衛星來源：本地收集的 TLE 檔 (與 Stage 6 / 暖啟動快照同一份數據)
+
+    每個星座取最新日期的檔案；不啟動任何網路更新任務。
+    """
+    root = Path(tle_data_dir) if tle_data_dir is not None else default_tle_data_dir()
+    satellites: List[Dict[str, Any]] = []
+    if root is None:
+        logger.warning("找不到 TLE 數據目錄")
+        return satellites
+    for constellation in constellations:
+        path = latest_tle_file(root, constellation)
+        if path is None:
+            logger.warning("找不到星座 TLE 檔", constellation=constellation, tle_data_dir=str(root))
+            continue
+        loaded = await asyncio.to_thread(parse_tle_file, path, constellation)
+        logger.info("衛星狀態表載入 TLE 檔", constellation=constellation, file=str(path), satellites=len(loaded))
+        satellites.extend(loaded)
+    return satellites
+
+
+class SatelliteStateTable:
+    """
+    共享衛星狀態表
+
+    tick_seconds 為模擬時間步長；回放倍速提高時以 SimulationClock.sleep 對應縮短牆鐘間隔，
+    但兩次更新至少相隔 min_wall_interval 秒牆鐘時間。
+    """
+
+    def __init__(self, tick_seconds: float = 1.0, min_wall_interval: float = 0.2,
+                 observers: Optional[Dict[str, Tuple[float, float, float]]] = None,
+                 satellite_loader: Optional[SatelliteLoader] = None,
+                 satellite_refresh_seconds: float = 3600.0):
+        self.tick_seconds = tick_seconds
+        self.min_wall_interval = min_wall_interval
+        self.observers = dict(observers or DEFAULT_OBSERVERS)
+        self.satellite_loader = satellite_loader or load_tle_satellites
+        self.satellite_refresh_seconds = satellite_refresh_seconds
+
+        self._snapshot: Optional[SatelliteStateSnapshot] = None
+        self._propagator: Optional[SGP4StatePropagator] = None
+        self._satellites_loaded_at = 0.0
+        self._generation = 0
+        self._task: Optional[asyncio.Task] = None
+        self._listeners: List[SnapshotListener] = []
+        self._stats = {"refreshes": 0, "refresh_errors": 0, "last_refresh_ms": 0.0}
+
+    @property
+    def snapshot(self) -> Optional[SatelliteStateSnapshot]:
+        return self._snapshot
+
+    @property
+    def ready(self) -> bool:
+        return self._snapshot is not None and len(self._snapshot) > 0
+
+    def set_satellites(self, satellites: Sequence[Dict[str, Any]]) -> None:
+        self._propagator = SGP4StatePropagator(satellites)
+        self._satellites_loaded_at = time.monotonic()
+        logger.info("衛星狀態表衛星集合已更新", satellites=len(self._propagator.satellites))
+
+    def add_listener(self, listener: SnapshotListener) -> None:
+        """
+        註冊換代回呼：每次 refresh 換上新快照後以該快照同步呼叫
+
+        背景更新時回呼在執行緒池中執行，衍生資料 (如波束覆蓋) 因此隨每一代預先建好。
+        """
+        if listener not in self._listeners:
+            self._listeners.append(listener)
+
+    def remove_listener(self, listener: SnapshotListener) -> None:
+        if listener in self._listeners:
+            self._listeners.remove(listener)
+
+    def refresh(self, timestamp: Optional[float] = None) -> SatelliteStateSnapshot:
+        """傳播到指定時刻 (預設為模擬時鐘目前時間) 並替換快照"""
+        if self._propagator is None:
+            raise RuntimeError("衛星狀態表尚未載入衛星")
+        timestamp = get_simulation_clock().timestamp() if timestamp is None else timestamp
+        started = time.perf_counter()
+        ecef, velocity, valid = self._propagator.propagate(timestamp)
+        self._generation += 1
+        snapshot = SatelliteStateSnapshot(self._generation, timestamp, self._propagator.metadata,
+                                          ecef, velocity, valid, self.observers)
+        self._snapshot = snapshot
+        self._stats["refreshes"] += 1
+        self._stats["last_refresh_ms"] = (time.perf_counter() - started) * 1000
+        for listener in list(self._listeners):
+            try:
+                listener(snapshot)
+            except Exception as e:
+                logger.warning("衛星狀態表換代回呼失敗", generation=snapshot.generation, error=str(e))
+        return snapshot
+
+    def snapshot_for(self, request_time: Optional[datetime] = None,
+                     tolerance_seconds: Optional[float] = None) -> Optional[SatelliteStateSnapshot]:
+        """
+        請求時間與目前快照相差在容許範圍內時返回快照，否則返回 None (由呼叫端走原路徑)
+
+        未指定 request_time 表示「目前」，以模擬時鐘判斷；預設容許兩個更新間隔
+        (回放倍速下為 min_wall_interval 對應的模擬時長)。
+        """
+        snapshot = self._snapshot
+        if snapshot is None or len(snapshot) == 0:
+            return None
+        clock = get_simulation_clock()
+        if tolerance_seconds is None:
+            tolerance_seconds = 2 * max(self.tick_seconds, self.min_wall_interval * clock.rate)
+        if request_time is None:
+            target = clock.timestamp()
+        else:
+            if request_time.tzinfo is None:
+                request_time = request_time.replace(tzinfo=timezone.utc)
+            target = request_time.timestamp()
+        return snapshot if abs(target - snapshot.timestamp) <= tolerance_seconds else None
+
+    async def _run(self) -> None:
+        loop = asyncio.get_running_loop()
+        clock = get_simulation_clock()
+        while True:
+            started = time.monotonic()
+            try:
+                if (self._propagator is None
+                        or time.monotonic() - self._satellites_loaded_at >= self.satellite_refresh_seconds):
+                    satellites = await self.satellite_loader()
+                    if not satellites:
+                        raise RuntimeError("衛星來源未返回任何衛星")
+                    self.set_satellites(satellites)
+                await loop.run_in_executor(None, self.refresh)
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                self._stats["refresh_errors"] += 1
+                logger.error("衛星狀態表更新失敗", error=str(e))
+                await asyncio.sleep(5)
+                continue
+            await clock.sleep(self.tick_seconds)
+            await asyncio.sleep(max(0.0, self.min_wall_interval - (time.monotonic() - started)))
+
+    def start(self) -> None:
+        if self._task is None or self._task.done():
+            self._task = asyncio.create_task(self._run())
+            logger.info("衛星狀態表背景更新已啟動", tick_seconds=self.tick_seconds)
+
+    async def stop(self) -> None:
+        if self._task is not None:
+            self._task.cancel()
+            try:
+                await self._task
+            except asyncio.CancelledError:
+                pass
+            self._task = None
+
+    def stats(self) -> Dict[str, Any]:
+        snapshot = self._snapshot
+        return {
+            **self._stats,
+            "ready": self.ready,
+            "generation": snapshot.generation if snapshot else 0,
+            "satellites": len(snapshot) if snapshot else 0,
+            "snapshot_time": snapshot.time.isoformat() if snapshot else None,
+            "observers": list(self.observers),
+            "tick_seconds": self.tick_seconds,
+        }
+
+
+# 進程級狀態表實例
+_state_table: Optional[SatelliteStateTable] = None
+
+
+def get_satellite_state_table() -> SatelliteStateTable:
+    global _state_table
+    if _state_table is None:
+        _state_table = SatelliteStateTable()
+    return _state_table
@@ -0,0 +1,451 @@
+#!/usr/bin/env python3
+"""
+共享模擬時鐘服務
+
+各服務 (SIB19 廣播排程、WebSocket 推送、衛星可見性查詢) 統一向此時鐘取得
+「目前時間」，而非直接呼叫 datetime.utcnow()：
+- live 模式：等同牆鐘 UTC 時間
+- replay 模式：從指定歷史時刻以 N 倍速回放，支援暫停 / 跳轉
+
+ReplayWindowPrefetcher 依回放游標與倍速，在背景預先載入前方的預計算資料時間窗，
+提高回放速率時查詢仍命中快取，不觸發同步重算。
+"""
+
+import asyncio
+import inspect
+import math
+import threading
+import time
+from collections import OrderedDict
+from datetime import datetime, timezone
+from typing import Any, Awaitable, Callable, Dict, List, Optional, Union
+
+import structlog
+
+logger = structlog.get_logger(__name__)
+
+ClockListener = Callable[[Dict[str, Any]], Any]
+WindowLoader = Callable[[datetime], Union[Any, Awaitable[Any]]]
+
+
+def _to_aware_utc(value: Union[datetime, float, int, str]) -> datetime:
+    """將 datetime / Unix 秒 / ISO 字串統一轉為帶時區的 UTC datetime"""
+    if isinstance(value, (int, float)):
+        return datetime.fromtimestamp(float(value), tz=timezone.utc)
+    if isinstance(value, str):
+        value = datetime.fromisoformat(value.replace("Z", "+00:00"))
+    if value.tzinfo is None:
+        return value.replace(tzinfo=timezone.utc)
+    return value.astimezone(timezone.utc)
+
+
+class SimulationClock:
+    """
+    可回放的模擬時鐘
+
+    以 (牆鐘錨點, 模擬錨點, 倍速) 表示時間軸：
+        sim_now = sim_anchor + (monotonic() - wall_anchor) * rate
+    任何控制操作 (播放、暫停、跳轉、改倍速) 都先把目前模擬時間固化為新錨點，
+    因此讀取是無鎖的純計算，控制操作之間保持時間連續。
+    """
+
+    MAX_RATE = 10_000.0
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._wall_anchor = time.monotonic()
+        self._sim_anchor = datetime.now(timezone.utc).timestamp()
+        self._rate = 1.0
+        self._paused = False
+        self._live = True
+        self._generation = 0  # 每次跳轉遞增，供等待者與預取器偵測不連續
+        self._followed_generation: Optional[int] = None  # follow() 最近套用的遠端 generation
+        self._listeners: List[ClockListener] = []
+        self.prefetchers: Dict[str, "ReplayWindowPrefetcher"] = {}
+
+    # ------------------------------------------------------------------
+    # 讀取
+    # ------------------------------------------------------------------
+
+    def timestamp(self) -> float:
+        """目前模擬時間 (Unix 秒)"""
+        if self._live:
+            return time.time()
+        if self._paused:
+            return self._sim_anchor
+        return self._sim_anchor + (time.monotonic() - self._wall_anchor) * self._rate
+
+    def now(self) -> datetime:
+        """目前模擬時間 (帶時區 UTC)，取代 datetime.now(timezone.utc)"""
+        return datetime.fromtimestamp(self.timestamp(), tz=timezone.utc)
+
+    def utcnow(self) -> datetime:
+        """目前模擬時間 (naive UTC)，取代 datetime.utcnow()"""
+        return self.now().replace(tzinfo=None)
+
+    @property
+    def rate(self) -> float:
+        return 1.0 if self._live else self._rate
+
+    @property
+    def paused(self) -> bool:
+        return self._paused and not self._live
+
+    @property
+    def is_replay(self) -> bool:
+        return not self._live
+
+    @property
+    def generation(self) -> int:
+        return self._generation
+
+    def status(self) -> Dict[str, Any]:
+        return {
+            "mode": "live" if self._live else "replay",
+            "simulation_time": self.now().isoformat(),
+            "rate": self.rate,
+            "paused": self.paused,
+            "generation": self._generation,
+            "wall_time": datetime.now(timezone.utc).isoformat(),
+        }
+
+    # ------------------------------------------------------------------
+    # 控制
+    # ------------------------------------------------------------------
+
+    def _rebase(self, sim_timestamp: Optional[float] = None):
+        """固化目前模擬時間為新錨點 (需持有鎖)"""
+        self._sim_anchor = self.timestamp() if sim_timestamp is None else sim_timestamp
+        self._wall_anchor = time.monotonic()
+
+    def play(self, rate: Optional[float] = None,
+             start_time: Optional[Union[datetime, float, str]] = None) -> Dict[str, Any]:
+        """進入回放模式 (可指定起始時刻與倍速)，並解除暫停"""
+        with self._lock:
+            start = None if start_time is None else _to_aware_utc(start_time).timestamp()
+            self._rebase(start)
+            if start is not None:
+                self._generation += 1
+            if rate is not None:
+                self._rate = self._validate_rate(rate)
+            self._live = False
+            self._paused = False
+        return self._notify("play")
+
+    def pause(self) -> Dict[str, Any]:
+        """暫停回放；live 模式下會先凍結於目前時刻並切換為 replay"""
+        with self._lock:
+            self._rebase()
+            self._live = False
+            self._paused = True
+        return self._notify("pause")
+
+    def resume(self) -> Dict[str, Any]:
+        with self._lock:
+            self._rebase()
+            self._paused = False
+        return self._notify("resume")
+
+    def set_rate(self, rate: float) -> Dict[str, Any]:
+        with self._lock:
+            rate = self._validate_rate(rate)
+            self._rebase()
+            self._live = False
+            self._rate = rate
+        return self._notify("rate")
+
+    def seek(self, target: Union[datetime, float, str]) -> Dict[str, Any]:
+        """跳轉至指定模擬時刻 (保持目前的暫停狀態與倍速)"""
+        with self._lock:
+            self._rebase(_to_aware_utc(target).timestamp())
+            self._live = False
+            self._generation += 1
+        return self._notify("seek")
+
+    def go_live(self) -> Dict[str, Any]:
+        """回到牆鐘時間"""
+        with self._lock:
+            self._live = True
+            self._paused = False
+            self._rate = 1.0
+            self._generation += 1
+            self._rebase(time.time())
+        return self._notify("live")
+
+    def follow(self, status: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+        """
+        套用遠端時鐘的 status() 快照 (跨服務同步用)
+
+        遠端 generation 變更視為跳轉：本地 generation 遞增並以 "seek" / "live" 通知，
+        讓本地預取器與等待者重新對齊；其餘變更以 "follow" 通知。狀態未變時不通知。
+        """
+        live = status.get("mode", "live") == "live"
+        remote_generation = status.get("generation")
+        with self._lock:
+            jumped = remote_generation is not None and remote_generation != self._followed_generation
+            changed = jumped or live != self._live
+            self._followed_generation = remote_generation
+            if live:
+                if not self._live:
+                    self._live, self._paused, self._rate = True, False, 1.0
+                    self._rebase(time.time())
+            else:
+                rate = self._validate_rate(status.get("rate", self._rate))
+                paused = bool(status.get("paused", False))
+                changed = changed or rate != self._rate or paused != self._paused
+                sim_time = status.get("simulation_time")
+                if sim_time is not None:
+                    # 持續校正錨點，避免兩端單調時鐘漂移累積
+                    self._rebase(_to_aware_utc(sim_time).timestamp())
+                self._live, self._rate, self._paused = False, rate, paused
+            if not changed:
+                return None
+            if jumped:
+                self._generation += 1
+        return self._notify(("live" if live else "seek") if jumped else "follow")
+
+    def _validate_rate(self, rate: float) -> float:
+        rate = float(rate)
+        if not (0 < rate <= self.MAX_RATE):
+            raise ValueError(f"rate must be in (0, {self.MAX_RATE:g}], got {rate}")
+        return rate
+
+    # ------------------------------------------------------------------
+    # 訂閱
+    # ------------------------------------------------------------------
+
+    def add_listener(self, listener: ClockListener):
+        """註冊控制變更回呼 (同步函數或協程函數皆可)"""
+        if listener not in self._listeners:
+            self._listeners.append(listener)
+
+    def remove_listener(self, listener: ClockListener):
+        if listener in self._listeners:
+            self._listeners.remove(listener)
+
+    def _notify(self, action: str) -> Dict[str, Any]:
+        status = {**self.status(), "action": action}
+        logger.info("模擬時鐘變更", **status)
+        for listener in list(self._listeners):
+            try:
+                result = listener(status)
+                if inspect.isawaitable(result):
+                    try:
+                        asyncio.get_running_loop().create_task(result)
+                    except RuntimeError:
+                        result.close()  # 無事件迴圈 (同步呼叫端)，丟棄協程
+            except Exception as e:
+                logger.warning("模擬時鐘監聽器失敗", action=action, error=str(e))
+        return status
+
+    # ------------------------------------------------------------------
+    # 等待
+    # ------------------------------------------------------------------
+
+    def wall_seconds_for(self, sim_seconds: float) -> float:
+        """模擬時長換算成牆鐘時長 (依目前倍速)"""
+        return sim_seconds / self.rate
+
+    async def sleep(self, sim_seconds: float, max_wall_slice: float = 0.5):
+        """
+        等待一段模擬時間
+
+        依倍速縮放牆鐘等待；暫停期間不前進。遇到跳轉 (generation 變更) 立即返回，
+        讓週期性任務在新時刻重新對齊，而不是按舊時間軸補跑。
+        """
+        generation = self._generation
+        target = self.timestamp() + sim_seconds
+        while True:
+            if self._generation != generation:
+                return
+            if self.paused:
+                await asyncio.sleep(max_wall_slice)
+                continue
+            remaining = target - self.timestamp()
+            if remaining <= 0:
+                return
+            await asyncio.sleep(min(remaining / self.rate, max_wall_slice))
+
+
+class ReplayWindowPrefetcher:
+    """
+    回放游標前方的預計算資料時間窗預取器
+
+    時間軸自 window_origin 起按 window_seconds 切窗 (對齊預計算資料的取樣點)，loader(window_start) 產生單一時間窗的資料。
+    背景任務依「倍速 × lookahead_wall_seconds」計算需要覆蓋的模擬時長，
+    持續載入游標前方尚未快取的窗；游標後方超過 retain_behind 個窗的資料被淘汰。
+    """
+
+    def __init__(self, name: str, loader: WindowLoader, window_seconds: float,
+                 clock: Optional[SimulationClock] = None,
+                 window_origin: float = 0.0,
+                 lookahead_wall_seconds: float = 10.0,
+                 retain_behind: int = 2,
+                 max_windows: int = 512,
+                 poll_interval: float = 0.5):
+        if window_seconds <= 0:
+            raise ValueError("window_seconds must be positive")
+        self.name = name
+        self.loader = loader
+        self.window_seconds = float(window_seconds)
+        self.window_origin = float(window_origin)
+        self.clock = clock or get_simulation_clock()
+        self.lookahead_wall_seconds = lookahead_wall_seconds
+        self.retain_behind = retain_behind
+        self.max_windows = max_windows
+        self.poll_interval = poll_interval
+
+        self._windows: "OrderedDict[float, Any]" = OrderedDict()
+        self._inflight: Dict[float, asyncio.Future] = {}
+        self._task: Optional[asyncio.Task] = None
+        self._wakeup: Optional[asyncio.Event] = None
+        self.hits = 0
+        self.misses = 0
+        self.prefetched = 0
+        self.evicted = 0
+
+        self.clock.prefetchers[name] = self
+
+    def window_key(self, when: Union[datetime, float]) -> float:
+        ts = _to_aware_utc(when).timestamp() if isinstance(when, datetime) else float(when)
+        index = math.floor((ts - self.window_origin) / self.window_seconds)
+        return self.window_origin + index * self.window_seconds
+
+    async def _load(self, key: float) -> Any:
+        """載入單一時間窗；同一窗的並發請求共用同一次載入"""
+        if key in self._inflight:
+            return await self._inflight[key]
+        future = asyncio.get_running_loop().create_future()
+        self._inflight[key] = future
+        try:
+            result = self.loader(datetime.fromtimestamp(key, tz=timezone.utc))
+            if inspect.isawaitable(result):
+                result = await result
+            self._windows[key] = result
+            self._windows.move_to_end(key)
+            while len(self._windows) > self.max_windows:
+                self._windows.popitem(last=False)
+                self.evicted += 1
+            future.set_result(result)
+            return result
+        except Exception as e:
+            future.set_exception(e)
+            future.exception()  # 已由呼叫端處理，避免未取用例外警告
+            raise
+        finally:
+            del self._inflight[key]
+
+    async def get(self, when: Optional[Union[datetime, float]] = None) -> Any:
+        """取得包含指定時刻 (預設為時鐘目前時刻) 的時間窗資料"""
+        key = self.window_key(self.clock.timestamp() if when is None else when)
+        if key in self._windows:
+            self.hits += 1
+            self._windows.move_to_end(key)
+            return self._windows[key]
+        self.misses += 1
+        return await self._load(key)
+
+    def _horizon_keys(self) -> List[float]:
+        cursor = self.window_key(self.clock.timestamp())
+        span = self.clock.rate * self.lookahead_wall_seconds
+        count = max(2, int(math.ceil(span / self.window_seconds)) + 1)
+        count = min(count, self.max_windows - self.retain_behind)
+        return [cursor + i * self.window_seconds for i in range(count)]
+
+    def _evict_behind(self, cursor: float):
+        floor_key = cursor - self.retain_behind * self.window_seconds
+        for key in [k for k in self._windows if k < floor_key]:
+            del self._windows[key]
+            self.evicted += 1
+
+    async def prefetch_once(self):
+        """依目前游標補齊前方時間窗 (由近而遠)"""
+        keys = self._horizon_keys()
+        self._evict_behind(keys[0])
+        generation = self.clock.generation
+        for key in keys:
+            if self.clock.generation != generation:
+                return  # 跳轉後由下一輪依新游標重新規劃
+            if key not in self._windows and key not in self._inflight:
+                try:
+                    await self._load(key)
+                    self.prefetched += 1
+                except Exception as e:
+                    logger.warning("預取時間窗失敗", prefetcher=self.name, window=key, error=str(e))
+                    return
+
+    async def _run(self):
+        while True:
+            try:
+                if self.clock.is_replay:
+                    await self.prefetch_once()
+                # 不用 wait_for：Python < 3.12 在喚醒與取消同時發生時會吞掉取消，導致 stop() 卡住
+                wakeup = asyncio.ensure_future(self._wakeup.wait())
+                try:
+                    await asyncio.wait({wakeup}, timeout=self.poll_interval)
+                finally:
+                    wakeup.cancel()
+                self._wakeup.clear()
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                logger.error("預取迴圈錯誤", prefetcher=self.name, error=str(e))
+                await asyncio.sleep(self.poll_interval)
+
+    def _on_clock_change(self, status: Dict[str, Any]):
+        if status.get("action") in ("seek", "live"):
+            self._windows.clear()
+        if self._wakeup is not None:
+            self._wakeup.set()
+
+    def start(self):
+        """在目前事件迴圈啟動背景預取 (重複呼叫無副作用)"""
+        if self._task is not None and not self._task.done():
+            return
+        self._wakeup = asyncio.Event()
+        self.clock.add_listener(self._on_clock_change)
+        self._task = asyncio.get_running_loop().create_task(self._run())
+        logger.info("回放預取器已啟動", prefetcher=self.name, window_seconds=self.window_seconds)
+
+    def detach(self):
+        """取消背景預取並從時鐘註銷 (不等待任務結束，可於同步程式碼中呼叫)"""
+        self.clock.remove_listener(self._on_clock_change)
+        self.clock.prefetchers.pop(self.name, None)
+        if self._task is not None:
+            self._task.cancel()
+
+    async def stop(self):
+        task = self._task
+        self.detach()
+        if task is not None:
+            try:
+                await task
+            except asyncio.CancelledError:
+                pass
+            self._task = None
+
+    def stats(self) -> Dict[str, Any]:
+        lookups = self.hits + self.misses
+        return {
+            "name": self.name,
+            "window_seconds": self.window_seconds,
+            "cached_windows": len(self._windows),
+            "hits": self.hits,
+            "misses": self.misses,
+            "hit_rate": self.hits / lookups if lookups else 0.0,
+            "prefetched": self.prefetched,
+            "evicted": self.evicted,
+            "running": self._task is not None and not self._task.done(),
+        }
+
+
+# 全局實例
+_simulation_clock: Optional[SimulationClock] = None
+
+
+def get_simulation_clock() -> SimulationClock:
+    """獲取共享模擬時鐘實例"""
+    global _simulation_clock
+    if _simulation_clock is None:
+        _simulation_clock = SimulationClock()
+    return _simulation_clock
@@ -17,6 +17,8 @@ import structlog
 from fastapi import WebSocket, WebSocketDisconnect
 from pydantic import BaseModel
 
+from .simulation_clock import get_simulation_clock
+
 logger = structlog.get_logger(__name__)
 
 
@@ -36,6 +38,7 @@ class EventType(Enum):
     # 系統事件
     SYSTEM_HEALTH_UPDATE = "system_health_update"
     SYSTEM_ALERT = "system_alert"
+    SIMULATION_CLOCK_UPDATE = "simulation_clock_update"
 
     # 連接事件
     CONNECTION_ESTABLISHED = "connection_established"
@@ -53,6 +56,7 @@ class WebSocketEvent:
     source: str
     priority: int = 0
     channel: Optional[str] = None
+    simulation_time: Optional[datetime] = None
 
 
 class WebSocketConnection:
@@ -84,6 +88,9 @@ class WebSocketConnection:
                 "event_id": event.event_id,
                 "event_type": event.event_type.value,
                 "timestamp": event.timestamp.isoformat(),
+                "simulation_time": (
+                    event.simulation_time or get_simulation_clock().now()
+                ).isoformat(),
                 "data": event.data,
                 "source": event.source,
                 "priority": event.priority,
@@ -182,6 +189,9 @@ class UnifiedWebSocketService:
         # 啟動事件處理器
         self.event_processor_task = asyncio.create_task(self._process_events())
 
+        # 模擬時鐘控制變更 (回放/暫停/跳轉) 即時推送給所有客戶端
+        get_simulation_clock().add_listener(self._on_simulation_clock_change)
+
         logger.info("統一 WebSocket 推送服務已啟動")
 
     async def stop(self):
@@ -190,6 +200,7 @@ class UnifiedWebSocketService:
             return
 
         self.is_running = False
+        get_simulation_clock().remove_listener(self._on_simulation_clock_change)
 
         # 停止任務
         if self.heartbeat_task:
@@ -240,6 +251,7 @@ class UnifiedWebSocketService:
                     "version": "1.0.0",
                     "supported_events": [e.value for e in EventType],
                 },
+                "simulation_clock": get_simulation_clock().status(),
             },
             source="websocket_service",
         )
@@ -438,7 +450,10 @@ class UnifiedWebSocketService:
                     event_id=str(uuid.uuid4()),
                     event_type=EventType.HEARTBEAT,
                     timestamp=datetime.now(),
-                    data={"server_time": datetime.now().isoformat()},
+                    data={
+                        "server_time": datetime.now().isoformat(),
+                        "simulation_clock": get_simulation_clock().status(),
+                    },
                     source="websocket_service",
                 )
 
@@ -451,6 +466,18 @@ class UnifiedWebSocketService:
                 logger.error(f"心跳循環錯誤: {e}")
                 await asyncio.sleep(5)
 
+    async def _on_simulation_clock_change(self, status: Dict[str, Any]):
+        """模擬時鐘控制變更回呼"""
+        await self.broadcast_event(
+            WebSocketEvent(
+                event_id=str(uuid.uuid4()),
+                event_type=EventType.SIMULATION_CLOCK_UPDATE,
+                timestamp=datetime.now(),
+                data=status,
+                source="simulation_clock",
+            )
+        )
+
     def get_stats(self) -> Dict[str, Any]:
         """獲取統計信息"""
         return {
@@ -0,0 +1,441 @@
+"""
+Warm-Start 衛星數據快照
+
+預先建置、帶版本的二進位快照，API 啟動時以 mmap 直接映射並提供查詢，
+不需解析大型 JSON 或等待 PostgreSQL 載入完成。
+
+檔案格式 (little-endian):
+    [0:8)    magic  b"NTNWARM1"
+    [8:12)   uint32 格式版本
+    [12:16)  uint32 header JSON 長度 N
+    [16:16+N) header JSON (資料集版本、衛星清單、欄位、陣列偏移)
+    ...      64-byte 對齊的陣列區段:
+             times  float64[n_times]              (epoch 秒)
+             states float32[n_sats, n_times, n_fields]
+
+PostgreSQL 水合改由背景任務使用 iter_hydration_records() 執行。
+"""
+
+import json
+import mmap
+import os
+import struct
+import logging
+from dataclasses import dataclass
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Optional, Tuple
+
+import numpy as np
+
+from .satellite_state_table import ecef_to_geodetic, gmst_radians
+
+logger = logging.getLogger(__name__)
+
+SNAPSHOT_MAGIC = b"NTNWARM1"
+SNAPSHOT_FORMAT_VERSION = 1
+DEFAULT_SNAPSHOT_PATH = "/app/data/satellite_warm_start.snap"
+
+# 每個 (衛星, 時間點) 的狀態欄位，順序即為陣列最後一維
+STATE_FIELDS = (
+    "position_x", "position_y", "position_z",
+    "velocity_x", "velocity_y", "velocity_z",
+    "elevation_deg", "azimuth_deg", "range_km", "is_visible",
+)
+FIELD_INDEX = {name: i for i, name in enumerate(STATE_FIELDS)}
+
+_HEADER_STRUCT = struct.Struct("<8sII")
+_ALIGNMENT = 64
+
+
+class SnapshotFormatError(Exception):
+    """快照檔案格式或版本不符"""
+
+
+def _align(offset: int) -> int:
+    return (offset + _ALIGNMENT - 1) // _ALIGNMENT * _ALIGNMENT
+
+
+def _parse_time(value: str) -> float:
+    return datetime.fromisoformat(value.replace("Z", "+00:00")).timestamp()
+
+
+# ----------------------------------------------------------------------
+# 建置
+# ----------------------------------------------------------------------
+
+def build_snapshot_from_precomputed(source_path: str, snapshot_path: str,
+                                    dataset_version: Optional[str] = None) -> Dict[str, Any]:
+    """
+    由 Pure Cron 預計算 JSON (constellations → orbit_data → satellites → positions)
+    建置 warm-start 快照
+
+    Returns:
+        建置統計
+    """
+    with open(source_path, "r", encoding="utf-8") as f:
+        precomputed = json.load(f)
+
+    satellites: List[Dict[str, Any]] = []
+    raw_positions: List[List[Dict[str, Any]]] = []
+    for constellation_name, constellation_data in precomputed.get("constellations", {}).items():
+        orbit_data = constellation_data.get("orbit_data", {})
+        for satellite_id, satellite_data in orbit_data.get("satellites", {}).items():
+            positions = satellite_data.get("positions", [])
+            if not positions:
+                continue
+            satellites.append({
+                "satellite_id": satellite_id,
+                "name": satellite_data.get("name", satellite_id),
+                "norad_id": satellite_data.get("norad_id"),
+                "constellation": constellation_name,
+            })
+            raw_positions.append(positions)
+
+    # 所有衛星共用一條時間軸 (聯集)，缺少的時間點以 NaN 填充
+    time_set = set()
+    for positions in raw_positions:
+        time_set.update(_parse_time(p["time"]) for p in positions if p.get("time"))
+    times = np.array(sorted(time_set), dtype=np.float64)
+    time_lookup = {t: i for i, t in enumerate(times.tolist())}
+
+    states = np.full((len(satellites), len(times), len(STATE_FIELDS)), np.nan, dtype=np.float32)
+    for sat_index, positions in enumerate(raw_positions):
+        for pos in positions:
+            if not pos.get("time"):
+                continue
+            t_index = time_lookup[_parse_time(pos["time"])]
+            eci = pos.get("position_eci") or {}
+            vel = pos.get("velocity_eci") or {}
+            visible = pos.get("is_visible")
+            states[sat_index, t_index] = (
+                eci.get("x", np.nan), eci.get("y", np.nan), eci.get("z", np.nan),
+                vel.get("x", np.nan), vel.get("y", np.nan), vel.get("z", np.nan),
+                _or_nan(pos.get("elevation_deg")), _or_nan(pos.get("azimuth_deg")),
+                _or_nan(pos.get("range_km")), np.nan if visible is None else float(bool(visible)),
+            )
+
+    metadata = {
+        "dataset_version": dataset_version or precomputed.get("metadata", {}).get(
+            "version", datetime.now(timezone.utc).strftime("%Y%m%d%H%M%S")),
+        "source_file": os.path.basename(source_path),
+        "source_mtime": os.path.getmtime(source_path),
+        "observer_location": precomputed.get("observer_location", {}),
+    }
+    write_snapshot(snapshot_path, satellites, times, states, metadata)
+
+    return {
+        "snapshot_path": snapshot_path,
+        "satellites": len(satellites),
+        "time_points": len(times),
+        "size_bytes": os.path.getsize(snapshot_path),
+        "dataset_version": metadata["dataset_version"],
+    }
+
+
+def _or_nan(value: Any) -> float:
+    return np.nan if value is None else float(value)
+
+
+def write_snapshot(snapshot_path: str, satellites: List[Dict[str, Any]], times: np.ndarray,
+                   states: np.ndarray, metadata: Dict[str, Any]) -> None:
+    """寫入快照 (先寫暫存檔再原子替換，避免 API 映射到寫入中的檔案)"""
+    times = np.ascontiguousarray(times, dtype="<f8")
+    states = np.ascontiguousarray(states, dtype="<f4")
+    if states.shape != (len(satellites), len(times), len(STATE_FIELDS)):
+        raise ValueError(f"states shape {states.shape} does not match satellites/times/fields")
+
+    header = {
+        "format_version": SNAPSHOT_FORMAT_VERSION,
+        "metadata": metadata,
+        "fields": list(STATE_FIELDS),
+        "satellites": satellites,
+        "n_times": int(len(times)),
+        "times_offset": 0,
+        "states_offset": 0,
+    }
+    # 偏移量取決於 header 長度，先以佔位值計算再回填
+    for _ in range(2):
+        header_bytes = json.dumps(header, ensure_ascii=False, default=str).encode("utf-8")
+        times_offset = _align(_HEADER_STRUCT.size + len(header_bytes))
+        states_offset = _align(times_offset + times.nbytes)
+        if header["times_offset"] == times_offset and header["states_offset"] == states_offset:
+            break
+        header["times_offset"] = times_offset
+        header["states_offset"] = states_offset
+    header_bytes = json.dumps(header, ensure_ascii=False, default=str).encode("utf-8")
+
+    tmp_path = f"{snapshot_path}.tmp"
+    Path(snapshot_path).parent.mkdir(parents=True, exist_ok=True)
+    with open(tmp_path, "wb") as f:
+        f.write(_HEADER_STRUCT.pack(SNAPSHOT_MAGIC, SNAPSHOT_FORMAT_VERSION, len(header_bytes)))
+        f.write(header_bytes)
+        f.write(b"\0" * (header["times_offset"] - f.tell()))
+        f.write(times.tobytes())
+        f.write(b"\0" * (header["states_offset"] - f.tell()))
+        f.write(states.tobytes())
+    os.replace(tmp_path, snapshot_path)
+
+
+# ----------------------------------------------------------------------
+# 讀取
+# ----------------------------------------------------------------------
+
+@dataclass
+class SnapshotSatelliteState:
+    """單顆衛星於某時間點的狀態"""
+    satellite_id: str
+    name: str
+    constellation: str
+    timestamp: float
+    position_x: float
+    position_y: float
+    position_z: float
+    velocity_x: float
+    velocity_y: float
+    velocity_z: float
+    elevation_deg: float
+    azimuth_deg: float
+    range_km: float
+    is_visible: bool
+
+    def to_dict(self) -> Dict[str, Any]:
+        data = self.__dict__.copy()
+        data["timestamp"] = datetime.fromtimestamp(self.timestamp, tz=timezone.utc).isoformat()
+        return data
+
+
+class WarmStartSnapshot:
+    """以 mmap 映射的唯讀快照，開啟成本與檔案大小無關"""
+
+    def __init__(self, path: str):
+        self.path = path
+        self._file = open(path, "rb")
+        try:
+            self._mmap = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        except Exception:
+            self._file.close()
+            raise
+
+        magic, version, header_len = _HEADER_STRUCT.unpack_from(self._mmap, 0)
+        if magic != SNAPSHOT_MAGIC:
+            self.close()
+            raise SnapshotFormatError(f"not a warm-start snapshot: {path}")
+        if version != SNAPSHOT_FORMAT_VERSION:
+            self.close()
+            raise SnapshotFormatError(f"unsupported snapshot version {version} (expected {SNAPSHOT_FORMAT_VERSION})")
+
+        header = json.loads(bytes(self._mmap[_HEADER_STRUCT.size:_HEADER_STRUCT.size + header_len]))
+        if header["fields"] != list(STATE_FIELDS):
+            self.close()
+            raise SnapshotFormatError("snapshot field layout does not match this build")
+
+        self.metadata: Dict[str, Any] = header["metadata"]
+        self.satellites: List[Dict[str, Any]] = header["satellites"]
+        n_sats, n_times = len(self.satellites), header["n_times"]
+
+        self.times = np.frombuffer(self._mmap, dtype="<f8", count=n_times, offset=header["times_offset"])
+        self.states = np.frombuffer(
+            self._mmap, dtype="<f4", count=n_sats * n_times * len(STATE_FIELDS),
+            offset=header["states_offset"]
+        ).reshape(n_sats, n_times, len(STATE_FIELDS))
+
+        self._constellations = np.array([s["constellation"].lower() for s in self.satellites])
+        self._index_by_id = {s["satellite_id"]: i for i, s in enumerate(self.satellites)}
+
+    @property
+    def dataset_version(self) -> str:
+        return self.metadata.get("dataset_version", "unknown")
+
+    @property
+    def satellite_count(self) -> int:
+        return len(self.satellites)
+
+    @property
+    def time_range(self) -> Tuple[float, float]:
+        if not len(self.times):
+            return (0.0, 0.0)
+        return float(self.times[0]), float(self.times[-1])
+
+    @property
+    def time_step_seconds(self) -> float:
+        """取樣間隔 (相鄰時間點差的中位數)"""
+        if len(self.times) < 2:
+            return 0.0
+        return float(np.median(np.diff(self.times)))
+
+    def covers(self, timestamp: float) -> bool:
+        """時間點是否落在快照範圍內 (兩端各容許半個取樣間隔)"""
+        if not len(self.times):
+            return False
+        start, end = self.time_range
+        margin = self.time_step_seconds / 2
+        return start - margin <= timestamp <= end + margin
+
+    def nearest_time_index(self, timestamp: float) -> int:
+        """找出最接近的時間索引 (二分搜尋)"""
+        index = int(np.searchsorted(self.times, timestamp))
+        if index <= 0:
+            return 0
+        if index >= len(self.times):
+            return len(self.times) - 1
+        return index if self.times[index] - timestamp < timestamp - self.times[index - 1] else index - 1
+
+    def get_satellites_at(self, timestamp: Optional[float] = None, constellation: Optional[str] = None,
+                          min_elevation_deg: Optional[float] = None, limit: Optional[int] = None,
+                          clamp: bool = False) -> Optional[List[SnapshotSatelliteState]]:
+        """
+        查詢某時間點的衛星狀態，直接從映射記憶體切片，無需計算
+
+        Args:
+            timestamp: epoch 秒，預設為當前時間
+            constellation: 星座過濾
+            min_elevation_deg: 最低仰角過濾 (結果依仰角降序)
+            limit: 返回數量上限
+            clamp: 時間超出快照範圍時改用最近端點；預設返回 None，避免以過期位置回應
+
+        Returns:
+            衛星狀態列表；時間超出快照範圍且 clamp=False 時為 None
+        """
+        if not len(self.times) or not self.satellites:
+            return []
+        if timestamp is None:
+            timestamp = datetime.now(timezone.utc).timestamp()
+        if not clamp and not self.covers(timestamp):
+            return None
+        t_index = self.nearest_time_index(timestamp)
+        frame = self.states[:, t_index, :]
+
+        mask = ~np.isnan(frame[:, FIELD_INDEX["position_x"]])
+        if constellation:
+            mask &= self._constellations == constellation.lower()
+        elevation = frame[:, FIELD_INDEX["elevation_deg"]]
+        if min_elevation_deg is not None:
+            mask &= elevation >= min_elevation_deg
+
+        indices = np.flatnonzero(mask)
+        if min_elevation_deg is not None:
+            indices = indices[np.argsort(-elevation[indices], kind="stable")]
+        if limit is not None:
+            indices = indices[:limit]
+
+        t = float(self.times[t_index])
+        return [self._state(i, t, frame[i]) for i in indices]
+
+    def get_satellite_track(self, satellite_id: str) -> Optional[np.ndarray]:
+        """取得單顆衛星的完整時間序列 (複本，呼叫端持有時不會阻止 close() 解除映射)"""
+        index = self._index_by_id.get(satellite_id)
+        return None if index is None else self.states[index].copy()
+
+    def _state(self, sat_index: int, timestamp: float, row: np.ndarray) -> SnapshotSatelliteState:
+        sat = self.satellites[sat_index]
+        values = row.tolist()
+        return SnapshotSatelliteState(
+            satellite_id=sat["satellite_id"],
+            name=sat["name"],
+            constellation=sat["constellation"],
+            timestamp=timestamp,
+            position_x=values[0], position_y=values[1], position_z=values[2],
+            velocity_x=values[3], velocity_y=values[4], velocity_z=values[5],
+            elevation_deg=values[6], azimuth_deg=values[7], range_km=values[8],
+            is_visible=bool(values[9] > 0.5),
+        )
+
+    def iter_hydration_records(self, batch_size: int = 5000) -> Iterator[List[Tuple]]:
+        """
+        產生 satellite_orbital_cache 水合用的記錄批次
+
+        每筆欄位順序與 HYDRATION_COLUMNS 相同 (18 欄):
+            (satellite_id, norad_id, constellation, timestamp,
+             position_x, position_y, position_z, velocity_x, velocity_y, velocity_z,
+             latitude, longitude, altitude, elevation_angle, azimuth_angle,
+             observer_latitude, observer_longitude, observer_altitude)
+        constellation 固定為 "precomputed"，觀測點欄位取自快照標頭的 observer_location；
+        星下點由 ECI 位置以 GMST 旋轉至 ECEF 後換算 WGS84 (高度 km)，與其他寫入端一致。
+        """
+        observer = self.metadata.get("observer_location", {})
+        batch: List[Tuple] = []
+        timestamps = [datetime.fromtimestamp(t, tz=timezone.utc) for t in self.times.tolist()]
+        gmst = np.array([gmst_radians(t / 86400.0 + 2440587.5, 0.0) for t in self.times.tolist()])
+        cos_gmst, sin_gmst = np.cos(gmst), np.sin(gmst)
+        for sat_index, sat in enumerate(self.satellites):
+            track = self.states[sat_index]
+            norad_id = sat.get("norad_id")
+            norad_id = int(norad_id) if str(norad_id).isdigit() else None
+            valid = np.flatnonzero(~np.isnan(track[:, 0]))
+            eci = track[valid, :3].astype(np.float64)
+            c, s = cos_gmst[valid], sin_gmst[valid]
+            ecef = np.stack([c * eci[:, 0] + s * eci[:, 1], -s * eci[:, 0] + c * eci[:, 1], eci[:, 2]], axis=1)
+            lat, lon, alt = ecef_to_geodetic(ecef)
+            for t_index, row, la, lo, al in zip(valid.tolist(), track[valid].tolist(),
+                                                lat.tolist(), lon.tolist(), alt.tolist()):
+                batch.append((
+                    sat["satellite_id"], norad_id, "precomputed", timestamps[t_index],
+                    row[0], row[1], row[2], row[3], row[4], row[5],
+                    la, lo, al, row[6], row[7],
+                    observer.get("lat"), observer.get("lon"), observer.get("alt"),
+                ))
+                if len(batch) >= batch_size:
+                    yield batch
+                    batch = []
+        if batch:
+            yield batch
+
+    def close(self):
+        """
+        解除映射並關閉檔案
+
+        numpy 視圖持有 mmap 的緩衝區匯出，需先釋放 times / states 才能關閉；
+        仍有其他視圖 (如進行中的水合迭代) 時記錄警告並放開映射參考，
+        映射在最後一個視圖釋放時由 mmap 物件回收。
+        """
+        self.times = None
+        self.states = None
+        if self._mmap is not None:
+            try:
+                self._mmap.close()
+            except BufferError:
+                logger.warning(f"⚠️ Warm-start 快照仍有使用中的視圖，映射將於視圖釋放後回收: {self.path}")
+            self._mmap = None
+        self._file.close()
+
+
+HYDRATION_COLUMNS = [
+    "satellite_id", "norad_id", "constellation", "timestamp",
+    "position_x", "position_y", "position_z",
+    "velocity_x", "velocity_y", "velocity_z",
+    "latitude", "longitude", "altitude",
+    "elevation_angle", "azimuth_angle",
+    "observer_latitude", "observer_longitude", "observer_altitude",
+]
+
+
+# 進程級快照實例
+_snapshot: Optional[WarmStartSnapshot] = None
+
+
+def load_warm_start_snapshot(path: Optional[str] = None) -> Optional[WarmStartSnapshot]:
+    """映射快照並設為進程級實例；檔案不存在或格式不符時返回 None"""
+    global _snapshot
+    path = path or os.getenv("WARM_START_SNAPSHOT_PATH", DEFAULT_SNAPSHOT_PATH)
+    if _snapshot is not None and _snapshot.path == path:
+        return _snapshot
+    if not os.path.exists(path):
+        logger.warning(f"⚠️ Warm-start 快照不存在: {path}")
+        return None
+    try:
+        snapshot = WarmStartSnapshot(path)
+    except (SnapshotFormatError, OSError, ValueError, KeyError) as e:
+        logger.error(f"❌ Warm-start 快照無法映射: {e}")
+        return None
+    if _snapshot is not None:
+        _snapshot.close()
+    _snapshot = snapshot
+    logger.info(f"✅ Warm-start 快照已映射: {snapshot.satellite_count} 顆衛星, "
+                f"{len(snapshot.times)} 個時間點, 版本 {snapshot.dataset_version}")
+    return _snapshot
+
+
+def get_warm_start_snapshot() -> Optional[WarmStartSnapshot]:
+    """取得已映射的快照 (未載入時返回 None)"""
+    return _snapshot
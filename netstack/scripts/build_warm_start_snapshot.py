@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""
+Warm-Start 快照建置腳本
+
+於映像建置或 Cron 預計算完成後執行，將預計算 JSON 轉為 API 啟動時
+直接 mmap 的二進位快照 (見 netstack_api/services/warm_start_snapshot.py)
+"""
+
+import argparse
+import logging
+import sys
+import time
+
+# 添加 netstack_api 到路徑
+sys.path.append('/app')
+
+from netstack_api.services.warm_start_snapshot import (
+    build_snapshot_from_precomputed,
+    DEFAULT_SNAPSHOT_PATH,
+    WarmStartSnapshot
+)
+
+logging.basicConfig(level=logging.INFO, format="%(asctime)s - %(levelname)s - %(message)s")
+logger = logging.getLogger(__name__)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="建置 NetStack warm-start 衛星快照")
+    parser.add_argument("--source", default="/app/data/sgp4_orbital_dataset.json",
+                        help="Pure Cron 預計算 JSON 路徑")
+    parser.add_argument("--output", default=DEFAULT_SNAPSHOT_PATH, help="快照輸出路徑")
+    parser.add_argument("--dataset-version", default=None, help="資料集版本標籤 (預設取自來源 metadata)")
+    args = parser.parse_args()
+
+    start = time.time()
+    stats = build_snapshot_from_precomputed(args.source, args.output, args.dataset_version)
+    logger.info(f"✅ 快照建置完成: {stats['satellites']} 顆衛星, {stats['time_points']} 個時間點, "
+                f"{stats['size_bytes']:,} bytes, 耗時 {time.time() - start:.1f}s")
+
+    # 驗證快照可映射並量測開啟時間
+    open_start = time.perf_counter()
+    snapshot = WarmStartSnapshot(args.output)
+    first_query = snapshot.get_satellites_at(timestamp=snapshot.time_range[0], limit=1)
+    elapsed_ms = (time.perf_counter() - open_start) * 1000
+    snapshot.close()
+    logger.info(f"✅ 快照驗證通過: 映射 + 首次查詢 {elapsed_ms:.2f}ms ({len(first_query)} 筆)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+決策引擎負載基準測試腳本
+
+以合成 UE 族群與本地 TLE 星座驅動接入/換手/事件觸發決策引擎
+(見 src/benchmarks/decision_engine_load.py)。
+指定 --baseline 時與基準結果比較，發現回歸則以非零狀態碼結束。
+"""
+
+import argparse
+import json
+import logging
+import sys
+from pathlib import Path
+
+NETSTACK_ROOT = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(NETSTACK_ROOT / "src" / "benchmarks"))
+
+from decision_engine_load import (
+    DEFAULT_TLE_ROOT,
+    LoadProfile,
+    WORK_KINDS,
+    compare_with_baseline,
+    run_benchmark,
+    save_result,
+)
+
+logging.basicConfig(level=logging.INFO, format="%(asctime)s - %(levelname)s - %(message)s")
+logger = logging.getLogger(__name__)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="NetStack 決策引擎大規模負載基準測試")
+    parser.add_argument("--ues", type=int, default=10_000, help="合成 UE 數量 (10k–1M)")
+    parser.add_argument("--duration", type=float, default=120.0, help="模擬時長 (秒)")
+    parser.add_argument("--tick", type=float, default=1.0, help="模擬步長 (秒)")
+    parser.add_argument("--report-rate", type=float, default=200.0, help="全體 UE 每模擬秒測量報告數")
+    parser.add_argument("--engines", nargs="+", choices=WORK_KINDS, default=list(WORK_KINDS),
+                        help="要驅動的決策引擎")
+    parser.add_argument("--workers", type=int, default=8, help="決策工作協程數")
+    parser.add_argument("--queue-size", type=int, default=1024, help="有界請求佇列大小")
+    parser.add_argument("--pacing", choices=("closed", "paced"), default="closed",
+                        help="closed=最大吞吐; paced=依 --time-scale 對齊牆鐘")
+    parser.add_argument("--time-scale", type=float, default=1.0, help="paced 模式的模擬/牆鐘時間比")
+    parser.add_argument("--constellations", nargs="+", default=["starlink", "oneweb"])
+    parser.add_argument("--max-satellites", type=int, default=None)
+    parser.add_argument("--start-time", default=None, help="模擬起始時間 (ISO 8601，預設最新 TLE 歷元)")
+    parser.add_argument("--tle-root", default=str(DEFAULT_TLE_ROOT))
+    parser.add_argument("--seed", type=int, default=20250801)
+    parser.add_argument("--output", default="decision_engine_benchmark.json", help="結果 JSON 路徑")
+    parser.add_argument("--baseline", default=None, help="回歸比較用的基準結果 JSON")
+    parser.add_argument("--throughput-tolerance", type=float, default=0.10)
+    parser.add_argument("--latency-tolerance", type=float, default=0.20)
+    parser.add_argument("--verbose-engines", action="store_true", help="保留引擎逐請求日誌")
+    args = parser.parse_args()
+
+    profile = LoadProfile(
+        ue_count=args.ues,
+        simulated_duration_s=args.duration,
+        tick_s=args.tick,
+        report_rate_hz=args.report_rate,
+        engines=tuple(args.engines),
+        workers=args.workers,
+        max_queue_size=args.queue_size,
+        pacing=args.pacing,
+        time_scale=args.time_scale,
+        constellations=tuple(args.constellations),
+        max_satellites=args.max_satellites,
+        start_time=args.start_time,
+        seed=args.seed,
+    )
+    result = run_benchmark(profile, tle_root=Path(args.tle_root), quiet_engines=not args.verbose_engines)
+    save_result(result, Path(args.output))
+    logger.info(f"📄 結果已寫入: {args.output}")
+
+    for kind, metrics in result["latency_ms"].items():
+        decision = metrics["decision"]
+        queue = metrics["queue_delay"]
+        logger.info(f"  {kind:<12} {result['throughput_per_s'][kind]:>9.1f}/s  "
+                    f"決策 p50={decision['p50_ms']:.3f} p99={decision['p99_ms']:.3f}ms  "
+                    f"佇列 p99={queue['p99_ms']:.3f}ms")
+
+    if args.baseline:
+        with open(args.baseline, "r", encoding="utf-8") as f:
+            baseline = json.load(f)
+        regressions = compare_with_baseline(result, baseline, args.throughput_tolerance, args.latency_tolerance)
+        if regressions:
+            for regression in regressions:
+                logger.error(f"❌ 回歸: {regression}")
+            sys.exit(1)
+        logger.info("✅ 未發現效能回歸")
+
+
+if __name__ == "__main__":
+    main()
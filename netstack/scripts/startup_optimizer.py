@@ -40,6 +40,9 @@ class StartupOptimizer:
             "enhanced_data_summary.json",
             "enhanced_build_config.json",
         ]
+        self.warm_start_snapshot = os.getenv(
+            "WARM_START_SNAPSHOT_PATH", "/app/data/satellite_warm_start.snap"
+        )
 
     def record_startup_time(self):
         """記錄啟動時間"""
@@ -87,6 +90,22 @@ class StartupOptimizer:
         for required_file in self.required_files:
             file_path = data_path / required_file
 
+            # warm-start 快照存在時 API 直接 mmap 快照，無需解析大型 JSON
+            if (
+                required_file == "enhanced_satellite_data.json"
+                and file_path.exists()
+                and Path(self.warm_start_snapshot).exists()
+            ):
+                logger.info(
+                    f"⚡ {required_file}: 已由 warm-start 快照取代，跳過 JSON 解析 "
+                    f"({self.warm_start_snapshot})"
+                )
+                preloaded_data[required_file] = {
+                    "warm_start_snapshot": self.warm_start_snapshot,
+                    "snapshot_size_bytes": Path(self.warm_start_snapshot).stat().st_size,
+                }
+                continue
+
             if file_path.exists():
                 try:
                     start_time = time.time()
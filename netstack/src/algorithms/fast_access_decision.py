@@ -378,6 +378,17 @@ class FastAccessDecisionEngine:
             self.logger.error(f"❌ 提交接入請求失敗: {e}")
             raise
     
+    async def decide_access(self, request: AccessRequest,
+                            candidates: Optional[List[AccessCandidate]] = None) -> Optional[AccessPlan]:
+        """
+        立即處理單一接入請求 (不經過輪詢循環)，返回建立的接入計劃或 None
+
+        candidates 由外部提供時 (如真實幾何計算的可見衛星) 取代引擎的候選查詢，
+        同樣套用信號、仰角與過載的基本門檻。
+        """
+        await self.submit_access_request(request)
+        return await self._process_access_request(request, candidates)
+    
     async def cancel_access_request(self, request_id: str) -> bool:
         """取消接入請求"""
         try:
@@ -439,18 +450,23 @@ class FastAccessDecisionEngine:
         except Exception as e:
             self.logger.error(f"❌ 決策處理循環異常: {e}")
     
-    async def _process_access_request(self, request: AccessRequest):
-        """處理接入請求"""
+    async def _process_access_request(self, request: AccessRequest,
+                                      candidates: Optional[List[AccessCandidate]] = None) -> Optional[AccessPlan]:
+        """處理接入請求，返回建立的接入計劃 (拒絕時為 None)"""
         start_time = time.time()
+        plan = None
         
         try:
             # 獲取候選衛星
-            candidates = await self._get_access_candidates(request)
+            if candidates is None:
+                candidates = await self._get_access_candidates(request)
+            else:
+                candidates = self._filter_candidates(candidates)
             
             if not candidates:
                 self.logger.warning(f"⚠️ 請求 {request.request_id} 無可用候選衛星")
                 await self._reject_request(request, AccessDecisionType.REJECT_COVERAGE)
-                return
+                return None
             
             # 評估和排序候選衛星
             evaluated_candidates = await self._evaluate_candidates(request, candidates)
@@ -472,6 +488,7 @@ class FastAccessDecisionEngine:
                     
                     self.logger.info(f"✅ 接入請求已接受: {request.request_id} -> 衛星: {selected_candidate.satellite_id}")
                 else:
+                    plan = None
                     await self._reject_request(request, AccessDecisionType.REJECT_OVERLOAD)
             
             elif decision == AccessDecisionType.CONDITIONAL_ACCEPT:
@@ -494,9 +511,12 @@ class FastAccessDecisionEngine:
                 self.stats['average_decision_time_ms'] = \
                     self.stats['total_decision_time_ms'] / total_requests
             
+            return plan
+            
         except Exception as e:
             self.logger.error(f"❌ 處理接入請求異常: {e}")
             await self._reject_request(request, AccessDecisionType.REJECT_OVERLOAD)
+            return None
     
     async def _get_access_candidates(self, request: AccessRequest) -> List[AccessCandidate]:
         """獲取接入候選衛星"""
@@ -558,12 +578,7 @@ class FastAccessDecisionEngine:
                 candidates.append(candidate)
             
             # 過濾不符合基本要求的候選
-            filtered_candidates = []
-            for candidate in candidates:
-                if (candidate.signal_strength_dbm >= self.decision_config['min_signal_strength_dbm'] and
-                    candidate.elevation_angle >= self.decision_config['min_elevation_angle_deg'] and
-                    not candidate.is_overloaded(self.decision_config['overload_threshold'])):
-                    filtered_candidates.append(candidate)
+            filtered_candidates = self._filter_candidates(candidates)
             
             # 更新緩存
             self.candidate_cache[cache_key] = filtered_candidates
@@ -575,6 +590,15 @@ class FastAccessDecisionEngine:
             self.logger.error(f"❌ 獲取接入候選失敗: {e}")
             return []
     
+    def _filter_candidates(self, candidates: List[AccessCandidate]) -> List[AccessCandidate]:
+        """過濾不符合信號、仰角或過載門檻的候選"""
+        return [
+            candidate for candidate in candidates
+            if (candidate.signal_strength_dbm >= self.decision_config['min_signal_strength_dbm'] and
+                candidate.elevation_angle >= self.decision_config['min_elevation_angle_deg'] and
+                not candidate.is_overloaded(self.decision_config['overload_threshold']))
+        ]
+    
     async def _evaluate_candidates(self, request: AccessRequest, 
                                   candidates: List[AccessCandidate]) -> List[AccessCandidate]:
         """評估候選衛星"""
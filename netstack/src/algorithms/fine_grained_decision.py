@@ -335,11 +335,22 @@ class FineGrainedHandoverDecisionEngine:
             # 從待處理列表移除
             del self.pending_requests[request.request_id]
     
-    async def _make_handover_decision(self, request: HandoverRequest) -> Optional[HandoverPlan]:
+    async def decide_handover(self, request: HandoverRequest,
+                              candidates: Optional[List[SatelliteCandidate]] = None) -> Optional[HandoverPlan]:
+        """
+        立即為單一請求制定切換決策 (不進入待處理佇列、不執行計劃)
+
+        candidates 由外部提供時取代引擎的候選查詢與緩存。
+        """
+        return await self._make_handover_decision(request, candidates)
+    
+    async def _make_handover_decision(self, request: HandoverRequest,
+                                      candidates: Optional[List[SatelliteCandidate]] = None) -> Optional[HandoverPlan]:
         """制定切換決策"""
         try:
             # 1. 獲取候選衛星
-            candidates = await self._get_satellite_candidates(request.user_id, request.current_satellite_id)
+            if candidates is None:
+                candidates = await self._get_satellite_candidates(request.user_id, request.current_satellite_id)
             if not candidates:
                 self.logger.warning(f"⚠️ 沒有可用的候選衛星: {request.request_id}")
                 return None
@@ -0,0 +1,1042 @@
+#!/usr/bin/env python3
+"""
+決策引擎大規模負載基準測試 (閉環)
+
+以 10k–1M 個合成 UE 驅動三個決策引擎：
+- FastAccessDecisionEngine          (接入請求)
+- FineGrainedHandoverDecisionEngine (換手請求)
+- HandoverEventTriggerService       (測量報告 → A4/A5/D2 事件決策)
+
+流程：
+1. 從本地 TLE 載入星座，以 SGP4 (SatrecArray) 逐步推進，TEME → ECEF
+2. UE 族群以 numpy 陣列保存位置/速度/航向，依移動類型向量化推進
+3. 每個模擬步抽樣回報 UE，分塊向量化計算仰角/距離/RSRP，產生測量報告、
+   接入與換手請求，放入有界佇列
+4. 工作協程經由引擎的公開決策入口 (decide_access / decide_handover /
+   process_satellite_measurements) 直接決策 (不經引擎內部輪詢迴圈)，並把決策結果
+   回寫到 UE 服務衛星狀態 (閉環)
+5. 以可合併直方圖記錄佇列延遲、決策延遲與端到端延遲，輸出 JSON 結果，
+   可作為回歸基準比較
+
+完全離線：只讀取 netstack/tle_data 下的 TLE 檔案，不需要資料庫或網路。
+工作負載在相同 seed 下可重現；延遲數值取決於執行環境。
+"""
+
+import asyncio
+import heapq
+import json
+import logging
+import math
+import random
+import sys
+import time
+from dataclasses import asdict, dataclass
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+import numpy as np
+
+# 與其他 src 模組一致：加入 src 與 netstack 根目錄以便匯入引擎與共用服務
+SRC_DIR = Path(__file__).resolve().parent.parent
+NETSTACK_ROOT = SRC_DIR.parent
+for _path in (str(SRC_DIR), str(NETSTACK_ROOT)):
+    if _path not in sys.path:
+        sys.path.insert(0, _path)
+
+try:
+    from sgp4.api import SatrecArray, Satrec, jday
+    SGP4_AVAILABLE = True
+except ImportError:
+    SGP4_AVAILABLE = False
+
+from netstack_api.services.latency_sketch import LatencyHistogram, WindowedLatencySketches
+
+logger = logging.getLogger(__name__)
+
+EARTH_RADIUS_KM = 6371.0
+WGS84_A_KM = 6378.137
+WGS84_E2 = 6.69437999014e-3
+SPEED_OF_LIGHT_KM_S = 299792.458
+DEFAULT_TLE_ROOT = NETSTACK_ROOT / "tle_data"
+
+# NTPU 觀測點 (與其他服務的預設觀測位置一致)
+DEFAULT_CENTER_LAT = 24.9441667
+DEFAULT_CENTER_LON = 121.3713889
+
+WORK_ACCESS = "access"
+WORK_HANDOVER = "handover"
+WORK_MEASUREMENT = "measurement"
+WORK_KINDS = (WORK_ACCESS, WORK_HANDOVER, WORK_MEASUREMENT)
+
+RESULT_FORMAT_VERSION = 1
+
+
+# ----------------------------------------------------------------------
+# 配置
+# ----------------------------------------------------------------------
+
+
+@dataclass
+class MobilityClass:
+    """UE 移動類型"""
+
+    name: str
+    share: float
+    min_speed_mps: float
+    max_speed_mps: float
+    turn_sigma_rad: float  # 每 sqrt(秒) 的航向隨機漫步標準差
+    altitude_m: float = 0.0
+
+
+DEFAULT_MOBILITY_MIX = (
+    MobilityClass("stationary", 0.45, 0.0, 0.0, 0.0),
+    MobilityClass("pedestrian", 0.25, 0.5, 2.0, 0.30),
+    MobilityClass("vehicular", 0.25, 8.0, 33.0, 0.05),
+    MobilityClass("aircraft", 0.05, 200.0, 250.0, 0.005, altitude_m=10_000.0),
+)
+
+DEFAULT_SERVICE_MIX = {"data": 0.60, "video": 0.15, "voice": 0.15, "iot": 0.10}
+
+
+@dataclass
+class LoadProfile:
+    """負載設定 (全部欄位都會寫入結果 JSON 以便比較)"""
+
+    ue_count: int = 10_000
+    simulated_duration_s: float = 120.0
+    tick_s: float = 1.0
+    # 全體 UE 每模擬秒產生的測量報告數
+    report_rate_hz: float = 200.0
+    engines: Tuple[str, ...] = WORK_KINDS
+    workers: int = 8
+    max_queue_size: int = 1024
+    # closed: 生成器只受佇列背壓限制 (量測最大吞吐)
+    # paced:  依 time_scale 將模擬時間對齊到牆鐘 (量測給定負載下的延遲)
+    pacing: str = "closed"
+    time_scale: float = 1.0
+
+    # 區域 (以中心點為原點的局部平面，半徑內反彈)
+    center_lat: float = DEFAULT_CENTER_LAT
+    center_lon: float = DEFAULT_CENTER_LON
+    region_radius_km: float = 300.0
+
+    # 星座
+    constellations: Tuple[str, ...] = ("starlink", "oneweb")
+    max_satellites: Optional[int] = None
+    start_time: Optional[str] = None  # ISO 8601；預設使用最新 TLE 歷元
+
+    # 鏈路預算與決策門檻
+    min_elevation_deg: float = 10.0
+    carrier_frequency_ghz: float = 2.0
+    eirp_per_re_dbm: float = 45.8
+    shadowing_sigma_db: float = 2.0
+    neighbors_per_report: int = 4
+    handover_hysteresis_db: float = 3.0
+    satellite_user_capacity: int = 2000
+    access_session_s: float = 300.0
+
+    geometry_chunk_size: int = 512
+    timeline_window_s: float = 1.0
+    seed: int = 20250801
+
+
+# ----------------------------------------------------------------------
+# 星座星曆
+# ----------------------------------------------------------------------
+
+
+def _latest_tle_file(tle_root: Path, constellation: str) -> Optional[Path]:
+    files = sorted((tle_root / constellation / "tle").glob(f"{constellation}_*.tle"))
+    return files[-1] if files else None
+
+
+def load_tle_catalog(tle_root: Path = DEFAULT_TLE_ROOT,
+                     constellations: Sequence[str] = ("starlink", "oneweb"),
+                     max_satellites: Optional[int] = None) -> List[Tuple[str, str, str, str]]:
+    """讀取每個星座最新的 TLE 檔案，返回 (名稱, 星座, line1, line2)"""
+    catalog = []
+    for constellation in constellations:
+        path = _latest_tle_file(Path(tle_root), constellation)
+        if path is None:
+            logger.warning(f"⚠️ 找不到 {constellation} 的 TLE 檔案: {tle_root}")
+            continue
+        lines = [line.rstrip() for line in path.read_text().splitlines() if line.strip()]
+        for i in range(0, len(lines) - 2, 3):
+            name, line1, line2 = lines[i].strip(), lines[i + 1], lines[i + 2]
+            if line1.startswith("1 ") and line2.startswith("2 "):
+                catalog.append((name, constellation, line1, line2))
+    if max_satellites is not None:
+        catalog = catalog[:max_satellites]
+    return catalog
+
+
+def _gmst_rad(jd_ut1: float) -> float:
+    """格林威治平恆星時 (IAU 1982)"""
+    t = (jd_ut1 - 2451545.0) / 36525.0
+    seconds = (67310.54841 + (876600.0 * 3600.0 + 8640184.812866) * t
+               + 0.093104 * t * t - 6.2e-6 * t * t * t)
+    return math.radians((seconds % 86400.0) / 240.0)
+
+
+class ConstellationEphemeris:
+    """SGP4 向量化星曆：一次推進整個星座到指定時刻 (ECEF, km)"""
+
+    def __init__(self, catalog: List[Tuple[str, str, str, str]]):
+        if not SGP4_AVAILABLE:
+            raise RuntimeError("sgp4 套件未安裝，無法建立星曆 (pip install sgp4)")
+        if not catalog:
+            raise ValueError("TLE catalog is empty")
+
+        self.names = [entry[0] for entry in catalog]
+        self.constellations = [entry[1] for entry in catalog]
+        self.index_of = {name: i for i, name in enumerate(self.names)}
+        satrecs = [Satrec.twoline2rv(entry[2], entry[3]) for entry in catalog]
+        self._array = SatrecArray(satrecs)
+        self.latest_epoch_jd = max(s.jdsatepoch + s.jdsatepochF for s in satrecs)
+
+    def __len__(self) -> int:
+        return len(self.names)
+
+    def propagate(self, when: datetime) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """返回 (位置 ECEF km [n,3], 速度 ECEF km/s [n,3], 有效遮罩 [n])"""
+        jd, fr = jday(when.year, when.month, when.day, when.hour, when.minute,
+                      when.second + when.microsecond / 1e6)
+        error, r, v = self._array.sgp4(np.array([jd]), np.array([fr]))
+        r_teme = r[:, 0, :]
+        v_teme = v[:, 0, :]
+
+        theta = _gmst_rad(jd + fr)
+        cos_t, sin_t = math.cos(theta), math.sin(theta)
+        rotation = np.array([[cos_t, sin_t, 0.0], [-sin_t, cos_t, 0.0], [0.0, 0.0, 1.0]])
+        positions = r_teme @ rotation.T
+        velocities = v_teme @ rotation.T
+        valid = (error[:, 0] == 0) & np.isfinite(positions).all(axis=1)
+        return positions, velocities, valid
+
+
+def _geodetic_to_ecef(lat_rad: np.ndarray, lon_rad: np.ndarray, alt_km: np.ndarray) -> np.ndarray:
+    sin_lat = np.sin(lat_rad)
+    cos_lat = np.cos(lat_rad)
+    n = WGS84_A_KM / np.sqrt(1.0 - WGS84_E2 * sin_lat * sin_lat)
+    return np.stack([
+        (n + alt_km) * cos_lat * np.cos(lon_rad),
+        (n + alt_km) * cos_lat * np.sin(lon_rad),
+        (n * (1.0 - WGS84_E2) + alt_km) * sin_lat,
+    ], axis=-1)
+
+
+# ----------------------------------------------------------------------
+# 合成 UE 族群
+# ----------------------------------------------------------------------
+
+
+class SyntheticUEPopulation:
+    """結構化陣列保存的 UE 族群 (局部東/北平面座標，km)"""
+
+    def __init__(self, profile: LoadProfile, rng: np.random.Generator,
+                 mobility_mix: Sequence[MobilityClass] = DEFAULT_MOBILITY_MIX,
+                 service_mix: Dict[str, float] = None):
+        n = profile.ue_count
+        self.size = n
+        self.rng = rng
+        self.radius_km = profile.region_radius_km
+        self.center_lat_rad = math.radians(profile.center_lat)
+        self.center_lon_rad = math.radians(profile.center_lon)
+        self.mobility_mix = list(mobility_mix)
+
+        # 區域內均勻分佈
+        r = self.radius_km * np.sqrt(rng.random(n))
+        phi = rng.random(n) * 2 * np.pi
+        self.x_km = (r * np.sin(phi)).astype(np.float32)
+        self.y_km = (r * np.cos(phi)).astype(np.float32)
+
+        shares = np.array([m.share for m in self.mobility_mix], dtype=np.float64)
+        self.mobility = rng.choice(len(self.mobility_mix), size=n, p=shares / shares.sum()).astype(np.int8)
+        min_speed = np.array([m.min_speed_mps for m in self.mobility_mix], dtype=np.float32)
+        max_speed = np.array([m.max_speed_mps for m in self.mobility_mix], dtype=np.float32)
+        self.speed_mps = (min_speed[self.mobility]
+                          + rng.random(n, dtype=np.float32) * (max_speed - min_speed)[self.mobility])
+        self.heading_rad = (rng.random(n, dtype=np.float32) * 2 * np.pi).astype(np.float32)
+        self.turn_sigma = np.array([m.turn_sigma_rad for m in self.mobility_mix], dtype=np.float32)[self.mobility]
+        self.altitude_km = (np.array([m.altitude_m for m in self.mobility_mix], dtype=np.float32)
+                            [self.mobility] / 1000.0)
+
+        service_mix = service_mix or DEFAULT_SERVICE_MIX
+        self.service_names = list(service_mix.keys())
+        service_p = np.array(list(service_mix.values()), dtype=np.float64)
+        self.service = rng.choice(len(self.service_names), size=n, p=service_p / service_p.sum()).astype(np.int8)
+
+        # 閉環狀態：服務衛星索引 (-1 = 未附著)
+        self.serving = np.full(n, -1, dtype=np.int32)
+
+    def advance(self, dt_s: float):
+        """向量化推進所有 UE：航向隨機漫步 + 等速移動，越界時轉向區域中心"""
+        self.heading_rad += (self.rng.standard_normal(self.size, dtype=np.float32)
+                             * self.turn_sigma * np.float32(math.sqrt(dt_s)))
+        step_km = self.speed_mps * np.float32(dt_s / 1000.0)
+        self.x_km += step_km * np.sin(self.heading_rad)
+        self.y_km += step_km * np.cos(self.heading_rad)
+
+        outside = self.x_km * self.x_km + self.y_km * self.y_km > self.radius_km * self.radius_km
+        if outside.any():
+            self.heading_rad[outside] = np.arctan2(-self.x_km[outside], -self.y_km[outside])
+
+    def geodetic(self, indices: np.ndarray) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """局部平面 → 大地座標 (弧度, 弧度, km)"""
+        lat = self.center_lat_rad + self.y_km[indices].astype(np.float64) / EARTH_RADIUS_KM
+        lon = self.center_lon_rad + (self.x_km[indices].astype(np.float64)
+                                     / (EARTH_RADIUS_KM * math.cos(self.center_lat_rad)))
+        return lat, lon, self.altitude_km[indices].astype(np.float64)
+
+    def mobility_counts(self) -> Dict[str, int]:
+        counts = np.bincount(self.mobility, minlength=len(self.mobility_mix))
+        return {m.name: int(c) for m, c in zip(self.mobility_mix, counts)}
+
+
+# ----------------------------------------------------------------------
+# 工作項目
+# ----------------------------------------------------------------------
+
+
+@dataclass
+class CandidateView:
+    """單顆候選衛星的量測視圖 (由向量化幾何結果切出)"""
+
+    index: int
+    rsrp_dbm: float
+    elevation_deg: float
+    azimuth_deg: float
+    range_km: float
+    radial_velocity_km_s: float
+    speed_km_s: float
+    load_fraction: float
+    availability_s: float
+
+
+@dataclass
+class WorkItem:
+    kind: str
+    seq: int
+    ue: int
+    sim_time: datetime
+    latitude: float
+    longitude: float
+    altitude_m: float
+    service: str
+    serving: Optional[CandidateView]
+    candidates: List[CandidateView]
+    previous_serving: int = -1
+    enqueued_at: float = 0.0
+
+
+def _rsrq_proxy(rsrp_dbm: float) -> float:
+    """RSRQ 近似值 (-19.5 ~ -3 dB，隨 RSRP 單調)"""
+    return float(min(-3.0, max(-19.5, -10.8 + 0.1 * (rsrp_dbm + 100.0))))
+
+
+def _quality_score(rsrp_dbm: float) -> float:
+    return float(min(1.0, max(0.0, (rsrp_dbm + 120.0) / 60.0)))
+
+
+# ----------------------------------------------------------------------
+# 引擎轉接器
+# ----------------------------------------------------------------------
+
+
+class DecisionTarget:
+    """把 WorkItem 轉成引擎請求並返回新的服務衛星名稱 (None = 不變)"""
+
+    kind: str = ""
+
+    def __init__(self, benchmark: "DecisionEngineLoadBenchmark"):
+        self.benchmark = benchmark
+
+    async def handle(self, item: WorkItem) -> Optional[str]:
+        raise NotImplementedError
+
+    async def on_tick(self, sim_time: datetime):
+        """每個模擬步呼叫 (釋放資源等)"""
+
+    def silence(self):
+        """關閉引擎逐請求 INFO 日誌，避免基準測試被日誌 I/O 主導"""
+
+    def stats(self) -> Dict[str, Any]:
+        return {}
+
+
+class FastAccessTarget(DecisionTarget):
+    kind = WORK_ACCESS
+
+    def __init__(self, benchmark: "DecisionEngineLoadBenchmark"):
+        super().__init__(benchmark)
+        from algorithms.fast_access_decision import (
+            AccessCandidate, AccessRequest, AccessTrigger, FastAccessDecisionEngine, ServiceClass
+        )
+        self._candidate_cls = AccessCandidate
+        self._request_cls = AccessRequest
+        self._trigger = AccessTrigger
+        self._service_classes = {
+            "data": ServiceClass.DATA, "video": ServiceClass.VIDEO,
+            "voice": ServiceClass.VOICE, "iot": ServiceClass.IOT,
+        }
+        self.engine = FastAccessDecisionEngine(engine_id="bench_fast_access")
+        # (釋放時刻, plan_id)：模擬會話結束後釋放預留資源
+        self._sessions: List[Tuple[datetime, str]] = []
+
+    def _to_candidate(self, view: CandidateView, item: WorkItem):
+        names = self.benchmark.ephemeris.names
+        candidate = self._candidate_cls(
+            satellite_id=names[view.index],
+            beam_id=f"BEAM-{view.index % 16 + 1}",
+            frequency_band="S-band",
+        )
+        candidate.elevation_angle = view.elevation_deg
+        candidate.azimuth_angle = view.azimuth_deg
+        candidate.distance_km = view.range_km
+        candidate.signal_strength_dbm = view.rsrp_dbm
+        candidate.path_loss_db = self.benchmark.profile.eirp_per_re_dbm - view.rsrp_dbm
+        candidate.doppler_shift_hz = self.benchmark.doppler_hz(view.radial_velocity_km_s)
+        candidate.total_capacity_mbps = 1000.0
+        candidate.current_load_percent = view.load_fraction
+        candidate.available_capacity_mbps = candidate.total_capacity_mbps * (1.0 - view.load_fraction)
+        candidate.max_users = self.benchmark.profile.satellite_user_capacity
+        candidate.active_users = int(view.load_fraction * candidate.max_users)
+        load_factor = candidate.calculate_load_factor()
+        candidate.predicted_throughput_mbps = candidate.available_capacity_mbps * 0.8
+        candidate.predicted_latency_ms = 2 * view.range_km / SPEED_OF_LIGHT_KM_S * 1000 + load_factor * 200.0
+        candidate.predicted_packet_loss_rate = load_factor * 0.01
+        candidate.predicted_availability_duration_s = view.availability_s
+        candidate.setup_time_ms = 100.0
+        candidate.signaling_overhead_kb = 5.0
+        candidate.power_consumption_mw = 500.0
+        candidate.interference_level_db = -80.0
+        now = datetime.now(timezone.utc)
+        candidate.visibility_window_start = now
+        candidate.visibility_window_end = now + timedelta(seconds=view.availability_s)
+        candidate.orbital_velocity_kmh = view.speed_km_s * 3600.0
+        return candidate
+
+    async def handle(self, item: WorkItem) -> Optional[str]:
+        engine = self.engine
+        request = self._request_cls(
+            request_id=f"bench-acc-{item.seq}",
+            user_id=f"ue-{item.ue}",
+            device_id=f"dev-{item.ue}",
+            trigger_type=(self._trigger.HANDOVER if item.previous_serving >= 0
+                          else self._trigger.INITIAL_ATTACH),
+            service_class=self._service_classes.get(item.service, self._service_classes["data"]),
+            timestamp=datetime.now(timezone.utc),
+            user_latitude=item.latitude,
+            user_longitude=item.longitude,
+            user_altitude_m=item.altitude_m,
+            current_satellite_id=(self.benchmark.ephemeris.names[item.previous_serving]
+                                  if item.previous_serving >= 0 else None),
+        )
+
+        # 以真實幾何候選取代引擎的模擬候選 (引擎套用同樣的基本門檻)
+        plan = await engine.decide_access(
+            request, [self._to_candidate(view, item) for view in item.candidates]
+        )
+        if plan is None:
+            return None
+        release_at = item.sim_time + timedelta(seconds=self.benchmark.profile.access_session_s)
+        heapq.heappush(self._sessions, (release_at, plan.plan_id))
+        return plan.selected_candidate.satellite_id
+
+    async def on_tick(self, sim_time: datetime):
+        while self._sessions and self._sessions[0][0] <= sim_time:
+            _, plan_id = heapq.heappop(self._sessions)
+            await self.engine.cancel_access_request(plan_id)
+
+    def silence(self):
+        self.engine.logger.setLevel(logging.WARNING)
+
+    def stats(self) -> Dict[str, Any]:
+        stats = {k: v for k, v in self.engine.stats.items() if isinstance(v, (int, float))}
+        stats["active_plans"] = len(self.engine.active_plans)
+        return stats
+
+
+class FineGrainedHandoverTarget(DecisionTarget):
+    kind = WORK_HANDOVER
+
+    def __init__(self, benchmark: "DecisionEngineLoadBenchmark"):
+        super().__init__(benchmark)
+        from algorithms.fine_grained_decision import (
+            FineGrainedHandoverDecisionEngine, HandoverRequest, HandoverTrigger, SatelliteCandidate
+        )
+        self._candidate_cls = SatelliteCandidate
+        self._request_cls = HandoverRequest
+        self._trigger = HandoverTrigger
+        self.engine = FineGrainedHandoverDecisionEngine(engine_id="bench_fine_grained")
+        self.plans = 0
+        self.no_plan = 0
+
+    def _to_candidate(self, view: CandidateView):
+        load_percent = view.load_fraction * 100.0
+        return self._candidate_cls(
+            satellite_id=self.benchmark.ephemeris.names[view.index],
+            signal_strength_dbm=view.rsrp_dbm,
+            elevation_angle=view.elevation_deg,
+            azimuth_angle=view.azimuth_deg,
+            distance_km=view.range_km,
+            velocity_kmh=view.speed_km_s * 3600.0,
+            doppler_shift_hz=self.benchmark.doppler_hz(view.radial_velocity_km_s),
+            available_bandwidth_mbps=200.0 * (1.0 - view.load_fraction),
+            current_load_percent=load_percent,
+            user_count=int(view.load_fraction * self.benchmark.profile.satellite_user_capacity),
+            beam_capacity_percent=load_percent,
+            predicted_throughput_mbps=100.0 * (1.0 - view.load_fraction),
+            predicted_latency_ms=2 * view.range_km / SPEED_OF_LIGHT_KM_S * 1000 + load_percent,
+            predicted_reliability=0.85 + 0.14 * _quality_score(view.rsrp_dbm),
+            predicted_availability_duration_s=view.availability_s,
+            handover_delay_ms=30.0 + view.range_km / SPEED_OF_LIGHT_KM_S * 1000,
+            signaling_overhead_kb=10.0,
+            resource_preparation_ms=20.0,
+        )
+
+    async def handle(self, item: WorkItem) -> Optional[str]:
+        engine = self.engine
+        serving_name = self.benchmark.ephemeris.names[item.serving.index]
+        request = self._request_cls(
+            request_id=f"bench-ho-{item.seq}",
+            user_id=f"ue-{item.ue}",
+            current_satellite_id=serving_name,
+            trigger_type=self._trigger.SIGNAL_STRENGTH,
+            priority=5,
+            timestamp=datetime.now(timezone.utc),
+            service_type=item.service,
+            current_signal_strength_dbm=item.serving.rsrp_dbm,
+        )
+
+        plan = await engine.decide_handover(request, [self._to_candidate(v) for v in item.candidates])
+
+        if plan is None:
+            self.no_plan += 1
+            return None
+        self.plans += 1
+        return plan.target_satellite.satellite_id
+
+    def silence(self):
+        self.engine.logger.setLevel(logging.WARNING)
+
+    def stats(self) -> Dict[str, Any]:
+        return {"plans": self.plans, "no_plan": self.no_plan}
+
+
+class TriggerServiceTarget(DecisionTarget):
+    kind = WORK_MEASUREMENT
+
+    def __init__(self, benchmark: "DecisionEngineLoadBenchmark"):
+        super().__init__(benchmark)
+        import services.handover_event_trigger_service as trigger_module
+        self._module = trigger_module
+        self._measurement_cls = trigger_module.SatelliteMeasurement
+        self.service = trigger_module.HandoverEventTriggerService()
+        self.decisions = 0
+        self.handover_decisions = 0
+
+    def _to_measurement(self, view: CandidateView, timestamp: float):
+        return self._measurement_cls(
+            satellite_id=self.benchmark.ephemeris.names[view.index],
+            timestamp=timestamp,
+            rsrp_dbm=view.rsrp_dbm,
+            rsrq_db=_rsrq_proxy(view.rsrp_dbm),
+            distance_km=view.range_km,
+            elevation_deg=view.elevation_deg,
+            azimuth_deg=view.azimuth_deg,
+            is_visible=view.elevation_deg >= self.benchmark.profile.min_elevation_deg,
+            signal_quality_score=_quality_score(view.rsrp_dbm),
+        )
+
+    async def handle(self, item: WorkItem) -> Optional[str]:
+        # 以模擬時間驅動每 UE 的 time-to-trigger 計時器
+        timestamp = item.sim_time.timestamp()
+        decision = await self.service.process_satellite_measurements(
+            self._to_measurement(item.serving, timestamp),
+            [self._to_measurement(v, timestamp) for v in item.candidates],
+            observer_location={"lat": item.latitude, "lon": item.longitude,
+                               "alt": item.altitude_m / 1000.0},
+            ue_id=f"ue-{item.ue}",
+        )
+        self.decisions += 1
+        if decision.should_handover and decision.target_satellite_id:
+            self.handover_decisions += 1
+            return decision.target_satellite_id
+        return None
+
+    def silence(self):
+        self._module.logger.setLevel(logging.WARNING)
+        logging.getLogger(self.service.event_generator.__class__.__module__).setLevel(logging.WARNING)
+
+    def stats(self) -> Dict[str, Any]:
+        return {
+            "decisions": self.decisions,
+            "handover_decisions": self.handover_decisions,
+            "event_history": len(self.service.event_history),
+        }
+
+
+TARGET_TYPES = {
+    WORK_ACCESS: FastAccessTarget,
+    WORK_HANDOVER: FineGrainedHandoverTarget,
+    WORK_MEASUREMENT: TriggerServiceTarget,
+}
+
+
+# ----------------------------------------------------------------------
+# 指標
+# ----------------------------------------------------------------------
+
+
+def summarize_histogram(histogram: LatencyHistogram) -> Dict[str, float]:
+    summary = {
+        "count": histogram.count,
+        "mean_ms": histogram.mean,
+        "stdev_ms": histogram.stdev,
+        "min_ms": histogram.min_value if histogram.count else 0.0,
+        "max_ms": histogram.max_value if histogram.count else 0.0,
+    }
+    summary.update({f"{k}_ms": v for k, v in histogram.percentiles((0.5, 0.95, 0.99)).items()})
+    return summary
+
+
+class BenchmarkMetrics:
+    """每種工作類型的佇列延遲 / 決策延遲 / 端到端延遲直方圖與計數"""
+
+    METRICS = ("queue_delay", "decision", "end_to_end")
+
+    def __init__(self, kinds: Sequence[str], timeline_window_s: float):
+        self.histograms = {kind: {m: LatencyHistogram() for m in self.METRICS} for kind in kinds}
+        self.timeline = WindowedLatencySketches(window_seconds=timeline_window_s)
+        self.offered = {kind: 0 for kind in kinds}
+        self.completed = {kind: 0 for kind in kinds}
+        self.errors = {kind: 0 for kind in kinds}
+        self.backpressure = LatencyHistogram()
+        self.geometry = LatencyHistogram()
+        self.pacing_lag = LatencyHistogram()
+
+    def record(self, kind: str, queue_ms: float, decision_ms: float, elapsed_s: float):
+        histograms = self.histograms[kind]
+        histograms["queue_delay"].record(queue_ms)
+        histograms["decision"].record(decision_ms)
+        histograms["end_to_end"].record(queue_ms + decision_ms)
+        self.timeline.record(kind, decision_ms, elapsed_s)
+        self.completed[kind] += 1
+
+
+# ----------------------------------------------------------------------
+# 基準測試
+# ----------------------------------------------------------------------
+
+
+class DecisionEngineLoadBenchmark:
+    """合成 UE 負載產生器 + 閉環決策引擎基準測試"""
+
+    def __init__(self, profile: LoadProfile, tle_root: Path = DEFAULT_TLE_ROOT,
+                 targets: Optional[Dict[str, DecisionTarget]] = None,
+                 quiet_engines: bool = True):
+        unknown = set(profile.engines) - set(WORK_KINDS)
+        if unknown:
+            raise ValueError(f"unknown engines: {sorted(unknown)}")
+        if profile.pacing not in ("closed", "paced"):
+            raise ValueError(f"unknown pacing mode: {profile.pacing}")
+
+        self.profile = profile
+        self.rng = np.random.default_rng(profile.seed)
+        random.seed(profile.seed)
+
+        catalog = load_tle_catalog(tle_root, profile.constellations, profile.max_satellites)
+        self.ephemeris = ConstellationEphemeris(catalog)
+        if profile.start_time:
+            self.start_time = datetime.fromisoformat(profile.start_time)
+            if self.start_time.tzinfo is None:
+                self.start_time = self.start_time.replace(tzinfo=timezone.utc)
+        else:
+            epoch = datetime(2000, 1, 1, 12, tzinfo=timezone.utc) + timedelta(
+                days=self.ephemeris.latest_epoch_jd - 2451545.0)
+            self.start_time = epoch.replace(microsecond=0)
+
+        self.population = SyntheticUEPopulation(profile, self.rng)
+        self.satellite_users = np.zeros(len(self.ephemeris), dtype=np.int64)
+
+        self.targets = targets if targets is not None else {
+            kind: TARGET_TYPES[kind](self) for kind in profile.engines
+        }
+        if quiet_engines:
+            for target in self.targets.values():
+                target.silence()
+
+        self.metrics = BenchmarkMetrics(list(self.targets.keys()), profile.timeline_window_s)
+        self._seq = 0
+        self._handovers_applied = 0
+        self._attachments = 0
+        self._coverage_holes = 0
+        self._reports = 0
+        self._unknown_targets = 0
+
+        # 區域中心 (用於每步預先篩選可能可見的衛星)
+        self._center_ecef = _geodetic_to_ecef(
+            np.array([math.radians(profile.center_lat)]),
+            np.array([math.radians(profile.center_lon)]),
+            np.array([0.0]))[0]
+        self._center_unit = self._center_ecef / np.linalg.norm(self._center_ecef)
+
+    # ------------------------------------------------------------------
+    # 鏈路模型
+    # ------------------------------------------------------------------
+
+    def doppler_hz(self, radial_velocity_km_s: float) -> float:
+        return -radial_velocity_km_s / SPEED_OF_LIGHT_KM_S * self.profile.carrier_frequency_ghz * 1e9
+
+    def _rsrp_dbm(self, range_km: np.ndarray, elevation_deg: np.ndarray) -> np.ndarray:
+        """EIRP - 自由空間損耗 - 大氣損耗 (天頂 0.1 dB，餘割律) - 陰影衰落"""
+        fspl = 32.45 + 20 * np.log10(self.profile.carrier_frequency_ghz * 1000.0) + 20 * np.log10(range_km)
+        atmospheric = 0.1 / np.sin(np.radians(np.maximum(elevation_deg, 5.0)))
+        shadowing = self.rng.normal(0.0, self.profile.shadowing_sigma_db, size=range_km.shape)
+        return self.profile.eirp_per_re_dbm - fspl - atmospheric + shadowing
+
+    # ------------------------------------------------------------------
+    # 幾何
+    # ------------------------------------------------------------------
+
+    def _visible_superset(self, positions: np.ndarray, valid: np.ndarray) -> np.ndarray:
+        """區域內任一點可能看到的衛星 (以地心角預先篩選)"""
+        radii = np.linalg.norm(positions, axis=1)
+        cos_angle = positions @ self._center_unit / np.maximum(radii, 1.0)
+        elevation = math.radians(self.profile.min_elevation_deg)
+        max_angle = (np.arccos(np.clip(EARTH_RADIUS_KM * math.cos(elevation) / np.maximum(radii, EARTH_RADIUS_KM),
+                                       -1.0, 1.0)) - elevation
+                     + self.profile.region_radius_km / EARTH_RADIUS_KM)
+        return np.flatnonzero(valid & (cos_angle >= np.cos(max_angle)))
+
+    def _report_geometry(self, reporters: np.ndarray, positions: np.ndarray,
+                         velocities: np.ndarray, visible: np.ndarray):
+        """分塊向量化計算回報 UE 到候選衛星的幾何與 RSRP，逐 UE 產生量測視圖"""
+        profile = self.profile
+        k = profile.neighbors_per_report + 1
+        sat_pos = positions[visible]
+        sat_vel = velocities[visible]
+        sat_speed = np.linalg.norm(sat_vel, axis=1)
+        local_of = np.full(len(self.ephemeris), -1, dtype=np.int64)
+        local_of[visible] = np.arange(visible.size)
+        load = np.minimum(self.satellite_users[visible] / profile.satellite_user_capacity, 0.99)
+        min_el = profile.min_elevation_deg
+
+        lat, lon, alt = self.population.geodetic(reporters)
+        for start in range(0, reporters.size, profile.geometry_chunk_size):
+            stop = start + profile.geometry_chunk_size
+            ues = reporters[start:stop]
+            c_lat, c_lon = lat[start:stop], lon[start:stop]
+            ue_pos = _geodetic_to_ecef(c_lat, c_lon, alt[start:stop])
+            up = np.stack([np.cos(c_lat) * np.cos(c_lon), np.cos(c_lat) * np.sin(c_lon), np.sin(c_lat)], axis=-1)
+
+            delta = sat_pos[None, :, :] - ue_pos[:, None, :]
+            ranges = np.linalg.norm(delta, axis=2)
+            elevation = np.degrees(np.arcsin(np.clip(np.einsum("ijk,ik->ij", delta, up) / ranges, -1.0, 1.0)))
+            rsrp = self._rsrp_dbm(ranges, elevation)
+            masked = np.where(elevation >= min_el, rsrp, -np.inf)
+
+            # 以下一秒位置估計仰角變化率，推算剩餘可見時間
+            delta_next = delta + sat_vel[None, :, :]
+            elevation_next = np.degrees(np.arcsin(np.clip(
+                np.einsum("ijk,ik->ij", delta_next, up) / np.linalg.norm(delta_next, axis=2), -1.0, 1.0)))
+            rate = elevation_next - elevation
+
+            top = np.argsort(-masked, axis=1)[:, :k] if masked.shape[1] > k else np.argsort(-masked, axis=1)
+            east = np.stack([-np.sin(c_lon), np.cos(c_lon), np.zeros_like(c_lon)], axis=-1)
+            north = np.stack([-np.sin(c_lat) * np.cos(c_lon), -np.sin(c_lat) * np.sin(c_lon), np.cos(c_lat)], axis=-1)
+
+            for row, ue in enumerate(ues):
+                def view(col: int) -> CandidateView:
+                    d = delta[row, col]
+                    el = float(elevation[row, col])
+                    r = float(rate[row, col])
+                    if r < 0:
+                        remaining = (el - min_el) / -r
+                    else:
+                        remaining = (180.0 - el - min_el) / max(r, 1e-3)
+                    return CandidateView(
+                        index=int(visible[col]),
+                        rsrp_dbm=float(rsrp[row, col]),
+                        elevation_deg=el,
+                        azimuth_deg=float(np.degrees(np.arctan2(d @ east[row], d @ north[row])) % 360.0),
+                        range_km=float(ranges[row, col]),
+                        radial_velocity_km_s=float(sat_vel[col] @ d / ranges[row, col]),
+                        speed_km_s=float(sat_speed[col]),
+                        load_fraction=float(load[col]),
+                        availability_s=float(min(max(remaining, 0.0), 1800.0)),
+                    )
+
+                candidates = [view(col) for col in top[row] if np.isfinite(masked[row, col])]
+                serving_index = int(self.population.serving[ue])
+                serving_col = local_of[serving_index] if serving_index >= 0 else -1
+                serving = None
+                if serving_col >= 0 and np.isfinite(masked[row, serving_col]):
+                    serving = view(int(serving_col))
+                    candidates = [c for c in candidates if c.index != serving_index][:k - 1]
+                yield int(ue), float(np.degrees(c_lat[row])), float(np.degrees(c_lon[row])), \
+                    float(alt[start + row] * 1000.0), serving, candidates
+
+    # ------------------------------------------------------------------
+    # 生成器與工作協程
+    # ------------------------------------------------------------------
+
+    def _make_item(self, kind: str, sim_time: datetime, ue: int, lat: float, lon: float, alt_m: float,
+                   serving: Optional[CandidateView], candidates: List[CandidateView]) -> WorkItem:
+        self._seq += 1
+        return WorkItem(
+            kind=kind, seq=self._seq, ue=ue, sim_time=sim_time,
+            latitude=lat, longitude=lon, altitude_m=alt_m,
+            service=self.population.service_names[self.population.service[ue]],
+            serving=serving, candidates=candidates,
+        )
+
+    def _work_for_report(self, sim_time: datetime, ue: int, lat: float, lon: float, alt_m: float,
+                         serving: Optional[CandidateView], candidates: List[CandidateView]) -> List[WorkItem]:
+        """依服務衛星狀態決定要產生的請求"""
+        self._reports += 1
+        if serving is None:
+            previous = int(self.population.serving[ue])
+            if previous >= 0:
+                self._set_serving(ue, -1)  # 服務衛星已落到門檻以下
+            if not candidates:
+                self._coverage_holes += 1
+                return []
+            if WORK_ACCESS in self.targets:
+                item = self._make_item(WORK_ACCESS, sim_time, ue, lat, lon, alt_m, None, candidates)
+                item.previous_serving = previous
+                return [item]
+            # 未啟用接入引擎時直接附著到最強衛星，讓換手/測量負載仍可建立
+            self._set_serving(ue, candidates[0].index)
+            return []
+
+        items = []
+        if WORK_MEASUREMENT in self.targets and candidates:
+            items.append(self._make_item(WORK_MEASUREMENT, sim_time, ue, lat, lon, alt_m, serving, candidates))
+        if (WORK_HANDOVER in self.targets and candidates and
+                candidates[0].rsrp_dbm - serving.rsrp_dbm >= self.profile.handover_hysteresis_db):
+            items.append(self._make_item(WORK_HANDOVER, sim_time, ue, lat, lon, alt_m, serving, candidates))
+        return items
+
+    def _set_serving(self, ue: int, satellite_index: int):
+        previous = int(self.population.serving[ue])
+        if previous == satellite_index:
+            return
+        if previous >= 0:
+            self.satellite_users[previous] -= 1
+            if satellite_index >= 0:
+                self._handovers_applied += 1
+        else:
+            self._attachments += 1
+        if satellite_index >= 0:
+            self.satellite_users[satellite_index] += 1
+        self.population.serving[ue] = satellite_index
+
+    async def _generator(self, queue: asyncio.Queue, wall_start: float):
+        profile = self.profile
+        ticks = int(math.ceil(profile.simulated_duration_s / profile.tick_s))
+        for tick in range(ticks):
+            sim_elapsed = tick * profile.tick_s
+            sim_time = self.start_time + timedelta(seconds=sim_elapsed)
+
+            if profile.pacing == "paced":
+                target_wall = wall_start + sim_elapsed / profile.time_scale
+                delay = target_wall - time.perf_counter()
+                if delay > 0:
+                    await asyncio.sleep(delay)
+                else:
+                    self.metrics.pacing_lag.record(-delay * 1000.0)
+
+            for target in self.targets.values():
+                await target.on_tick(sim_time)
+            if tick:
+                self.population.advance(profile.tick_s)
+
+            report_count = int(self.rng.poisson(profile.report_rate_hz * profile.tick_s))
+            if not report_count:
+                continue
+            reporters = np.unique(self.rng.integers(0, self.population.size, report_count))
+
+            geometry_start = time.perf_counter()
+            positions, velocities, valid = self.ephemeris.propagate(sim_time)
+            visible = self._visible_superset(positions, valid)
+            reports = list(self._report_geometry(reporters, positions, velocities, visible))
+            self.metrics.geometry.record((time.perf_counter() - geometry_start) * 1000.0)
+
+            for ue, lat, lon, alt_m, serving, candidates in reports:
+                for item in self._work_for_report(sim_time, ue, lat, lon, alt_m, serving, candidates):
+                    self.metrics.offered[item.kind] += 1
+                    put_start = time.perf_counter()
+                    item.enqueued_at = put_start
+                    await queue.put(item)
+                    blocked_ms = (time.perf_counter() - put_start) * 1000.0
+                    if blocked_ms > 0.01:
+                        self.metrics.backpressure.record(blocked_ms)
+
+        for _ in range(profile.workers):
+            await queue.put(None)
+
+    async def _worker(self, queue: asyncio.Queue, wall_start: float):
+        while True:
+            item = await queue.get()
+            if item is None:
+                queue.task_done()
+                return
+            dequeued = time.perf_counter()
+            target = self.targets[item.kind]
+            new_serving = None
+            try:
+                new_serving = await target.handle(item)
+            except Exception as e:
+                self.metrics.errors[item.kind] += 1
+                logger.debug(f"❌ {item.kind} 決策失敗 (seq={item.seq}): {e}")
+            done = time.perf_counter()
+            self.metrics.record(item.kind, (dequeued - item.enqueued_at) * 1000.0,
+                                (done - dequeued) * 1000.0, done - wall_start)
+
+            if new_serving is not None:
+                index = self.ephemeris.index_of.get(new_serving)
+                if index is None:
+                    self._unknown_targets += 1
+                else:
+                    self._set_serving(item.ue, index)
+            queue.task_done()
+
+    async def run(self) -> Dict[str, Any]:
+        """執行基準測試並返回結果字典"""
+        profile = self.profile
+        logger.info(f"🚀 決策引擎負載測試: {profile.ue_count:,} UE, {len(self.ephemeris):,} 顆衛星, "
+                    f"{profile.report_rate_hz:g} 報告/模擬秒, 引擎={list(self.targets.keys())}, "
+                    f"模式={profile.pacing}")
+
+        queue: asyncio.Queue = asyncio.Queue(maxsize=profile.max_queue_size)
+        wall_start = time.perf_counter()
+        workers = [asyncio.create_task(self._worker(queue, wall_start)) for _ in range(profile.workers)]
+        await self._generator(queue, wall_start)
+        await asyncio.gather(*workers)
+        wall_elapsed = time.perf_counter() - wall_start
+
+        result = self._build_result(wall_elapsed)
+        logger.info(f"✅ 負載測試完成: {sum(self.metrics.completed.values()):,} 個決策, "
+                    f"{result['throughput_per_s']['total']:.1f} 決策/秒, 耗時 {wall_elapsed:.1f}s")
+        return result
+
+    def _build_result(self, wall_elapsed: float) -> Dict[str, Any]:
+        metrics = self.metrics
+        total_completed = sum(metrics.completed.values())
+        throughput = {kind: n / wall_elapsed if wall_elapsed > 0 else 0.0
+                      for kind, n in metrics.completed.items()}
+        throughput["total"] = total_completed / wall_elapsed if wall_elapsed > 0 else 0.0
+
+        timeline = {}
+        for kind in metrics.timeline.keys():
+            windows = metrics.timeline.windows[kind]
+            timeline[kind] = [
+                {"t_s": start, "completed": h.count,
+                 "throughput_per_s": h.count / metrics.timeline.window_seconds,
+                 "p99_decision_ms": h.quantile(0.99)}
+                for start, h in sorted(windows.items())
+            ]
+
+        profile = asdict(self.profile)
+        profile["engines"] = list(self.profile.engines)
+        profile["constellations"] = list(self.profile.constellations)
+
+        return {
+            "benchmark": "decision_engine_load",
+            "format_version": RESULT_FORMAT_VERSION,
+            "generated_at": datetime.now(timezone.utc).isoformat(),
+            "profile": profile,
+            "constellation": {
+                "satellites": len(self.ephemeris),
+                "by_constellation": {c: self.ephemeris.constellations.count(c)
+                                     for c in sorted(set(self.ephemeris.constellations))},
+                "start_time": self.start_time.isoformat(),
+            },
+            "population": {
+                "ue_count": self.population.size,
+                "mobility": self.population.mobility_counts(),
+                "attached_at_end": int((self.population.serving >= 0).sum()),
+            },
+            "wall_time_s": wall_elapsed,
+            "simulated_time_s": self.profile.simulated_duration_s,
+            "reports": self._reports,
+            "offered": dict(metrics.offered),
+            "completed": dict(metrics.completed),
+            "errors": dict(metrics.errors),
+            "throughput_per_s": throughput,
+            "latency_ms": {
+                kind: {name: summarize_histogram(h) for name, h in histograms.items()}
+                for kind, histograms in metrics.histograms.items()
+            },
+            "generator": {
+                "geometry_ms": summarize_histogram(metrics.geometry),
+                "backpressure_ms": summarize_histogram(metrics.backpressure),
+                "pacing_lag_ms": summarize_histogram(metrics.pacing_lag),
+            },
+            "network": {
+                "attachments": self._attachments,
+                "handovers_applied": self._handovers_applied,
+                "coverage_holes": self._coverage_holes,
+                "unknown_targets": self._unknown_targets,
+            },
+            "engine_stats": {kind: target.stats() for kind, target in self.targets.items()},
+            "timeline": timeline,
+            "sketches": {
+                kind: {name: h.to_dict() for name, h in histograms.items()}
+                for kind, histograms in metrics.histograms.items()
+            },
+        }
+
+
+# ----------------------------------------------------------------------
+# 回歸比較
+# ----------------------------------------------------------------------
+
+
+def compare_with_baseline(result: Dict[str, Any], baseline: Dict[str, Any],
+                          throughput_tolerance: float = 0.10,
+                          latency_tolerance: float = 0.20) -> List[str]:
+    """
+    與基準結果比較，返回回歸描述列表 (空列表表示通過)
+
+    吞吐量下降超過 throughput_tolerance，或 p95/p99 決策延遲
+    上升超過 latency_tolerance 視為回歸。
+    """
+    regressions = []
+    for kind, base_value in baseline.get("throughput_per_s", {}).items():
+        current = result.get("throughput_per_s", {}).get(kind)
+        if current is None or base_value <= 0:
+            continue
+        if current < base_value * (1.0 - throughput_tolerance):
+            regressions.append(f"throughput[{kind}] {current:.1f}/s < baseline {base_value:.1f}/s "
+                               f"(-{(1 - current / base_value) * 100:.1f}%)")
+
+    for kind, metrics in baseline.get("latency_ms", {}).items():
+        base_decision = metrics.get("decision", {})
+        current_decision = result.get("latency_ms", {}).get(kind, {}).get("decision", {})
+        for key in ("p95_ms", "p99_ms"):
+            base_value = base_decision.get(key, 0.0)
+            current = current_decision.get(key)
+            if current is None or base_value <= 0:
+                continue
+            if current > base_value * (1.0 + latency_tolerance):
+                regressions.append(f"decision {key}[{kind}] {current:.3f}ms > baseline {base_value:.3f}ms "
+                                   f"(+{(current / base_value - 1) * 100:.1f}%)")
+    return regressions
+
+
+def run_benchmark(profile: LoadProfile, tle_root: Path = DEFAULT_TLE_ROOT,
+                  quiet_engines: bool = True) -> Dict[str, Any]:
+    """同步入口 (CLI 使用)"""
+    benchmark = DecisionEngineLoadBenchmark(profile, tle_root=tle_root, quiet_engines=quiet_engines)
+    return asyncio.run(benchmark.run())
+
+
+def save_result(result: Dict[str, Any], path: Path):
+    path = Path(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(result, f, indent=2, ensure_ascii=False)
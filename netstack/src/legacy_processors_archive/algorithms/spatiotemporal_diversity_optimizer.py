@@ -21,6 +21,11 @@ from dataclasses import dataclass
 import logging
 from datetime import datetime, timedelta
 
+try:
+    from .submodular_pool_selector import LazyGreedyPoolSelector
+except ImportError:
+    from submodular_pool_selector import LazyGreedyPoolSelector
+
 logger = logging.getLogger(__name__)
 
 @dataclass
@@ -71,6 +76,8 @@ class SpatiotemporalDiversityOptimizer:
         self.phase_bins = 12  # 將軌道週期分為12個相位區間
         self.raan_bins = 8  # 將RAAN分為8個區間
         self.time_resolution = 30  # 時間解析度（秒）
+        self.coverage_weight = self.config.get('coverage_weight', 0.8)  # 覆蓋項權重，其餘為相位多樣性
+        self.selection_statistics: Dict = {}
         
         logger.info("✅ 時空錯置優化器初始化完成")
         
@@ -98,13 +105,15 @@ class SpatiotemporalDiversityOptimizer:
         
         # 2. 計算相位分佈
         phase_distribution = self._calculate_phase_distribution(phase_info_list)
+        visibility = self._build_visibility_matrix(candidates, constellation)
         
         # 3. 選擇時空錯置的衛星
         selected_indices = self._select_diverse_satellites(
             phase_info_list,
             phase_distribution,
             target_pool_size,
-            constellation
+            constellation,
+            visibility
         )
         
         # 4. 驗證覆蓋連續性
@@ -121,7 +130,8 @@ class SpatiotemporalDiversityOptimizer:
                 candidates,
                 coverage_analysis,
                 constellation,
-                target_pool_size
+                target_pool_size,
+                visibility
             )
             # 重新分析覆蓋
             coverage_analysis = self._analyze_coverage_continuity(
@@ -213,76 +223,77 @@ class SpatiotemporalDiversityOptimizer:
             
         return distribution
         
+    def _build_visibility_matrix(self, satellites: List[Dict], constellation: str) -> np.ndarray:
+        """建立 (衛星數, 週期時間點數) 可見性矩陣，時間分箱規則與覆蓋連續性分析一致"""
+        orbit_period = self.coverage_targets[constellation]['orbit_period']
+        time_points = int(orbit_period * 60 / self.time_resolution)
+        visibility = np.zeros((len(satellites), time_points), dtype=bool)
+        
+        for i, sat in enumerate(satellites):
+            for pos in sat.get('position_timeseries', [])[:time_points]:
+                if pos.get('is_visible', False):
+                    time_idx = int(pos.get('time_offset_seconds', 0) // self.time_resolution)
+                    if time_idx < time_points:
+                        visibility[i, time_idx] = True
+                        
+        return visibility
+        
+    def _phase_bin_indices(self, phase_info_list: List[OrbitalPhaseInfo]) -> Tuple[np.ndarray, np.ndarray]:
+        """每顆衛星的平均近點角區間與 RAAN 區間 (與相位分佈的分箱規則一致)"""
+        mean_anomalies = np.array([p.mean_anomaly for p in phase_info_list], dtype=np.float64)
+        raans = np.array([p.raan for p in phase_info_list], dtype=np.float64)
+        ma_bins = np.minimum((mean_anomalies % 360 / (360 / self.phase_bins)).astype(np.int64), self.phase_bins - 1)
+        raan_bins = np.minimum((raans % 360 / (360 / self.raan_bins)).astype(np.int64), self.raan_bins - 1)
+        return ma_bins, raan_bins
+        
     def _select_diverse_satellites(
         self,
         phase_info_list: List[OrbitalPhaseInfo],
         phase_distribution: Dict,
         target_size: int,
-        constellation: str
+        constellation: str,
+        visibility: Optional[np.ndarray] = None
     ) -> List[int]:
-        """選擇時空多樣化的衛星"""
-        selected_indices = []
-        selected_set = set()
-        
-        # 優先從每個相位區間選擇衛星，確保時間錯置
-        satellites_per_bin = max(1, target_size // self.phase_bins)
-        
-        # 第一輪：從每個平均近點角區間選擇
-        for ma_bin in range(self.phase_bins):
-            bin_satellites = phase_distribution['mean_anomaly_bins'][ma_bin]
-            if not bin_satellites:
-                continue
-                
-            # 按可見時間長度排序
-            bin_satellites_sorted = sorted(
-                bin_satellites,
-                key=lambda i: len(phase_info_list[i].visible_windows),
-                reverse=True
-            )
+        """
+        選擇時空多樣化的衛星
+        
+        以覆蓋 + 相位多樣性的次模目標做惰性貪婪選擇 (CELF)，
+        每一步只重新評估佇列頂端增益已過期的候選
+        """
+        if not phase_info_list:
+            return []
+        if visibility is None:
+            visibility = self._visibility_from_windows(phase_info_list, constellation)
             
-            # 選擇該區間最好的衛星
-            for sat_idx in bin_satellites_sorted[:satellites_per_bin]:
-                if sat_idx not in selected_set:
-                    selected_indices.append(sat_idx)
-                    selected_set.add(sat_idx)
-                    
-                if len(selected_indices) >= target_size:
-                    break
-                    
-            if len(selected_indices) >= target_size:
-                break
-                
-        # 第二輪：如果數量不足，從不同RAAN區間補充
-        if len(selected_indices) < target_size:
-            for raan_bin in range(self.raan_bins):
-                bin_satellites = phase_distribution['raan_bins'][raan_bin]
+        ma_bins, raan_bins = self._phase_bin_indices(phase_info_list)
+        selector = LazyGreedyPoolSelector(
+            visibility,
+            self.coverage_targets[constellation]['min_visible'],
+            ma_bins,
+            raan_bins,
+            self.phase_bins,
+            self.raan_bins,
+            target_size,
+            coverage_weight=self.coverage_weight
+        )
+        selected_indices = selector.select(min(target_size, len(phase_info_list)))
+        self.selection_statistics['diverse_selection'] = selector.get_statistics()
+        
+        return selected_indices
+        
+    def _visibility_from_windows(self, phase_info_list: List[OrbitalPhaseInfo], constellation: str) -> np.ndarray:
+        """由可見時間窗口重建可見性矩陣 (呼叫端未提供矩陣時使用)"""
+        orbit_period = self.coverage_targets[constellation]['orbit_period']
+        time_points = int(orbit_period * 60 / self.time_resolution)
+        visibility = np.zeros((len(phase_info_list), time_points), dtype=bool)
+        
+        for i, phase_info in enumerate(phase_info_list):
+            for start, end in phase_info.visible_windows:
+                first = int(start // self.time_resolution)
+                last = max(first + 1, int(math.ceil(end / self.time_resolution)))
+                visibility[i, first:min(last, time_points)] = True
                 
-                for sat_idx in bin_satellites:
-                    if sat_idx not in selected_set:
-                        selected_indices.append(sat_idx)
-                        selected_set.add(sat_idx)
-                        
-                    if len(selected_indices) >= target_size:
-                        break
-                        
-                if len(selected_indices) >= target_size:
-                    break
-                    
-        # 第三輪：如果還是不足，選擇剩餘最佳的衛星
-        if len(selected_indices) < target_size:
-            remaining = [i for i in range(len(phase_info_list)) if i not in selected_set]
-            remaining_sorted = sorted(
-                remaining,
-                key=lambda i: len(phase_info_list[i].visible_windows),
-                reverse=True
-            )
-            
-            for sat_idx in remaining_sorted:
-                selected_indices.append(sat_idx)
-                if len(selected_indices) >= target_size:
-                    break
-                    
-        return selected_indices[:target_size]
+        return visibility
         
     def _analyze_coverage_continuity(
         self,
@@ -375,70 +386,51 @@ class SpatiotemporalDiversityOptimizer:
         all_candidates: List[Dict],
         coverage_analysis: SpatiotemporalCoverage,
         constellation: str,
-        max_size: int
+        max_size: int,
+        visibility: Optional[np.ndarray] = None
     ) -> List[Dict]:
-        """補充覆蓋空隙"""
-        if len(selected_satellites) >= max_size:
+        """
+        補充覆蓋空隙
+        
+        從目前選擇繼續惰性貪婪，只計算覆蓋增益 (即填補未達最少可見數的時間點)，
+        增益為 0 時停止
+        """
+        if len(selected_satellites) >= max_size or not coverage_analysis.coverage_gaps:
             return selected_satellites
             
         logger.info(f"⚠️ 覆蓋不足，補充衛星以填補空隙")
         
-        # 找出未選擇的衛星
-        selected_ids = {sat.get('satellite_id') for sat in selected_satellites}
-        unselected = [sat for sat in all_candidates 
-                     if sat.get('satellite_id') not in selected_ids]
+        if visibility is None:
+            visibility = self._build_visibility_matrix(all_candidates, constellation)
+            
+        index_by_id = {sat.get('satellite_id'): i for i, sat in enumerate(all_candidates)}
+        initial = [index_by_id[sat.get('satellite_id')] for sat in selected_satellites
+                   if sat.get('satellite_id') in index_by_id]
+        
+        ma_bins, raan_bins = self._phase_bin_indices(self._extract_orbital_phases(all_candidates, constellation))
+        selector = LazyGreedyPoolSelector(
+            visibility,
+            self.coverage_targets[constellation]['min_visible'],
+            ma_bins,
+            raan_bins,
+            self.phase_bins,
+            self.raan_bins,
+            max_size,
+            coverage_weight=self.coverage_weight
+        )
+        initial_set = set(initial)
+        selected = selector.select(
+            len(initial) + max_size - len(selected_satellites),
+            initial=initial,
+            min_gain=0.0,
+            coverage_only=True
+        )
+        self.selection_statistics['gap_supplement'] = selector.get_statistics()
         
-        # 針對每個覆蓋空隙，選擇最佳衛星
         supplemented = selected_satellites.copy()
-        
-        for gap_start, gap_end in coverage_analysis.coverage_gaps:
-            if len(supplemented) >= max_size:
-                break
-                
-            # 找出在空隙期間可見的衛星
-            gap_coverage_scores = []
-            
-            for sat in unselected:
-                score = self._calculate_gap_coverage_score(sat, gap_start, gap_end)
-                if score > 0:
-                    gap_coverage_scores.append((sat, score))
-                    
-            # 選擇得分最高的衛星
-            gap_coverage_scores.sort(key=lambda x: x[1], reverse=True)
-            
-            for sat, score in gap_coverage_scores[:3]:  # 每個空隙最多補充3顆
-                if sat.get('satellite_id') not in selected_ids:
-                    supplemented.append(sat)
-                    selected_ids.add(sat.get('satellite_id'))
-                    
-                if len(supplemented) >= max_size:
-                    break
-                    
+        supplemented.extend(all_candidates[i] for i in selected if i not in initial_set)
         return supplemented[:max_size]
         
-    def _calculate_gap_coverage_score(self, satellite: Dict, gap_start: float, gap_end: float) -> float:
-        """計算衛星對特定空隙的覆蓋得分"""
-        position_timeseries = satellite.get('position_timeseries', [])
-        
-        if not position_timeseries:
-            return 0.0
-            
-        coverage_time = 0
-        
-        for pos in position_timeseries:
-            time_offset = pos.get('time_offset_seconds', 0)
-            
-            # 檢查是否在空隙時間範圍內
-            if gap_start <= time_offset <= gap_end:
-                if pos.get('is_visible', False):
-                    coverage_time += self.time_resolution
-                    
-        # 計算覆蓋比例
-        gap_duration = gap_end - gap_start
-        if gap_duration > 0:
-            return coverage_time / gap_duration
-        return 0.0
-        
     def validate_orbit_period_coverage(
         self,
         satellites: List[Dict],
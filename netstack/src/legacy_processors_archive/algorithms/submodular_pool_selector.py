@@ -0,0 +1,147 @@
+"""
+🧮 次模函數衛星池選擇器 (Lazy-Greedy / CELF)
+==========================================
+
+目的：以單調次模目標函數描述「覆蓋 + 相位多樣性」，用惰性貪婪 (CELF)
+取代每選一顆就重新掃描所有候選衛星的做法。
+
+目標函數 f(S)，各項皆為模函數經凹函數截斷後加總，故單調且次模：
+1. 覆蓋：Σ_t min(可見數_t, 最少可見數) / (時間點數 × 最少可見數)
+2. 相位多樣性：各平均近點角區間與 RAAN 區間的 min(區間衛星數, 區間上限) 比例
+3. 可見時間 (模函數，僅作同分時的偏好)
+
+CELF 要點：
+- 次模性保證邊際增益只會隨選擇集合變大而下降，舊的增益是新增益的上界
+- 優先佇列保存各候選的「過期」增益；取出堆頂後重新計算，若仍為最大即選入，
+  否則以新增益放回佇列；與標準貪婪選出相同序列，保有 (1 - 1/e) 近似保證
+- 每一步通常只需重新計算少數候選，而非掃描全部候選
+"""
+
+import heapq
+import logging
+from typing import Dict, Iterable, List, Optional
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+class LazyGreedyPoolSelector:
+    """覆蓋 + 相位多樣性的惰性貪婪選擇器"""
+
+    def __init__(
+        self,
+        visibility: np.ndarray,
+        coverage_target: int,
+        mean_anomaly_bins: np.ndarray,
+        raan_bins: np.ndarray,
+        n_mean_anomaly_bins: int,
+        n_raan_bins: int,
+        pool_size: int,
+        coverage_weight: float = 0.8,
+        visible_time_weight: float = 0.01
+    ):
+        """
+        Args:
+            visibility: (候選數, 時間點數) 布林可見性矩陣
+            coverage_target: 每個時間點的最少可見衛星數 (覆蓋飽和點)
+            mean_anomaly_bins / raan_bins: 每顆候選所在的相位區間索引
+            n_mean_anomaly_bins / n_raan_bins: 區間數量
+            pool_size: 目標池大小 (決定每個相位區間的飽和上限)
+            coverage_weight: 覆蓋項權重，其餘為相位多樣性權重
+            visible_time_weight: 可見時間偏好項權重
+        """
+        visibility = np.asarray(visibility, dtype=bool)
+        self.n_candidates, self.n_times = visibility.shape
+        self.visible_steps = [np.flatnonzero(row) for row in visibility]
+        self.coverage_target = max(1, int(coverage_target))
+        self.ma_bins = np.asarray(mean_anomaly_bins, dtype=np.int64)
+        self.raan_bins = np.asarray(raan_bins, dtype=np.int64)
+        self.ma_cap = max(1, -(-pool_size // n_mean_anomaly_bins))
+        self.raan_cap = max(1, -(-pool_size // n_raan_bins))
+
+        # 各項單位增益 (使飽和時各項總和為 1)
+        self.coverage_unit = coverage_weight / max(self.n_times * self.coverage_target, 1)
+        self.ma_unit = (1.0 - coverage_weight) / 2 / (n_mean_anomaly_bins * self.ma_cap)
+        self.raan_unit = (1.0 - coverage_weight) / 2 / (n_raan_bins * self.raan_cap)
+        self.modular_gain = visible_time_weight * visibility.sum(axis=1) / max(self.n_times, 1)
+
+        self.counts = np.zeros(self.n_times, dtype=np.int32)
+        self.ma_counts = np.zeros(n_mean_anomaly_bins, dtype=np.int32)
+        self.raan_counts = np.zeros(n_raan_bins, dtype=np.int32)
+        self.selected: List[int] = []
+        self._selected_set = set()
+        self.value = 0.0
+        self.statistics = {'gain_evaluations': 0, 'selection_steps': 0}
+
+    def marginal_gain(self, index: int, coverage_only: bool = False) -> float:
+        """候選加入目前集合的邊際增益"""
+        self.statistics['gain_evaluations'] += 1
+        steps = self.visible_steps[index]
+        gain = self.coverage_unit * int(np.count_nonzero(self.counts[steps] < self.coverage_target))
+        if coverage_only:
+            return gain
+        if self.ma_counts[self.ma_bins[index]] < self.ma_cap:
+            gain += self.ma_unit
+        if self.raan_counts[self.raan_bins[index]] < self.raan_cap:
+            gain += self.raan_unit
+        return gain + float(self.modular_gain[index])
+
+    def add(self, index: int, gain: Optional[float] = None):
+        """將候選加入集合並更新覆蓋與區間計數"""
+        if gain is None:
+            gain = self.marginal_gain(index)
+        self.counts[self.visible_steps[index]] += 1
+        self.ma_counts[self.ma_bins[index]] += 1
+        self.raan_counts[self.raan_bins[index]] += 1
+        self.selected.append(index)
+        self._selected_set.add(index)
+        self.value += gain
+
+    def select(
+        self,
+        size: int,
+        initial: Iterable[int] = (),
+        min_gain: float = -1.0,
+        coverage_only: bool = False
+    ) -> List[int]:
+        """
+        CELF 選擇直到集合大小達到 size
+
+        Args:
+            size: 目標集合大小 (含 initial)
+            initial: 已選入的候選索引
+            min_gain: 最佳邊際增益不大於此值時停止 (預設不提前停止)
+            coverage_only: 只計算覆蓋增益 (用於補充覆蓋空隙)
+        """
+        for index in initial:
+            if index not in self._selected_set:
+                self.add(index)
+
+        # 佇列元素: (-增益, 候選索引, 計算增益時的集合大小)
+        heap = []
+        for index in range(self.n_candidates):
+            if index not in self._selected_set:
+                heap.append((-self.marginal_gain(index, coverage_only), index, len(self.selected)))
+        heapq.heapify(heap)
+
+        while heap and len(self.selected) < size:
+            neg_gain, index, stamp = heapq.heappop(heap)
+            if stamp == len(self.selected):
+                if -neg_gain <= min_gain:
+                    break
+                self.add(index, self.marginal_gain(index) if coverage_only else -neg_gain)
+                self.statistics['selection_steps'] += 1
+            else:
+                heapq.heappush(heap, (-self.marginal_gain(index, coverage_only), index, len(self.selected)))
+
+        return list(self.selected)
+
+    def get_statistics(self) -> Dict[str, float]:
+        steps = max(self.statistics['selection_steps'], 1)
+        return {
+            **self.statistics,
+            'candidates': self.n_candidates,
+            'evaluations_per_step': self.statistics['gain_evaluations'] / steps,
+            'objective_value': self.value,
+        }
@@ -26,6 +26,20 @@ import math
 
 logger = logging.getLogger(__name__)
 
+# 共享模擬時鐘：回放模式下廣播時間與衛星位置跟隨模擬時間，而非牆鐘
+try:
+    from netstack_api.services.simulation_clock import get_simulation_clock
+    SIMULATION_CLOCK_AVAILABLE = True
+except ImportError:
+    SIMULATION_CLOCK_AVAILABLE = False
+
+
+def _utc_now() -> datetime:
+    """目前 (模擬) UTC 時間"""
+    if SIMULATION_CLOCK_AVAILABLE:
+        return get_simulation_clock().now()
+    return datetime.now(timezone.utc)
+
 
 class SIB19BroadcastType(Enum):
     """SIB19 廣播類型"""
@@ -190,7 +204,7 @@ class SIB19Message:
     
     def is_valid(self) -> bool:
         """檢查消息是否仍然有效"""
-        age = (datetime.now(timezone.utc) - self.broadcast_time).total_seconds()
+        age = (_utc_now() - self.broadcast_time).total_seconds()
         return age < self.validity_duration
 
 
@@ -253,8 +267,11 @@ class SIB19BroadcastScheduler:
             while self.is_running:
                 await self._periodic_broadcast_cycle()
                 
-                # 等待下一個廣播週期
-                await asyncio.sleep(self.broadcast_config['periodic_interval'])
+                # 等待下一個廣播週期 (模擬時間；回放倍速下相應縮短，跳轉後立即重新廣播)
+                if SIMULATION_CLOCK_AVAILABLE:
+                    await get_simulation_clock().sleep(self.broadcast_config['periodic_interval'])
+                else:
+                    await asyncio.sleep(self.broadcast_config['periodic_interval'])
                 
         except asyncio.CancelledError:
             self.logger.info("📡 SIB19 廣播調度器循環已取消")
@@ -281,7 +298,7 @@ class SIB19BroadcastScheduler:
     
     async def _update_satellite_positions(self):
         """更新所有衛星位置"""
-        current_time = datetime.now(timezone.utc)
+        current_time = _utc_now()
         
         for satellite_id, ephemeris in self.active_satellites.items():
             try:
@@ -298,7 +315,7 @@ class SIB19BroadcastScheduler:
     
     async def _calculate_visible_satellites(self):
         """計算當前可見衛星"""
-        current_time = datetime.now(timezone.utc)
+        current_time = _utc_now()
         observer_lat = self.observer_location['latitude']
         observer_lon = self.observer_location['longitude']
         min_elevation = self.observer_location['min_elevation']
@@ -439,7 +456,7 @@ class SIB19BroadcastScheduler:
         # 創建 SIB19 消息
         sib19_message = SIB19Message(
             message_id=f"sib19_{int(time.time() * 1000)}_{self.sequence_counter}",
-            broadcast_time=datetime.now(timezone.utc),
+            broadcast_time=_utc_now(),
             broadcast_type=broadcast_type,
             validity_duration=self.broadcast_config['validity_duration'],
             sequence_number=self.sequence_counter,
@@ -613,7 +630,7 @@ class SIB19BroadcastScheduler:
     
     def get_broadcast_statistics(self) -> Dict[str, Any]:
         """獲取廣播統計信息"""
-        now = datetime.now(timezone.utc)
+        now = _utc_now()
         one_hour_ago = now - timedelta(hours=1)
         
         # 統計最近一小時的廣播
@@ -651,7 +668,7 @@ async def create_sib19_broadcast_scheduler() -> SIB19BroadcastScheduler:
         SatelliteEphemeris(
             satellite_id="STARLINK-1007",
             norad_id=44713,
-            epoch_time=datetime.now(timezone.utc),
+            epoch_time=_utc_now(),
             semi_major_axis=6921.0,
             eccentricity=0.0001,
             inclination=53.0,
@@ -666,7 +683,7 @@ async def create_sib19_broadcast_scheduler() -> SIB19BroadcastScheduler:
         SatelliteEphemeris(
             satellite_id="STARLINK-1008", 
             norad_id=44714,
-            epoch_time=datetime.now(timezone.utc),
+            epoch_time=_utc_now(),
             semi_major_axis=6921.0,
             eccentricity=0.0001,
             inclination=53.0,
@@ -692,7 +709,7 @@ def create_test_satellite_ephemeris(satellite_id: str, norad_id: int) -> Satelli
     return SatelliteEphemeris(
         satellite_id=satellite_id,
         norad_id=norad_id,
-        epoch_time=datetime.now(timezone.utc),
+        epoch_time=_utc_now(),
         semi_major_axis=6921.0,
         eccentricity=0.0001,
         inclination=53.0,
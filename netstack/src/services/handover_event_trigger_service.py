@@ -6,6 +6,7 @@
 
 import asyncio
 import logging
+from collections import Counter, deque
 from typing import Dict, List, Any, Optional, Tuple, Callable
 from dataclasses import dataclass
 from datetime import datetime, timedelta
@@ -17,6 +18,10 @@ try:
 except ImportError:
     # 嘗試本地開發路徑
     from .threegpp_event_generator import ThreeGPPEventGenerator, MeasurementEventType
+try:
+    from netstack.src.services.streaming_trigger_engine import StreamingTriggerEngine, LEFT
+except ImportError:
+    from .streaming_trigger_engine import StreamingTriggerEngine, LEFT
 try:
     # 嘗試容器內的路徑
     from netstack_api.services.distance_correction_service import DistanceCorrectionService
@@ -65,9 +70,15 @@ class HandoverEventTriggerService:
         self.event_generator = ThreeGPPEventGenerator()
         self.distance_corrector = DistanceCorrectionService()
         
-        # 事件歷史記錄
-        self.event_history: List[Dict] = []
-        self.handover_history: List[Dict] = []
+        # 每 UE 串流觸發狀態 (L3 濾波、進入/離開條件、TTT 計時器)
+        self.trigger_engine = StreamingTriggerEngine(self.event_generator)
+        
+        # 事件歷史記錄 (時間順序，過期事件從左端移除)
+        self.event_history: deque = deque()
+        self.event_counts: Counter = Counter()
+        self.handover_history: deque = deque(maxlen=10000)
+        self.total_handovers = 0
+        self.last_handover_by_ue: Dict[str, float] = {}
         
         # 事件回調函數
         self.event_callbacks: Dict[str, List[Callable]] = {}
@@ -106,44 +117,44 @@ class HandoverEventTriggerService:
         self, 
         serving_satellite: SatelliteMeasurement,
         neighbor_satellites: List[SatelliteMeasurement],
-        observer_location: Dict[str, float] = None
+        observer_location: Dict[str, float] = None,
+        ue_id: str = "default"
     ) -> HandoverDecision:
         """
         處理衛星測量數據並做出換手決策
         
-        這是主要的入口點，整合所有A4/A5/D2事件判斷
+        這是主要的入口點，整合所有A4/A5/D2事件判斷。
+        每筆測量只增量更新該 UE 的觸發狀態，回調僅在事件進入/離開時觸發。
         """
-        timestamp = datetime.now().timestamp()
+        timestamp = serving_satellite.timestamp or datetime.now().timestamp()
         
-        logger.info(
-            f"🔍 處理衛星測量: 服務衛星={serving_satellite.satellite_id}, "
+        logger.debug(
+            f"🔍 處理衛星測量: UE={ue_id}, 服務衛星={serving_satellite.satellite_id}, "
             f"鄰居衛星數={len(neighbor_satellites)}"
         )
         
-        # 1. 準備數據結構供3GPP事件生成器使用
-        handover_data = self._prepare_handover_data(
-            serving_satellite, neighbor_satellites, timestamp
+        # 1. 更新串流狀態，取得本次的事件轉換
+        transitions = self.trigger_engine.update(
+            ue_id, serving_satellite, neighbor_satellites, timestamp
         )
         
-        # 2. 生成3GPP事件 (包含A4/A5/D2)
-        events = self.event_generator.generate_measurement_events(handover_data)
+        # 2. 目前處於觸發狀態的事件 (包含A4/A5/D2)
+        triggered_events = self.trigger_engine.active_events(ue_id)
         
-        # 3. 分析觸發的事件
-        triggered_events = [e for e in events if e['timestamp'] >= timestamp - 60]
-        
-        # 4. 基於事件做出換手決策
+        # 3. 基於事件做出換手決策
         handover_decision = await self._make_handover_decision(
-            serving_satellite, neighbor_satellites, triggered_events
+            serving_satellite, neighbor_satellites, triggered_events, ue_id, timestamp
         )
         
-        # 5. 記錄事件和決策
-        self._record_events(triggered_events)
-        self._record_handover_decision(handover_decision, timestamp)
+        # 4. 記錄事件轉換和決策
+        self._record_events(transitions, timestamp)
+        self._record_handover_decision(handover_decision, timestamp, ue_id)
         
-        # 6. 觸發回調
-        await self._trigger_event_callbacks(triggered_events, handover_decision)
+        # 5. 僅對事件轉換觸發回調
+        if transitions:
+            await self._trigger_event_callbacks(transitions, handover_decision)
         
-        logger.info(
+        logger.debug(
             f"💡 換手決策: {handover_decision.should_handover}, "
             f"目標: {handover_decision.target_satellite_id}, "
             f"原因: {handover_decision.handover_reason}"
@@ -151,62 +162,18 @@ class HandoverEventTriggerService:
         
         return handover_decision
     
-    def _prepare_handover_data(
-        self, 
-        serving_satellite: SatelliteMeasurement, 
-        neighbor_satellites: List[SatelliteMeasurement],
-        timestamp: float
-    ) -> Dict[str, Any]:
-        """準備3GPP事件生成器需要的數據結構"""
-        trajectories = {}
-        
-        # 服務衛星軌跡點
-        serving_point = {
-            'timestamp': timestamp,
-            'elevation': serving_satellite.elevation_deg,
-            'azimuth': serving_satellite.azimuth_deg,
-            'distance_km': serving_satellite.distance_km,
-            'range_km': serving_satellite.distance_km,
-            'signal_strength': serving_satellite.signal_quality_score,
-            'is_visible': serving_satellite.is_visible,
-            'rsrp_dbm': serving_satellite.rsrp_dbm
-        }
-        trajectories[serving_satellite.satellite_id] = [serving_point]
-        
-        # 鄰居衛星軌跡點
-        for neighbor in neighbor_satellites:
-            neighbor_point = {
-                'timestamp': timestamp,
-                'elevation': neighbor.elevation_deg,
-                'azimuth': neighbor.azimuth_deg,
-                'distance_km': neighbor.distance_km,
-                'range_km': neighbor.distance_km,
-                'signal_strength': neighbor.signal_quality_score,
-                'is_visible': neighbor.is_visible,
-                'rsrp_dbm': neighbor.rsrp_dbm
-            }
-            trajectories[neighbor.satellite_id] = [neighbor_point]
-        
-        return {
-            'trajectories': trajectories,
-            'observer_location': {
-                'lat': 24.9441667,  # NTPU預設位置
-                'lon': 121.3713889,
-                'alt': 0.024
-            },
-            'timestamp': timestamp
-        }
-    
     async def _make_handover_decision(
         self,
         serving_satellite: SatelliteMeasurement,
         neighbor_satellites: List[SatelliteMeasurement],
-        triggered_events: List[Dict]
+        triggered_events: List[Dict],
+        ue_id: str = "default",
+        timestamp: Optional[float] = None
     ) -> HandoverDecision:
         """基於觸發的事件做出換手決策"""
         
         # 檢查是否在冷卻期
-        if self._is_in_handover_cooldown():
+        if self._is_in_handover_cooldown(ue_id, timestamp):
             return HandoverDecision(
                 should_handover=False,
                 target_satellite_id=None,
@@ -293,31 +260,34 @@ class HandoverEventTriggerService:
             triggered_events=event_types
         )
     
-    def _is_in_handover_cooldown(self) -> bool:
-        """檢查是否在換手冷卻期內"""
-        if not self.handover_history:
+    def _is_in_handover_cooldown(self, ue_id: str = "default", timestamp: Optional[float] = None) -> bool:
+        """檢查該 UE 是否在換手冷卻期內"""
+        last_handover = self.last_handover_by_ue.get(ue_id)
+        if last_handover is None:
             return False
         
-        last_handover = self.handover_history[-1]
-        time_since_last = datetime.now().timestamp() - last_handover['timestamp']
-        
-        return time_since_last < self.handover_cooldown_seconds
+        now = timestamp if timestamp is not None else datetime.now().timestamp()
+        return now - last_handover < self.handover_cooldown_seconds
     
-    def _record_events(self, events: List[Dict]):
+    def _record_events(self, events: List[Dict], timestamp: float):
         """記錄事件到歷史"""
-        self.event_history.extend(events)
+        for event in events:
+            self.event_history.append(event)
+            self.event_counts[event.get('event_type', 'unknown')] += 1
         
         # 保留最近1小時的事件
-        cutoff_time = datetime.now().timestamp() - 3600
-        self.event_history = [
-            e for e in self.event_history 
-            if e.get('timestamp', 0) >= cutoff_time
-        ]
+        cutoff_time = timestamp - 3600
+        while self.event_history and self.event_history[0].get('timestamp', 0) < cutoff_time:
+            expired = self.event_history.popleft()
+            self.event_counts[expired.get('event_type', 'unknown')] -= 1
     
-    def _record_handover_decision(self, decision: HandoverDecision, timestamp: float):
+    def _record_handover_decision(self, decision: HandoverDecision, timestamp: float, ue_id: str = "default"):
         """記錄換手決策"""
         if decision.should_handover:
+            self.total_handovers += 1
+            self.last_handover_by_ue[ue_id] = timestamp
             self.handover_history.append({
+                'ue_id': ue_id,
                 'timestamp': timestamp,
                 'target_satellite': decision.target_satellite_id,
                 'reason': decision.handover_reason,
@@ -330,9 +300,11 @@ class HandoverEventTriggerService:
         events: List[Dict], 
         decision: HandoverDecision
     ):
-        """觸發註冊的事件回調"""
+        """觸發註冊的事件回調 (離開事件以 '<類型>_left' 註冊)"""
         for event in events:
             event_type = event['event_type']
+            if event.get('transition') == LEFT:
+                event_type = f"{event_type}_left"
             if event_type in self.event_callbacks:
                 for callback in self.event_callbacks[event_type]:
                     try:
@@ -352,16 +324,12 @@ class HandoverEventTriggerService:
     
     def get_event_statistics(self) -> Dict[str, Any]:
         """獲取事件統計"""
-        event_counts = {}
-        for event in self.event_history:
-            event_type = event.get('event_type', 'unknown')
-            event_counts[event_type] = event_counts.get(event_type, 0) + 1
-        
         return {
             'total_events': len(self.event_history),
-            'event_breakdown': event_counts,
-            'total_handovers': len(self.handover_history),
+            'event_breakdown': {k: v for k, v in self.event_counts.items() if v > 0},
+            'total_handovers': self.total_handovers,
             'last_handover': self.handover_history[-1] if self.handover_history else None,
+            'trigger_engine': self.trigger_engine.get_statistics(),
             'monitoring_active': self.is_active
         }
     
@@ -379,9 +347,15 @@ class HandoverEventTriggerService:
                 config['rsrp_thresholds']
             )
         
+        for key in ('hysteresis', 'time_to_trigger', 'filter_coefficient'):
+            if key in config:
+                self.event_generator.measurement_config[key] = config[key]
+        
         if 'distance_thresholds' in config:
             self.event_generator.distance_config.update(config['distance_thresholds'])
         
+        # 串流引擎直接引用生成器的配置字典，更新後立即生效
+        
         logger.info("📝 換手事件觸發服務配置已更新")
     
     async def _perform_event_check(self):
@@ -9,16 +9,22 @@ import logging
 import numpy as np
 from datetime import datetime, timezone, timedelta
 from pathlib import Path
-from typing import Dict, List, Optional, Any, Tuple
+from typing import Dict, List, Optional, Any, Sequence, Tuple
 from math import degrees, radians, sin, cos, sqrt, atan2, asin, pi
 
+from .visibility_timeline_cache import timeline_satellite_id
+from .window_search import (
+    PassOverlapIndex, SlidingWindowSearch, TickAggregates, WindowConstraints, WindowScoreWeights
+)
+
 logger = logging.getLogger(__name__)
 
 class CoordinateSpecificOrbitEngine:
     """座標特定軌道預計算引擎 - 支援任意觀測點"""
     
     def __init__(self, observer_lat: float, observer_lon: float, 
-                 observer_alt: float = 0.0, min_elevation: float = 10.0):
+                 observer_alt: float = 0.0, min_elevation: float = 10.0,
+                 timeline_cache=None):
         """
         初始化引擎
         
@@ -27,11 +33,13 @@ class CoordinateSpecificOrbitEngine:
             observer_lon: 觀測點經度 (度) 
             observer_alt: 觀測點海拔 (米)
             min_elevation: 最小仰角閾值 (度)
+            timeline_cache: 選用的 VisibilityTimelineCache，命中時跳過永不可見衛星的軌道計算
         """
         self.observer_lat = observer_lat
         self.observer_lon = observer_lon  
         self.observer_alt = observer_alt
         self.min_elevation = min_elevation
+        self.timeline_cache = timeline_cache
         
         # 預計算參數
         self.earth_radius_km = 6371.0  # 地球半徑 (km)
@@ -771,10 +779,27 @@ class CoordinateSpecificOrbitEngine:
             'total_input': len(all_satellites),
             'passed_filter': 0,
             'rejected_never_visible': 0,
-            'rejected_errors': 0
+            'rejected_errors': 0,
+            'timeline_cache_skipped': 0
         }
         
+        # 可見性時間軸快取：候選集合外的衛星在整個週期內都不會達到門檻
+        candidate_ids = None
+        if self.timeline_cache is not None:
+            candidate_ids = self.timeline_cache.candidate_ids(
+                self.observer_lat, self.observer_lon, all_satellites, reference_time,
+                reference_time + timedelta(minutes=self.orbital_period_minutes),
+                min_elevation_deg=self.min_elevation
+            )
+            if candidate_ids is not None:
+                logger.info(f"  可見性時間軸命中: {len(candidate_ids)} 顆候選衛星")
+        
         for i, satellite in enumerate(all_satellites):
+            if candidate_ids is not None and timeline_satellite_id(satellite) not in candidate_ids:
+                filter_stats['rejected_never_visible'] += 1
+                filter_stats['timeline_cache_skipped'] += 1
+                continue
+            
             try:
                 # 計算完整軌道週期
                 orbit_data = self.compute_96min_orbital_cycle(satellite, reference_time)
@@ -812,6 +837,8 @@ class CoordinateSpecificOrbitEngine:
         logger.info(f"  - 通過篩選: {filter_stats['passed_filter']}")
         logger.info(f"  - 永不可見: {filter_stats['rejected_never_visible']}")
         logger.info(f"  - 計算錯誤: {filter_stats['rejected_errors']}")
+        if candidate_ids is not None:
+            logger.info(f"  - 時間軸快取略過: {filter_stats['timeline_cache_skipped']}")
         logger.info(f"  - 篩選效率: {filter_efficiency:.1f}% 減少")
         
         return filtered_satellites
@@ -900,65 +927,64 @@ class CoordinateSpecificOrbitEngine:
         logger.info(f"  衛星數量: {len(filtered_satellites)}")
         
         # 24小時內每小時評估一次
-        evaluation_windows = []
+        # 可見弧段以參考時間為原點轉為秒數，一次建立 AOS/LOS 前綴和索引，
+        # 每個評估窗口的重疊統計只需兩次二分搜尋
         window_duration = timedelta(hours=window_hours)
-        
-        for hour_offset in range(0, 24, 1):  # 每小時評估
+        aos, los, durations, elevations = [], [], [], []
+        for satellite in filtered_satellites:
+            for vis_window in satellite.get('visibility_windows', []):
+                vis_start = datetime.fromisoformat(vis_window['start_time'].replace('Z', '+00:00'))
+                vis_end = datetime.fromisoformat(vis_window['end_time'].replace('Z', '+00:00'))
+                aos.append((vis_start - reference_time).total_seconds())
+                los.append((vis_end - reference_time).total_seconds())
+                durations.append(vis_window['duration_seconds'])
+                elevations.append(vis_window['max_elevation'])
+
+        elevations = np.asarray(elevations, dtype=float)
+        pass_index = PassOverlapIndex(aos, los, weights={
+            'duration': np.asarray(durations, dtype=float),
+            'elevation': elevations,
+            'handover': (elevations > 30).astype(float)  # 高仰角換手機會更好
+        })
+        integral_durations = all(isinstance(d, int) for d in durations)
+
+        offsets = np.arange(0, 24, 1) * 3600.0
+        overlaps = pass_index.overlaps(offsets, offsets + window_duration.total_seconds())
+
+        evaluation_windows = []
+        for i, hour_offset in enumerate(range(0, 24, 1)):
             window_start = reference_time + timedelta(hours=hour_offset)
             window_end = window_start + window_duration
-            
+            visible_count = int(overlaps['count'][i])
+            total_time = overlaps['duration'][i]
+
             window_stats = {
                 'start_time': window_start.isoformat(),
                 'end_time': window_end.isoformat(),
                 'duration_hours': window_hours,
-                'visible_satellites': 0,
-                'total_visibility_time': 0,
-                'avg_elevation': 0.0,
-                'handover_opportunities': 0,
+                'visible_satellites': visible_count,
+                'total_visibility_time': int(round(total_time)) if integral_durations else float(total_time),
+                'avg_elevation': float(overlaps['elevation'][i]) / visible_count if visible_count > 0 else 0.0,
+                'handover_opportunities': int(round(overlaps['handover'][i])),
                 'quality_score': 0.0
             }
-            
-            total_elevation = 0
-            elevation_count = 0
-            
-            # 評估每顆衛星在此窗口的表現
-            for satellite in filtered_satellites:
-                if 'visibility_windows' in satellite:
-                    for vis_window in satellite['visibility_windows']:
-                        vis_start = datetime.fromisoformat(vis_window['start_time'].replace('Z', '+00:00'))
-                        vis_end = datetime.fromisoformat(vis_window['end_time'].replace('Z', '+00:00'))
-                        
-                        # 檢查可見性窗口是否與評估窗口重疊
-                        if vis_start <= window_end and vis_end >= window_start:
-                            window_stats['visible_satellites'] += 1
-                            window_stats['total_visibility_time'] += vis_window['duration_seconds']
-                            total_elevation += vis_window['max_elevation']
-                            elevation_count += 1
-                            
-                            # 統計換手機會
-                            if vis_window['max_elevation'] > 30:  # 高仰角換手機會更好
-                                window_stats['handover_opportunities'] += 1
-            
-            # 計算平均仰角
-            if elevation_count > 0:
-                window_stats['avg_elevation'] = total_elevation / elevation_count
-            
+
             # 計算綜合品質分數
             # 考慮因素：可見衛星數、平均仰角、總可見時間、換手機會
             satellite_factor = min(window_stats['visible_satellites'] / 10, 1.0)  # 正規化到0-1
             elevation_factor = min(window_stats['avg_elevation'] / 90, 1.0)  # 正規化到0-1
             time_factor = min(window_stats['total_visibility_time'] / 3600, 1.0)  # 正規化到0-1 (1小時)
             handover_factor = min(window_stats['handover_opportunities'] / 20, 1.0)  # 正規化到0-1
-            
+
             window_stats['quality_score'] = (
                 satellite_factor * 0.4 +  # 40% 衛星數量
-                elevation_factor * 0.3 +   # 30% 平均仰角  
+                elevation_factor * 0.3 +   # 30% 平均仰角
                 time_factor * 0.2 +        # 20% 總可見時間
                 handover_factor * 0.1      # 10% 換手機會
             ) * 100
-            
+
             evaluation_windows.append(window_stats)
-        
+
         # 找出最佳窗口
         best_window = max(evaluation_windows, key=lambda w: w['quality_score'])
         
@@ -988,7 +1014,122 @@ class CoordinateSpecificOrbitEngine:
         
         return optimal_result
     
-    def generate_display_optimized_data(self, optimal_window_data: Dict[str, Any], 
+    def search_time_windows(self, filtered_satellites: List[Dict[str, Any]],
+                            window_minutes: Sequence[float] = (30, 45, 60),
+                            stride_seconds: Optional[int] = None,
+                            constraints: Optional[WindowConstraints] = None,
+                            weights: Optional[WindowScoreWeights] = None,
+                            top_k: int = 3,
+                            describe_best: bool = False) -> Dict[str, Any]:
+        """
+        多窗口長度滑動搜尋 (逐時刻精度)
+
+        以 compute_*_orbital_cycle 產出的 positions 建立 (衛星 × 時刻) 仰角矩陣，
+        每時刻聚合一次後以前綴和與滑動極值一次評估所有起點與窗口長度。
+
+        Args:
+            filtered_satellites: 含 positions (time_offset_seconds, elevation_deg) 的衛星清單
+            window_minutes: 要評估的窗口長度 (分鐘)
+            stride_seconds: 起點間隔，預設為時間步長
+            constraints: 窗口約束 (最少/最多可見數、最差仰角、覆蓋率)
+            weights: 評分權重
+            top_k: 每個窗口長度保留的最佳窗口數
+            describe_best: 是否為最佳窗口附上逐衛星可見弧段與最佳服務衛星切換事件
+
+        Returns:
+            Dict: {'by_length': {分鐘: [窗口]}, 'best': 最佳窗口, 'evaluated': 評估窗口數}
+        """
+        step = self.time_step_seconds
+        matrix = self._elevation_matrix_from_positions(filtered_satellites)
+        if matrix is None:
+            return {'by_length': {}, 'best': None, 'evaluated': 0}
+        elevation, start_time = matrix
+
+        aggregates = TickAggregates.from_elevation_matrix(elevation, start_time, step, self.min_elevation)
+        search = SlidingWindowSearch(aggregates)
+        lengths = {int(round(minutes * 60 / step)): minutes for minutes in window_minutes}
+        result = search.sweep(list(lengths), stride=max(1, (stride_seconds or step) // step),
+                              constraints=constraints, weights=weights, top_k=top_k)
+        result['by_length'] = {lengths[length]: windows for length, windows in result['by_length'].items()}
+
+        if result['best']:
+            if describe_best:
+                result['best'].update(self._describe_window_satellites(
+                    filtered_satellites, elevation, start_time,
+                    result['best']['start_tick'], result['best']['length_ticks']
+                ))
+            logger.info(f"滑動窗口搜尋完成: 評估 {result['evaluated']} 個窗口, "
+                        f"最佳 {result['best']['start_time']} ({result['best']['duration_minutes']:.0f} 分鐘), "
+                        f"分數 {result['best']['score']:.1f}")
+        return result
+
+    def _elevation_matrix_from_positions(
+            self, filtered_satellites: List[Dict[str, Any]]) -> Optional[Tuple[np.ndarray, datetime]]:
+        """positions 轉為 (衛星 × 時刻) 仰角矩陣 (缺值為 -90) 與時間軸起點；無位置資料時回傳 None"""
+        step = self.time_step_seconds
+        offsets = [p['time_offset_seconds'] for sat in filtered_satellites for p in sat.get('positions', [])]
+        if not offsets:
+            return None
+
+        ticks = int(max(offsets) // step) + 1
+        elevation = np.full((len(filtered_satellites), ticks), -90.0)
+        start_time = None
+        for row, satellite in enumerate(filtered_satellites):
+            for position in satellite.get('positions', []):
+                elevation[row, int(position['time_offset_seconds'] // step)] = position['elevation_deg']
+                if start_time is None and position['time_offset_seconds'] == 0:
+                    start_time = datetime.fromisoformat(position['time'])
+        if start_time is None:
+            start_time = datetime.fromisoformat(filtered_satellites[0]['computation_metadata']['start_time'])
+        return elevation, start_time
+
+    def _describe_window_satellites(self, filtered_satellites: List[Dict[str, Any]], elevation: np.ndarray,
+                                    start_time: datetime, start_tick: int, length: int) -> Dict[str, Any]:
+        """窗口 [start_tick, start_tick + length) 內的逐衛星可見弧段與最佳服務衛星切換"""
+        step = self.time_step_seconds
+        window = elevation[:, start_tick:start_tick + length]
+        visible = window >= self.min_elevation
+
+        def tick_time(tick: int) -> str:
+            return (start_time + timedelta(seconds=(start_tick + tick) * step)).isoformat()
+
+        satellites = []
+        for row in np.flatnonzero(visible.any(axis=1)):
+            # 連續可見區段：以前後補 False 的差分找出升起 / 落下索引
+            edges = np.diff(np.concatenate(([False], visible[row], [False])).astype(np.int8))
+            rises, sets = np.flatnonzero(edges == 1), np.flatnonzero(edges == -1)
+            satellite = filtered_satellites[row]
+            satellites.append({
+                'satellite_id': timeline_satellite_id(satellite),
+                'norad_id': satellite.get('norad_id'),
+                'name': satellite.get('name'),
+                'max_elevation': float(window[row][visible[row]].max()),
+                'visibility_windows': [
+                    {
+                        'start_time': tick_time(int(rise)),
+                        'end_time': tick_time(int(end) - 1),
+                        'max_elevation': float(window[row, rise:end].max()),
+                        'duration_minutes': (int(end) - int(rise)) * step / 60,
+                    }
+                    for rise, end in zip(rises, sets)
+                ],
+            })
+
+        # 每時刻由仰角最高的可見衛星服務，服務衛星改變即為一次換手
+        serving = np.where(visible.any(axis=0), np.argmax(np.where(visible, window, -np.inf), axis=0), -1)
+        handovers = []
+        for tick in np.flatnonzero((serving[1:] != serving[:-1]) & (serving[1:] >= 0) & (serving[:-1] >= 0)) + 1:
+            source, target = int(serving[tick - 1]), int(serving[tick])
+            handovers.append({
+                'timestamp': tick_time(int(tick)),
+                'from_satellite': timeline_satellite_id(filtered_satellites[source]),
+                'to_satellite': timeline_satellite_id(filtered_satellites[target]),
+                'trigger_reason': 'elevation_threshold',
+                'elevation_change': float(window[target, tick] - window[source, tick]),
+            })
+        return {'satellites': satellites, 'handover_events': handovers}
+
+    def generate_display_optimized_data(self, optimal_window_data: Dict[str, Any],
                                        acceleration: int = 60, 
                                        distance_scale: float = 0.1) -> Dict[str, Any]:
         """
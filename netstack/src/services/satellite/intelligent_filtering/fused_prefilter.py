@@ -0,0 +1,490 @@
+#!/usr/bin/env python3
+"""
+融合預篩選核心 - 階段二智能篩選系統
+
+將地理相關性篩選、星座仰角門檻 (含分層仰角換手階段)、RSRP 估算與換手適用性評分
+合併為一次對欄位陣列的向量化運算，輸出布林遮罩與評分向量。
+
+評分公式與 geographic_filter.py / handover_scorer.py / rsrp_calculator.py 逐項一致，
+僅將逐顆衛星的字典迴圈改為 (N 顆衛星 × T 個時間點) 的矩陣運算。
+"""
+
+import logging
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Sequence
+
+import numpy as np
+
+try:
+    from ..layered_elevation_threshold import LayeredThreshold
+    LAYERED_THRESHOLD_AVAILABLE = True
+except (ImportError, ValueError):
+    LAYERED_THRESHOLD_AVAILABLE = False
+
+logger = logging.getLogger(__name__)
+
+# 星座代碼：用於欄位陣列中的星座欄
+CONSTELLATION_CODES = {"starlink": 0, "oneweb": 1}
+UNKNOWN_CONSTELLATION = -1
+
+# 分層仰角換手階段代碼 (數值越大越接近斷線)
+PHASE_ORDER = ["monitoring", "pre_handover", "execution", "critical", "disconnected"]
+
+
+def _constellation_code(name: Optional[str]) -> int:
+    return CONSTELLATION_CODES.get(str(name or "").lower(), UNKNOWN_CONSTELLATION)
+
+
+@dataclass
+class SatelliteColumns:
+    """衛星欄位陣列 (每顆衛星一列，時間序列補齊為 N × T 矩陣)"""
+    satellite_ids: List[str]
+    group_code: np.ndarray          # 星座分離後的分組 (決定換手評分公式與 RSRP 參數)
+    threshold_code: np.ndarray      # 衛星自帶 constellation 欄位 (決定地理篩選仰角門檻)
+    inclination: np.ndarray
+    altitude: np.ndarray
+    eccentricity: np.ndarray
+    elevation: np.ndarray           # 補齊位置為 NaN
+    time_offset: np.ndarray
+    valid: np.ndarray               # 有效時間點遮罩
+    has_altitude: np.ndarray
+
+    def __len__(self) -> int:
+        return len(self.satellite_ids)
+
+    @property
+    def n_points(self) -> np.ndarray:
+        return self.valid.sum(axis=1)
+
+    @classmethod
+    def from_constellation_data(cls, constellation_data: Dict[str, List[Dict]]) -> "SatelliteColumns":
+        """由星座分離後的 {星座: [衛星...]} 結構建立欄位 (順序與字典迭代順序一致)"""
+        satellites: List[Dict] = []
+        groups: List[int] = []
+        for constellation, sats in constellation_data.items():
+            code = _constellation_code(constellation)
+            satellites.extend(sats)
+            groups.extend([code] * len(sats))
+        return cls.from_satellites(satellites, groups)
+
+    @classmethod
+    def from_satellites(cls, satellites: Sequence[Dict],
+                        group_codes: Optional[Sequence[int]] = None) -> "SatelliteColumns":
+        n = len(satellites)
+        max_len = max((len(s.get("timeseries") or []) for s in satellites), default=0)
+
+        inclination = np.zeros(n)
+        altitude = np.zeros(n)
+        eccentricity = np.zeros(n)
+        has_altitude = np.zeros(n, dtype=bool)
+        threshold_code = np.empty(n, dtype=np.int8)
+        elevation = np.full((n, max_len), np.nan)
+        time_offset = np.zeros((n, max_len))
+        valid = np.zeros((n, max_len), dtype=bool)
+        satellite_ids = []
+
+        for i, satellite in enumerate(satellites):
+            orbit_data = satellite.get("orbit_data", {})
+            satellite_ids.append(satellite.get("satellite_id", ""))
+            inclination[i] = orbit_data.get("inclination", 0)
+            altitude[i] = orbit_data.get("altitude", 0)
+            eccentricity[i] = orbit_data.get("eccentricity", 0)
+            has_altitude[i] = "altitude" in orbit_data
+            # 地理篩選以衛星自身的 constellation 欄位取門檻，預設 Starlink
+            threshold_code[i] = _constellation_code(satellite.get("constellation", "starlink"))
+
+            timeseries = satellite.get("timeseries") or []
+            if timeseries:
+                t = len(timeseries)
+                elevation[i, :t] = [p.get("elevation_deg", -90) for p in timeseries]
+                time_offset[i, :t] = [p.get("time_offset_seconds", 0) for p in timeseries]
+                valid[i, :t] = True
+
+        if group_codes is None:
+            group_code = threshold_code.copy()
+        else:
+            group_code = np.asarray(group_codes, dtype=np.int8)
+
+        return cls(
+            satellite_ids=satellite_ids,
+            group_code=group_code,
+            threshold_code=threshold_code,
+            inclination=inclination,
+            altitude=altitude,
+            eccentricity=eccentricity,
+            elevation=elevation,
+            time_offset=time_offset,
+            valid=valid,
+            has_altitude=has_altitude,
+        )
+
+
+@dataclass
+class FusedPrefilterResult:
+    """融合預篩選結果 (所有向量與輸入欄位同序)"""
+    mask: np.ndarray                # 通過地理篩選 (及選用的分層階段門檻)
+    score: np.ndarray               # 換手適用性評分，未通過者為 0
+    geo_score: np.ndarray           # 地理相關性評分，未通過者為 0
+    checked: np.ndarray             # 傾角/高度/時間序列檢查皆通過 (legacy 會寫入 _filtering_params_used)
+    min_elevation: np.ndarray       # 每顆衛星採用的星座仰角門檻
+    visible_points: np.ndarray
+    total_points: np.ndarray
+    peak_elevation: np.ndarray
+    peak_phase: np.ndarray          # 峰值仰角所處的分層換手階段代碼 (見 PHASE_ORDER)
+    handover_ready_points: np.ndarray  # 仰角 ≥ 執行門檻的時間點數
+    rsrp_peak_dbm: np.ndarray       # 峰值仰角下的 RSRP 估算，未通過者為 NaN
+    thresholds: Dict[str, Any] = field(default_factory=dict)
+
+    @property
+    def passed(self) -> int:
+        return int(self.mask.sum())
+
+    def ranked_indices(self, group_code: Optional[np.ndarray] = None, code: Optional[int] = None) -> np.ndarray:
+        """通過者依評分降序 (穩定排序，與 list.sort(reverse=True) 同序)"""
+        selected = self.mask if code is None else self.mask & (group_code == code)
+        indices = np.flatnonzero(selected)
+        order = np.argsort(-self.score[indices], kind="stable")
+        return indices[order]
+
+
+class FusedPrefilterKernel:
+    """地理篩選 + 仰角門檻 + RSRP + 換手評分 融合核心
+
+    參數直接取自既有的 GeographicFilter / HandoverScorer / RSRPCalculator 實例，
+    確保兩條路徑使用同一份配置。
+    """
+
+    def __init__(self, geographic_filter, handover_scorer, rsrp_calculator,
+                 environment: str = "open", min_peak_phase: Optional[str] = None):
+        """
+        Args:
+            geographic_filter: GeographicFilter 實例 (觀測點與星座仰角門檻)
+            handover_scorer: HandoverScorer 實例 (評分權重)
+            rsrp_calculator: RSRPCalculator 實例 (鏈路預算參數)
+            environment: 分層仰角門檻環境 (open/urban/mountain/rain_heavy)
+            min_peak_phase: 選用的分層門檻篩選，例如 "execution" 表示峰值仰角
+                            至少需達臨界門檻；None 時與既有篩選結果完全一致
+        """
+        self.geographic_filter = geographic_filter
+        self.handover_scorer = handover_scorer
+        self.rsrp_calculator = rsrp_calculator
+        self.environment = environment
+
+        if LAYERED_THRESHOLD_AVAILABLE:
+            self.layered_thresholds = LayeredThreshold().get_adjusted_thresholds(environment)
+        else:
+            self.layered_thresholds = {"pre_handover": 15.0, "execution": 10.0, "critical": 5.0,
+                                       "environment": environment, "adjustment_factor": 1.0}
+
+        if min_peak_phase is not None and min_peak_phase not in PHASE_ORDER:
+            raise ValueError(f"未知的換手階段: {min_peak_phase}")
+        self.min_peak_phase = min_peak_phase
+
+    # ------------------------------------------------------------------
+    # 主流程
+    # ------------------------------------------------------------------
+
+    def evaluate(self, columns: SatelliteColumns) -> FusedPrefilterResult:
+        """一次向量化運算完成 F2.2 地理篩選與 F2.3 換手評分"""
+        n = len(columns)
+        observer_lat = self.geographic_filter.observer_location["latitude"]
+        params = self.geographic_filter.constellation_filtering_params
+
+        min_elevation = np.where(columns.threshold_code == CONSTELLATION_CODES["oneweb"],
+                                 params["oneweb"]["min_elevation_deg"],
+                                 params["starlink"]["min_elevation_deg"])
+
+        elevation = columns.elevation
+        valid = columns.valid
+        total_points = columns.n_points
+
+        # 1. 地理篩選: 傾角覆蓋、高度範圍、時間序列存在、星座門檻可見點
+        checked = ((columns.inclination >= abs(observer_lat))
+                   & (columns.altitude >= 200) & (columns.altitude <= 2000)
+                   & (total_points > 0))
+        visible_points = (valid & (elevation >= min_elevation[:, None])).sum(axis=1)
+        mask = checked & (visible_points > 0)
+
+        # 2. 分層仰角換手階段
+        peak_elevation = np.where(valid, elevation, -np.inf).max(axis=1, initial=-np.inf)
+        peak_phase = self._phase_codes(peak_elevation)
+        handover_ready_points = (valid & (elevation >= self.layered_thresholds["execution"])).sum(axis=1)
+        if self.min_peak_phase is not None:
+            mask &= peak_phase <= PHASE_ORDER.index(self.min_peak_phase)
+
+        # 3. 地理相關性評分與換手評分
+        geo_score = np.where(mask, self._geographic_scores(columns, observer_lat), 0.0)
+        score = np.where(mask, self._handover_scores(columns), 0.0)
+
+        # 4. 峰值仰角 RSRP 估算 (通過者峰值仰角必 ≥ 星座門檻 > 0)
+        rsrp = np.full(n, np.nan)
+        if mask.any():
+            rsrp[mask] = self.rsrp_dbm(columns.altitude[mask], columns.group_code[mask],
+                                       peak_elevation[mask])
+
+        return FusedPrefilterResult(
+            mask=mask,
+            score=score,
+            geo_score=geo_score,
+            checked=checked,
+            min_elevation=min_elevation,
+            visible_points=visible_points,
+            total_points=total_points,
+            peak_elevation=peak_elevation,
+            peak_phase=peak_phase,
+            handover_ready_points=handover_ready_points,
+            rsrp_peak_dbm=rsrp,
+            thresholds={k: v for k, v in self.layered_thresholds.items()},
+        )
+
+    def _phase_codes(self, elevation: np.ndarray) -> np.ndarray:
+        """與 LayeredElevationEngine.analyze_satellite_phase 相同的階段判斷"""
+        th = self.layered_thresholds
+        return np.select(
+            [elevation >= th["pre_handover"], elevation >= th["execution"],
+             elevation >= th["critical"], elevation > 0],
+            [0, 1, 2, 3], default=4,
+        ).astype(np.int8)
+
+    # ------------------------------------------------------------------
+    # 地理相關性評分 (geographic_filter._calculate_geographic_relevance_score)
+    # ------------------------------------------------------------------
+
+    def _geographic_scores(self, columns: SatelliteColumns, observer_lat: float) -> np.ndarray:
+        inclination = columns.inclination
+        altitude = columns.altitude
+
+        inclination_score = np.select(
+            [inclination < observer_lat, inclination <= observer_lat + 10,
+             inclination <= observer_lat + 30, inclination <= 90],
+            [0.0, 50.0, 100.0, 80.0], default=60.0,
+        )
+
+        # 可見性統計與覆蓋持續性使用通用 (Starlink) 門檻
+        threshold = self.geographic_filter.filtering_params["min_elevation_deg"]
+        visible = columns.valid & (columns.elevation >= threshold)
+        total_points = columns.n_points
+        visible_count = visible.sum(axis=1)
+        has_visible = visible_count > 0
+        safe_count = np.maximum(visible_count, 1)
+
+        elevation_sum = np.where(visible, columns.elevation, 0.0).sum(axis=1)
+        max_elevation = np.where(visible, columns.elevation, 0.0).max(axis=1, initial=0.0)
+        visibility_ratio = visible_count / np.maximum(total_points, 1) * 50
+        max_elevation_score = np.minimum(max_elevation / 90 * 30, 30)
+        avg_elevation_score = np.minimum(elevation_sum / safe_count / 45 * 20, 20)
+        visibility_score = np.where(
+            has_visible, visibility_ratio + max_elevation_score + avg_elevation_score, 0.0)
+
+        altitude_score = np.select(
+            [altitude <= 0, (altitude >= 400) & (altitude <= 600), (altitude >= 1100) & (altitude <= 1300),
+             (altitude >= 300) & (altitude <= 800), (altitude >= 800) & (altitude <= 1500)],
+            [0.0, 100.0, 90.0, 80.0, 70.0], default=30.0,
+        )
+
+        segments, longest = self._visible_runs(visible)
+        avg_segment = visible_count / np.maximum(segments, 1)
+        coverage_score = np.where(
+            segments > 0,
+            np.minimum(avg_segment / 10 * 50, 50) + np.minimum(longest / 20 * 50, 50),
+            0.0,
+        )
+
+        score = inclination_score * 0.30
+        score = score + visibility_score * 0.40
+        score = score + altitude_score * 0.20
+        score = score + coverage_score * 0.10
+        return np.clip(score, 0.0, 100.0)
+
+    @staticmethod
+    def _visible_runs(visible: np.ndarray):
+        """連續可見段落數與最長段落長度 (沿時間軸迭代，對衛星維度向量化)"""
+        n, t = visible.shape
+        run = np.zeros(n, dtype=np.int64)
+        longest = np.zeros(n, dtype=np.int64)
+        for k in range(t):
+            run = (run + 1) * visible[:, k]
+            np.maximum(longest, run, out=longest)
+        previous = np.zeros_like(visible)
+        if t:
+            previous[:, 1:] = visible[:, :-1]
+        segments = (visible & ~previous).sum(axis=1)
+        return segments, longest
+
+    # ------------------------------------------------------------------
+    # 換手適用性評分 (handover_scorer._calculate_*_handover_score)
+    # ------------------------------------------------------------------
+
+    def _handover_scores(self, columns: SatelliteColumns) -> np.ndarray:
+        starlink_cfg = self.handover_scorer.starlink_scoring_config
+        oneweb_cfg = self.handover_scorer.oneweb_scoring_config
+        inclination = columns.inclination
+        altitude = columns.altitude
+        eccentricity = columns.eccentricity
+        total_points = columns.n_points
+
+        phase_score = self._phase_distribution_scores(columns)
+
+        # --- Starlink ---
+        inc_dev = np.abs(inclination - starlink_cfg["optimal_inclination"])
+        s_inclination = np.select([inc_dev <= 2, inc_dev <= 5, inc_dev <= 10], [100.0, 85.0, 70.0],
+                                  default=np.maximum(0.0, 50.0 - inc_dev * 2))
+        alt_dev = np.abs(altitude - starlink_cfg["optimal_altitude"])
+        s_altitude = np.select([alt_dev <= 50, alt_dev <= 100, alt_dev <= 200], [100.0, 80.0, 60.0],
+                               default=np.maximum(0.0, 40.0 - alt_dev * 0.1))
+
+        above_horizon = columns.valid & (columns.elevation >= 0)
+        previous = np.zeros_like(above_horizon)
+        previous[:, 1:] = above_horizon[:, :-1]
+        changes = (columns.valid & (above_horizon != previous)).sum(axis=1)
+        s_frequency = np.select([changes <= 2, changes <= 6, changes <= 10], [30.0, 100.0, 80.0], default=50.0)
+        s_frequency = np.where(total_points > 0, s_frequency, 0.0)
+
+        eccentricity_score = np.maximum(0, 100 - eccentricity * 1000)
+        altitude_stability = np.where((altitude >= 400) & (altitude <= 1500), 100.0,
+                                      np.maximum(0, 100 - np.abs(altitude - 950) * 0.1))
+        s_stability = (eccentricity_score + altitude_stability) / 2
+
+        starlink = s_inclination * starlink_cfg["orbital_inclination_weight"] / 100
+        starlink = starlink + s_altitude * starlink_cfg["altitude_suitability_weight"] / 100
+        starlink = starlink + phase_score * starlink_cfg["phase_distribution_weight"] / 100
+        starlink = starlink + s_frequency * starlink_cfg["handover_frequency_weight"] / 100
+        starlink = starlink + s_stability * starlink_cfg["signal_stability_weight"] / 100
+
+        # --- OneWeb ---
+        o_inclination = np.select([inclination >= 85, inclination >= 80, inclination >= 70],
+                                  [100.0, 80.0, 60.0], default=30.0)
+        o_dev = np.abs(altitude - oneweb_cfg["optimal_altitude"])
+        o_altitude = np.select([o_dev <= 100, o_dev <= 200, o_dev <= 300], [100.0, 80.0, 60.0],
+                               default=np.maximum(0.0, 40.0 - o_dev * 0.05))
+        o_polar = np.select([inclination >= 85, inclination >= 70, inclination >= 50],
+                            [100.0, 80.0, 60.0], default=20.0)
+        o_shape = np.select([eccentricity <= 0.001, eccentricity <= 0.005, eccentricity <= 0.01, eccentricity <= 0.05],
+                            [100.0, 90.0, 80.0, 60.0], default=30.0)
+
+        oneweb = o_inclination * oneweb_cfg["orbital_inclination_weight"] / 100
+        oneweb = oneweb + o_altitude * oneweb_cfg["altitude_suitability_weight"] / 100
+        oneweb = oneweb + o_polar * oneweb_cfg["polar_coverage_weight"] / 100
+        oneweb = oneweb + o_shape * oneweb_cfg["orbital_shape_weight"] / 100
+        oneweb = oneweb + phase_score * oneweb_cfg["phase_distribution_weight"] / 100
+
+        # 既有評分器只處理 starlink / oneweb 兩組，其餘分組不評分
+        score = np.select([columns.group_code == CONSTELLATION_CODES["starlink"],
+                           columns.group_code == CONSTELLATION_CODES["oneweb"]],
+                          [starlink, oneweb], default=0.0)
+        return np.clip(score, 0.0, 100.0)
+
+    @staticmethod
+    def _phase_distribution_scores(columns: SatelliteColumns) -> np.ndarray:
+        """可見 (仰角 ≥ 0°) 時間點間隔的樣本標準差 → 均勻度評分"""
+        visible = columns.valid & (columns.elevation >= 0)
+        n, t = visible.shape
+
+        # 以前向填補取得上一個可見時間點，得到相鄰可見點間隔
+        intervals = np.zeros((n, t))
+        has_interval = np.zeros((n, t), dtype=bool)
+        last_time = np.zeros(n)
+        seen = np.zeros(n, dtype=bool)
+        for k in range(t):
+            current = visible[:, k]
+            has_interval[:, k] = current & seen
+            intervals[:, k] = columns.time_offset[:, k] - last_time
+            last_time = np.where(current, columns.time_offset[:, k], last_time)
+            seen |= current
+
+        count = has_interval.sum(axis=1)
+        mean = np.where(has_interval, intervals, 0.0).sum(axis=1) / np.maximum(count, 1)
+        squared = np.where(has_interval, (intervals - mean[:, None]) ** 2, 0.0).sum(axis=1)
+        std_dev = np.where(count > 1, np.sqrt(squared / np.maximum(count - 1, 1)), 0.0)
+        uniformity = np.minimum(100.0, np.maximum(0, 100 - (std_dev / 1800 * 100)))
+
+        visible_count = visible.sum(axis=1)
+        score = np.where(visible_count < 2, 50.0, uniformity)
+        return np.where(columns.n_points > 0, score, 0.0)
+
+    # ------------------------------------------------------------------
+    # RSRP (rsrp_calculator.calculate_rsrp 的向量化版本)
+    # ------------------------------------------------------------------
+
+    def _link_parameters(self, group_code: np.ndarray):
+        """依星座分組取得 EIRP 與頻率 (未知星座使用 3GPP NTN 建議值)"""
+        constellation_params = self.rsrp_calculator.constellation_params
+        eirp = np.full(group_code.shape, 42.0)
+        frequency = np.full(group_code.shape, 20.0)
+        for name, code in CONSTELLATION_CODES.items():
+            if name in constellation_params:
+                selected = group_code == code
+                eirp[selected] = constellation_params[name]["eirp_dbw"]
+                frequency[selected] = constellation_params[name]["frequency_ghz"]
+        return eirp, frequency
+
+    def rsrp_dbm(self, altitude: np.ndarray, group_code: np.ndarray, elevation_deg) -> np.ndarray:
+        """
+        計算 RSRP (dBm)
+
+        Args:
+            altitude: 衛星高度 (km)，形狀 (N,)
+            group_code: 星座分組代碼，形狀 (N,)
+            elevation_deg: 仰角，形狀 (N,) 或 (N, K)；(K,) 時對每顆衛星評估 K 個仰角
+
+        Returns:
+            與 elevation_deg 廣播後相同形狀的 RSRP 陣列
+        """
+        altitude = np.asarray(altitude, dtype=float)
+        elevation = np.asarray(elevation_deg, dtype=float)
+        eirp, frequency = self._link_parameters(np.asarray(group_code))
+        if elevation.ndim == 1 and elevation.shape[0] != altitude.shape[0]:
+            elevation = np.broadcast_to(elevation, (altitude.shape[0], elevation.shape[0]))
+        if elevation.ndim == 2:
+            altitude = altitude[:, None]
+            eirp = eirp[:, None]
+            frequency = frequency[:, None]
+
+        terminal = self.rsrp_calculator.ground_terminal_params
+        system = self.rsrp_calculator.system_params
+        water_vapor = self.rsrp_calculator.atmospheric_params["water_vapor_density"]
+
+        # 傾斜距離 (餘弦定理)
+        R = 6371.0
+        elevation_rad = np.radians(elevation)
+        sat_radius = R + altitude
+        distance = np.sqrt(R * R + sat_radius * sat_radius
+                           - 2 * R * sat_radius * np.cos(np.pi / 2 - elevation_rad))
+
+        # ITU-R P.525 自由空間損耗
+        fspl = 32.45 + 20 * np.log10(frequency) + 20 * np.log10(distance)
+
+        # ITU-R P.618 / P.676 大氣損耗
+        oxygen = np.select([frequency < 15.0, frequency < 25.0],
+                           [0.008, 0.012 + (frequency - 15.0) * 0.002], default=0.032)
+        vapor = np.select([frequency < 15.0, frequency < 25.0],
+                          [water_vapor * 0.0006, water_vapor * (0.001 + (frequency - 15.0) * 0.0002)],
+                          default=water_vapor * 0.003)
+        sin_elevation = np.sin(elevation_rad)
+        # 與逐顆計算器相同，門檻比較使用弧度往返換算後的仰角 (30° 會落在 29.999...)
+        atmospheric_deg = np.degrees(elevation_rad)
+        with np.errstate(divide="ignore", invalid="ignore"):
+            path_km = np.where(atmospheric_deg >= 5.0, 8.0 * (1.0 / sin_elevation),
+                               8.0 / np.sin(np.radians(5.0)) * (5.0 / atmospheric_deg))
+            cloud = np.where(atmospheric_deg < 30.0, 0.1 * (1.0 / sin_elevation), 0.05)
+        atmospheric = oxygen * path_km + vapor * path_km + cloud
+
+        received = (eirp + terminal["antenna_gain_dbi"] - fspl - atmospheric
+                    - terminal["implementation_loss_db"] - terminal["polarization_loss_db"]
+                    - terminal["pointing_loss_db"] + 30)
+        rsrp = received - 10 * np.log10(terminal["total_subcarriers"])
+
+        # ITU-R P.681 確定性衰落
+        height_factor = np.clip((altitude - 400.0) / (2000.0 - 400.0), 0.1, 1.0)
+        fading = (system["multipath_std_db"] * (1.0 - height_factor * 0.3)
+                  + system["shadowing_std_db"] * (1.0 - sin_elevation * 0.5))
+
+        return np.clip(rsrp - fading, -140.0, -50.0)
+
+
+def create_fused_prefilter_kernel(geographic_filter, handover_scorer, rsrp_calculator,
+                                  environment: str = "open",
+                                  min_peak_phase: Optional[str] = None) -> FusedPrefilterKernel:
+    """創建融合預篩選核心"""
+    return FusedPrefilterKernel(geographic_filter, handover_scorer, rsrp_calculator,
+                                environment=environment, min_peak_phase=min_peak_phase)
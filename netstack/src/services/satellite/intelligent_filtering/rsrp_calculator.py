@@ -79,6 +79,12 @@ class RSRPCalculator:
             'humidity_percent': 75.0        # 平均相對濕度
         }
         
+        # ITU-R P.681 LEO 陸地行動衛星信道 (開闊/郊區) 衰落統計
+        self.system_params = {
+            'multipath_std_db': 2.0,        # 多徑衰落標準差
+            'shadowing_std_db': 4.0         # 陰影衰落標準差
+        }
+        
     def calculate_rsrp(self, satellite: Dict[str, Any], elevation_deg: float = 45.0) -> float:
         """
         計算衛星的 RSRP 信號強度 - 完全符合學術級標準 Grade A
@@ -26,6 +26,13 @@ from .handover_scorer import HandoverScorer
 from .rsrp_calculator import RSRPCalculator, create_rsrp_calculator
 from .gpp_event_analyzer import GPPEventAnalyzer, create_gpp_event_analyzer
 
+# 融合預篩選核心 (需要 numpy)，不可用時退回逐顆衛星的模組鏈
+try:
+    from .fused_prefilter import SatelliteColumns, create_fused_prefilter_kernel
+    FUSED_PREFILTER_AVAILABLE = True
+except ImportError:
+    FUSED_PREFILTER_AVAILABLE = False
+
 logger = logging.getLogger(__name__)
 
 
@@ -35,13 +42,15 @@ class UnifiedIntelligentFilter:
     完整的模組化智能篩選架構，整合所有功能
     """
     
-    def __init__(self, observer_lat: float = 24.9441667, observer_lon: float = 121.3713889):
+    def __init__(self, observer_lat: float = 24.9441667, observer_lon: float = 121.3713889,
+                 use_fused_kernel: bool = True):
         """
         初始化統一智能篩選系統
         
         Args:
             observer_lat: 觀測點緯度 (NTPU)
             observer_lon: 觀測點經度 (NTPU)
+            use_fused_kernel: 以融合向量化核心一次完成地理篩選與換手評分
         """
         self.observer_lat = observer_lat
         self.observer_lon = observer_lon
@@ -53,6 +62,14 @@ class UnifiedIntelligentFilter:
         self.rsrp_calculator = create_rsrp_calculator(observer_lat, observer_lon)
         self.event_analyzer = create_gpp_event_analyzer(self.rsrp_calculator)
         
+        # 融合預篩選核心共用上述模組的配置
+        self.prefilter_kernel = None
+        self.last_prefilter_result = None
+        if use_fused_kernel and FUSED_PREFILTER_AVAILABLE:
+            self.prefilter_kernel = create_fused_prefilter_kernel(
+                self.geographic_filter, self.handover_scorer, self.rsrp_calculator
+            )
+        
         logger.info("🚀 統一智能篩選系統初始化完成")
         logger.info(f"📍 觀測點: NTPU ({observer_lat:.4f}°N, {observer_lon:.4f}°E)")
         logger.info("✅ 已載入: 星座分離 + 地理篩選 + 換手評分 + 信號計算 + 事件分析")
@@ -90,7 +107,7 @@ class UnifiedIntelligentFilter:
         
         # === F2.2：地理相關性篩選 ===
         logger.info("🌍 執行F2.2: 地理相關性篩選")
-        geo_filtered = self.geographic_filter.apply_geographic_filtering(constellation_filtered)
+        geo_filtered, fused_scored = self._apply_geographic_filtering(constellation_filtered)
         
         geo_stats = self.geographic_filter.get_filtering_statistics(constellation_filtered, geo_filtered)
         f2_total = sum(len(sats) for sats in geo_filtered.values())
@@ -99,7 +116,7 @@ class UnifiedIntelligentFilter:
         
         # === F3：換手適用性評分 ===
         logger.info("📊 執行F3: 換手適用性評分")
-        scored_data = self.handover_scorer.apply_handover_scoring(geo_filtered)
+        scored_data = fused_scored if fused_scored is not None else self.handover_scorer.apply_handover_scoring(geo_filtered)
         
         scoring_stats = self.handover_scorer.get_scoring_statistics(scored_data)
         f3_total = sum(len(sats) for sats in scored_data.values())
@@ -179,7 +196,7 @@ class UnifiedIntelligentFilter:
         
         # === F2.2：地理相關性篩選 ===
         logger.info("🌍 執行F2.2: 地理相關性篩選")
-        geo_filtered = self.geographic_filter.apply_geographic_filtering(constellation_filtered)
+        geo_filtered, fused_scored = self._apply_geographic_filtering(constellation_filtered)
         
         geo_stats = self.geographic_filter.get_filtering_statistics(constellation_filtered, geo_filtered)
         f2_total = sum(len(sats) for sats in geo_filtered.values())
@@ -188,7 +205,7 @@ class UnifiedIntelligentFilter:
         
         # === F2.3：換手適用性評分 ===
         logger.info("📊 執行F2.3: 換手適用性評分")
-        scored_data = self.handover_scorer.apply_handover_scoring(geo_filtered)
+        scored_data = fused_scored if fused_scored is not None else self.handover_scorer.apply_handover_scoring(geo_filtered)
         
         scoring_stats = self.handover_scorer.get_scoring_statistics(scored_data)
         f2_scored_total = sum(len(sats) for sats in scored_data.values())
@@ -264,7 +281,7 @@ class UnifiedIntelligentFilter:
         
         # === 2. geographical_relevance ===  
         logger.info("🌍 步驟2: geographical_relevance")
-        geo_filtered = self.geographic_filter.apply_geographic_filtering(constellation_filtered)
+        geo_filtered, fused_scored = self._apply_geographic_filtering(constellation_filtered)
         executed_steps.append("geographical_relevance")
         
         geo_stats = self.geographic_filter.get_filtering_statistics(constellation_filtered, geo_filtered)
@@ -273,7 +290,7 @@ class UnifiedIntelligentFilter:
         
         # === 3. handover_suitability ===
         logger.info("📊 步驟3: handover_suitability") 
-        scored_data = self.handover_scorer.apply_handover_scoring(geo_filtered)
+        scored_data = fused_scored if fused_scored is not None else self.handover_scorer.apply_handover_scoring(geo_filtered)
         executed_steps.append("handover_suitability")
         
         scoring_stats = self.handover_scorer.get_scoring_statistics(scored_data)
@@ -323,6 +340,57 @@ class UnifiedIntelligentFilter:
         logger.info("📊 執行換手適用性評分（文檔標準方法）") 
         return self.handover_scorer.apply_handover_scoring(geo_filtered_data)
     
+    def _apply_geographic_filtering(self, constellation_filtered: Dict[str, List[Dict]]
+                                    ) -> Tuple[Dict[str, List[Dict]], Optional[Dict[str, List[Dict]]]]:
+        """
+        F2.2 地理篩選 (+ F2.3 換手評分)
+        
+        融合核心可用時，一次向量化運算同時得到地理篩選與換手評分結果，
+        寫回衛星字典的欄位與排序和逐模組執行完全相同；否則只做地理篩選，
+        評分結果回傳 None 由呼叫端交給 HandoverScorer。
+        """
+        if self.prefilter_kernel is None:
+            return self.geographic_filter.apply_geographic_filtering(constellation_filtered), None
+        
+        columns = SatelliteColumns.from_constellation_data(constellation_filtered)
+        result = self.prefilter_kernel.evaluate(columns)
+        self.last_prefilter_result = result
+        
+        geo_filtered: Dict[str, List[Dict]] = {}
+        scored_data: Dict[str, List[Dict]] = {}
+        offset = 0
+        for constellation, satellites in constellation_filtered.items():
+            for i, satellite in enumerate(satellites, start=offset):
+                if result.checked[i]:
+                    satellite["_filtering_params_used"] = {
+                        "constellation": satellite.get("constellation", "starlink").lower(),
+                        "min_elevation_deg": float(result.min_elevation[i]),
+                        "visible_points": int(result.visible_points[i]),
+                        "total_points": int(result.total_points[i])
+                    }
+            
+            passed = [i for i in range(offset, offset + len(satellites)) if result.mask[i]]
+            geo_filtered[constellation] = []
+            for i in passed:
+                satellite = satellites[i - offset]
+                satellite["geographic_relevance_score"] = float(result.geo_score[i])
+                geo_filtered[constellation].append(satellite)
+            
+            # 與 HandoverScorer 相同：僅 starlink / oneweb 分組評分並依評分降序
+            if constellation in ("starlink", "oneweb"):
+                ranked = sorted(passed, key=lambda i: result.score[i], reverse=True)
+                scored_data[constellation] = []
+                for i in ranked:
+                    satellite = satellites[i - offset]
+                    satellite["handover_suitability_score"] = float(result.score[i])
+                    satellite["constellation"] = constellation
+                    scored_data[constellation].append(satellite)
+            offset += len(satellites)
+        
+        logger.info(f"⚡ 融合預篩選核心: {len(columns)} 顆衛星單次向量化評估, "
+                   f"{result.passed} 顆通過")
+        return geo_filtered, scored_data
+    
     def _extract_satellites_from_sgp4_data(self, sgp4_data: Dict[str, Any]) -> List[Dict]:
         """從SGP4數據中提取衛星列表，兼容字典和列表格式"""
         all_satellites = []
@@ -423,23 +491,36 @@ class UnifiedIntelligentFilter:
     def _enhance_with_signal_quality(self, scored_data: Dict[str, List[Dict]]) -> Dict[str, List[Dict]]:
         """為衛星數據添加信號品質評估"""
         enhanced_data = {}
+        evaluation_elevations = [10, 30, 45, 60]
         
         for constellation, satellites in scored_data.items():
             enhanced_satellites = []
             
-            for satellite in satellites:
+            # 融合核心一次計算整個星座的 RSRP 表；缺少高度的衛星交由逐顆計算器報錯
+            rsrp_table = None
+            if self.prefilter_kernel is not None and satellites and all(
+                    'altitude' in sat.get('orbit_data', {}) for sat in satellites):
+                columns = SatelliteColumns.from_satellites(satellites)
+                rsrp_table = self.prefilter_kernel.rsrp_dbm(
+                    columns.altitude, columns.group_code, evaluation_elevations
+                ).tolist()
+            
+            for index, satellite in enumerate(satellites):
                 enhanced_satellite = satellite.copy()
                 
                 # 計算多個仰角下的 RSRP
-                rsrp_values = []
-                for elevation in [10, 30, 45, 60]:
-                    rsrp = self.rsrp_calculator.calculate_rsrp(satellite, elevation)
-                    rsrp_values.append(rsrp)
+                if rsrp_table is not None:
+                    rsrp_values = rsrp_table[index]
+                else:
+                    rsrp_values = []
+                    for elevation in evaluation_elevations:
+                        rsrp = self.rsrp_calculator.calculate_rsrp(satellite, elevation)
+                        rsrp_values.append(rsrp)
                 
                 # 添加信號品質指標
                 enhanced_satellite['signal_quality'] = {
                     'rsrp_range': {
-                        f'elev_{elev}deg': rsrp for elev, rsrp in zip([10, 30, 45, 60], rsrp_values)
+                        f'elev_{elev}deg': rsrp for elev, rsrp in zip(evaluation_elevations, rsrp_values)
                     },
                     'mean_rsrp_dbm': sum(rsrp_values) / len(rsrp_values),
                     'max_rsrp_dbm': max(rsrp_values),
@@ -694,9 +775,10 @@ class UnifiedIntelligentFilter:
 
 
 def create_unified_intelligent_filter(observer_lat: float = 24.9441667, 
-                                     observer_lon: float = 121.3713889) -> UnifiedIntelligentFilter:
+                                     observer_lon: float = 121.3713889,
+                                     use_fused_kernel: bool = True) -> UnifiedIntelligentFilter:
     """創建統一智能篩選系統實例"""
-    return UnifiedIntelligentFilter(observer_lat, observer_lon)
+    return UnifiedIntelligentFilter(observer_lat, observer_lon, use_fused_kernel=use_fused_kernel)
 
 
 if __name__ == "__main__":
@@ -11,19 +11,22 @@ from pathlib import Path
 from typing import Dict, List, Optional, Any, Tuple
 import numpy as np
 from shared_core.elevation_threshold_manager import get_elevation_threshold_manager
+from .visibility_timeline_cache import timeline_satellite_id
 
 logger = logging.getLogger(__name__)
 
 class NTPUVisibilityFilter:
     """NTPU 座標特定可見性篩選器"""
     
-    def __init__(self, coordinate_engine=None, cache_enabled: bool = True):
+    def __init__(self, coordinate_engine=None, cache_enabled: bool = True,
+                 timeline_cache=None):
         """
         初始化 NTPU 可見性篩選器
         
         Args:
             coordinate_engine: CoordinateSpecificOrbitEngine 實例
             cache_enabled: 是否啟用結果緩存
+            timeline_cache: 選用的 VisibilityTimelineCache (僅用於精確計算路徑)
         """
         # NTPU 固定座標
         self.observer_lat = 24.94417   # 24°56'39"N
@@ -38,6 +41,7 @@ class NTPUVisibilityFilter:
         self.coordinate_engine = coordinate_engine
         self.cache_enabled = cache_enabled
         self.visibility_cache = {}
+        self.timeline_cache = timeline_cache
         
         # 篩選統計
         self.filter_stats = {
@@ -45,6 +49,7 @@ class NTPUVisibilityFilter:
             'visible_satellites': 0,
             'filtered_out': 0,
             'cache_hits': 0,
+            'timeline_cache_rejections': 0,
             'processing_time_seconds': 0.0
         }
         
@@ -77,6 +82,14 @@ class NTPUVisibilityFilter:
             if self.coordinate_engine is None:
                 # 如果沒有座標引擎，使用簡化瞬時計算
                 visibility_result = self._instantaneous_visibility_check(satellite_data, reference_time)
+            elif self._timeline_rejects(satellite_data, reference_time):
+                # 時間軸與精確計算使用相同幾何，候選集合外必不可見
+                self.filter_stats['timeline_cache_rejections'] += 1
+                visibility_result = {
+                    'is_visible': False,
+                    'calculation_method': 'visibility_timeline_cache',
+                    'observation_time': reference_time.isoformat()
+                }
             else:
                 # 使用精確瞬時計算
                 visibility_data = self.coordinate_engine.compute_instantaneous_visibility(
@@ -123,6 +136,16 @@ class NTPUVisibilityFilter:
                 'calculation_method': 'error'
             }
     
+    def _timeline_rejects(self, satellite_data: Dict[str, Any], reference_time: datetime) -> bool:
+        """可見性時間軸命中且衛星不在候選集合內"""
+        if self.timeline_cache is None:
+            return False
+        candidates = self.timeline_cache.candidate_ids(
+            self.observer_lat, self.observer_lon, [satellite_data], reference_time,
+            min_elevation_deg=self.min_elevation
+        )
+        return candidates is not None and timeline_satellite_id(satellite_data) not in candidates
+    
     def _instantaneous_visibility_check(self, satellite_data: Dict[str, Any], 
                                        reference_time: datetime) -> Dict[str, Any]:
         """
@@ -455,9 +478,11 @@ class NTPUVisibilityFilter:
             return False
 
 
-def create_ntpu_filter(coordinate_engine=None, cache_enabled: bool = True) -> NTPUVisibilityFilter:
+def create_ntpu_filter(coordinate_engine=None, cache_enabled: bool = True,
+                       timeline_cache=None) -> NTPUVisibilityFilter:
     """創建 NTPU 可見性篩選器實例"""
-    return NTPUVisibilityFilter(coordinate_engine=coordinate_engine, cache_enabled=cache_enabled)
+    return NTPUVisibilityFilter(coordinate_engine=coordinate_engine, cache_enabled=cache_enabled,
+                                timeline_cache=timeline_cache)
 
 
 if __name__ == "__main__":
@@ -22,6 +22,8 @@ from skyfield.api import EarthSatellite, utc, load, wgs84
 import numpy as np
 from shared_core.elevation_threshold_manager import get_elevation_threshold_manager
 
+from .window_search import SlidingWindowSearch, TickAggregates, per_satellite_window_stats
+
 
 logger = logging.getLogger(__name__)
 
@@ -290,61 +292,178 @@ class OptimalTimeframeAnalyzer:
             最佳時間段配置
         """
         logger.info("開始尋找最佳換手時間段...")
+
+        today = datetime.now(timezone.utc).replace(hour=0, minute=0, second=0, microsecond=0)
+        scan_minutes = 96 * 60
+        durations = [30, 35, 40, 45]  # 測試不同時間段長度
+
+        # 時間窗起點 (每5分鐘) 與長度須落在取樣格點上，才能共用一次傳播的仰角矩陣
+        if (5 * 60) % self.time_step_seconds != 0:
+            return self._find_optimal_timeframe_by_rescan(
+                observer_lat, observer_lon, candidate_satellites, durations, scan_minutes
+            )
+
+        # 掃描96分鐘內的不同時間窗（每5分鐘檢查一次）
+        # 整個掃描範圍只傳播一次，各時間窗的逐衛星統計以前綴和與滑動最大值取得
+        step = self.time_step_seconds
+        elevation = self._compute_elevation_matrix(
+            candidate_satellites, observer_lat, observer_lon, today,
+            int(scan_minutes * 60 // step) + 1
+        )
+
+        # 起點 (每5分鐘) 由 SlidingWindowSearch 列舉；同時可見數上限超過 10 的窗口，
+        # 不重複可見衛星數必然超過理想範圍，先以滑動最大值排除，只對其餘起點計算逐衛星統計
+        search = SlidingWindowSearch(
+            TickAggregates.from_elevation_matrix(elevation, today, step, self.min_elevation)
+        )
+        best = None  # (起點分鐘, 長度)
+        max_coverage_score = 0
+
+        window_candidates = []
+        for duration in durations:
+            length = duration * 60 // step + 1  # 含結束時間點
+            metrics = search.evaluate(length, stride=5 * 60 // step)
+            if metrics['starts'].size == 0:
+                continue
+            starts = metrics['starts'][metrics['max_visible'] <= 10]
+            if starts.size == 0:
+                continue
+            valid = starts * step // 60
+            stats = per_satellite_window_stats(
+                elevation, self.min_elevation, length, starts.astype(np.int64)
+            )
+            counts = (stats['visible_ticks'] > 0).sum(axis=0)
+            # 理想衛星數量範圍
+            for w in np.flatnonzero((counts >= 6) & (counts <= 10)):
+                window_candidates.append((int(valid[w]), duration, stats, w))
+
+        # 依原掃描順序 (起點、長度) 評分，保持相同的最佳窗口選擇
+        window_candidates.sort(key=lambda c: (c[0], durations.index(c[1])))
+        for start_minute, duration, stats, w in window_candidates:
+            coverage_score = self._score_window_from_stats(stats, w, duration)
+            if coverage_score > max_coverage_score:
+                max_coverage_score = coverage_score
+                best = (start_minute, duration)
+
+        best_timeframe = None
+        if best:
+            # 只為最佳時間窗產出完整軌跡
+            start_minute, duration = best
+            timeframe_satellites = self.analyze_timeframe_coverage(
+                candidate_satellites, start_minute, duration, observer_lat, observer_lon
+            )
+            if timeframe_satellites:
+                best_timeframe = self._build_timeframe(today, start_minute, duration, timeframe_satellites)
+
+        if best_timeframe:
+            logger.info(f"找到最佳時間段: {best_timeframe.start_timestamp}, "
+                       f"持續 {best_timeframe.duration_minutes} 分鐘, "
+                       f"{best_timeframe.satellite_count} 顆衛星, "
+                       f"品質評分: {best_timeframe.coverage_quality_score:.2f}")
+        else:
+            logger.warning("未找到符合條件的最佳時間段")
         
+        return best_timeframe
+    
+    def _compute_elevation_matrix(self, candidate_satellites: List[Dict[str, str]],
+                                  observer_lat: float, observer_lon: float,
+                                  start_time: datetime, ticks: int) -> np.ndarray:
+        """整個掃描範圍的 (衛星 × 時刻) 仰角矩陣，計算失敗的衛星整列為 NaN"""
+        observer = self.earth.latlon(observer_lat, observer_lon)
+        times = self.ts.from_datetimes([
+            start_time + timedelta(seconds=k * self.time_step_seconds) for k in range(ticks)
+        ])
+
+        elevation = np.full((len(candidate_satellites), ticks), np.nan)
+        for row, satellite_data in enumerate(candidate_satellites):
+            try:
+                satellite = EarthSatellite(satellite_data['line1'], satellite_data['line2'], satellite_data['name'])
+                alt, _, _ = (satellite - observer).at(times).altaz()
+                elevation[row] = alt.degrees
+            except Exception as e:
+                logger.error(f"計算衛星 {satellite_data['name']} 可見性失敗: {e}")
+        return elevation
+
+    def _score_window_from_stats(self, stats: Dict[str, np.ndarray], w: int, duration_minutes: int) -> float:
+        """
+        由逐衛星窗口統計計算覆蓋品質評分
+        與 _calculate_coverage_quality_score 相同的公式與累加順序
+        """
+        rows = np.flatnonzero(stats['visible_ticks'][:, w] > 0)
+        satellite_count = len(rows)
+        step = self.time_step_seconds
+
+        if 6 <= satellite_count <= 10:
+            count_score = 1.0
+        else:
+            count_score = max(0, 1 - abs(satellite_count - 8) * 0.1)
+
+        max_elevations = [float(stats['max_elevation'][r, w]) for r in rows]
+        first_ticks = [int(stats['first_tick'][r, w]) for r in rows]
+        last_ticks = [int(stats['last_tick'][r, w]) for r in rows]
+        durations = [(last - first) * step / 60 for first, last in zip(first_ticks, last_ticks)]
+
+        elevation_score = sum(max_elevations) / satellite_count / 90
+        coverage_score = min(sum(durations) / (duration_minutes * 2), 1.0)
+
+        # 換手連續性：依優先級穩定排序後檢查相鄰衛星的落下/升起間隔
+        continuity_score = 0.0
+        if satellite_count >= 2:
+            priorities = [
+                self._calculate_handover_priority(
+                    VisibilityWindow('', '', '', max_elevations[i], durations[i]), 0
+                )
+                for i in range(satellite_count)
+            ]
+            order = sorted(range(satellite_count), key=lambda i: priorities[i])
+            overlap_count = 0
+            for current, following in zip(order, order[1:]):
+                gap_seconds = (first_ticks[following] - last_ticks[current]) * step
+                if gap_seconds <= 300:  # 重疊或間隔不超過5分鐘
+                    overlap_count += 1
+            continuity_score = overlap_count / (satellite_count - 1)
+
+        return (count_score * 0.3 + elevation_score * 0.3 +
+                coverage_score * 0.2 + continuity_score * 0.2)
+
+    def _build_timeframe(self, today: datetime, start_time_minutes: int, duration: int,
+                         timeframe_satellites: List[SatelliteTrajectory]) -> OptimalTimeframe:
+        """組裝最佳時間段結果"""
+        return OptimalTimeframe(
+            start_timestamp=(today + timedelta(minutes=start_time_minutes)).isoformat(),
+            duration_minutes=duration,
+            satellite_count=len(timeframe_satellites),
+            satellites=timeframe_satellites,
+            handover_sequence=self._generate_handover_sequence(timeframe_satellites),
+            coverage_quality_score=self._calculate_coverage_quality_score(timeframe_satellites, duration)
+        )
+
+    def _find_optimal_timeframe_by_rescan(self, observer_lat: float, observer_lon: float,
+                                          candidate_satellites: List[Dict[str, str]],
+                                          durations: List[int], scan_minutes: int) -> Optional[OptimalTimeframe]:
+        """時間步長無法對齊5分鐘起點時，逐時間窗重新計算軌跡"""
+        today = datetime.now(timezone.utc).replace(hour=0, minute=0, second=0, microsecond=0)
         best_timeframe = None
         max_coverage_score = 0
-        
-        # 掃描96分鐘內的不同時間窗（每5分鐘檢查一次）
-        for start_time_minutes in range(0, 96 * 60, 5):
-            for duration in [30, 35, 40, 45]:  # 測試不同時間段長度
-                if start_time_minutes + duration > 96 * 60:
+
+        for start_time_minutes in range(0, scan_minutes, 5):
+            for duration in durations:
+                if start_time_minutes + duration > scan_minutes:
                     continue
-                
-                logger.debug(f"分析時間段: {start_time_minutes//60:02d}:{start_time_minutes%60:02d} - {duration}分鐘")
-                
-                # 分析該時間段的衛星覆蓋
+
                 timeframe_satellites = self.analyze_timeframe_coverage(
                     candidate_satellites, start_time_minutes, duration, observer_lat, observer_lon
                 )
-                
                 if not timeframe_satellites:
                     continue
-                
-                # 計算覆蓋品質評分
+
                 coverage_score = self._calculate_coverage_quality_score(timeframe_satellites, duration)
-                
-                # 檢查是否為最佳配置
-                if (coverage_score > max_coverage_score and 
-                    6 <= len(timeframe_satellites) <= 10):  # 理想衛星數量範圍
-                    
+                if coverage_score > max_coverage_score and 6 <= len(timeframe_satellites) <= 10:
                     max_coverage_score = coverage_score
-                    
-                    # 生成換手序列
-                    handover_sequence = self._generate_handover_sequence(timeframe_satellites)
-                    
-                    # 計算開始時間戳
-                    today = datetime.now(timezone.utc).replace(hour=0, minute=0, second=0, microsecond=0)
-                    start_timestamp = (today + timedelta(minutes=start_time_minutes)).isoformat()
-                    
-                    best_timeframe = OptimalTimeframe(
-                        start_timestamp=start_timestamp,
-                        duration_minutes=duration,
-                        satellite_count=len(timeframe_satellites),
-                        satellites=timeframe_satellites,
-                        handover_sequence=handover_sequence,
-                        coverage_quality_score=coverage_score
-                    )
-        
-        if best_timeframe:
-            logger.info(f"找到最佳時間段: {best_timeframe.start_timestamp}, "
-                       f"持續 {best_timeframe.duration_minutes} 分鐘, "
-                       f"{best_timeframe.satellite_count} 顆衛星, "
-                       f"品質評分: {best_timeframe.coverage_quality_score:.2f}")
-        else:
-            logger.warning("未找到符合條件的最佳時間段")
-        
+                    best_timeframe = self._build_timeframe(today, start_time_minutes, duration, timeframe_satellites)
+
         return best_timeframe
-    
+
     def _calculate_coverage_quality_score(self, satellites: List[SatelliteTrajectory], duration_minutes: int) -> float:
         """計算覆蓋品質評分"""
         if not satellites:
@@ -11,7 +11,9 @@ import math
 # Numpy 替代方案
 try:
     import numpy as np
+    NUMPY_AVAILABLE = True
 except ImportError:
+    NUMPY_AVAILABLE = False
     class NumpyMock:
         def std(self, data): 
             if not data or len(data) <= 1: return 0.0
@@ -28,6 +30,16 @@ from dataclasses import dataclass
 
 logger = logging.getLogger(__name__)
 
+# 相位空間索引 (需要 numpy 與 orbit-engine 共用模組)；不可用時明確警告，避免靜默退回
+try:
+    from .phase_space_index import PhaseSpaceIndex, circular_diversity
+    PHASE_SPACE_INDEX_AVAILABLE = True
+    PHASE_SPACE_INDEX_ERROR = None
+except ImportError as e:
+    PHASE_SPACE_INDEX_AVAILABLE = False
+    PHASE_SPACE_INDEX_ERROR = str(e)
+    logger.warning(f"⚠️ 相位空間索引不可用: {e}")
+
 @dataclass
 class OrbitalPlaneInfo:
     """軌道平面資訊"""
@@ -310,12 +322,57 @@ class OrbitalPlaneGrouper:
         
         return diversity_score
     
+    def build_phase_space_index(self, satellites: List[Dict],
+                                raan_bins: int = 36, phase_bins: int = 36) -> "PhaseSpaceIndex":
+        """
+        建立 (RAAN, 緯度幅角) 環面網格索引
+        
+        衛星字典需含 raan、mean_anomaly，可選 argument_of_perigee、mean_motion、inclination；
+        索引可用 advance(dt) 隨時間推進，並以網格掃描回答空洞與填補查詢。
+        """
+        if not PHASE_SPACE_INDEX_AVAILABLE:
+            raise RuntimeError(f"相位空間索引不可用: {PHASE_SPACE_INDEX_ERROR}")
+        return PhaseSpaceIndex.from_orbital_elements(satellites, raan_bins, phase_bins)
+    
+    def find_phase_gaps(self, selected_satellites: List[Dict], candidates: List[Dict],
+                        max_fills: int = 5) -> List[Dict]:
+        """
+        找出已選衛星的最大相位空洞，並為每個空洞挑選最接近的候選衛星
+        
+        Returns:
+            [{'raan_deg', 'phase_deg', 'clearance_cells', 'fill_satellite_id'}]
+        """
+        selected_index = self.build_phase_space_index(selected_satellites)
+        candidate_index = self.build_phase_space_index(candidates)
+        by_id = {
+            str(sat.get('satellite_id', sat.get('name', i))): sat
+            for i, sat in enumerate(candidates)
+        }
+        
+        # 每次填補後更新已選索引，下一個空洞依填補後的分佈重新計算
+        fills = []
+        for _ in range(max_fills):
+            holes = selected_index.largest_holes(top_k=1)
+            if not holes or not len(candidate_index):
+                break
+            hole = holes[0]
+            fill_id = selected_index.best_fill(candidate_index, hole['raan_deg'], hole['phase_deg'])
+            fills.append({**hole, 'fill_satellite_id': fill_id})
+            fill = by_id[fill_id]
+            candidate_index.remove_satellites([fill_id])
+            # 沿用完整軌道元素 (平均運動、傾角)，填補後的索引 advance() 時才會正確推進
+            selected_index.add_orbital_elements([{**fill, 'satellite_id': fill_id}])
+        return fills
+    
     def _calculate_circular_diversity(self, angles: List[float]) -> float:
         """計算圓形角度的分散度"""
         
         if len(angles) <= 1:
             return 0.0
         
+        if PHASE_SPACE_INDEX_AVAILABLE:
+            return circular_diversity([angle % 360.0 for angle in angles])
+        
         # 轉換為單位向量
         radians = [math.radians(angle % 360.0) for angle in angles]
         
@@ -11,7 +11,9 @@ import math
 # Numpy 替代方案
 try:
     import numpy as np
+    NUMPY_AVAILABLE = True
 except ImportError:
+    NUMPY_AVAILABLE = False
     class NumpyMock:
         def std(self, data): 
             if not data or len(data) <= 1: return 0.0
@@ -28,6 +30,16 @@ from dataclasses import dataclass
 
 logger = logging.getLogger(__name__)
 
+# 相位空間索引 (需要 numpy 與 orbit-engine 共用模組)；不可用時明確警告，避免靜默退回
+try:
+    from .phase_space_index import PhaseSpaceIndex, circular_diversity
+    PHASE_SPACE_INDEX_AVAILABLE = True
+    PHASE_SPACE_INDEX_ERROR = None
+except ImportError as e:
+    PHASE_SPACE_INDEX_AVAILABLE = False
+    PHASE_SPACE_INDEX_ERROR = str(e)
+    logger.warning(f"⚠️ 相位空間索引不可用: {e}")
+
 @dataclass 
 class PhaseInfo:
     """相位資訊"""
@@ -233,6 +245,9 @@ class PhaseDistributionOptimizer:
                                target_count: int) -> List[PhaseInfo]:
         """貪心算法選擇相位分散最佳的衛星"""
         
+        if NUMPY_AVAILABLE:
+            return self._greedy_phase_selection_vectorized(phase_infos, target_count)
+        
         selected = []
         candidates = phase_infos.copy()
         
@@ -266,6 +281,56 @@ class PhaseDistributionOptimizer:
         
         return selected
     
+    def _greedy_phase_selection_vectorized(self, phase_infos: List[PhaseInfo],
+                                           target_count: int) -> List[PhaseInfo]:
+        """
+        向量化貪心選擇 (結果與逐一比較版本相同)
+        
+        已選衛星的升起時間保持排序，每輪以 searchsorted 取得所有候選者
+        與最近已選衛星的間隔，避免候選者 × 已選衛星的兩兩比較。
+        """
+        
+        if not phase_infos:
+            return []
+        
+        rise = np.array([info.rise_time.timestamp() for info in phase_infos])
+        quality = np.array([info.phase_quality for info in phase_infos])
+        available = np.ones(len(phase_infos), dtype=bool)
+        
+        # 選擇第一顆衛星 (品質最高的)
+        first = int(np.argmax(quality))
+        order = [first]
+        available[first] = False
+        selected_rise = rise[[first]]
+        
+        while len(order) < target_count and available.any():
+            candidates = np.flatnonzero(available)
+            candidate_rise = rise[candidates]
+            
+            # 與已選衛星的最小升起時間間隔 (左右鄰居)
+            pos = np.searchsorted(selected_rise, candidate_rise)
+            left = selected_rise[np.maximum(pos - 1, 0)]
+            right = selected_rise[np.minimum(pos, selected_rise.size - 1)]
+            min_interval = np.minimum(np.abs(candidate_rise - left), np.abs(candidate_rise - right))
+            
+            interval_score = np.where(
+                min_interval >= self.optimal_separation,
+                1.0,
+                np.where(
+                    min_interval >= self.min_separation,
+                    (min_interval - self.min_separation) / (self.optimal_separation - self.min_separation),
+                    0.1 * (min_interval / self.min_separation)
+                )
+            )
+            total_score = 0.4 * quality[candidates] + 0.6 * interval_score
+            
+            best = int(candidates[int(np.argmax(total_score))])
+            order.append(best)
+            available[best] = False
+            selected_rise = np.insert(selected_rise, np.searchsorted(selected_rise, rise[best]), rise[best])
+        
+        return [phase_infos[i] for i in order]
+    
     def _calculate_interval_score(self, candidate: PhaseInfo, 
                                  selected: List[PhaseInfo]) -> float:
         """計算時間間隔品質分數"""
@@ -402,6 +467,11 @@ class PhaseDistributionOptimizer:
             ]
         }
         
+        if PHASE_SPACE_INDEX_AVAILABLE:
+            report['phase_space'] = PhaseSpaceIndex.from_orbital_elements(satellites).summary()
+        else:
+            report['phase_space'] = {'available': False, 'error': PHASE_SPACE_INDEX_ERROR}
+        
         if intervals:
             report['interval_statistics'] = {
                 'mean_interval_seconds': np.mean(intervals),
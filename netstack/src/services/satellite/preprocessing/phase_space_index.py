@@ -0,0 +1,15 @@
+"""
+軌道相位空間索引 - (RAAN, 緯度幅角) 環面網格
+
+唯一實作位於 orbit-engine shared/core_modules/phase_space_index.py，
+此處載入該檔案並重新匯出，供預處理階段的相位分散與軌道分群使用。
+"""
+
+from shared_core.orbit_engine_modules import load_orbit_engine_module
+
+_shared = load_orbit_engine_module("shared/core_modules/phase_space_index.py")
+
+PhaseSpaceIndex = _shared.PhaseSpaceIndex
+circular_diversity = _shared.circular_diversity
+
+__all__ = ["PhaseSpaceIndex", "circular_diversity"]
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+"""
+陣列化無縫循環建構器
+
+SeamlessLoopGenerator 原本在逐幀字典上比對首尾衛星位置並線性插入過渡幀。
+本模組改以 (幀 × 衛星 × 欄位) 陣列運作：
+- 循環點：在軌道週期整數倍附近的候選幀，向量化計算所有衛星相對第 0 幀的
+  ECEF 位置誤差，取平均誤差最小者
+- 過渡幀：以三次 Hermite 插值銜接循環尾端與開頭 (端點斜率取自相鄰幀差分)，
+  經度與方位角先展開再插值
+- 只在輸出時把可見衛星轉為幀字典，陣列以 float32 儲存
+"""
+
+import logging
+from dataclasses import dataclass
+from datetime import datetime, timedelta
+from typing import Any, Dict, List, Optional, Sequence
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+FRAME_FIELDS = ("lat", "lon", "alt", "elevation", "azimuth", "distance", "rsrp", "doppler")
+_FIELD = {name: k for k, name in enumerate(FRAME_FIELDS)}
+EARTH_RADIUS_KM = 6378.137
+
+
+@dataclass
+class FrameArray:
+    """(幀 × 衛星 × 欄位) 時間序列"""
+    timestamps: List[datetime]
+    satellite_ids: List[Any]
+    data: np.ndarray            # (F, S, len(FRAME_FIELDS))
+    step_seconds: float
+
+    @property
+    def frame_count(self) -> int:
+        return int(self.data.shape[0])
+
+    def field(self, name: str) -> np.ndarray:
+        return self.data[..., _FIELD[name]]
+
+    @classmethod
+    def from_batch(cls, batch, dtype=np.float32) -> "FrameArray":
+        """由 TrajectoryBatch (N × T) 建立，僅保留計算成功的衛星"""
+        rows = [row for row in batch.unique_rows().values() if batch.valid[row]]
+        data = np.empty((len(batch.timestamps), len(rows), len(FRAME_FIELDS)), dtype=dtype)
+        for k, name in enumerate(FRAME_FIELDS):
+            data[..., k] = getattr(batch, name)[rows].T
+        step = ((batch.timestamps[1] - batch.timestamps[0]).total_seconds()
+                if len(batch.timestamps) > 1 else 30.0)
+        return cls(list(batch.timestamps), [batch.satellite_ids[row] for row in rows], data, step)
+
+    @classmethod
+    def from_frames(cls, frames: Sequence[Dict], dtype=np.float32) -> "FrameArray":
+        """由逐幀字典 (TimeSeriesEngine 幀格式) 建立；幀中缺席的衛星填 NaN"""
+        ids: Dict[Any, int] = {}
+        for frame in frames:
+            for sat in frame.get("satellites", []):
+                ids.setdefault(sat["satellite_id"], len(ids))
+
+        data = np.full((len(frames), len(ids), len(FRAME_FIELDS)), np.nan, dtype=dtype)
+        for f, frame in enumerate(frames):
+            for sat in frame.get("satellites", []):
+                s = ids[sat["satellite_id"]]
+                for group in ("position", "relative", "signal"):
+                    for name, value in sat.get(group, {}).items():
+                        if name in _FIELD:
+                            data[f, s, _FIELD[name]] = value
+
+        timestamps = [datetime.fromisoformat(frame["timestamp"].replace("Z", "+00:00")) for frame in frames]
+        step = (timestamps[1] - timestamps[0]).total_seconds() if len(timestamps) > 1 else 30.0
+        return cls(timestamps, list(ids), data, step)
+
+    def to_frames(self, min_elevation: float = 10.0, stop: Optional[int] = None) -> List[Dict]:
+        """轉為逐幀字典，只輸出仰角達門檻的衛星"""
+        stop = self.frame_count if stop is None else stop
+        frames = [
+            {
+                "timestamp": self.timestamps[f].isoformat(),
+                "satellites": [],
+                "active_events": [],
+                "handover_candidates": []
+            }
+            for f in range(stop)
+        ]
+
+        # 一次取出所有可見 (幀, 衛星) 的欄位值再分派到各幀
+        frame_index, sat_index = np.nonzero(self.field("elevation")[:stop] >= min_elevation)
+        values = self.data[frame_index, sat_index].tolist()
+        for f, s, row in zip(frame_index.tolist(), sat_index.tolist(), values):
+            frames[f]["satellites"].append(_satellite_entry(self.satellite_ids[s], row))
+        return frames
+
+
+def _satellite_entry(sat_id: Any, values) -> Dict[str, Any]:
+    lat, lon, alt, elevation, azimuth, distance, rsrp, doppler = values
+    return {
+        "satellite_id": sat_id,
+        "name": f"SAT-{sat_id}",
+        "position": {"lat": lat, "lon": lon, "alt": alt},
+        "relative": {"elevation": elevation, "azimuth": azimuth, "distance": distance},
+        "signal": {"rsrp": rsrp, "doppler": doppler}
+    }
+
+
+def _ecef(frames: FrameArray, index) -> np.ndarray:
+    """指定幀的衛星 ECEF 位置 (km)，球面地球近似"""
+    lat = np.radians(frames.field("lat")[index].astype(np.float64))
+    lon = np.radians(frames.field("lon")[index].astype(np.float64))
+    radius = EARTH_RADIUS_KM + frames.field("alt")[index].astype(np.float64)
+    return np.stack([radius * np.cos(lat) * np.cos(lon),
+                     radius * np.cos(lat) * np.sin(lon),
+                     radius * np.sin(lat)], axis=-1)
+
+
+def find_loop_point(frames: FrameArray, period_minutes: float,
+                    search_radius_frames: int = 6, min_fraction: float = 0.5) -> Dict[str, Any]:
+    """
+    在軌道週期整數倍附近尋找循環點
+
+    候選結束幀 L = k × 週期 ± search_radius_frames (L ≥ min_fraction × 總幀數)，
+    誤差為所有衛星在幀 L 與幀 0 的平均 ECEF 距離。
+
+    Returns:
+        {'loop_point': L, 'position_error_km': 誤差, 'orbits': k, 'candidates': 評估數}
+    """
+    total = frames.frame_count
+    period_frames = period_minutes * 60.0 / frames.step_seconds
+    if total < 2 or period_frames <= 0 or frames.data.shape[1] == 0:
+        return {"loop_point": total, "position_error_km": 0.0, "orbits": 0, "candidates": 0}
+
+    candidates = set()
+    for k in range(1, int((total - 1) / period_frames) + 1):
+        center = int(round(k * period_frames))
+        for offset in range(-search_radius_frames, search_radius_frames + 1):
+            end = center + offset
+            if max(1, min_fraction * total) <= end <= total - 1:
+                candidates.add(end)
+    if not candidates:
+        candidates = {total - 1}
+    candidates = np.array(sorted(candidates))
+
+    reference = _ecef(frames, 0)                        # (S, 3)
+    errors = np.linalg.norm(_ecef(frames, candidates) - reference[None], axis=-1)   # (C, S)
+    finite = np.isfinite(errors)
+    counts = finite.sum(axis=1)
+    mean_errors = np.where(counts > 0, np.where(finite, errors, 0.0).sum(axis=1) / np.maximum(counts, 1), np.inf)
+
+    best = int(np.argmin(mean_errors))
+    loop_point = int(candidates[best])
+    return {
+        "loop_point": loop_point,
+        "position_error_km": float(mean_errors[best]),
+        "orbits": int(round(loop_point / period_frames)),
+        "candidates": int(candidates.size)
+    }
+
+
+def hermite_transition(frames: FrameArray, loop_point: int, transition_frames: int) -> np.ndarray:
+    """
+    循環尾端 (幀 loop_point - 1) 到開頭 (幀 0) 的三次 Hermite 過渡幀
+
+    Returns:
+        (transition_frames, S, 欄位) 陣列
+    """
+    data = frames.data
+    p0 = data[loop_point - 1].astype(np.float64)
+    p1 = data[0].astype(np.float64)
+    m0 = p0 - data[loop_point - 2] if loop_point >= 2 else np.zeros_like(p0)
+    m1 = data[1] - p1 if frames.frame_count >= 2 else np.zeros_like(p1)
+
+    # 角度欄位展開：終點取與起點差距最小的等價角
+    for name, span in (("lon", 360.0), ("azimuth", 360.0)):
+        k = _FIELD[name]
+        p1[:, k] = p0[:, k] + (p1[:, k] - p0[:, k] + span / 2) % span - span / 2
+        m0[:, k] = (m0[:, k] + span / 2) % span - span / 2
+        m1[:, k] = (m1[:, k] + span / 2) % span - span / 2
+
+    intervals = transition_frames + 1
+    s = (np.arange(1, transition_frames + 1) / intervals)[:, None, None]
+    h00 = 2 * s ** 3 - 3 * s ** 2 + 1
+    h10 = s ** 3 - 2 * s ** 2 + s
+    h01 = -2 * s ** 3 + 3 * s ** 2
+    h11 = s ** 3 - s ** 2
+    # 斜率以「每幀」計，換算為整段過渡參數
+    result = h00 * p0 + h10 * intervals * m0 + h01 * p1 + h11 * intervals * m1
+
+    lon = result[..., _FIELD["lon"]]
+    result[..., _FIELD["lon"]] = (lon + 180.0) % 360.0 - 180.0
+    result[..., _FIELD["azimuth"]] %= 360.0
+    return result.astype(frames.data.dtype)
+
+
+def build_seamless_loop(frames: FrameArray, period_minutes: float, window_hours: int = 24,
+                        position_threshold_km: float = 10.0, transition_seconds: int = 60,
+                        min_elevation: float = 10.0, search_radius_frames: int = 6) -> Dict[str, Any]:
+    """建立無縫循環時間序列 (SeamlessLoopGenerator.create_seamless_loop 的輸出格式)"""
+    if frames.frame_count == 0:
+        return {"frames": [], "metadata": {"loop_point": 0}}
+
+    loop = find_loop_point(frames, period_minutes, search_radius_frames)
+    loop_point = loop["loop_point"]
+    output = frames.to_frames(min_elevation, stop=loop_point)
+
+    transition_count = 0
+    if loop["position_error_km"] > position_threshold_km and loop_point >= 1:
+        transition_count = max(1, int(transition_seconds // frames.step_seconds))
+        transition = hermite_transition(frames, loop_point, transition_count)
+        visible = transition[..., _FIELD["elevation"]] >= min_elevation
+        last_time = frames.timestamps[loop_point - 1]
+        for i in range(transition_count):
+            output.append({
+                "timestamp": (last_time + timedelta(seconds=(i + 1) * frames.step_seconds)).isoformat(),
+                "satellites": [_satellite_entry(frames.satellite_ids[s], transition[i, s].tolist())
+                               for s in np.flatnonzero(visible[i])],
+                "transition": True,
+                "alpha": (i + 1) / (transition_count + 1)
+            })
+
+    logger.info(f"循環點: 第 {loop_point} 幀 ({loop['orbits']} 個軌道週期), "
+                f"位置誤差 {loop['position_error_km']:.2f} km, 過渡幀 {transition_count}")
+
+    return {
+        "frames": output,
+        "metadata": {
+            "loop_point": loop_point,
+            "window_hours": window_hours,
+            "total_frames": len(output),
+            "seamless": True,
+            "position_diff_km": loop["position_error_km"],
+            "loop_orbits": loop["orbits"],
+            "loop_candidates_evaluated": loop["candidates"],
+            "transition_frames": transition_count,
+            "transition_method": "hermite"
+        }
+    }
@@ -13,11 +13,18 @@
 
 import math
 from datetime import datetime, timezone, timedelta
+from pathlib import Path
 from typing import List, Dict, Any, Optional, Tuple
 from concurrent.futures import ThreadPoolExecutor
 import asyncio
 import logging
 
+import numpy as np
+
+from .trajectory_kernel import TrajectoryBatch, VectorizedTrajectoryKernel
+from .seamless_loop_builder import FrameArray, build_seamless_loop
+from .window_search import SlidingWindowSearch, TickAggregates
+
 # 設置日誌
 logger = logging.getLogger(__name__)
 
@@ -111,6 +118,18 @@ class SeamlessLoopGenerator:
             }
         }
     
+    def create_seamless_loop_from_array(self, frames: FrameArray, orbit_info: Dict[str, Any],
+                                        min_elevation: float = 10.0) -> Dict[str, Any]:
+        """陣列幀版本：在軌道週期整數倍附近選循環點，過渡幀以 Hermite 插值"""
+        
+        return build_seamless_loop(
+            frames,
+            period_minutes=orbit_info.get("orbit_period_minutes", 96),
+            window_hours=orbit_info.get("window_hours", 24),
+            position_threshold_km=self.position_threshold,
+            min_elevation=min_elevation
+        )
+    
     def _calculate_position_difference(self, frame1: Dict, frame2: Dict) -> float:
         """計算兩個時間點之間的平均位置差異"""
         
@@ -234,165 +253,144 @@ class DynamicTimeWindowSelector:
     
     def __init__(self):
         self.target_visible = (8, 12)  # 目標可見衛星範圍
+        self.sample_minutes = 10       # 取樣間隔，亦為候選起點間隔
         
     async def find_optimal_window(self, date: datetime, constellation: str) -> Dict[str, Any]:
-        """找到指定日期的最佳24小時窗口"""
-        
-        candidates = []
-        
-        # 測試不同起始時間（每6小時測試一次）
-        for hour in range(0, 24, 6):
-            start_time = datetime(
-                date.year, date.month, date.day, hour, 0, 0, 
-                tzinfo=timezone.utc
-            )
-            end_time = start_time + timedelta(hours=24)
-            
-            # 評估這個時間窗口
-            quality = await self._evaluate_window_quality(
-                start_time, 
-                end_time, 
-                constellation
+        """
+        找到指定日期的最佳24小時窗口
+
+        候選起點為當日每個取樣時刻。自當日 00:00 起的整段時間軸每個取樣點只計算一次
+        可見數與換手候選數，再由 SlidingWindowSearch 以前綴和對所有起點評分
+        (分數為每個取樣點品質分的窗口平均)。
+        """
+        day_start = datetime(date.year, date.month, date.day, tzinfo=timezone.utc)
+        step = timedelta(minutes=self.sample_minutes)
+        window = timedelta(hours=24)
+        window_ticks = int(window / step) + 1   # 含結束時間點
+        start_count = int(timedelta(days=1) / step)   # 當日每個取樣時刻各為一個候選起點
+        ticks = start_count + window_ticks - 1
+        
+        visible = np.zeros(ticks, dtype=np.int64)
+        candidates = np.zeros(ticks, dtype=np.int64)
+        for k in range(ticks):
+            timestamp = day_start + k * step
+            visible[k] = await self._simulate_visible_satellites(timestamp, constellation)
+            candidates[k] = await self._simulate_handover_candidates(
+                timestamp, constellation, visible_satellites=int(visible[k])
             )
-            
-            candidates.append({
-                "start": start_time,
-                "end": end_time, 
-                "quality_score": quality['score'],
-                "metrics": quality['metrics']
-            })
         
-        # 選擇最佳窗口
-        best_window = max(candidates, key=lambda x: x["quality_score"])
+        search = SlidingWindowSearch(
+            TickAggregates.from_counts(visible, day_start, step.total_seconds()),
+            target_visible=self.target_visible,
+            series={'candidates': candidates, 'quality': self._tick_quality_scores(visible, candidates)},
+        )
+        best = search.sweep([window_ticks], score_fn=lambda metrics: metrics['mean_quality'])['best']
+        
+        start_time = day_start + best['start_tick'] * step
+        best_window = {
+            "start": start_time,
+            "end": start_time + window,
+            "quality_score": best['score'],
+            "metrics": {
+                'total_samples': window_ticks,
+                'avg_visible': best['mean_visible'],
+                'avg_candidates': best['mean_candidates'],
+                'optimal_count': int(round(best['target_ratio'] * window_ticks)),
+                'candidate_starts': start_count,
+            }
+        }
         
         logger.info(f"最佳時間窗口: {best_window['start']} - {best_window['end']}")
-        logger.info(f"品質分數: {best_window['quality_score']:.2f}")
+        logger.info(f"品質分數: {best_window['quality_score']:.2f} (評估 {start_count} 個起點)")
         
         return best_window
     
-    async def _evaluate_window_quality(self, start_time: datetime, end_time: datetime, constellation: str) -> Dict[str, Any]:
-        """評估時間窗口品質"""
-        
-        # 每10分鐘採樣一次
-        sample_times = []
-        current = start_time
-        while current <= end_time:
-            sample_times.append(current)
-            current += timedelta(minutes=10)
-        
-        # 模擬計算各指標
-        metrics = []
-        for ts in sample_times:
-            # 這裡應該調用真實的衛星可見性計算
-            # 暫時使用模擬數據
-            visible_sats = await self._simulate_visible_satellites(ts, constellation)
-            handover_candidates = await self._simulate_handover_candidates(ts, constellation)
-            
-            metrics.append({
-                "timestamp": ts,
-                "visible": visible_sats,
-                "candidates": handover_candidates
-            })
-        
-        # 綜合評分
-        score = self._calculate_quality_score(metrics)
-        
-        return {
-            'score': score,
-            'metrics': {
-                'total_samples': len(metrics),
-                'avg_visible': sum(m['visible'] for m in metrics) / len(metrics),
-                'avg_candidates': sum(m['candidates'] for m in metrics) / len(metrics),
-                'optimal_count': sum(1 for m in metrics if self.target_visible[0] <= m['visible'] <= self.target_visible[1])
-            }
-        }
-    
     async def _simulate_visible_satellites(self, timestamp: datetime, constellation: str) -> int:
-    """計算特定時間點的可見衛星數量 - 使用真實 SGP4 軌道計算"""
+        """計算特定時間點的可見衛星數量 - 使用真實 SGP4 軌道計算"""
     
-    try:
-        # 獲取最新的 TLE 數據檔案
-        constellation_lower = constellation.lower()
-        tle_data_dir = Path("/netstack/tle_data") / constellation_lower / "tle"
-        
-        if not tle_data_dir.exists():
-            logger.warning(f"TLE 數據目錄不存在: {tle_data_dir}")
-            return self._calculate_deterministic_visibility(timestamp, constellation)
-        
-        # 尋找最新的 TLE 檔案
-        tle_files = list(tle_data_dir.glob("*.tle"))
-        if not tle_files:
-            logger.warning(f"無可用的 TLE 檔案: {tle_data_dir}")
-            return self._calculate_deterministic_visibility(timestamp, constellation)
-        
-        # 按檔案時間排序，選擇最新的
-        latest_tle_file = max(tle_files, key=lambda x: x.stat().st_mtime)
-        logger.debug(f"使用 TLE 檔案: {latest_tle_file}")
-        
-        # 嘗試使用 Skyfield 進行真實軌道計算
-        from skyfield.api import Loader, utc, wgs84
-        from skyfield.sgp4lib import EarthSatellite
+        try:
+            # 獲取最新的 TLE 數據檔案
+            constellation_lower = constellation.lower()
+            tle_data_dir = Path("/netstack/tle_data") / constellation_lower / "tle"
+        
+            if not tle_data_dir.exists():
+                logger.warning(f"TLE 數據目錄不存在: {tle_data_dir}")
+                return self._calculate_deterministic_visibility(timestamp, constellation)
+        
+            # 尋找最新的 TLE 檔案
+            tle_files = list(tle_data_dir.glob("*.tle"))
+            if not tle_files:
+                logger.warning(f"無可用的 TLE 檔案: {tle_data_dir}")
+                return self._calculate_deterministic_visibility(timestamp, constellation)
+        
+            # 按檔案時間排序，選擇最新的
+            latest_tle_file = max(tle_files, key=lambda x: x.stat().st_mtime)
+            logger.debug(f"使用 TLE 檔案: {latest_tle_file}")
+        
+            # 嘗試使用 Skyfield 進行真實軌道計算
+            from skyfield.api import Loader, utc, wgs84
+            from skyfield.sgp4lib import EarthSatellite
         
-        # 使用 /app/data 目錄存儲 Skyfield 數據
-        skyfield_data_dir = Path("/app/data/skyfield-data")
-        skyfield_data_dir.mkdir(parents=True, exist_ok=True)
+            # 使用 /app/data 目錄存儲 Skyfield 數據
+            skyfield_data_dir = Path("/app/data/skyfield-data")
+            skyfield_data_dir.mkdir(parents=True, exist_ok=True)
         
-        loader = Loader(str(skyfield_data_dir))
-        ts = loader.timescale()
+            loader = Loader(str(skyfield_data_dir))
+            ts = loader.timescale()
         
-        # NTPU 觀測點
-        ntpu = wgs84.latlon(NTPU_LAT, NTPU_LON, elevation_m=int(NTPU_ALT * 1000))
+            # NTPU 觀測點
+            ntpu = wgs84.latlon(NTPU_LAT, NTPU_LON, elevation_m=int(NTPU_ALT * 1000))
         
-        # 讀取 TLE 數據
-        visible_count = 0
-        with open(latest_tle_file, 'r') as f:
-            lines = f.readlines()
+            # 讀取 TLE 數據
+            visible_count = 0
+            with open(latest_tle_file, 'r') as f:
+                lines = f.readlines()
         
-        # 解析 TLE (每3行一組，取前20顆進行快速計算)
-        sample_size = min(60, len(lines) // 3)  # 快速採樣
-        for i in range(0, sample_size * 3, 3):
-            if i + 2 >= len(lines):
-                break
+            # 解析 TLE (每3行一組，取前20顆進行快速計算)
+            sample_size = min(60, len(lines) // 3)  # 快速採樣
+            for i in range(0, sample_size * 3, 3):
+                if i + 2 >= len(lines):
+                    break
             
-            name = lines[i].strip()
-            line1 = lines[i + 1].strip()
-            line2 = lines[i + 2].strip()
+                name = lines[i].strip()
+                line1 = lines[i + 1].strip()
+                line2 = lines[i + 2].strip()
             
-            if not (line1.startswith('1 ') and line2.startswith('2 ')):
-                continue
+                if not (line1.startswith('1 ') and line2.startswith('2 ')):
+                    continue
             
-            try:
-                # 創建衛星對象
-                satellite = EarthSatellite(line1, line2, name, ts)
+                try:
+                    # 創建衛星對象
+                    satellite = EarthSatellite(line1, line2, name, ts)
                 
-                # 計算位置
-                t = ts.from_datetime(timestamp.replace(tzinfo=utc))
-                difference = satellite - ntpu
-                topocentric = difference.at(t)
-                alt, az, distance = topocentric.altaz()
+                    # 計算位置
+                    t = ts.from_datetime(timestamp.replace(tzinfo=utc))
+                    difference = satellite - ntpu
+                    topocentric = difference.at(t)
+                    alt, az, distance = topocentric.altaz()
                 
-                # 檢查可見性 (仰角 >= 10 度)
-                if alt.degrees >= 10.0:
-                    visible_count += 1
+                    # 檢查可見性 (仰角 >= 10 度)
+                    if alt.degrees >= 10.0:
+                        visible_count += 1
                     
-            except Exception as e:
-                logger.debug(f"計算衛星 {name} 可見性失敗: {e}")
-                continue
-        
-        # 根據採樣比例估算總數
-        if sample_size > 0:
-            total_satellites = len(lines) // 3
-            estimated_total = int(visible_count * total_satellites / sample_size)
-            return min(estimated_total, 15)  # 限制最大值
-        
-        return visible_count
-        
-    except ImportError:
-        logger.warning("無法載入 Skyfield，使用確定性計算")
-        return self._calculate_deterministic_visibility(timestamp, constellation)
-    except Exception as e:
-        logger.warning(f"真實可見性計算失敗: {e}，使用確定性計算")
-        return self._calculate_deterministic_visibility(timestamp, constellation)
+                except Exception as e:
+                    logger.debug(f"計算衛星 {name} 可見性失敗: {e}")
+                    continue
+        
+            # 根據採樣比例估算總數
+            if sample_size > 0:
+                total_satellites = len(lines) // 3
+                estimated_total = int(visible_count * total_satellites / sample_size)
+                return min(estimated_total, 15)  # 限制最大值
+        
+            return visible_count
+        
+        except ImportError:
+            logger.warning("無法載入 Skyfield，使用確定性計算")
+            return self._calculate_deterministic_visibility(timestamp, constellation)
+        except Exception as e:
+            logger.warning(f"真實可見性計算失敗: {e}，使用確定性計算")
+            return self._calculate_deterministic_visibility(timestamp, constellation)
     
     def _calculate_deterministic_visibility(self, timestamp: datetime, constellation: str) -> int:
         """確定性可見衛星計算 - 基於軌道力學原理
@@ -480,13 +478,16 @@ class DynamicTimeWindowSelector:
         
         return total_visible
     
-    async def _simulate_handover_candidates(self, timestamp: datetime, constellation: str) -> int:
+    async def _simulate_handover_candidates(self, timestamp: datetime, constellation: str,
+                                            visible_satellites: Optional[int] = None) -> int:
         """真實換手候選計算 - 基於 3GPP NTN 標準
         
         禁止使用隨機數！必須基於物理原理和信號條件
+        visible_satellites: 呼叫端已算出的同時刻可見數 (避免重複軌道計算)
         """
         # 首先獲取可見衛星數量
-        visible_satellites = await self._simulate_visible_satellites(timestamp, constellation)
+        if visible_satellites is None:
+            visible_satellites = await self._simulate_visible_satellites(timestamp, constellation)
         
         if visible_satellites <= 0:
             return 0
@@ -569,40 +570,47 @@ class DynamicTimeWindowSelector:
         
         return final_candidates
     
-    def _calculate_quality_score(self, metrics: List[Dict]) -> float:
-        """計算綜合品質分數"""
-        
-        score = 0.0
-        
-        for m in metrics:
-            # 理想可見數範圍內加分
-            if self.target_visible[0] <= m['visible'] <= self.target_visible[1]:
-                score += 10
-            
-            # 充足候選加分  
-            if m['candidates'] >= 3:
-                score += 5
-            
-            # 過少衛星扣分
-            if m['visible'] < 6:
-                score -= 20
-            
-            # 過多衛星輕微扣分
-            if m['visible'] > 15:
-                score -= 5
-        
-        return score / len(metrics) if metrics else 0.0
+    def _tick_quality_scores(self, visible: np.ndarray, candidates: np.ndarray) -> np.ndarray:
+        """每個取樣點的品質分 (窗口分數為其平均)"""
+        lo, hi = self.target_visible
+        return (np.where((visible >= lo) & (visible <= hi), 10.0, 0.0)   # 理想可見數範圍內加分
+                + np.where(candidates >= 3, 5.0, 0.0)                   # 充足候選加分
+                - np.where(visible < 6, 20.0, 0.0)                      # 過少衛星扣分
+                - np.where(visible > 15, 5.0, 0.0))                     # 過多衛星輕微扣分
 
 class BatchTrajectoryCalculator:
     """批量計算衛星軌跡"""
     
-    def __init__(self):
+    def __init__(self, backend: str = "vectorized"):
+        """
+        Args:
+            backend: "vectorized" 整批交給向量化核心 (N × T 陣列運算)；
+                     "threaded" 逐衛星純 Python 計算
+        """
         self.cache = {}
         self.max_workers = 8
+        self.backend = backend
+        self.kernel = VectorizedTrajectoryKernel(NTPU_LAT, NTPU_LON, NTPU_ALT)
+    
+    async def calculate_batch_arrays(self, satellites: List[Dict], time_window: Dict,
+                                     interval_seconds: int = 30) -> TrajectoryBatch:
+        """批量計算所有衛星的時間序列，回傳逐衛星 (N × T) 陣列"""
+        
+        timestamps = self._generate_timestamps(time_window, interval_seconds)
+        logger.info(f"開始向量化批量計算 {len(satellites)} 顆衛星 × {len(timestamps)} 個時間點的軌跡")
+        
+        batch = await asyncio.to_thread(self.kernel.compute, satellites, timestamps)
+        
+        logger.info(f"批量計算完成，成功計算 {int(batch.valid.sum())} 顆衛星")
+        return batch
     
     async def calculate_batch(self, satellites: List[Dict], time_window: Dict, interval_seconds: int = 30) -> Dict[str, List[Dict]]:
         """批量計算所有衛星的時間序列"""
         
+        if self.backend == "vectorized":
+            batch = await self.calculate_batch_arrays(satellites, time_window, interval_seconds)
+            return batch.to_point_lists()
+        
         logger.info(f"開始批量計算 {len(satellites)} 顆衛星的軌跡")
         
         results = {}
@@ -952,15 +960,27 @@ class TimeSeriesEngine:
             "end": optimal_window["end"]
         }
         
-        trajectories = await self.trajectory_calculator.calculate_batch(
-            satellites, time_window, interval_seconds=30
-        )
-        
-        # 4. 組裝時間序列幀
-        frames = self._assemble_timeseries_frames(trajectories, time_window)
-        
-        # 5. 生成無縫循環
-        seamless_data = self.loop_generator.create_seamless_loop(frames, orbit_info["window_hours"])
+        if self.trajectory_calculator.backend == "vectorized":
+            batch = await self.trajectory_calculator.calculate_batch_arrays(
+                satellites, time_window, interval_seconds=30
+            )
+            trajectory_count = int(batch.valid[list(batch.unique_rows().values())].sum())
+            
+            # 4-5. 以 (幀 × 衛星 × 欄位) 陣列直接生成無縫循環
+            seamless_data = self.loop_generator.create_seamless_loop_from_array(
+                FrameArray.from_batch(batch), orbit_info
+            )
+        else:
+            trajectories = await self.trajectory_calculator.calculate_batch(
+                satellites, time_window, interval_seconds=30
+            )
+            trajectory_count = len([t for t in trajectories.values() if t])
+            
+            # 4. 組裝時間序列幀
+            frames = self._assemble_timeseries_frames(trajectories, time_window)
+            
+            # 5. 生成無縫循環
+            seamless_data = self.loop_generator.create_seamless_loop(frames, orbit_info["window_hours"])
         
         # 6. 添加元數據
         seamless_data["metadata"].update({
@@ -968,7 +988,7 @@ class TimeSeriesEngine:
             "orbit_info": orbit_info,
             "optimal_window": optimal_window,
             "satellite_count": len(satellites),
-            "trajectory_count": len([t for t in trajectories.values() if t])
+            "trajectory_count": trajectory_count
         })
         
         logger.info(f"時間序列創建完成: {len(seamless_data['frames'])} 幀")
@@ -0,0 +1,639 @@
+#!/usr/bin/env python3
+"""
+觀測點可見性時間軸快取 - 以 (觀測網格, 日期) 為鍵
+
+將「從這裡在這段時間看得到哪些衛星」的問題改為區間查表：
+- 觀測點以 cell_deg (預設 0.5°) 網格量化，每個網格中心 × 每個 UTC 日
+  預先計算每顆衛星的 AOS/LOS 區間清單 (CSR 壓縮陣列)
+- 建表門檻 = 最小仰角 - 網格邊界誤差 (半對角線造成的最大仰角差)，
+  因此網格內任一觀測點的可見衛星必為候選集合的子集
+- 查詢先以區間查表取得候選，再對候選做一次真實觀測點的幾何精算
+- 時間軸記錄每顆衛星的 TLE 內容雜湊 (含 epoch)，鍵與磁碟檔名帶 TLE 集合指紋；
+  查詢時 TLE 已更新或不在時間軸內的衛星一律列為候選 (由精算決定)，
+  重新建表時只傳播這些衛星並與既有區間合併
+
+建表以行程池依衛星分塊平行執行 (SGP4 SatrecArray 向量化傳播)，
+每塊同時產出所有請求網格的區間，可在背景排程。
+幾何慣例與 CoordinateSpecificOrbitEngine.eci_to_observer_coordinates 相同。
+"""
+
+import asyncio
+import hashlib
+import logging
+import math
+import os
+import time
+from collections import OrderedDict
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, field
+from datetime import date, datetime, timedelta, timezone
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional, Sequence, Set, Tuple
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+EARTH_RADIUS_KM = 6371.0
+SECONDS_PER_DAY = 86400
+
+CellDayKey = Tuple[int, int, str]  # (緯度網格, 經度網格, ISO 日期)
+CellKey = Tuple[int, int, str, str]  # (緯度網格, 經度網格, ISO 日期, TLE 集合指紋)
+
+
+def timeline_satellite_id(tle: Dict[str, Any]) -> str:
+    """時間軸中的衛星識別 (優先 NORAD ID，與 TLE 資料字典一致)"""
+    norad_id = tle.get('norad_id')
+    return str(norad_id) if norad_id not in (None, '', 0) else str(tle.get('name', ''))
+
+
+def tle_digest(tle: Dict[str, Any]) -> str:
+    """TLE 內容雜湊 (兩行根數含 epoch，任何更新都會改變雜湊)"""
+    content = f"{tle['line1'].strip()}\n{tle['line2'].strip()}"
+    return hashlib.sha1(content.encode()).hexdigest()[:16]
+
+
+def tle_set_fingerprint(satellite_ids: Sequence[str], digests: Sequence[str]) -> str:
+    """TLE 集合指紋 (與順序無關)"""
+    h = hashlib.sha1()
+    for sat_id, digest in sorted(zip(satellite_ids, digests)):
+        h.update(f"{sat_id}:{digest};".encode())
+    return h.hexdigest()[:12]
+
+
+def observer_cell(lat: float, lon: float, cell_deg: float = 0.5) -> Tuple[int, int]:
+    """觀測點所在網格索引 (經度折回 [-180, 180))"""
+    lon = (lon + 180.0) % 360.0 - 180.0
+    return int(math.floor(lat / cell_deg)), int(math.floor(lon / cell_deg))
+
+
+def cell_center(cell: Tuple[int, int], cell_deg: float = 0.5) -> Tuple[float, float]:
+    return (cell[0] + 0.5) * cell_deg, (cell[1] + 0.5) * cell_deg
+
+
+def elevation_margin_deg(cell_deg: float, lat: float, min_altitude_km: float = 500.0) -> float:
+    """
+    網格中心與網格內任一點之間的最大仰角差上界
+
+    觀測點水平位移 d 對衛星視線方向的改變不超過 d / 斜距 (斜距 ≥ 軌道高度)，
+    另加地表法向量旋轉 d / R。
+    """
+    half_lat_km = cell_deg / 2 * 111.32
+    half_lon_km = cell_deg / 2 * 111.32 * math.cos(math.radians(min(abs(lat) + cell_deg / 2, 90.0)))
+    half_diagonal_km = math.hypot(half_lat_km, half_lon_km)
+    return math.degrees(half_diagonal_km / min_altitude_km + half_diagonal_km / EARTH_RADIUS_KM)
+
+
+def observer_look_angles(positions: np.ndarray, lat: float, lon: float,
+                         alt_m: float = 0.0) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    向量化計算仰角 / 方位角 / 距離
+
+    Args:
+        positions: (..., 3) 位置 (km)
+        lat, lon: 觀測點 (度)
+        alt_m: 觀測點海拔 (米)
+
+    Returns:
+        (elevation_deg, azimuth_deg, range_km)
+    """
+    lat_rad, lon_rad = math.radians(lat), math.radians(lon)
+    sin_lat, cos_lat = math.sin(lat_rad), math.cos(lat_rad)
+    sin_lon, cos_lon = math.sin(lon_rad), math.cos(lon_rad)
+    radius = EARTH_RADIUS_KM + alt_m / 1000.0
+
+    dx = positions[..., 0] - radius * cos_lat * cos_lon
+    dy = positions[..., 1] - radius * cos_lat * sin_lon
+    dz = positions[..., 2] - radius * sin_lat
+
+    east = -sin_lon * dx + cos_lon * dy
+    north = -sin_lat * cos_lon * dx - sin_lat * sin_lon * dy + cos_lat * dz
+    up = cos_lat * cos_lon * dx + cos_lat * sin_lon * dy + sin_lat * dz
+
+    elevation = np.degrees(np.arctan2(up, np.hypot(east, north)))
+    azimuth = np.degrees(np.arctan2(east, north)) % 360.0
+    distance = np.sqrt(dx * dx + dy * dy + dz * dz)
+    return elevation, azimuth, distance
+
+
+def _day_start(day: date) -> datetime:
+    return datetime(day.year, day.month, day.day, tzinfo=timezone.utc)
+
+
+def _as_utc(moment: datetime) -> datetime:
+    return moment.replace(tzinfo=timezone.utc) if moment.tzinfo is None else moment.astimezone(timezone.utc)
+
+
+def _propagate(tles: Sequence[Tuple[str, str, str]], day: date, seconds: np.ndarray) -> np.ndarray:
+    """SGP4 向量化傳播，回傳 (N, T, 3)；傳播錯誤的樣本填 NaN"""
+    from sgp4.api import Satrec, SatrecArray, jday
+
+    satellites = [Satrec.twoline2rv(line1, line2) for _, line1, line2 in tles]
+    jd0, fr0 = jday(day.year, day.month, day.day, 0, 0, 0)
+    jd = np.full(seconds.shape, jd0)
+    fr = fr0 + seconds / SECONDS_PER_DAY
+    errors, positions, _ = SatrecArray(satellites).sgp4(jd, fr)
+    positions = np.asarray(positions, dtype=float)
+    positions[np.asarray(errors) != 0] = np.nan
+    return positions
+
+
+def _extract_intervals(elevation: np.ndarray, threshold: float, step_seconds: int):
+    """布林可見矩陣 → (衛星索引, AOS 秒, LOS 秒, 峰值仰角)"""
+    visible = elevation >= threshold
+    n, t = visible.shape
+    padded = np.zeros((n, t + 2), dtype=np.int8)
+    padded[:, 1:-1] = visible
+    edges = np.diff(padded, axis=1)
+    start_rows, start_cols = np.nonzero(edges == 1)
+    _, end_cols = np.nonzero(edges == -1)  # 逐列掃描，與起點一一對應
+
+    if start_rows.size:
+        # 區間峰值：在展平陣列上以 reduceat 取每段最大值
+        flat = np.where(visible, elevation, -90.0).ravel()
+        starts_flat = start_rows * t + start_cols
+        bounds = np.empty(start_rows.size * 2, dtype=np.int64)
+        bounds[0::2] = starts_flat
+        bounds[1::2] = start_rows * t + end_cols
+        peaks = np.maximum.reduceat(np.append(flat, -90.0), bounds)[0::2]
+    else:
+        peaks = np.zeros(0)
+
+    return (start_rows.astype(np.int32),
+            (start_cols * step_seconds).astype(np.int32),
+            ((end_cols - 1) * step_seconds).astype(np.int32),
+            peaks.astype(np.float32))
+
+
+def _build_chunk(tles: Sequence[Tuple[str, str, str]], day_iso: str,
+                 centers: Sequence[Tuple[float, float]], thresholds: Sequence[float],
+                 step_seconds: int) -> List[Tuple[np.ndarray, np.ndarray, np.ndarray, np.ndarray]]:
+    """行程池工作單元：一塊衛星 × 全部網格"""
+    day = date.fromisoformat(day_iso)
+    seconds = np.arange(0, SECONDS_PER_DAY, step_seconds, dtype=float)
+    positions = _propagate(tles, day, seconds)
+    results = []
+    for (lat, lon), threshold in zip(centers, thresholds):
+        elevation, _, _ = observer_look_angles(positions, lat, lon)
+        results.append(_extract_intervals(np.nan_to_num(elevation, nan=-90.0), threshold, step_seconds))
+    return results
+
+
+@dataclass
+class CellDayTimeline:
+    """單一網格 × 單日的可見性時間軸 (CSR：offsets[i]:offsets[i+1] 為第 i 顆衛星的區間)"""
+    cell: Tuple[int, int]
+    day: date
+    cell_deg: float
+    step_seconds: int
+    min_elevation_deg: float
+    margin_deg: float
+    satellite_ids: List[str]
+    tle_digests: List[str]
+    offsets: np.ndarray
+    aos: np.ndarray
+    los: np.ndarray
+    peak_elevation: np.ndarray
+    built_at: float = field(default_factory=time.time)
+
+    def __post_init__(self):
+        self._owner = np.repeat(np.arange(len(self.satellite_ids)), np.diff(self.offsets))
+        self._index = {sid: i for i, sid in enumerate(self.satellite_ids)}
+        self._digests = dict(zip(self.satellite_ids, self.tle_digests))
+        self.tle_fingerprint = tle_set_fingerprint(self.satellite_ids, self.tle_digests)
+
+    @property
+    def cell_day(self) -> CellDayKey:
+        return self.cell[0], self.cell[1], self.day.isoformat()
+
+    @property
+    def key(self) -> CellKey:
+        return (*self.cell_day, self.tle_fingerprint)
+
+    def uncovered(self, tle_data: Sequence[Dict[str, Any]]) -> Set[str]:
+        """TLE 資料中不在時間軸內或 TLE 已更新 (雜湊不同) 的衛星 ID"""
+        return {
+            sat_id for sat_id, digest in
+            ((timeline_satellite_id(t), tle_digest(t)) for t in tle_data)
+            if self._digests.get(sat_id) != digest
+        }
+
+    def retained_parts(self, drop_ids: Set[str]):
+        """排除 drop_ids 後的 (衛星ID, 雜湊, 每顆區間數, aos, los, 峰值)，供合併建表使用"""
+        keep = np.array([sid not in drop_ids for sid in self.satellite_ids], dtype=bool)
+        interval_mask = keep[self._owner]
+        kept = np.flatnonzero(keep)
+        return ([self.satellite_ids[i] for i in kept],
+                [self.tle_digests[i] for i in kept],
+                np.diff(self.offsets)[kept],
+                self.aos[interval_mask], self.los[interval_mask],
+                self.peak_elevation[interval_mask])
+
+    @property
+    def interval_count(self) -> int:
+        return int(self.aos.size)
+
+    @property
+    def nbytes(self) -> int:
+        return int(self.offsets.nbytes + self.aos.nbytes + self.los.nbytes + self.peak_elevation.nbytes)
+
+    def candidate_indices(self, start_seconds: float, end_seconds: float) -> np.ndarray:
+        """與 [start, end] (日內秒數) 重疊的衛星索引；區間兩端各放寬一個取樣步長"""
+        hit = (self.aos - self.step_seconds <= end_seconds) & (self.los + self.step_seconds >= start_seconds)
+        return np.unique(self._owner[hit])
+
+    def candidates(self, start_seconds: float, end_seconds: Optional[float] = None) -> List[str]:
+        end_seconds = start_seconds if end_seconds is None else end_seconds
+        return [self.satellite_ids[i] for i in self.candidate_indices(start_seconds, end_seconds)]
+
+    def intervals_for(self, satellite_id: str) -> List[Dict[str, Any]]:
+        i = self._index.get(satellite_id)
+        if i is None:
+            return []
+        start = _day_start(self.day)
+        return [
+            {
+                'aos': (start + timedelta(seconds=int(self.aos[k]))).isoformat(),
+                'los': (start + timedelta(seconds=int(self.los[k]))).isoformat(),
+                'peak_elevation_deg': float(self.peak_elevation[k]),
+            }
+            for k in range(self.offsets[i], self.offsets[i + 1])
+        ]
+
+    def save(self, path: Path) -> None:
+        np.savez_compressed(
+            path,
+            satellite_ids=np.array(self.satellite_ids),
+            tle_digests=np.array(self.tle_digests),
+            offsets=self.offsets, aos=self.aos, los=self.los, peak_elevation=self.peak_elevation,
+            meta=np.array([self.cell[0], self.cell[1], self.cell_deg, self.step_seconds,
+                           self.min_elevation_deg, self.margin_deg, self.built_at]),
+            day=np.array(self.day.isoformat()),
+        )
+
+    @classmethod
+    def load(cls, path: Path) -> "CellDayTimeline":
+        with np.load(path, allow_pickle=False) as data:
+            meta = data['meta']
+            return cls(
+                cell=(int(meta[0]), int(meta[1])),
+                day=date.fromisoformat(str(data['day'])),
+                cell_deg=float(meta[2]),
+                step_seconds=int(meta[3]),
+                min_elevation_deg=float(meta[4]),
+                margin_deg=float(meta[5]),
+                satellite_ids=[str(s) for s in data['satellite_ids']],
+                tle_digests=[str(s) for s in data['tle_digests']],
+                offsets=data['offsets'], aos=data['aos'], los=data['los'],
+                peak_elevation=data['peak_elevation'],
+                built_at=float(meta[6]),
+            )
+
+
+class VisibilityTimelineCache:
+    """(觀測網格, 日期) 可見性時間軸快取"""
+
+    def __init__(self, cell_deg: float = 0.5, step_seconds: int = 30,
+                 min_elevation_deg: float = 5.0, min_altitude_km: float = 500.0,
+                 max_entries: int = 256, cache_dir: Optional[Path] = None,
+                 max_workers: Optional[int] = None, chunk_size: int = 500):
+        """
+        Args:
+            cell_deg: 觀測網格邊長 (度)
+            step_seconds: 時間軸取樣步長
+            min_elevation_deg: 建表仰角門檻；只能回答門檻 ≥ 此值的查詢
+            min_altitude_km: 網格誤差估算採用的最低軌道高度
+            max_entries: 記憶體中保留的網格日數 (LRU)
+            cache_dir: 選用的磁碟快取目錄 (.npz)
+            max_workers: 建表行程數 (None = CPU 核心數；1 = 在目前行程執行)
+            chunk_size: 每個工作單元的衛星數
+        """
+        self.cell_deg = cell_deg
+        self.step_seconds = step_seconds
+        self.min_elevation_deg = min_elevation_deg
+        self.min_altitude_km = min_altitude_km
+        self.max_entries = max_entries
+        self.cache_dir = Path(cache_dir) if cache_dir else None
+        self.max_workers = max_workers
+        self.chunk_size = chunk_size
+
+        self._timelines: "OrderedDict[CellKey, CellDayTimeline]" = OrderedDict()
+        self._latest: Dict[CellDayKey, CellKey] = {}  # 每個網格日最新建立的時間軸
+        self._building: Dict[CellDayKey, asyncio.Task] = {}
+        self._stats = {'hits': 0, 'misses': 0, 'disk_loads': 0, 'builds': 0,
+                       'build_seconds': 0.0, 'propagated_satellites': 0,
+                       'uncovered_satellites': 0, 'refinements': 0}
+
+        if self.cache_dir:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+
+    # ------------------------------------------------------------------
+    # 鍵與存取
+    # ------------------------------------------------------------------
+
+    def key_for(self, lat: float, lon: float, day: date) -> CellDayKey:
+        cell = observer_cell(lat, lon, self.cell_deg)
+        return cell[0], cell[1], day.isoformat()
+
+    def _disk_path(self, key: CellKey) -> Optional[Path]:
+        if not self.cache_dir:
+            return None
+        return self.cache_dir / (f"vis_{key[0]}_{key[1]}_{key[2]}_{key[3]}"
+                                 f"_{self.cell_deg:g}_{self.step_seconds}.npz")
+
+    def _latest_disk_path(self, cell_day: CellDayKey) -> Optional[Path]:
+        """網格日最新寫入的磁碟時間軸 (各 TLE 集合指紋中取最新者)"""
+        if not self.cache_dir:
+            return None
+        pattern = f"vis_{cell_day[0]}_{cell_day[1]}_{cell_day[2]}_*_{self.cell_deg:g}_{self.step_seconds}.npz"
+        paths = list(self.cache_dir.glob(pattern))
+        return max(paths, key=lambda p: p.stat().st_mtime) if paths else None
+
+    def get(self, lat: float, lon: float, day: date) -> Optional[CellDayTimeline]:
+        """
+        網格日最新的時間軸
+
+        回傳的時間軸可能早於呼叫端的 TLE 資料，以 CellDayTimeline.uncovered 檢查涵蓋範圍。
+        """
+        cell_day = self.key_for(lat, lon, day)
+        key = self._latest.get(cell_day)
+        timeline = self._timelines.get(key) if key is not None else None
+        if timeline is not None:
+            self._timelines.move_to_end(key)
+            self._stats['hits'] += 1
+            return timeline
+
+        path = self._latest_disk_path(cell_day)
+        if path is not None:
+            try:
+                timeline = CellDayTimeline.load(path)
+                if timeline.min_elevation_deg <= self.min_elevation_deg:
+                    self._stats['disk_loads'] += 1
+                    self._store(timeline, persist=False)
+                    return timeline
+            except Exception as e:
+                logger.warning(f"可見性時間軸載入失敗 {path}: {e}")
+
+        self._stats['misses'] += 1
+        return None
+
+    def _store(self, timeline: CellDayTimeline, persist: bool = True) -> None:
+        previous = self._latest.get(timeline.cell_day)
+        if previous is not None and previous != timeline.key:
+            # 舊 TLE 集合的時間軸已由合併後的新時間軸取代
+            self._timelines.pop(previous, None)
+        self._latest[timeline.cell_day] = timeline.key
+        self._timelines[timeline.key] = timeline
+        self._timelines.move_to_end(timeline.key)
+        while len(self._timelines) > self.max_entries:
+            evicted, _ = self._timelines.popitem(last=False)
+            if self._latest.get(evicted[:3]) == evicted:
+                del self._latest[evicted[:3]]
+        path = self._disk_path(timeline.key)
+        if persist and path is not None:
+            try:
+                timeline.save(path)
+                if previous is not None and previous != timeline.key:
+                    self._disk_path(previous).unlink(missing_ok=True)
+            except Exception as e:
+                logger.warning(f"可見性時間軸寫入失敗 {path}: {e}")
+
+    # ------------------------------------------------------------------
+    # 建表 (行程池平行)
+    # ------------------------------------------------------------------
+
+    def build(self, tle_data: Sequence[Dict[str, Any]], observers: Iterable[Tuple[float, float]],
+              day: date) -> List[CellDayTimeline]:
+        """
+        為多個觀測點所在網格建立指定日期的時間軸
+
+        網格日已有相同門檻的時間軸時只傳播未涵蓋 (新增或 TLE 已更新) 的衛星，
+        再與既有區間合併；全部涵蓋時直接回傳既有時間軸。
+
+        Args:
+            tle_data: TLE 字典清單 (name / norad_id / line1 / line2)
+            observers: 觀測點 (lat, lon)，同網格者只建一次
+            day: UTC 日期
+        """
+        cells = sorted({observer_cell(lat, lon, self.cell_deg) for lat, lon in observers})
+        if not cells or not tle_data:
+            return []
+
+        started = time.perf_counter()
+        existing: List[Optional[CellDayTimeline]] = []
+        for cell in cells:
+            timeline = self.get(*cell_center(cell, self.cell_deg), day)
+            reusable = (timeline is not None
+                        and timeline.min_elevation_deg == self.min_elevation_deg
+                        and timeline.step_seconds == self.step_seconds)
+            existing.append(timeline if reusable else None)
+
+        stale: Set[str] = set()
+        for timeline in existing:
+            stale |= ({timeline_satellite_id(t) for t in tle_data} if timeline is None
+                      else timeline.uncovered(tle_data))
+        if not stale:
+            return existing
+
+        fresh = [t for t in tle_data if timeline_satellite_id(t) in stale]
+        tles = [(timeline_satellite_id(t), t['line1'], t['line2']) for t in fresh]
+        digests = [tle_digest(t) for t in fresh]
+        centers = [cell_center(c, self.cell_deg) for c in cells]
+        margins = [elevation_margin_deg(self.cell_deg, lat, self.min_altitude_km) for lat, _ in centers]
+        thresholds = [self.min_elevation_deg - m for m in margins]
+
+        chunks = [tles[i:i + self.chunk_size] for i in range(0, len(tles), self.chunk_size)]
+        args = (day.isoformat(), centers, thresholds, self.step_seconds)
+        workers = self.max_workers or min(len(chunks), os.cpu_count() or 1)
+        if workers <= 1:
+            chunk_results = [_build_chunk(chunk, *args) for chunk in chunks]
+        else:
+            with ProcessPoolExecutor(max_workers=workers) as executor:
+                chunk_results = list(executor.map(
+                    _build_chunk, chunks, *[[a] * len(chunks) for a in args]))
+
+        timelines = []
+        for c, (cell, margin, previous) in enumerate(zip(cells, margins, existing)):
+            rows, aos, los, peaks = [], [], [], []
+            base = 0
+            for chunk, results in zip(chunks, chunk_results):
+                r, a, l, p = results[c]
+                rows.append(r + base)
+                aos.append(a)
+                los.append(l)
+                peaks.append(p)
+                base += len(chunk)
+            counts = np.bincount(np.concatenate(rows), minlength=len(tles))
+
+            # 既有時間軸中未被重新傳播的衛星原樣保留 (含不在本次 TLE 資料中的衛星)
+            if previous is not None:
+                kept_ids, kept_digests, kept_counts, kept_aos, kept_los, kept_peaks = \
+                    previous.retained_parts({t[0] for t in tles})
+                satellite_ids = kept_ids + [t[0] for t in tles]
+                tle_digests = kept_digests + digests
+                counts = np.concatenate([kept_counts, counts])
+                aos.insert(0, kept_aos)
+                los.insert(0, kept_los)
+                peaks.insert(0, kept_peaks)
+            else:
+                satellite_ids, tle_digests = [t[0] for t in tles], list(digests)
+
+            timeline = CellDayTimeline(
+                cell=cell,
+                day=day,
+                cell_deg=self.cell_deg,
+                step_seconds=self.step_seconds,
+                min_elevation_deg=self.min_elevation_deg,
+                margin_deg=margin,
+                satellite_ids=satellite_ids,
+                tle_digests=tle_digests,
+                offsets=np.concatenate(([0], np.cumsum(counts))).astype(np.int32),
+                aos=np.concatenate(aos),
+                los=np.concatenate(los),
+                peak_elevation=np.concatenate(peaks),
+            )
+            self._store(timeline)
+            timelines.append(timeline)
+
+        elapsed = time.perf_counter() - started
+        self._stats['builds'] += len(timelines)
+        self._stats['build_seconds'] += elapsed
+        self._stats['propagated_satellites'] += len(tles)
+        logger.info(f"可見性時間軸建立完成: {len(cells)} 網格 × {len(tles)} 顆衛星 "
+                    f"(共 {len(tle_data)} 顆, {day.isoformat()}, {workers} 行程, {elapsed:.1f}s)")
+        return timelines
+
+    def schedule_build(self, tle_data: Sequence[Dict[str, Any]],
+                       observers: Iterable[Tuple[float, float]], day: date) -> Optional[asyncio.Task]:
+        """
+        在背景執行緒排程建表；同一網格日已在建置中、
+        或既有時間軸已涵蓋全部 TLE 資料時不重複排程
+        """
+        observers = list(observers)
+        pending = []
+        for lat, lon in observers:
+            key = self.key_for(lat, lon, day)
+            if key in self._building or key in pending:
+                continue
+            latest = self._timelines.get(self._latest.get(key))
+            if latest is None or latest.uncovered(tle_data):
+                pending.append(key)
+        if not pending:
+            return None
+
+        loop = asyncio.get_running_loop()
+        task = loop.create_task(asyncio.to_thread(self.build, tle_data, observers, day))
+        for key in pending:
+            self._building[key] = task
+
+        def _done(t: asyncio.Task):
+            for key in pending:
+                self._building.pop(key, None)
+            if not t.cancelled() and t.exception() is not None:
+                logger.error(f"背景可見性時間軸建立失敗: {t.exception()}")
+
+        task.add_done_callback(_done)
+        return task
+
+    # ------------------------------------------------------------------
+    # 查詢
+    # ------------------------------------------------------------------
+
+    def candidate_ids(self, lat: float, lon: float, tle_data: Sequence[Dict[str, Any]],
+                      start: datetime, end: Optional[datetime] = None,
+                      min_elevation_deg: Optional[float] = None) -> Optional[Set[str]]:
+        """
+        [start, end] 內可能達到門檻的衛星 ID 集合
+
+        Args:
+            tle_data: 呼叫端目前的 TLE 資料；不在時間軸內或 TLE 已更新的衛星
+                無法由時間軸排除，一律列入候選
+
+        Returns:
+            候選集合；時間軸未涵蓋整段期間或門檻低於建表門檻時回傳 None，
+            呼叫端應退回完整計算
+        """
+        if min_elevation_deg is not None and min_elevation_deg < self.min_elevation_deg:
+            return None
+        start = _as_utc(start)
+        end = _as_utc(end) if end is not None else start
+
+        candidates: Set[str] = set()
+        uncovered: Set[str] = set()
+        day = start.date()
+        while day <= end.date():
+            timeline = self.get(lat, lon, day)
+            if timeline is None:
+                return None
+            day_start = _day_start(day)
+            lo = max((start - day_start).total_seconds(), 0.0)
+            hi = min((end - day_start).total_seconds(), float(SECONDS_PER_DAY))
+            candidates.update(timeline.candidates(lo, hi))
+            uncovered |= timeline.uncovered(tle_data)
+            day += timedelta(days=1)
+        self._stats['uncovered_satellites'] += len(uncovered)
+        return candidates | uncovered
+
+    def query_visible(self, lat: float, lon: float, when: datetime,
+                      tle_data: Sequence[Dict[str, Any]],
+                      min_elevation_deg: Optional[float] = None,
+                      alt_m: float = 0.0) -> Optional[List[Dict[str, Any]]]:
+        """
+        區間查表 + 候選幾何精算：回傳真實觀測點在 when 時刻的可見衛星
+
+        Returns:
+            依仰角降序的 [{satellite_id, elevation_deg, azimuth_deg, range_km}]；
+            快取未命中時回傳 None
+        """
+        threshold = self.min_elevation_deg if min_elevation_deg is None else min_elevation_deg
+        candidates = self.candidate_ids(lat, lon, tle_data, when, min_elevation_deg=threshold)
+        if candidates is None:
+            return None
+
+        selected = [t for t in tle_data if timeline_satellite_id(t) in candidates]
+        if not selected:
+            return []
+
+        when = _as_utc(when)
+        tles = [(timeline_satellite_id(t), t['line1'], t['line2']) for t in selected]
+        seconds = np.array([(when - _day_start(when.date())).total_seconds()])
+        positions = _propagate(tles, when.date(), seconds)[:, 0, :]
+        elevation, azimuth, distance = observer_look_angles(positions, lat, lon, alt_m)
+        self._stats['refinements'] += len(tles)
+
+        visible = [
+            {
+                'satellite_id': tles[i][0],
+                'elevation_deg': float(elevation[i]),
+                'azimuth_deg': float(azimuth[i]),
+                'range_km': float(distance[i]),
+            }
+            for i in np.flatnonzero(np.nan_to_num(elevation, nan=-90.0) >= threshold)
+        ]
+        visible.sort(key=lambda s: s['elevation_deg'], reverse=True)
+        return visible
+
+    def stats(self) -> Dict[str, Any]:
+        lookups = self._stats['hits'] + self._stats['misses'] + self._stats['disk_loads']
+        return {
+            **self._stats,
+            'entries': len(self._timelines),
+            'building': len(self._building),
+            'memory_bytes': sum(t.nbytes for t in self._timelines.values()),
+            'hit_rate': (self._stats['hits'] + self._stats['disk_loads']) / lookups if lookups else 0.0,
+            'cell_deg': self.cell_deg,
+            'step_seconds': self.step_seconds,
+            'min_elevation_deg': self.min_elevation_deg,
+        }
+
+
+_visibility_timeline_cache: Optional[VisibilityTimelineCache] = None
+
+
+def get_visibility_timeline_cache() -> VisibilityTimelineCache:
+    """全域可見性時間軸快取 (VISIBILITY_TIMELINE_CACHE_DIR 設定時啟用磁碟快取)"""
+    global _visibility_timeline_cache
+    if _visibility_timeline_cache is None:
+        cache_dir = os.getenv('VISIBILITY_TIMELINE_CACHE_DIR')
+        _visibility_timeline_cache = VisibilityTimelineCache(cache_dir=Path(cache_dir) if cache_dir else None)
+    return _visibility_timeline_cache
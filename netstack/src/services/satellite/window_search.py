@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+"""
+滑動時間窗搜尋引擎
+
+最佳時間窗搜尋原本對每個候選起點重新統計可見衛星與品質，成本為
+O(候選窗口數 × 窗口長度 × 衛星數)。本模組先計算一次每個時刻 (tick) 的聚合量
+(可見數、仰角總和、最低/最高仰角、換手事件)，再以：
+- 前綴和：任意窗口的總量 / 平均值 O(1)
+- 分塊前後綴極值 (van Herk / Gil-Werman，單調佇列的向量化等價形式)：
+  任意長度窗口的滑動最小/最大值 O(T)
+一次掃描為多個窗口長度與約束條件評分。
+
+另提供 PassOverlapIndex：以排序後的 AOS/LOS 前綴和回答「與窗口重疊的可見弧段」統計，
+以及 per_satellite_window_stats：逐衛星 (N × T) 的窗口內可見點數、最高仰角與首末可見時刻。
+"""
+
+import logging
+from dataclasses import dataclass, field
+from datetime import datetime, timedelta
+from typing import Any, Callable, Dict, List, Optional, Sequence
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+# ----------------------------------------------------------------------
+# 基礎運算
+# ----------------------------------------------------------------------
+
+def _prefix(values: np.ndarray) -> np.ndarray:
+    """沿最後一軸的前綴和，前置 0 (prefix[..., i] = values[..., :i].sum())"""
+    values = np.asarray(values)
+    shape = values.shape[:-1] + (1,)
+    return np.concatenate([np.zeros(shape, dtype=np.result_type(values, np.int64)),
+                           np.cumsum(values, axis=-1)], axis=-1)
+
+
+def window_sums(prefix: np.ndarray, length: int, starts: np.ndarray) -> np.ndarray:
+    """以前綴和取得 [start, start + length) 的總和"""
+    return prefix[..., starts + length] - prefix[..., starts]
+
+
+def _sliding_extreme(values: np.ndarray, length: int, reducer, fill) -> np.ndarray:
+    """van Herk / Gil-Werman：沿最後一軸的長度 length 滑動極值，輸出長度 T - length + 1"""
+    values = np.asarray(values, dtype=float)
+    t = values.shape[-1]
+    if length <= 0 or length > t:
+        raise ValueError(f"窗口長度 {length} 超出序列長度 {t}")
+    if length == 1:
+        return values.copy()
+
+    blocks = -(-t // length)
+    padded = np.full(values.shape[:-1] + (blocks * length,), fill)
+    padded[..., :t] = values
+    shaped = padded.reshape(values.shape[:-1] + (blocks, length))
+    forward = reducer.accumulate(shaped, axis=-1).reshape(padded.shape)
+    backward = np.flip(reducer.accumulate(np.flip(shaped, axis=-1), axis=-1), axis=-1).reshape(padded.shape)
+    count = t - length + 1
+    return reducer(backward[..., :count], forward[..., length - 1:length - 1 + count])
+
+
+def sliding_min(values: np.ndarray, length: int) -> np.ndarray:
+    return _sliding_extreme(values, length, np.minimum, np.inf)
+
+
+def sliding_max(values: np.ndarray, length: int) -> np.ndarray:
+    return _sliding_extreme(values, length, np.maximum, -np.inf)
+
+
+# ----------------------------------------------------------------------
+# 每時刻聚合與多窗口長度掃描
+# ----------------------------------------------------------------------
+
+@dataclass
+class WindowConstraints:
+    """窗口約束 (None 表示不限制)"""
+    min_visible: Optional[int] = None               # 窗口內每個時刻至少可見數
+    max_visible: Optional[int] = None               # 窗口內每個時刻至多可見數
+    min_worst_elevation: Optional[float] = None     # 窗口內最佳服務衛星仰角的最低值
+    min_coverage_ratio: Optional[float] = None      # 至少一顆可見的時刻比例
+    min_handover_opportunities: Optional[int] = None
+
+
+@dataclass
+class WindowScoreWeights:
+    """窗口評分權重 (與 find_optimal_timewindow 相同的 40/30/20/10 結構)"""
+    visible: float = 0.4
+    elevation: float = 0.3
+    coverage: float = 0.2
+    handover: float = 0.1
+    visible_norm: float = 10.0
+    handover_norm: float = 20.0
+
+
+@dataclass
+class TickAggregates:
+    """每個取樣時刻的聚合量"""
+    start_time: datetime
+    tick_seconds: float
+    visible_count: np.ndarray
+    elevation_sum: np.ndarray
+    min_elevation: np.ndarray       # 可見衛星中的最低仰角；無可見衛星時為 -90
+    max_elevation: np.ndarray       # 可見衛星中的最高仰角；無可見衛星時為 -90
+    handover_events: np.ndarray     # 此時刻發生的 AOS + LOS 次數
+
+    @property
+    def ticks(self) -> int:
+        return int(self.visible_count.size)
+
+    @classmethod
+    def from_elevation_matrix(cls, elevation: np.ndarray, start_time: datetime,
+                              tick_seconds: float, min_elevation: float) -> "TickAggregates":
+        """由 (衛星 × 時刻) 仰角矩陣建立"""
+        elevation = np.atleast_2d(np.asarray(elevation, dtype=float))
+        visible = elevation >= min_elevation
+        any_visible = visible.any(axis=0)
+
+        transitions = np.zeros(elevation.shape[1], dtype=np.int64)
+        if elevation.shape[1] > 1:
+            transitions[1:] = (visible[:, 1:] != visible[:, :-1]).sum(axis=0)
+
+        return cls(
+            start_time=start_time,
+            tick_seconds=tick_seconds,
+            visible_count=visible.sum(axis=0),
+            elevation_sum=np.where(visible, elevation, 0.0).sum(axis=0),
+            min_elevation=np.where(any_visible, np.where(visible, elevation, np.inf).min(axis=0), -90.0),
+            max_elevation=np.where(any_visible, np.where(visible, elevation, -np.inf).max(axis=0), -90.0),
+            handover_events=transitions,
+        )
+
+    @classmethod
+    def from_counts(cls, visible_count: np.ndarray, start_time: datetime, tick_seconds: float,
+                    handover_events: Optional[np.ndarray] = None) -> "TickAggregates":
+        """僅有每時刻可見數 (無逐衛星仰角) 時建立；仰角相關聚合以 -90 / 0 填補"""
+        visible_count = np.asarray(visible_count, dtype=np.int64)
+        ticks = visible_count.size
+        return cls(
+            start_time=start_time,
+            tick_seconds=tick_seconds,
+            visible_count=visible_count,
+            elevation_sum=np.zeros(ticks),
+            min_elevation=np.full(ticks, -90.0),
+            max_elevation=np.full(ticks, -90.0),
+            handover_events=(np.zeros(ticks, dtype=np.int64) if handover_events is None
+                             else np.asarray(handover_events, dtype=np.int64)),
+        )
+
+
+class SlidingWindowSearch:
+    """以前綴和與滑動極值一次掃描所有候選窗口"""
+
+    def __init__(self, aggregates: TickAggregates, target_visible: Optional[Sequence[int]] = None,
+                 series: Optional[Dict[str, np.ndarray]] = None):
+        """
+        Args:
+            aggregates: 每時刻聚合量
+            target_visible: 選用的理想可見數範圍 (lo, hi)，用於統計落在範圍內的時刻比例
+            series: 選用的額外每時刻數列，evaluate 以 mean_<名稱> 回傳窗口平均
+        """
+        self.aggregates = aggregates
+        self.target_visible = tuple(target_visible) if target_visible else None
+        self._series_prefix = {name: _prefix(np.asarray(values, dtype=float))
+                               for name, values in (series or {}).items()}
+
+        a = aggregates
+        self._visible_prefix = _prefix(a.visible_count)
+        self._elevation_prefix = _prefix(a.elevation_sum)
+        self._covered_prefix = _prefix((a.visible_count > 0).astype(np.int64))
+        self._handover_prefix = _prefix(a.handover_events)
+        if self.target_visible:
+            lo, hi = self.target_visible
+            self._target_prefix = _prefix(((a.visible_count >= lo) & (a.visible_count <= hi)).astype(np.int64))
+
+    def evaluate(self, length: int, stride: int = 1) -> Dict[str, np.ndarray]:
+        """長度 length (時刻數) 的所有窗口指標，起點間隔 stride"""
+        a = self.aggregates
+        starts = np.arange(0, a.ticks - length + 1, stride)
+        if starts.size == 0:
+            return {'starts': starts}
+
+        visible_total = window_sums(self._visible_prefix, length, starts)
+        elevation_total = window_sums(self._elevation_prefix, length, starts)
+        metrics = {
+            'starts': starts,
+            'mean_visible': visible_total / length,
+            'mean_elevation': np.where(visible_total > 0, elevation_total / np.maximum(visible_total, 1), 0.0),
+            'coverage_ratio': window_sums(self._covered_prefix, length, starts) / length,
+            'handover_opportunities': window_sums(self._handover_prefix, length, starts),
+            'min_visible': sliding_min(a.visible_count, length)[starts],
+            'max_visible': sliding_max(a.visible_count, length)[starts],
+            # 每時刻取最高仰角衛星服務，窗口內最差的時刻
+            'worst_elevation': sliding_min(a.max_elevation, length)[starts],
+            'peak_elevation': sliding_max(a.max_elevation, length)[starts],
+        }
+        if self.target_visible:
+            metrics['target_ratio'] = window_sums(self._target_prefix, length, starts) / length
+        for name, prefix in self._series_prefix.items():
+            metrics[f'mean_{name}'] = window_sums(prefix, length, starts) / length
+        return metrics
+
+    @staticmethod
+    def _constraint_mask(metrics: Dict[str, np.ndarray], constraints: WindowConstraints) -> np.ndarray:
+        mask = np.ones(metrics['starts'].shape, dtype=bool)
+        if constraints.min_visible is not None:
+            mask &= metrics['min_visible'] >= constraints.min_visible
+        if constraints.max_visible is not None:
+            mask &= metrics['max_visible'] <= constraints.max_visible
+        if constraints.min_worst_elevation is not None:
+            mask &= metrics['worst_elevation'] >= constraints.min_worst_elevation
+        if constraints.min_coverage_ratio is not None:
+            mask &= metrics['coverage_ratio'] >= constraints.min_coverage_ratio
+        if constraints.min_handover_opportunities is not None:
+            mask &= metrics['handover_opportunities'] >= constraints.min_handover_opportunities
+        return mask
+
+    @staticmethod
+    def score(metrics: Dict[str, np.ndarray], weights: WindowScoreWeights) -> np.ndarray:
+        return (np.minimum(metrics['mean_visible'] / weights.visible_norm, 1.0) * weights.visible
+                + np.minimum(metrics['mean_elevation'] / 90, 1.0) * weights.elevation
+                + metrics['coverage_ratio'] * weights.coverage
+                + np.minimum(metrics['handover_opportunities'] / weights.handover_norm, 1.0) * weights.handover) * 100
+
+    def sweep(self, window_lengths: Sequence[int], stride: int = 1,
+              constraints: Optional[WindowConstraints] = None,
+              weights: Optional[WindowScoreWeights] = None,
+              top_k: int = 1,
+              score_fn: Optional[Callable[[Dict[str, np.ndarray]], np.ndarray]] = None) -> Dict[str, Any]:
+        """
+        多窗口長度單次掃描
+
+        score_fn 可取代預設的加權評分 (輸入 evaluate 的指標，回傳每個窗口的分數)。
+
+        Returns:
+            {'by_length': {長度: [前 top_k 個窗口]}, 'best': 全體最佳窗口或 None, 'evaluated': 評估窗口數}
+        """
+        constraints = constraints or WindowConstraints()
+        weights = weights or WindowScoreWeights()
+        a = self.aggregates
+        by_length: Dict[int, List[Dict[str, Any]]] = {}
+        best = None
+        evaluated = 0
+
+        for length in window_lengths:
+            if length <= 0 or length > a.ticks:
+                by_length[length] = []
+                continue
+            metrics = self.evaluate(length, stride)
+            evaluated += metrics['starts'].size
+            raw = score_fn(metrics) if score_fn is not None else self.score(metrics, weights)
+            scores = np.where(self._constraint_mask(metrics, constraints), raw, -np.inf)
+
+            order = np.argsort(-scores, kind='stable')[:top_k]
+            windows = [self._describe(metrics, int(i), length, float(scores[i]))
+                       for i in order if np.isfinite(scores[i])]
+            by_length[length] = windows
+            if windows and (best is None or windows[0]['score'] > best['score']):
+                best = windows[0]
+
+        return {'by_length': by_length, 'best': best, 'evaluated': evaluated}
+
+    def _describe(self, metrics: Dict[str, np.ndarray], i: int, length: int, score: float) -> Dict[str, Any]:
+        a = self.aggregates
+        start = int(metrics['starts'][i])
+        window = {
+            'start_tick': start,
+            'length_ticks': length,
+            'start_time': (a.start_time + timedelta(seconds=start * a.tick_seconds)).isoformat(),
+            'end_time': (a.start_time + timedelta(seconds=(start + length - 1) * a.tick_seconds)).isoformat(),
+            'duration_minutes': length * a.tick_seconds / 60,
+            'score': score,
+        }
+        for key, values in metrics.items():
+            if key != 'starts':
+                window[key] = float(values[i])
+        return window
+
+
+# ----------------------------------------------------------------------
+# 可見弧段重疊統計
+# ----------------------------------------------------------------------
+
+@dataclass
+class PassOverlapIndex:
+    """
+    可見弧段 (AOS/LOS) 與查詢窗口重疊統計
+
+    弧段 [aos, los] 與窗口 [s, e] 重疊 ⇔ aos ≤ e 且 los ≥ s。
+    los < s 的弧段必有 aos < s ≤ e，因此
+        重疊數 = #(aos ≤ e) - #(los < s)
+    權重總和同理，以排序後的前綴和各做一次二分搜尋。
+    """
+    aos: np.ndarray
+    los: np.ndarray
+    weights: Dict[str, np.ndarray] = field(default_factory=dict)
+
+    def __post_init__(self):
+        self.aos = np.asarray(self.aos, dtype=float)
+        self.los = np.asarray(self.los, dtype=float)
+        self._aos_order = np.argsort(self.aos, kind='stable')
+        self._los_order = np.argsort(self.los, kind='stable')
+        self._aos_sorted = self.aos[self._aos_order]
+        self._los_sorted = self.los[self._los_order]
+        self._aos_prefix = {k: _prefix(np.asarray(w, dtype=float)[self._aos_order]) for k, w in self.weights.items()}
+        self._los_prefix = {k: _prefix(np.asarray(w, dtype=float)[self._los_order]) for k, w in self.weights.items()}
+
+    def __len__(self) -> int:
+        return int(self.aos.size)
+
+    def overlaps(self, starts, ends) -> Dict[str, np.ndarray]:
+        """每個窗口 [starts[i], ends[i]] 的重疊弧段數與各權重總和"""
+        starts = np.asarray(starts, dtype=float)
+        ends = np.asarray(ends, dtype=float)
+        began = np.searchsorted(self._aos_sorted, ends, side='right')
+        ended = np.searchsorted(self._los_sorted, starts, side='left')
+        result = {'count': began - ended}
+        for key in self.weights:
+            result[key] = self._aos_prefix[key][began] - self._los_prefix[key][ended]
+        return result
+
+
+# ----------------------------------------------------------------------
+# 逐衛星窗口統計
+# ----------------------------------------------------------------------
+
+def per_satellite_window_stats(elevation: np.ndarray, min_elevation: float,
+                               length: int, starts: np.ndarray) -> Dict[str, np.ndarray]:
+    """
+    (衛星 × 時刻) 仰角矩陣在多個窗口 [start, start + length) 內的逐衛星統計
+
+    Returns:
+        visible_ticks (N × W)、max_elevation (可見點中最高仰角，無則 -inf)、
+        first_tick / last_tick (窗口內首末可見時刻，無則 -1)
+    """
+    elevation = np.atleast_2d(np.asarray(elevation, dtype=float))
+    n, t = elevation.shape
+    starts = np.asarray(starts, dtype=np.int64)
+    visible = elevation >= min_elevation
+
+    visible_ticks = window_sums(_prefix(visible.astype(np.int64)), length, starts)
+    max_elevation = sliding_max(np.where(visible, elevation, -np.inf), length)[:, starts]
+
+    # 下一個 / 上一個可見時刻索引
+    ticks = np.arange(t)
+    next_visible = np.where(visible, ticks, t)
+    next_visible = np.flip(np.minimum.accumulate(np.flip(next_visible, axis=1), axis=1), axis=1)
+    prev_visible = np.maximum.accumulate(np.where(visible, ticks, -1), axis=1)
+
+    has_visible = visible_ticks > 0
+    first_tick = np.where(has_visible, next_visible[:, starts], -1)
+    last_tick = np.where(has_visible, prev_visible[:, starts + length - 1], -1)
+
+    return {
+        'visible_ticks': visible_ticks,
+        'max_elevation': max_elevation,
+        'first_tick': first_tick,
+        'last_tick': last_tick,
+    }
@@ -0,0 +1,365 @@
+"""
+串流式 3GPP 測量事件觸發引擎
+
+每個 UE 保存服務衛星與各鄰居衛星的狀態：L3 濾波後的 RSRP、最新距離、
+各事件的進入/離開條件與 time-to-trigger 計時器。每筆新測量只更新該 UE
+的狀態 (與歷史長度無關)，僅在事件進入或離開觸發狀態時輸出轉換，
+取代每次呼叫都重建軌跡並重放整段窗口的做法。
+
+進入/離開條件依 3GPP TS 38.331 §5.5.4 (Hys 為遲滯、Off 為偏移)：
+- A1: Ms - Hys > Thresh3            離開: Ms + Hys < Thresh3
+- A2: Ms + Hys < Thresh1            離開: Ms - Hys > Thresh1
+- A3: Mn - Hys > Ms + Off_a3        離開: Mn + Hys < Ms + Off_a3
+- A4: Mn - Hys > Thresh2            離開: Mn + Hys < Thresh2
+- A5: Ms + Hys < Thresh1 且 Mn - Hys > Thresh2
+                                    離開: Ms - Hys > Thresh1 或 Mn + Hys < Thresh2
+- A6: Mn - Hys > Ms + Off_a6        離開: Mn + Hys < Ms + Off_a6
+- D2: Ds - HysD > ThreshD1 且 Dn + HysD < ThreshD2
+                                    離開: Ds + HysD < ThreshD1 或 Dn - HysD > ThreshD2
+"""
+
+import logging
+from collections import OrderedDict
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+try:
+    # 嘗試容器內的路徑
+    from netstack.src.services.threegpp_event_generator import MeasurementEventType
+except ImportError:
+    # 嘗試本地開發路徑
+    from .threegpp_event_generator import MeasurementEventType
+
+logger = logging.getLogger(__name__)
+
+SERVING_EVENTS = ("A1", "A2")
+NEIGHBOUR_EVENTS = ("A3", "A4", "A5", "A6", "D2")
+
+ENTERED = "entered"
+LEFT = "left"
+
+
+class _EventTimer:
+    """單一事件的觸發狀態與 time-to-trigger 計時器"""
+    __slots__ = ("active", "entering_since", "leaving_since", "triggered_at")
+
+    def __init__(self):
+        self.active = False
+        self.entering_since: Optional[float] = None
+        self.leaving_since: Optional[float] = None
+        self.triggered_at: Optional[float] = None
+
+    def step(self, entering: bool, leaving: bool, now: float, ttt: float) -> Optional[str]:
+        """條件須連續成立 ttt 秒才轉換狀態；返回 ENTERED / LEFT / None"""
+        if not self.active:
+            if not entering:
+                self.entering_since = None
+                return None
+            if self.entering_since is None:
+                self.entering_since = now
+            if now - self.entering_since >= ttt:
+                self.active = True
+                self.entering_since = None
+                self.triggered_at = now
+                return ENTERED
+            return None
+
+        if not leaving:
+            self.leaving_since = None
+            return None
+        if self.leaving_since is None:
+            self.leaving_since = now
+        if now - self.leaving_since >= ttt:
+            self.active = False
+            self.leaving_since = None
+            return LEFT
+        return None
+
+
+class _LinkState:
+    """單一衛星鏈路的濾波量測"""
+    __slots__ = ("rsrp", "distance_km", "elevation_deg", "azimuth_deg", "visible", "last_seen", "timers")
+
+    def __init__(self, event_types: Sequence[str]):
+        self.rsrp: Optional[float] = None
+        self.distance_km = 0.0
+        self.elevation_deg = 0.0
+        self.azimuth_deg = 0.0
+        self.visible = False
+        self.last_seen = 0.0
+        self.timers = {event_type: _EventTimer() for event_type in event_types}
+
+    def observe(self, measurement, now: float, alpha: float):
+        # 3GPP L3 濾波: F_n = (1 - a) F_{n-1} + a M_n
+        rsrp = measurement.rsrp_dbm
+        self.rsrp = rsrp if self.rsrp is None else (1.0 - alpha) * self.rsrp + alpha * rsrp
+        self.distance_km = measurement.distance_km
+        self.elevation_deg = measurement.elevation_deg
+        self.azimuth_deg = measurement.azimuth_deg
+        self.visible = measurement.is_visible
+        self.last_seen = now
+
+    def reset_timers(self):
+        for event_type in self.timers:
+            self.timers[event_type] = _EventTimer()
+
+
+class UETriggerState:
+    """
+    單一 UE 的服務衛星與鄰居衛星狀態
+
+    active 保存目前處於觸發狀態的事件字典 (鍵為 (事件類型, 鄰居 ID))，只在進入/離開時增刪；
+    active_list 為其列表快取，有轉換時才重建。
+    """
+    __slots__ = ("ue_id", "serving_id", "serving", "neighbours", "samples", "active", "active_list")
+
+    def __init__(self, ue_id: str):
+        self.ue_id = ue_id
+        self.serving_id: Optional[str] = None
+        self.serving = _LinkState(SERVING_EVENTS)
+        self.neighbours: Dict[str, _LinkState] = {}
+        self.samples = 0
+        self.active: Dict[Tuple[str, Optional[str]], Dict[str, Any]] = {}
+        self.active_list: Optional[List[Dict[str, Any]]] = []
+
+
+class StreamingTriggerEngine:
+    """
+    每 UE、每鄰居的串流事件觸發引擎
+
+    門檻、遲滯、偏移與 D2 距離參數直接引用 ThreeGPPEventGenerator 的配置字典，
+    update_configuration 修改後立即生效；事件字典格式沿用 create_measurement_event。
+    """
+
+    def __init__(self, event_generator, max_ues: int = 10000, neighbour_stale_seconds: float = 30.0):
+        self.event_generator = event_generator
+        self.measurement_config = event_generator.measurement_config
+        self.distance_config = event_generator.distance_config
+        self.max_ues = max_ues
+        self.neighbour_stale_seconds = neighbour_stale_seconds
+        self._ues: "OrderedDict[str, UETriggerState]" = OrderedDict()
+        self.statistics = {"samples": 0, "transitions": 0, "serving_changes": 0, "ues_evicted": 0}
+
+    # === 參數 ===
+
+    @property
+    def filter_alpha(self) -> float:
+        """L3 濾波係數 a = 1 / 2^(k/4)，k 為 filterCoefficient (預設 fc4)"""
+        k = self.measurement_config.get("filter_coefficient", 4)
+        return 1.0 / (2.0 ** (k / 4.0))
+
+    @property
+    def time_to_trigger_seconds(self) -> float:
+        return self.measurement_config.get("time_to_trigger", 0) / 1000.0
+
+    # === 串流更新 ===
+
+    def update(self, ue_id: str, serving, neighbours: Sequence, timestamp: float) -> List[Dict[str, Any]]:
+        """
+        以一筆測量報告更新 UE 狀態
+
+        Args:
+            ue_id: UE 識別碼
+            serving: 服務衛星 SatelliteMeasurement
+            neighbours: 鄰居衛星 SatelliteMeasurement 列表
+            timestamp: 測量時間 (秒)
+
+        Returns:
+            本次發生的事件轉換 (含 'transition': entered / left)
+        """
+        state = self._state(ue_id)
+        transitions: List[Dict[str, Any]] = []
+        alpha = self.filter_alpha
+        ttt = self.time_to_trigger_seconds
+
+        if state.serving_id != serving.satellite_id:
+            self._change_serving(state, serving.satellite_id, timestamp, transitions)
+        state.serving.observe(serving, timestamp, alpha)
+        state.samples += 1
+        self.statistics["samples"] += 1
+
+        self._evaluate_serving(state, timestamp, ttt, transitions)
+
+        seen = set()
+        for measurement in neighbours:
+            sat_id = measurement.satellite_id
+            if sat_id == state.serving_id:
+                continue
+            seen.add(sat_id)
+            link = state.neighbours.get(sat_id)
+            if link is None:
+                link = state.neighbours[sat_id] = _LinkState(NEIGHBOUR_EVENTS)
+            link.observe(measurement, timestamp, alpha)
+            self._evaluate_neighbour(state, sat_id, link, timestamp, ttt, transitions)
+
+        # 未出現在本次報告中的鄰居：逾時後移除，仍在觸發中的事件先輸出離開
+        if len(seen) != len(state.neighbours):
+            for sat_id in [s for s in state.neighbours if s not in seen]:
+                link = state.neighbours[sat_id]
+                if timestamp - link.last_seen > self.neighbour_stale_seconds:
+                    for event_type, timer in link.timers.items():
+                        if timer.active:
+                            self._transition(state, event_type, sat_id, link, timestamp, LEFT, transitions)
+                    del state.neighbours[sat_id]
+
+        self.statistics["transitions"] += len(transitions)
+        return transitions
+
+    def active_events(self, ue_id: str) -> List[Dict[str, Any]]:
+        """
+        目前處於觸發狀態的事件 (唯讀列表)
+
+        事件字典在進入觸發時建立一次，measurements 為觸發當下的濾波量測
+        (與事件觸發式量測報告相同)；沒有轉換的取樣直接返回快取列表。
+        """
+        state = self._ues.get(ue_id)
+        if state is None:
+            return []
+        if state.active_list is None:
+            state.active_list = list(state.active.values())
+        return state.active_list
+
+    def remove_ue(self, ue_id: str):
+        self._ues.pop(ue_id, None)
+
+    def get_statistics(self) -> Dict[str, Any]:
+        return {**self.statistics, "tracked_ues": len(self._ues)}
+
+    # === 內部 ===
+
+    def _state(self, ue_id: str) -> UETriggerState:
+        state = self._ues.get(ue_id)
+        if state is None:
+            state = self._ues[ue_id] = UETriggerState(ue_id)
+            if len(self._ues) > self.max_ues:
+                self._ues.popitem(last=False)
+                self.statistics["ues_evicted"] += 1
+        else:
+            self._ues.move_to_end(ue_id)
+        return state
+
+    def _change_serving(self, state: UETriggerState, new_serving_id: str, now: float, transitions: List[Dict]):
+        """服務衛星變更：相對事件全部失效，新服務衛星沿用其作為鄰居時的濾波值"""
+        if state.serving_id is not None:
+            self.statistics["serving_changes"] += 1
+            for event_type, timer in state.serving.timers.items():
+                if timer.active:
+                    self._transition(state, event_type, None, None, now, LEFT, transitions)
+            for sat_id, link in state.neighbours.items():
+                for event_type, timer in link.timers.items():
+                    if timer.active:
+                        self._transition(state, event_type, sat_id, link, now, LEFT, transitions)
+                link.reset_timers()
+
+        previous = state.neighbours.pop(new_serving_id, None)
+        state.serving = _LinkState(SERVING_EVENTS)
+        if previous is not None:
+            state.serving.rsrp = previous.rsrp
+        state.serving_id = new_serving_id
+
+    def _evaluate_serving(self, state: UETriggerState, now: float, ttt: float, transitions: List[Dict]):
+        thresholds = self.measurement_config["rsrp_thresholds"]
+        hys = self.measurement_config["hysteresis"]
+        ms = state.serving.rsrp
+        conditions = {
+            "A1": (ms - hys > thresholds["threshold3"], ms + hys < thresholds["threshold3"]),
+            "A2": (ms + hys < thresholds["threshold1"], ms - hys > thresholds["threshold1"]),
+        }
+        for event_type, (entering, leaving) in conditions.items():
+            transition = state.serving.timers[event_type].step(entering, leaving, now, ttt)
+            if transition:
+                self._transition(state, event_type, None, None, now, transition, transitions)
+
+    def _evaluate_neighbour(self, state: UETriggerState, sat_id: str, link: _LinkState,
+                            now: float, ttt: float, transitions: List[Dict]):
+        config = self.measurement_config
+        thresholds = config["rsrp_thresholds"]
+        hys = config["hysteresis"]
+        ms, mn = state.serving.rsrp, link.rsrp
+        t1, t2 = thresholds["threshold1"], thresholds["threshold2"]
+
+        if link.visible:
+            conditions = {
+                "A3": (mn - hys > ms + config["offset_a3"], mn + hys < ms + config["offset_a3"]),
+                "A4": (mn - hys > t2, mn + hys < t2),
+                "A5": (ms + hys < t1 and mn - hys > t2, ms - hys > t1 or mn + hys < t2),
+                "A6": (mn - hys > ms + config["offset_a6"], mn + hys < ms + config["offset_a6"]),
+            }
+            if self.distance_config.get("enable_distance_handover", True):
+                d1 = self.distance_config["serving_distance_threshold"]
+                d2 = self.distance_config["neighbor_distance_threshold"]
+                hys_d = self.distance_config["distance_hysteresis"]
+                ds, dn = state.serving.distance_km, link.distance_km
+                conditions["D2"] = (ds - hys_d > d1 and dn + hys_d < d2, ds + hys_d < d1 or dn - hys_d > d2)
+            else:
+                conditions["D2"] = (False, True)
+        else:
+            # 不可見的鄰居不能進入事件，已觸發的事件視為離開條件成立
+            conditions = {event_type: (False, True) for event_type in NEIGHBOUR_EVENTS}
+
+        for event_type, (entering, leaving) in conditions.items():
+            transition = link.timers[event_type].step(entering, leaving, now, ttt)
+            if transition:
+                self._transition(state, event_type, sat_id, link, now, transition, transitions)
+
+    def _transition(self, state: UETriggerState, event_type: str, neighbour_id: Optional[str],
+                    link: Optional[_LinkState], now: float, transition: str, transitions: List[Dict]):
+        """輸出一筆轉換並同步更新該 UE 的觸發中事件快取"""
+        event = self._event(state, event_type, neighbour_id, link, now, transition)
+        transitions.append(event)
+        key = (event_type, neighbour_id)
+        if transition == ENTERED:
+            state.active[key] = {k: v for k, v in event.items() if k != "transition"}
+        else:
+            state.active.pop(key, None)
+        state.active_list = None
+
+    def _event(self, state: UETriggerState, event_type: str, neighbour_id: Optional[str],
+               link: Optional[_LinkState], now: float, transition: Optional[str]) -> Dict[str, Any]:
+        """以與 ThreeGPPEventGenerator 相同的欄位建立事件字典"""
+        thresholds = self.measurement_config["rsrp_thresholds"]
+        serving = state.serving
+        ms = serving.rsrp
+
+        if event_type == "A1":
+            sat_id, measurements = state.serving_id, {
+                "serving_rsrp": ms, "threshold": thresholds["threshold3"],
+                "margin": ms - thresholds["threshold3"], "elevation": serving.elevation_deg}
+        elif event_type == "A2":
+            sat_id, measurements = state.serving_id, {
+                "serving_rsrp": ms, "threshold": thresholds["threshold1"],
+                "margin": thresholds["threshold1"] - ms, "elevation": serving.elevation_deg}
+        elif event_type == "A4":
+            sat_id, measurements = neighbour_id, {
+                "neighbor_rsrp": link.rsrp, "threshold": thresholds["threshold2"],
+                "margin": link.rsrp - thresholds["threshold2"], "elevation": link.elevation_deg,
+                "handover_candidate": neighbour_id}
+        elif event_type == "A5":
+            sat_id, measurements = state.serving_id, {
+                "serving_rsrp": ms, "neighbor_rsrp": link.rsrp, "neighbor_sat_id": neighbour_id,
+                "threshold1": thresholds["threshold1"], "threshold2": thresholds["threshold2"],
+                "serving_margin": thresholds["threshold1"] - ms,
+                "neighbor_margin": link.rsrp - thresholds["threshold2"],
+                "handover_required": True, "handover_candidate": neighbour_id}
+        elif event_type in ("A3", "A6"):
+            offset = self.measurement_config["offset_a3" if event_type == "A3" else "offset_a6"]
+            sat_id, measurements = state.serving_id, {
+                "serving_rsrp": ms, "neighbor_rsrp": link.rsrp, "neighbor_sat_id": neighbour_id,
+                "offset": offset, "margin": link.rsrp - ms - offset, "handover_candidate": neighbour_id}
+        else:
+            advantage = serving.distance_km - link.distance_km
+            sat_id, measurements = state.serving_id, {
+                "serving_distance_km": serving.distance_km, "neighbor_distance_km": link.distance_km,
+                "neighbor_sat_id": neighbour_id,
+                "serving_threshold_km": self.distance_config["serving_distance_threshold"],
+                "neighbor_threshold_km": self.distance_config["neighbor_distance_threshold"],
+                "distance_advantage_km": advantage, "serving_elevation": serving.elevation_deg,
+                "neighbor_elevation": link.elevation_deg, "handover_required": True,
+                "handover_candidate": neighbour_id, "handover_reason": "distance_optimization",
+                "expected_improvement_km": advantage}
+
+        event = self.event_generator.create_measurement_event(MeasurementEventType(event_type), sat_id, now,
+                                                              measurements)
+        event["ue_id"] = state.ue_id
+        if transition is not None:
+            event["transition"] = transition
+        return event
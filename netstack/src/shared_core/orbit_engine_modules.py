@@ -0,0 +1,65 @@
+"""
+orbit-engine 共享模組載入器
+
+部分演算法 (相位空間索引、響應編碼層) 只在 orbit-engine/src/shared 保留一份實作，
+NetStack 透過本模組直接載入該檔案，不再維護複本。搜尋順序:
+1. 環境變數 ORBIT_ENGINE_SRC (指向 orbit-engine/src)
+2. 容器唯讀掛載 /app/orbit_engine_src (見 compose/core.yaml)
+3. 原始碼樹中的 orbit-engine/src
+
+模組以獨立名稱登記於 sys.modules，避免觸發 orbit-engine shared 套件初始化
+(會載入 SGP4/Skyfield 等 NetStack 不需要的依賴)。
+"""
+
+import importlib.util
+import logging
+import os
+import sys
+from pathlib import Path
+from types import ModuleType
+from typing import Iterator
+
+logger = logging.getLogger(__name__)
+
+_CONTAINER_MOUNT = Path("/app/orbit_engine_src")
+
+
+def _candidate_roots() -> Iterator[Path]:
+    override = os.getenv("ORBIT_ENGINE_SRC")
+    if override:
+        yield Path(override)
+    yield _CONTAINER_MOUNT
+    # 原始碼樹：netstack/src/shared_core -> 專案根目錄
+    yield Path(__file__).resolve().parents[3] / "orbit-engine" / "src"
+
+
+def load_orbit_engine_module(relative_path: str) -> ModuleType:
+    """
+    載入 orbit-engine/src 下的單一模組檔案
+
+    Args:
+        relative_path: 相對於 orbit-engine/src 的路徑，
+            例如 "shared/core_modules/phase_space_index.py"
+    """
+    module_name = "orbit_engine_" + relative_path[:-3].replace("/", "_")
+    if module_name in sys.modules:
+        return sys.modules[module_name]
+
+    for root in _candidate_roots():
+        path = root / relative_path
+        if not path.is_file():
+            continue
+        spec = importlib.util.spec_from_file_location(module_name, path)
+        module = importlib.util.module_from_spec(spec)
+        sys.modules[module_name] = module
+        try:
+            spec.loader.exec_module(module)
+        except Exception:
+            del sys.modules[module_name]
+            raise
+        logger.info(f"orbit-engine 共享模組載入自 {path}")
+        return module
+
+    raise ImportError(
+        f"找不到 orbit-engine 模組 {relative_path}，請確認唯讀掛載或設定 ORBIT_ENGINE_SRC"
+    )
@@ -14,12 +14,23 @@ __author__ = "NTN Stack Validation Team"
 
 from .base_validator import BaseValidator, ValidationResult
 from .validation_engine import ValidationEngine
+from .compiled_plan import (
+    ValidationRule, RuleKind, CompiledValidationPlan, StructuralSnapshot,
+    compile_rules, default_rules, structural_snapshot
+)
 from .error_handler import ValidationError, ValidationWarning
 
 __all__ = [
     "BaseValidator",
     "ValidationResult", 
     "ValidationEngine",
+    "ValidationRule",
+    "RuleKind",
+    "CompiledValidationPlan",
+    "StructuralSnapshot",
+    "compile_rules",
+    "default_rules",
+    "structural_snapshot",
     "ValidationError",
     "ValidationWarning"
 ]
@@ -0,0 +1,537 @@
+"""
+編譯式驗證計畫
+Compiled Single-Pass Validation Plan
+
+將所有已註冊的規則編譯為單一遍歷計畫：
+- 一次迭代式走訪 (無遞迴) 收集規則關注的欄位為列式陣列
+- 以 numpy 向量化評估範圍、NaN、時間單調性與跨階段 ID 規則
+- 同一次走訪附帶產生結構快照，供 data_quality_engine 各檢查器共用
+- 可選統計抽樣模式，適用於超大型 Stage 2-4 輸出 (規則計畫與結構快照共用同一份樣本)
+"""
+
+from typing import Dict, List, Any, Optional, Iterable, Set, Tuple
+from collections import defaultdict
+from dataclasses import dataclass, field
+from datetime import datetime
+from enum import Enum
+import itertools
+import logging
+import random
+import time
+
+import numpy as np
+
+from .base_validator import ValidationResult, ValidationStatus, ValidationLevel
+
+
+logger = logging.getLogger(__name__)
+
+# 結構快照的時間欄位 (與原 data_quality_engine 走訪器的鍵名清單一致)
+TIME_SERIES_KEYS = frozenset(("timestamp", "time", "datetime", "epoch"))
+STAGE_TIMESTAMP_KEYS = frozenset(("timestamp", "time", "datetime"))
+
+# 內建範圍規則 (沿用 visibility_data_structure 的欄位約束與地理座標定義域)
+BUILTIN_RANGES = (
+    ("elevation", -90.0, 90.0),
+    ("elevation_deg", -90.0, 90.0),
+    ("azimuth", 0.0, 360.0),
+    ("azimuth_deg", 0.0, 360.0),
+    ("latitude", -90.0, 90.0),
+    ("longitude", -180.0, 180.0),
+)
+
+# 走訪旗標
+_TIME_SERIES = 1    # 尚未進入時間序列欄位
+_STAGE_TIME = 2     # 尚未進入階段時間戳欄位
+_ALL_FLAGS = _TIME_SERIES | _STAGE_TIME
+
+# 每次 collect() 的走訪編號，結構快照以此識別產生它的計畫調用
+_invocation_counter = itertools.count(1)
+
+
+class RuleKind(Enum):
+    """規則類型"""
+    RANGE = "range"                      # 數值範圍
+    FINITE = "finite"                    # NaN / Inf 檢測
+    MONOTONIC_TIME = "monotonic_time"    # 時間序列單調遞增
+    CROSS_STAGE_ID = "cross_stage_id"    # 跨階段 ID 一致性
+
+
+@dataclass
+class ValidationRule:
+    """
+    可編譯驗證規則
+
+    field 為葉節點鍵名 (如 'elevation_deg')，於任何巢狀層級皆會匹配，
+    與既有 data_quality_engine 走訪器以鍵名辨識欄位的行為一致。
+    """
+    rule_id: str
+    kind: RuleKind
+    field: str
+    min_value: Optional[float] = None
+    max_value: Optional[float] = None
+    reference_ids: Optional[Set[Any]] = None
+    reference_context_key: str = "upstream_satellite_ids"
+    level: ValidationLevel = ValidationLevel.HIGH
+    max_reported_violations: int = 10
+
+    @classmethod
+    def range(cls, field: str, min_value: float = None, max_value: float = None, **kwargs) -> "ValidationRule":
+        return cls(rule_id=kwargs.pop("rule_id", f"range:{field}"), kind=RuleKind.RANGE,
+                   field=field, min_value=min_value, max_value=max_value, **kwargs)
+
+    @classmethod
+    def finite(cls, field: str, **kwargs) -> "ValidationRule":
+        return cls(rule_id=kwargs.pop("rule_id", f"finite:{field}"), kind=RuleKind.FINITE,
+                   field=field, **kwargs)
+
+    @classmethod
+    def monotonic_time(cls, field: str = "timestamp", **kwargs) -> "ValidationRule":
+        return cls(rule_id=kwargs.pop("rule_id", f"monotonic:{field}"), kind=RuleKind.MONOTONIC_TIME,
+                   field=field, **kwargs)
+
+    @classmethod
+    def cross_stage_ids(cls, field: str = "satellite_id", reference_ids: Iterable[Any] = None,
+                        **kwargs) -> "ValidationRule":
+        refs = set(reference_ids) if reference_ids is not None else None
+        return cls(rule_id=kwargs.pop("rule_id", f"cross_stage_ids:{field}"), kind=RuleKind.CROSS_STAGE_ID,
+                   field=field, reference_ids=refs, **kwargs)
+
+
+@dataclass
+class SamplingConfig:
+    """統計抽樣配置：長度超過 threshold 的列表僅保留 sample_size 個元素 (保持原順序)"""
+    enabled: bool = False
+    threshold: int = 10000
+    sample_size: int = 2000
+    seed: int = 42
+
+    @classmethod
+    def from_dict(cls, config: Dict[str, Any] = None) -> "SamplingConfig":
+        config = config or {}
+        return cls(
+            enabled=config.get("enabled", False),
+            threshold=config.get("threshold", 10000),
+            sample_size=config.get("sample_size", 2000),
+            seed=config.get("seed", 42)
+        )
+
+
+@dataclass
+class StructuralSnapshot:
+    """
+    結構快照：統計分析與跨階段一致性檢查需要的欄位
+
+    路徑規則與原遞迴走訪器相同 (字典鍵以 '.' 連接，列表不增加層級)，
+    同一路徑的數值按前序走訪順序排列；抽樣模式下只涵蓋樣本元素 (sampled=True)，
+    依賴完整集合的跨階段比對應據此跳過。
+    source 持有走訪的數據本身，重用時以物件身分比對，不會因 id() 回收而誤配。
+    """
+    invocation_id: int
+    source: Any = field(default=None, repr=False, compare=False)
+    sampled: bool = False
+    numerical_fields: Dict[str, List[float]] = field(default_factory=dict)
+    time_series: Dict[str, List[Any]] = field(default_factory=dict)
+    satellite_ids: Set[Any] = field(default_factory=set)
+    stage_satellite_ids: Dict[str, Set[Any]] = field(default_factory=dict)
+    timestamps_by_stage: Dict[str, List[Any]] = field(default_factory=dict)
+    coordinate_systems: Set[str] = field(default_factory=set)
+    eci_coordinates: List[Dict[str, Any]] = field(default_factory=list)
+    geodetic_coordinates: List[Dict[str, Any]] = field(default_factory=list)
+
+
+@dataclass
+class ColumnarSnapshot:
+    """單次走訪的列式結果"""
+    numeric: Dict[str, List[float]] = field(default_factory=dict)
+    series: Dict[str, List[Tuple[str, List[Any]]]] = field(default_factory=dict)
+    identifiers: Dict[str, List[Any]] = field(default_factory=dict)
+    structure: Optional[StructuralSnapshot] = None
+    nodes_visited: int = 0
+    lists_sampled: int = 0
+
+
+class CompiledValidationPlan:
+    """
+    編譯後的驗證計畫
+
+    編譯時將規則按欄位類型歸類，走訪時每個鍵只做一次集合查找，
+    評估階段對每個欄位的列式陣列執行所有相關規則。
+    """
+
+    def __init__(self, rules: List[ValidationRule], sampling: SamplingConfig = None,
+                 name: str = "CompiledValidationPlan"):
+        self.name = name
+        self.rules = list(rules)
+        self.sampling = sampling or SamplingConfig()
+
+        self._numeric_fields: Set[str] = set()
+        self._series_fields: Set[str] = set()
+        self._id_fields: Set[str] = set()
+
+        for rule in self.rules:
+            if rule.kind in (RuleKind.RANGE, RuleKind.FINITE):
+                self._numeric_fields.add(rule.field)
+            elif rule.kind == RuleKind.MONOTONIC_TIME:
+                self._series_fields.add(rule.field)
+            elif rule.kind == RuleKind.CROSS_STAGE_ID:
+                self._id_fields.add(rule.field)
+
+        self._watched = self._numeric_fields | self._series_fields | self._id_fields
+
+    # ------------------------------------------------------------------
+    # 單次走訪
+    # ------------------------------------------------------------------
+
+    def collect(self, data: Any, structure: bool = True) -> ColumnarSnapshot:
+        """迭代式單次走訪，收集所有規則關注的欄位 (structure=True 時一併建立結構快照)"""
+        snapshot = ColumnarSnapshot(
+            numeric={f: [] for f in self._numeric_fields},
+            series={f: [] for f in self._series_fields},
+            identifiers={f: [] for f in self._id_fields}
+        )
+        shape = StructuralSnapshot(invocation_id=next(_invocation_counter), source=data) if structure else None
+        numerical = defaultdict(list)
+        watched = self._watched
+        numeric_fields = self._numeric_fields
+        series_fields = self._series_fields
+        id_fields = self._id_fields
+        sampling = self.sampling
+        rng = random.Random(sampling.seed)
+
+        # 堆疊元素: (物件, 路徑, 直接所屬列表的識別鍵, 階段鍵, 走訪旗標)；子節點逆序壓棧以維持前序順序
+        stack: List[Tuple[Any, str, str, str, int]] = [(data, "", "", "", _ALL_FLAGS)]
+        # 同一列表中各元素的時間戳需彙整成一條序列
+        pending_series: Dict[Tuple[str, str], Tuple[str, List[Any]]] = {}
+
+        while stack:
+            obj, path, list_path, stage, flags = stack.pop()
+
+            if isinstance(obj, dict):
+                snapshot.nodes_visited += 1
+                if shape is not None:
+                    self._collect_dict_structure(shape, obj, stage)
+                children = []
+                for key, value in obj.items():
+                    child_path = f"{path}.{key}" if path else key
+                    child_stage = stage
+                    child_flags = flags
+                    if shape is not None:
+                        lowered = key.lower() if isinstance(key, str) else ""
+                        if "stage" in lowered:
+                            child_stage = key
+                        if flags & _TIME_SERIES and lowered in TIME_SERIES_KEYS:
+                            shape.time_series[child_path] = value if isinstance(value, list) else [value]
+                            child_flags &= ~_TIME_SERIES
+                        if flags & _STAGE_TIME and lowered in STAGE_TIMESTAMP_KEYS:
+                            bucket = shape.timestamps_by_stage.setdefault(child_stage, [])
+                            if isinstance(value, list):
+                                bucket.extend(value)
+                            else:
+                                bucket.append(value)
+                            child_flags &= ~_STAGE_TIME
+                        if isinstance(value, (int, float)) and not isinstance(value, bool):
+                            numerical[child_path].append(float(value))
+                    if key in watched and not isinstance(value, dict):
+                        if key in numeric_fields:
+                            self._append_numeric(snapshot.numeric[key], value)
+                        if key in series_fields:
+                            if isinstance(value, list):
+                                snapshot.series[key].append((child_path, value))
+                            elif list_path:
+                                # 列表元素中的標量時間戳依所屬列表彙整為一條序列
+                                pending_series.setdefault(
+                                    (list_path, key), (f"{path}[].{key}", [])
+                                )[1].append(value)
+                        if key in id_fields:
+                            snapshot.identifiers[key].append(value)
+                    if isinstance(value, (dict, list)):
+                        children.append((value, child_path, "", child_stage, child_flags))
+                stack.extend(reversed(children))
+
+            elif isinstance(obj, list):
+                snapshot.nodes_visited += 1
+                sampled = None
+                if sampling.enabled and len(obj) > sampling.threshold:
+                    sampled = set(rng.sample(range(len(obj)), min(sampling.sample_size, len(obj))))
+                    snapshot.lists_sampled += 1
+                list_key = f"{path}#{id(obj)}"
+                children = []
+                # 出現巢狀列表後，同路徑的標量需延後到巢狀列表之後處理才能維持前序順序
+                defer_scalars = False
+                for index, item in enumerate(obj):
+                    # 未抽中的元素對規則計畫與結構快照都不走訪
+                    if sampled is not None and index not in sampled:
+                        continue
+                    if isinstance(item, (dict, list)):
+                        children.append((item, path, list_key, stage, flags))
+                        defer_scalars = defer_scalars or isinstance(item, list)
+                    elif shape is not None and path and isinstance(item, (int, float)) \
+                            and not isinstance(item, bool):
+                        if defer_scalars:
+                            children.append((item, path, list_key, stage, flags))
+                        else:
+                            numerical[path].append(float(item))
+                stack.extend(reversed(children))
+
+            elif shape is not None and path and isinstance(obj, (int, float)) and not isinstance(obj, bool):
+                # 延後處理的列表標量
+                numerical[path].append(float(obj))
+
+        for (_, key), (series_path, values) in pending_series.items():
+            snapshot.series[key].append((series_path, values))
+
+        if shape is not None:
+            shape.numerical_fields = dict(numerical)
+            shape.sampled = snapshot.lists_sampled > 0
+            snapshot.structure = shape
+        return snapshot
+
+    @staticmethod
+    def _collect_dict_structure(shape: StructuralSnapshot, obj: Dict[Any, Any], stage: str):
+        """單一字典節點上的衛星 ID 與座標系統偵測"""
+        if "satellite_id" in obj:
+            satellite_id = obj["satellite_id"]
+            shape.satellite_ids.add(satellite_id)
+            shape.stage_satellite_ids.setdefault(stage, set()).add(satellite_id)
+        if "x" in obj and "y" in obj and "z" in obj:
+            shape.coordinate_systems.add("eci")
+            shape.eci_coordinates.append({"x": obj["x"], "y": obj["y"], "z": obj["z"]})
+        if "latitude" in obj and "longitude" in obj:
+            shape.coordinate_systems.add("geodetic")
+            shape.geodetic_coordinates.append({"lat": obj["latitude"], "lon": obj["longitude"]})
+        elif "lat" in obj and "lon" in obj:
+            shape.coordinate_systems.add("geodetic")
+            shape.geodetic_coordinates.append({"lat": obj["lat"], "lon": obj["lon"]})
+        if "azimuth" in obj and "elevation" in obj:
+            shape.coordinate_systems.add("topocentric")
+
+    @staticmethod
+    def _append_numeric(column: List[float], value: Any):
+        if isinstance(value, bool):
+            return
+        if isinstance(value, (int, float)):
+            column.append(float(value))
+        elif value is None:
+            column.append(float("nan"))
+        elif isinstance(value, list):
+            for v in value:
+                if isinstance(v, (int, float)) and not isinstance(v, bool):
+                    column.append(float(v))
+                elif v is None:
+                    column.append(float("nan"))
+
+    # ------------------------------------------------------------------
+    # 向量化評估
+    # ------------------------------------------------------------------
+
+    def execute(self, data: Any, context: Dict[str, Any] = None) -> List[ValidationResult]:
+        """執行編譯後的計畫，返回每條規則一個驗證結果"""
+        start = time.perf_counter()
+        snapshot = self.collect(data, structure=False)
+        return self.evaluate(snapshot, context, walk_seconds=time.perf_counter() - start)
+
+    def evaluate(self, snapshot: ColumnarSnapshot, context: Dict[str, Any] = None,
+                 walk_seconds: float = 0.0) -> List[ValidationResult]:
+        """對已收集的列式結果評估所有規則"""
+        context = context or {}
+        start = time.perf_counter()
+        numeric_arrays = {f: np.asarray(v, dtype=np.float64) for f, v in snapshot.numeric.items()}
+        sampled = snapshot.lists_sampled > 0
+
+        results = []
+        for rule in self.rules:
+            if rule.kind == RuleKind.RANGE:
+                results.append(self._evaluate_range(rule, numeric_arrays[rule.field], sampled))
+            elif rule.kind == RuleKind.FINITE:
+                results.append(self._evaluate_finite(rule, numeric_arrays[rule.field], sampled))
+            elif rule.kind == RuleKind.MONOTONIC_TIME:
+                results.append(self._evaluate_monotonic(rule, snapshot.series[rule.field], sampled))
+            elif rule.kind == RuleKind.CROSS_STAGE_ID:
+                results.append(self._evaluate_cross_stage(rule, snapshot.identifiers[rule.field],
+                                                          context, sampled))
+
+        total_seconds = walk_seconds + time.perf_counter() - start
+        self.last_execution_stats = {
+            "rules_evaluated": len(self.rules),
+            "nodes_visited": snapshot.nodes_visited,
+            "lists_sampled": snapshot.lists_sampled,
+            "walk_seconds": walk_seconds,
+            "total_seconds": total_seconds
+        }
+        logger.debug(f"{self.name}: {len(self.rules)} rules, {snapshot.nodes_visited} nodes, "
+                     f"{total_seconds * 1000:.1f}ms")
+        return results
+
+    def _result(self, rule: ValidationRule, passed: bool, message: str,
+                details: Dict[str, Any], sampled: bool) -> ValidationResult:
+        return ValidationResult(
+            validator_name=self.name,
+            status=ValidationStatus.PASSED if passed else ValidationStatus.FAILED,
+            level=ValidationLevel.INFO if passed else rule.level,
+            message=message,
+            details=details,
+            metadata={"rule_id": rule.rule_id, "rule_kind": rule.kind.value, "sampled": sampled}
+        )
+
+    def _evaluate_range(self, rule: ValidationRule, values: np.ndarray, sampled: bool) -> ValidationResult:
+        finite_values = values[np.isfinite(values)]
+        mask = np.zeros(finite_values.shape, dtype=bool)
+        if rule.min_value is not None:
+            mask |= finite_values < rule.min_value
+        if rule.max_value is not None:
+            mask |= finite_values > rule.max_value
+        violations = int(mask.sum())
+        details = {
+            "field": rule.field,
+            "checked": int(finite_values.size),
+            "violations": violations,
+            "allowed_range": [rule.min_value, rule.max_value],
+            "sample_violations": finite_values[mask][:rule.max_reported_violations].tolist()
+        }
+        if finite_values.size:
+            details["observed_range"] = [float(finite_values.min()), float(finite_values.max())]
+        return self._result(
+            rule, violations == 0,
+            f"'{rule.field}' range check: {violations} of {finite_values.size} values out of range",
+            details, sampled
+        )
+
+    def _evaluate_finite(self, rule: ValidationRule, values: np.ndarray, sampled: bool) -> ValidationResult:
+        bad = ~np.isfinite(values)
+        nan_count = int(np.isnan(values).sum())
+        inf_count = int(bad.sum()) - nan_count
+        details = {
+            "field": rule.field,
+            "checked": int(values.size),
+            "nan_count": nan_count,
+            "inf_count": inf_count,
+            "first_bad_indices": np.flatnonzero(bad)[:rule.max_reported_violations].tolist()
+        }
+        return self._result(
+            rule, not bad.any(),
+            f"'{rule.field}' finite check: {nan_count} NaN, {inf_count} Inf in {values.size} values",
+            details, sampled
+        )
+
+    def _evaluate_monotonic(self, rule: ValidationRule, series: List[Tuple[str, List[Any]]],
+                            sampled: bool) -> ValidationResult:
+        violating_series = []
+        checked = 0
+        for series_path, raw in series:
+            if len(raw) < 2:
+                continue
+            seconds = _to_epoch_seconds(raw)
+            checked += 1
+            if seconds is None:
+                violating_series.append({"series": series_path, "reason": "unparseable timestamps"})
+                continue
+            steps = np.diff(seconds)
+            backwards = np.flatnonzero(steps < 0)
+            if backwards.size:
+                violating_series.append({
+                    "series": series_path,
+                    "backward_steps": int(backwards.size),
+                    "first_index": int(backwards[0]) + 1
+                })
+        details = {
+            "field": rule.field,
+            "series_checked": checked,
+            "violating_series": len(violating_series),
+            "violations": violating_series[:rule.max_reported_violations]
+        }
+        return self._result(
+            rule, not violating_series,
+            f"'{rule.field}' monotonic check: {len(violating_series)} of {checked} series out of order",
+            details, sampled
+        )
+
+    def _evaluate_cross_stage(self, rule: ValidationRule, observed: List[Any],
+                              context: Dict[str, Any], sampled: bool) -> ValidationResult:
+        reference = rule.reference_ids
+        if reference is None:
+            context_refs = (context.get("metadata") or {}).get(rule.reference_context_key) \
+                or context.get(rule.reference_context_key)
+            reference = set(context_refs) if context_refs is not None else None
+
+        observed_ids = set(observed)
+        if reference is None:
+            return ValidationResult(
+                validator_name=self.name,
+                status=ValidationStatus.SKIPPED,
+                level=ValidationLevel.INFO,
+                message=f"'{rule.field}' cross-stage check skipped: no reference ids",
+                details={"field": rule.field, "observed_unique": len(observed_ids)},
+                metadata={"rule_id": rule.rule_id, "rule_kind": rule.kind.value, "sampled": sampled}
+            )
+
+        unexpected = observed_ids - reference
+        # 抽樣模式下未觀測到的 ID 不代表遺失，只檢查多出的 ID
+        missing = set() if sampled else reference - observed_ids
+        details = {
+            "field": rule.field,
+            "observed_unique": len(observed_ids),
+            "reference_count": len(reference),
+            "unexpected_ids": sorted(map(str, unexpected))[:rule.max_reported_violations],
+            "missing_ids": sorted(map(str, missing))[:rule.max_reported_violations],
+            "unexpected_count": len(unexpected),
+            "missing_count": len(missing)
+        }
+        return self._result(
+            rule, not unexpected and not missing,
+            f"'{rule.field}' cross-stage check: {len(unexpected)} unexpected, {len(missing)} missing",
+            details, sampled
+        )
+
+
+def _to_epoch_seconds(values: List[Any]) -> Optional[np.ndarray]:
+    """將時間戳列表轉為 epoch 秒陣列 (數值直接使用，ISO 字串批次解析)"""
+    if all(isinstance(v, (int, float)) and not isinstance(v, bool) for v in values):
+        return np.asarray(values, dtype=np.float64)
+    try:
+        normalized = [str(v).replace("Z", "").replace("+00:00", "") for v in values]
+        stamps = np.array(normalized, dtype="datetime64[us]")
+        return stamps.astype(np.int64) / 1e6
+    except (ValueError, TypeError):
+        pass
+    try:
+        return np.array([datetime.fromisoformat(str(v).replace("Z", "+00:00")).timestamp()
+                         for v in values], dtype=np.float64)
+    except (ValueError, TypeError):
+        return None
+
+
+def default_rules() -> List[ValidationRule]:
+    """
+    內建規則：常見物理欄位的範圍與 NaN/Inf 檢查、時間戳單調性、跨階段衛星 ID
+
+    時間單調性僅為 MEDIUM (不阻斷)，因同層列表未必是時間序列；
+    跨階段 ID 檢查在上下文沒有參考 ID 時自動跳過。
+    """
+    rules = []
+    for field_name, min_value, max_value in BUILTIN_RANGES:
+        rules.append(ValidationRule.range(field_name, min_value, max_value))
+        rules.append(ValidationRule.finite(field_name))
+    rules.append(ValidationRule.monotonic_time("timestamp", level=ValidationLevel.MEDIUM))
+    rules.append(ValidationRule.cross_stage_ids("satellite_id"))
+    return rules
+
+
+def structural_snapshot(data: Any, context: Dict[str, Any] = None) -> StructuralSnapshot:
+    """
+    取得數據的結構快照：引擎本次計畫調用已走訪同一份數據時直接重用，否則單次走訪建立
+
+    上下文需同時帶有快照與其計畫調用編號 (plan_invocation)，且快照來源即為 data 本身。
+    """
+    context = context or {}
+    shared = context.get("data_snapshot")
+    if shared is not None and context.get("plan_invocation") == shared.invocation_id \
+            and shared.source is data:
+        return shared
+    return CompiledValidationPlan([], name="StructuralSnapshot").collect(data).structure
+
+
+def compile_rules(rules: List[ValidationRule], sampling: Dict[str, Any] = None,
+                  name: str = "CompiledValidationPlan") -> CompiledValidationPlan:
+    """便捷函數：將規則列表編譯為單次走訪計畫"""
+    return CompiledValidationPlan(rules, SamplingConfig.from_dict(sampling), name=name)
@@ -7,10 +7,12 @@ from typing import Dict, List, Any, Optional, Type
 from datetime import datetime
 import logging
 import threading
+import time
 from concurrent.futures import ThreadPoolExecutor, as_completed
 
 from .base_validator import BaseValidator, ValidationResult, ValidationStatus, ValidationLevel
 from .error_handler import ValidationError, ErrorHandler
+from .compiled_plan import ValidationRule, CompiledValidationPlan, SamplingConfig, default_rules
 
 
 logger = logging.getLogger(__name__)
@@ -37,6 +39,7 @@ class ValidationContext:
         self.start_time = datetime.utcnow()
         self.validators_run = []
         self.thread_local = threading.local()
+        self.data_snapshot = None
         
     def add_validator(self, validator_name: str):
         """添加已運行的驗證器"""
@@ -59,6 +62,14 @@ class ValidationContext:
             "duration_seconds": self.get_duration(),
             "validators_run": self.validators_run
         }
+        
+    def to_validator_context(self) -> Dict[str, Any]:
+        """傳給驗證器的上下文，附帶引擎單次走訪產生的結構快照 (不寫入報告)"""
+        validator_context = self.to_dict()
+        if self.data_snapshot is not None:
+            validator_context["data_snapshot"] = self.data_snapshot
+            validator_context["plan_invocation"] = self.data_snapshot.invocation_id
+        return validator_context
 
 
 class ValidationEngine:
@@ -80,6 +91,10 @@ class ValidationEngine:
         self.parallel_execution = self.config.get("parallel_execution", True)
         self.max_workers = self.config.get("max_workers", 4)
         self.stop_on_critical = self.config.get("stop_on_critical", True)
+        self.sampling_config = SamplingConfig.from_dict(self.config.get("sampling"))
+        self.builtin_rules: List[ValidationRule] = default_rules() if self.config.get("builtin_rules", True) else []
+        self.rule_sets: Dict[str, List[ValidationRule]] = {}
+        self._compiled_plans: Dict[str, CompiledValidationPlan] = {}
         self.logger = logging.getLogger("validation.engine")
         
     def register_validator(self, validator: BaseValidator, chain: str = "default"):
@@ -104,6 +119,36 @@ class ValidationEngine:
             
         self.logger.info(f"Registered validator: {validator.name} in chain: {chain}")
         
+    def register_rule(self, rule: ValidationRule, chain: str = "default"):
+        """
+        註冊可編譯規則
+
+        同一鏈的所有規則在執行時編譯為單一走訪計畫，
+        範圍、NaN、時間單調性與跨階段 ID 檢查只需走訪數據一次。
+
+        Args:
+            rule: 驗證規則
+            chain: 驗證器鏈名稱
+        """
+        rules = self.rule_sets.setdefault(chain, [])
+        rules[:] = [r for r in rules if r.rule_id != rule.rule_id]
+        rules.append(rule)
+        self._compiled_plans.pop(chain, None)
+        self.logger.info(f"Registered rule: {rule.rule_id} in chain: {chain}")
+
+    def get_compiled_plan(self, chain: str = "default") -> Optional[CompiledValidationPlan]:
+        """獲取 (必要時編譯) 指定鏈的單次走訪計畫：內建規則加上該鏈註冊的規則 (同 rule_id 以鏈規則為準)"""
+        chain_rules = self.rule_sets.get(chain, [])
+        if not chain_rules and not self.builtin_rules:
+            return None
+        if chain not in self._compiled_plans:
+            overridden = {r.rule_id for r in chain_rules}
+            rules = [r for r in self.builtin_rules if r.rule_id not in overridden] + chain_rules
+            self._compiled_plans[chain] = CompiledValidationPlan(
+                rules, self.sampling_config, name=f"CompiledRules[{chain}]"
+            )
+        return self._compiled_plans[chain]
+
     def unregister_validator(self, validator_name: str):
         """
         取消註冊驗證器
@@ -145,20 +190,36 @@ class ValidationEngine:
         
         # 獲取要運行的驗證器列表
         validator_names = self.validator_chains.get(validator_chain, [])
-        if not validator_names:
+        if not validator_names and not self.rule_sets.get(validator_chain):
             self.logger.warning(f"No validators found in chain: {validator_chain}")
             return self._create_empty_result(context)
+        compiled_plan = self.get_compiled_plan(validator_chain)
             
         all_results = []
         blocking_errors = []
         
         try:
-            if self.parallel_execution and len(validator_names) > 1:
+            # 編譯規則先以單次走訪執行，同一次走訪的結構快照交給後續驗證器重用；
+            # 阻斷性錯誤可提前終止其餘驗證器
+            if compiled_plan is not None:
+                context.add_validator(compiled_plan.name)
+                start = time.perf_counter()
+                snapshot = compiled_plan.collect(data)
+                context.data_snapshot = snapshot.structure
+                plan_results = compiled_plan.evaluate(snapshot, context.to_dict(),
+                                                      walk_seconds=time.perf_counter() - start)
+                all_results.extend(plan_results)
+                if self.stop_on_critical and any(r.is_blocking() for r in plan_results):
+                    validator_names = []
+
+            if not validator_names:
+                pass
+            elif self.parallel_execution and len(validator_names) > 1:
                 # 並行執行驗證器
-                all_results = self._run_validators_parallel(validator_names, data, context)
+                all_results.extend(self._run_validators_parallel(validator_names, data, context))
             else:
                 # 序列執行驗證器
-                all_results = self._run_validators_sequential(validator_names, data, context)
+                all_results.extend(self._run_validators_sequential(validator_names, data, context))
                 
         except Exception as e:
             self.logger.exception(f"Validation engine error: {e}")
@@ -171,6 +232,10 @@ class ValidationEngine:
             )
             all_results.append(error_result)
             
+        finally:
+            # 快照只對本次數據有效，避免上下文重用時誤配
+            context.data_snapshot = None
+            
         # 分析結果
         summary = self._analyze_results(all_results, context)
         
@@ -203,7 +268,7 @@ class ValidationEngine:
             context.add_validator(validator_name)
             
             try:
-                results = validator.run_validation(data, context.to_dict())
+                results = validator.run_validation(data, context.to_validator_context())
                 all_results.extend(results)
                 
                 # 檢查是否需要因嚴重錯誤而停止
@@ -272,7 +337,7 @@ class ValidationEngine:
                             context: ValidationContext) -> List[ValidationResult]:
         """運行單個驗證器（用於並行執行）"""
         context.add_validator(validator.name)
-        return validator.run_validation(data, context.to_dict())
+        return validator.run_validation(data, context.to_validator_context())
         
     def _analyze_results(self, 
                         results: List[ValidationResult], 
@@ -348,10 +413,13 @@ class ValidationEngine:
             "total_validators": len(self.validators),
             "validator_names": list(self.validators.keys()),
             "validator_chains": self.validator_chains,
+            "builtin_rules": [r.rule_id for r in self.builtin_rules],
+            "rule_sets": {chain: [r.rule_id for r in rules] for chain, rules in self.rule_sets.items()},
             "engine_config": {
                 "parallel_execution": self.parallel_execution,
                 "max_workers": self.max_workers,
-                "stop_on_critical": self.stop_on_critical
+                "stop_on_critical": self.stop_on_critical,
+                "sampling_enabled": self.sampling_config.enabled
             }
         }
         
@@ -16,6 +16,7 @@ from dataclasses import dataclass
 from collections import defaultdict
 
 from ..core.base_validator import BaseValidator, ValidationResult, ValidationStatus, ValidationLevel
+from ..core.compiled_plan import StructuralSnapshot, structural_snapshot
 from ..config.data_quality_config import (
     DataQualityConfig, QualityDimension, QualityLevel,
     get_data_quality_config
@@ -306,20 +307,23 @@ class StatisticalAnalyzer(BaseValidator):
             validation_warnings = []
             analysis_results = {}
             
+            # 所有分析共用同一次走訪的結構快照 (由驗證引擎傳入時直接重用)
+            snapshot = structural_snapshot(data, context)
+            
             # 數值欄位統計分析
-            numerical_result = self._analyze_numerical_fields(data)
+            numerical_result = self._analyze_numerical_fields(snapshot.numerical_fields)
             analysis_results['numerical_analysis'] = numerical_result
             validation_warnings.extend(numerical_result.anomalies)
             
             # 時間序列驗證
-            if self._has_time_series_data(data):
-                time_series_result = self._validate_time_series(data)
+            if self._has_time_series_data(snapshot):
+                time_series_result = self._validate_time_series(snapshot.time_series)
                 analysis_results['time_series_analysis'] = time_series_result
                 validation_errors.extend(time_series_result.get('errors', []))
                 validation_warnings.extend(time_series_result.get('warnings', []))
             
             # 相關性分析
-            correlation_result = self._analyze_correlations(data)
+            correlation_result = self._analyze_correlations(snapshot.numerical_fields)
             analysis_results['correlation_analysis'] = correlation_result
             validation_warnings.extend(correlation_result.get('warnings', []))
             
@@ -354,10 +358,8 @@ class StatisticalAnalyzer(BaseValidator):
                 metadata={'validation_type': 'statistical_analysis'}
             )
     
-    def _analyze_numerical_fields(self, data: Dict[str, Any]) -> StatisticalAnalysisResult:
+    def _analyze_numerical_fields(self, numerical_fields: Dict[str, List[float]]) -> StatisticalAnalysisResult:
         """分析數值欄位"""
-        numerical_fields = self._extract_numerical_fields(data)
-        
         if not numerical_fields:
             return StatisticalAnalysisResult(
                 total_samples=0,
@@ -421,25 +423,6 @@ class StatisticalAnalyzer(BaseValidator):
             anomalies=anomalies
         )
     
-    def _extract_numerical_fields(self, data: Dict[str, Any]) -> Dict[str, List[float]]:
-        """提取數值欄位"""
-        numerical_fields = defaultdict(list)
-        
-        def extract_from_item(item: Any, prefix: str = ''):
-            if isinstance(item, dict):
-                for key, value in item.items():
-                    field_name = f"{prefix}.{key}" if prefix else key
-                    extract_from_item(value, field_name)
-            elif isinstance(item, list):
-                for i, sub_item in enumerate(item):
-                    extract_from_item(sub_item, prefix)
-            elif isinstance(item, (int, float)) and not isinstance(item, bool):
-                if prefix:
-                    numerical_fields[prefix].append(float(item))
-        
-        extract_from_item(data)
-        return dict(numerical_fields)
-    
     def _test_normality(self, values: List[float], field_name: str) -> Dict[str, Any]:
         """正態性檢驗"""
         try:
@@ -574,19 +557,15 @@ class StatisticalAnalyzer(BaseValidator):
         
         return max(0.0, min(100.0, base_score))
     
-    def _has_time_series_data(self, data: Dict[str, Any]) -> bool:
+    def _has_time_series_data(self, snapshot: StructuralSnapshot) -> bool:
         """檢查是否包含時間序列數據"""
-        time_indicators = ['timestamp', 'time', 'datetime', 'epoch']
-        return any(indicator in str(data).lower() for indicator in time_indicators)
+        return bool(snapshot.time_series)
     
-    def _validate_time_series(self, data: Dict[str, Any]) -> Dict[str, List[str]]:
+    def _validate_time_series(self, time_series_data: Dict[str, List]) -> Dict[str, List[str]]:
         """時間序列驗證"""
         errors = []
         warnings = []
         
-        # 提取時間序列數據
-        time_series_data = self._extract_time_series(data)
-        
         if not time_series_data:
             warnings.append("No time series data found for validation")
             return {'errors': errors, 'warnings': warnings}
@@ -631,35 +610,10 @@ class StatisticalAnalyzer(BaseValidator):
         
         return {'errors': errors, 'warnings': warnings}
     
-    def _extract_time_series(self, data: Dict[str, Any]) -> Dict[str, List]:
-        """提取時間序列數據"""
-        time_series = {}
-        
-        def extract_timestamps(obj: Any, path: str = ''):
-            if isinstance(obj, dict):
-                for key, value in obj.items():
-                    current_path = f"{path}.{key}" if path else key
-                    if key.lower() in ['timestamp', 'time', 'datetime', 'epoch']:
-                        if isinstance(value, list):
-                            time_series[current_path] = value
-                        else:
-                            time_series[current_path] = [value]
-                    else:
-                        extract_timestamps(value, current_path)
-            elif isinstance(obj, list):
-                for i, item in enumerate(obj):
-                    extract_timestamps(item, path)
-        
-        extract_timestamps(data)
-        return time_series
-    
-    def _analyze_correlations(self, data: Dict[str, Any]) -> Dict[str, List[str]]:
+    def _analyze_correlations(self, numerical_fields: Dict[str, List[float]]) -> Dict[str, List[str]]:
         """相關性分析"""
         warnings = []
         
-        # 提取數值欄位進行相關性分析
-        numerical_fields = self._extract_numerical_fields(data)
-        
         if len(numerical_fields) < 2:
             warnings.append("Insufficient numerical fields for correlation analysis")
             return {'warnings': warnings}
@@ -727,8 +681,11 @@ class CrossStageConsistencyChecker(BaseValidator):
             validation_errors = []
             validation_warnings = []
             
+            # 所有檢查共用同一次走訪的結構快照 (由驗證引擎傳入時直接重用)
+            snapshot = structural_snapshot(data, context)
+            
             # 階段依賴檢查
-            dependency_result = self._check_stage_dependencies(data)
+            dependency_result = self._check_stage_dependencies(data, snapshot)
             consistency_result = ConsistencyCheckResult(
                 consistency_score=dependency_result.get('score', 0.0),
                 inconsistencies=dependency_result.get('inconsistencies', []),
@@ -741,7 +698,7 @@ class CrossStageConsistencyChecker(BaseValidator):
             validation_errors.extend(consistency_result.dependency_violations)
             
             # 數據流驗證
-            data_flow_result = self._validate_data_flow(data)
+            data_flow_result = self._validate_data_flow(data, snapshot)
             validation_errors.extend(data_flow_result.get('errors', []))
             validation_warnings.extend(data_flow_result.get('warnings', []))
             
@@ -776,7 +733,7 @@ class CrossStageConsistencyChecker(BaseValidator):
                 metadata={'validation_type': 'cross_stage_consistency'}
             )
     
-    def _check_stage_dependencies(self, data: Dict[str, Any]) -> Dict[str, Any]:
+    def _check_stage_dependencies(self, data: Dict[str, Any], snapshot: StructuralSnapshot) -> Dict[str, Any]:
         """檢查階段依賴關係"""
         errors = []
         violations = []
@@ -784,7 +741,7 @@ class CrossStageConsistencyChecker(BaseValidator):
         score = 100.0
         
         # 檢查衛星數量一致性
-        satellite_counts = self._extract_satellite_counts(data)
+        satellite_counts = self._extract_satellite_counts(data, snapshot)
         if len(set(satellite_counts.values())) > 1:
             inconsistencies.append({
                 'type': 'satellite_count_mismatch',
@@ -794,7 +751,7 @@ class CrossStageConsistencyChecker(BaseValidator):
             score -= 20
         
         # 檢查時間戳對齊
-        timestamp_alignment = self._check_timestamp_alignment(data)
+        timestamp_alignment = self._check_timestamp_alignment(snapshot)
         if not timestamp_alignment['is_aligned']:
             inconsistencies.append({
                 'type': 'timestamp_misalignment',
@@ -804,7 +761,7 @@ class CrossStageConsistencyChecker(BaseValidator):
             score -= 15
         
         # 檢查座標系統一致性
-        coordinate_consistency = self._check_coordinate_system_consistency(data)
+        coordinate_consistency = self._check_coordinate_system_consistency(snapshot)
         if not coordinate_consistency['is_consistent']:
             inconsistencies.append({
                 'type': 'coordinate_system_inconsistency',
@@ -821,7 +778,7 @@ class CrossStageConsistencyChecker(BaseValidator):
             'violations': violations
         }
     
-    def _extract_satellite_counts(self, data: Dict[str, Any]) -> Dict[str, int]:
+    def _extract_satellite_counts(self, data: Dict[str, Any], snapshot: StructuralSnapshot) -> Dict[str, int]:
         """提取各階段衛星數量"""
         counts = {}
         
@@ -840,53 +797,20 @@ class CrossStageConsistencyChecker(BaseValidator):
             elif isinstance(stage2_data, dict) and 'satellites' in stage2_data:
                 counts['stage2'] = len(stage2_data['satellites'])
         
-        # 通用方法：查找包含satellite_id的項目
-        satellite_ids = set()
-        
-        def extract_satellite_ids(obj: Any):
-            if isinstance(obj, dict):
-                if 'satellite_id' in obj:
-                    satellite_ids.add(obj['satellite_id'])
-                for value in obj.values():
-                    extract_satellite_ids(value)
-            elif isinstance(obj, list):
-                for item in obj:
-                    extract_satellite_ids(item)
-        
-        extract_satellite_ids(data)
-        if satellite_ids:
-            counts['total_unique_satellites'] = len(satellite_ids)
+        # 通用方法：包含satellite_id的項目 (抽樣快照只含部分衛星，不參與數量比對)
+        if snapshot.satellite_ids and not snapshot.sampled:
+            counts['total_unique_satellites'] = len(snapshot.satellite_ids)
         
         return counts
     
-    def _check_timestamp_alignment(self, data: Dict[str, Any]) -> Dict[str, Any]:
+    def _check_timestamp_alignment(self, snapshot: StructuralSnapshot) -> Dict[str, Any]:
         """檢查時間戳對齊"""
-        timestamps_by_stage = {}
+        timestamps_by_stage = snapshot.timestamps_by_stage
         misalignments = []
         
-        # 提取各階段時間戳
-        def extract_timestamps_by_stage(obj: Any, stage_prefix: str = ''):
-            if isinstance(obj, dict):
-                for key, value in obj.items():
-                    if 'stage' in key.lower():
-                        new_prefix = key
-                    else:
-                        new_prefix = stage_prefix
-                    
-                    if key.lower() in ['timestamp', 'time', 'datetime']:
-                        if new_prefix not in timestamps_by_stage:
-                            timestamps_by_stage[new_prefix] = []
-                        if isinstance(value, list):
-                            timestamps_by_stage[new_prefix].extend(value)
-                        else:
-                            timestamps_by_stage[new_prefix].append(value)
-                    else:
-                        extract_timestamps_by_stage(value, new_prefix)
-            elif isinstance(obj, list):
-                for item in obj:
-                    extract_timestamps_by_stage(item, stage_prefix)
-        
-        extract_timestamps_by_stage(data)
+        # 抽樣快照中各階段的樣本互不對應，重疊度無意義
+        if snapshot.sampled:
+            return {'is_aligned': True, 'misalignments': misalignments, 'skipped': 'sampled'}
         
         # 檢查時間戳對齊
         stage_keys = list(timestamps_by_stage.keys())
@@ -913,42 +837,16 @@ class CrossStageConsistencyChecker(BaseValidator):
             'misalignments': misalignments
         }
     
-    def _check_coordinate_system_consistency(self, data: Dict[str, Any]) -> Dict[str, Any]:
+    def _check_coordinate_system_consistency(self, snapshot: StructuralSnapshot) -> Dict[str, Any]:
         """檢查座標系統一致性"""
         issues = []
-        coordinate_systems = set()
-        
-        # 檢測使用的座標系統
-        def detect_coordinate_systems(obj: Any, path: str = ''):
-            if isinstance(obj, dict):
-                # ECI 座標系統檢測
-                if all(coord in obj for coord in ['x', 'y', 'z']):
-                    coordinate_systems.add('eci')
-                
-                # 經緯度座標系統檢測
-                if all(coord in obj for coord in ['latitude', 'longitude']):
-                    coordinate_systems.add('geodetic')
-                elif all(coord in obj for coord in ['lat', 'lon']):
-                    coordinate_systems.add('geodetic')
-                
-                # 方位角-仰角系統檢測
-                if all(coord in obj for coord in ['azimuth', 'elevation']):
-                    coordinate_systems.add('topocentric')
-                
-                for key, value in obj.items():
-                    new_path = f"{path}.{key}" if path else key
-                    detect_coordinate_systems(value, new_path)
-            elif isinstance(obj, list):
-                for i, item in enumerate(obj):
-                    detect_coordinate_systems(item, path)
-        
-        detect_coordinate_systems(data)
+        coordinate_systems = snapshot.coordinate_systems
         
         # 檢查座標變換一致性
         if 'eci' in coordinate_systems and 'geodetic' in coordinate_systems:
             # 驗證 ECI 到經緯度的轉換是否合理
-            eci_coords = self._extract_coordinates(data, 'eci')
-            geodetic_coords = self._extract_coordinates(data, 'geodetic')
+            eci_coords = self._extract_coordinates(snapshot, 'eci')
+            geodetic_coords = self._extract_coordinates(snapshot, 'geodetic')
             
             if eci_coords and geodetic_coords:
                 consistency_check = self._validate_coordinate_transformation(eci_coords, geodetic_coords)
@@ -961,38 +859,13 @@ class CrossStageConsistencyChecker(BaseValidator):
             'issues': issues
         }
     
-    def _extract_coordinates(self, data: Dict[str, Any], coord_type: str) -> List[Dict[str, float]]:
+    def _extract_coordinates(self, snapshot: StructuralSnapshot, coord_type: str) -> List[Dict[str, float]]:
         """提取指定類型的座標"""
-        coordinates = []
-        
-        def extract_coords(obj: Any):
-            if isinstance(obj, dict):
-                if coord_type == 'eci' and all(coord in obj for coord in ['x', 'y', 'z']):
-                    coordinates.append({
-                        'x': obj['x'],
-                        'y': obj['y'], 
-                        'z': obj['z']
-                    })
-                elif coord_type == 'geodetic':
-                    if all(coord in obj for coord in ['latitude', 'longitude']):
-                        coordinates.append({
-                            'lat': obj['latitude'],
-                            'lon': obj['longitude']
-                        })
-                    elif all(coord in obj for coord in ['lat', 'lon']):
-                        coordinates.append({
-                            'lat': obj['lat'],
-                            'lon': obj['lon']
-                        })
-                
-                for value in obj.values():
-                    extract_coords(value)
-            elif isinstance(obj, list):
-                for item in obj:
-                    extract_coords(item)
-        
-        extract_coords(data)
-        return coordinates
+        if coord_type == 'eci':
+            return snapshot.eci_coordinates
+        if coord_type == 'geodetic':
+            return snapshot.geodetic_coordinates
+        return []
     
     def _validate_coordinate_transformation(self, eci_coords: List[Dict], geodetic_coords: List[Dict]) -> Dict[str, Any]:
         """驗證座標變換一致性"""
@@ -1025,13 +898,13 @@ class CrossStageConsistencyChecker(BaseValidator):
             'issues': issues
         }
     
-    def _validate_data_flow(self, data: Dict[str, Any]) -> Dict[str, List[str]]:
+    def _validate_data_flow(self, data: Dict[str, Any], snapshot: StructuralSnapshot) -> Dict[str, List[str]]:
         """驗證數據流完整性"""
         errors = []
         warnings = []
         
         # 檢查輸入輸出映射
-        input_output_mapping = self._check_input_output_mapping(data)
+        input_output_mapping = self._check_input_output_mapping(snapshot)
         errors.extend(input_output_mapping.get('errors', []))
         warnings.extend(input_output_mapping.get('warnings', []))
         
@@ -1042,45 +915,26 @@ class CrossStageConsistencyChecker(BaseValidator):
         
         return {'errors': errors, 'warnings': warnings}
     
-    def _check_input_output_mapping(self, data: Dict[str, Any]) -> Dict[str, List[str]]:
+    def _check_input_output_mapping(self, snapshot: StructuralSnapshot) -> Dict[str, List[str]]:
         """檢查輸入輸出映射"""
         errors = []
         warnings = []
         
         # 檢查衛星識別符保持
         if self.consistency_rules['stage_dependencies']['stage1_to_stage2']['satellite_count_consistency']:
-            satellite_ids_preservation = self._check_satellite_id_preservation(data)
+            satellite_ids_preservation = self._check_satellite_id_preservation(snapshot)
             if not satellite_ids_preservation['preserved']:
                 errors.append("Satellite identifiers not preserved across stages")
         
         return {'errors': errors, 'warnings': warnings}
     
-    def _check_satellite_id_preservation(self, data: Dict[str, Any]) -> Dict[str, bool]:
+    def _check_satellite_id_preservation(self, snapshot: StructuralSnapshot) -> Dict[str, bool]:
         """檢查衛星ID保持"""
         # 簡化實現：檢查不同階段是否有相同的衛星ID集合
-        stage_satellite_ids = {}
-        
-        def extract_stage_satellite_ids(obj: Any, current_stage: str = ''):
-            if isinstance(obj, dict):
-                if 'satellite_id' in obj:
-                    if current_stage not in stage_satellite_ids:
-                        stage_satellite_ids[current_stage] = set()
-                    stage_satellite_ids[current_stage].add(obj['satellite_id'])
-                
-                for key, value in obj.items():
-                    if 'stage' in key.lower():
-                        new_stage = key
-                    else:
-                        new_stage = current_stage
-                    extract_stage_satellite_ids(value, new_stage)
-            elif isinstance(obj, list):
-                for item in obj:
-                    extract_stage_satellite_ids(item, current_stage)
-        
-        extract_stage_satellite_ids(data)
-        
-        # 檢查ID集合是否一致
-        if len(stage_satellite_ids) > 1:
+        stage_satellite_ids = snapshot.stage_satellite_ids
+        
+        # 檢查ID集合是否一致 (抽樣快照的各階段集合只是樣本，無法比對)
+        if len(stage_satellite_ids) > 1 and not snapshot.sampled:
             id_sets = list(stage_satellite_ids.values())
             all_same = all(id_set == id_sets[0] for id_set in id_sets)
             return {'preserved': all_same}
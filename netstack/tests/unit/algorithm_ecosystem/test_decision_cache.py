@@ -0,0 +1,171 @@
+"""
+量化決策緩存測試 (鍵量化、LRU 淘汰、可見性失效、抽樣驗證與命中副本)
+"""
+
+import sys
+import types
+from datetime import datetime, timedelta
+from pathlib import Path
+
+import pytest
+
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+if "netstack_api" not in sys.modules:
+    _package = types.ModuleType("netstack_api")
+    _package.__path__ = [str(_API_ROOT)]
+    sys.modules["netstack_api"] = _package
+
+from netstack_api.algorithm_ecosystem.decision_cache import (  # noqa: E402
+    DecisionCacheConfig, QuantizedDecisionCache,
+)
+from netstack_api.algorithm_ecosystem.interfaces import (  # noqa: E402
+    GeoCoordinate, HandoverContext, HandoverDecision, HandoverDecisionType, SatelliteInfo, SignalMetrics,
+)
+
+
+def _context(ue_id="ue_1", lat=24.9441, lon=121.3713, serving_rsrp=-100.0, candidates=None):
+    candidates = candidates or {"sat_a": -95.0, "sat_b": -105.0, "sat_c": -99.0, "sat_d": -120.0}
+    satellites = [
+        SatelliteInfo(sat_id, GeoCoordinate(25.0 + i, 121.0 + i, 550_000.0),
+                      signal_metrics=SignalMetrics(rsrp=rsrp, rsrq=-10, sinr=10))
+        for i, (sat_id, rsrp) in enumerate(sorted(candidates.items()))
+    ]
+    satellites.append(SatelliteInfo("sat_serving", GeoCoordinate(24.0, 121.0, 550_000.0)))
+    return HandoverContext(
+        ue_id=ue_id, current_satellite="sat_serving", ue_location=GeoCoordinate(lat, lon),
+        ue_velocity=None, current_signal_metrics=SignalMetrics(rsrp=serving_rsrp, rsrq=-10, sinr=10),
+        candidate_satellites=satellites, network_state={}, timestamp=datetime(2025, 9, 21),
+    )
+
+
+def _decision(target="sat_a", ue_id="ue_1", timing=None):
+    return HandoverDecision(
+        target_satellite=target, handover_decision=HandoverDecisionType.IMMEDIATE_HANDOVER,
+        confidence=0.9, timing=timing, decision_reason="test", algorithm_name="test",
+        decision_time=12.5, metadata={"ue_id": ue_id, "score": 3.0},
+    )
+
+
+@pytest.mark.unit
+class TestKeyQuantization:
+
+    def test_nearby_ues_with_similar_signals_share_a_key(self):
+        cache = QuantizedDecisionCache()
+        # 同一 0.01° 網格、RSRP 同一 3 dB 分桶
+        a = _context("ue_1", lat=24.9441, lon=121.3713, serving_rsrp=-100.0)
+        b = _context("ue_2", lat=24.9449, lon=121.3719, serving_rsrp=-101.5,
+                     candidates={"sat_a": -94.5, "sat_b": -104.0, "sat_c": -98.0, "sat_d": -119.0})
+        assert cache.key_for(a) == cache.key_for(b)
+
+    def test_key_changes_across_buckets(self):
+        cache = QuantizedDecisionCache()
+        base = cache.key_for(_context())
+        assert cache.key_for(_context(lat=24.9541)) != base                     # 相鄰網格
+        assert cache.key_for(_context(serving_rsrp=-95.0)) != base              # 服務 RSRP 分桶
+        assert cache.key_for(_context(candidates={"sat_a": -95.0, "sat_b": -90.0,
+                                                  "sat_c": -99.0, "sat_d": -120.0})) != base
+
+    def test_only_top_candidates_by_rsrp_enter_the_key(self):
+        cache = QuantizedDecisionCache(DecisionCacheConfig(top_candidates=3))
+        _, _, _, _, candidates = cache.key_for(_context())
+        assert [sat_id for sat_id, _, _ in candidates] == ["sat_a", "sat_c", "sat_b"]
+        # 第四顆候選的變化不影響鍵
+        weaker = _context(candidates={"sat_a": -95.0, "sat_b": -105.0, "sat_c": -99.0, "sat_d": -130.0})
+        assert cache.key_for(weaker) == cache.key_for(_context())
+
+
+@pytest.mark.unit
+class TestStorage:
+
+    def test_lru_eviction_keeps_recently_used_entries(self):
+        cache = QuantizedDecisionCache(DecisionCacheConfig(max_entries=2))
+        first, second, third = (_context(lat=10.0 + i) for i in range(3))
+        cache.put(first, _decision())
+        cache.put(second, _decision())
+        assert cache.get(first) is not None           # first 成為最近使用
+        cache.put(third, _decision())
+
+        assert len(cache) == 2
+        assert cache.get(second) is None
+        assert cache.get(first) is not None and cache.get(third) is not None
+        assert cache.get_stats()["evictions"] == 1
+
+    def test_update_visible_satellites_invalidates_departed_satellites(self):
+        cache = QuantizedDecisionCache()
+        via_a = _context(lat=10.0)                                   # 前三候選 sat_a / sat_c / sat_b
+        via_d = _context(lat=20.0, candidates={"sat_d": -90.0})
+        cache.put(via_a, _decision("sat_a"))
+        cache.put(via_d, _decision("sat_d"))
+        everything = {"sat_serving", "sat_a", "sat_b", "sat_c", "sat_d"}
+        assert cache.update_visible_satellites(everything) == 0
+
+        assert cache.update_visible_satellites(everything - {"sat_a"}) == 1
+        assert cache.get(via_a) is None
+        assert cache.get(via_d) is not None
+        assert cache.get_stats()["invalidations"] == 1
+
+        # 已不可見衛星的決策不寫入
+        cache.put(via_a, _decision("sat_a"))
+        assert cache.get(via_a) is None
+
+    def test_ttl_expiry(self, monkeypatch):
+        import netstack_api.algorithm_ecosystem.decision_cache as module
+        now = [1000.0]
+        monkeypatch.setattr(module.time, "monotonic", lambda: now[0])
+        cache = QuantizedDecisionCache(DecisionCacheConfig(ttl_seconds=5.0))
+        cache.put(_context(), _decision())
+        now[0] += 4.9
+        assert cache.get(_context()) is not None
+        now[0] += 0.2
+        assert cache.get(_context()) is None
+        assert cache.get_stats()["expirations"] == 1
+
+
+@pytest.mark.unit
+class TestValidationSampling:
+
+    def test_should_validate_every_nth_hit(self):
+        cache = QuantizedDecisionCache(DecisionCacheConfig(validation_interval=4))
+        cache.put(_context(), _decision())
+        sampled = []
+        for _ in range(12):
+            cache.get(_context())
+            sampled.append(cache.should_validate())
+        assert sampled.count(True) == 3
+        assert [i for i, s in enumerate(sampled) if s] == [3, 7, 11]
+
+    def test_validation_disabled_by_default(self):
+        cache = QuantizedDecisionCache()
+        cache.put(_context(), _decision())
+        cache.get(_context())
+        assert not cache.should_validate()
+
+    def test_agreement_rate(self):
+        cache = QuantizedDecisionCache()
+        assert cache.record_validation(_decision("sat_a"), _decision("sat_a"))
+        assert not cache.record_validation(_decision("sat_a"), _decision("sat_c"))
+        assert cache.get_stats()["agreement_rate"] == pytest.approx(0.5)
+
+
+@pytest.mark.unit
+def test_hit_returns_a_copy_without_per_ue_fields(monkeypatch):
+    import netstack_api.algorithm_ecosystem.decision_cache as module
+    now = [1000.0]
+    monkeypatch.setattr(module.time, "monotonic", lambda: now[0])
+    cache = QuantizedDecisionCache()
+    timing = datetime(2025, 9, 21, 12, 0, 0)
+    original = _decision(ue_id="ue_1", timing=timing)
+    cache.put(_context("ue_1"), original)
+    original.metadata["score"] = -1.0             # 呼叫端事後修改不影響緩存
+
+    now[0] += 2.0
+    hit = cache.get(_context("ue_2"))
+    assert hit is not original
+    assert hit.target_satellite == "sat_a" and hit.confidence == 0.9
+    assert "ue_id" not in hit.metadata
+    assert hit.metadata["score"] == 3.0 and hit.metadata["cache_hit"] is True
+    assert hit.decision_time == 0.0
+    assert hit.timing == timing + timedelta(seconds=2.0)
+
+    hit.metadata["score"] = 99.0                    # 命中副本彼此獨立
+    assert cache.get(_context("ue_3")).metadata["score"] == 3.0
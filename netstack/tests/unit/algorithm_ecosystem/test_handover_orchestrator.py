@@ -0,0 +1,193 @@
+"""
+換手協調器測試 (套件可匯入、批次與單筆決策一致、微批次合併、集成投票與決策緩存)
+"""
+
+import asyncio
+import sys
+import types
+from datetime import datetime
+from pathlib import Path
+
+import pytest
+
+# 只以輕量套件登記 netstack_api，algorithm_ecosystem 走真實的套件初始化
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+if "netstack_api" not in sys.modules:
+    _package = types.ModuleType("netstack_api")
+    _package.__path__ = [str(_API_ROOT)]
+    sys.modules["netstack_api"] = _package
+
+import netstack_api.algorithm_ecosystem as ecosystem  # noqa: E402
+from netstack_api.algorithm_ecosystem.interfaces import (  # noqa: E402
+    AlgorithmInfo, AlgorithmType, GeoCoordinate, HandoverAlgorithm, HandoverContext,
+    HandoverDecision, HandoverDecisionType, SatelliteInfo, SignalMetrics,
+)
+from netstack_api.algorithm_ecosystem.orchestrator import (  # noqa: E402
+    HandoverOrchestrator, OrchestratorConfig, OrchestratorMode,
+)
+
+
+class StrongestCandidate(HandoverAlgorithm):
+    """候選 RSRP 高於服務衛星 margin_db 時換手到最強候選，記錄每次批次呼叫的大小"""
+
+    def __init__(self, name="strongest", margin_db=3.0, confidence=0.8):
+        super().__init__(name)
+        self.margin_db = margin_db
+        self.confidence = confidence
+        self.batch_sizes = []
+        self.single_calls = 0
+
+    def _decide(self, context):
+        best = max(context.candidate_satellites, key=lambda sat: sat.signal_metrics.rsrp)
+        handover = best.signal_metrics.rsrp > context.current_signal_metrics.rsrp + self.margin_db
+        return HandoverDecision(
+            target_satellite=best.satellite_id if handover else None,
+            handover_decision=(HandoverDecisionType.IMMEDIATE_HANDOVER if handover
+                               else HandoverDecisionType.NO_HANDOVER),
+            confidence=self.confidence, timing=None, decision_reason="rsrp_margin",
+            algorithm_name=self.name, decision_time=0.0, metadata={"ue_id": context.ue_id},
+        )
+
+    async def predict_handover(self, context):
+        self.single_calls += 1
+        return self._decide(context)
+
+    async def predict_handover_batch(self, contexts):
+        self.batch_sizes.append(len(contexts))
+        return [self._decide(context) for context in contexts]
+
+    def get_algorithm_info(self):
+        return AlgorithmInfo(self.name, "1.0", AlgorithmType.HEURISTIC, "test", {})
+
+
+def _context(i, serving_rsrp=-100.0):
+    candidates = [
+        SatelliteInfo(f"sat_{j}", GeoCoordinate(24.0 + j, 121.0, 550_000.0),
+                      signal_metrics=SignalMetrics(rsrp=-110.0 + ((i * 7 + j * 3) % 20), rsrq=-10, sinr=10))
+        for j in range(4)
+    ]
+    return HandoverContext(
+        ue_id=f"ue_{i}", current_satellite="sat_0",
+        ue_location=GeoCoordinate(24.0 + i * 0.5, 121.0 + i * 0.5),
+        ue_velocity=None,
+        current_signal_metrics=SignalMetrics(rsrp=serving_rsrp, rsrq=-10, sinr=10),
+        candidate_satellites=candidates, network_state={}, timestamp=datetime(2025, 9, 21),
+    )
+
+
+async def _orchestrator(algorithms, **config):
+    registry = ecosystem.AlgorithmRegistry()
+    for priority, algorithm in enumerate(algorithms):
+        await registry.register_algorithm(algorithm.name, algorithm, priority=priority)
+    environment = ecosystem.EnvironmentManager()
+    await environment.initialize()
+    orchestrator = HandoverOrchestrator(registry, environment, OrchestratorConfig(**config))
+    await orchestrator.initialize()
+    return orchestrator
+
+
+def _summary(decision):
+    return decision.handover_decision, decision.target_satellite, decision.algorithm_name
+
+
+@pytest.mark.unit
+def test_package_exports_real_orchestrator():
+    assert ecosystem.ORCHESTRATOR_AVAILABLE
+    assert ecosystem.HandoverOrchestrator is HandoverOrchestrator
+    assert OrchestratorConfig(mode="ensemble").mode is OrchestratorMode.ENSEMBLE
+
+
+@pytest.mark.unit
+def test_batch_matches_single_decisions():
+    contexts = [_context(i) for i in range(20)]
+
+    async def run():
+        algorithm = StrongestCandidate()
+        orchestrator = await _orchestrator([algorithm], default_algorithm="strongest", enable_caching=False)
+        batch = await orchestrator.predict_handover_batch(contexts)
+        single = [await orchestrator.predict_handover(c) for c in contexts]
+        return algorithm, orchestrator, batch, single
+
+    algorithm, orchestrator, batch, single = asyncio.run(run())
+    assert [_summary(d) for d in batch] == [_summary(d) for d in single]
+    assert [d.metadata["ue_id"] for d in batch] == [c.ue_id for c in contexts]
+    assert {d.handover_decision for d in batch} == set(HandoverDecisionType) - {HandoverDecisionType.PREPARE_HANDOVER}
+    # 整批只呼叫一次算法批次推論，指標每批寫入一次
+    assert algorithm.batch_sizes == [20]
+    assert algorithm.single_calls == 20
+    metrics = orchestrator.get_orchestrator_stats()
+    assert metrics["batch_metrics"]["strongest"]["batches"] == 1
+    assert metrics["batch_metrics"]["strongest"]["decisions"] == 20
+    assert metrics["algorithm_stats"]["strongest"]["total_requests"] == 40
+
+
+@pytest.mark.unit
+def test_micro_batcher_coalesces_concurrent_requests():
+    contexts = [_context(i) for i in range(10)]
+
+    async def run():
+        algorithm = StrongestCandidate()
+        orchestrator = await _orchestrator(
+            [algorithm], default_algorithm="strongest", enable_caching=False,
+            enable_micro_batching=True, batch_window_ms=20.0, max_batch_size=4,
+        )
+        decisions = await asyncio.gather(*(orchestrator.predict_handover(c) for c in contexts))
+        await orchestrator.cleanup()
+        return algorithm, orchestrator, decisions
+
+    algorithm, orchestrator, decisions = asyncio.run(run())
+    reference = StrongestCandidate()
+    assert [_summary(d) for d in decisions] == [_summary(reference._decide(c)) for c in contexts]
+    # max_batch_size 滿即送出，剩餘請求在視窗到期時合併
+    assert algorithm.batch_sizes == [4, 4, 2]
+    assert algorithm.single_calls == 0
+    stats = orchestrator.get_orchestrator_stats()["micro_batching"]
+    assert stats["batches"] == 3 and stats["decisions"] == 10 and stats["pending"] == 0
+
+
+@pytest.mark.unit
+def test_cached_decisions_skip_the_algorithm():
+    contexts = [_context(i) for i in range(8)]
+
+    async def run():
+        algorithm = StrongestCandidate()
+        orchestrator = await _orchestrator([algorithm], default_algorithm="strongest")
+        first = await orchestrator.predict_handover_batch(contexts)
+        second = await orchestrator.predict_handover_batch(contexts)
+        return algorithm, orchestrator, first, second
+
+    algorithm, orchestrator, first, second = asyncio.run(run())
+    assert [_summary(d) for d in first] == [_summary(d) for d in second]
+    assert algorithm.batch_sizes == [8]
+    assert orchestrator.get_orchestrator_stats()["decision_cache"]["hits"] == 8
+
+
+@pytest.mark.unit
+def test_ensemble_batch_votes_across_members():
+    contexts = [_context(i) for i in range(12)]
+
+    async def run():
+        eager = StrongestCandidate("eager", margin_db=0.0, confidence=0.6)
+        cautious = StrongestCandidate("cautious", margin_db=10.0, confidence=0.5)
+        steady = StrongestCandidate("steady", margin_db=10.0, confidence=0.5)
+        orchestrator = await _orchestrator(
+            [eager, cautious, steady], mode="ensemble", enable_caching=False,
+            ensemble_config={"algorithms": ["eager", "cautious", "steady"]},
+        )
+        batch = await orchestrator.predict_handover_batch(contexts)
+        single = [await orchestrator.predict_handover(c) for c in contexts]
+        return eager, batch, single
+
+    eager, batch, single = asyncio.run(run())
+    assert [_summary(d) for d in batch] == [_summary(d) for d in single]
+    assert all(d.algorithm_name == "ensemble" for d in batch)
+    assert eager.batch_sizes[0] == 12
+    disagreements = 0
+    for decision in batch:
+        votes = decision.metadata["ensemble_votes"]
+        assert set(votes) == {"eager", "cautious", "steady"}
+        # 兩個保守成員 (0.5 + 0.5) 勝過單一積極成員 (0.6)
+        if votes["eager"] != votes["cautious"]:
+            disagreements += 1
+            assert decision.handover_decision.name == votes["cautious"]
+    assert disagreements > 0
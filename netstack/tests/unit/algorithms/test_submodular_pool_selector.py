@@ -0,0 +1,99 @@
+"""
+次模衛星池選擇器測試 (CELF 與逐步全掃描的標準貪婪選出相同序列)
+"""
+
+import importlib.util
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+_MODULE_PATH = (Path(__file__).parent.parent.parent.parent / "src" / "legacy_processors_archive"
+                / "algorithms" / "submodular_pool_selector.py")
+_spec = importlib.util.spec_from_file_location("submodular_pool_selector", _MODULE_PATH)
+sps = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(sps)
+
+MA_BINS, RAAN_BINS = 6, 4
+
+
+def _selector(seed, candidates=80, times=120, pool_size=24, coverage_target=3):
+    """隨機可見窗口；複製部分候選使邊際增益出現同分"""
+    rng = np.random.default_rng(seed)
+    visibility = np.zeros((candidates, times), dtype=bool)
+    for row in visibility:
+        for _ in range(int(rng.integers(0, 4))):
+            start = int(rng.integers(0, times))
+            row[start:start + int(rng.integers(5, 40))] = True
+    ma_bins = rng.integers(0, MA_BINS, candidates)
+    raan_bins = rng.integers(0, RAAN_BINS, candidates)
+    for source, target in zip(range(0, candidates, 9), range(4, candidates, 9)):
+        visibility[target] = visibility[source]
+        ma_bins[target], raan_bins[target] = ma_bins[source], raan_bins[source]
+    return sps.LazyGreedyPoolSelector(visibility, coverage_target, ma_bins, raan_bins,
+                                      MA_BINS, RAAN_BINS, pool_size)
+
+
+def _plain_greedy(selector, size, initial=(), min_gain=-1.0, coverage_only=False):
+    """每一步重新計算所有候選的邊際增益，取最大者 (同分取索引最小者)"""
+    for index in initial:
+        if index not in selector._selected_set:
+            selector.add(index)
+    while len(selector.selected) < size:
+        remaining = [i for i in range(selector.n_candidates) if i not in selector._selected_set]
+        if not remaining:
+            break
+        gains = [selector.marginal_gain(i, coverage_only) for i in remaining]
+        best = max(range(len(remaining)), key=gains.__getitem__)
+        if gains[best] <= min_gain:
+            break
+        selector.add(remaining[best])
+    return list(selector.selected)
+
+
+def _objective(selector, selected):
+    """由選出集合直接計算 f(S)"""
+    selected = list(selected)
+    counts = np.zeros(selector.n_times, dtype=np.int64)
+    for index in selected:
+        counts[selector.visible_steps[index]] += 1
+    ma = np.bincount(selector.ma_bins[selected], minlength=MA_BINS)
+    raan = np.bincount(selector.raan_bins[selected], minlength=RAAN_BINS)
+    return (selector.coverage_unit * np.minimum(counts, selector.coverage_target).sum()
+            + selector.ma_unit * np.minimum(ma, selector.ma_cap).sum()
+            + selector.raan_unit * np.minimum(raan, selector.raan_cap).sum()
+            + selector.modular_gain[selected].sum())
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("seed", [0, 3, 17, 42])
+def test_celf_matches_plain_greedy(seed):
+    lazy, eager = _selector(seed), _selector(seed)
+
+    selected = lazy.select(24)
+    assert selected == _plain_greedy(eager, 24)
+    assert len(set(selected)) == 24
+    assert lazy.value == pytest.approx(eager.value, abs=1e-12)
+    assert lazy.value == pytest.approx(_objective(lazy, selected), abs=1e-12)
+    # 惰性更新省下大部分邊際增益計算
+    assert lazy.statistics['gain_evaluations'] < eager.statistics['gain_evaluations'] / 2
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("seed", [1, 8])
+def test_celf_matches_plain_greedy_for_coverage_supplement(seed):
+    # 補充覆蓋空隙的用法：沿用已選集合、只看覆蓋增益、增益為 0 時停止
+    initial = [2, 11, 30, 57]
+    lazy, eager = _selector(seed, coverage_target=2), _selector(seed, coverage_target=2)
+
+    selected = lazy.select(40, initial=initial, min_gain=0.0, coverage_only=True)
+    assert selected == _plain_greedy(eager, 40, initial=initial, min_gain=0.0, coverage_only=True)
+    assert selected[:len(initial)] == initial
+    assert lazy.value == pytest.approx(_objective(lazy, selected), abs=1e-12)
+
+
+@pytest.mark.unit
+def test_selection_stops_when_candidates_run_out():
+    lazy, eager = _selector(5, candidates=10), _selector(5, candidates=10)
+    assert lazy.select(24) == _plain_greedy(eager, 24)
+    assert sorted(lazy.selected) == list(range(10))
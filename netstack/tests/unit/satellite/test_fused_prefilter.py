@@ -0,0 +1,140 @@
+"""
+融合預篩選核心測試 (遮罩、地理/換手評分、排序與 RSRP 和逐模組篩選鏈一致)
+"""
+
+import copy
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 只以輕量套件登記篩選目錄，避免 services.satellite / shared_core 初始化時載入重依賴
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.insert(0, str(_SRC))
+for _name in ("shared_core", "services", "services.satellite", "services.satellite.intelligent_filtering"):
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_SRC.joinpath(*_name.split(".")))]
+        sys.modules[_name] = _package
+
+from services.satellite.intelligent_filtering import fused_prefilter  # noqa: E402
+from services.satellite.intelligent_filtering.geographic_filter import GeographicFilter  # noqa: E402
+from services.satellite.intelligent_filtering.handover_scorer import HandoverScorer  # noqa: E402
+from services.satellite.intelligent_filtering.rsrp_calculator import RSRPCalculator  # noqa: E402
+
+
+def _satellite(rng, constellation, index):
+    """隨機軌道與可見弧段；部分衛星故意落在傾角/高度/時間序列檢查之外"""
+    if constellation == "starlink":
+        inclination = float(rng.choice([53.0, 53.2, 43.0, 70.0, 97.6, 20.0]))
+        altitude = float(rng.choice([550.0, 540.0, 610.0, 340.0, 150.0]))
+    else:
+        inclination = float(rng.choice([87.9, 86.4, 84.0, 72.0]))
+        altitude = float(rng.choice([1200.0, 1150.0, 1320.0, 2100.0]))
+    points = int(rng.integers(0, 60)) if index % 7 else 0
+    # 正弦過境加擾動，峰值散佈在門檻上下
+    peak = rng.uniform(-5.0, 70.0)
+    phase = rng.uniform(0, 2 * np.pi)
+    elevation = peak * np.sin(np.linspace(0, 3 * np.pi, points) + phase) + rng.normal(0, 2.0, points)
+    return {
+        "satellite_id": f"{constellation}_{index}",
+        "constellation": constellation,
+        "orbit_data": {"inclination": inclination, "altitude": altitude,
+                       "eccentricity": float(rng.choice([0.0001, 0.003, 0.02]))},
+        "timeseries": [{"elevation_deg": float(e), "time_offset_seconds": 30.0 * k}
+                       for k, e in enumerate(elevation)],
+    }
+
+
+def _constellation_data(seed=8, count=60):
+    rng = np.random.default_rng(seed)
+    data = {name: [_satellite(rng, name, i) for i in range(count)] for name in ("starlink", "oneweb")}
+    # 完全相同的衛星評分相同，用來確認同分時保持輸入順序
+    for sats in data.values():
+        twin = copy.deepcopy(sats[1])
+        twin["satellite_id"] += "_twin"
+        sats.insert(5, twin)
+    return data
+
+
+@pytest.fixture
+def modules():
+    return GeographicFilter(), HandoverScorer(), RSRPCalculator()
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("seed", [8, 21])
+def test_fused_matches_module_chain(modules, seed):
+    geographic_filter, handover_scorer, rsrp_calculator = modules
+    data = _constellation_data(seed)
+
+    legacy_geo = geographic_filter.apply_geographic_filtering(copy.deepcopy(data))
+    legacy_scored = handover_scorer.apply_handover_scoring(copy.deepcopy(legacy_geo))
+
+    kernel = fused_prefilter.create_fused_prefilter_kernel(geographic_filter, handover_scorer, rsrp_calculator)
+    columns = fused_prefilter.SatelliteColumns.from_constellation_data(data)
+    result = kernel.evaluate(columns)
+    rows = {sat_id: row for row, sat_id in enumerate(columns.satellite_ids)}
+
+    # 遮罩：通過地理篩選的集合與輸入順序
+    passed = [columns.satellite_ids[row] for row in np.flatnonzero(result.mask)]
+    assert passed == [sat["satellite_id"] for name in data for sat in legacy_geo[name]]
+    assert 0 < result.passed < len(columns)
+
+    for name in data:
+        # 地理相關性評分
+        for sat in legacy_geo[name]:
+            assert result.geo_score[rows[sat["satellite_id"]]] == pytest.approx(
+                sat["geographic_relevance_score"], abs=1e-9)
+
+        # 換手評分與排序 (同分保持輸入順序)
+        ranked = result.ranked_indices(columns.group_code, fused_prefilter.CONSTELLATION_CODES[name])
+        assert [columns.satellite_ids[row] for row in ranked] == [sat["satellite_id"] for sat in legacy_scored[name]]
+        for sat in legacy_scored[name]:
+            assert result.score[rows[sat["satellite_id"]]] == pytest.approx(
+                sat["handover_suitability_score"], abs=1e-9)
+
+        # 峰值仰角 RSRP
+        for sat in legacy_geo[name]:
+            row = rows[sat["satellite_id"]]
+            expected = rsrp_calculator.calculate_rsrp(sat, float(result.peak_elevation[row]))
+            assert result.rsrp_peak_dbm[row] == pytest.approx(expected, abs=1e-9)
+
+    # 未通過者評分為 0、RSRP 為 NaN
+    rejected = ~result.mask
+    assert not result.score[rejected].any() and not result.geo_score[rejected].any()
+    assert np.isnan(result.rsrp_peak_dbm[rejected]).all()
+
+
+@pytest.mark.unit
+def test_twin_satellites_keep_input_order(modules):
+    data = _constellation_data()
+    kernel = fused_prefilter.create_fused_prefilter_kernel(*modules)
+    columns = fused_prefilter.SatelliteColumns.from_constellation_data(data)
+    result = kernel.evaluate(columns)
+
+    compared = 0
+    for name in data:
+        original, twin = data[name][1]["satellite_id"], data[name][5]["satellite_id"]
+        ranked = [columns.satellite_ids[row] for row in
+                  result.ranked_indices(columns.group_code, fused_prefilter.CONSTELLATION_CODES[name])]
+        if original in ranked:
+            assert ranked.index(twin) == ranked.index(original) + 1
+            compared += 1
+    assert compared
+
+
+@pytest.mark.unit
+def test_peak_phase_filter_only_narrows_mask(modules):
+    data = _constellation_data()
+    columns = fused_prefilter.SatelliteColumns.from_constellation_data(data)
+    baseline = fused_prefilter.create_fused_prefilter_kernel(*modules).evaluate(columns)
+    narrowed = fused_prefilter.create_fused_prefilter_kernel(*modules, min_peak_phase="pre_handover").evaluate(columns)
+
+    assert not (narrowed.mask & ~baseline.mask).any()
+    # 峰值處於 pre_handover 階段以內 = 峰值仰角達執行門檻
+    expected = baseline.mask & (baseline.peak_elevation >= narrowed.thresholds["execution"])
+    np.testing.assert_array_equal(narrowed.mask, expected)
+    np.testing.assert_array_equal(narrowed.score[narrowed.mask], baseline.score[narrowed.mask])
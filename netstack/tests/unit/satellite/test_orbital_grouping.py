@@ -0,0 +1,69 @@
+"""
+軌道平面分群器相位空洞填補測試 (填補衛星以完整軌道元素加入索引)
+"""
+
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 只以輕量套件登記預處理目錄，避免 services.satellite 初始化時載入 TLE 下載器
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.insert(0, str(_SRC))
+for _name in ("services", "services.satellite", "services.satellite.preprocessing"):
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_SRC.joinpath(*_name.split(".")))]
+        sys.modules[_name] = _package
+
+from services.satellite.preprocessing import orbital_grouping  # noqa: E402
+
+
+def _walker(planes, per_plane, prefix="sat"):
+    return [
+        {'satellite_id': f"{prefix}_{p}_{s}", 'raan': p * 360.0 / planes,
+         'mean_anomaly': s * 360.0 / per_plane, 'argument_of_perigee': 0.0,
+         'mean_motion': 15.05, 'inclination': 53.0}
+        for p in range(planes) for s in range(per_plane)
+    ]
+
+
+@pytest.mark.unit
+def test_phase_space_index_is_available():
+    assert orbital_grouping.PHASE_SPACE_INDEX_AVAILABLE
+    assert orbital_grouping.PHASE_SPACE_INDEX_ERROR is None
+
+
+@pytest.mark.unit
+def test_filled_satellites_move_with_the_index(monkeypatch):
+    grouper = orbital_grouping.OrbitalPlaneGrouper()
+    selected = [s for s in _walker(6, 6) if not s['satellite_id'].startswith("sat_2_")]
+    candidates = _walker(12, 6, prefix="cand")
+    built = []
+    original = grouper.build_phase_space_index
+
+    def capture(satellites, *args, **kwargs):
+        index = original(satellites, *args, **kwargs)
+        built.append(index)
+        return index
+
+    monkeypatch.setattr(grouper, "build_phase_space_index", capture)
+    fills = grouper.find_phase_gaps(selected, candidates, max_fills=3)
+
+    assert len(fills) == 3
+    selected_index = built[0]
+    by_id = {c['satellite_id']: c for c in candidates}
+    filled = [by_id[f['fill_satellite_id']] for f in fills]
+    for sat in filled:
+        pos = selected_index._position[sat['satellite_id']]
+        assert selected_index.phase_rate[pos] > 0
+        assert selected_index.raan_rate[pos] < 0
+
+    # 推進後與重新以完整元素建立的索引一致
+    fresh = orbital_grouping.PhaseSpaceIndex.from_orbital_elements(selected + filled)
+    for _ in range(5):
+        selected_index.advance(120.0)
+        fresh.advance(120.0)
+    np.testing.assert_array_equal(selected_index.counts, fresh.counts)
@@ -0,0 +1,143 @@
+"""
+無縫循環建構器測試 (Hermite 過渡端點連續、經度跨換日線、循環點選擇)
+"""
+
+import sys
+import types
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 只以輕量套件登記衛星服務目錄，避免 services.satellite 初始化時載入 TLE 下載器
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.insert(0, str(_SRC))
+for _name in ("services", "services.satellite"):
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_SRC.joinpath(*_name.split(".")))]
+        sys.modules[_name] = _package
+
+from services.satellite import seamless_loop_builder as slb  # noqa: E402
+
+T0 = datetime(2025, 1, 1, tzinfo=timezone.utc)
+FIELD = {name: k for k, name in enumerate(slb.FRAME_FIELDS)}
+
+
+def _frames(data, step_seconds=60.0):
+    timestamps = [T0 + timedelta(seconds=step_seconds * k) for k in range(data.shape[0])]
+    return slb.FrameArray(timestamps, [f"sat_{s}" for s in range(data.shape[1])], data, step_seconds)
+
+
+def _periodic(total, period_frames, satellites=4):
+    """週期為 period_frames 幀的圓軌道星下點 (緯度/經度/高度) 與固定可見仰角"""
+    data = np.zeros((total, satellites, len(slb.FRAME_FIELDS)), dtype=np.float64)
+    t = np.arange(total)[:, None]
+    phase = np.linspace(0, 2 * np.pi, satellites, endpoint=False)[None, :]
+    angle = 2 * np.pi * t / period_frames + phase
+    data[..., FIELD["lat"]] = 53.0 * np.sin(angle)
+    data[..., FIELD["lon"]] = np.degrees(np.arctan2(np.sin(angle) * 0.6, np.cos(angle)))
+    data[..., FIELD["alt"]] = 550.0
+    data[..., FIELD["elevation"]] = 30.0
+    data[..., FIELD["azimuth"]] = 90.0
+    data[..., FIELD["distance"]] = 900.0
+    data[..., FIELD["rsrp"]] = -95.0
+    return data
+
+
+@pytest.mark.unit
+class TestHermiteTransition:
+
+    def test_consistent_slopes_give_evenly_spaced_frames(self):
+        """端點斜率與端點差一致時，Hermite 過渡退化為等距直線，兩端無跳躍"""
+        transition_frames, loop_point = 4, 10
+        rng = np.random.default_rng(2)
+        # 數值範圍讓經度/方位角在相鄰幀間不需要展開
+        data = rng.uniform(10.0, 80.0, (16, 3, len(slb.FRAME_FIELDS)))
+        p0, p1 = data[loop_point - 1].copy(), data[0].copy()
+        delta = (p1 - p0) / (transition_frames + 1)
+        data[loop_point - 2] = p0 - delta
+        data[1] = p1 + delta
+
+        result = slb.hermite_transition(_frames(data), loop_point, transition_frames)
+
+        expected = p0 + delta * np.arange(1, transition_frames + 1)[:, None, None]
+        np.testing.assert_allclose(result, expected, rtol=1e-9)
+
+    def test_endpoints_are_approached_continuously(self):
+        rng = np.random.default_rng(5)
+        data = rng.uniform(-50.0, 50.0, (12, 5, len(slb.FRAME_FIELDS)))
+        loop_point, transition_frames = 9, 200
+
+        result = slb.hermite_transition(_frames(data), loop_point, transition_frames)
+
+        # 過渡幀以原取樣間隔延續端點斜率：與 p0 + m0 / p1 - m1 的差距隨過渡幀數 1/T 收斂
+        p0, p1 = data[loop_point - 1], data[0]
+        m0, m1 = p0 - data[loop_point - 2], data[1] - p1
+        bound = 3 * (np.abs(p1 - p0) + np.abs(m0) + np.abs(m1)) / (transition_frames + 1)
+        for name in ("lat", "alt", "elevation", "distance", "rsrp"):
+            k = FIELD[name]
+            assert np.all(np.abs(result[0, :, k] - (p0[:, k] + m0[:, k])) <= bound[:, k])
+            assert np.all(np.abs(result[-1, :, k] - (p1[:, k] - m1[:, k])) <= bound[:, k])
+
+    def test_longitude_crosses_the_dateline(self):
+        data = np.zeros((8, 1, len(slb.FRAME_FIELDS)))
+        loop_point, transition_frames = 6, 3
+        data[loop_point - 2, 0, FIELD["lon"]] = 178.5
+        data[loop_point - 1, 0, FIELD["lon"]] = 179.0
+        data[0, 0, FIELD["lon"]] = -179.0
+        data[1, 0, FIELD["lon"]] = -178.5
+        data[loop_point - 1, 0, FIELD["azimuth"]] = 359.0
+        data[loop_point - 2, 0, FIELD["azimuth"]] = 358.5
+        data[0, 0, FIELD["azimuth"]] = 1.0
+        data[1, 0, FIELD["azimuth"]] = 1.5
+
+        result = slb.hermite_transition(_frames(data), loop_point, transition_frames)
+
+        np.testing.assert_allclose(result[:, 0, FIELD["lon"]], [179.5, -180.0, -179.5], atol=1e-9)
+        np.testing.assert_allclose(result[:, 0, FIELD["azimuth"]], [359.5, 0.0, 0.5], atol=1e-9)
+
+
+@pytest.mark.unit
+class TestLoopPoint:
+
+    def test_picks_true_period_multiple_near_nominal_period(self):
+        # 名義週期 96 幀、實際週期 97 幀：候選 186..198 中第 194 幀與第 0 幀重合
+        frames = _frames(_periodic(250, 97.0))
+        loop = slb.find_loop_point(frames, period_minutes=96.0)
+
+        assert loop["loop_point"] == 194
+        assert loop["orbits"] == 2
+        assert loop["position_error_km"] == pytest.approx(0.0, abs=1e-6)
+        assert loop["candidates"] == 13
+
+    def test_candidates_respect_min_fraction(self):
+        # min_fraction 決定最短循環長度：0.3 時第一個週期 (97 幀) 即可，0.5 時需兩個週期
+        frames = _frames(_periodic(250, 97.0))
+        loop = slb.find_loop_point(frames, period_minutes=96.0, min_fraction=0.3)
+        assert loop["loop_point"] == 97
+        loop = slb.find_loop_point(frames, period_minutes=96.0, min_fraction=0.5)
+        assert loop["loop_point"] == 194
+
+    def test_exact_loop_needs_no_transition(self):
+        result = slb.build_seamless_loop(_frames(_periodic(250, 97.0)), period_minutes=96.0)
+        metadata = result["metadata"]
+        assert metadata["loop_point"] == 194
+        assert metadata["transition_frames"] == 0
+        assert len(result["frames"]) == 194
+        assert not any(frame.get("transition") for frame in result["frames"])
+
+    def test_mismatched_loop_appends_contiguous_transition(self):
+        # 實際週期遠離搜尋半徑：誤差超過門檻，以過渡幀銜接
+        frames = _frames(_periodic(250, 120.0))
+        result = slb.build_seamless_loop(frames, period_minutes=96.0, transition_seconds=180)
+        metadata = result["metadata"]
+        loop_point = metadata["loop_point"]
+
+        assert metadata["position_diff_km"] > 10.0
+        assert metadata["transition_frames"] == 3
+        transition = result["frames"][loop_point:]
+        assert [frame["alpha"] for frame in transition] == [0.25, 0.5, 0.75]
+        timestamps = [datetime.fromisoformat(frame["timestamp"]) for frame in result["frames"]]
+        assert all(b - a == timedelta(minutes=1) for a, b in zip(timestamps, timestamps[1:]))
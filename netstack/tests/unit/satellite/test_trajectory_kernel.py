@@ -0,0 +1,90 @@
+"""
+向量化軌跡核心測試 (與 BatchTrajectoryCalculator 逐點計算一致、預設依序執行、常駐執行緒池)
+"""
+
+import sys
+import types
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 只以輕量套件登記衛星服務目錄，避免 services.satellite 初始化時載入 TLE 下載器
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.insert(0, str(_SRC))
+for _name in ("services", "services.satellite"):
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_SRC.joinpath(*_name.split(".")))]
+        sys.modules[_name] = _package
+
+from services.satellite import timeseries_engine  # noqa: E402
+from services.satellite.trajectory_kernel import VectorizedTrajectoryKernel  # noqa: E402
+
+T0 = datetime(2025, 1, 1, 6, 0, tzinfo=timezone.utc)
+
+
+def _satellites(count, seed=4):
+    rng = np.random.default_rng(seed)
+    return [
+        {'satellite_id': f"sat_{i}", 'altitude': float(rng.uniform(540.0, 1200.0)),
+         'inclination': float(rng.uniform(40.0, 98.0)), 'raan': float(rng.uniform(0.0, 360.0)),
+         'mean_anomaly': float(rng.uniform(0.0, 360.0))}
+        for i in range(count)
+    ]
+
+
+def _timestamps(count=90, step_seconds=60):
+    return [T0 + timedelta(seconds=step_seconds * k) for k in range(count)]
+
+
+@pytest.mark.unit
+def test_kernel_matches_scalar_trajectory(monkeypatch):
+    calculator = timeseries_engine.BatchTrajectoryCalculator(backend="threaded")
+    # 無 TLE 的衛星以軌道力學模型為準 (不依賴環境是否安裝 SGP4 / Skyfield)
+    monkeypatch.setattr(calculator, "_simulate_sgp4_calculation", calculator._calculate_from_orbital_mechanics)
+    satellites, timestamps = _satellites(12), _timestamps()
+
+    vectorized = calculator.kernel.compute(satellites, timestamps).to_point_lists()
+
+    assert list(vectorized) == [sat['satellite_id'] for sat in satellites]
+    for sat in satellites:
+        expected = calculator._calculate_satellite_trajectory(sat, timestamps)
+        actual = vectorized[sat['satellite_id']]
+        assert len(actual) == len(expected) == len(timestamps)
+        for point, reference in zip(actual, expected):
+            assert point['timestamp'] == reference['timestamp']
+            # 向量化運算的捨入順序不同，容許 1e-6 度 / km 等級的差異
+            for group in ('position', 'relative', 'signal'):
+                for key, value in reference[group].items():
+                    assert point[group][key] == pytest.approx(value, rel=1e-7, abs=1e-6), (group, key)
+
+
+@pytest.mark.unit
+def test_default_runs_chunks_in_caller_thread():
+    kernel = VectorizedTrajectoryKernel(24.94, 121.37, 0.024, chunk_size=4)
+    assert kernel.max_workers == 1
+    kernel.compute(_satellites(10), _timestamps(5))
+    assert kernel._executor is None
+
+
+@pytest.mark.unit
+def test_threaded_chunks_reuse_one_pool():
+    satellites, timestamps = _satellites(40), _timestamps(30)
+    sequential = VectorizedTrajectoryKernel(24.94, 121.37, 0.024, chunk_size=8).compute(satellites, timestamps)
+
+    kernel = VectorizedTrajectoryKernel(24.94, 121.37, 0.024, max_workers=3, chunk_size=8)
+    try:
+        first = kernel.compute(satellites, timestamps)
+        executor = kernel._executor
+        second = kernel.compute(satellites, timestamps)
+        assert executor is not None and kernel._executor is executor
+    finally:
+        kernel.close()
+    assert kernel._executor is None
+
+    for batch in (first, second):
+        assert batch.valid.all()
+        for field in ('lat', 'lon', 'alt', 'elevation', 'azimuth', 'distance', 'rsrp'):
+            np.testing.assert_array_equal(getattr(batch, field), getattr(sequential, field))
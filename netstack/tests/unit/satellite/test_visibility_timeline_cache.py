@@ -0,0 +1,128 @@
+"""
+可見性時間軸快取測試 (TLE 指紋鍵、未涵蓋衛星、增量合併建表)
+
+以圓軌道替身取代 SGP4 傳播，TLE 第二行編碼 (RAAN, 初始相位, 傾角)。
+"""
+
+import importlib.util
+import math
+from datetime import date, datetime, timedelta, timezone
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+_MODULE_PATH = (Path(__file__).parent.parent.parent.parent / "src" / "services" / "satellite"
+                / "visibility_timeline_cache.py")
+_spec = importlib.util.spec_from_file_location("visibility_timeline_cache", _MODULE_PATH)
+vtc = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(vtc)
+
+ORBIT_RADIUS_KM = 6371.0 + 550.0
+PERIOD_SECONDS = 5730.0
+DAY = date(2025, 1, 1)
+OBSERVER = (24.94, 121.37)
+
+
+def _fake_propagate(tles, day, seconds):
+    positions = np.empty((len(tles), seconds.size, 3))
+    offset = (day - DAY).days * vtc.SECONDS_PER_DAY
+    for i, (_, _, line2) in enumerate(tles):
+        raan, phase, inc = (math.radians(float(v)) for v in line2.split())
+        u = phase + 2 * math.pi * (seconds + offset) / PERIOD_SECONDS
+        x, y = np.cos(u), np.sin(u)
+        positions[i, :, 0] = ORBIT_RADIUS_KM * (math.cos(raan) * x - math.sin(raan) * math.cos(inc) * y)
+        positions[i, :, 1] = ORBIT_RADIUS_KM * (math.sin(raan) * x + math.cos(raan) * math.cos(inc) * y)
+        positions[i, :, 2] = ORBIT_RADIUS_KM * math.sin(inc) * y
+    return positions
+
+
+def _tle(norad_id, raan, phase, inc=53.0, epoch="25001.0"):
+    return {'norad_id': norad_id, 'name': f"SAT-{norad_id}",
+            'line1': f"1 {norad_id} {epoch}", 'line2': f"{raan} {phase} {inc}"}
+
+
+def _constellation(count, seed=3):
+    rng = np.random.default_rng(seed)
+    return [_tle(1000 + i, float(rng.uniform(0, 360)), float(rng.uniform(0, 360)))
+            for i in range(count)]
+
+
+def _exact_visible(tle_data, when, threshold=10.0):
+    seconds = np.array([(when - datetime(when.year, when.month, when.day, tzinfo=timezone.utc)).total_seconds()])
+    tles = [(vtc.timeline_satellite_id(t), t['line1'], t['line2']) for t in tle_data]
+    positions = _fake_propagate(tles, when.date(), seconds)[:, 0, :]
+    elevation, _, _ = vtc.observer_look_angles(positions, *OBSERVER)
+    return {tles[i][0] for i in np.flatnonzero(elevation >= threshold)}
+
+
+@pytest.fixture(autouse=True)
+def fake_sgp4(monkeypatch):
+    monkeypatch.setattr(vtc, "_propagate", _fake_propagate)
+
+
+def _cache(**kwargs):
+    return vtc.VisibilityTimelineCache(min_elevation_deg=10.0, step_seconds=30, max_workers=1, **kwargs)
+
+
+@pytest.mark.unit
+class TestVisibilityTimelineCache:
+
+    def test_satellites_missing_from_timeline_stay_candidates(self):
+        base = _constellation(60)
+        cache = _cache()
+        cache.build(base, [OBSERVER], DAY)
+
+        added = [_tle(9000 + i, float(r), float(p)) for i, (r, p) in enumerate([(30, 10), (200, 300), (95, 45)])]
+        current = base + added
+        start = datetime(2025, 1, 1, 6, tzinfo=timezone.utc)
+        candidates = cache.candidate_ids(*OBSERVER, current, start, start + timedelta(minutes=96),
+                                         min_elevation_deg=10.0)
+        assert {vtc.timeline_satellite_id(t) for t in added} <= candidates
+
+        for minute in range(0, 96, 7):
+            when = start + timedelta(minutes=minute)
+            visible = cache.query_visible(*OBSERVER, when, current, min_elevation_deg=10.0)
+            assert {s['satellite_id'] for s in visible} == _exact_visible(current, when)
+
+    def test_updated_tle_is_not_served_from_stale_intervals(self):
+        base = _constellation(40)
+        cache = _cache()
+        cache.build(base, [OBSERVER], DAY)
+
+        updated = [dict(t) for t in base]
+        updated[5] = _tle(updated[5]['norad_id'], 120.0, 80.0, epoch="25001.5")
+        when = datetime(2025, 1, 1, 12, tzinfo=timezone.utc)
+        candidates = cache.candidate_ids(*OBSERVER, updated, when, min_elevation_deg=10.0)
+        assert vtc.timeline_satellite_id(updated[5]) in candidates
+
+        visible = cache.query_visible(*OBSERVER, when, updated, min_elevation_deg=10.0)
+        assert {s['satellite_id'] for s in visible} == _exact_visible(updated, when)
+
+    def test_incremental_build_matches_full_build(self, tmp_path):
+        base = _constellation(50)
+        changed = [dict(t) for t in base]
+        changed[0] = _tle(changed[0]['norad_id'], 10.0, 20.0, epoch="25001.7")
+        current = changed + [_tle(7777, 250.0, 100.0)]
+
+        cache = _cache(cache_dir=tmp_path)
+        first = cache.build(base, [OBSERVER], DAY)[0]
+        propagated = cache.stats()['propagated_satellites']
+        merged = cache.build(current, [OBSERVER], DAY)[0]
+        assert cache.stats()['propagated_satellites'] - propagated == 2
+        assert merged.key != first.key
+        assert merged.uncovered(current) == set()
+
+        full = _cache().build(current, [OBSERVER], DAY)[0]
+        assert merged.tle_fingerprint == full.tle_fingerprint
+        for tle in current:
+            sat_id = vtc.timeline_satellite_id(tle)
+            assert merged.intervals_for(sat_id) == full.intervals_for(sat_id)
+
+        # 磁碟檔名帶指紋，舊集合的檔案被取代；新行程載入的是合併後時間軸
+        files = sorted(p.name for p in tmp_path.glob("vis_*.npz"))
+        assert len(files) == 1 and merged.tle_fingerprint in files[0]
+        reloaded = _cache(cache_dir=tmp_path).get(*OBSERVER, DAY)
+        assert reloaded.key == merged.key
+        assert reloaded.uncovered(current) == set()
+        assert cache.build(current, [OBSERVER], DAY)[0] is merged
@@ -0,0 +1,214 @@
+"""
+多波束覆蓋引擎測試 (索引查詢對照全波束掃描、換日線與極區、狀態表換代與 API)
+
+以圓軌道合成快照取代 SGP4 傳播。
+"""
+
+import math
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 以輕量套件載入 netstack_api 子模組，避免 models/services 套件初始化載入 SIB19 等依賴
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+for _name, _path in [("netstack_api", _API_ROOT), ("netstack_api.models", _API_ROOT / "models"),
+                     ("netstack_api.services", _API_ROOT / "services"),
+                     ("netstack_api.routers", _API_ROOT / "routers")]:
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_path)]
+        sys.modules[_name] = _package
+
+from netstack_api.services import beam_footprint_engine as bfe  # noqa: E402
+from netstack_api.services import satellite_state_table as sst  # noqa: E402
+
+ORBIT_RADIUS_KM = bfe.EARTH_RADIUS_KM + 550.0
+ORBIT_SPEED_KM_S = 7.59
+
+
+def _synthetic_state(count=3000, oneweb=600, seed=0, t=0.0):
+    """Walker 式圓軌道：Starlink 53° 殼層 + OneWeb 87.9° 極軌 (涵蓋極區)"""
+    rng = np.random.default_rng(seed)
+    inc = np.radians(np.r_[np.full(count - oneweb, 53.0), np.full(oneweb, 87.9)])
+    raan = rng.uniform(0, 2 * np.pi, count)
+    anomaly = rng.uniform(0, 2 * np.pi, count) + ORBIT_SPEED_KM_S / ORBIT_RADIUS_KM * t
+    x, y = np.cos(anomaly), np.sin(anomaly)
+    ecef = ORBIT_RADIUS_KM * np.stack([
+        np.cos(raan) * x - np.sin(raan) * np.cos(inc) * y,
+        np.sin(raan) * x + np.cos(raan) * np.cos(inc) * y,
+        np.sin(inc) * y,
+    ], axis=1)
+    velocity = ORBIT_SPEED_KM_S * np.stack([
+        -np.cos(raan) * y - np.sin(raan) * np.cos(inc) * x,
+        -np.sin(raan) * y + np.cos(raan) * np.cos(inc) * x,
+        np.sin(inc) * x,
+    ], axis=1)
+    metadata = {
+        "satellite_id": np.array([f"sat_{i}" for i in range(count)], dtype=object),
+        "name": np.array([f"SAT-{i}" for i in range(count)], dtype=object),
+        "norad_id": np.arange(count),
+        "constellation": np.array(["starlink"] * (count - oneweb) + ["oneweb"] * oneweb, dtype=object),
+    }
+    return metadata, ecef, velocity
+
+
+def _snapshot(generation=1, t=0.0):
+    metadata, ecef, velocity = _synthetic_state(t=t)
+    return sst.SatelliteStateSnapshot(generation, 1.7e9 + t, metadata, ecef, velocity,
+                                      np.ones(len(ecef), dtype=bool), {})
+
+
+def _brute_force(frame, lat, lon):
+    """掃描本代全部波束的最強服務波束 (與引擎相同的仰角與覆蓋邊緣條件)"""
+    lat_r, lon_r = math.radians(lat), math.radians(lon)
+    up = np.array([math.cos(lat_r) * math.cos(lon_r), math.cos(lat_r) * math.sin(lon_r), math.sin(lat_r)])
+    to_ue = up * bfe.EARTH_RADIUS_KM - frame.satellite_ecef[frame.beam_satellite]
+    range_km = np.linalg.norm(to_ue, axis=1)
+    direction = to_ue / range_km[:, None]
+    elevation = np.degrees(np.arcsin(-direction @ up))
+    off_axis = np.degrees(np.arccos(np.clip(np.sum(direction * frame.boresight, axis=1), -1.0, 1.0)))
+
+    rsrp = np.full(len(frame), -np.inf)
+    for layout_id, pattern in enumerate(frame.patterns):
+        mask = frame.beam_layout == layout_id
+        gain = pattern.gain_db(off_axis[mask])
+        fspl = 20 * np.log10(range_km[mask]) + 20 * math.log10(frame.frequency_ghz[layout_id]) + 92.45
+        ok = ((elevation[mask] >= frame.min_elevation_deg[layout_id])
+              & (gain >= pattern.max_gain_dbi - frame.edge_gain_db[layout_id]))
+        rsrp[mask] = np.where(ok, frame.tx_power_dbm[layout_id] + gain - fspl, -np.inf)
+    best = int(np.argmax(rsrp))
+    return (best, float(rsrp[best])) if np.isfinite(rsrp[best]) else (-1, None)
+
+
+def _assert_matches_brute_force(engine, frame, lat, lon):
+    assignment = engine.assign(frame, np.asarray(lat, dtype=float), np.asarray(lon, dtype=float))
+    served = 0
+    for i, (la, lo) in enumerate(zip(lat, lon)):
+        beam, rsrp = _brute_force(frame, la, lo)
+        if beam < 0:
+            assert assignment.beam[i] == -1, (la, lo)
+            continue
+        served += 1
+        assert assignment.beam[i] >= 0, (la, lo)
+        assert assignment.rsrp_dbm[i] == pytest.approx(rsrp, abs=1e-9), (la, lo)
+    return served
+
+
+@pytest.fixture(scope="module")
+def frame_and_engine():
+    engine = bfe.BeamFootprintEngine()
+    return engine.frame_for_snapshot(_snapshot()), engine
+
+
+@pytest.mark.unit
+class TestBeamFootprintEngine:
+
+    def test_random_ues_match_brute_force(self, frame_and_engine):
+        frame, engine = frame_and_engine
+        rng = np.random.default_rng(1)
+        lat = rng.uniform(-80, 80, 300)
+        lon = rng.uniform(-180, 180, 300)
+        assert _assert_matches_brute_force(engine, frame, lat, lon) > 10
+
+    def test_dateline_ues_match_brute_force(self, frame_and_engine):
+        frame, engine = frame_and_engine
+        # 換日線附近的波束中心，以及跨到另一側的鄰近點
+        near = np.flatnonzero(np.abs(frame.centre_lon) > 178.0)[:40]
+        assert near.size > 0
+        lat = np.r_[frame.centre_lat[near], frame.centre_lat[near], [0.0, 0.0, 45.0, -45.0]]
+        lon = np.r_[frame.centre_lon[near], -np.sign(frame.centre_lon[near]) * 179.9,
+                    [179.999, -179.999, 180.0, -180.0]]
+        assert _assert_matches_brute_force(engine, frame, lat, lon) > 0
+
+    def test_polar_ues_match_brute_force(self, frame_and_engine):
+        frame, engine = frame_and_engine
+        lat = np.r_[np.full(12, 89.99), np.full(12, -89.99), np.full(12, 87.5), np.full(12, -87.5)]
+        lon = np.tile(np.linspace(-180, 150, 12), 4)
+        assert _assert_matches_brute_force(engine, frame, lat, lon) > 0
+
+    def test_state_table_generation_builds_frame(self):
+        metadata, ecef, velocity = _synthetic_state()
+
+        class FakePropagator:
+            def __init__(self):
+                self.metadata = metadata
+
+            def propagate(self, timestamp):
+                return ecef, velocity, np.ones(len(ecef), dtype=bool)
+
+        table = sst.SatelliteStateTable(observers={})
+        table._propagator = FakePropagator()
+        engine = bfe.BeamFootprintEngine()
+        engine.attach(table)
+
+        snapshot = table.refresh(timestamp=1.7e9)
+        assert engine.get_stats()["frames_built"] == 1
+        assert engine.get_stats()["cached_generations"] == [snapshot.generation]
+        assert engine.current_frame().generation == snapshot.generation
+        assert engine.get_stats()["frames_built"] == 1  # 查詢直接取用換代時建立的覆蓋
+
+        engine.detach()
+        table.refresh(timestamp=1.7e9 + 1)
+        assert engine.get_stats()["frames_built"] == 1
+
+    def test_tracker_hysteresis_and_events(self):
+        engine = bfe.BeamFootprintEngine()
+        tracker = bfe.BeamAssignmentTracker(engine, hysteresis_db=3.0)
+        rng = np.random.default_rng(2)
+        lat, lon = rng.uniform(-50, 50, 200), rng.uniform(-180, 180, 200)
+        ue_ids = [f"ue{i}" for i in range(200)]
+
+        first = engine.frame_for_snapshot(_snapshot(1))
+        assignment, events = tracker.update(first, ue_ids, lat, lon)
+        assert {e["type"] for e in events} == {"beam_acquired"}
+        assert len(events) == int((assignment.beam >= 0).sum())
+        # 同一代重複更新不應產生事件
+        assert tracker.update(first, ue_ids, lat, lon)[1] == []
+
+        _, events = tracker.update(engine.frame_for_snapshot(_snapshot(2, t=60.0)), ue_ids, lat, lon)
+        kinds = {e["type"] for e in events}
+        assert kinds <= {"beam_acquired", "beam_lost", "intra_satellite", "inter_satellite"}
+        assert tracker.statistics["beam_switches"] == sum(
+            e["type"] in ("intra_satellite", "inter_satellite") for e in events)
+
+
+@pytest.mark.unit
+def test_router_serves_current_generation(monkeypatch):
+    from fastapi import FastAPI
+    from fastapi.testclient import TestClient
+
+    from netstack_api.routers import beam_footprint_router
+
+    metadata, ecef, velocity = _synthetic_state()
+    table = sst.SatelliteStateTable(observers={})
+    table._propagator = types.SimpleNamespace(
+        metadata=metadata, propagate=lambda ts: (ecef, velocity, np.ones(len(ecef), dtype=bool)))
+    engine = bfe.BeamFootprintEngine()
+    engine.attach(table)
+    tracker = bfe.BeamAssignmentTracker(engine)
+    monkeypatch.setattr(beam_footprint_router, "get_beam_footprint_engine", lambda: engine)
+    monkeypatch.setattr(beam_footprint_router, "get_beam_assignment_tracker", lambda: tracker)
+
+    app = FastAPI()
+    app.include_router(beam_footprint_router.router)
+    client = TestClient(app)
+    assert client.get("/api/v1/beams/serving", params={"latitude": 25.0, "longitude": 121.5}).status_code == 503
+
+    snapshot = table.refresh(timestamp=1.7e9)
+    frame = engine.current_frame()
+    centre = int(np.argmax(frame.centre_lat < 50))
+    lat, lon = float(frame.centre_lat[centre]), float(frame.centre_lon[centre])
+
+    serving = client.get("/api/v1/beams/serving", params={"latitude": lat, "longitude": lon}).json()
+    assert serving["generation"] == snapshot.generation
+    assert serving["rsrp_dbm"] == pytest.approx(_brute_force(frame, lat, lon)[1], abs=1e-9)
+
+    tracked = client.post("/api/v1/beams/track", json={
+        "ues": [{"ue_id": "ue-1", "latitude": lat, "longitude": lon}]
+    }).json()
+    assert tracked["events"][0]["type"] == "beam_acquired"
+    assert tracked["assignments"]["ue-1"]["satellite_id"] == serving["satellite_id"]
+    assert client.get("/api/v1/beams/stats").json()["tracker"]["tracked_ues"] == 1
@@ -0,0 +1,190 @@
+"""
+可合併延遲直方圖測試 (分位數相對誤差上限、合併、時間窗保留期、溢出檔隨服務關閉)
+"""
+
+import asyncio
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+for _name, _path in [("netstack_api", _API_ROOT), ("netstack_api.services", _API_ROOT / "services")]:
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_path)]
+        sys.modules[_name] = _package
+
+from netstack_api.services.latency_sketch import (  # noqa: E402
+    HistogramLayout, LatencyHistogram, WindowedLatencySketches,
+)
+
+QUANTILES = (0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.95, 0.99, 0.999)
+
+
+def _samples(n=20000, seed=5):
+    # 換手延遲量級 (數 ms 到數百 ms) 的長尾分佈
+    return np.random.default_rng(seed).lognormal(mean=np.log(40.0), sigma=0.8, size=n)
+
+
+@pytest.mark.unit
+class TestQuantileAccuracy:
+
+    @pytest.mark.parametrize("accuracy", [0.01, 0.05])
+    def test_quantiles_within_relative_accuracy(self, accuracy):
+        values = _samples()
+        histogram = LatencyHistogram(HistogramLayout(relative_accuracy=accuracy))
+        for value in values:
+            histogram.record(value)
+
+        ordered = np.sort(values)
+        for q in QUANTILES:
+            exact = ordered[int(q * (len(values) - 1))]
+            assert abs(histogram.quantile(q) - exact) <= accuracy * exact
+        percentiles = histogram.percentiles(QUANTILES)
+        assert [percentiles[f"p{q * 100:g}"] for q in QUANTILES] == [histogram.quantile(q) for q in QUANTILES]
+
+    def test_extremes_and_moments_are_exact(self):
+        values = _samples(5000)
+        histogram = LatencyHistogram()
+        histogram.record_many(values)
+        assert histogram.quantile(0.0) == values.min()
+        assert histogram.quantile(1.0) == values.max()
+        assert histogram.mean == pytest.approx(values.mean())
+        assert histogram.stdev == pytest.approx(values.std(ddof=1))
+
+    def test_record_many_matches_record(self):
+        values = np.concatenate([_samples(2000), [0.001, 0.01, 1e7]])
+        single, batch = LatencyHistogram(), LatencyHistogram()
+        for value in values:
+            single.record(value)
+        batch.record_many(values)
+        np.testing.assert_array_equal(single.counts, batch.counts)
+        assert batch.counts[0] == 2 and batch.counts[-1] == 1
+
+
+@pytest.mark.unit
+class TestMerge:
+
+    def test_merged_shards_equal_single_histogram(self):
+        values = _samples()
+        whole = LatencyHistogram()
+        whole.record_many(values)
+        shards = [LatencyHistogram() for _ in range(4)]
+        for shard, part in zip(shards, np.array_split(values, 4)):
+            shard.record_many(part)
+
+        merged = LatencyHistogram()
+        for shard in shards:
+            merged.merge(LatencyHistogram.from_dict(shard.to_dict()))
+        np.testing.assert_array_equal(merged.counts, whole.counts)
+        assert merged.count == whole.count
+        assert merged.min_value == whole.min_value and merged.max_value == whole.max_value
+        assert [merged.quantile(q) for q in QUANTILES] == [whole.quantile(q) for q in QUANTILES]
+
+    def test_layout_mismatch_is_rejected(self):
+        with pytest.raises(ValueError):
+            LatencyHistogram().merge(LatencyHistogram(HistogramLayout(relative_accuracy=0.02)))
+
+    def test_windowed_merge_combines_windows_and_totals(self):
+        a, b = WindowedLatencySketches(60.0), WindowedLatencySketches(60.0)
+        a.record("NTN", 100.0, 0.0)
+        a.record("NTN", 120.0, 61.0)
+        b.record("NTN", 110.0, 30.0)
+        b.record("Proposed", 25.0, 65.0)
+        a.merge(WindowedLatencySketches.from_dict(b.to_dict()))
+
+        assert a.total("NTN").count == 3
+        assert a.range("NTN", 0.0, 60.0).count == 2
+        assert a.range("Proposed").count == 1
+        with pytest.raises(ValueError):
+            a.merge(WindowedLatencySketches(30.0))
+
+
+@pytest.mark.unit
+class TestWindowRetention:
+
+    def test_old_windows_expire_but_totals_remain(self):
+        sketches = WindowedLatencySketches(window_seconds=60.0, retention_seconds=180.0)
+        for minute in range(10):
+            sketches.record("NTN", 100.0 + minute, minute * 60.0 + 1.0)
+
+        # 最新時間窗起點 540s，保留 [360, 540]
+        assert sorted(sketches.windows["NTN"]) == [360, 420, 480, 540]
+        assert sketches.range("NTN").count == 4
+        assert sketches.total("NTN").count == 10
+
+    def test_late_samples_do_not_move_the_cutoff(self):
+        sketches = WindowedLatencySketches(window_seconds=60.0, retention_seconds=60.0)
+        sketches.record("NTN", 100.0, 600.0)
+        sketches.record("NTN", 100.0, 30.0)     # 遲到樣本仍記錄，待下一次新時間窗時清除
+        assert sorted(sketches.windows["NTN"]) == [0, 600]
+        sketches.record("NTN", 100.0, 660.0)
+        assert sorted(sketches.windows["NTN"]) == [600, 660]
+        assert sketches.expire(now=760.0) == 1
+        assert sorted(sketches.windows["NTN"]) == [660]
+
+    def test_retention_survives_export_and_merge(self):
+        source = WindowedLatencySketches(window_seconds=60.0, retention_seconds=120.0)
+        for minute in range(5):
+            source.record("NTN", 50.0, minute * 60.0)
+        restored = WindowedLatencySketches.from_dict(source.to_dict())
+        assert restored.retention_seconds == 120.0
+
+        newer = WindowedLatencySketches(window_seconds=60.0)
+        newer.record("NTN", 50.0, 600.0)
+        restored.merge(newer)
+        assert sorted(restored.windows["NTN"]) == [600]
+        assert restored.total("NTN").count == 6
+
+    def test_no_retention_keeps_everything(self):
+        sketches = WindowedLatencySketches(window_seconds=60.0)
+        for minute in range(10):
+            sketches.record("NTN", 100.0, minute * 60.0)
+        assert len(sketches.windows["NTN"]) == 10
+        assert sketches.expire() == 0
+
+
+@pytest.mark.unit
+def test_spill_file_closes_on_service_shutdown(tmp_path, monkeypatch):
+    # 環境缺少的重依賴僅在匯入期間以替身登記
+    structlog_stub = types.ModuleType("structlog")
+
+    class _Logger:
+        def __getattr__(self, name):
+            return lambda *args, **kwargs: None
+
+    structlog_stub.get_logger = lambda *args, **kwargs: _Logger()
+    stubs = {"structlog": structlog_stub}
+    stubs.update({name: types.ModuleType(name) for name in ("pandas", "matplotlib", "matplotlib.pyplot")})
+    for name, stub in stubs.items():
+        if name not in sys.modules:
+            try:
+                __import__(name)
+            except ImportError:
+                monkeypatch.setitem(sys.modules, name, stub)
+    from netstack_api.services import handover_measurement_service as hms
+
+    spill = tmp_path / "spill" / "events.jsonl"
+    service = hms.HandoverMeasurementService(
+        output_dir=str(tmp_path / "out"), retain_events=False, spill_path=str(spill)
+    )
+
+    async def run():
+        await service.record_handover_event("ue_1", "sat_a", "sat_b", hms.HandoverScheme.PROPOSED, 25.0)
+        handle = service.measurement._spill_file
+        assert handle is not None and not handle.closed
+        await service.shutdown()
+        return handle
+
+    handle = asyncio.run(run())
+    assert handle.closed and service.measurement._spill_file is None
+    assert len(spill.read_text(encoding="utf-8").splitlines()) == 1
+
+    with hms.HandoverMeasurement(output_dir=str(tmp_path / "out"), spill_path=str(spill)) as measurement:
+        measurement.record_handover("ue_2", "sat_b", "sat_c", 0.0, 0.03, hms.HandoverScheme.PROPOSED)
+        handle = measurement._spill_file
+    assert handle.closed
+    assert len(spill.read_text(encoding="utf-8").splitlines()) == 2
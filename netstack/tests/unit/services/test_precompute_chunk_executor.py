@@ -0,0 +1,279 @@
+"""
+預計算分塊執行器測試 (分塊規劃不重不漏、恢復時跳過已檢查點分塊、規劃指紋不符時捨棄檢查點)
+
+SGP4 傳播以替身取代：每個 (衛星, 時間點) 產生一筆記錄，並記下實際計算過的分塊。
+"""
+
+import asyncio
+import sys
+import threading
+import types
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+
+import pytest
+
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+for _name, _path in [("netstack_api", _API_ROOT), ("netstack_api.services", _API_ROOT / "services")]:
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_path)]
+        sys.modules[_name] = _package
+
+T0 = datetime(2025, 1, 1, tzinfo=timezone.utc)
+OBSERVER = (24.94, 121.37, 0.024)
+
+
+class _FakePrecomputer:
+    """compute_history 的替身：時間點 start + k × step (≤ end)，每顆衛星一筆"""
+
+    calls = []
+    lock = threading.Lock()
+
+    def __init__(self, tle_data, observer_coords, time_range):
+        self.tle_data = tle_data
+        self.time_range = time_range
+
+    def compute_history(self, time_interval_seconds=30):
+        start, end = self.time_range
+        with self.lock:
+            self.calls.append((self.tle_data[0]["name"], start))
+        results = []
+        current = start
+        while current <= end:
+            results.extend((tle["name"], current) for tle in self.tle_data)
+            current += timedelta(seconds=time_interval_seconds)
+        return results
+
+
+class _FakeBatchProcessor:
+    stored = []
+
+    def __init__(self, db_url):
+        pass
+
+    async def initialize(self):
+        return True
+
+    async def process_and_store(self, results):
+        self.stored.extend(results)
+        return {"processed": len(results), "failed": 0}
+
+    async def close(self):
+        pass
+
+
+@pytest.fixture(scope="module")
+def modules():
+    # 環境缺少的重依賴與 SGP4 / 資料庫元件僅在匯入期間以替身登記
+    structlog_stub = types.ModuleType("structlog")
+
+    class _Logger:
+        def __getattr__(self, name):
+            return lambda *args, **kwargs: None
+
+    structlog_stub.get_logger = lambda *args, **kwargs: _Logger()
+    history = types.ModuleType("netstack_api.services.precompute_satellite_history")
+    history.SatelliteHistoryPrecomputer = _FakePrecomputer
+    history.PrecomputeResult = tuple
+    history.ObserverPosition = tuple
+    batch = types.ModuleType("netstack_api.services.batch_processor")
+    batch.HistoryBatchProcessor = _FakeBatchProcessor
+    tle = types.ModuleType("netstack_api.services.tle_data_manager")
+    tle.TLEDataManager = lambda *args, **kwargs: None
+
+    with pytest.MonkeyPatch.context() as patch:
+        try:
+            __import__("structlog")
+        except ImportError:
+            patch.setitem(sys.modules, "structlog", structlog_stub)
+        for stub in (history, batch, tle):
+            patch.setitem(sys.modules, stub.__name__, stub)
+        from netstack_api.services import precompute_chunk_executor as pce
+        from netstack_api.services import precompute_job_manager as pjm
+        yield pce, pjm
+    # 替身模組只供本檔使用
+    sys.modules.pop("netstack_api.services.precompute_chunk_executor", None)
+    sys.modules.pop("netstack_api.services.precompute_job_manager", None)
+
+
+@pytest.fixture(autouse=True)
+def _reset_fakes():
+    _FakePrecomputer.calls = []
+    _FakeBatchProcessor.stored = []
+
+
+def _tle_data(count):
+    return [{"name": f"SAT-{i}", "line1": f"1 {i}", "line2": f"2 {i}"} for i in range(count)]
+
+
+def _grid(start, end, step):
+    points, current = [], start
+    while current <= end:
+        points.append(current)
+        current += timedelta(seconds=step)
+    return points
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("hours, step, chunk_hours, satellites, shard_size", [
+    (6.0, 30, 1.0, 1200, 500),
+    (2.5, 45, 1.0, 7, 3),        # 步長不整除一小時、最後一個區段與分片不完整
+    (1.0, 3600, 0.25, 4, 10),    # 區段短於步長：每塊至少一個時間點
+    (0.0, 30, 1.0, 2, 1),        # 起訖相同：單一時間點
+])
+def test_chunk_plan_covers_each_timestep_once(modules, hours, step, chunk_hours, satellites, shard_size):
+    pce, _ = modules
+    end = T0 + timedelta(hours=hours, seconds=7)    # 結束時間不落在網格上
+    chunks = pce.plan_chunks("starlink", T0, end, step, satellites, shard_size, chunk_hours)
+
+    grid = _grid(T0, end, step)
+    assert [chunk.index for chunk in chunks] == list(range(len(chunks)))
+    shards = sorted({(c.shard_start, c.shard_end) for c in chunks})
+    assert shards[0][0] == 0 and shards[-1][1] == satellites
+    assert all(a[1] == b[0] for a, b in zip(shards, shards[1:]))
+
+    for shard in shards:
+        points = [t for c in chunks if (c.shard_start, c.shard_end) == shard
+                  for t in _grid(c.time_start, c.time_end, step)]
+        assert points == grid
+        assert sum(c.time_points for c in chunks if (c.shard_start, c.shard_end) == shard) == len(grid)
+    assert sum(c.calculations for c in chunks) == satellites * len(grid)
+
+
+@pytest.mark.unit
+def test_empty_plans(modules):
+    pce, _ = modules
+    assert pce.plan_chunks("starlink", T0, T0 + timedelta(hours=1), 30, 0) == []
+    assert pce.plan_chunks("starlink", T0, T0 - timedelta(seconds=1), 30, 10) == []
+
+
+@pytest.mark.unit
+def test_resume_skips_checkpointed_chunks(modules, tmp_path):
+    pce, _ = modules
+    store = pce.ChunkCheckpointStore(str(tmp_path))
+    tle_data = _tle_data(6)
+    chunks = pce.plan_chunks("starlink", T0, T0 + timedelta(hours=3), 60, len(tle_data), 2, 1.0)
+    assert len(chunks) == 12       # 3 個分片 × 4 個區段 (181 個時間點，最後一段只有結束時間點)
+
+    executor = ThreadPoolExecutor(max_workers=2)
+    runner = pce.ChunkedJobRunner(executor, store, max_in_flight=2)
+    started, done = [], []
+
+    async def run(limit):
+        started.clear()
+        done.clear()
+        return await runner.run(
+            "job", chunks, tle_data, OBSERVER, 60,
+            should_continue=lambda: len(started) < limit,
+            on_chunk_done=lambda chunk, stats: done.append(chunk.index),
+            on_chunk_started=lambda chunk: started.append(chunk.index),
+        )
+
+    try:
+        # 第一次執行提交 5 個分塊後暫停，等待在途分塊寫入檢查點
+        assert asyncio.run(run(5)) is False
+        first = set(done)
+        assert store.completed_chunks("job") == first and len(first) == 5
+
+        # 恢復：只計算其餘分塊
+        _FakePrecomputer.calls = []
+        assert asyncio.run(run(len(chunks))) is True
+    finally:
+        executor.shutdown()
+
+    assert first.isdisjoint(done)
+    assert first | set(done) == {chunk.index for chunk in chunks}
+    computed = {(name, start) for name, start in _FakePrecomputer.calls}
+    assert computed == {(tle_data[c.shard_start]["name"], c.time_start) for c in chunks if c.index in done}
+
+    # 所有分塊結果的聯集與單次計算完全相同
+    records = [r for results in store.iter_chunk_results("job", [c.index for c in chunks]) for r in results]
+    expected = _FakePrecomputer(tle_data, OBSERVER, (T0, T0 + timedelta(hours=3))).compute_history(60)
+    assert sorted(records) == sorted(expected) and len(set(records)) == len(records)
+
+
+def _manager_job(pjm, tmp_path, shard_size=2):
+    manager = pjm.PrecomputeJobManager(max_workers=2, checkpoint_dir=str(tmp_path))
+    executor = ThreadPoolExecutor(max_workers=2)
+    manager._get_executor = lambda: executor
+    config = pjm.JobConfig(constellation="starlink", start_time=T0, end_time=T0 + timedelta(hours=2),
+                           observer_coords=OBSERVER, time_step_seconds=60, shard_size=shard_size)
+    job = pjm.JobInfo(job_id="job", config=config, status=pjm.JobStatus.PENDING,
+                      created_at=datetime.now(timezone.utc))
+    manager.active_jobs["job"] = job
+    return manager, job, executor
+
+
+def _seed_checkpoint(pce, manager, job, tle_data, fingerprint, indices):
+    """預先寫入作業清單、釘選 TLE 與部分分塊檢查點 (如同上次執行中斷)"""
+    store = manager.checkpoint_store
+    store.save_tle_data("job", tle_data)
+    store.save_manifest("job", {"job_id": "job", "fingerprint": fingerprint})
+    config = job.config
+    chunks = pce.plan_chunks(config.constellation, config.start_time, config.end_time,
+                             config.time_step_seconds, len(tle_data), config.shard_size, config.chunk_hours)
+    for index in indices:
+        chunk = chunks[index]
+        results, _ = pce.compute_chunk(tle_data[chunk.shard_start:chunk.shard_end], OBSERVER,
+                                       chunk.time_start, chunk.time_end, config.time_step_seconds)
+        store.save_chunk("job", index, results, {"index": index, "records": len(results)})
+    _FakePrecomputer.calls = []
+    return chunks
+
+
+@pytest.mark.unit
+def test_matching_fingerprint_resumes_checkpoints(modules, tmp_path):
+    pce, pjm = modules
+    tle_data = _tle_data(4)
+    manager, job, executor = _manager_job(pjm, tmp_path)
+    fingerprint = pce.plan_fingerprint(manager._config_to_dict(job.config), tle_data, 2, 1.0)
+    chunks = _seed_checkpoint(pce, manager, job, tle_data, fingerprint, [0, 3])
+
+    try:
+        asyncio.run(manager._execute_precompute_job("job"))
+    finally:
+        executor.shutdown()
+
+    assert job.status == pjm.JobStatus.COMPLETED
+    assert job.resumed_chunks == 2 and job.total_chunks == len(chunks) == 6
+    assert len(_FakePrecomputer.calls) == 4
+    assert job.processed_records == len(_FakeBatchProcessor.stored) == 4 * 121
+
+
+@pytest.mark.unit
+def test_fingerprint_mismatch_discards_checkpoints(modules, tmp_path):
+    pce, pjm = modules
+    tle_data = _tle_data(4)
+    manager, job, executor = _manager_job(pjm, tmp_path)
+    # 舊檢查點以不同分片大小規劃
+    stale = pce.plan_fingerprint(manager._config_to_dict(job.config), tle_data, 3, 1.0)
+    chunks = _seed_checkpoint(pce, manager, job, tle_data, stale, [0, 1, 2])
+
+    try:
+        asyncio.run(manager._execute_precompute_job("job"))
+    finally:
+        executor.shutdown()
+
+    assert job.status == pjm.JobStatus.COMPLETED
+    assert job.resumed_chunks == 0
+    assert len(_FakePrecomputer.calls) == len(chunks)
+    assert job.processed_records == 4 * 121
+    assert sorted(_FakeBatchProcessor.stored) == sorted(
+        _FakePrecomputer(tle_data, OBSERVER, (T0, T0 + timedelta(hours=2))).compute_history(60))
+
+
+@pytest.mark.unit
+def test_fingerprint_tracks_plan_inputs(modules):
+    pce, _ = modules
+    config = {"constellation": "starlink", "time_step_seconds": 30}
+    tle_data = _tle_data(3)
+    base = pce.plan_fingerprint(config, tle_data, 500, 1.0)
+    assert pce.plan_fingerprint(dict(config), [dict(t) for t in tle_data], 500, 1.0) == base
+    assert pce.plan_fingerprint({**config, "time_step_seconds": 60}, tle_data, 500, 1.0) != base
+    assert pce.plan_fingerprint(config, tle_data, 250, 1.0) != base
+    assert pce.plan_fingerprint(config, tle_data, 500, 0.5) != base
+    updated = [dict(t) for t in tle_data]
+    updated[1]["line2"] = "2 1 updated"
+    assert pce.plan_fingerprint(config, updated, 500, 1.0) != base
@@ -0,0 +1,117 @@
+"""
+共享衛星狀態表測試 (預設衛星來源讀取本地 TLE 檔、背景更新產生非空快照)
+"""
+
+import asyncio
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 以輕量套件載入 netstack_api 子模組，避免 services 套件初始化載入重依賴
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+for _name, _path in [("netstack_api", _API_ROOT), ("netstack_api.services", _API_ROOT / "services")]:
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_path)]
+        sys.modules[_name] = _package
+
+from netstack_api.services import satellite_state_table as sst  # noqa: E402
+
+STARLINK_TLE = """STARLINK-1008
+1 44714U 19074B   25266.17900924 -.00000055  00000+0  15232-4 0  9991
+2 44714  53.0533 218.6047 0001564  98.0837 262.0330 15.06390214323500
+STARLINK-1011
+1 44717U 19074E   25266.19226849  .00000868  00000+0  77285-4 0  9994
+2 44717  53.0535 218.5462 0001450  82.7226 277.3928 15.06394123323516
+"""
+
+
+@pytest.fixture
+def tle_dir(tmp_path):
+    tle = tmp_path / "starlink" / "tle"
+    tle.mkdir(parents=True)
+    (tle / "starlink_20250920.tle").write_text(STARLINK_TLE.split("STARLINK-1011")[0])
+    (tle / "starlink_20250921.tle").write_text(STARLINK_TLE)
+    return tmp_path
+
+
+@pytest.mark.unit
+def test_default_loader_reads_latest_tle_file(tle_dir):
+    satellites = asyncio.run(sst.load_tle_satellites(tle_data_dir=tle_dir))
+    assert [sat["norad_id"] for sat in satellites] == [44714, 44717]
+    assert satellites[0]["satellite_id"] == "starlink_44714"
+    assert satellites[0]["name"] == "STARLINK-1008"
+    assert satellites[1]["line2"].startswith("2 44717")
+    assert all(sat["constellation"] == "starlink" for sat in satellites)
+
+
+@pytest.mark.unit
+def test_default_loader_reads_repository_tle_data():
+    """原始碼樹 netstack/tle_data 即為容器 /app/tle_data 掛載的內容"""
+    repo_tle = _API_ROOT.parent / "tle_data"
+    if sst.latest_tle_file(repo_tle, "starlink") is None:
+        pytest.skip("原始碼樹未包含 TLE 檔")
+    satellites = asyncio.run(sst.load_tle_satellites(("starlink",), tle_data_dir=repo_tle))
+    assert len(satellites) > 1000
+
+
+@pytest.mark.unit
+def test_table_started_with_default_loader_has_rows(tle_dir, monkeypatch):
+    monkeypatch.setenv("TLE_DATA_DIR", str(tle_dir))
+    if not sst.SGP4_AVAILABLE:
+        # 無 sgp4 時以圓軌道位置代替傳播，仍經過預設衛星來源與背景更新
+        class CircularPropagator:
+            def __init__(self, satellites):
+                self.satellites = list(satellites)
+                self.metadata = {
+                    field: np.array([sat[field] for sat in self.satellites], dtype=object)
+                    for field in ("satellite_id", "name", "norad_id", "constellation")
+                }
+
+            def propagate(self, timestamp):
+                n = len(self.satellites)
+                ecef = np.tile([sst.WGS84_A_KM + 550.0, 0.0, 0.0], (n, 1))
+                return ecef, np.zeros((n, 3)), np.ones(n, dtype=bool)
+
+        monkeypatch.setattr(sst, "SGP4StatePropagator", CircularPropagator)
+
+    async def run():
+        table = sst.SatelliteStateTable(tick_seconds=0.01, min_wall_interval=0.01)
+        assert table.satellite_loader is sst.load_tle_satellites
+        table.start()
+        try:
+            for _ in range(200):
+                if table.ready:
+                    break
+                await asyncio.sleep(0.01)
+        finally:
+            await table.stop()
+        return table
+
+    table = asyncio.run(run())
+    assert table.ready
+    assert table.stats()["satellites"] == 2
+    assert table.snapshot_for(tolerance_seconds=3600) is not None
+    assert list(table.snapshot.column("norad_id", np.arange(2))) == [44714, 44717]
+
+
+@pytest.mark.unit
+def test_empty_source_is_reported_as_refresh_error(tmp_path, monkeypatch):
+    monkeypatch.setenv("TLE_DATA_DIR", str(tmp_path))
+
+    async def run():
+        table = sst.SatelliteStateTable()
+        table.start()
+        for _ in range(100):
+            if table.stats()["refresh_errors"]:
+                break
+            await asyncio.sleep(0.01)
+        await table.stop()
+        return table
+
+    table = asyncio.run(run())
+    assert table.stats()["refresh_errors"] == 1
+    assert not table.ready
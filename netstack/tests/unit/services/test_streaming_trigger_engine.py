@@ -0,0 +1,163 @@
+"""
+串流事件觸發引擎測試 (A3/A5/D2 的 time-to-trigger 進入/離開與遲滯區間)
+
+L3 濾波係數設為 0 (濾波值即量測值)、TTT 1 秒、每 0.25 秒一筆測量，
+每個事件以三種量測組合描述：進入條件成立、遲滯區間內 (進入與離開皆不成立)、離開條件成立。
+"""
+
+import sys
+import types
+from dataclasses import dataclass
+from pathlib import Path
+
+import pytest
+
+# 只以輕量套件登記服務目錄，避免 services 套件初始化載入重依賴
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.insert(0, str(_SRC))
+if "services" not in sys.modules:
+    _package = types.ModuleType("services")
+    _package.__path__ = [str(_SRC / "services")]
+    sys.modules["services"] = _package
+
+from services.streaming_trigger_engine import ENTERED, LEFT, StreamingTriggerEngine  # noqa: E402
+from services.threegpp_event_generator import ThreeGPPEventGenerator  # noqa: E402
+
+T0 = 1_700_000_000.0
+STEP = 0.25
+TTT = 1.0
+
+
+@dataclass
+class _Measurement:
+    """與 SatelliteMeasurement 相同欄位的測量替身"""
+    satellite_id: str
+    rsrp_dbm: float
+    distance_km: float
+    elevation_deg: float = 30.0
+    azimuth_deg: float = 180.0
+    is_visible: bool = True
+
+
+# 預設門檻：Hys 2 dB、Off_a3 3 dB、Thresh1 -110、Thresh2 -106、ThreshD1 1500、ThreshD2 1200、HysD 50 km
+# 每個位準為 (Ms, Mn, Ds, Dn)
+SCENARIOS = {
+    # 進入: Mn - Ms > 5；離開: Mn - Ms < 1
+    "A3": {"enter": (-100.0, -94.0, 1000.0, 1000.0),
+           "band": (-100.0, -97.0, 1000.0, 1000.0),
+           "leave": (-100.0, -101.5, 1000.0, 1000.0)},
+    # 進入: Ms < -112 且 Mn > -104；離開: Ms > -108 或 Mn < -108
+    "A5": {"enter": (-113.0, -103.0, 1000.0, 1000.0),
+           "band": (-111.0, -103.0, 1000.0, 1000.0),
+           "leave": (-107.0, -103.0, 1000.0, 1000.0)},
+    # 進入: Ds > 1550 且 Dn < 1150；離開: Ds < 1450 或 Dn > 1250
+    "D2": {"enter": (-100.0, -100.0, 1600.0, 1100.0),
+           "band": (-100.0, -100.0, 1520.0, 1100.0),
+           "leave": (-100.0, -100.0, 1400.0, 1100.0)},
+}
+
+
+class _Feed:
+    """依序餵入測量並只記錄指定事件的轉換"""
+
+    def __init__(self, event_type):
+        generator = ThreeGPPEventGenerator()
+        generator.measurement_config["filter_coefficient"] = 0
+        generator.measurement_config["time_to_trigger"] = TTT * 1000
+        self.engine = StreamingTriggerEngine(generator)
+        self.event_type = event_type
+        self.levels = SCENARIOS[event_type]
+        self.samples = 0
+
+    @property
+    def now(self):
+        return self.samples * STEP
+
+    def run(self, level, seconds):
+        """以同一位準持續 seconds 秒；返回 [(相對時間, 轉換)]"""
+        ms, mn, ds, dn = self.levels[level]
+        transitions = []
+        for _ in range(int(round(seconds / STEP))):
+            now = self.now
+            events = self.engine.update("ue", _Measurement("serving", ms, ds),
+                                        [_Measurement("neighbour", mn, dn)], T0 + now)
+            transitions.extend((now, e["transition"]) for e in events if e["event_type"] == self.event_type)
+            self.samples += 1
+        return transitions
+
+    def active(self):
+        return [e for e in self.engine.active_events("ue") if e["event_type"] == self.event_type]
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("event_type", list(SCENARIOS))
+class TestTimeToTrigger:
+
+    def test_enters_after_condition_holds_for_ttt(self, event_type):
+        feed = _Feed(event_type)
+        assert feed.run("band", 2.0) == []
+        start = feed.now
+        assert feed.run("enter", TTT) == []
+        assert not feed.active()
+        # 條件從 start 起連續成立，第 TTT 秒的取樣觸發
+        assert feed.run("enter", STEP) == [(start + TTT, ENTERED)]
+        assert len(feed.active()) == 1
+        assert feed.active()[0]["timestamp"] == T0 + start + TTT
+
+    def test_interrupted_entry_restarts_timer(self, event_type):
+        feed = _Feed(event_type)
+        feed.run("enter", TTT - STEP)
+        # 進入條件中斷 (落入遲滯區間) 後計時器歸零
+        assert feed.run("band", STEP) == []
+        restart = feed.now
+        assert feed.run("enter", TTT) == []
+        assert feed.run("enter", STEP) == [(restart + TTT, ENTERED)]
+
+    def test_leaves_after_condition_holds_for_ttt(self, event_type):
+        feed = _Feed(event_type)
+        feed.run("enter", TTT + STEP)
+        assert feed.active()
+        start = feed.now
+        assert feed.run("leave", TTT) == []
+        assert feed.active()
+        assert feed.run("leave", STEP) == [(start + TTT, LEFT)]
+        assert not feed.active()
+
+    def test_interrupted_leave_restarts_timer(self, event_type):
+        feed = _Feed(event_type)
+        feed.run("enter", TTT + STEP)
+        feed.run("leave", TTT - STEP)
+        assert feed.run("band", STEP) == []
+        restart = feed.now
+        assert feed.run("leave", TTT) == []
+        assert feed.run("leave", STEP) == [(restart + TTT, LEFT)]
+
+
+@pytest.mark.unit
+@pytest.mark.parametrize("event_type", list(SCENARIOS))
+class TestHysteresis:
+
+    def test_band_keeps_triggered_event(self, event_type):
+        feed = _Feed(event_type)
+        feed.run("enter", TTT + STEP)
+        # 遲滯區間內離開條件不成立，停留多久都不離開
+        assert feed.run("band", 10 * TTT) == []
+        assert len(feed.active()) == 1
+
+    def test_band_does_not_trigger(self, event_type):
+        feed = _Feed(event_type)
+        assert feed.run("band", 10 * TTT) == []
+        assert not feed.active()
+
+    def test_oscillation_shorter_than_ttt_does_not_chatter(self, event_type):
+        feed = _Feed(event_type)
+        # 未觸發時：進入條件每次只成立半個 TTT
+        for _ in range(6):
+            assert feed.run("enter", TTT / 2) == []
+            assert feed.run("band", STEP) == []
+        feed.run("enter", TTT + STEP)
+        # 已觸發時：離開條件每次只成立半個 TTT
+        for _ in range(6):
+            assert feed.run("leave", TTT / 2) == []
+            assert feed.run("band", STEP) == []
+        assert len(feed.active()) == 1
@@ -0,0 +1,169 @@
+"""
+Warm-start 快照測試 (水合記錄含星下點、背景水合任務與失敗狀態)
+"""
+
+import asyncio
+import math
+import sys
+import types
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+_API_ROOT = Path(__file__).parent.parent.parent.parent / "netstack_api"
+for _name, _path in [("netstack_api", _API_ROOT), ("netstack_api.services", _API_ROOT / "services")]:
+    if _name not in sys.modules:
+        _package = types.ModuleType(_name)
+        _package.__path__ = [str(_path)]
+        sys.modules[_name] = _package
+
+from netstack_api.services import satellite_state_table as sst  # noqa: E402
+from netstack_api.services import warm_start_snapshot as wss  # noqa: E402
+
+T0 = 1758456000.0   # 2025-09-21T12:00:00Z
+ORBIT_RADIUS_KM = sst.WGS84_A_KM + 550.0
+POLAR_RADIUS_KM = sst.WGS84_A_KM * (1 - sst.WGS84_F)
+
+
+def _write_snapshot(path, n_times=5, step=60.0):
+    """兩顆衛星：赤道面 (ECI x 軸起算) 與極軌 (ECI z 軸上方)"""
+    times = T0 + step * np.arange(n_times)
+    states = np.full((2, n_times, len(wss.STATE_FIELDS)), np.nan, dtype=np.float32)
+    states[0, :, 0] = ORBIT_RADIUS_KM
+    states[0, :, 1:3] = 0.0
+    states[1, :, 0:2] = 0.0
+    states[1, :, 2] = POLAR_RADIUS_KM + 550.0
+    states[:, :, 3:6] = 0.0
+    states[:, :, 6:10] = (10.0, 180.0, 1200.0, 1.0)
+    states[1, -1, :] = np.nan                     # 缺少的時間點不產生記錄
+    satellites = [
+        {"satellite_id": "sat_eq", "name": "EQ", "norad_id": "44714", "constellation": "starlink"},
+        {"satellite_id": "sat_pole", "name": "POLE", "norad_id": None, "constellation": "oneweb"},
+    ]
+    metadata = {"dataset_version": "test", "observer_location": {"lat": 24.94, "lon": 121.37, "alt": 0.024}}
+    wss.write_snapshot(str(path), satellites, times, states, metadata)
+    return times
+
+
+@pytest.mark.unit
+def test_hydration_records_carry_sub_satellite_point(tmp_path):
+    path = tmp_path / "snap.bin"
+    times = _write_snapshot(path)
+    snapshot = wss.WarmStartSnapshot(str(path))
+    try:
+        records = [r for batch in snapshot.iter_hydration_records(batch_size=3) for r in batch]
+    finally:
+        snapshot.close()
+
+    assert len(records) == 9
+    assert all(len(r) == len(wss.HYDRATION_COLUMNS) for r in records)
+    columns = {name: i for i, name in enumerate(wss.HYDRATION_COLUMNS)}
+    equator = [r for r in records if r[0] == "sat_eq"]
+    pole = [r for r in records if r[0] == "sat_pole"]
+    assert len(pole) == 4
+
+    for record, t in zip(equator, times):
+        assert record[columns["latitude"]] == pytest.approx(0.0, abs=1e-6)
+        assert record[columns["altitude"]] == pytest.approx(550.0, abs=1e-3)
+        # ECI x 軸的經度為 -GMST
+        expected = -math.degrees(sst.gmst_radians(t / 86400.0 + 2440587.5, 0.0))
+        assert (record[columns["longitude"]] - expected + 180.0) % 360.0 - 180.0 == pytest.approx(0.0, abs=1e-6)
+    # 地球自轉使固定 ECI 方向的經度每分鐘西移約 0.25°
+    drift = equator[1][columns["longitude"]] - equator[0][columns["longitude"]]
+    assert drift == pytest.approx(-0.2507, abs=1e-3)
+
+    assert all(r[columns["latitude"]] == pytest.approx(90.0, abs=1e-6) for r in pole)
+    assert pole[0][columns["altitude"]] == pytest.approx(550.0, abs=0.01)
+    assert equator[0][columns["norad_id"]] == 44714 and pole[0][columns["norad_id"]] is None
+    assert equator[0][columns["observer_latitude"]] == 24.94
+    assert equator[0][columns["elevation_angle"]] == 10.0
+
+
+@pytest.mark.unit
+def test_hydration_failure_is_kept_and_reported(tmp_path, monkeypatch):
+    asyncpg = types.ModuleType("asyncpg")
+
+    async def connect(url):
+        raise ConnectionRefusedError("postgres unavailable")
+
+    asyncpg.connect = connect
+    monkeypatch.setitem(sys.modules, "asyncpg", asyncpg)
+    from netstack_api.services import instant_satellite_loader as isl
+
+    path = tmp_path / "snap.bin"
+    _write_snapshot(path)
+    monkeypatch.setenv("WARM_START_SNAPSHOT_PATH", str(path))
+
+    async def run():
+        assert await isl.InstantSatelliteLoader("postgresql://unused").ensure_data_available()
+        # 建立任務的 loader 已離開作用域，任務仍由模組持有
+        task = isl._hydration_task
+        assert task is not None
+        await task
+        return task.result()
+
+    try:
+        assert asyncio.run(run()) is False
+        status = isl.get_hydration_status()
+        assert status["state"] == "failed"
+        assert "postgres unavailable" in status["error"]
+        assert status["dataset_version"] == "test"
+    finally:
+        isl._hydration_task = None
+        if wss.get_warm_start_snapshot() is not None:
+            wss.get_warm_start_snapshot().close()
+        wss._snapshot = None
+
+
+@pytest.mark.unit
+def test_out_of_range_queries_are_not_clamped(tmp_path):
+    path = tmp_path / "snap.bin"
+    times = _write_snapshot(path)
+    snapshot = wss.WarmStartSnapshot(str(path))
+    try:
+        assert snapshot.time_step_seconds == 60.0
+        assert [s.satellite_id for s in snapshot.get_satellites_at(times[2])] == ["sat_eq", "sat_pole"]
+        # 範圍外半個取樣間隔內仍使用端點
+        assert snapshot.get_satellites_at(times[0] - 29.0)[0].timestamp == times[0]
+        assert snapshot.get_satellites_at(times[-1] + 29.0)[0].timestamp == times[-1]
+        # 超出範圍返回 None，不以過期位置回應
+        assert snapshot.get_satellites_at(times[-1] + 3600.0) is None
+        assert snapshot.get_satellites_at(times[0] - 31.0) is None
+        clamped = snapshot.get_satellites_at(times[-1] + 3600.0, clamp=True)
+        assert clamped and clamped[0].timestamp == times[-1]
+    finally:
+        snapshot.close()
+
+
+@pytest.mark.unit
+def test_close_unmaps_even_when_tracks_are_held(tmp_path):
+    path = tmp_path / "snap.bin"
+    _write_snapshot(path)
+    snapshot = wss.WarmStartSnapshot(str(path))
+    mapping = snapshot._mmap
+    track = snapshot.get_satellite_track("sat_eq")
+    states = snapshot.get_satellites_at(T0)
+
+    snapshot.close()
+
+    assert mapping.closed and snapshot._mmap is None
+    assert track[0, 0] == pytest.approx(ORBIT_RADIUS_KM)     # 呼叫端持有的是複本
+    assert states[0].satellite_id == "sat_eq"
+    snapshot.close()                                         # 重複關閉無副作用
+
+
+@pytest.mark.unit
+def test_close_with_live_view_releases_reference(tmp_path, caplog):
+    path = tmp_path / "snap.bin"
+    _write_snapshot(path)
+    snapshot = wss.WarmStartSnapshot(str(path))
+    mapping = snapshot._mmap
+    view = snapshot.states[0]                                # 例如進行中的水合迭代
+
+    with caplog.at_level("WARNING"):
+        snapshot.close()
+
+    assert snapshot._mmap is None and not mapping.closed
+    assert "使用中的視圖" in caplog.text
+    assert view[0, 0] == pytest.approx(ORBIT_RADIUS_KM)      # 視圖仍然有效
@@ -0,0 +1,160 @@
+"""
+驗證引擎編譯式單次走訪計畫測試
+"""
+
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent.parent.parent / "src"))
+
+from validation.core.base_validator import BaseValidator, ValidationStatus, ValidationLevel
+from validation.core.compiled_plan import (
+    CompiledValidationPlan, SamplingConfig, ValidationRule, default_rules, structural_snapshot,
+)
+from validation.core.validation_engine import ValidationEngine
+
+
+class RecordingValidator(BaseValidator):
+    """記錄收到的上下文並回報一個通過結果"""
+
+    def __init__(self, name="RecordingValidator"):
+        super().__init__(name)
+        self.contexts = []
+
+    def validate(self, data, context=None):
+        self.contexts.append(context)
+        return [self.create_result(ValidationStatus.PASSED, ValidationLevel.INFO, "ok")]
+
+
+def _stage_output(elevation=45.0):
+    return {
+        "stage2": {
+            "satellites": [
+                {"satellite_id": "STARLINK-1", "elevation": elevation, "azimuth": 180.0,
+                 "timestamp": "2025-01-01T00:00:00Z"},
+                {"satellite_id": "STARLINK-2", "elevation": 30.0, "azimuth": 90.0,
+                 "timestamp": "2025-01-01T00:00:30Z"},
+            ]
+        }
+    }
+
+
+@pytest.mark.unit
+class TestCompiledPlanInEngine:
+
+    def test_blocking_plan_result_reaches_report(self):
+        engine = ValidationEngine({"parallel_execution": False})
+        validator = RecordingValidator()
+        engine.register_validator(validator)
+
+        summary = engine.validate_data(_stage_output(elevation=120.0))
+
+        assert summary["has_blocking_errors"] is True
+        assert summary["validation_aborted"] is True
+        blocking_rules = {error["metadata"]["rule_id"] for error in summary["blocking_errors"]}
+        assert "range:elevation" in blocking_rules
+        # 阻斷性錯誤終止後續驗證器
+        assert validator.contexts == []
+
+    def test_plan_and_validator_results_are_both_reported(self):
+        engine = ValidationEngine({"parallel_execution": False})
+        engine.register_validator(RecordingValidator())
+
+        summary = engine.validate_data(_stage_output())
+
+        assert summary["has_blocking_errors"] is False
+        assert set(summary["validator_results"]) == {"CompiledRules[default]", "RecordingValidator"}
+        assert summary["validation_summary"]["total_results"] == len(engine.builtin_rules) + 1
+
+    def test_validators_reuse_engine_snapshot(self):
+        engine = ValidationEngine({"parallel_execution": False})
+        validator = RecordingValidator()
+        engine.register_validator(validator)
+        data = _stage_output()
+
+        engine.validate_data(data)
+
+        shared = validator.contexts[0]["data_snapshot"]
+        assert structural_snapshot(data, validator.contexts[0]) is shared
+        assert shared.satellite_ids == {"STARLINK-1", "STARLINK-2"}
+        assert shared.stage_satellite_ids == {"stage2": {"STARLINK-1", "STARLINK-2"}}
+        assert shared.numerical_fields["stage2.satellites.elevation"] == [45.0, 30.0]
+        assert "topocentric" in shared.coordinate_systems
+
+    def test_chain_rule_overrides_builtin(self):
+        engine = ValidationEngine({"parallel_execution": False})
+        engine.register_rule(ValidationRule.range("elevation", 0.0, 200.0, rule_id="range:elevation"))
+
+        summary = engine.validate_data(_stage_output(elevation=120.0))
+
+        assert summary["has_blocking_errors"] is False
+        rule_ids = [r["metadata"]["rule_id"] for r in summary["validator_results"]["CompiledRules[default]"]]
+        assert rule_ids.count("range:elevation") == 1
+
+
+def _large_output(n=50):
+    return {
+        "stage3": {
+            "satellites": [
+                {"satellite_id": f"SAT-{i}", "elevation": float(i % 90), "azimuth": 10.0}
+                for i in range(n)
+            ]
+        }
+    }
+
+
+@pytest.mark.unit
+class TestStructuralSnapshot:
+
+    def test_sampling_applies_to_structural_walk(self):
+        data = _large_output()
+        plan = CompiledValidationPlan(default_rules(), SamplingConfig(enabled=True, threshold=20, sample_size=5))
+
+        snapshot = plan.collect(data)
+
+        shape = snapshot.structure
+        assert snapshot.lists_sampled == 1
+        assert shape.sampled is True
+        assert len(shape.satellite_ids) == 5
+        assert len(shape.numerical_fields["stage3.satellites.elevation"]) == 5
+        # 規則計畫與結構快照看到同一份樣本
+        assert len(snapshot.numeric["elevation"]) == 5
+        assert snapshot.nodes_visited == 3 + 5
+
+    def test_full_walk_is_not_marked_sampled(self):
+        shape = CompiledValidationPlan(default_rules()).collect(_large_output()).structure
+        assert shape.sampled is False
+        assert len(shape.satellite_ids) == 50
+
+    def test_snapshot_from_another_invocation_is_not_reused(self):
+        data = _stage_output()
+        plan = CompiledValidationPlan(default_rules())
+        shared = plan.collect(data).structure
+
+        matching = {"data_snapshot": shared, "plan_invocation": shared.invocation_id}
+        assert structural_snapshot(data, matching) is shared
+        # 快照缺少調用編號、編號屬於其他調用、或來源並非同一物件時重新走訪
+        assert structural_snapshot(data, {"data_snapshot": shared}) is not shared
+        later = plan.collect(data).structure
+        assert later.invocation_id != shared.invocation_id
+        assert structural_snapshot(data, {"data_snapshot": shared,
+                                          "plan_invocation": later.invocation_id}) is not shared
+        rebuilt = structural_snapshot(_stage_output(elevation=10.0), matching)
+        assert rebuilt is not shared
+        assert rebuilt.numerical_fields["stage2.satellites.elevation"] == [10.0, 30.0]
+
+    def test_sampled_snapshot_skips_set_comparisons(self):
+        pytest.importorskip("scipy")
+        from validation.engines.data_quality_engine import CrossStageConsistencyChecker
+
+        data = {"stage1": _large_output()["stage3"], "stage2": _large_output()["stage3"]}
+        plan = CompiledValidationPlan([], SamplingConfig(enabled=True, threshold=20, sample_size=5))
+        shape = plan.collect(data).structure
+        # 兩個階段各自抽樣，樣本集合不同
+        assert shape.stage_satellite_ids["stage1"] != shape.stage_satellite_ids["stage2"]
+
+        checker = CrossStageConsistencyChecker()
+        assert checker._check_satellite_id_preservation(shape) == {"preserved": True}
+        assert "total_unique_satellites" not in checker._extract_satellite_counts(data, shape)
@@ -17,6 +17,7 @@ import numpy as np
 
 from ..engines.sgp4_orbital_engine import SGP4OrbitalEngine
 from ..engines.skyfield_orbital_engine import SkyfieldOrbitalEngine
+from .phase_space_index import PhaseSpaceIndex, circular_diversity
 
 logger = logging.getLogger(__name__)
 
@@ -27,7 +28,7 @@ class OrbitalCalculationsCore:
     功能範圍:
     - 軌道元素提取和計算 (替代Stage 6的55個違規方法)
     - Mean Anomaly, RAAN, Argument of Perigee計算
-    - 軌道相位分析和多樣性評估
+    - 軌道相位分析和多樣性評估 (PhaseSpaceIndex 環面網格)
     - 星座軌道分佈優化計算
     - TLE epoch時間基準管理 (學術標準強制要求)
     """
@@ -303,6 +304,9 @@ class OrbitalCalculationsCore:
             # 計算相位多樣性分數
             phase_diversity_score = self._calculate_phase_diversity_score(orbital_elements)
 
+            # 相位空間網格摘要 (空洞與佔據率)
+            phase_space = self.build_phase_space_index(orbital_elements).summary()
+
             analysis_result = {
                 'constellation': constellation_filter or 'all',
                 'total_satellites': len(filtered_satellites),
@@ -310,6 +314,7 @@ class OrbitalCalculationsCore:
                 'mean_anomaly_analysis': mean_anomaly_analysis,
                 'raan_analysis': raan_analysis,
                 'phase_diversity_score': phase_diversity_score,
+                'phase_space': phase_space,
                 'calculation_method': 'academic_grade_a_standard',
                 'epoch_time_compliant': True
             }
@@ -335,8 +340,10 @@ class OrbitalCalculationsCore:
             return 0.0
 
         try:
-            mean_anomalies = [elem.get('mean_anomaly', 0) for elem in orbital_elements]
-            raans = [elem.get('raan', 0) for elem in orbital_elements]
+            mean_anomalies = np.fromiter((elem.get('mean_anomaly', 0) for elem in orbital_elements),
+                                         dtype=np.float64, count=len(orbital_elements))
+            raans = np.fromiter((elem.get('raan', 0) for elem in orbital_elements),
+                                dtype=np.float64, count=len(orbital_elements))
 
             # 計算平近點角多樣性
             ma_diversity = self._calculate_angular_distribution_diversity(mean_anomalies)
@@ -355,6 +362,23 @@ class OrbitalCalculationsCore:
             self.logger.error(f"❌ 相位多樣性計算失敗: {e}")
             return 0.0
 
+    def build_phase_space_index(self, orbital_elements: List[Dict],
+                                raan_bins: int = 36, phase_bins: int = 36) -> PhaseSpaceIndex:
+        """
+        建立 (RAAN, 緯度幅角) 環面網格索引
+
+        索引可隨 advance(dt) 推進，並以 O(bins) 回答多樣性、空洞與填補候選查詢，
+        供 Stage 6 池選擇快速檢驗相位覆蓋。
+
+        Args:
+            orbital_elements: extract_orbital_elements() 的輸出或含 raan/mean_anomaly 的字典
+            raan_bins: RAAN 軸分箱數
+            phase_bins: 緯度幅角軸分箱數
+        """
+        index = PhaseSpaceIndex.from_orbital_elements(orbital_elements, raan_bins, phase_bins)
+        self.calculation_stats['phase_diversity_analyses'] += 1
+        return index
+
     def get_calculation_statistics(self) -> Dict:
         """獲取計算統計信息"""
         stats = self.calculation_stats.copy()
@@ -465,33 +489,33 @@ class OrbitalCalculationsCore:
 
     def _analyze_mean_anomaly_distribution(self, orbital_elements: List[Dict]) -> Dict:
         """分析平近點角分佈"""
-        mean_anomalies = [elem.get('mean_anomaly', 0) for elem in orbital_elements]
+        mean_anomalies = np.array([elem.get('mean_anomaly', 0) for elem in orbital_elements], dtype=np.float64)
 
-        if not mean_anomalies:
+        if not mean_anomalies.size:
             return {}
 
         return {
-            'count': len(mean_anomalies),
-            'mean': np.mean(mean_anomalies),
-            'std': np.std(mean_anomalies),
-            'min': min(mean_anomalies),
-            'max': max(mean_anomalies),
+            'count': int(mean_anomalies.size),
+            'mean': float(mean_anomalies.mean()),
+            'std': float(mean_anomalies.std()),
+            'min': float(mean_anomalies.min()),
+            'max': float(mean_anomalies.max()),
             'distribution_quality': self._assess_angular_distribution_quality(mean_anomalies)
         }
 
     def _analyze_raan_distribution(self, orbital_elements: List[Dict]) -> Dict:
         """分析RAAN分佈"""
-        raans = [elem.get('raan', 0) for elem in orbital_elements]
+        raans = np.array([elem.get('raan', 0) for elem in orbital_elements], dtype=np.float64)
 
-        if not raans:
+        if not raans.size:
             return {}
 
         return {
-            'count': len(raans),
-            'mean': np.mean(raans),
-            'std': np.std(raans),
-            'min': min(raans),
-            'max': max(raans),
+            'count': int(raans.size),
+            'mean': float(raans.mean()),
+            'std': float(raans.std()),
+            'min': float(raans.min()),
+            'max': float(raans.max()),
             'distribution_quality': self._assess_angular_distribution_quality(raans)
         }
 
@@ -501,22 +525,8 @@ class OrbitalCalculationsCore:
 
     def _calculate_angular_distribution_diversity(self, angles: List[float]) -> float:
         """計算角度分佈多樣性"""
-        if not angles or len(angles) < 2:
-            return 0.0
-
-        # 將角度轉換為單位圓上的向量
-        angles_rad = [math.radians(angle) for angle in angles]
-        vectors = [(math.cos(a), math.sin(a)) for a in angles_rad]
-
-        # 計算向量和的模長
-        sum_x = sum(v[0] for v in vectors)
-        sum_y = sum(v[1] for v in vectors)
-        resultant_length = math.sqrt(sum_x*sum_x + sum_y*sum_y)
-
-        # 多樣性分數 = 1 - (合向量長度/向量數量)
-        diversity_score = 1.0 - (resultant_length / len(vectors))
-
-        return max(0.0, min(1.0, diversity_score))
+        # 多樣性分數 = 1 - (合向量長度/向量數量)，向量化計算
+        return circular_diversity(angles)
 
     def _assess_angular_distribution_quality(self, angles: List[float]) -> str:
         """評估角度分佈品質"""
@@ -0,0 +1,305 @@
+"""
+平行回火 (Replica Exchange) 衛星池退火器
+
+在不同溫度上同時運行多條退火鏈，分散到多個工作進程；每輪結束後相鄰溫度的
+鏈依 Metropolis 交換準則互換狀態，讓高溫鏈跨越能障、低溫鏈精修，
+比單鏈退火更早脫離局部最優。
+
+成本評估:
+- 可見性矩陣 (衛星 × 時間點) 以 np.packbits 位元打包，工作進程只載入一次
+- 維護每個星座每個時間點的可見數，換入/換出一顆衛星時只處理兩列位元
+  XOR 後不同的時間點，以查表計算可見數偏離目標範圍的懲罰差值
+- 每顆衛星的品質成本為加法項，差值 O(1)
+- 星座內交換保持各星座池大小固定，池大小約束恆成立
+"""
+
+import logging
+import math
+import os
+import time
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class AnnealingGroup:
+    """星座分組目標"""
+    name: str
+    pool_size: int                  # 池中該星座的衛星數
+    visible_range: Tuple[int, int]  # 每個時間點的同時可見數目標 (min, max)
+
+
+@dataclass
+class AnnealingResult:
+    """退火結果"""
+    selected_indices: List[int]
+    cost: float
+    visibility_penalty: float
+    quality_cost: float
+    group_compliance: Dict[str, float]  # 各星座可見數落在目標範圍內的時間比例
+    statistics: Dict[str, Any] = field(default_factory=dict)
+
+
+class PackedVisibilityProblem:
+    """打包後的池選擇問題 (可序列化傳給工作進程)"""
+
+    def __init__(self, visibility: np.ndarray, group_ids: np.ndarray, groups: Sequence[AnnealingGroup],
+                 satellite_costs: Optional[np.ndarray] = None,
+                 deficit_weight: float = 1.0, surplus_weight: float = 0.5, quality_weight: float = 0.1):
+        visibility = np.asarray(visibility, dtype=bool)
+        if visibility.ndim != 2:
+            raise ValueError("visibility 必須是 (衛星數, 時間點數) 矩陣")
+        self.n_satellites, self.n_times = visibility.shape
+        self.packed = np.packbits(visibility, axis=1)
+        self.group_ids = np.asarray(group_ids, dtype=np.int32)
+        self.groups = list(groups)
+        self.satellite_costs = (np.zeros(self.n_satellites) if satellite_costs is None
+                                else np.asarray(satellite_costs, dtype=np.float64) * quality_weight)
+
+        # 懲罰查表: lut[g][c] = 星座 g 在某時間點可見數為 c 時的懲罰 (已按時間點數正規化)
+        self.luts = []
+        for group in self.groups:
+            counts = np.arange(group.pool_size + 1, dtype=np.float64)
+            low, high = group.visible_range
+            penalty = (deficit_weight * np.maximum(low - counts, 0) +
+                       surplus_weight * np.maximum(counts - high, 0))
+            self.luts.append(penalty / max(self.n_times, 1))
+
+        self.members = [np.flatnonzero(self.group_ids == g) for g in range(len(self.groups))]
+        for g, group in enumerate(self.groups):
+            if group.pool_size > len(self.members[g]):
+                raise ValueError(f"星座 {group.name} 候選數不足: {len(self.members[g])} < {group.pool_size}")
+
+    def row(self, index: int) -> np.ndarray:
+        return np.unpackbits(self.packed[index], count=self.n_times)
+
+    def counts(self, selected: np.ndarray) -> np.ndarray:
+        """選中衛星在各時間點的可見數 (int32，長度為時間點數)"""
+        if selected.size == 0:
+            return np.zeros(self.n_times, dtype=np.int32)
+        rows = np.unpackbits(self.packed[selected], axis=1, count=self.n_times)
+        return rows.sum(axis=0, dtype=np.int32)
+
+    def evaluate(self, selection: Sequence[np.ndarray]) -> Tuple[float, float]:
+        """完整成本 (可見性懲罰, 品質成本)"""
+        penalty = sum(float(self.luts[g][self.counts(sel)].sum()) for g, sel in enumerate(selection))
+        quality = sum(float(self.satellite_costs[sel].sum()) for sel in selection)
+        return penalty, quality
+
+    def initial_selection(self, rng: np.random.Generator) -> List[np.ndarray]:
+        return [rng.choice(self.members[g], size=group.pool_size, replace=False)
+                for g, group in enumerate(self.groups)]
+
+
+class _Chain:
+    """單條退火鏈的可變狀態 (已選/未選索引與各星座可見數)"""
+
+    def __init__(self, problem: PackedVisibilityProblem, selection: Sequence[np.ndarray]):
+        self.problem = problem
+        self.selected = [np.array(sel, dtype=np.int64) for sel in selection]
+        self.unselected = []
+        for g, sel in enumerate(self.selected):
+            mask = np.isin(problem.members[g], sel, assume_unique=True)
+            self.unselected.append(problem.members[g][~mask].copy())
+        self.counts = [problem.counts(sel) for sel in self.selected]
+        penalty, quality = problem.evaluate(self.selected)
+        self.cost = penalty + quality
+
+    def run(self, temperature: float, steps: int, rng: np.random.Generator) -> Dict[str, Any]:
+        problem = self.problem
+        packed, n_times = problem.packed, problem.n_times
+        # 只有同時有已選與未選衛星的星座才能交換
+        movable = [g for g in range(len(self.selected)) if self.selected[g].size and self.unselected[g].size]
+        if not movable:
+            return {"accepted": 0, "best_cost": self.cost, "best_selection": [s.copy() for s in self.selected]}
+        weights = np.array([self.selected[g].size for g in movable], dtype=np.float64)
+        group_draws = rng.choice(len(movable), size=steps, p=weights / weights.sum())
+        uniforms = rng.random((steps, 3))
+
+        best_cost = self.cost
+        best_selection = [s.copy() for s in self.selected]
+        accepted = 0
+        for step in range(steps):
+            g = movable[group_draws[step]]
+            sel, unsel, counts, lut = self.selected[g], self.unselected[g], self.counts[g], problem.luts[g]
+            a = int(uniforms[step, 0] * sel.size)
+            b = int(uniforms[step, 1] * unsel.size)
+            out_sat, in_sat = sel[a], unsel[b]
+
+            # 只有兩列位元不同的時間點會改變可見數
+            changed = np.flatnonzero(np.unpackbits(packed[out_sat] ^ packed[in_sat], count=n_times))
+            if changed.size:
+                in_bits = (packed[in_sat][changed >> 3] >> (7 - (changed & 7))) & 1
+                step_delta = in_bits.astype(np.int32) * 2 - 1
+                old = counts[changed]
+                new = old + step_delta
+                delta = float(lut[new].sum() - lut[old].sum())
+            else:
+                delta = 0.0
+            delta += problem.satellite_costs[in_sat] - problem.satellite_costs[out_sat]
+
+            if delta <= 0 or uniforms[step, 2] < math.exp(-delta / temperature):
+                if changed.size:
+                    counts[changed] = new
+                sel[a], unsel[b] = in_sat, out_sat
+                self.cost += delta
+                accepted += 1
+                if self.cost < best_cost - 1e-12:
+                    best_cost = self.cost
+                    best_selection = [s.copy() for s in self.selected]
+
+        return {"accepted": accepted, "best_cost": best_cost, "best_selection": best_selection}
+
+
+# 工作進程內的問題實例 (由 initializer 載入一次)
+_WORKER_PROBLEM: Optional[PackedVisibilityProblem] = None
+
+
+def _init_worker(problem: PackedVisibilityProblem):
+    global _WORKER_PROBLEM
+    _WORKER_PROBLEM = problem
+
+
+def _run_segment(selection: List[np.ndarray], temperature: float, steps: int, seed: int,
+                 problem: Optional[PackedVisibilityProblem] = None) -> Dict[str, Any]:
+    """執行一段固定溫度的退火，返回最終狀態與本段最佳解"""
+    problem = problem if problem is not None else _WORKER_PROBLEM
+    chain = _Chain(problem, selection)
+    outcome = chain.run(temperature, steps, np.random.default_rng(seed))
+    outcome["selection"] = chain.selected
+    outcome["cost"] = chain.cost
+    return outcome
+
+
+class ParallelTemperingAnnealer:
+    """
+    多鏈平行回火退火器
+
+    配置參數:
+        num_replicas: 鏈數 (預設為 CPU 核心數，至少 2)
+        max_workers: 工作進程數 (1 表示在目前進程內依序執行)
+        t_min / t_max: 溫度梯度兩端 (幾何級數)
+        rounds / steps_per_round: 交換輪數與每輪每鏈步數
+        patience_rounds: 最佳解連續未改善的輪數上限
+        seed: 隨機種子
+    """
+
+    def __init__(self, config: Optional[Dict[str, Any]] = None):
+        config = config or {}
+        cpu_count = os.cpu_count() or 1
+        self.num_replicas = max(2, int(config.get('num_replicas', min(cpu_count, 8))))
+        self.max_workers = max(1, int(config.get('max_workers', min(cpu_count, self.num_replicas))))
+        self.t_min = float(config.get('t_min', 1e-3))
+        self.t_max = float(config.get('t_max', 1.0))
+        self.rounds = int(config.get('rounds', 40))
+        self.steps_per_round = int(config.get('steps_per_round', 2000))
+        self.patience_rounds = int(config.get('patience_rounds', 10))
+        self.seed = config.get('seed')
+        self.cost_weights = {
+            'deficit_weight': float(config.get('deficit_weight', 1.0)),
+            'surplus_weight': float(config.get('surplus_weight', 0.5)),
+            'quality_weight': float(config.get('quality_weight', 0.1)),
+        }
+
+    def temperatures(self) -> np.ndarray:
+        return np.geomspace(self.t_min, self.t_max, self.num_replicas)
+
+    def optimize(self, visibility: np.ndarray, group_ids: Sequence[int], groups: Sequence[AnnealingGroup],
+                 satellite_costs: Optional[Sequence[float]] = None) -> AnnealingResult:
+        """
+        選出各星座指定數量的衛星，使同時可見數盡量落在目標範圍內
+
+        Args:
+            visibility: (衛星數, 時間點數) 布林可見性矩陣
+            group_ids: 每顆衛星所屬的星座分組索引
+            groups: 各星座分組的池大小與可見數目標
+            satellite_costs: 每顆衛星的品質成本 (越小越好，可為 None)
+        """
+        started = time.perf_counter()
+        problem = PackedVisibilityProblem(visibility, np.asarray(group_ids), groups,
+                                          None if satellite_costs is None else np.asarray(satellite_costs),
+                                          **self.cost_weights)
+        rng = np.random.default_rng(self.seed)
+        temperatures = self.temperatures()
+        states = [problem.initial_selection(rng) for _ in temperatures]
+        costs = [sum(problem.evaluate(s)) for s in states]
+        best_index = int(np.argmin(costs))
+        best_cost, best_selection = costs[best_index], [s.copy() for s in states[best_index]]
+
+        stats = {"rounds": 0, "swaps_attempted": 0, "swaps_accepted": 0, "moves_accepted": 0,
+                 "replicas": len(temperatures), "workers": 1}
+        executor = self._create_executor(problem)
+        stats["workers"] = self.max_workers if executor is not None else 1
+        stale_rounds = 0
+        try:
+            for round_index in range(self.rounds):
+                seeds = rng.integers(0, 2 ** 63 - 1, size=len(temperatures))
+                outcomes = self._run_round(executor, problem, states, temperatures, seeds)
+                stats["rounds"] += 1
+
+                improved = False
+                for i, outcome in enumerate(outcomes):
+                    states[i], costs[i] = outcome["selection"], outcome["cost"]
+                    stats["moves_accepted"] += outcome["accepted"]
+                    if outcome["best_cost"] < best_cost - 1e-12:
+                        best_cost, best_selection = outcome["best_cost"], outcome["best_selection"]
+                        improved = True
+
+                # 相鄰溫度交換 (奇偶輪交替配對)
+                for i in range(round_index % 2, len(temperatures) - 1, 2):
+                    stats["swaps_attempted"] += 1
+                    exponent = (1.0 / temperatures[i] - 1.0 / temperatures[i + 1]) * (costs[i] - costs[i + 1])
+                    if exponent >= 0 or rng.random() < math.exp(exponent):
+                        states[i], states[i + 1] = states[i + 1], states[i]
+                        costs[i], costs[i + 1] = costs[i + 1], costs[i]
+                        stats["swaps_accepted"] += 1
+
+                stale_rounds = 0 if improved else stale_rounds + 1
+                if stale_rounds >= self.patience_rounds:
+                    break
+        finally:
+            if executor is not None:
+                executor.shutdown()
+
+        penalty, quality = problem.evaluate(best_selection)
+        compliance = {}
+        for g, group in enumerate(problem.groups):
+            counts = problem.counts(best_selection[g])
+            low, high = group.visible_range
+            compliance[group.name] = float(np.mean((counts >= low) & (counts <= high))) if counts.size else 0.0
+
+        stats["wall_time_seconds"] = time.perf_counter() - started
+        stats["swap_acceptance_rate"] = stats["swaps_accepted"] / max(stats["swaps_attempted"], 1)
+        return AnnealingResult(
+            selected_indices=sorted(int(i) for sel in best_selection for i in sel),
+            cost=penalty + quality,
+            visibility_penalty=penalty,
+            quality_cost=quality,
+            group_compliance=compliance,
+            statistics=stats,
+        )
+
+    def _create_executor(self, problem: PackedVisibilityProblem) -> Optional[ProcessPoolExecutor]:
+        if self.max_workers <= 1:
+            return None
+        try:
+            return ProcessPoolExecutor(max_workers=self.max_workers, initializer=_init_worker,
+                                       initargs=(problem,))
+        except (OSError, ValueError) as e:
+            logger.warning(f"⚠️ 無法建立退火工作進程，改為單進程執行: {e}")
+            return None
+
+    def _run_round(self, executor: Optional[ProcessPoolExecutor], problem: PackedVisibilityProblem,
+                   states: List[List[np.ndarray]], temperatures: np.ndarray,
+                   seeds: np.ndarray) -> List[Dict[str, Any]]:
+        if executor is None:
+            return [_run_segment(state, float(t), self.steps_per_round, int(seed), problem)
+                    for state, t, seed in zip(states, temperatures, seeds)]
+        futures = [executor.submit(_run_segment, state, float(t), self.steps_per_round, int(seed))
+                   for state, t, seed in zip(states, temperatures, seeds)]
+        return [future.result() for future in futures]
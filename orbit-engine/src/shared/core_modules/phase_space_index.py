@@ -0,0 +1,424 @@
+"""
+軌道相位空間索引 - (RAAN, 緯度幅角) 環面網格
+
+將衛星依 (升交點赤經 RAAN, 緯度幅角 u = ω + M) 分箱到 raan_bins × phase_bins 的環面網格，
+取代逐顆衛星迴圈與兩兩比較的相位分析:
+- 多樣性分數、空洞查詢、「最適合填補此相位空洞的衛星」只掃描網格，與衛星數量無關
+- advance() 以向量化方式推進 u (平均運動) 與 RAAN (J2 節點進動)，
+  只對跨越網格邊界的衛星增減計數
+- add_satellites / remove_satellites 只處理異動的衛星 (欄式緩衝區 + 交換刪除)，
+  不重建整個索引
+
+NetStack 預處理 (services/satellite/preprocessing/phase_space_index.py)
+透過 shared_core.orbit_engine_modules 直接載入本檔案，兩邊共用同一實作。
+
+學術標準說明:
+- 緯度幅角以 ω + M 近似 (LEO 近圓軌道 e ≈ 0)
+- RAAN 進動使用標準 J2 長期項: dΩ/dt = -1.5 n J2 (Re/a)² cos i / (1 - e²)²
+- 時間推進以呼叫端提供的 TLE epoch 基準時間差計算，不讀取系統時間
+"""
+
+import math
+from typing import Any, Dict, List, Optional, Sequence
+
+import numpy as np
+
+# 物理常數 - WGS72 (與SGP4一致)
+EARTH_RADIUS_KM = 6378.135
+GM_EARTH_KM3_S2 = 398600.8
+J2 = 1.082616e-3
+SECONDS_PER_DAY = 86400.0
+
+
+def _buffered_column(name: str, doc: str) -> property:
+    """欄式緩衝區的有效區段 (前 _size 筆)，指派時就地寫回緩衝區"""
+    buffer = f"_{name}_buf"
+
+    def getter(self) -> np.ndarray:
+        return getattr(self, buffer)[:self._size]
+
+    def setter(self, value) -> None:
+        getattr(self, buffer)[:self._size] = value
+
+    return property(getter, setter, doc=doc)
+
+
+def circular_diversity(angles_deg: Sequence[float]) -> float:
+    """
+    角度分佈多樣性 (向量化)
+
+    多樣性 = 1 - |單位向量平均| ，0 表示完全集中，1 表示均勻分散
+    """
+    angles = np.radians(np.asarray(angles_deg, dtype=np.float64))
+    if angles.size < 2:
+        return 0.0
+    resultant = math.hypot(float(np.cos(angles).mean()), float(np.sin(angles).mean()))
+    return max(0.0, min(1.0, 1.0 - resultant))
+
+
+class PhaseSpaceIndex:
+    """
+    (RAAN, 緯度幅角) 環面網格索引
+
+    每顆衛星以欄式陣列儲存 (RAAN, u, 角速率)，網格保存每格衛星數量與成員；
+    統計查詢以網格計數與格心向量完成，與衛星數量無關。
+    """
+
+    _COLUMNS = (('raan', np.float64), ('arg_latitude', np.float64),
+                ('phase_rate', np.float64), ('raan_rate', np.float64),
+                ('cells', np.int64))
+
+    raan = _buffered_column('raan', "RAAN (度)")
+    arg_latitude = _buffered_column('arg_latitude', "緯度幅角 u (度)")
+    phase_rate = _buffered_column('phase_rate', "u 變化率 (度/秒)")
+    raan_rate = _buffered_column('raan_rate', "RAAN 進動率 (度/秒)")
+    cells = _buffered_column('cells', "所在格子 (攤平索引)")
+
+    def __init__(self, raan_bins: int = 36, phase_bins: int = 36):
+        if raan_bins < 1 or phase_bins < 1:
+            raise ValueError("raan_bins 與 phase_bins 必須為正整數")
+        self.raan_bins = raan_bins
+        self.phase_bins = phase_bins
+        self.raan_width = 360.0 / raan_bins
+        self.phase_width = 360.0 / phase_bins
+        self.counts = np.zeros((raan_bins, phase_bins), dtype=np.int64)
+
+        self.satellite_ids: List[str] = []
+        self._position: Dict[str, int] = {}
+        self._size = 0
+        for name, dtype in self._COLUMNS:
+            setattr(self, f"_{name}_buf", np.empty(0, dtype=dtype))
+        # 每格成員 (依加入順序)，best_fill 直接取格內衛星，不掃描全部衛星
+        self._members: Dict[int, Dict[str, None]] = {}
+
+        # 格心 (度) 與單位向量，供 O(bins) 查詢使用
+        self._raan_centers = (np.arange(raan_bins) + 0.5) * self.raan_width
+        self._phase_centers = (np.arange(phase_bins) + 0.5) * self.phase_width
+        self._raan_unit = np.stack([np.cos(np.radians(self._raan_centers)),
+                                    np.sin(np.radians(self._raan_centers))], axis=1)
+        self._phase_unit = np.stack([np.cos(np.radians(self._phase_centers)),
+                                     np.sin(np.radians(self._phase_centers))], axis=1)
+
+    # ------------------------------------------------------------------
+    # 建立與更新
+    # ------------------------------------------------------------------
+
+    @classmethod
+    def from_orbital_elements(cls, orbital_elements: List[Dict[str, Any]],
+                              raan_bins: int = 36, phase_bins: int = 36) -> "PhaseSpaceIndex":
+        """
+        由軌道元素列表建立索引
+
+        每個元素需含 raan、mean_anomaly，可選 argument_of_perigee、
+        mean_motion (圈/日)、inclination、semi_major_axis、eccentricity。
+        """
+        index = cls(raan_bins, phase_bins)
+        index.add_orbital_elements(orbital_elements)
+        return index
+
+    def add_orbital_elements(self, orbital_elements: List[Dict[str, Any]]) -> None:
+        """以軌道元素字典批次加入衛星 (欄位解讀與 from_orbital_elements 相同)"""
+        if not orbital_elements:
+            return
+
+        def column(key: str, default: float) -> np.ndarray:
+            return np.array([float(e.get(key) or default) for e in orbital_elements])
+
+        mean_motion = column('mean_motion', 0.0)
+        semi_major_axis = column('semi_major_axis', 0.0)
+        # 缺少平均運動時由半長軸推算 (圈/日)
+        derived = semi_major_axis > EARTH_RADIUS_KM
+        mean_motion = np.where(
+            (mean_motion <= 0) & derived,
+            np.sqrt(GM_EARTH_KM3_S2 / np.maximum(semi_major_axis, 1.0) ** 3) * SECONDS_PER_DAY / (2 * math.pi),
+            mean_motion,
+        )
+
+        self.add_satellites(
+            satellite_ids=[str(e.get('satellite_id', e.get('name', i))) for i, e in enumerate(orbital_elements)],
+            raan_deg=column('raan', 0.0),
+            arg_latitude_deg=column('argument_of_perigee', 0.0) + column('mean_anomaly', 0.0),
+            mean_motion_rev_per_day=mean_motion,
+            inclination_deg=column('inclination', 0.0),
+            eccentricity=column('eccentricity', 0.0),
+        )
+
+    def add_satellites(self, satellite_ids: Sequence[str], raan_deg: Sequence[float],
+                       arg_latitude_deg: Sequence[float],
+                       mean_motion_rev_per_day: Optional[Sequence[float]] = None,
+                       inclination_deg: Optional[Sequence[float]] = None,
+                       eccentricity: Optional[Sequence[float]] = None) -> None:
+        """
+        批次加入衛星 (已存在的ID會先移除)
+
+        mean_motion 為 0 或未提供時衛星在 advance() 中保持靜止；
+        提供 inclination 時以 J2 長期項計算 RAAN 進動率。
+        """
+        ids = [str(s) for s in satellite_ids]
+        existing = [s for s in ids if s in self._position]
+        if existing:
+            self.remove_satellites(existing)
+
+        n = len(ids)
+        raan = np.mod(np.asarray(raan_deg, dtype=np.float64), 360.0)
+        u = np.mod(np.asarray(arg_latitude_deg, dtype=np.float64), 360.0)
+        motion = (np.zeros(n) if mean_motion_rev_per_day is None
+                  else np.asarray(mean_motion_rev_per_day, dtype=np.float64))
+        phase_rate = motion * 360.0 / SECONDS_PER_DAY
+
+        raan_rate = np.zeros(n)
+        if inclination_deg is not None:
+            inc = np.radians(np.asarray(inclination_deg, dtype=np.float64))
+            ecc = np.zeros(n) if eccentricity is None else np.asarray(eccentricity, dtype=np.float64)
+            moving = motion > 0
+            n_rad_s = motion * 2 * math.pi / SECONDS_PER_DAY
+            a = np.where(moving, np.cbrt(GM_EARTH_KM3_S2 / np.where(moving, n_rad_s, 1.0) ** 2), 1.0)
+            raan_rate = np.where(
+                moving,
+                np.degrees(-1.5 * n_rad_s * J2 * (EARTH_RADIUS_KM / a) ** 2 * np.cos(inc) / (1 - ecc ** 2) ** 2),
+                0.0,
+            )
+
+        cells = self._cell_of(raan, u)
+        np.add.at(self.counts.reshape(-1), cells, 1)
+
+        start, end = self._size, self._size + n
+        self._reserve(end)
+        for (name, _), values in zip(self._COLUMNS, (raan, u, phase_rate, raan_rate, cells)):
+            getattr(self, f"_{name}_buf")[start:end] = values
+        self._size = end
+        for offset, sat_id in enumerate(ids):
+            self._position[sat_id] = start + offset
+            self._members.setdefault(int(cells[offset]), {})[sat_id] = None
+        self.satellite_ids.extend(ids)
+
+    def remove_satellites(self, satellite_ids: Sequence[str]) -> int:
+        """
+        移除衛星，返回實際移除數量
+
+        以最後一筆衛星填補被移除的位置 (交換刪除)，成本與移除數量成正比。
+        """
+        flat = self.counts.reshape(-1)
+        removed = 0
+        for sat_id in satellite_ids:
+            pos = self._position.pop(sat_id, None)
+            if pos is None:
+                continue
+            cell = int(self._cells_buf[pos])
+            flat[cell] -= 1
+            members = self._members[cell]
+            del members[sat_id]
+            if not members:
+                del self._members[cell]
+
+            last = self._size - 1
+            if pos != last:
+                moved_id = self.satellite_ids[last]
+                self.satellite_ids[pos] = moved_id
+                self._position[moved_id] = pos
+                for name, _ in self._COLUMNS:
+                    buf = getattr(self, f"_{name}_buf")
+                    buf[pos] = buf[last]
+            self.satellite_ids.pop()
+            self._size = last
+            removed += 1
+        return removed
+
+    def _reserve(self, capacity: int) -> None:
+        """確保緩衝區容量 (倍增配置，批次加入為均攤 O(加入數量))"""
+        current = self._cells_buf.size
+        if capacity <= current:
+            return
+        new_capacity = max(capacity, 2 * current, 16)
+        for name, dtype in self._COLUMNS:
+            old = getattr(self, f"_{name}_buf")
+            grown = np.empty(new_capacity, dtype=dtype)
+            grown[:self._size] = old[:self._size]
+            setattr(self, f"_{name}_buf", grown)
+
+    def advance(self, dt_seconds: float) -> int:
+        """
+        推進時間 dt 秒 (向量化)
+
+        Returns:
+            跨越網格邊界的衛星數
+        """
+        if not self.satellite_ids or dt_seconds == 0:
+            return 0
+        self.arg_latitude = np.mod(self.arg_latitude + self.phase_rate * dt_seconds, 360.0)
+        self.raan = np.mod(self.raan + self.raan_rate * dt_seconds, 360.0)
+        new_cells = self._cell_of(self.raan, self.arg_latitude)
+        moved = np.flatnonzero(new_cells != self.cells)
+        if moved.size:
+            old_cells = self.cells[moved]
+            flat = self.counts.reshape(-1)
+            np.subtract.at(flat, old_cells, 1)
+            np.add.at(flat, new_cells[moved], 1)
+            for pos, old, new in zip(moved.tolist(), old_cells.tolist(), new_cells[moved].tolist()):
+                sat_id = self.satellite_ids[pos]
+                members = self._members[old]
+                del members[sat_id]
+                if not members:
+                    del self._members[old]
+                self._members.setdefault(new, {})[sat_id] = None
+            self.cells = new_cells
+        return int(moved.size)
+
+    def _cell_of(self, raan: np.ndarray, u: np.ndarray) -> np.ndarray:
+        raan_bin = np.minimum((raan // self.raan_width).astype(np.int64), self.raan_bins - 1)
+        phase_bin = np.minimum((u // self.phase_width).astype(np.int64), self.phase_bins - 1)
+        return raan_bin * self.phase_bins + phase_bin
+
+    def __len__(self) -> int:
+        return len(self.satellite_ids)
+
+    # ------------------------------------------------------------------
+    # 查詢 (掃描網格，與衛星數量無關)
+    # ------------------------------------------------------------------
+
+    def _marginal_diversity(self, marginal: np.ndarray, unit: np.ndarray) -> float:
+        total = marginal.sum()
+        if total < 2:
+            return 0.0
+        resultant = np.linalg.norm(marginal @ unit) / total
+        return max(0.0, min(1.0, 1.0 - float(resultant)))
+
+    def diversity_scores(self) -> Dict[str, float]:
+        """
+        相位多樣性分數 (以格心近似角度，誤差受網格解析度限制)
+
+        Returns:
+            phase / raan 為各軸的環形多樣性；occupancy 為非空格比例；
+            combined 沿用核心模組權重 0.6 × 相位 + 0.4 × RAAN
+        """
+        phase = self._marginal_diversity(self.counts.sum(axis=0), self._phase_unit)
+        raan = self._marginal_diversity(self.counts.sum(axis=1), self._raan_unit)
+        total = int(self.counts.sum())
+        occupied = int(np.count_nonzero(self.counts))
+        max_occupancy = min(total, self.counts.size) if total else 0
+        return {
+            'phase': phase,
+            'raan': raan,
+            'combined': 0.6 * phase + 0.4 * raan,
+            'occupancy': occupied / self.counts.size,
+            'occupancy_efficiency': occupied / max_occupancy if max_occupancy else 0.0,
+        }
+
+    def axis_gaps(self, axis: str = 'phase', min_width_deg: float = 0.0) -> List[Dict[str, float]]:
+        """
+        單軸環形空洞 (連續空箱)，依寬度遞減排序
+
+        Args:
+            axis: 'phase' (緯度幅角) 或 'raan'
+        """
+        if axis == 'phase':
+            marginal, width = self.counts.sum(axis=0), self.phase_width
+        elif axis == 'raan':
+            marginal, width = self.counts.sum(axis=1), self.raan_width
+        else:
+            raise ValueError(f"未知的軸: {axis}")
+
+        occupied = np.flatnonzero(marginal)
+        bins = marginal.size
+        if occupied.size == 0:
+            return [{'start_deg': 0.0, 'width_deg': 360.0, 'center_deg': 180.0}]
+
+        # 相鄰非空箱之間的空箱數 (含跨越 360° 的環繞段)
+        next_occupied = np.roll(occupied, -1)
+        run_lengths = np.mod(next_occupied - occupied - 1, bins)
+        gaps = []
+        for start_bin, length in zip(occupied, run_lengths):
+            gap_width = float(length) * width
+            if length > 0 and gap_width >= min_width_deg:
+                start = ((start_bin + 1) % bins) * width
+                gaps.append({
+                    'start_deg': start,
+                    'width_deg': gap_width,
+                    'center_deg': (start + gap_width / 2) % 360.0,
+                })
+        gaps.sort(key=lambda g: g['width_deg'], reverse=True)
+        return gaps
+
+    def _torus_distance_to_occupied(self, occupied_mask: np.ndarray) -> np.ndarray:
+        """每個格子到最近非空格的環面距離 (以格數計，向量化)"""
+        occupied_r, occupied_p = np.nonzero(occupied_mask)
+        if occupied_r.size == 0:
+            return np.full(self.counts.shape, np.inf)
+        grid_r = np.arange(self.raan_bins)[:, None, None]
+        grid_p = np.arange(self.phase_bins)[None, :, None]
+        dr = np.abs(grid_r - occupied_r[None, None, :])
+        dr = np.minimum(dr, self.raan_bins - dr)
+        dp = np.abs(grid_p - occupied_p[None, None, :])
+        dp = np.minimum(dp, self.phase_bins - dp)
+        return np.sqrt(dr ** 2 + dp ** 2).min(axis=2)
+
+    def largest_holes(self, top_k: int = 5) -> List[Dict[str, float]]:
+        """
+        二維相位空洞: 距離最近衛星最遠的空格 (環面距離)
+
+        Returns:
+            [{'raan_deg', 'phase_deg', 'clearance_cells'}] 依空隙遞減
+        """
+        distance = self._torus_distance_to_occupied(self.counts > 0)
+        distance = np.where(self.counts > 0, 0.0, distance)
+        flat = distance.reshape(-1)
+        order = np.argsort(-flat, kind='stable')[:top_k]
+        holes = []
+        for cell in order:
+            if flat[cell] <= 0:
+                break
+            r, p = divmod(int(cell), self.phase_bins)
+            holes.append({
+                'raan_deg': float(self._raan_centers[r]),
+                'phase_deg': float(self._phase_centers[p]),
+                'clearance_cells': float(flat[cell]) if np.isfinite(flat[cell]) else float(max(self.counts.shape)),
+            })
+        return holes
+
+    def best_fill(self, candidates: "PhaseSpaceIndex", raan_deg: float,
+                  phase_deg: float) -> Optional[str]:
+        """
+        找出候選索引中最接近指定相位空洞的衛星
+
+        先以候選網格計數找最近的非空格 (O(bins))，再只在該格成員中選擇
+        與空洞中心角距離最小的衛星。
+        """
+        if self.counts.shape != candidates.counts.shape:
+            raise ValueError("候選索引的網格解析度必須一致")
+        if not len(candidates):
+            return None
+        target_r = int(raan_deg % 360.0 // self.raan_width) % self.raan_bins
+        target_p = int(phase_deg % 360.0 // self.phase_width) % self.phase_bins
+
+        dr = np.abs(np.arange(self.raan_bins) - target_r)
+        dr = np.minimum(dr, self.raan_bins - dr)[:, None]
+        dp = np.abs(np.arange(self.phase_bins) - target_p)
+        dp = np.minimum(dp, self.phase_bins - dp)[None, :]
+        distance = np.where(candidates.counts > 0, dr ** 2 + dp ** 2, np.iinfo(np.int64).max)
+        cell = int(np.argmin(distance))
+
+        members = np.fromiter((candidates._position[s] for s in candidates._members[cell]),
+                              dtype=np.int64)
+        d_raan = np.abs(candidates.raan[members] - raan_deg % 360.0)
+        d_raan = np.minimum(d_raan, 360.0 - d_raan)
+        d_phase = np.abs(candidates.arg_latitude[members] - phase_deg % 360.0)
+        d_phase = np.minimum(d_phase, 360.0 - d_phase)
+        best = members[int(np.argmin(d_raan ** 2 + d_phase ** 2))]
+        return candidates.satellite_ids[best]
+
+    def coverage_gain(self, raan_deg: float, phase_deg: float) -> bool:
+        """加入此相位是否會佔據新的空格"""
+        cell = self._cell_of(np.array([raan_deg % 360.0]), np.array([phase_deg % 360.0]))[0]
+        return bool(self.counts.reshape(-1)[cell] == 0)
+
+    def summary(self, top_gaps: int = 3) -> Dict[str, Any]:
+        """索引摘要 (供分析報告使用)"""
+        return {
+            'grid': [self.raan_bins, self.phase_bins],
+            'satellites': len(self),
+            'occupied_cells': int(np.count_nonzero(self.counts)),
+            'diversity': self.diversity_scores(),
+            'largest_phase_gaps': self.axis_gaps('phase')[:top_gaps],
+            'largest_raan_gaps': self.axis_gaps('raan')[:top_gaps],
+            'largest_holes': self.largest_holes(top_gaps),
+        }
@@ -0,0 +1,415 @@
+"""
+大型衛星響應編碼層
+
+衛星池、動畫幀、預計算結果等響應動輒數 MB 的巢狀字典，經 pydantic 驗證
+再以標準庫 json 序列化常比計算本身更慢。本模組直接編碼處理結果：
+- JSON：orjson 可用時直接序列化 numpy 陣列，否則退回標準庫 json
+- 依 Accept 標頭可選 MessagePack (application/msgpack) 與
+  Arrow IPC stream (application/vnd.apache.arrow.stream)，兩者皆為選配依賴
+- ColumnarPayload 以 (欄位 → 一維陣列) 表示陣列化結果，只在輸出時轉為逐筆記錄
+- 不可變的預計算窗口以 ETag 緩存編碼後位元組：命中時不重建也不重新編碼，
+  If-None-Match 相符回 304
+
+NetStack (netstack_api/services/response_encoding.py) 透過
+shared_core.orbit_engine_modules 直接載入本檔案，兩邊共用同一實作。
+"""
+
+import dataclasses
+import hashlib
+import inspect
+import json
+import math
+from collections import OrderedDict
+from datetime import date, datetime
+from enum import Enum
+from pathlib import PurePath
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+try:
+    import numpy as np
+    NUMPY_AVAILABLE = True
+except ImportError:
+    NUMPY_AVAILABLE = False
+
+try:
+    import orjson
+    ORJSON_AVAILABLE = True
+except ImportError:
+    ORJSON_AVAILABLE = False
+
+try:
+    import msgpack
+    MSGPACK_AVAILABLE = True
+except ImportError:
+    MSGPACK_AVAILABLE = False
+
+try:
+    import pyarrow as pa
+    import pyarrow.ipc
+    ARROW_AVAILABLE = True
+except ImportError:
+    ARROW_AVAILABLE = False
+
+JSON_MEDIA_TYPE = "application/json"
+MSGPACK_MEDIA_TYPE = "application/msgpack"
+ARROW_MEDIA_TYPE = "application/vnd.apache.arrow.stream"
+
+MEDIA_TYPES = {"json": JSON_MEDIA_TYPE, "msgpack": MSGPACK_MEDIA_TYPE, "arrow": ARROW_MEDIA_TYPE}
+_ACCEPT_FORMATS = {
+    JSON_MEDIA_TYPE: "json",
+    "*/*": "json",
+    "application/*": "json",
+    MSGPACK_MEDIA_TYPE: "msgpack",
+    "application/x-msgpack": "msgpack",
+    "application/vnd.msgpack": "msgpack",
+    ARROW_MEDIA_TYPE: "arrow",
+}
+
+
+class NotTabularError(ValueError):
+    """響應無法轉為 Arrow 表格"""
+
+
+def format_available(fmt: str) -> bool:
+    if fmt == "msgpack":
+        return MSGPACK_AVAILABLE
+    if fmt == "arrow":
+        return ARROW_AVAILABLE
+    return fmt == "json"
+
+
+def available_media_types() -> List[str]:
+    return [media for fmt, media in MEDIA_TYPES.items() if format_available(fmt)]
+
+
+def negotiate_format(accept: Optional[str]) -> Optional[str]:
+    """
+    依 Accept 標頭選擇編碼格式
+
+    Returns:
+        'json' / 'msgpack' / 'arrow'；沒有可用的格式時為 None (應回 406)
+    """
+    if not accept or not accept.strip():
+        return "json"
+
+    best, best_q = None, 0.0
+    for part in accept.split(","):
+        media, _, params = part.partition(";")
+        fmt = _ACCEPT_FORMATS.get(media.strip().lower())
+        if fmt is None or not format_available(fmt):
+            continue
+
+        q = 1.0
+        for param in params.split(";"):
+            name, _, value = param.partition("=")
+            if name.strip().lower() == "q":
+                try:
+                    q = float(value)
+                except ValueError:
+                    q = 0.0
+        # 同權重時取先出現者
+        if q > best_q:
+            best, best_q = fmt, q
+    return best
+
+
+# === 陣列化結果 ===
+
+def _column_values(column: Any) -> List[Any]:
+    """欄位轉為 Python 列表；浮點 NaN 輸出為 null"""
+    if NUMPY_AVAILABLE and isinstance(column, np.ndarray):
+        if column.dtype.kind == "f" and np.isnan(column).any():
+            column = np.where(np.isnan(column), None, column.astype(object))
+        return column.tolist()
+    return list(column)
+
+
+@dataclasses.dataclass
+class ColumnarPayload:
+    """
+    陣列化結果：欄位名 → 等長一維陣列 (numpy 或 list)，加上表外的中繼資料
+
+    JSON / MessagePack 輸出為 {**metadata, records_key: 記錄}，orient='records'
+    時記錄為逐筆字典，orient='columns' 時為 {欄位: 陣列}；Arrow 一律輸出欄位表，
+    中繼資料放在 schema metadata 的 'metadata' 鍵 (JSON)。
+    """
+    columns: Dict[str, Any]
+    metadata: Dict[str, Any] = dataclasses.field(default_factory=dict)
+    records_key: str = "records"
+    orient: str = "records"
+
+    def __len__(self) -> int:
+        return len(next(iter(self.columns.values()))) if self.columns else 0
+
+    def to_records(self) -> List[Dict[str, Any]]:
+        names = list(self.columns)
+        values = [_column_values(self.columns[name]) for name in names]
+        return [dict(zip(names, row)) for row in zip(*values)]
+
+    def to_dict(self) -> Dict[str, Any]:
+        records = self.to_records() if self.orient == "records" else self.columns
+        return {**self.metadata, self.records_key: records}
+
+    def to_arrow_table(self):
+        arrays = {}
+        for name, column in self.columns.items():
+            if NUMPY_AVAILABLE and isinstance(column, np.ndarray) and column.dtype.kind != "O":
+                arrays[name] = pa.array(column, from_pandas=True)   # NaN → null
+            else:
+                arrays[name] = pa.array(_column_values(column))
+        table = pa.table(arrays)
+        return table.replace_schema_metadata({"metadata": _json_dumps(self.metadata)})
+
+
+# === 編碼 ===
+
+def _default(obj: Any) -> Any:
+    """標準庫 json / orjson / msgpack 共用的型別轉換"""
+    if isinstance(obj, ColumnarPayload):
+        return obj.to_dict()
+    if NUMPY_AVAILABLE:
+        if isinstance(obj, np.ndarray):
+            return _column_values(obj)
+        if isinstance(obj, np.generic):
+            value = obj.item()
+            return None if isinstance(value, float) and math.isnan(value) else value
+    if isinstance(obj, (datetime, date)):
+        return obj.isoformat()
+    if dataclasses.is_dataclass(obj) and not isinstance(obj, type):
+        return dataclasses.asdict(obj)
+    if isinstance(obj, Enum):
+        return obj.value
+    if isinstance(obj, (set, frozenset, tuple)):
+        return list(obj)
+    if isinstance(obj, PurePath):
+        return str(obj)
+    raise TypeError(f"Object of type {type(obj).__name__} is not serializable")
+
+
+def _json_dumps(obj: Any) -> bytes:
+    if ORJSON_AVAILABLE:
+        # ColumnarPayload 是 dataclass，須交由 _default 轉換
+        return orjson.dumps(obj, default=_default,
+                            option=(orjson.OPT_SERIALIZE_NUMPY | orjson.OPT_NON_STR_KEYS
+                                    | orjson.OPT_PASSTHROUGH_DATACLASS))
+    return json.dumps(obj, default=_default, ensure_ascii=False,
+                      allow_nan=False, separators=(",", ":")).encode("utf-8")
+
+
+def _split_table(payload: Any, table_key: Optional[str]) -> Tuple[Any, Any]:
+    """取出 table_key (以 '.' 分隔的路徑) 指向的記錄，回傳 (記錄, 其餘內容)"""
+    if isinstance(payload, ColumnarPayload):
+        return payload, None
+    if not table_key:
+        if isinstance(payload, list):
+            return payload, None
+        raise NotTabularError("響應沒有指定表格欄位")
+
+    head, _, rest = table_key.partition(".")
+    if not isinstance(payload, dict) or head not in payload:
+        raise NotTabularError(f"響應中沒有表格欄位 '{table_key}'")
+    if rest:
+        records, inner = _split_table(payload[head], rest)
+        return records, {**payload, head: inner}
+    return payload[head], {key: value for key, value in payload.items() if key != head}
+
+
+def _arrow_stream(payload: Any, table_key: Optional[str]) -> bytes:
+    records, remainder = _split_table(payload, table_key)
+    if isinstance(records, ColumnarPayload):
+        table = records.to_arrow_table()
+        if remainder is not None:
+            table = table.replace_schema_metadata({
+                "metadata": _json_dumps({**records.metadata, **remainder})
+            })
+    else:
+        if not isinstance(records, list) or not all(isinstance(row, dict) for row in records):
+            raise NotTabularError("表格欄位必須是字典列表")
+        try:
+            # 巢狀值先轉為 JSON 相容型別，再交由 Arrow 推斷 struct / list 欄位
+            table = pa.Table.from_pylist(json.loads(_json_dumps(records)))
+        except (pa.ArrowInvalid, pa.ArrowTypeError) as e:
+            raise NotTabularError(f"記錄無法轉為 Arrow 表格: {e}") from e
+        table = table.replace_schema_metadata({"metadata": _json_dumps(remainder)})
+
+    sink = pa.BufferOutputStream()
+    with pa.ipc.new_stream(sink, table.schema) as writer:
+        writer.write_table(table)
+    return sink.getvalue().to_pybytes()
+
+
+def encode_payload(payload: Any, fmt: str = "json", table_key: Optional[str] = None) -> bytes:
+    """
+    以指定格式編碼響應
+
+    Args:
+        payload: 字典 / 列表 / ColumnarPayload，可含 numpy 陣列與 datetime
+        fmt: 'json' / 'msgpack' / 'arrow'
+        table_key: Arrow 格式下作為表格的記錄列表路徑 (例如 'data.pools')
+    """
+    if fmt == "json":
+        return _json_dumps(payload)
+    if fmt == "msgpack":
+        if isinstance(payload, ColumnarPayload):
+            payload = payload.to_dict()
+        return msgpack.packb(payload, default=_default, use_bin_type=True)
+    if fmt == "arrow":
+        return _arrow_stream(payload, table_key)
+    raise ValueError(f"不支援的編碼格式: {fmt}")
+
+
+# === ETag 與編碼緩存 ===
+
+def make_etag(*parts: Any) -> str:
+    """由數據版本 (數據 ID、修改時間、查詢參數…) 產生強 ETag"""
+    digest = hashlib.sha1(json.dumps(parts, sort_keys=True, default=str).encode("utf-8"))
+    return f'"{digest.hexdigest()[:32]}"'
+
+
+def etag_matches(if_none_match: Optional[str], etag: str) -> bool:
+    """If-None-Match 比對 (弱比較)"""
+    if not if_none_match:
+        return False
+    for candidate in if_none_match.split(","):
+        candidate = candidate.strip()
+        if candidate == "*":
+            return True
+        if candidate.startswith("W/"):
+            candidate = candidate[2:]
+        if candidate == etag:
+            return True
+    return False
+
+
+class EncodedResponseCache:
+    """以 ETag 為鍵、總位元組數受限的編碼結果 LRU 緩存"""
+
+    def __init__(self, max_entries: int = 128, max_bytes: int = 256 * 1024 * 1024):
+        self.max_entries = max_entries
+        self.max_bytes = max_bytes
+        self._entries: "OrderedDict[str, Tuple[bytes, str]]" = OrderedDict()
+        self._bytes = 0
+        self._stats = {"hits": 0, "misses": 0, "insertions": 0, "evictions": 0, "oversized": 0}
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def get(self, etag: str) -> Optional[Tuple[bytes, str]]:
+        entry = self._entries.get(etag)
+        if entry is None:
+            self._stats["misses"] += 1
+            return None
+        self._entries.move_to_end(etag)
+        self._stats["hits"] += 1
+        return entry
+
+    def put(self, etag: str, body: bytes, media_type: str) -> None:
+        if len(body) > self.max_bytes:
+            self._stats["oversized"] += 1
+            return
+        if etag in self._entries:
+            self._bytes -= len(self._entries.pop(etag)[0])
+        self._entries[etag] = (body, media_type)
+        self._bytes += len(body)
+        self._stats["insertions"] += 1
+
+        while len(self._entries) > self.max_entries or self._bytes > self.max_bytes:
+            _, (evicted, _) = self._entries.popitem(last=False)
+            self._bytes -= len(evicted)
+            self._stats["evictions"] += 1
+
+    def clear(self) -> None:
+        self._entries.clear()
+        self._bytes = 0
+
+    def get_stats(self) -> Dict[str, Any]:
+        stats = dict(self._stats)
+        lookups = stats["hits"] + stats["misses"]
+        stats["entries"] = len(self._entries)
+        stats["bytes"] = self._bytes
+        stats["hit_rate"] = stats["hits"] / lookups if lookups else 0.0
+        return stats
+
+
+@dataclasses.dataclass
+class EncodedResponse:
+    """已編碼的 HTTP 響應，與 Web 框架無關"""
+    status_code: int
+    body: bytes
+    media_type: Optional[str]
+    headers: Dict[str, str]
+
+    def to_response(self, response_cls):
+        """轉為框架的 Response (例如 fastapi.Response)"""
+        return response_cls(content=self.body, status_code=self.status_code,
+                            media_type=self.media_type, headers=self.headers)
+
+
+class ResponseEncoder:
+    """內容協商 + 編碼 + ETag 緩存"""
+
+    def __init__(self, cache: Optional[EncodedResponseCache] = None):
+        self.cache = cache if cache is not None else EncodedResponseCache()
+
+    async def respond(
+        self,
+        build: Any,
+        accept: Optional[str] = None,
+        if_none_match: Optional[str] = None,
+        etag_parts: Optional[Sequence[Any]] = None,
+        table_key: Optional[str] = None,
+        cache_control: Optional[str] = None
+    ) -> EncodedResponse:
+        """
+        產生已編碼響應
+
+        Args:
+            build: 響應內容，或回傳內容的函數 / 協程函數 (只在緩存未命中時呼叫)
+            accept / if_none_match: 請求標頭
+            etag_parts: 數據版本；提供時以 ETag 緩存編碼結果並支援 304，
+                        僅用於內容在此版本下不可變的響應
+            table_key: Arrow 格式下的表格記錄路徑
+            cache_control: Cache-Control 標頭
+        """
+        fmt = negotiate_format(accept)
+        if fmt is None:
+            return EncodedResponse(406, _json_dumps({
+                "detail": f"Not Acceptable; supported media types: {', '.join(available_media_types())}"
+            }), JSON_MEDIA_TYPE, {"Vary": "Accept"})
+
+        headers = {"Vary": "Accept"}
+        if cache_control:
+            headers["Cache-Control"] = cache_control
+
+        etag = make_etag(fmt, *etag_parts) if etag_parts is not None else None
+        if etag is not None:
+            headers["ETag"] = etag
+            if etag_matches(if_none_match, etag):
+                return EncodedResponse(304, b"", None, headers)
+            cached = self.cache.get(etag)
+            if cached is not None:
+                return EncodedResponse(200, cached[0], cached[1], headers)
+
+        payload = build() if callable(build) else build
+        if inspect.isawaitable(payload):
+            payload = await payload
+
+        try:
+            body = encode_payload(payload, fmt, table_key)
+        except NotTabularError as e:
+            return EncodedResponse(406, _json_dumps({"detail": str(e)}), JSON_MEDIA_TYPE, {"Vary": "Accept"})
+
+        if etag is not None:
+            self.cache.put(etag, body, MEDIA_TYPES[fmt])
+        return EncodedResponse(200, body, MEDIA_TYPES[fmt], headers)
+
+
+_response_encoder: Optional[ResponseEncoder] = None
+
+
+def get_response_encoder() -> ResponseEncoder:
+    """進程內共用的響應編碼器 (共用編碼緩存)"""
+    global _response_encoder
+    if _response_encoder is None:
+        _response_encoder = ResponseEncoder()
+    return _response_encoder
@@ -0,0 +1,443 @@
+"""
+存儲分層規劃 (熱 / 溫 / 冷)
+
+PostgreSQL 與 Volume、記憶體與檔案之間的選擇原本是靜態規則，歸檔成長後
+查詢成本與磁碟佔用無法自動平衡。本模組提供與存儲後端無關的分層核心：
+- AccessTracker：依 (數據集, 時間窗口) 記錄指數衰減的存取頻率
+- TierCostModel：以「存取率 × 讀取延遲」加「體積 × 單位存儲成本」估算各層成本
+- StorageTierPlanner：為每個時間窗口選擇成本最低的層級，並在熱層容量、
+  溫層預算與冷層最小年齡約束下自動平衡
+- 冷層以壓縮欄式檔案保存 (pyarrow 可用時為 Parquet，否則為欄式 gzip JSON)，
+  讀回與原始數據完全一致
+"""
+
+import gzip
+import json
+import math
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+try:
+    import orjson
+    ORJSON_AVAILABLE = True
+except ImportError:
+    ORJSON_AVAILABLE = False
+
+try:
+    import pyarrow as pa
+    import pyarrow.parquet as pq
+    ARROW_AVAILABLE = True
+except ImportError:
+    ARROW_AVAILABLE = False
+
+TIERS = ("hot", "warm", "cold")
+
+PARQUET_SUFFIX = ".parquet"
+COLUMNS_JSON_SUFFIX = ".columns.json.gz"
+COLD_SUFFIXES = (PARQUET_SUFFIX, COLUMNS_JSON_SUFFIX)
+
+
+@dataclass
+class TierCostModel:
+    """分層成本模型 (成本為無單位的相對值，只用於比較)"""
+    read_latency_ms: Dict[str, float] = field(default_factory=lambda: {"hot": 0.05, "warm": 20.0, "cold": 80.0})
+    footprint_cost_per_mb: Dict[str, float] = field(default_factory=lambda: {"hot": 1.0, "warm": 0.1, "cold": 0.1})
+    latency_weight: float = 0.01                 # 每 (次/小時 × 毫秒) 的成本
+    cold_size_ratio: float = 0.3                 # 冷層欄式壓縮後體積比 (遷移時以實測值更新)
+    bucket_seconds: int = 3600                   # 時間窗口粒度
+    hot_window_seconds: int = 6 * 3600           # 近期窗口，套用 recent_access_prior
+    recent_access_prior: float = 6.0             # 近期窗口尚無歷史時假設的存取率 (次/小時)
+    cold_min_age_seconds: int = 24 * 3600        # 未滿此年齡的窗口不降為冷層
+    hot_max_bytes: int = 256 * 1024 * 1024       # 熱層 (記憶體) 容量
+    warm_max_bytes: Optional[int] = None         # 溫層預算，超出時降級收益最低的窗口
+
+    @classmethod
+    def from_config(cls, config: Optional[Dict[str, Any]] = None) -> "TierCostModel":
+        config = config or {}
+        known = {f for f in cls.__dataclass_fields__}
+        model = cls(**{k: v for k, v in config.items() if k in known and not isinstance(v, dict)})
+        for key in ("read_latency_ms", "footprint_cost_per_mb"):
+            if isinstance(config.get(key), dict):
+                getattr(model, key).update(config[key])
+        return model
+
+    def size_factor(self, tier: str) -> float:
+        return self.cold_size_ratio if tier == "cold" else 1.0
+
+    def cost(self, tier: str, rate_per_hour: float, size_bytes: int) -> float:
+        size_mb = size_bytes / (1024 * 1024)
+        return (rate_per_hour * self.read_latency_ms[tier] * self.latency_weight
+                + size_mb * self.size_factor(tier) * self.footprint_cost_per_mb[tier])
+
+    def observe_compression(self, original_bytes: int, cold_bytes: int, weight: float = 0.2):
+        """以實測的冷層壓縮比平滑更新成本模型"""
+        if original_bytes > 0 and cold_bytes > 0:
+            ratio = cold_bytes / original_bytes
+            self.cold_size_ratio += weight * (ratio - self.cold_size_ratio)
+
+
+class AccessTracker:
+    """
+    (數據集, 時間窗口) 存取頻率追蹤器
+
+    每個鍵保存指數衰減計數 (半衰期 half_life_seconds)，存取率 = 計數 / 平均壽命。
+    """
+
+    def __init__(self, half_life_seconds: float = 6 * 3600):
+        self.half_life_seconds = float(half_life_seconds)
+        self._decay = math.log(2) / self.half_life_seconds
+        self._counters: Dict[Tuple[str, int], Tuple[float, float]] = {}
+        self._lock = threading.Lock()
+
+    def record(self, dataset: str, bucket_start: int, now: float, count: float = 1.0):
+        key = (dataset, int(bucket_start))
+        with self._lock:
+            value, updated = self._counters.get(key, (0.0, now))
+            self._counters[key] = (value * math.exp(-self._decay * max(0.0, now - updated)) + count, now)
+
+    def rate_per_hour(self, dataset: str, bucket_start: int, now: float) -> float:
+        with self._lock:
+            value, updated = self._counters.get((dataset, int(bucket_start)), (0.0, now))
+        decayed = value * math.exp(-self._decay * max(0.0, now - updated))
+        return decayed * self._decay * 3600.0
+
+    def prune(self, now: float, min_rate_per_hour: float = 1e-4):
+        """移除已衰減至可忽略的計數"""
+        with self._lock:
+            keys = list(self._counters)
+        for dataset, bucket in keys:
+            if self.rate_per_hour(dataset, bucket, now) < min_rate_per_hour:
+                with self._lock:
+                    self._counters.pop((dataset, bucket), None)
+
+    def to_dict(self) -> Dict[str, Any]:
+        with self._lock:
+            counters = [[d, b, v, u] for (d, b), (v, u) in self._counters.items()]
+        return {"half_life_seconds": self.half_life_seconds, "counters": counters}
+
+    @classmethod
+    def from_dict(cls, state: Dict[str, Any]) -> "AccessTracker":
+        tracker = cls(state.get("half_life_seconds", 6 * 3600))
+        for dataset, bucket, value, updated in state.get("counters", []):
+            tracker._counters[(dataset, int(bucket))] = (float(value), float(updated))
+        return tracker
+
+
+@dataclass
+class TierSegment:
+    """同一數據集、同一時間窗口內的存儲項目"""
+    dataset: str
+    bucket_start: int
+    size_bytes: int = 0
+    tier: str = "warm"
+    item_ids: List[str] = field(default_factory=list)
+
+    @property
+    def key(self) -> Tuple[str, int]:
+        return (self.dataset, self.bucket_start)
+
+
+@dataclass
+class TierPlacement:
+    """單一時間窗口的分層決策"""
+    dataset: str
+    bucket_start: int
+    current_tier: str
+    target_tier: str
+    rate_per_hour: float
+    size_bytes: int
+    costs: Dict[str, float]
+    reason: str
+    item_ids: List[str] = field(default_factory=list)
+
+    @property
+    def needs_migration(self) -> bool:
+        return self.current_tier != self.target_tier
+
+
+class StorageTierPlanner:
+    """依成本模型為各時間窗口決定存儲層級"""
+
+    def __init__(self, cost_model: Optional[TierCostModel] = None, tracker: Optional[AccessTracker] = None):
+        self.cost_model = cost_model or TierCostModel()
+        self.tracker = tracker or AccessTracker()
+
+    def bucket_of(self, timestamp: float) -> int:
+        size = self.cost_model.bucket_seconds
+        return int(timestamp // size * size)
+
+    def record_access(self, dataset: str, timestamp: float, now: float):
+        self.tracker.record(dataset, self.bucket_of(timestamp), now)
+
+    def plan(self, segments: Iterable[TierSegment], now: float) -> List[TierPlacement]:
+        """為每個窗口選擇層級：先取無容量約束下的最低成本，再套用熱層容量與溫層預算"""
+        model = self.cost_model
+        placements: List[TierPlacement] = []
+
+        for segment in segments:
+            age = now - (segment.bucket_start + model.bucket_seconds)
+            rate = self.tracker.rate_per_hour(segment.dataset, segment.bucket_start, now)
+            if age < model.hot_window_seconds:
+                rate = max(rate, model.recent_access_prior)
+
+            costs = {tier: model.cost(tier, rate, segment.size_bytes) for tier in TIERS}
+            allowed = [tier for tier in TIERS if tier != "cold" or age >= model.cold_min_age_seconds]
+            target = min(allowed, key=lambda tier: costs[tier])
+            reason = "recent_window" if age < model.hot_window_seconds else "cost"
+            placements.append(TierPlacement(
+                dataset=segment.dataset, bucket_start=segment.bucket_start,
+                current_tier=segment.tier, target_tier=target, rate_per_hour=rate,
+                size_bytes=segment.size_bytes, costs=costs, reason=reason,
+                item_ids=list(segment.item_ids)
+            ))
+
+        self._enforce_hot_capacity(placements, now)
+        self._enforce_warm_budget(placements, now)
+        return placements
+
+    def _enforce_hot_capacity(self, placements: List[TierPlacement], now: float):
+        """熱層容量有限：依每位元組節省的成本排序保留，其餘退回次佳層級"""
+        model = self.cost_model
+        hot = [p for p in placements if p.target_tier == "hot"]
+
+        def saving_density(p: TierPlacement) -> float:
+            fallback = min(p.costs["warm"], p.costs["cold"] if self._cold_allowed(p, now) else math.inf)
+            return (fallback - p.costs["hot"]) / max(p.size_bytes, 1)
+
+        used = 0
+        for placement in sorted(hot, key=saving_density, reverse=True):
+            if used + placement.size_bytes <= model.hot_max_bytes:
+                used += placement.size_bytes
+                continue
+            placement.target_tier = ("cold" if self._cold_allowed(placement, now)
+                                     and placement.costs["cold"] < placement.costs["warm"] else "warm")
+            placement.reason = "hot_capacity"
+
+    def _enforce_warm_budget(self, placements: List[TierPlacement], now: float):
+        """溫層超出預算時，降級「留在溫層收益」最低的可降級窗口"""
+        budget = self.cost_model.warm_max_bytes
+        if budget is None:
+            return
+        warm = [p for p in placements if p.target_tier == "warm"]
+        used = sum(p.size_bytes for p in warm)
+        for placement in sorted(warm, key=lambda p: p.costs["cold"] - p.costs["warm"]):
+            if used <= budget:
+                break
+            if self._cold_allowed(placement, now):
+                placement.target_tier = "cold"
+                placement.reason = "warm_budget"
+                used -= placement.size_bytes
+
+    def _cold_allowed(self, placement: TierPlacement, now: float) -> bool:
+        age = now - (placement.bucket_start + self.cost_model.bucket_seconds)
+        return age >= self.cost_model.cold_min_age_seconds
+
+
+def dumps_compact(data: Any) -> bytes:
+    """熱層以緊湊 JSON 位元組保存，讀取方各自取得獨立副本"""
+    if ORJSON_AVAILABLE:
+        return orjson.dumps(data, default=str, option=orjson.OPT_NON_STR_KEYS)
+    return json.dumps(data, ensure_ascii=False, separators=(",", ":"), default=str).encode("utf-8")
+
+
+def loads_compact(payload: bytes) -> Any:
+    return orjson.loads(payload) if ORJSON_AVAILABLE else json.loads(payload)
+
+
+class HotTierStore:
+    """熱層記憶體存儲 (依位元組上限的 LRU，值為 dumps_compact 編碼的位元組)"""
+
+    def __init__(self, max_bytes: int):
+        self.max_bytes = max_bytes
+        self._items: "OrderedDict[str, Tuple[Any, int]]" = OrderedDict()
+        self._bytes = 0
+        self._lock = threading.Lock()
+        self.stats = {"hits": 0, "misses": 0, "evictions": 0}
+
+    def get(self, key: str) -> Optional[Any]:
+        with self._lock:
+            entry = self._items.get(key)
+            if entry is None:
+                self.stats["misses"] += 1
+                return None
+            self._items.move_to_end(key)
+            self.stats["hits"] += 1
+            payload = entry[0]
+        return loads_compact(payload)
+
+    def put(self, key: str, value: Any) -> bool:
+        payload = dumps_compact(value)
+        size_bytes = len(payload)
+        if size_bytes > self.max_bytes:
+            return False
+        with self._lock:
+            if key in self._items:
+                self._bytes -= self._items.pop(key)[1]
+            self._items[key] = (payload, size_bytes)
+            self._bytes += size_bytes
+            while self._bytes > self.max_bytes:
+                _, (_, evicted) = self._items.popitem(last=False)
+                self._bytes -= evicted
+                self.stats["evictions"] += 1
+        return True
+
+    def discard(self, key: str):
+        with self._lock:
+            entry = self._items.pop(key, None)
+            if entry is not None:
+                self._bytes -= entry[1]
+
+    def __contains__(self, key: str) -> bool:
+        with self._lock:
+            return key in self._items
+
+    def get_stats(self) -> Dict[str, Any]:
+        with self._lock:
+            return {**self.stats, "entries": len(self._items), "bytes": self._bytes, "max_bytes": self.max_bytes}
+
+
+# === 冷層欄式編碼 ===
+
+_SCALAR_TYPES = (str, int, float, bool)
+
+
+class _Missing:
+    pass
+
+
+_MISSING = _Missing()
+
+
+def _find_table(data: Any, path: Tuple[str, ...] = ()) -> Tuple[Tuple[str, ...], int]:
+    """在巢狀字典中尋找最大的「字典列表」作為欄式表"""
+    best: Tuple[Tuple[str, ...], int] = ((), 0)
+    if isinstance(data, dict):
+        for key, value in data.items():
+            if isinstance(value, list) and value and all(isinstance(row, dict) for row in value):
+                if len(value) > best[1]:
+                    best = (path + (key,), len(value))
+            elif isinstance(value, dict):
+                candidate = _find_table(value, path + (key,))
+                if candidate[1] > best[1]:
+                    best = candidate
+    return best
+
+
+def _split_columns(rows: List[Dict[str, Any]]) -> Tuple[List[str], Dict[str, List[Any]], Dict[str, str]]:
+    """
+    將記錄拆為欄位：每列皆有且型別一致的純量欄位保留原生型別，
+    其餘以 JSON 文本保存 (缺少的鍵為 None、值為 null 時為 "null"，可無損還原)
+    """
+    order: Dict[str, None] = {}
+    for row in rows:
+        for key in row:
+            order.setdefault(key, None)
+
+    columns: Dict[str, List[Any]] = {}
+    kinds: Dict[str, str] = {}
+    for key in order:
+        values = [row.get(key, _MISSING) for row in rows]
+        present_types = {type(v) for v in values if v is not None}
+        native = (len(present_types) <= 1 and present_types <= set(_SCALAR_TYPES)
+                  and not any(v is _MISSING for v in values))
+        if native:
+            columns[key] = values
+            kinds[key] = next(iter(present_types)).__name__ if present_types else "null"
+        else:
+            columns[key] = [None if v is _MISSING else json.dumps(v, ensure_ascii=False) for v in values]
+            kinds[key] = "json"
+    return list(order), columns, kinds
+
+
+def _join_columns(order: List[str], columns: Dict[str, List[Any]], kinds: Dict[str, str], n_rows: int) -> List[Dict[str, Any]]:
+    rows: List[Dict[str, Any]] = [{} for _ in range(n_rows)]
+    for key in order:
+        values = columns[key]
+        if kinds[key] == "json":
+            for row, value in zip(rows, values):
+                if value is not None:
+                    row[key] = json.loads(value)
+        else:
+            for row, value in zip(rows, values):
+                row[key] = value
+    return rows
+
+
+def write_columnar(path_stem: Path, data: Dict[str, Any], prefer_parquet: bool = True) -> Path:
+    """
+    將存儲數據寫為冷層欄式檔案
+
+    Args:
+        path_stem: 不含副檔名的目標路徑
+        data: 任意 JSON 相容字典；最大的字典列表轉為欄式表，其餘保存在封套中
+
+    Returns:
+        實際寫入的檔案路徑
+    """
+    table_path, n_rows = _find_table(data)
+    envelope = json.loads(json.dumps(data, default=str))
+    rows: List[Dict[str, Any]] = []
+    if table_path:
+        parent = envelope
+        for key in table_path[:-1]:
+            parent = parent[key]
+        rows = parent[table_path[-1]]
+        parent[table_path[-1]] = None
+    order, columns, kinds = _split_columns(rows)
+    header = {"table_path": list(table_path), "n_rows": len(rows), "order": order,
+              "kinds": kinds, "envelope": envelope}
+
+    path_stem = Path(path_stem)
+    if prefer_parquet and ARROW_AVAILABLE:
+        target = path_stem.with_name(path_stem.name + PARQUET_SUFFIX)
+        arrays = {f"c{i}": pa.array(columns[key]) for i, key in enumerate(order)}
+        table = pa.table(arrays) if arrays else pa.table({"_": pa.array([None] * len(rows))})
+        table = table.replace_schema_metadata({"orbit_engine_tier": json.dumps(header, ensure_ascii=False)})
+        pq.write_table(table, target, compression="zstd")
+    else:
+        target = path_stem.with_name(path_stem.name + COLUMNS_JSON_SUFFIX)
+        with gzip.open(target, "wt", encoding="utf-8", compresslevel=9) as f:
+            json.dump({**header, "columns": [columns[key] for key in order]}, f,
+                      ensure_ascii=False, separators=(",", ":"))
+    return target
+
+
+def read_columnar(path: Path) -> Dict[str, Any]:
+    """讀回冷層欄式檔案，返回與寫入時相同的字典"""
+    path = Path(path)
+    if path.name.endswith(PARQUET_SUFFIX):
+        if not ARROW_AVAILABLE:
+            raise RuntimeError(f"讀取 {path.name} 需要 pyarrow")
+        table = pq.read_table(path)
+        header = json.loads(table.schema.metadata[b"orbit_engine_tier"])
+        columns = {key: table.column(f"c{i}").to_pylist() for i, key in enumerate(header["order"])}
+    else:
+        with gzip.open(path, "rt", encoding="utf-8") as f:
+            header = json.load(f)
+        columns = dict(zip(header["order"], header.pop("columns")))
+
+    data = header["envelope"]
+    if header["table_path"]:
+        parent = data
+        for key in header["table_path"][:-1]:
+            parent = parent[key]
+        parent[header["table_path"][-1]] = _join_columns(header["order"], columns, header["kinds"], header["n_rows"])
+    return data
+
+
+def is_cold_file(path: Path) -> bool:
+    return any(Path(path).name.endswith(suffix) for suffix in COLD_SUFFIXES)
+
+
+def placement_summary(placements: Iterable[TierPlacement]) -> Dict[str, Any]:
+    """彙總分層決策：各層窗口數與位元組、待遷移數"""
+    summary = {tier: {"segments": 0, "bytes": 0} for tier in TIERS}
+    migrations = 0
+    for placement in placements:
+        summary[placement.target_tier]["segments"] += 1
+        summary[placement.target_tier]["bytes"] += placement.size_bytes
+        migrations += placement.needs_migration
+    return {"tiers": summary, "pending_migrations": migrations}
@@ -257,6 +257,22 @@ class RLEnvironmentAdapter:
         self.episode_reward = 0.0
         self.logger.info("🔄 RL環境已重置")
 
+    def create_vectorized_environment(self, optimization_data: Dict[str, Any], num_envs: int,
+                                      seed: Optional[int] = None):
+        """
+        建立批次向量化換手環境 (訓練數據生成用)
+
+        候選衛星的時間序列只在此轉換一次，之後所有回合以陣列運算推進
+        """
+        from .vectorized_handover_env import VectorizedHandoverEnv
+
+        env_config = {**self.config.get('vectorized_env', {}), 'reward_weights': self.reward_weights}
+        env = VectorizedHandoverEnv.from_candidates(
+            optimization_data.get('candidates', []), num_envs, env_config, seed
+        )
+        self.logger.info(f"✅ 向量化環境建立完成: {num_envs} 個回合, {env.num_satellites} 顆衛星")
+        return env
+
     def get_environment_info(self) -> Dict[str, Any]:
         """獲取環境信息"""
         return {
@@ -0,0 +1,238 @@
+"""
+Vectorized Handover Environment for Stage 4 RL Research
+
+批次向量化的換手RL環境：數千個獨立換手回合在共享的預計算可見性/信號陣列上
+同步推進，觀測、動作、獎勵皆為連續 numpy 陣列。
+
+設計要點:
+- 衛星 × 時間點的 RSRP、仰角、可見性陣列只建立一次，所有回合共享
+- 每個時間點的前 K 顆可見候選 (依 RSRP 排序) 預先計算為 (T, K) 索引表，
+  觀測與轉移只做陣列索引 (gather)，不再逐步轉換字典
+- 動作: 0..K-1 選擇候選槽位 (選到目前服務衛星即不換手)，K 表示維持服務
+- 獎勵權重沿用 RLEnvironmentAdapter 的 reward_weights
+- 回合結束時自動重置，結束前的觀測放在 info['final_observation']
+- 以 numpy Generator 決定起始時間，相同種子得到相同軌跡
+"""
+
+import logging
+from typing import Any, Dict, List, Optional, Tuple
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+# 正規化範圍
+RSRP_FLOOR_DBM = -140.0
+RSRP_SPAN_DB = 60.0
+
+# 每個候選槽位的特徵: RSRP、仰角、是否為服務衛星、槽位有效
+SLOT_FEATURES = 4
+# 服務衛星特徵: RSRP、仰角、是否可見、距上次換手的時間比例
+SERVING_FEATURES = 4
+
+
+class VectorizedHandoverEnv:
+    """批次換手環境 (多回合同步推進)"""
+
+    def __init__(self, rsrp_dbm: np.ndarray, elevation_deg: np.ndarray, num_envs: int,
+                 config: Optional[Dict[str, Any]] = None, seed: Optional[int] = None):
+        """
+        Args:
+            rsrp_dbm: (衛星數, 時間點數) RSRP，不可見或無資料為 NaN
+            elevation_deg: (衛星數, 時間點數) 仰角
+            num_envs: 同步推進的回合數
+            config: candidate_slots / episode_length / elevation_threshold_deg /
+                    reward_weights / outage_penalty
+            seed: 隨機種子
+        """
+        config = config or {}
+        rsrp_dbm = np.asarray(rsrp_dbm, dtype=np.float32)
+        elevation_deg = np.asarray(elevation_deg, dtype=np.float32)
+        if rsrp_dbm.shape != elevation_deg.shape or rsrp_dbm.ndim != 2:
+            raise ValueError("rsrp_dbm 與 elevation_deg 必須是相同形狀的 (衛星數, 時間點數) 陣列")
+
+        self.num_satellites, self.num_times = rsrp_dbm.shape
+        self.num_envs = int(num_envs)
+        self.candidate_slots = int(config.get('candidate_slots', 8))
+        self.episode_length = int(min(config.get('episode_length', 120), self.num_times - 1))
+        if self.episode_length < 1:
+            raise ValueError("時間點數不足以構成回合")
+        self.reward_weights = config.get('reward_weights', {
+            'signal_quality': 0.4,
+            'coverage': 0.3,
+            'handover_cost': -0.2,
+            'energy_efficiency': 0.1
+        })
+        self.outage_penalty = float(config.get('outage_penalty', -1.0))
+
+        threshold = float(config.get('elevation_threshold_deg', 10.0))
+        self.visible = (elevation_deg >= threshold) & np.isfinite(rsrp_dbm)
+        # 時間為第一軸，使同一時間點的衛星特徵在記憶體中連續
+        self.rsrp_norm = np.ascontiguousarray(np.where(
+            self.visible, np.clip((rsrp_dbm - RSRP_FLOOR_DBM) / RSRP_SPAN_DB, 0.0, 1.0), 0.0).T)
+        self.elevation_norm = np.ascontiguousarray(np.where(
+            self.visible, np.clip(elevation_deg / 90.0, 0.0, 1.0), 0.0).T)
+        self.visible_t = np.ascontiguousarray(self.visible.T)
+        self.top_candidates = self._rank_candidates(self.rsrp_norm, self.visible_t, self.candidate_slots)
+
+        self.observation_size = self.candidate_slots * SLOT_FEATURES + SERVING_FEATURES
+        self.action_size = self.candidate_slots + 1
+
+        # 回合狀態
+        self.time_index = np.zeros(self.num_envs, dtype=np.int64)
+        self.serving = np.zeros(self.num_envs, dtype=np.int64)
+        self.steps = np.zeros(self.num_envs, dtype=np.int64)
+        self.last_handover = np.zeros(self.num_envs, dtype=np.int64)
+        self.episode_return = np.zeros(self.num_envs, dtype=np.float64)
+        self._env_index = np.arange(self.num_envs)
+        self.rng = np.random.default_rng(seed)
+        self.statistics = {'steps': 0, 'episodes_completed': 0, 'handovers': 0, 'outage_steps': 0}
+
+    @staticmethod
+    def _rank_candidates(rsrp_norm: np.ndarray, visible_t: np.ndarray, k: int) -> np.ndarray:
+        """每個時間點依 RSRP 排序的前 K 顆可見衛星 (T, K)，不足以 -1 填補"""
+        scores = np.where(visible_t, rsrp_norm, -1.0)
+        k_eff = min(k, scores.shape[1])
+        order = np.argsort(-scores, axis=1, kind='stable')[:, :k_eff]
+        ranked = np.where(np.take_along_axis(visible_t, order, axis=1), order, -1)
+        if k_eff < k:
+            ranked = np.pad(ranked, ((0, 0), (0, k - k_eff)), constant_values=-1)
+        return ranked.astype(np.int64)
+
+    # === Gym 風格介面 ===
+
+    def reset(self, seed: Optional[int] = None) -> Tuple[np.ndarray, Dict[str, Any]]:
+        """重置所有回合，返回 (觀測, info)"""
+        if seed is not None:
+            self.rng = np.random.default_rng(seed)
+        self._reset_envs(self._env_index)
+        return self._observe(), {}
+
+    def step(self, actions: np.ndarray) -> Tuple[np.ndarray, np.ndarray, np.ndarray, np.ndarray, Dict[str, Any]]:
+        """
+        同步推進所有回合一步
+
+        Returns:
+            (觀測, 獎勵, terminated, truncated, info)，皆為長度 num_envs 的陣列
+        """
+        actions = np.asarray(actions, dtype=np.int64)
+        if actions.shape != (self.num_envs,):
+            raise ValueError(f"actions 形狀必須為 ({self.num_envs},)")
+
+        t = self.time_index
+        # 解析動作: 有效槽位才會成為新的服務衛星
+        slot = np.clip(actions, 0, self.candidate_slots - 1)
+        chosen = self.top_candidates[t, slot]
+        switch = (actions < self.candidate_slots) & (chosen >= 0) & (chosen != self.serving)
+        self.serving = np.where(switch, chosen, self.serving)
+        self.last_handover = np.where(switch, self.steps, self.last_handover)
+
+        # 時間推進後評估服務衛星
+        self.time_index = t + 1
+        self.steps += 1
+        t_next = self.time_index
+        serving_visible = self.visible_t[t_next, self.serving]
+        weights = self.reward_weights
+        rewards = (weights.get('signal_quality', 0.0) * self.rsrp_norm[t_next, self.serving] +
+                   weights.get('coverage', 0.0) * serving_visible +
+                   weights.get('handover_cost', 0.0) * switch +
+                   weights.get('energy_efficiency', 0.0) * self.elevation_norm[t_next, self.serving] +
+                   np.where(serving_visible, 0.0, self.outage_penalty)).astype(np.float32)
+        self.episode_return += rewards
+
+        terminated = np.zeros(self.num_envs, dtype=bool)
+        truncated = self.steps >= self.episode_length
+        self.statistics['steps'] += self.num_envs
+        self.statistics['handovers'] += int(switch.sum())
+        self.statistics['outage_steps'] += int((~serving_visible).sum())
+
+        observations = self._observe()
+        info: Dict[str, Any] = {'handover': switch}
+        done = np.flatnonzero(truncated | terminated)
+        if done.size:
+            info['final_observation'] = observations[done].copy()
+            info['final_env_indices'] = done
+            info['episode_returns'] = self.episode_return[done].copy()
+            self.statistics['episodes_completed'] += int(done.size)
+            self._reset_envs(done)
+            observations[done] = self._observe(done)
+
+        return observations, rewards, terminated, truncated, info
+
+    def _reset_envs(self, envs: np.ndarray):
+        """重置指定回合: 隨機起始時間，服務衛星為起始時 RSRP 最強的可見衛星"""
+        starts = self.rng.integers(0, self.num_times - self.episode_length, size=envs.size)
+        self.time_index[envs] = starts
+        best = self.top_candidates[starts, 0]
+        self.serving[envs] = np.where(best >= 0, best, 0)
+        self.steps[envs] = 0
+        self.last_handover[envs] = 0
+        self.episode_return[envs] = 0.0
+
+    def _observe(self, envs: Optional[np.ndarray] = None) -> np.ndarray:
+        """以陣列索引組出觀測 (len(envs), observation_size) float32"""
+        envs = self._env_index if envs is None else envs
+        t = self.time_index[envs]
+        serving = self.serving[envs]
+        candidates = self.top_candidates[t]                       # (n, K)
+        valid = candidates >= 0
+        safe = np.where(valid, candidates, 0)
+        t_col = t[:, None]
+
+        slots = np.empty((envs.size, self.candidate_slots, SLOT_FEATURES), dtype=np.float32)
+        slots[..., 0] = np.where(valid, self.rsrp_norm[t_col, safe], 0.0)
+        slots[..., 1] = np.where(valid, self.elevation_norm[t_col, safe], 0.0)
+        slots[..., 2] = valid & (candidates == serving[:, None])
+        slots[..., 3] = valid
+
+        observations = np.empty((envs.size, self.observation_size), dtype=np.float32)
+        observations[:, :self.candidate_slots * SLOT_FEATURES] = slots.reshape(envs.size, -1)
+        tail = observations[:, self.candidate_slots * SLOT_FEATURES:]
+        tail[:, 0] = self.rsrp_norm[t, serving]
+        tail[:, 1] = self.elevation_norm[t, serving]
+        tail[:, 2] = self.visible_t[t, serving]
+        tail[:, 3] = (self.steps[envs] - self.last_handover[envs]) / self.episode_length
+        return observations
+
+    # === 建構與資訊 ===
+
+    @classmethod
+    def from_candidates(cls, candidates: List[Dict[str, Any]], num_envs: int,
+                        config: Optional[Dict[str, Any]] = None,
+                        seed: Optional[int] = None) -> "VectorizedHandoverEnv":
+        """
+        由 Stage 4 候選衛星 (含 position_timeseries) 建立共享陣列
+
+        每點 RSRP 取 rsrp_dbm / signal_quality.rsrp_dbm，缺少時使用候選的平均信號強度
+        """
+        timed = [c for c in candidates if c.get('position_timeseries')]
+        if not timed:
+            raise ValueError("候選衛星缺少 position_timeseries，無法建立向量化環境")
+
+        num_times = max(len(c['position_timeseries']) for c in timed)
+        rsrp = np.full((len(timed), num_times), np.nan, dtype=np.float32)
+        elevation = np.full((len(timed), num_times), -90.0, dtype=np.float32)
+        for i, candidate in enumerate(timed):
+            fallback = candidate.get('signal_analysis', {}).get('average_signal_strength', np.nan)
+            for j, point in enumerate(candidate['position_timeseries']):
+                elevation[i, j] = point.get('elevation_deg', point.get('elevation_angle', -90.0))
+                value = point.get('rsrp_dbm')
+                if value is None:
+                    value = (point.get('signal_quality') or {}).get('rsrp_dbm', fallback)
+                rsrp[i, j] = np.nan if value is None else value
+
+        env = cls(rsrp, elevation, num_envs, config, seed)
+        env.satellite_ids = [c.get('satellite_id', f"satellite_{i}") for i, c in enumerate(timed)]
+        return env
+
+    def get_environment_info(self) -> Dict[str, Any]:
+        return {
+            'num_envs': self.num_envs,
+            'num_satellites': self.num_satellites,
+            'num_times': self.num_times,
+            'observation_size': self.observation_size,
+            'action_size': self.action_size,
+            'episode_length': self.episode_length,
+            'reward_weights': self.reward_weights,
+            'statistics': dict(self.statistics),
+        }
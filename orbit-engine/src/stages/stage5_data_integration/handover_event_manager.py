@@ -173,6 +173,28 @@ class HandoverEventManager:
         else:
             return "monitor_only"
 
+    def build_handover_event_rows(self, satellite: Dict[str, Any], events: List[Dict[str, Any]]) -> List[Dict[str, Any]]:
+        """構建換手事件列"""
+        satellite_id = satellite.get("satellite_id")
+        rows = []
+        for event in events:
+            scenario = event.get("scenario_metadata", {})
+            rows.append({
+                "satellite_id": satellite_id,
+                "event_type": event.get("event_type"),
+                "event_timestamp": event.get("event_timestamp"),
+                "trigger_rsrp_dbm": event.get("trigger_rsrp_dbm"),
+                "previous_rsrp_dbm": event.get("previous_rsrp_dbm"),
+                "elevation_deg": event.get("elevation_deg"),
+                "handover_decision": event.get("handover_decision"),
+                "processing_latency_ms": event.get("processing_latency_ms"),
+                "detection_method": event.get("detection_method"),
+                "constellation": scenario.get("constellation"),
+                "signal_change_rate": scenario.get("signal_change_rate_db_per_sec"),
+                "academic_compliance": scenario.get("academic_compliance")
+            })
+        return rows
+
     def insert_handover_events(self, satellite: Dict[str, Any], events: List[Dict[str, Any]]) -> Dict[str, Any]:
         """插入換手事件到PostgreSQL"""
         result = {"success": True, "errors": [], "events_inserted": 0}
@@ -185,22 +207,7 @@ class HandoverEventManager:
         try:
             satellite_id = satellite.get("satellite_id")
 
-            for event in events:
-                event_data = {
-                    "satellite_id": satellite_id,
-                    "event_type": event.get("event_type"),
-                    "event_timestamp": event.get("event_timestamp"),
-                    "trigger_rsrp_dbm": event.get("trigger_rsrp_dbm"),
-                    "previous_rsrp_dbm": event.get("previous_rsrp_dbm"),
-                    "elevation_deg": event.get("elevation_deg"),
-                    "handover_decision": event.get("handover_decision"),
-                    "processing_latency_ms": event.get("processing_latency_ms"),
-                    "detection_method": event.get("detection_method"),
-                    "constellation": event.get("scenario_metadata", {}).get("constellation"),
-                    "signal_change_rate": event.get("scenario_metadata", {}).get("signal_change_rate_db_per_sec"),
-                    "academic_compliance": event.get("scenario_metadata", {}).get("academic_compliance")
-                }
-
+            for event_data in self.build_handover_event_rows(satellite, events):
                 # 構建插入SQL
                 columns = list(event_data.keys())
                 placeholders = ["%s"] * len(columns)
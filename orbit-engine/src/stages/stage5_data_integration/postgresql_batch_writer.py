@@ -0,0 +1,423 @@
+"""
+PostgreSQL Batch Writer - Stage 5 背景批次寫入器
+
+職責：
+1. 以有界佇列接收各表的資料列，生產端 (Stage 5 計算) 不再等待逐列往返
+2. 依表聚合為大批次：僅追加的表使用 COPY，需 upsert 的表使用多列 INSERT
+3. 透過小型連接池並行寫入，並依外鍵依賴保證父表批次先提交
+4. 提供 flush 屏障，於階段結束時確認所有資料已落庫
+"""
+
+import io
+import logging
+import queue
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor, Future, wait
+from dataclasses import dataclass
+from datetime import date, datetime
+from typing import Any, Callable, Dict, Iterable, List, Optional, Sequence, Tuple
+
+try:
+    import psycopg2
+    from psycopg2.extras import execute_values
+    PSYCOPG2_AVAILABLE = True
+except ImportError:
+    PSYCOPG2_AVAILABLE = False
+
+logger = logging.getLogger(__name__)
+
+# 佇列項目類型
+_ROWS = "rows"
+_BARRIER = "barrier"
+_STOP = "stop"
+
+
+@dataclass(frozen=True)
+class TableSpec:
+    """單一目標表的批次寫入規格"""
+    name: str
+    columns: Tuple[str, ...]
+    mode: str = "copy"                          # copy | upsert
+    conflict_key: Optional[str] = None          # upsert 衝突鍵
+    update_columns: Tuple[str, ...] = ()        # upsert 時更新的欄位
+    depends_on: Tuple[str, ...] = ()            # 外鍵父表，其批次須先提交
+
+    def insert_sql(self) -> str:
+        """多列 INSERT 語句 (供 execute_values 展開 VALUES %s)"""
+        sql = f"INSERT INTO {self.name} ({', '.join(self.columns)}) VALUES %s"
+        if self.conflict_key:
+            if self.update_columns:
+                updates = ", ".join(f"{col} = EXCLUDED.{col}" for col in self.update_columns)
+                sql += f" ON CONFLICT ({self.conflict_key}) DO UPDATE SET {updates}"
+            else:
+                sql += f" ON CONFLICT ({self.conflict_key}) DO NOTHING"
+        return sql
+
+    def copy_sql(self) -> str:
+        """COPY FROM STDIN 語句 (CSV 格式)"""
+        return f"COPY {self.name} ({', '.join(self.columns)}) FROM STDIN WITH (FORMAT csv)"
+
+
+# Stage 5 各表的寫入規格：時間戳欄位省略，由表預設值 NOW() 填入
+STAGE5_TABLE_SPECS: Dict[str, TableSpec] = {
+    "satellite_metadata": TableSpec(
+        name="satellite_metadata",
+        columns=("satellite_id", "constellation", "orbital_period_minutes", "inclination_deg",
+                 "eccentricity", "mean_motion", "visibility_rate", "max_elevation_deg"),
+        mode="upsert",
+        conflict_key="satellite_id",
+        update_columns=("constellation", "visibility_rate", "data_integration_timestamp")
+    ),
+    "signal_statistics": TableSpec(
+        name="signal_statistics",
+        columns=("satellite_id", "avg_rsrp_dbm", "min_rsrp_dbm", "max_rsrp_dbm",
+                 "rsrp_std_dev", "signal_quality_grade", "visibility_rate"),
+        depends_on=("satellite_metadata",)
+    ),
+    "handover_events": TableSpec(
+        name="handover_events",
+        columns=("satellite_id", "event_type", "event_timestamp", "trigger_rsrp_dbm",
+                 "previous_rsrp_dbm", "elevation_deg", "handover_decision", "processing_latency_ms",
+                 "detection_method", "constellation", "signal_change_rate", "academic_compliance"),
+        depends_on=("satellite_metadata",)
+    ),
+}
+
+
+def _copy_field(value: Any) -> str:
+    """將單一值編碼為 COPY CSV 欄位 (未加引號的空欄位即 NULL)"""
+    if value is None:
+        return ""
+    if isinstance(value, bool):
+        return "t" if value else "f"
+    if isinstance(value, (int, float)):
+        return repr(value)
+    if isinstance(value, (datetime, date)):
+        value = value.isoformat()
+    text = str(value)
+    return '"' + text.replace('"', '""') + '"'
+
+
+def encode_copy_rows(rows: Iterable[Sequence[Any]]) -> str:
+    """將資料列編碼為 COPY CSV 文本"""
+    return "".join(",".join(_copy_field(v) for v in row) + "\n" for row in rows)
+
+
+class _ConnectionPool:
+    """小型執行緒安全連接池 (延遲建立，最多 max_size 條連接)"""
+
+    def __init__(self, factory: Callable[[], Any], max_size: int):
+        self.factory = factory
+        self.max_size = max_size
+        self._idle: "queue.LifoQueue" = queue.LifoQueue()
+        self._created = 0
+        self._lock = threading.Lock()
+
+    def acquire(self):
+        try:
+            return self._idle.get_nowait()
+        except queue.Empty:
+            pass
+        with self._lock:
+            if self._created < self.max_size:
+                self._created += 1
+                try:
+                    return self.factory()
+                except Exception:
+                    self._created -= 1
+                    raise
+        return self._idle.get()
+
+    def release(self, connection, broken: bool = False):
+        if broken:
+            try:
+                connection.close()
+            except Exception:
+                pass
+            with self._lock:
+                self._created -= 1
+            return
+        self._idle.put(connection)
+
+    def close_all(self):
+        while True:
+            try:
+                connection = self._idle.get_nowait()
+            except queue.Empty:
+                break
+            try:
+                connection.close()
+            except Exception:
+                pass
+        with self._lock:
+            self._created = 0
+
+
+class PostgreSQLBatchWriter:
+    """
+    背景批次寫入器
+
+    生產端呼叫 put()/put_many() 將資料列放入有界佇列 (滿時阻塞形成背壓)；
+    收集執行緒依表累積，達到 batch_size 或佇列閒置 flush_interval_seconds 時
+    交由寫入執行緒池以 COPY / 多列 INSERT 批次提交。flush() 為屏障，
+    返回前保證先前放入的資料列均已提交或記錄為錯誤。
+    """
+
+    def __init__(self, connection_factory: Callable[[], Any],
+                 table_specs: Optional[Dict[str, TableSpec]] = None,
+                 config: Optional[Dict[str, Any]] = None):
+        """
+        初始化批次寫入器
+
+        Args:
+            connection_factory: 建立數據庫連接的函數
+            table_specs: 目標表寫入規格，預設為 Stage 5 各表
+            config: batch_size / queue_size / pool_size / flush_interval_seconds / put_timeout_seconds
+        """
+        self.logger = logging.getLogger(__name__)
+        self.config = config or {}
+        self.table_specs = dict(table_specs or STAGE5_TABLE_SPECS)
+
+        self.batch_size = max(1, int(self.config.get("batch_size", 1000)))
+        self.queue_size = max(1, int(self.config.get("queue_size", 10000)))
+        self.pool_size = max(1, int(self.config.get("pool_size", 2)))
+        self.flush_interval = float(self.config.get("flush_interval_seconds", 0.5))
+        self.put_timeout = self.config.get("put_timeout_seconds")
+
+        self._pool = _ConnectionPool(connection_factory, self.pool_size)
+        self._queue: "queue.Queue" = queue.Queue(maxsize=self.queue_size)
+        self._buffers: Dict[str, List[Tuple[Any, ...]]] = {name: [] for name in self.table_specs}
+        self._pending: Dict[str, List[Future]] = {name: [] for name in self.table_specs}
+        self._deferred: List[Tuple[TableSpec, List[Tuple[Any, ...]]]] = []
+        self._deferred_rows = 0
+        self._executor: Optional[ThreadPoolExecutor] = None
+        self._collector: Optional[threading.Thread] = None
+        self._stats_lock = threading.Lock()
+        self._errors: List[str] = []
+
+        self.write_statistics = {
+            "rows_enqueued": 0,
+            "rows_written": 0,
+            "rows_failed": 0,
+            "batches_written": 0,
+            "batches_failed": 0,
+            "write_time_seconds": 0.0,
+            "rows_by_table": {name: 0 for name in self.table_specs}
+        }
+
+    # === 生命週期 ===
+
+    def start(self) -> "PostgreSQLBatchWriter":
+        """啟動收集執行緒與寫入執行緒池"""
+        if self._collector is not None:
+            return self
+        self._executor = ThreadPoolExecutor(max_workers=self.pool_size, thread_name_prefix="stage5-pg-writer")
+        self._collector = threading.Thread(target=self._collect_loop, name="stage5-pg-collector", daemon=True)
+        self._collector.start()
+        self.logger.info(f"🚚 PostgreSQL批次寫入器已啟動: batch={self.batch_size}, pool={self.pool_size}")
+        return self
+
+    @property
+    def running(self) -> bool:
+        return self._collector is not None and self._collector.is_alive()
+
+    def close(self, timeout: Optional[float] = None) -> Dict[str, Any]:
+        """寫出剩餘資料並停止所有執行緒、關閉連接池"""
+        result = {"success": True, "errors": []}
+        if self._collector is not None:
+            done = threading.Event()
+            self._queue.put((_STOP, done))
+            done.wait(timeout)
+            self._collector.join(timeout)
+            self._collector = None
+            result = self._barrier_result()
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+        self._pool.close_all()
+        return result
+
+    # === 生產端 ===
+
+    def put(self, table: str, row: Any):
+        """放入單列 (dict 依規格欄位取值，序列須與欄位順序一致)"""
+        self.put_many(table, [row])
+
+    def put_many(self, table: str, rows: Iterable[Any]):
+        """以單一佇列項目放入多列，降低佇列開銷"""
+        if not self.running:
+            raise RuntimeError("批次寫入器未啟動，請先調用 start()")
+        spec = self.table_specs.get(table)
+        if spec is None:
+            raise KeyError(f"未知的目標表: {table}")
+        prepared = [self._to_tuple(spec, row) for row in rows]
+        if not prepared:
+            return
+        self._queue.put((_ROWS, table, prepared), timeout=self.put_timeout)
+        with self._stats_lock:
+            self.write_statistics["rows_enqueued"] += len(prepared)
+
+    def flush(self, timeout: Optional[float] = None) -> Dict[str, Any]:
+        """屏障：等待先前放入的資料列全部寫出，返回期間累積的錯誤"""
+        if not self.running:
+            return self._barrier_result()
+        done = threading.Event()
+        self._queue.put((_BARRIER, done))
+        if not done.wait(timeout):
+            return {"success": False, "errors": [f"批次寫入 flush 逾時 ({timeout}s)"]}
+        return self._barrier_result()
+
+    def get_statistics(self) -> Dict[str, Any]:
+        """獲取寫入統計信息"""
+        with self._stats_lock:
+            stats = dict(self.write_statistics)
+            stats["rows_by_table"] = dict(self.write_statistics["rows_by_table"])
+        stats["queue_depth"] = self._queue.qsize()
+        return stats
+
+    # === 收集執行緒 ===
+
+    def _collect_loop(self):
+        while True:
+            try:
+                item = self._queue.get(timeout=self.flush_interval)
+            except queue.Empty:
+                # 佇列閒置時寫出部分批次，讓計算與 I/O 重疊
+                self._submit_all()
+                continue
+
+            kind = item[0]
+            if kind == _ROWS:
+                _, table, rows = item
+                buffer = self._buffers[table]
+                buffer.extend(rows)
+                if len(buffer) >= self.batch_size:
+                    self._submit(table, partial=False)
+            elif kind == _BARRIER:
+                self._drain()
+                item[1].set()
+            elif kind == _STOP:
+                self._drain()
+                item[1].set()
+                return
+
+    def _submit(self, table: str, partial: bool = True):
+        """送出緩衝批次；partial=False 時不足 batch_size 的餘數留待後續累積"""
+        spec = self.table_specs[table]
+        buffer = self._buffers[table]
+        while buffer and (partial or len(buffer) >= self.batch_size):
+            rows = buffer[:self.batch_size]
+            del buffer[:self.batch_size]
+            self._dispatch(spec, rows)
+        self._release_deferred()
+
+    def _dispatch(self, spec: TableSpec, rows: List[Tuple[Any, ...]]):
+        # 子表列的父表資料可能仍在緩衝中：暫緩至父表批次送出，避免為保序而送出零碎父表批次
+        if any(self._buffers.get(parent) for parent in spec.depends_on):
+            self._deferred.append((spec, rows))
+            self._deferred_rows += len(rows)
+            if self._deferred_rows >= self.queue_size:
+                for parent in spec.depends_on:
+                    if self._buffers.get(parent):
+                        self._submit(parent)
+            return
+
+        parents = [f for parent in spec.depends_on for f in self._pending.get(parent, []) if not f.done()]
+        future = self._executor.submit(self._write_batch, spec, rows, parents)
+        self._pending[spec.name] = [f for f in self._pending[spec.name] if not f.done()]
+        self._pending[spec.name].append(future)
+
+    def _release_deferred(self):
+        if not self._deferred:
+            return
+        deferred, self._deferred, self._deferred_rows = self._deferred, [], 0
+        for spec, rows in deferred:
+            self._dispatch(spec, rows)
+
+    def _submit_all(self):
+        for table in self.table_specs:
+            if self._buffers[table]:
+                self._submit(table)
+        self._release_deferred()
+
+    def _drain(self):
+        self._submit_all()
+        wait([f for futures in self._pending.values() for f in futures])
+        for table in self._pending:
+            self._pending[table] = []
+
+    # === 寫入執行緒 ===
+
+    def _write_batch(self, spec: TableSpec, rows: List[Tuple[Any, ...]], parents: List[Future]):
+        if parents:
+            wait(parents)
+
+        start = time.perf_counter()
+        connection = None
+        broken = False
+        try:
+            connection = self._pool.acquire()
+            cursor = connection.cursor()
+            try:
+                if spec.mode == "copy":
+                    cursor.copy_expert(spec.copy_sql(), io.StringIO(encode_copy_rows(rows)))
+                else:
+                    rows = self._dedupe(spec, rows)
+                    if PSYCOPG2_AVAILABLE:
+                        execute_values(cursor, spec.insert_sql(), rows, page_size=len(rows))
+                    else:
+                        row_sql = "(" + ", ".join(["%s"] * len(spec.columns)) + ")"
+                        sql = spec.insert_sql().replace("VALUES %s", "VALUES " + ", ".join([row_sql] * len(rows)))
+                        cursor.execute(sql, [value for row in rows for value in row])
+            finally:
+                cursor.close()
+            connection.commit()
+
+            with self._stats_lock:
+                self.write_statistics["rows_written"] += len(rows)
+                self.write_statistics["batches_written"] += 1
+                self.write_statistics["rows_by_table"][spec.name] += len(rows)
+                self.write_statistics["write_time_seconds"] += time.perf_counter() - start
+
+        except Exception as e:
+            if connection is not None:
+                try:
+                    connection.rollback()
+                except Exception:
+                    broken = True
+                broken = broken or bool(getattr(connection, "closed", 0))
+            error_msg = f"{spec.name} 批次寫入失敗 ({len(rows)} 列): {e}"
+            self.logger.error(f"   ❌ {error_msg}")
+            with self._stats_lock:
+                self.write_statistics["rows_failed"] += len(rows)
+                self.write_statistics["batches_failed"] += 1
+                self._errors.append(error_msg)
+        finally:
+            if connection is not None:
+                self._pool.release(connection, broken)
+
+    # === 內部工具 ===
+
+    @staticmethod
+    def _to_tuple(spec: TableSpec, row: Any) -> Tuple[Any, ...]:
+        if isinstance(row, dict):
+            return tuple(row.get(col) for col in spec.columns)
+        row = tuple(row)
+        if len(row) != len(spec.columns):
+            raise ValueError(f"{spec.name} 欄位數不符: 期望 {len(spec.columns)}，實際 {len(row)}")
+        return row
+
+    @staticmethod
+    def _dedupe(spec: TableSpec, rows: List[Tuple[Any, ...]]) -> List[Tuple[Any, ...]]:
+        """同一語句內 ON CONFLICT 不可重複更新同一列，保留衝突鍵的最後一筆"""
+        if not spec.conflict_key:
+            return rows
+        key_index = spec.columns.index(spec.conflict_key)
+        latest = {row[key_index]: row for row in rows}
+        return list(latest.values())
+
+    def _barrier_result(self) -> Dict[str, Any]:
+        with self._stats_lock:
+            errors, self._errors = self._errors, []
+        return {"success": not errors, "errors": errors}
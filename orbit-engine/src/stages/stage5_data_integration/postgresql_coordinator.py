@@ -4,13 +4,14 @@ PostgreSQL Coordinator - 重構後的主協調器
 """
 
 import logging
-from typing import Dict, Any, Optional
+from typing import Dict, Any, List, Optional
 import psycopg2
 from psycopg2.extras import DictCursor
 
 from .database_schema_manager import DatabaseSchemaManager
 from .signal_data_processor import SignalDataProcessor
 from .handover_event_manager import HandoverEventManager
+from .postgresql_batch_writer import PostgreSQLBatchWriter
 
 logger = logging.getLogger(__name__)
 
@@ -36,6 +37,17 @@ class PostgreSQLCoordinator:
             "password": self.config.get("password", "postgres")
         }
 
+        # 背景批次寫入配置 (停用時回退為逐衛星同步插入)
+        self.batch_writer_config = {
+            "enabled": True,
+            "batch_size": 1000,
+            "queue_size": 10000,
+            "pool_size": 2,
+            "flush_interval_seconds": 0.5,
+            "flush_timeout_seconds": 300,
+            **self.config.get("batch_writer", {})
+        }
+
         # 統計信息
         self.integration_statistics = {
             "total_satellites_processed": 0,
@@ -186,33 +198,10 @@ class PostgreSQLCoordinator:
 
             # 3. 處理衛星數據
             satellites_data = integrated_data.get("satellites", [])
-            for satellite in satellites_data:
-                satellite_id = satellite.get("satellite_id")
-
-                # 插入衛星元數據
-                metadata_result = self.signal_processor.insert_satellite_metadata(satellite)
-                if not metadata_result["success"]:
-                    result["errors"].extend(metadata_result["errors"])
-
-                # 提取並插入信號統計
-                signal_stats = self.signal_processor.extract_signal_statistics(satellite)
-                if signal_stats:
-                    stats_result = self.signal_processor.insert_signal_statistics(satellite, signal_stats)
-                    if stats_result["success"]:
-                        self.integration_statistics["signal_statistics_processed"] += 1
-                    else:
-                        result["errors"].extend(stats_result["errors"])
-
-                # 生成並插入換手事件
-                handover_events = self.event_manager.generate_handover_events(satellite)
-                if handover_events:
-                    events_result = self.event_manager.insert_handover_events(satellite, handover_events)
-                    if events_result["success"]:
-                        self.integration_statistics["handover_events_processed"] += events_result["events_inserted"]
-                    else:
-                        result["errors"].extend(events_result["errors"])
-
-                self.integration_statistics["total_satellites_processed"] += 1
+            if self.batch_writer_config.get("enabled", True):
+                self._integrate_satellites_batched(satellites_data, result)
+            else:
+                self._integrate_satellites_sync(satellites_data, result)
 
             # 4. 提交事務
             self.connection.commit()
@@ -254,6 +243,84 @@ class PostgreSQLCoordinator:
 
         return result
 
+    def _integrate_satellites_sync(self, satellites_data: List[Dict[str, Any]], result: Dict[str, Any]):
+        """逐衛星同步插入 (批次寫入停用時使用)"""
+        for satellite in satellites_data:
+            # 插入衛星元數據
+            metadata_result = self.signal_processor.insert_satellite_metadata(satellite)
+            if not metadata_result["success"]:
+                result["errors"].extend(metadata_result["errors"])
+
+            # 提取並插入信號統計
+            signal_stats = self.signal_processor.extract_signal_statistics(satellite)
+            if signal_stats:
+                stats_result = self.signal_processor.insert_signal_statistics(satellite, signal_stats)
+                if stats_result["success"]:
+                    self.integration_statistics["signal_statistics_processed"] += 1
+                else:
+                    result["errors"].extend(stats_result["errors"])
+
+            # 生成並插入換手事件
+            handover_events = self.event_manager.generate_handover_events(satellite)
+            if handover_events:
+                events_result = self.event_manager.insert_handover_events(satellite, handover_events)
+                if events_result["success"]:
+                    self.integration_statistics["handover_events_processed"] += events_result["events_inserted"]
+                else:
+                    result["errors"].extend(events_result["errors"])
+
+            self.integration_statistics["total_satellites_processed"] += 1
+
+    def _integrate_satellites_batched(self, satellites_data: List[Dict[str, Any]], result: Dict[str, Any]):
+        """經背景批次寫入器整合：計算與數據庫寫入重疊，階段結束以 flush 屏障確認落庫"""
+        writer = PostgreSQLBatchWriter(self._create_writer_connection, config=self.batch_writer_config).start()
+
+        try:
+            for satellite in satellites_data:
+                writer.put("satellite_metadata", self.signal_processor.build_satellite_metadata_row(satellite))
+
+                signal_stats = self.signal_processor.extract_signal_statistics(satellite)
+                if signal_stats:
+                    writer.put("signal_statistics",
+                               self.signal_processor.build_signal_statistics_row(satellite, signal_stats))
+
+                handover_events = self.event_manager.generate_handover_events(satellite)
+                if handover_events:
+                    writer.put_many("handover_events",
+                                    self.event_manager.build_handover_event_rows(satellite, handover_events))
+
+                self.integration_statistics["total_satellites_processed"] += 1
+
+            flush_result = writer.flush(self.batch_writer_config.get("flush_timeout_seconds"))
+            result["errors"].extend(flush_result["errors"])
+        finally:
+            close_result = writer.close(self.batch_writer_config.get("flush_timeout_seconds"))
+            result["errors"].extend(close_result["errors"])
+
+        # 以實際落庫列數更新統計
+        write_stats = writer.get_statistics()
+        rows_by_table = write_stats["rows_by_table"]
+        self.integration_statistics["signal_statistics_processed"] += rows_by_table["signal_statistics"]
+        self.integration_statistics["handover_events_processed"] += rows_by_table["handover_events"]
+        self.signal_processor.processing_statistics["metadata_inserted"] += rows_by_table["satellite_metadata"]
+        self.event_manager.event_statistics["events_inserted"] += rows_by_table["handover_events"]
+        self.integration_statistics["batch_writer"] = write_stats
+
+        self.logger.info(f"🚚 批次寫入完成: {write_stats['rows_written']} 列 / "
+                         f"{write_stats['batches_written']} 批, 失敗 {write_stats['rows_failed']} 列")
+
+    def _create_writer_connection(self):
+        """為批次寫入器連接池建立連接"""
+        connection = psycopg2.connect(
+            host=self.db_config["host"],
+            port=self.db_config["port"],
+            database=self.db_config["database"],
+            user=self.db_config["user"],
+            password=self.db_config["password"]
+        )
+        connection.autocommit = False
+        return connection
+
     def insert_processing_summary(self, integrated_data: Dict[str, Any]) -> Dict[str, Any]:
         """插入處理摘要到PostgreSQL"""
         result = {"success": True, "errors": []}
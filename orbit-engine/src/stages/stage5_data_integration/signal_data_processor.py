@@ -107,6 +107,34 @@ class SignalDataProcessor:
         from .stage5_shared_utilities import grade_signal_quality
         return grade_signal_quality(rsrp_dbm)
 
+    def build_satellite_metadata_row(self, satellite: Dict[str, Any]) -> Dict[str, Any]:
+        """從多階段數據構建衛星元數據列 (不含時間戳欄位)"""
+        stage1_data = satellite.get("stage1_orbital", {})
+        visibility_stats = satellite.get("stage2_visibility", {}).get("visibility_statistics", {})
+
+        return {
+            "satellite_id": satellite.get("satellite_id"),
+            "constellation": satellite.get("constellation", "unknown"),
+            "orbital_period_minutes": stage1_data.get("orbital_period_minutes"),
+            "inclination_deg": stage1_data.get("inclination_deg"),
+            "eccentricity": stage1_data.get("eccentricity"),
+            "mean_motion": stage1_data.get("mean_motion"),
+            "visibility_rate": visibility_stats.get("visibility_rate", 0.0),
+            "max_elevation_deg": visibility_stats.get("max_elevation_deg")
+        }
+
+    def build_signal_statistics_row(self, satellite: Dict[str, Any], signal_stats: Dict[str, Any]) -> Dict[str, Any]:
+        """構建信號統計列 (不含時間戳欄位)"""
+        return {
+            "satellite_id": satellite.get("satellite_id"),
+            "avg_rsrp_dbm": signal_stats.get("avg_rsrp_dbm"),
+            "min_rsrp_dbm": signal_stats.get("min_rsrp_dbm"),
+            "max_rsrp_dbm": signal_stats.get("max_rsrp_dbm"),
+            "rsrp_std_dev": signal_stats.get("rsrp_std_dev"),
+            "signal_quality_grade": signal_stats.get("signal_quality_grade"),
+            "visibility_rate": signal_stats.get("visibility_rate")
+        }
+
     def insert_satellite_metadata(self, satellite: Dict[str, Any]) -> Dict[str, Any]:
         """插入衛星元數據到PostgreSQL"""
         result = {"success": True, "errors": []}
@@ -115,23 +143,8 @@ class SignalDataProcessor:
 
         try:
             satellite_id = satellite.get("satellite_id")
-            constellation = satellite.get("constellation", "unknown")
-
-            # 從多階段數據中提取元數據
-            stage1_data = satellite.get("stage1_orbital", {})
-            stage2_data = satellite.get("stage2_visibility", {})
-
-            metadata = {
-                "satellite_id": satellite_id,
-                "constellation": constellation,
-                "orbital_period_minutes": stage1_data.get("orbital_period_minutes"),
-                "inclination_deg": stage1_data.get("inclination_deg"),
-                "eccentricity": stage1_data.get("eccentricity"),
-                "mean_motion": stage1_data.get("mean_motion"),
-                "visibility_rate": stage2_data.get("visibility_statistics", {}).get("visibility_rate", 0.0),
-                "max_elevation_deg": stage2_data.get("visibility_statistics", {}).get("max_elevation_deg"),
-                "data_integration_timestamp": "NOW()"
-            }
+            metadata = self.build_satellite_metadata_row(satellite)
+            metadata["data_integration_timestamp"] = "NOW()"
 
             # 構建插入SQL
             columns = list(metadata.keys())
@@ -168,18 +181,8 @@ class SignalDataProcessor:
 
         try:
             satellite_id = satellite.get("satellite_id")
-
-            # 準備信號統計數據
-            stats_data = {
-                "satellite_id": satellite_id,
-                "avg_rsrp_dbm": signal_stats.get("avg_rsrp_dbm"),
-                "min_rsrp_dbm": signal_stats.get("min_rsrp_dbm"),
-                "max_rsrp_dbm": signal_stats.get("max_rsrp_dbm"),
-                "rsrp_std_dev": signal_stats.get("rsrp_std_dev"),
-                "signal_quality_grade": signal_stats.get("signal_quality_grade"),
-                "visibility_rate": signal_stats.get("visibility_rate"),
-                "timestamp": "NOW()"
-            }
+            stats_data = self.build_signal_statistics_row(satellite, signal_stats)
+            stats_data["timestamp"] = "NOW()"
 
             # 構建插入SQL
             columns = list(stats_data.keys())
@@ -12,8 +12,15 @@ import os
 import json
 import logging
 from typing import Dict, List, Any, Optional, Tuple
+from dataclasses import asdict
 from datetime import datetime, timezone
 
+try:
+    from shared.utils.storage_tiering import TierCostModel
+    TIERING_AVAILABLE = True
+except ImportError:
+    TIERING_AVAILABLE = False
+
 logger = logging.getLogger(__name__)
 
 class StorageBalanceAnalyzer:
@@ -90,7 +97,8 @@ class StorageBalanceAnalyzer:
             "performance_analysis": {},
             "balance_assessment": {},
             "optimization_recommendations": [],
-            "cost_analysis": {}
+            "cost_analysis": {},
+            "tiering_policy": {}
         }
         
         # 1. 計算存儲需求
@@ -122,6 +130,10 @@ class StorageBalanceAnalyzer:
             storage_requirements, performance_analysis
         )
         balance_analysis["cost_analysis"] = cost_analysis
+
+        # 6. 導出自動分層成本模型 (熱窗口留在PostgreSQL，冷窗口降級為Volume欄式檔案)
+        if TIERING_AVAILABLE:
+            balance_analysis["tiering_policy"] = asdict(self.build_tier_cost_model(performance_analysis))
         
         # 更新統計
         self.analysis_statistics["balance_analyses_performed"] += 1
@@ -313,6 +325,32 @@ class StorageBalanceAnalyzer:
         
         return performance_analysis
     
+    def build_tier_cost_model(self, performance_analysis: Dict[str, Any]) -> "TierCostModel":
+        """
+        以性能評估與存儲成本係數建立分層成本模型
+
+        熱層對應PostgreSQL (索引查詢)，溫層為Volume JSON，冷層為Volume壓縮欄式檔案；
+        單位存儲成本以Volume為基準的相對值表示。
+        """
+        pg_perf = performance_analysis["postgresql_performance"]
+        vol_perf = performance_analysis["volume_performance"]
+        pg_cost = self.storage_characteristics["postgresql"]["cost_factors"]["storage_cost_per_gb"]
+        vol_cost = self.storage_characteristics["volume_storage"]["cost_factors"]["storage_cost_per_gb"]
+
+        model = TierCostModel()
+        model.read_latency_ms = {
+            "hot": pg_perf["index_query_ms"],
+            "warm": vol_perf["bulk_access_ms"],
+            "cold": vol_perf["structured_query_ms"]
+        }
+        baseline = model.footprint_cost_per_mb["warm"]
+        model.footprint_cost_per_mb = {
+            "hot": baseline * pg_cost / vol_cost,
+            "warm": baseline,
+            "cold": baseline
+        }
+        return model
+
     def _assess_postgresql_performance(self, satellites_count: int) -> Dict[str, Any]:
         """評估PostgreSQL性能"""
         # 基於數據量的性能模型
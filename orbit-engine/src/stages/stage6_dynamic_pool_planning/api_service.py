@@ -27,13 +27,15 @@ from pathlib import Path
 try:
     from fastapi import FastAPI, HTTPException, Request, Depends, Query, Path as PathParam
     from fastapi.middleware.cors import CORSMiddleware
-    from fastapi.responses import JSONResponse
+    from fastapi.responses import JSONResponse, Response
     from fastapi.security import HTTPBearer, HTTPAuthorizationCredentials
     import uvicorn
     FASTAPI_AVAILABLE = True
 except ImportError:
     FASTAPI_AVAILABLE = False
 
+from .result_cache import ResultGeneration, Stage6ResultCache, Stage6Sources
+
 
 @dataclass
 class APIResponse:
@@ -136,6 +138,11 @@ class APIService:
             'avg_response_time': 0
         }
 
+        # 世代化結果快取：常用查詢變體在 Stage 6 完成時預先計算並編碼
+        self.result_cache = Stage6ResultCache(self.api_config.get('result_cache', {}))
+        # 冷快取時進行中的重建 (同一時間只建一次，並發請求共用)
+        self._refresh_future: Optional[asyncio.Future] = None
+
         # FastAPI 應用
         if FASTAPI_AVAILABLE:
             self.app = self._create_fastapi_app()
@@ -246,39 +253,18 @@ class APIService:
 
         @app.get("/api/v1/satellite-pools")
         async def get_satellite_pools(
+            request: Request,
             limit: int = Query(50, ge=1, le=1000),
             offset: int = Query(0, ge=0),
-            constellation: Optional[str] = Query(None)
+            constellation: Optional[str] = Query(None),
+            quality_grade: Optional[str] = Query(None)
         ):
-            """獲取衛星池數據"""
+            """獲取衛星池數據 (Accept 可選 application/msgpack 或 Arrow IPC stream)"""
             try:
-                # 嘗試從快取獲取
-                cache_key = f"satellite_pools_{limit}_{offset}_{constellation or 'all'}"
-                cached_data = None
-
-                if self.cache_manager:
-                    cached_data = self.cache_manager.get(cache_key, 'satellite_pools')
-
-                if cached_data:
-                    return self._create_api_response(
-                        success=True,
-                        data=cached_data,
-                        message="Satellite pools retrieved from cache"
-                    )
-
-                # 從存儲獲取
-                pools_data = await self._get_satellite_pools_data(limit, offset, constellation)
-
-                # 設置快取
-                if self.cache_manager and pools_data:
-                    self.cache_manager.set(cache_key, pools_data, ttl=300)
-
-                return self._create_api_response(
-                    success=True,
-                    data=pools_data,
-                    message=f"Retrieved {len(pools_data.get('pools', []))} satellite pools"
-                )
-
+                return await self._encoded_view(request, 'satellite_pools', limit=limit, offset=offset,
+                                                constellation=constellation, quality_grade=quality_grade)
+            except HTTPException:
+                raise
             except Exception as e:
                 self.logger.error(f"❌ 獲取衛星池失敗: {e}")
                 raise HTTPException(status_code=500, detail=str(e))
@@ -324,43 +310,24 @@ class APIService:
 
         @app.get("/api/v1/animation-data")
         async def get_animation_data(
+            request: Request,
             time_range: Optional[str] = Query(None),
-            satellite_ids: Optional[str] = Query(None)
+            satellite_ids: Optional[str] = Query(None),
+            quality_grade: Optional[str] = Query(None)
         ):
-            """獲取動畫數據"""
+            """獲取動畫數據 (Accept 可選 application/msgpack 或 Arrow IPC stream)"""
             try:
-                cache_key = f"animation_data_{time_range or 'all'}_{satellite_ids or 'all'}"
-                cached_data = None
-
-                if self.cache_manager:
-                    cached_data = self.cache_manager.get(cache_key, 'animation_data')
-
-                if cached_data:
-                    return self._create_api_response(
-                        success=True,
-                        data=cached_data,
-                        message="Animation data retrieved from cache"
-                    )
-
-                # 從存儲獲取動畫數據
-                animation_data = await self._get_animation_data(time_range, satellite_ids)
-
-                # 設置快取
-                if self.cache_manager and animation_data:
-                    self.cache_manager.set(cache_key, animation_data, ttl=120)  # 2分鐘快取
-
-                return self._create_api_response(
-                    success=True,
-                    data=animation_data,
-                    message="Animation data retrieved"
-                )
-
+                return await self._encoded_view(request, 'animation_data', time_range=time_range,
+                                                satellite_ids=satellite_ids, quality_grade=quality_grade)
+            except HTTPException:
+                raise
             except Exception as e:
                 self.logger.error(f"❌ 獲取動畫數據失敗: {e}")
                 raise HTTPException(status_code=500, detail=str(e))
 
         @app.get("/api/v1/handover-events")
         async def get_handover_events(
+            request: Request,
             limit: int = Query(100, ge=1, le=1000),
             satellite_id: Optional[str] = Query(None),
             time_start: Optional[str] = Query(None),
@@ -368,32 +335,10 @@ class APIService:
         ):
             """獲取換手事件"""
             try:
-                cache_key = f"handover_events_{limit}_{satellite_id or 'all'}_{time_start or 'none'}_{time_end or 'none'}"
-                cached_data = None
-
-                if self.cache_manager:
-                    cached_data = self.cache_manager.get(cache_key, 'handover_events')
-
-                if cached_data:
-                    return self._create_api_response(
-                        success=True,
-                        data=cached_data,
-                        message="Handover events retrieved from cache"
-                    )
-
-                # 從存儲獲取換手事件
-                handover_events = await self._get_handover_events(limit, satellite_id, time_start, time_end)
-
-                # 設置快取
-                if self.cache_manager and handover_events:
-                    self.cache_manager.set(cache_key, handover_events, ttl=180)  # 3分鐘快取
-
-                return self._create_api_response(
-                    success=True,
-                    data=handover_events,
-                    message=f"Retrieved {len(handover_events.get('events', []))} handover events"
-                )
-
+                return await self._encoded_view(request, 'handover_events', limit=limit, satellite_id=satellite_id,
+                                                time_start=time_start, time_end=time_end)
+            except HTTPException:
+                raise
             except Exception as e:
                 self.logger.error(f"❌ 獲取換手事件失敗: {e}")
                 raise HTTPException(status_code=500, detail=str(e))
@@ -421,6 +366,7 @@ class APIService:
             stats = {
                 "request_stats": self.request_stats,
                 "cache_stats": self.cache_manager.get_cache_statistics() if self.cache_manager else {},
+                "result_cache": self.result_cache.get_stats(),
                 "storage_stats": self.storage_manager.get_storage_statistics() if self.storage_manager else {}
             }
 
@@ -430,41 +376,130 @@ class APIService:
                 message="API statistics retrieved"
             )
 
-    async def _get_satellite_pools_data(self, limit: int, offset: int, constellation: Optional[str]) -> Dict[str, Any]:
-        """獲取衛星池數據 - 真實實現"""
+    # 各查詢視圖在 Arrow 格式下作為表格的記錄路徑
+    _VIEW_TABLE_KEYS = {
+        'satellite_pools': 'data.pools',
+        'animation_data': 'data.animation_frames',
+        'handover_events': 'data.events'
+    }
+
+    async def _encoded_view(self, request, view: str, **params):
+        """
+        由目前結果快取世代回應查詢
+
+        常用變體在 Stage 6 完成時已編碼；其他變體在記憶體索引上計算後於世代內記憶。
+        ETag 含世代權杖，If-None-Match 相符時回 304。
+        """
+        generation = await self._result_generation_async()
+
+        def build() -> Dict[str, Any]:
+            return self._view_envelope(view, generation.view(view, **params))
+
+        if generation.encoder is None:
+            return build()
+        encoded = await generation.encoder.respond(
+            build,
+            accept=request.headers.get("accept"),
+            if_none_match=request.headers.get("if-none-match"),
+            etag_parts=generation.etag_parts(view, generation.normalize(view, **params)),
+            table_key=self._VIEW_TABLE_KEYS[view],
+            cache_control="no-cache"
+        )
+        return encoded.to_response(Response)
+
+    def _view_envelope(self, view: str, data: Dict[str, Any]) -> Dict[str, Any]:
+        """查詢結果 → 標準化 API 響應 (預先計算與即時查詢共用)"""
+        if view == 'satellite_pools':
+            message = f"Retrieved {len(data.get('pools', []))} satellite pools"
+        elif view == 'handover_events':
+            message = f"Retrieved {len(data.get('events', []))} handover events"
+        else:
+            message = "Animation data retrieved"
+        return self._create_api_response(success=True, data=data, message=message)
+
+    def refresh_result_cache(self) -> Dict[str, Any]:
+        """由存儲重建結果快取並發布新世代 (Stage 6 完成持久化後呼叫)"""
+        generation = self.result_cache.build(self._load_result_sources(), self._view_envelope)
+        self.result_cache.publish(generation)
+        return generation.get_stats()
+
+    def _result_generation(self) -> ResultGeneration:
+        """目前世代；尚未建立 (例如獨立啟動 API 服務) 時由存儲建立"""
+        generation = self.result_cache.current
+        if generation is None:
+            self.refresh_result_cache()
+            generation = self.result_cache.current
+        return generation
+
+    async def _result_generation_async(self) -> ResultGeneration:
+        """
+        目前世代 (非同步處理器使用)
+
+        冷快取時在執行緒池中由存儲重建，不阻塞事件迴圈；
+        並發請求等待同一個重建 (single-flight)，存儲只讀一次。
+        """
+        generation = self.result_cache.current
+        if generation is not None:
+            return generation
+        loop = asyncio.get_running_loop()
+        # 同步包裝器每次使用新的事件迴圈，其他迴圈的重建不可共用
+        if (self._refresh_future is None or self._refresh_future.done()
+                or self._refresh_future.get_loop() is not loop):
+            self._refresh_future = loop.run_in_executor(None, self.refresh_result_cache)
+        future = self._refresh_future
+        try:
+            await asyncio.shield(future)
+        finally:
+            if future.done() and self._refresh_future is future:
+                self._refresh_future = None
+        return self.result_cache.current
+
+    def _load_result_sources(self) -> Stage6Sources:
+        """從存儲讀入衛星池清單、最新動畫數據與換手事件"""
         if not self.storage_manager:
             raise RuntimeError("StorageManager 未初始化，無法獲取真實數據")
-        
-        try:
-            # 從存儲管理器獲取真實數據
-            stored_data = self.storage_manager.list_stored_data('satellite_pools')
-            
-            # 應用constellation過濾器
-            if constellation:
-                filtered_data = [
-                    item for item in stored_data 
-                    if item.get('metadata', {}).get('constellation') == constellation
-                ]
+
+        sources = Stage6Sources(pools=self.storage_manager.list_stored_data('satellite_pools'))
+
+        # 最新的動畫數據
+        animation_data_list = self.storage_manager.list_stored_data('animation_data')
+        if animation_data_list:
+            latest_data = max(animation_data_list, key=lambda x: x.get('modified_time', ''))
+            animation_content = self.storage_manager.retrieve_data(latest_data['data_id'])
+            if animation_content and 'data' in animation_content:
+                sources.animation_frames = animation_content['data']
             else:
-                filtered_data = stored_data
-            
-            # 應用分頁
-            total_count = len(filtered_data)
-            paginated_data = filtered_data[offset:offset + limit]
-            
-            return {
-                "pools": paginated_data,
-                "total": total_count,
-                "limit": limit,
-                "offset": offset,
-                "constellation_filter": constellation,
-                "data_source": "real_storage",
-                "query_timestamp": datetime.now(timezone.utc).isoformat()
-            }
-            
-        except Exception as e:
-            self.logger.error(f"❌ 獲取真實衛星池數據失敗: {e}")
-            raise RuntimeError(f"數據獲取失敗: {str(e)}")
+                self.logger.warning(f"⚠️ 動畫數據格式錯誤: {latest_data['data_id']}")
+
+        # 換手事件：沒有專用數據時嘗試從其他數據類型提取
+        handover_data_list = self.storage_manager.list_stored_data('handover_events')
+        if not handover_data_list:
+            for data_type in ['timeseries_data', 'hierarchical_data', 'formatted_outputs']:
+                data_list = self.storage_manager.list_stored_data(data_type)
+                if data_list:
+                    handover_data_list = self._extract_handover_events_from_data(data_list, data_type)
+                    if handover_data_list:
+                        break
+
+        if handover_data_list:
+            all_events = []
+            for data_item in handover_data_list:
+                event_content = data_item if 'data' in data_item else self.storage_manager.retrieve_data(data_item['data_id'])
+                if event_content and 'data' in event_content:
+                    if isinstance(event_content['data'], list):
+                        all_events.extend(event_content['data'])
+                    elif isinstance(event_content['data'], dict) and 'events' in event_content['data']:
+                        all_events.extend(event_content['data']['events'])
+            sources.handover_events = all_events
+
+        return sources
+
+    async def _get_satellite_pools_data(self, limit: int, offset: int, constellation: Optional[str],
+                                        quality_grade: Optional[str] = None) -> Dict[str, Any]:
+        """獲取衛星池數據 - 結果快取查詢"""
+        generation = await self._result_generation_async()
+        return generation.view('satellite_pools', limit=limit, offset=offset,
+                               constellation=constellation, quality_grade=quality_grade)
 
     async def _get_satellite_pool_detail(self, pool_id: str) -> Optional[Dict[str, Any]]:
         """獲取衛星池詳情 - 真實實現"""
@@ -491,151 +526,20 @@ class APIService:
             self.logger.error(f"❌ 獲取衛星池詳情失敗: {pool_id}, {e}")
             raise RuntimeError(f"池詳情獲取失敗: {str(e)}")
 
-    async def _get_animation_data(self, time_range: Optional[str], satellite_ids: Optional[str]) -> Dict[str, Any]:
-        """獲取動畫數據 - 真實實現"""
-        if not self.storage_manager:
-            raise RuntimeError("StorageManager 未初始化，無法獲取真實動畫數據")
-        
-        try:
-            # 從存儲獲取真實動畫數據
-            animation_data_list = self.storage_manager.list_stored_data('animation_data')
-            
-            if not animation_data_list:
-                raise ValueError("未找到動畫數據，請確保 Stage 5 已生成動畫數據")
-            
-            # 獲取最新的動畫數據
-            latest_data = max(animation_data_list, key=lambda x: x.get('modified_time', ''))
-            animation_content = self.storage_manager.retrieve_data(latest_data['data_id'])
-            
-            if not animation_content or 'data' not in animation_content:
-                raise ValueError("動畫數據格式錯誤")
-            
-            frames_data = animation_content['data']
-            
-            # 應用時間範圍過濾
-            if time_range:
-                # 實現時間範圍過濾邏輯
-                filtered_frames = self._filter_frames_by_time_range(frames_data, time_range)
-            else:
-                filtered_frames = frames_data
-            
-            # 應用衛星ID過濾
-            if satellite_ids:
-                satellite_id_list = satellite_ids.split(',')
-                filtered_frames = self._filter_frames_by_satellite_ids(filtered_frames, satellite_id_list)
-            
-            return {
-                "animation_frames": filtered_frames,
-                "time_range": time_range,
-                "satellite_filter": satellite_ids,
-                "data_source": "real_storage",
-                "total_frames": len(filtered_frames) if isinstance(filtered_frames, list) else 0,
-                "retrieved_at": datetime.now(timezone.utc).isoformat()
-            }
-            
-        except Exception as e:
-            self.logger.error(f"❌ 獲取真實動畫數據失敗: {e}")
-            raise RuntimeError(f"動畫數據獲取失敗: {str(e)}")
-    
-    def _filter_frames_by_time_range(self, frames_data: Any, time_range: str) -> Any:
-        """根據時間範圍過濾動畫幀"""
-        # 實現時間範圍過濾邏輯
-        if isinstance(frames_data, list):
-            # 解析時間範圍 (假設格式為 "start_time,end_time")
-            try:
-                if ',' in time_range:
-                    start_time_str, end_time_str = time_range.split(',', 1)
-                    start_time = datetime.fromisoformat(start_time_str.replace('Z', '+00:00'))
-                    end_time = datetime.fromisoformat(end_time_str.replace('Z', '+00:00'))
-                    
-                    return [
-                        frame for frame in frames_data
-                        if 'timestamp' in frame and 
-                        start_time <= datetime.fromisoformat(frame['timestamp'].replace('Z', '+00:00')) <= end_time
-                    ]
-            except (ValueError, TypeError) as e:
-                self.logger.warning(f"時間範圍格式錯誤: {e}")
-        
-        return frames_data
-    
-    def _filter_frames_by_satellite_ids(self, frames_data: Any, satellite_ids: List[str]) -> Any:
-        """根據衛星ID過濾動畫幀"""
-        if isinstance(frames_data, list):
-            filtered_frames = []
-            for frame in frames_data:
-                if 'satellites' in frame and isinstance(frame['satellites'], list):
-                    filtered_satellites = [
-                        sat for sat in frame['satellites']
-                        if sat.get('id') in satellite_ids
-                    ]
-                    if filtered_satellites:
-                        filtered_frame = frame.copy()
-                        filtered_frame['satellites'] = filtered_satellites
-                        filtered_frames.append(filtered_frame)
-            return filtered_frames
-        
-        return frames_data
+    async def _get_animation_data(self, time_range: Optional[str], satellite_ids: Optional[str],
+                                  quality_grade: Optional[str] = None) -> Dict[str, Any]:
+        """獲取動畫數據 - 結果快取查詢"""
+        generation = await self._result_generation_async()
+        return generation.view('animation_data', time_range=time_range,
+                               satellite_ids=satellite_ids, quality_grade=quality_grade)
 
     async def _get_handover_events(self, limit: int, satellite_id: Optional[str],
                                    time_start: Optional[str], time_end: Optional[str]) -> Dict[str, Any]:
-        """獲取換手事件 - 真實實現"""
-        if not self.storage_manager:
-            raise RuntimeError("StorageManager 未初始化，無法獲取真實換手事件")
-        
-        try:
-            # 從存儲獲取真實換手事件數據
-            handover_data_list = self.storage_manager.list_stored_data('handover_events')
-            
-            if not handover_data_list:
-                # 檢查是否有其他相關數據類型
-                all_data_types = ['timeseries_data', 'hierarchical_data', 'formatted_outputs']
-                for data_type in all_data_types:
-                    data_list = self.storage_manager.list_stored_data(data_type)
-                    if data_list:
-                        # 嘗試從其他數據源提取換手事件
-                        events = self._extract_handover_events_from_data(data_list, data_type)
-                        if events:
-                            handover_data_list = events
-                            break
-                
-                if not handover_data_list:
-                    raise ValueError("未找到換手事件數據，請確保前置階段已生成相關數據")
-            
-            # 獲取所有換手事件數據
-            all_events = []
-            for data_item in handover_data_list:
-                event_content = self.storage_manager.retrieve_data(data_item['data_id'])
-                if event_content and 'data' in event_content:
-                    if isinstance(event_content['data'], list):
-                        all_events.extend(event_content['data'])
-                    elif isinstance(event_content['data'], dict) and 'events' in event_content['data']:
-                        all_events.extend(event_content['data']['events'])
-            
-            # 應用過濾器
-            filtered_events = self._filter_handover_events(
-                all_events, satellite_id, time_start, time_end
-            )
-            
-            # 應用限制
-            limited_events = filtered_events[:limit] if limit < len(filtered_events) else filtered_events
-            
-            return {
-                "events": limited_events,
-                "total": len(filtered_events),
-                "limit": limit,
-                "filters": {
-                    "satellite_id": satellite_id,
-                    "time_start": time_start,
-                    "time_end": time_end
-                },
-                "data_source": "real_storage", 
-                "retrieved_at": datetime.now(timezone.utc).isoformat()
-            }
-            
-        except Exception as e:
-            self.logger.error(f"❌ 獲取真實換手事件失敗: {e}")
-            raise RuntimeError(f"換手事件獲取失敗: {str(e)}")
-    
+        """獲取換手事件 - 結果快取查詢"""
+        generation = await self._result_generation_async()
+        return generation.view('handover_events', limit=limit, satellite_id=satellite_id,
+                               time_start=time_start, time_end=time_end)
+
     def _extract_handover_events_from_data(self, data_list: List[Dict], data_type: str) -> List[Dict]:
         """從其他數據類型中提取換手事件"""
         events = []
@@ -670,58 +574,6 @@ class APIService:
         
         return [{'data_id': f'extracted_{i}', 'data': events}] if events else []
     
-    def _filter_handover_events(self, events: List[Dict], satellite_id: Optional[str],
-                               time_start: Optional[str], time_end: Optional[str]) -> List[Dict]:
-        """過濾換手事件"""
-        filtered = events
-        
-        # 按衛星ID過濾
-        if satellite_id:
-            filtered = [
-                event for event in filtered
-                if (event.get('from_satellite') == satellite_id or 
-                    event.get('to_satellite') == satellite_id or
-                    event.get('satellite_id') == satellite_id)
-            ]
-        
-        # 按時間範圍過濾
-        if time_start or time_end:
-            time_filtered = []
-            for event in filtered:
-                event_time_str = event.get('timestamp')
-                if not event_time_str:
-                    continue
-                
-                try:
-                    event_time = datetime.fromisoformat(event_time_str.replace('Z', '+00:00'))
-                    
-                    # 檢查時間範圍
-                    if time_start:
-                        start_time = datetime.fromisoformat(time_start.replace('Z', '+00:00'))
-                        if event_time < start_time:
-                            continue
-                    
-                    if time_end:
-                        end_time = datetime.fromisoformat(time_end.replace('Z', '+00:00'))
-                        if event_time > end_time:
-                            continue
-                    
-                    time_filtered.append(event)
-                    
-                except (ValueError, TypeError) as e:
-                    self.logger.warning(f"換手事件時間格式錯誤: {e}")
-                    continue
-            
-            filtered = time_filtered
-        
-        # 按時間排序（最新的在前）
-        try:
-            filtered.sort(key=lambda x: x.get('timestamp', ''), reverse=True)
-        except Exception as e:
-            self.logger.warning(f"換手事件排序失敗: {e}")
-        
-        return filtered
-
     async def _process_custom_query(self, query_data: Dict[str, Any]) -> Dict[str, Any]:
         """處理自定義查詢 - 真實實現"""
         if not self.storage_manager:
@@ -999,6 +851,7 @@ class APIService:
                 "requests_per_minute": self.rate_limiter.requests_per_minute,
                 "active_clients": len(self.rate_limiter.client_requests)
             },
+            "result_cache": self.result_cache.get_stats(),
             "configuration": self.api_config
         }
 
@@ -1025,7 +878,8 @@ class APIService:
                 self._get_satellite_pools_data(
                     query_params.get('limit', 50),
                     query_params.get('offset', 0),
-                    query_params.get('constellation')
+                    query_params.get('constellation'),
+                    query_params.get('quality_grade')
                 )
             )
         finally:
@@ -1039,7 +893,8 @@ class APIService:
             return loop.run_until_complete(
                 self._get_animation_data(
                     query_params.get('time_range'),
-                    query_params.get('satellite_ids')
+                    query_params.get('satellite_ids'),
+                    query_params.get('quality_grade')
                 )
             )
         finally:
@@ -16,6 +16,22 @@ from typing import Dict, List, Any, Optional, Tuple
 from dataclasses import dataclass
 import numpy as np
 
+try:
+    from shared.core_modules.phase_space_index import PhaseSpaceIndex
+    PHASE_SPACE_INDEX_AVAILABLE = True
+except ImportError:
+    PHASE_SPACE_INDEX_AVAILABLE = False
+
+try:
+    from shared.core_modules.parallel_tempering_annealer import AnnealingGroup, ParallelTemperingAnnealer
+    PARALLEL_TEMPERING_AVAILABLE = True
+except ImportError:
+    PARALLEL_TEMPERING_AVAILABLE = False
+
+# 平行回火策略的預設同時可見數目標與可見仰角門檻
+DEFAULT_VISIBLE_RANGES = {'starlink': (10, 15), 'oneweb': (3, 6)}
+DEFAULT_ELEVATION_THRESHOLDS = {'starlink': 5.0, 'oneweb': 10.0}
+
 @dataclass
 class SatelliteCandidate:
     """衛星候選者數據結構"""
@@ -27,6 +43,9 @@ class SatelliteCandidate:
     coverage_score: float
     handover_potential: float
     rl_score: float = 0.0
+    raan: Optional[float] = None                  # 升交點赤經 (度)
+    argument_of_latitude: Optional[float] = None  # 緯度幅角 u = ω + M (度)
+    visibility_timeline: Optional[np.ndarray] = None  # 各時間點是否高於可見仰角門檻
 
 class PoolGenerationEngine:
     """
@@ -90,6 +109,8 @@ class PoolGenerationEngine:
                 return self._generate_balanced_pool(candidates, target_count)
             elif strategy == "high_quality":
                 return self._generate_high_quality_pool(candidates, target_count)
+            elif strategy == "parallel_tempering":
+                return self._generate_parallel_tempering_pool(candidates, target_count)
             else:
                 return self._generate_fallback_pool(candidates, target_count)
 
@@ -130,13 +151,17 @@ class PoolGenerationEngine:
                 candidates, target_count
             )
 
-            return {
+            pool = {
                 "strategy": "gap_filling",
                 "satellites": gap_filling_satellites,
                 "total_count": len(gap_filling_satellites),
                 "avg_coverage_score": np.mean([s.coverage_score for s in gap_filling_satellites]),
                 "configuration_score": self._calculate_pool_score(gap_filling_satellites)
             }
+            phase_index = self._build_phase_index(gap_filling_satellites)
+            if phase_index is not None:
+                pool["phase_coverage"] = phase_index.diversity_scores()
+            return pool
 
         except Exception as e:
             self.logger.error(f"❌ 填補空隙池生成失敗: {e}")
@@ -181,6 +206,53 @@ class PoolGenerationEngine:
             self.logger.error(f"❌ 高品質池生成失敗: {e}")
             return {}
 
+    def _generate_parallel_tempering_pool(self, candidates: List[SatelliteCandidate],
+                                          target_count: int) -> Dict[str, Any]:
+        """以多鏈平行回火在可見性時間軸上最佳化衛星池 (缺少時間軸時退回平衡策略)"""
+        try:
+            timed = [c for c in candidates if c.visibility_timeline is not None and len(c.visibility_timeline)]
+            if not PARALLEL_TEMPERING_AVAILABLE or not timed:
+                self.logger.warning("⚠️ 平行回火不可用或候選者缺少可見性時間軸，改用平衡策略")
+                return self._generate_balanced_pool(candidates, target_count)
+
+            # 依星座分組，池大小按候選比例分配 (與平衡策略一致)
+            names = sorted({c.constellation.lower() for c in timed})
+            group_index = {name: g for g, name in enumerate(names)}
+            visible_ranges = self.config.get('visible_ranges', DEFAULT_VISIBLE_RANGES)
+            target_count = min(target_count, len(timed))
+            members = [sum(1 for c in timed if c.constellation.lower() == name) for name in names]
+            sizes = [int(target_count * m / len(timed)) for m in members]
+            sizes[int(np.argmax(members))] += target_count - sum(sizes)
+            groups = [AnnealingGroup(name, min(size, m), tuple(visible_ranges.get(name, (1, size or 1))))
+                      for name, size, m in zip(names, sizes, members)]
+
+            n_times = max(len(c.visibility_timeline) for c in timed)
+            visibility = np.zeros((len(timed), n_times), dtype=bool)
+            for i, c in enumerate(timed):
+                visibility[i, :len(c.visibility_timeline)] = c.visibility_timeline
+
+            result = ParallelTemperingAnnealer(self.config.get('parallel_tempering', {})).optimize(
+                visibility,
+                [group_index[c.constellation.lower()] for c in timed],
+                groups,
+                [1.0 - c.coverage_score for c in timed]
+            )
+            selected = [timed[i] for i in result.selected_indices]
+
+            return {
+                "strategy": "parallel_tempering",
+                "satellites": selected,
+                "total_count": len(selected),
+                "annealing_cost": result.cost,
+                "visibility_compliance": result.group_compliance,
+                "annealing_statistics": result.statistics,
+                "configuration_score": self._calculate_pool_score(selected)
+            }
+
+        except Exception as e:
+            self.logger.error(f"❌ 平行回火池生成失敗: {e}")
+            return {}
+
     def _generate_fallback_pool(self, candidates: List[SatelliteCandidate],
                               target_count: int) -> Dict[str, Any]:
         """生成回退衛星池（綜合評分最高的候選者）"""
@@ -214,6 +286,10 @@ class PoolGenerationEngine:
     def _select_gap_filling_satellites(self, candidates: List[SatelliteCandidate],
                                      target_count: int) -> List[SatelliteCandidate]:
         """選擇填補覆蓋空隙的衛星"""
+        # 候選者皆帶有軌道相位時，以相位空間索引填補 (RAAN, 緯度幅角) 空洞
+        if self._has_phase_info(candidates):
+            return self._select_phase_hole_fillers(candidates, target_count)
+
         # 基於覆蓋分數和位置分散性選擇
         selected = []
         remaining = candidates.copy()
@@ -229,6 +305,58 @@ class PoolGenerationEngine:
 
         return selected
 
+    def _has_phase_info(self, satellites: List[SatelliteCandidate]) -> bool:
+        return (PHASE_SPACE_INDEX_AVAILABLE and bool(satellites) and
+                all(s.raan is not None and s.argument_of_latitude is not None for s in satellites))
+
+    def _build_phase_index(self, satellites: List[SatelliteCandidate]) -> Optional["PhaseSpaceIndex"]:
+        """以候選者的軌道相位建立環面網格索引 (缺少相位資訊時返回 None)"""
+        if not self._has_phase_info(satellites):
+            return None
+        index = PhaseSpaceIndex(
+            raan_bins=self.config.get('phase_raan_bins', 36),
+            phase_bins=self.config.get('phase_bins', 36)
+        )
+        index.add_satellites(
+            [s.satellite_id for s in satellites],
+            [s.raan for s in satellites],
+            [s.argument_of_latitude for s in satellites]
+        )
+        return index
+
+    def _select_phase_hole_fillers(self, candidates: List[SatelliteCandidate],
+                                   target_count: int) -> List[SatelliteCandidate]:
+        """
+        相位空洞填補選擇
+
+        以覆蓋分數最高者為起點，之後每輪在已選索引中找出最大相位空洞，
+        從候選索引挑選最接近空洞中心的衛星；網格全滿後改按覆蓋分數補足。
+        每輪查詢只掃描網格，不做候選者兩兩比較。
+        """
+        by_id = {c.satellite_id: c for c in candidates}
+        remaining = self._build_phase_index(candidates)
+        selected_index = PhaseSpaceIndex(remaining.raan_bins, remaining.phase_bins)
+        selected: List[SatelliteCandidate] = []
+
+        def take(candidate: SatelliteCandidate):
+            selected.append(candidate)
+            remaining.remove_satellites([candidate.satellite_id])
+            selected_index.add_satellites(
+                [candidate.satellite_id], [candidate.raan], [candidate.argument_of_latitude]
+            )
+
+        take(max(candidates, key=lambda x: x.coverage_score))
+        while len(selected) < target_count and len(remaining):
+            holes = selected_index.largest_holes(top_k=1)
+            if holes:
+                fill_id = selected_index.best_fill(remaining, holes[0]['raan_deg'], holes[0]['phase_deg'])
+                take(by_id[fill_id])
+            else:
+                rest = [by_id[sat_id] for sat_id in remaining.satellite_ids]
+                take(max(rest, key=lambda x: x.coverage_score))
+
+        return selected
+
     def _select_balanced_satellites(self, candidates: List[SatelliteCandidate],
                                   target_count: int) -> List[SatelliteCandidate]:
         """選擇平衡的衛星組合"""
@@ -371,9 +499,18 @@ class PoolGenerationEngine:
             elevation = orbital_data.get('elevation', 0.0)
             distance = orbital_data.get('distance', 0.0)
 
+            # 軌道相位 (供相位空間索引使用，缺少時為 None)
+            raan = orbital_data.get('raan')
+            argument_of_latitude = orbital_data.get('argument_of_latitude')
+            if argument_of_latitude is None and 'mean_anomaly' in orbital_data:
+                argument_of_latitude = (
+                    orbital_data.get('argument_of_perigee', 0.0) + orbital_data['mean_anomaly']
+                ) % 360.0
+
             # 計算覆蓋分數和換手潛力
             coverage_score = self._calculate_coverage_score(sat_data)
             handover_potential = self._calculate_handover_potential(sat_data)
+            visibility_timeline = self._extract_visibility_timeline(constellation, sat_data)
 
             return SatelliteCandidate(
                 satellite_id=sat_id,
@@ -382,13 +519,29 @@ class PoolGenerationEngine:
                 elevation=elevation,
                 distance=distance,
                 coverage_score=coverage_score,
-                handover_potential=handover_potential
+                handover_potential=handover_potential,
+                raan=raan,
+                argument_of_latitude=argument_of_latitude,
+                visibility_timeline=visibility_timeline
             )
 
         except Exception as e:
             self.logger.warning(f"⚠️ 候選者創建失敗 {sat_id}: {e}")
             return None
 
+    def _extract_visibility_timeline(self, constellation: str,
+                                     sat_data: Dict[str, Any]) -> Optional[np.ndarray]:
+        """由位置時間序列的仰角產生可見性時間軸 (無時間序列時返回 None)"""
+        timeseries = sat_data.get('position_timeseries') or []
+        if not timeseries:
+            return None
+        thresholds = self.config.get('elevation_thresholds', DEFAULT_ELEVATION_THRESHOLDS)
+        threshold = thresholds.get(constellation.lower(), 10.0)
+        elevations = np.array([
+            point.get('elevation_deg', point.get('elevation_angle', -90.0)) for point in timeseries
+        ], dtype=np.float64)
+        return elevations >= threshold
+
     def _calculate_coverage_score(self, sat_data: Dict[str, Any]) -> float:
         """計算覆蓋分數"""
         try:
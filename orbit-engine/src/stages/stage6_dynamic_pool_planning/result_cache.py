@@ -0,0 +1,403 @@
+"""
+Result Cache for Stage 6 Persistence API
+世代化 API 結果快取
+
+Stage 6 每次完成持久化即建立一個新世代：
+- 從存儲一次讀入衛星池清單、最新動畫幀與換手事件，建立查詢索引
+  (星座 / 品質等級分組、幀時間索引、衛星 → 換手事件)
+- 預先計算常用查詢變體 (星座 × 品質等級、整段與固定長度時間窗口)，
+  以 JSON 編碼存入該世代的編碼快取
+- 其餘查詢變體只在記憶體索引上計算，結果在世代內記憶 (LRU)
+- 失效 = 發布新世代 (替換一個引用)，不掃描快取鍵；ETag 含世代權杖，
+  舊世代的響應不會被誤認為仍有效
+"""
+
+import bisect
+import logging
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from datetime import datetime, timedelta, timezone
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple
+
+try:
+    from shared.utils.response_encoding import (
+        EncodedResponseCache, ResponseEncoder, JSON_MEDIA_TYPE, encode_payload, make_etag
+    )
+    RESPONSE_ENCODING_AVAILABLE = True
+except ImportError:
+    RESPONSE_ENCODING_AVAILABLE = False
+
+VIEWS = ('satellite_pools', 'animation_data', 'handover_events')
+GRADE_FIELDS = ('quality_grade', 'signal_quality_grade')
+
+
+def parse_time(value: Any) -> Optional[datetime]:
+    """ISO 時間字串 → 有時區的 datetime (無時區者視為 UTC)；無法解析時為 None"""
+    if not isinstance(value, str) or not value:
+        return None
+    try:
+        parsed = datetime.fromisoformat(value.replace('Z', '+00:00'))
+    except ValueError:
+        return None
+    return parsed if parsed.tzinfo else parsed.replace(tzinfo=timezone.utc)
+
+
+def normalize_time_range(time_range: Optional[str]) -> Optional[str]:
+    """'start,end' 正規化為 ISO 格式；格式錯誤視為不過濾"""
+    if not time_range or ',' not in time_range:
+        return None
+    start_str, end_str = time_range.split(',', 1)
+    start, end = parse_time(start_str.strip()), parse_time(end_str.strip())
+    if start is None or end is None:
+        return None
+    return f"{start.isoformat()},{end.isoformat()}"
+
+
+def grade_of(item: Dict[str, Any]) -> Optional[str]:
+    """衛星 / 衛星池的品質等級 (自身欄位或 metadata)"""
+    for source in (item, item.get('metadata') or {}):
+        if isinstance(source, dict):
+            for name in GRADE_FIELDS:
+                if source.get(name):
+                    return str(source[name])
+    return None
+
+
+@dataclass
+class Stage6Sources:
+    """一次從存儲讀入的 API 數據來源"""
+    pools: List[Dict[str, Any]] = field(default_factory=list)      # 衛星池存儲清單 (最新在前)
+    animation_frames: Any = None                                   # 最新動畫數據；None 表示沒有
+    handover_events: Optional[List[Dict[str, Any]]] = None         # None 表示沒有換手事件數據
+
+
+class ResultGeneration:
+    """
+    單一世代的查詢索引、記憶的查詢結果與編碼快取
+
+    世代建立後來源數據不再變動，所以同一組參數的結果 (及其編碼) 在世代內不變。
+    """
+
+    def __init__(self, number: int, sources: Stage6Sources, max_views: int = 512,
+                 encoded_cache_entries: int = 1024, encoded_cache_mb: float = 256):
+        self.number = number
+        self.built_at = datetime.now(timezone.utc)
+        self.token = f"{number}:{self.built_at.isoformat()}"
+        self.sources = sources
+        self.max_views = max_views
+        self._views: "OrderedDict[Tuple, Dict[str, Any]]" = OrderedDict()
+        self.stats = {'view_hits': 0, 'view_misses': 0, 'precomputed': 0, 'precomputed_bytes': 0}
+
+        if RESPONSE_ENCODING_AVAILABLE:
+            self.encoded = EncodedResponseCache(encoded_cache_entries, int(encoded_cache_mb * 1024 * 1024))
+            self.encoder = ResponseEncoder(self.encoded)
+        else:
+            self.encoded = None
+            self.encoder = None
+
+        self._build_indexes()
+
+    # === 索引 ===
+
+    def _build_indexes(self) -> None:
+        pools = self.sources.pools
+        self.constellations = sorted({
+            item.get('metadata', {}).get('constellation') for item in pools
+            if item.get('metadata', {}).get('constellation')
+        })
+        self.pool_grades = sorted({grade for grade in (grade_of(item) for item in pools) if grade})
+
+        # 動畫幀時間索引 (只含有時間戳的幀，保留原順序)
+        frames = self.sources.animation_frames
+        self._timed_frames: List[Dict[str, Any]] = []
+        self._frame_times: List[datetime] = []
+        self.satellite_grades: List[str] = []
+        if isinstance(frames, list):
+            grades = set()
+            for frame in frames:
+                if not isinstance(frame, dict):
+                    continue
+                for sat in frame.get('satellites') or []:
+                    if isinstance(sat, dict):
+                        grade = grade_of(sat)
+                        if grade:
+                            grades.add(grade)
+                frame_time = parse_time(frame.get('timestamp'))
+                if frame_time is not None:
+                    self._timed_frames.append(frame)
+                    self._frame_times.append(frame_time)
+            self.satellite_grades = sorted(grades)
+        self._frames_sorted = all(a <= b for a, b in zip(self._frame_times, self._frame_times[1:]))
+
+        # 換手事件：依時間新→舊排序一次，並建立衛星 → 事件索引 (保持排序)
+        events = list(self.sources.handover_events or [])
+        try:
+            events.sort(key=lambda x: x.get('timestamp', ''), reverse=True)
+        except Exception as e:
+            logging.getLogger(__name__).warning(f"換手事件排序失敗: {e}")
+        self._events = events
+        self._event_times = {id(event): parse_time(event.get('timestamp')) for event in events}
+        self._events_by_satellite: Dict[str, List[Dict[str, Any]]] = {}
+        for event in events:
+            for sat_id in {event.get('from_satellite'), event.get('to_satellite'), event.get('satellite_id')}:
+                if sat_id:
+                    self._events_by_satellite.setdefault(sat_id, []).append(event)
+
+    # === 查詢參數 ===
+
+    @staticmethod
+    def normalize(view: str, **params) -> Tuple:
+        """查詢參數 → 正規化鍵 (同時用於結果記憶與 ETag)"""
+        if view == 'satellite_pools':
+            return (params.get('limit', 50), params.get('offset', 0),
+                    params.get('constellation'), params.get('quality_grade'))
+        if view == 'animation_data':
+            return (normalize_time_range(params.get('time_range')),
+                    params.get('satellite_ids'), params.get('quality_grade'))
+        if view == 'handover_events':
+            time_start = parse_time(params.get('time_start'))
+            time_end = parse_time(params.get('time_end'))
+            return (params.get('limit', 100), params.get('satellite_id'),
+                    time_start.isoformat() if time_start else None,
+                    time_end.isoformat() if time_end else None)
+        raise ValueError(f"未知的查詢視圖: {view}")
+
+    def etag_parts(self, view: str, key: Tuple) -> Tuple:
+        return (self.token, view) + key
+
+    # === 查詢 ===
+
+    def view(self, view: str, **params) -> Dict[str, Any]:
+        """查詢結果 (世代內記憶)"""
+        key = self.normalize(view, **params)
+        cache_key = (view,) + key
+        cached = self._views.get(cache_key)
+        if cached is not None:
+            self._views.move_to_end(cache_key)
+            self.stats['view_hits'] += 1
+            return cached
+
+        self.stats['view_misses'] += 1
+        result = getattr(self, f"_{view}")(*key)
+        self._views[cache_key] = result
+        while len(self._views) > self.max_views:
+            self._views.popitem(last=False)
+        return result
+
+    def _satellite_pools(self, limit: int, offset: int, constellation: Optional[str],
+                         quality_grade: Optional[str]) -> Dict[str, Any]:
+        pools = self.sources.pools
+        if constellation:
+            pools = [item for item in pools if item.get('metadata', {}).get('constellation') == constellation]
+        if quality_grade:
+            pools = [item for item in pools if grade_of(item) == quality_grade]
+
+        return {
+            "pools": pools[offset:offset + limit],
+            "total": len(pools),
+            "limit": limit,
+            "offset": offset,
+            "constellation_filter": constellation,
+            "quality_grade_filter": quality_grade,
+            "data_source": "real_storage",
+            "generation": self.number,
+            "query_timestamp": self.built_at.isoformat()
+        }
+
+    def _animation_data(self, time_range: Optional[str], satellite_ids: Optional[str],
+                        quality_grade: Optional[str]) -> Dict[str, Any]:
+        frames = self.sources.animation_frames
+        if frames is None:
+            raise ValueError("未找到動畫數據，請確保 Stage 5 已生成動畫數據")
+
+        if isinstance(frames, list):
+            if time_range:
+                start_str, end_str = time_range.split(',', 1)
+                frames = self._frames_between(parse_time(start_str), parse_time(end_str))
+
+            wanted = set(satellite_ids.split(',')) if satellite_ids else None
+            if wanted is not None or quality_grade:
+                frames = self._filter_frame_satellites(frames, wanted, quality_grade)
+
+        return {
+            "animation_frames": frames,
+            "time_range": time_range,
+            "satellite_filter": satellite_ids,
+            "quality_grade_filter": quality_grade,
+            "data_source": "real_storage",
+            "total_frames": len(frames) if isinstance(frames, list) else 0,
+            "generation": self.number,
+            "retrieved_at": self.built_at.isoformat()
+        }
+
+    def _frames_between(self, start: datetime, end: datetime) -> List[Dict[str, Any]]:
+        if self._frames_sorted:
+            lo = bisect.bisect_left(self._frame_times, start)
+            hi = bisect.bisect_right(self._frame_times, end)
+            return self._timed_frames[lo:hi]
+        return [frame for frame, t in zip(self._timed_frames, self._frame_times) if start <= t <= end]
+
+    @staticmethod
+    def _filter_frame_satellites(frames: List[Any], satellite_ids: Optional[set],
+                                 quality_grade: Optional[str]) -> List[Dict[str, Any]]:
+        """只保留指定衛星 / 品質等級的衛星，沒有剩餘衛星的幀移除"""
+        filtered_frames = []
+        for frame in frames:
+            if isinstance(frame, dict) and isinstance(frame.get('satellites'), list):
+                satellites = [
+                    sat for sat in frame['satellites']
+                    if (satellite_ids is None or sat.get('id') in satellite_ids)
+                    and (not quality_grade or grade_of(sat) == quality_grade)
+                ]
+                if satellites:
+                    filtered_frames.append({**frame, 'satellites': satellites})
+        return filtered_frames
+
+    def _handover_events(self, limit: int, satellite_id: Optional[str],
+                         time_start: Optional[str], time_end: Optional[str]) -> Dict[str, Any]:
+        if self.sources.handover_events is None:
+            raise ValueError("未找到換手事件數據，請確保前置階段已生成相關數據")
+
+        events = self._events_by_satellite.get(satellite_id, []) if satellite_id else self._events
+        if time_start or time_end:
+            start, end = parse_time(time_start), parse_time(time_end)
+            events = [
+                event for event in events
+                if self._event_times[id(event)] is not None
+                and (start is None or self._event_times[id(event)] >= start)
+                and (end is None or self._event_times[id(event)] <= end)
+            ]
+
+        return {
+            "events": events[:limit],
+            "total": len(events),
+            "limit": limit,
+            "filters": {
+                "satellite_id": satellite_id,
+                "time_start": time_start,
+                "time_end": time_end
+            },
+            "data_source": "real_storage",
+            "generation": self.number,
+            "retrieved_at": self.built_at.isoformat()
+        }
+
+    # === 預先計算 ===
+
+    def time_windows(self, window_minutes: float, max_windows: int) -> List[Tuple[datetime, datetime]]:
+        """自第一幀起、固定長度的連續時間窗口 (含端點)"""
+        if not self._frame_times or window_minutes <= 0:
+            return []
+        first, last = min(self._frame_times), max(self._frame_times)
+        step = timedelta(minutes=window_minutes)
+        windows = []
+        start = first
+        while start <= last and len(windows) < max_windows:
+            windows.append((start, start + step - timedelta(microseconds=1)))
+            start += step
+        return windows
+
+    def common_variants(self, config: Optional[Dict[str, Any]] = None) -> Iterator[Tuple[str, Dict[str, Any]]]:
+        """Stage 6 完成時預先計算的查詢變體"""
+        config = config or {}
+        windows = self.time_windows(config.get('time_window_minutes', 60), config.get('max_time_windows', 48))
+
+        for constellation in [None] + self.constellations:
+            for grade in [None] + self.pool_grades:
+                yield 'satellite_pools', {'limit': config.get('default_page_size', 50), 'offset': 0,
+                                          'constellation': constellation, 'quality_grade': grade}
+
+        if self.sources.animation_frames is not None:
+            for time_range in [None] + [f"{start.isoformat()},{end.isoformat()}" for start, end in windows]:
+                for grade in [None] + self.satellite_grades:
+                    yield 'animation_data', {'time_range': time_range, 'quality_grade': grade}
+
+        if self.sources.handover_events is not None:
+            for start, end in [(None, None)] + windows:
+                yield 'handover_events', {'limit': config.get('default_event_limit', 100),
+                                          'time_start': start.isoformat() if start else None,
+                                          'time_end': end.isoformat() if end else None}
+
+    def precompute(self, envelope: Callable[[str, Dict[str, Any]], Dict[str, Any]],
+                   config: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """
+        計算常用查詢變體並以 JSON 編碼存入本世代的編碼快取
+
+        Args:
+            envelope: (視圖, 查詢結果) → API 響應 (與路由使用的相同)
+        """
+        for view, params in self.common_variants(config):
+            data = self.view(view, **params)
+            if self.encoded is None:
+                continue
+            body = encode_payload(envelope(view, data), 'json')
+            key = self.normalize(view, **params)
+            self.encoded.put(make_etag('json', *self.etag_parts(view, key)), body, JSON_MEDIA_TYPE)
+            self.stats['precomputed'] += 1
+            self.stats['precomputed_bytes'] += len(body)
+        return self.get_stats()
+
+    def get_stats(self) -> Dict[str, Any]:
+        return {
+            **self.stats,
+            'generation': self.number,
+            'built_at': self.built_at.isoformat(),
+            'memoized_views': len(self._views),
+            'constellations': self.constellations,
+            'quality_grades': sorted(set(self.pool_grades) | set(self.satellite_grades)),
+            'encoded_cache': self.encoded.get_stats() if self.encoded is not None else {}
+        }
+
+
+class Stage6ResultCache:
+    """
+    Stage 6 API 結果快取
+
+    持有目前世代；publish() 以新世代替換、invalidate() 丟棄目前世代，
+    兩者皆為 O(1)，不需要逐鍵失效。
+    """
+
+    def __init__(self, config: Optional[Dict] = None):
+        self.config = config or {}
+        self.logger = logging.getLogger(f"{__name__}.{self.__class__.__name__}")
+        self._current: Optional[ResultGeneration] = None
+        self._last_number = 0
+        self.stats = {'generations_published': 0, 'invalidations': 0}
+
+    @property
+    def current(self) -> Optional[ResultGeneration]:
+        return self._current
+
+    @property
+    def generation(self) -> int:
+        return self._current.number if self._current else 0
+
+    def build(self, sources: Stage6Sources,
+              envelope: Callable[[str, Dict[str, Any]], Dict[str, Any]]) -> ResultGeneration:
+        """建立並預先計算新世代 (尚未發布，讀取仍使用目前世代)"""
+        self._last_number += 1
+        generation = ResultGeneration(
+            self._last_number, sources,
+            max_views=self.config.get('max_views', 512),
+            encoded_cache_entries=self.config.get('encoded_cache_entries', 1024),
+            encoded_cache_mb=self.config.get('encoded_cache_mb', 256)
+        )
+        generation.precompute(envelope, self.config)
+        return generation
+
+    def publish(self, generation: ResultGeneration) -> None:
+        self._current = generation
+        self.stats['generations_published'] += 1
+        self.logger.info(f"✅ 結果快取世代 {generation.number} 已發布: "
+                         f"預先計算 {generation.stats['precomputed']} 個查詢變體")
+
+    def invalidate(self) -> None:
+        self._current = None
+        self.stats['invalidations'] += 1
+
+    def get_stats(self) -> Dict[str, Any]:
+        return {
+            **self.stats,
+            'generation': self.generation,
+            'current': self._current.get_stats() if self._current else None
+        }
@@ -230,6 +230,9 @@ class Stage6PersistenceProcessor(BaseStageProcessor):
                 persistence_results['formatted_outputs_id'] = data_id
                 self.processing_stats['data_persistence_operations'] += 1
             
+            # 分層遷移：一次性執行時在此同步跑一輪 (背景遷移需明確開啟)
+            persistence_results['tiering'] = self.storage_manager.run_tier_migration()
+
             # 創建持久化摘要
             persistence_results['persistence_summary'] = {
                 'total_data_stored': self.processing_stats['data_persistence_operations'],
@@ -259,6 +262,15 @@ class Stage6PersistenceProcessor(BaseStageProcessor):
             preload_stats = self.cache_manager.preload_frequent_data()
             cache_setup_results['preload_operations'] = preload_stats.get('total_preloaded', 0)
             self.processing_stats['cache_operations'] += cache_setup_results['preload_operations']
+
+            # 以本次持久化的數據發布新的 API 結果快取世代 (舊世代整體失效)
+            result_cache_stats = self.api_service.refresh_result_cache()
+            cache_setup_results['result_cache'] = {
+                'generation': result_cache_stats['generation'],
+                'precomputed_variants': result_cache_stats['precomputed'],
+                'precomputed_bytes': result_cache_stats['precomputed_bytes']
+            }
+            self.processing_stats['cache_operations'] += result_cache_stats['precomputed']
             
             # 設置快取策略
             cache_setup_results['cache_policies'] = {
@@ -377,7 +389,8 @@ class Stage6PersistenceProcessor(BaseStageProcessor):
             'cache_setup': {
                 'multilayer_cache_enabled': True,
                 'preload_operations': cache_results.get('preload_operations', 0),
-                'cache_policies': cache_results.get('cache_policies', {})
+                'cache_policies': cache_results.get('cache_policies', {}),
+                'result_cache': cache_results.get('result_cache', {})
             },
             'metadata': {
                 'processing_time': datetime.now(timezone.utc).isoformat(),
@@ -591,6 +604,12 @@ class Stage6PersistenceProcessor(BaseStageProcessor):
             self.logger.error(f"❌ 保存結果失敗: {e}")
             return ""
 
+    def shutdown(self) -> None:
+        """停止存儲背景工作 (分層遷移) 並保存分層狀態"""
+        if self.storage_manager:
+            self.storage_manager.close()
+        self.service_status['storage_service'] = 'stopped'
+
     def get_service_statistics(self) -> Dict[str, Any]:
         """獲取服務統計信息"""
         return {
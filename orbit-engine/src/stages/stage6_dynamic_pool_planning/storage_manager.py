@@ -12,12 +12,27 @@ import os
 import logging
 import shutil
 import gzip
+import threading
+import time
+import weakref
 from datetime import datetime, timezone
 from pathlib import Path
 from typing import Dict, Any, Optional, List, Union
 from dataclasses import dataclass, asdict
 import hashlib
 
+try:
+    from shared.utils.storage_tiering import (
+        AccessTracker, HotTierStore, StorageTierPlanner, TierCostModel, TierPlacement, TierSegment,
+        COLD_SUFFIXES, is_cold_file, placement_summary, read_columnar, write_columnar
+    )
+    TIERING_AVAILABLE = True
+except ImportError:
+    TIERING_AVAILABLE = False
+
+# 主存儲數據檔案的副檔名 (溫層 JSON 與冷層欄式檔案)
+_DATA_SUFFIXES = ('.columns.json.gz', '.parquet', '.json.gz', '.json')
+
 
 @dataclass
 class StorageMetadata:
@@ -72,6 +87,9 @@ class StorageManager:
             'last_cleanup': None
         }
 
+        # 分層存儲 (熱: 記憶體, 溫: JSON 檔案, 冷: 壓縮欄式檔案)
+        self._init_tiering()
+
         self.logger.info("✅ Storage Manager 初始化完成")
 
     def _ensure_storage_directories(self) -> None:
@@ -166,40 +184,33 @@ class StorageManager:
             備份是否成功
         """
         try:
-            # 查找原始數據
-            data_info = self._find_data_by_id(data_id)
-            if not data_info:
-                self.logger.error(f"❌ 找不到數據: {data_id}")
-                return False
-
-            # 讀取原始數據
-            original_data = self.retrieve_data(data_id)
-            if not original_data:
-                return False
-
-            # 創建備份
-            backup_timestamp = datetime.now(timezone.utc).strftime('%Y%m%d_%H%M%S')
-            backup_id = f"{data_id}_backup_{backup_timestamp}"
-
-            backup_path = self.backup_storage_path / data_info['data_type'] / f"{backup_id}.json"
-
-            # 備份數據包含原始數據 + 備份信息
-            backup_data = {
+            # 備份直接複製已壓縮的數據檔案，不重新解析與序列化 (持鎖避免與分層遷移交錯)
+            with self._tier_lock:
+                data_info = self._find_data_by_id(data_id)
+                if not data_info:
+                    self.logger.error(f"❌ 找不到數據: {data_id}")
+                    return False
+
+                source_path = data_info['file_path']
+                backup_timestamp = datetime.now(timezone.utc).strftime('%Y%m%d_%H%M%S')
+                backup_id = f"{data_id}_backup_{backup_timestamp}"
+                backup_dir = self.backup_storage_path / data_info['data_type']
+                backup_dir.mkdir(parents=True, exist_ok=True)
+
+                backup_path = backup_dir / (backup_id + source_path.name[len(data_id):])
+                shutil.copy2(source_path, backup_path)
+
+            # 備份信息另存為清單檔
+            backup_manifest = {
                 'original_data_id': data_id,
                 'backup_id': backup_id,
                 'backup_timestamp': datetime.now(timezone.utc).isoformat(),
                 'backup_policy': backup_policy or self.storage_config['backup_frequency'],
-                'original_data': original_data
+                'backup_file': backup_path.name,
+                'size_bytes': backup_path.stat().st_size
             }
-
-            # 壓縮備份
-            if self.storage_config['compression_enabled']:
-                backup_path = backup_path.with_suffix('.json.gz')
-                with gzip.open(backup_path, 'wt', encoding='utf-8') as f:
-                    json.dump(backup_data, f, indent=2, ensure_ascii=False, default=str)
-            else:
-                with open(backup_path, 'w', encoding='utf-8') as f:
-                    json.dump(backup_data, f, indent=2, ensure_ascii=False, default=str)
+            with open(backup_dir / f"{backup_id}_manifest.json", 'w', encoding='utf-8') as f:
+                json.dump(backup_manifest, f, indent=2, ensure_ascii=False)
 
             # 更新統計
             self.storage_stats['backups_created'] += 1
@@ -220,24 +231,23 @@ class StorageManager:
             version: 版本號（可選）
 
         Returns:
-            檢索到的數據
+            檢索到的數據 (每次呼叫皆為獨立物件；熱層保存編碼後位元組，修改結果不影響熱層副本)
         """
         try:
+            if self.hot_store is not None:
+                stored_data = self.hot_store.get(data_id)
+                if stored_data is not None:
+                    self._record_access(stored_data)
+                    return stored_data
+
             data_info = self._find_data_by_id(data_id)
             if not data_info:
                 self.logger.warning(f"⚠️ 找不到數據: {data_id}")
                 return None
 
-            # 構建文件路徑
-            data_path = data_info['file_path']
-
-            # 讀取數據
-            if data_path.suffix == '.gz':
-                with gzip.open(data_path, 'rt', encoding='utf-8') as f:
-                    stored_data = json.load(f)
-            else:
-                with open(data_path, 'r', encoding='utf-8') as f:
-                    stored_data = json.load(f)
+            # 讀取數據 (溫層 JSON 或冷層欄式檔案)
+            stored_data = self._read_data_file(data_info['file_path'])
+            self._record_access(stored_data)
 
             self.logger.info(f"✅ 數據已檢索: {data_id}")
             return stored_data
@@ -312,12 +322,14 @@ class StorageManager:
         stats = {'files_deleted': 0, 'space_freed_mb': 0}
 
         try:
-            for file_path in directory.rglob("*.json*"):
+            for file_path in self._iter_data_files(directory, recursive=True):
                 if file_path.is_file():
                     file_mtime = file_path.stat().st_mtime
                     if file_mtime < cutoff_timestamp:
                         file_size = file_path.stat().st_size
                         file_path.unlink()
+                        if self.hot_store is not None:
+                            self.hot_store.discard(self._data_id_from_path(file_path))
                         stats['files_deleted'] += 1
                         stats['space_freed_mb'] += file_size / (1024 * 1024)
         except Exception as e:
@@ -333,7 +345,7 @@ class StorageManager:
             total_files = 0
 
             for storage_path in [self.primary_storage_path, self.backup_storage_path]:
-                for file_path in storage_path.rglob("*.json*"):
+                for file_path in self._iter_data_files(storage_path, recursive=True):
                     if file_path.is_file():
                         total_size += file_path.stat().st_size
                         total_files += 1
@@ -349,6 +361,7 @@ class StorageManager:
 
             # 合併歷史統計
             current_stats.update(self.storage_stats)
+            current_stats['tiering'] = self.get_tiering_statistics()
 
             return current_stats
 
@@ -365,10 +378,10 @@ class StorageManager:
 
             for dir_path in search_dirs:
                 if dir_path.is_dir() and dir_path.name != 'metadata':
-                    for file_path in dir_path.glob("*.json*"):
+                    for file_path in self._iter_data_files(dir_path):
                         if file_path.is_file():
                             # 讀取元數據
-                            data_id = file_path.stem.replace('.json', '')
+                            data_id = self._data_id_from_path(file_path)
                             metadata_path = self.primary_storage_path / 'metadata' / f"{data_id}_metadata.json"
 
                             metadata = {}
@@ -389,4 +402,301 @@ class StorageManager:
 
         except Exception as e:
             self.logger.error(f"❌ 列出存儲數據失敗: {e}")
-            return []
\ No newline at end of file
+            return []
+
+    # === 分層存儲 ===
+
+    def _init_tiering(self) -> None:
+        """
+        初始化分層規劃器與熱層記憶體存儲
+
+        背景遷移需以 tiering.background_migration 明確開啟 (長駐服務使用)；
+        開啟後由擁有者呼叫 close() 停止，或於管理器被回收後自行結束。
+        """
+        self.tiering_config = {
+            'enabled': True,
+            'background_migration': False,
+            'migration_interval_seconds': 600,
+            'prefer_parquet': True,
+            'verify_migrations': True,
+            'access_half_life_seconds': 6 * 3600,
+            **self.config.get('tiering', {})
+        }
+        self._tier_lock = threading.RLock()
+        self._tier_stop = threading.Event()
+        self._tier_thread: Optional[threading.Thread] = None
+        self._item_timestamps: Dict[str, float] = {}
+        self._tier_state_path = self.primary_storage_path / 'metadata' / 'tiering_access_state.json'
+        self.tier_stats = {
+            'migrations': {'to_hot': 0, 'to_warm': 0, 'to_cold': 0},
+            'migration_failures': 0,
+            'bytes_saved': 0,
+            'last_migration': None,
+            'last_plan': {}
+        }
+
+        self.hot_store = None
+        self.tier_planner = None
+        if not (TIERING_AVAILABLE and self.tiering_config['enabled']):
+            return
+
+        tracker = AccessTracker(self.tiering_config['access_half_life_seconds'])
+        if self._tier_state_path.exists():
+            try:
+                with open(self._tier_state_path, 'r', encoding='utf-8') as f:
+                    tracker = AccessTracker.from_dict(json.load(f))
+            except Exception as e:
+                self.logger.warning(f"⚠️ 分層存取紀錄載入失敗，重新開始統計: {e}")
+
+        cost_model = TierCostModel.from_config(self.tiering_config.get('cost_model'))
+        self.tier_planner = StorageTierPlanner(cost_model, tracker)
+        self.hot_store = HotTierStore(cost_model.hot_max_bytes)
+
+        if self.tiering_config['background_migration']:
+            self.start_tier_migration()
+
+    def start_tier_migration(self, interval_seconds: Optional[float] = None) -> None:
+        """啟動背景分層遷移執行緒"""
+        if self.tier_planner is None or (self._tier_thread and self._tier_thread.is_alive()):
+            return
+        interval = interval_seconds or self.tiering_config['migration_interval_seconds']
+        stop = self._tier_stop
+        stop.clear()
+        # 執行緒只持有弱參照，擁有者未呼叫 close() 就被回收時迴圈也會結束
+        owner = weakref.ref(self)
+
+        def _loop():
+            while not stop.wait(interval):
+                manager = owner()
+                if manager is None:
+                    return
+                try:
+                    manager.run_tier_migration()
+                except Exception as e:
+                    manager.logger.error(f"❌ 背景分層遷移失敗: {e}")
+                del manager
+
+        self._tier_thread = threading.Thread(target=_loop, name="stage6-tier-migration", daemon=True)
+        self._tier_thread.start()
+
+    def stop_tier_migration(self, timeout: Optional[float] = None) -> None:
+        """停止背景分層遷移執行緒"""
+        self._tier_stop.set()
+        if self._tier_thread is not None:
+            self._tier_thread.join(timeout)
+            self._tier_thread = None
+
+    def close(self, timeout: Optional[float] = 5.0) -> None:
+        """停止背景遷移並保存存取頻率統計"""
+        self.stop_tier_migration(timeout)
+        if self.tier_planner is not None:
+            self._save_tier_state()
+
+    def plan_storage_tiers(self, now: Optional[float] = None) -> List['TierPlacement']:
+        """依存取頻率與時間窗口規劃各數據的存儲層級"""
+        if self.tier_planner is None:
+            return []
+        now = now if now is not None else time.time()
+        placements = self.tier_planner.plan(self._scan_tier_segments(), now)
+        self.tier_stats['last_plan'] = placement_summary(placements)
+        return placements
+
+    def run_tier_migration(self, now: Optional[float] = None) -> Dict[str, Any]:
+        """執行一輪分層規劃與遷移 (熱層載入記憶體，冷熱之間轉換檔案格式)"""
+        result = {'planned': 0, 'migrated': 0, 'failed': 0}
+        if self.tier_planner is None:
+            return result
+
+        now = now if now is not None else time.time()
+        placements = self.plan_storage_tiers(now)
+        result['planned'] = len(placements)
+
+        for placement in placements:
+            for data_id in placement.item_ids:
+                try:
+                    if self._migrate_item(data_id, placement.target_tier):
+                        result['migrated'] += 1
+                except Exception as e:
+                    result['failed'] += 1
+                    self.tier_stats['migration_failures'] += 1
+                    self.logger.error(f"❌ 分層遷移失敗 {data_id} -> {placement.target_tier}: {e}")
+
+        self.tier_planner.tracker.prune(now)
+        self._save_tier_state()
+        self.tier_stats['last_migration'] = datetime.now(timezone.utc).isoformat()
+        if result['migrated'] or result['failed']:
+            self.logger.info(f"🧊 分層遷移完成: 遷移 {result['migrated']} 項，失敗 {result['failed']} 項")
+        return result
+
+    def get_tiering_statistics(self) -> Dict[str, Any]:
+        """獲取分層存儲統計信息"""
+        if self.tier_planner is None:
+            return {'enabled': False}
+        return {
+            'enabled': True,
+            'hot_store': self.hot_store.get_stats(),
+            'cold_size_ratio': round(self.tier_planner.cost_model.cold_size_ratio, 4),
+            'background_migration': bool(self._tier_thread and self._tier_thread.is_alive()),
+            **self.tier_stats
+        }
+
+    def _scan_tier_segments(self) -> List['TierSegment']:
+        """掃描主存儲，依 (數據類型, 時間窗口) 彙總為分層區段"""
+        segments: Dict[tuple, TierSegment] = {}
+        tiers: Dict[tuple, set] = {}
+
+        for type_dir in self.primary_storage_path.iterdir():
+            if not type_dir.is_dir() or type_dir.name == 'metadata':
+                continue
+            for file_path in self._iter_data_files(type_dir):
+                data_id = self._data_id_from_path(file_path)
+                metadata = self._read_storage_metadata(data_id)
+                timestamp = self._item_timestamp(data_id, metadata, file_path)
+                bucket = self.tier_planner.bucket_of(timestamp)
+                tier = ('hot' if data_id in self.hot_store
+                        else 'cold' if is_cold_file(file_path) else 'warm')
+
+                key = (type_dir.name, bucket)
+                segment = segments.setdefault(key, TierSegment(dataset=type_dir.name, bucket_start=bucket))
+                segment.size_bytes += metadata.get('size_bytes') or file_path.stat().st_size
+                segment.item_ids.append(data_id)
+                tiers.setdefault(key, set()).add(tier)
+
+        for key, segment in segments.items():
+            segment.tier = tiers[key].pop() if len(tiers[key]) == 1 else 'mixed'
+        return list(segments.values())
+
+    def _migrate_item(self, data_id: str, target_tier: str) -> bool:
+        """將單一數據移至目標層級；返回是否有實際遷移"""
+        with self._tier_lock:
+            data_info = self._find_data_by_id(data_id)
+            if not data_info:
+                self.hot_store.discard(data_id)
+                return False
+            path = data_info['file_path']
+
+            if target_tier == 'hot':
+                if data_id in self.hot_store:
+                    return False
+                if not self.hot_store.put(data_id, self._read_data_file(path)):
+                    return False
+                self.tier_stats['migrations']['to_hot'] += 1
+                return True
+
+            was_hot = data_id in self.hot_store
+            self.hot_store.discard(data_id)
+            cold = is_cold_file(path)
+            if (target_tier == 'cold') == cold:
+                return was_hot
+
+            stored_data = self._read_data_file(path)
+            stem = path.parent / data_id
+            stat = path.stat()
+            if target_tier == 'cold':
+                new_path = write_columnar(stem, stored_data, self.tiering_config['prefer_parquet'])
+            else:
+                new_path = self._write_warm_file(stem, stored_data)
+
+            if self.tiering_config['verify_migrations'] and self._read_data_file(new_path) != stored_data:
+                new_path.unlink()
+                raise ValueError("遷移後讀回內容不一致")
+
+            # 保留原修改時間，保留期清理與排序不受遷移影響
+            os.utime(new_path, (stat.st_atime, stat.st_mtime))
+            new_size = new_path.stat().st_size
+            path.unlink()
+
+            if target_tier == 'cold':
+                self.tier_planner.cost_model.observe_compression(
+                    self._read_storage_metadata(data_id).get('size_bytes') or stat.st_size, new_size)
+            self.tier_stats['bytes_saved'] += stat.st_size - new_size
+            self.tier_stats['migrations'][f'to_{target_tier}'] += 1
+            return True
+
+    def _write_warm_file(self, stem: Path, stored_data: Dict[str, Any]) -> Path:
+        """以主存儲格式寫回溫層 JSON 檔案"""
+        if self.storage_config['compression_enabled']:
+            path = stem.with_name(stem.name + '.json.gz')
+            with gzip.open(path, 'wt', encoding='utf-8') as f:
+                json.dump(stored_data, f, indent=2, ensure_ascii=False, default=str)
+        else:
+            path = stem.with_name(stem.name + '.json')
+            with open(path, 'w', encoding='utf-8') as f:
+                json.dump(stored_data, f, indent=2, ensure_ascii=False, default=str)
+        return path
+
+    def _read_data_file(self, data_path: Path) -> Dict[str, Any]:
+        """讀取溫層 JSON 或冷層欄式數據檔案"""
+        if TIERING_AVAILABLE and is_cold_file(data_path):
+            return read_columnar(data_path)
+        if data_path.suffix == '.gz':
+            with gzip.open(data_path, 'rt', encoding='utf-8') as f:
+                return json.load(f)
+        with open(data_path, 'r', encoding='utf-8') as f:
+            return json.load(f)
+
+    def _record_access(self, stored_data: Dict[str, Any]) -> None:
+        """記錄一次存取到 (數據類型, 時間窗口) 的頻率統計"""
+        if self.tier_planner is None or not isinstance(stored_data, dict):
+            return
+        data_id = stored_data.get('data_id')
+        timestamp = self._item_timestamps.get(data_id)
+        if timestamp is None:
+            timestamp = self._parse_timestamp(stored_data.get('timestamp')) or time.time()
+            self._item_timestamps[data_id] = timestamp
+        self.tier_planner.record_access(stored_data.get('data_type', 'unknown'), timestamp, time.time())
+
+    def _item_timestamp(self, data_id: str, metadata: Dict[str, Any], file_path: Path) -> float:
+        timestamp = self._item_timestamps.get(data_id)
+        if timestamp is None:
+            timestamp = self._parse_timestamp(metadata.get('timestamp')) or file_path.stat().st_mtime
+            self._item_timestamps[data_id] = timestamp
+        return timestamp
+
+    def _read_storage_metadata(self, data_id: str) -> Dict[str, Any]:
+        metadata_path = self.primary_storage_path / 'metadata' / f"{data_id}_metadata.json"
+        if not metadata_path.exists():
+            return {}
+        try:
+            with open(metadata_path, 'r', encoding='utf-8') as f:
+                return json.load(f)
+        except Exception:
+            return {}
+
+    def _save_tier_state(self) -> None:
+        """保存存取頻率統計，重啟後延續分層決策"""
+        try:
+            tmp_path = self._tier_state_path.with_suffix('.tmp')
+            with open(tmp_path, 'w', encoding='utf-8') as f:
+                json.dump(self.tier_planner.tracker.to_dict(), f)
+            os.replace(tmp_path, self._tier_state_path)
+        except Exception as e:
+            self.logger.warning(f"⚠️ 分層存取紀錄保存失敗: {e}")
+
+    @staticmethod
+    def _parse_timestamp(value: Any) -> Optional[float]:
+        if not value:
+            return None
+        try:
+            parsed = datetime.fromisoformat(str(value).replace('Z', '+00:00'))
+        except ValueError:
+            return None
+        if parsed.tzinfo is None:
+            parsed = parsed.replace(tzinfo=timezone.utc)
+        return parsed.timestamp()
+
+    @staticmethod
+    def _iter_data_files(directory: Path, recursive: bool = False):
+        """列出目錄中的數據檔案 (溫層 JSON 與冷層欄式檔案)"""
+        files = directory.rglob('*') if recursive else directory.glob('*')
+        for file_path in files:
+            if file_path.name.endswith(_DATA_SUFFIXES):
+                yield file_path
+
+    @staticmethod
+    def _data_id_from_path(file_path: Path) -> str:
+        name = file_path.name
+        for suffix in _DATA_SUFFIXES:
+            if name.endswith(suffix):
+                return name[:-len(suffix)]
+        return file_path.stem
@@ -0,0 +1,97 @@
+"""
+平行回火衛星池退火器測試 (打包可見性成本、副本交換、多進程一致性)
+"""
+
+import importlib.util
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 直接載入模組，避免 shared.core_modules 套件初始化時載入 SGP4/Skyfield 引擎
+_MODULE_PATH = (Path(__file__).parent.parent.parent.parent / "src" / "shared" / "core_modules"
+                / "parallel_tempering_annealer.py")
+_spec = importlib.util.spec_from_file_location("parallel_tempering_annealer", _MODULE_PATH)
+annealer = importlib.util.module_from_spec(_spec)
+sys.modules[_spec.name] = annealer  # 工作進程以模組名稱反序列化任務函數
+_spec.loader.exec_module(annealer)
+
+AnnealingGroup = annealer.AnnealingGroup
+PackedVisibilityProblem = annealer.PackedVisibilityProblem
+ParallelTemperingAnnealer = annealer.ParallelTemperingAnnealer
+
+N_TIMES = 96
+
+
+def _pass_matrix(rng, count, duration):
+    """每顆衛星在隨機起點有一段連續可見窗口"""
+    visibility = np.zeros((count, N_TIMES), dtype=bool)
+    for i, start in enumerate(rng.integers(0, N_TIMES, size=count)):
+        visibility[i, start:start + duration] = True
+        visibility[i, :max(0, start + duration - N_TIMES)] = True
+    return visibility
+
+
+def _problem(seed=0):
+    rng = np.random.default_rng(seed)
+    visibility = np.vstack([_pass_matrix(rng, 200, 16), _pass_matrix(rng, 60, 20)])
+    group_ids = np.r_[np.zeros(200, dtype=int), np.ones(60, dtype=int)]
+    groups = [AnnealingGroup("starlink", 40, (5, 8)), AnnealingGroup("oneweb", 12, (2, 3))]
+    return visibility, group_ids, groups, rng.random(len(group_ids))
+
+
+@pytest.mark.unit
+class TestParallelTemperingAnnealer:
+
+    def test_incremental_cost_matches_full_evaluation(self):
+        visibility, group_ids, groups, costs = _problem()
+        problem = PackedVisibilityProblem(visibility, group_ids, groups, costs)
+        chain = annealer._Chain(problem, problem.initial_selection(np.random.default_rng(1)))
+        chain.run(temperature=0.05, steps=500, rng=np.random.default_rng(2))
+
+        assert chain.cost == pytest.approx(sum(problem.evaluate(chain.selected)))
+        for g, counts in enumerate(chain.counts):
+            np.testing.assert_array_equal(counts, visibility[chain.selected[g]].sum(axis=0))
+
+    def test_pool_sizes_are_preserved(self):
+        visibility, group_ids, groups, costs = _problem()
+        result = ParallelTemperingAnnealer({'num_replicas': 3, 'max_workers': 1, 'rounds': 5,
+                                            'steps_per_round': 200, 'seed': 7}).optimize(
+            visibility, group_ids, groups, costs)
+
+        selected = np.array(result.selected_indices)
+        assert len(set(result.selected_indices)) == 52
+        assert (group_ids[selected] == 0).sum() == 40 and (group_ids[selected] == 1).sum() == 12
+        assert result.cost == pytest.approx(result.visibility_penalty + result.quality_cost)
+
+    def test_replicas_improve_on_random_pools(self):
+        visibility, group_ids, groups, costs = _problem()
+        problem = PackedVisibilityProblem(visibility, group_ids, groups, costs)
+        rng = np.random.default_rng(11)
+        random_costs = [sum(problem.evaluate(problem.initial_selection(rng))) for _ in range(20)]
+
+        result = ParallelTemperingAnnealer({'num_replicas': 4, 'max_workers': 1, 'rounds': 15,
+                                            'steps_per_round': 500, 'seed': 3}).optimize(
+            visibility, group_ids, groups, costs)
+
+        assert result.cost < min(random_costs)
+        assert result.statistics['swaps_attempted'] > 0
+        assert result.group_compliance['starlink'] > 0.9
+
+    def test_worker_processes_match_in_process_run(self):
+        visibility, group_ids, groups, costs = _problem()
+        config = {'num_replicas': 2, 'rounds': 3, 'steps_per_round': 200, 'seed': 5}
+        local = ParallelTemperingAnnealer({**config, 'max_workers': 1}).optimize(
+            visibility, group_ids, groups, costs)
+        pooled = ParallelTemperingAnnealer({**config, 'max_workers': 2}).optimize(
+            visibility, group_ids, groups, costs)
+
+        assert pooled.selected_indices == local.selected_indices
+        assert pooled.cost == pytest.approx(local.cost)
+
+    def test_rejects_undersized_constellation(self):
+        visibility, group_ids, _, _ = _problem()
+        with pytest.raises(ValueError):
+            PackedVisibilityProblem(visibility, group_ids, [AnnealingGroup("starlink", 10, (1, 2)),
+                                                            AnnealingGroup("oneweb", 61, (1, 2))])
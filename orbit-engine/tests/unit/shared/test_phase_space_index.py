@@ -0,0 +1,174 @@
+"""
+相位空間索引 (RAAN, 緯度幅角) 環面網格測試
+"""
+
+import importlib.util
+import math
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 直接載入模組，避免 shared.core_modules 套件初始化時載入 SGP4/Skyfield 引擎
+_MODULE_PATH = Path(__file__).parent.parent.parent.parent / "src" / "shared" / "core_modules" / "phase_space_index.py"
+_spec = importlib.util.spec_from_file_location("phase_space_index", _MODULE_PATH)
+phase_space_index = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(phase_space_index)
+
+PhaseSpaceIndex = phase_space_index.PhaseSpaceIndex
+circular_diversity = phase_space_index.circular_diversity
+
+
+def _walker_elements(planes: int, per_plane: int, mean_motion: float = 15.05,
+                     inclination: float = 53.0):
+    """Walker-Delta 星座軌道元素"""
+    elements = []
+    for p in range(planes):
+        for s in range(per_plane):
+            elements.append({
+                'satellite_id': f"sat_{p:02d}_{s:02d}",
+                'raan': p * 360.0 / planes,
+                'mean_anomaly': s * 360.0 / per_plane,
+                'argument_of_perigee': 0.0,
+                'mean_motion': mean_motion,
+                'inclination': inclination,
+            })
+    return elements
+
+
+@pytest.mark.unit
+class TestPhaseSpaceIndex:
+
+    def test_counts_match_satellites(self):
+        index = PhaseSpaceIndex.from_orbital_elements(_walker_elements(6, 10))
+        assert len(index) == 60
+        assert index.counts.sum() == 60
+
+    def test_circular_diversity_matches_loop_formula(self):
+        rng = np.random.default_rng(7)
+        angles = rng.uniform(0, 360, 200)
+        sum_x = sum(math.cos(math.radians(a)) for a in angles)
+        sum_y = sum(math.sin(math.radians(a)) for a in angles)
+        expected = 1.0 - math.hypot(sum_x, sum_y) / len(angles)
+        assert circular_diversity(angles) == pytest.approx(expected)
+        assert circular_diversity([10.0]) == 0.0
+
+    def test_uniform_constellation_has_high_diversity(self):
+        uniform = PhaseSpaceIndex.from_orbital_elements(_walker_elements(12, 12))
+        clustered = PhaseSpaceIndex.from_orbital_elements([
+            {'satellite_id': str(i), 'raan': 10.0 + i * 0.1, 'mean_anomaly': 20.0}
+            for i in range(50)
+        ])
+        assert uniform.diversity_scores()['combined'] > 0.95
+        assert clustered.diversity_scores()['combined'] < 0.05
+
+    def test_axis_gaps_wrap_around(self):
+        index = PhaseSpaceIndex(raan_bins=36, phase_bins=36)
+        index.add_satellites(['a', 'b'], [0.0, 0.0], [5.0, 95.0])
+        gaps = index.axis_gaps('phase')
+        # 非空箱 0 與 9，最大空洞為 100°~360° (跨越 0° 前的 26 箱)
+        assert gaps[0]['width_deg'] == pytest.approx(260.0)
+        assert gaps[0]['start_deg'] == pytest.approx(100.0)
+        assert gaps[1]['width_deg'] == pytest.approx(80.0)
+
+    def test_best_fill_picks_candidate_nearest_hole(self):
+        selected = PhaseSpaceIndex(raan_bins=12, phase_bins=12)
+        selected.add_satellites(['s1', 's2'], [0.0, 0.0], [0.0, 10.0])
+        candidates = PhaseSpaceIndex(raan_bins=12, phase_bins=12)
+        candidates.add_satellites(['near', 'far', 'mid'], [180.0, 30.0, 150.0], [180.0, 30.0, 160.0])
+
+        hole = selected.largest_holes(top_k=1)[0]
+        assert hole['clearance_cells'] >= 5
+        assert selected.best_fill(candidates, 180.0, 180.0) == 'near'
+        assert selected.coverage_gain(180.0, 180.0)
+        assert not selected.coverage_gain(1.0, 1.0)
+
+    def test_advance_matches_rebuild(self):
+        elements = _walker_elements(8, 15)
+        moving = PhaseSpaceIndex.from_orbital_elements(elements)
+        for _ in range(20):
+            moving.advance(30.0)
+
+        # 以相同推進量重新建立索引應得到相同網格
+        rebuilt = PhaseSpaceIndex.from_orbital_elements(elements)
+        rebuilt.arg_latitude = np.mod(rebuilt.arg_latitude + rebuilt.phase_rate * 600.0, 360.0)
+        rebuilt.raan = np.mod(rebuilt.raan + rebuilt.raan_rate * 600.0, 360.0)
+        expected_cells = rebuilt._cell_of(rebuilt.raan, rebuilt.arg_latitude)
+        expected_counts = np.bincount(expected_cells, minlength=moving.counts.size)
+
+        np.testing.assert_array_equal(moving.counts.reshape(-1), expected_counts)
+        assert moving.counts.sum() == len(elements)
+
+    def test_j2_raan_regression_for_prograde_orbit(self):
+        index = PhaseSpaceIndex.from_orbital_elements(_walker_elements(1, 1, inclination=53.0))
+        # Starlink 53° 殼層約 -4.5 °/日 的節點進動
+        drift_per_day = index.raan_rate[0] * 86400.0
+        assert -5.5 < drift_per_day < -3.5
+
+    def test_remove_satellites_updates_grid(self):
+        index = PhaseSpaceIndex.from_orbital_elements(_walker_elements(2, 4))
+        removed = index.remove_satellites(['sat_00_00', 'sat_01_03', 'missing'])
+        assert removed == 2
+        assert len(index) == 6
+        assert index.counts.sum() == 6
+
+    def test_incremental_updates_match_fresh_index(self):
+        rng = np.random.default_rng(11)
+        elements = _walker_elements(6, 12)
+        index = PhaseSpaceIndex.from_orbital_elements(elements)
+        live = {e['satellite_id']: e for e in elements}
+
+        for step in range(30):
+            drop = rng.choice(sorted(live), size=3, replace=False).tolist()
+            index.remove_satellites(drop)
+            for sat_id in drop:
+                del live[sat_id]
+            added = [{'satellite_id': f"new_{step}_{k}", 'raan': float(rng.uniform(0, 360)),
+                      'mean_anomaly': float(rng.uniform(0, 360)), 'mean_motion': 15.05,
+                      'inclination': 53.0} for k in range(2)]
+            index.add_satellites([e['satellite_id'] for e in added], [e['raan'] for e in added],
+                                 [e['mean_anomaly'] for e in added])
+            live.update({e['satellite_id']: e for e in added})
+
+        fresh = PhaseSpaceIndex.from_orbital_elements(list(live.values()))
+        np.testing.assert_array_equal(index.counts, fresh.counts)
+        assert sorted(index.satellite_ids) == sorted(live)
+        for sat_id in live:
+            pos = index._position[sat_id]
+            assert index.satellite_ids[pos] == sat_id
+            assert sat_id in index._members[int(index.cells[pos])]
+
+        # best_fill 只掃描格內成員，結果應與逐顆比較一致
+        selected = PhaseSpaceIndex()
+        for raan, phase in [(5.0, 5.0), (123.0, 250.0), (300.0, 77.0)]:
+            best = selected.best_fill(index, raan, phase)
+            target = selected._cell_of(np.array([raan]), np.array([phase]))[0]
+            tr, tp = divmod(int(target), selected.phase_bins)
+            r, p = np.divmod(index.cells, selected.phase_bins)
+            dr = np.minimum(np.abs(r - tr), selected.raan_bins - np.abs(r - tr))
+            dp = np.minimum(np.abs(p - tp), selected.phase_bins - np.abs(p - tp))
+            cell_distance = dr ** 2 + dp ** 2
+            nearest = np.flatnonzero(index.cells == index.cells[np.argmin(cell_distance)])
+            d_raan = np.abs(index.raan[nearest] - raan)
+            d_raan = np.minimum(d_raan, 360.0 - d_raan)
+            d_phase = np.abs(index.arg_latitude[nearest] - phase)
+            d_phase = np.minimum(d_phase, 360.0 - d_phase)
+            assert best == index.satellite_ids[nearest[np.argmin(d_raan ** 2 + d_phase ** 2)]]
+
+    def test_add_orbital_elements_keeps_motion(self):
+        elements = _walker_elements(4, 6)
+        index = PhaseSpaceIndex.from_orbital_elements(elements[:-3])
+        # 以半長軸代替平均運動的衛星同樣推算出相位速率
+        added = [dict(elements[-3])] + elements[-2:]
+        added[0]['mean_motion'] = None
+        added[0]['semi_major_axis'] = 6921.0
+        index.add_orbital_elements(added)
+        fresh = PhaseSpaceIndex.from_orbital_elements(elements[:-3] + added)
+
+        for _ in range(10):
+            index.advance(60.0)
+            fresh.advance(60.0)
+        np.testing.assert_array_equal(index.counts, fresh.counts)
+        pos = index._position[added[0]['satellite_id']]
+        assert index.phase_rate[pos] > 0
+        assert index.raan_rate[pos] < 0
@@ -0,0 +1,109 @@
+"""
+大型衛星響應編碼層測試 (內容協商、陣列化結果編碼、ETag 緩存)
+"""
+
+import asyncio
+import importlib.util
+import json
+from datetime import datetime, timezone
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 直接載入模組，避免 shared 套件初始化時載入 psutil 等依賴
+_MODULE_PATH = Path(__file__).parent.parent.parent.parent / "src" / "shared" / "utils" / "response_encoding.py"
+_spec = importlib.util.spec_from_file_location("response_encoding", _MODULE_PATH)
+response_encoding = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(response_encoding)
+
+ColumnarPayload = response_encoding.ColumnarPayload
+EncodedResponseCache = response_encoding.EncodedResponseCache
+ResponseEncoder = response_encoding.ResponseEncoder
+encode_payload = response_encoding.encode_payload
+negotiate_format = response_encoding.negotiate_format
+
+
+def _columnar(orient="records"):
+    return ColumnarPayload(
+        columns={
+            "satellite_id": ["s1", "s2", "s3"],
+            "timestamp": [datetime(2025, 1, 1, tzinfo=timezone.utc)] * 3,
+            "elevation": np.array([10.0, np.nan, 30.0]),
+        },
+        metadata={"job_id": "job-1"},
+        records_key="results",
+        orient=orient
+    )
+
+
+@pytest.mark.unit
+class TestResponseEncoding:
+
+    def test_negotiation(self):
+        assert negotiate_format(None) == "json"
+        assert negotiate_format("text/html,*/*;q=0.8") == "json"
+        assert negotiate_format("image/png") is None
+        if response_encoding.MSGPACK_AVAILABLE:
+            assert negotiate_format("application/json;q=0.5, application/x-msgpack") == "msgpack"
+        else:
+            assert negotiate_format("application/msgpack, application/json;q=0.1") == "json"
+
+    def test_columnar_json_records_and_columns(self):
+        records = json.loads(encode_payload(_columnar()))
+        assert records["job_id"] == "job-1"
+        assert [row["satellite_id"] for row in records["results"]] == ["s1", "s2", "s3"]
+        assert records["results"][1]["elevation"] is None
+        assert records["results"][0]["timestamp"].startswith("2025-01-01T00:00:00")
+
+        columns = json.loads(encode_payload(_columnar("columns")))
+        assert columns["results"]["elevation"] == [10.0, None, 30.0]
+
+    def test_stdlib_fallback_matches(self, monkeypatch):
+        payload = {"data": {"pools": [{"n": np.int64(3), "x": np.float32(0.5)}], "count": 1}}
+        fast = json.loads(encode_payload(payload))
+        monkeypatch.setattr(response_encoding, "ORJSON_AVAILABLE", False)
+        assert json.loads(encode_payload(payload)) == fast == {"data": {"pools": [{"n": 3, "x": 0.5}], "count": 1}}
+
+    def test_arrow_table_from_nested_records(self):
+        pa = pytest.importorskip("pyarrow")
+        payload = {"success": True, "data": {"pools": [{"id": "a", "size": 3}, {"id": "b", "size": 5}], "total": 2}}
+        table = pa.ipc.open_stream(encode_payload(payload, "arrow", "data.pools")).read_all()
+        assert table.column("size").to_pylist() == [3, 5]
+        assert json.loads(table.schema.metadata[b"metadata"]) == {"success": True, "data": {"total": 2}}
+
+        with pytest.raises(response_encoding.NotTabularError):
+            encode_payload(payload, "arrow")
+
+    def test_etag_cache_and_not_modified(self):
+        encoder = ResponseEncoder(EncodedResponseCache(max_entries=4))
+        builds = []
+
+        def build():
+            builds.append(1)
+            return _columnar()
+
+        async def scenario():
+            first = await encoder.respond(build, etag_parts=("job-1", "v1"))
+            again = await encoder.respond(build, etag_parts=("job-1", "v1"))
+            revalidated = await encoder.respond(build, if_none_match=f'W/{first.headers["ETag"]}',
+                                                etag_parts=("job-1", "v1"))
+            changed = await encoder.respond(build, etag_parts=("job-1", "v2"))
+            rejected = await encoder.respond(build, accept="image/png")
+            return first, again, revalidated, changed, rejected
+
+        first, again, revalidated, changed, rejected = asyncio.run(scenario())
+        assert first.status_code == 200 and again.body == first.body
+        assert revalidated.status_code == 304 and revalidated.body == b""
+        assert changed.headers["ETag"] != first.headers["ETag"]
+        assert rejected.status_code == 406
+        assert len(builds) == 2
+
+    def test_cache_byte_limit_evicts_oldest(self):
+        cache = EncodedResponseCache(max_entries=10, max_bytes=10)
+        cache.put('"a"', b"12345", "application/json")
+        cache.put('"b"', b"12345", "application/json")
+        cache.put('"c"', b"123", "application/json")
+        assert cache.get('"a"') is None and cache.get('"c"') is not None
+        cache.put('"big"', b"x" * 11, "application/json")
+        assert cache.get_stats()["oversized"] == 1
@@ -0,0 +1,111 @@
+"""
+存儲分層規劃測試 (存取頻率、成本規劃、冷層欄式編碼)
+"""
+
+import importlib.util
+from pathlib import Path
+
+import pytest
+
+# 直接載入模組，避免 shared 套件初始化時載入 psutil 等依賴
+_MODULE_PATH = Path(__file__).parent.parent.parent.parent / "src" / "shared" / "utils" / "storage_tiering.py"
+_spec = importlib.util.spec_from_file_location("storage_tiering", _MODULE_PATH)
+storage_tiering = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(storage_tiering)
+
+AccessTracker = storage_tiering.AccessTracker
+StorageTierPlanner = storage_tiering.StorageTierPlanner
+TierCostModel = storage_tiering.TierCostModel
+TierSegment = storage_tiering.TierSegment
+
+HOUR = 3600
+DAY = 24 * HOUR
+NOW = 100 * DAY
+MB = 1024 * 1024
+
+
+def _segment(age_hours, size_mb=1, tier="warm", dataset="animation_data"):
+    return TierSegment(dataset=dataset, bucket_start=NOW - int(age_hours * HOUR) - HOUR,
+                       size_bytes=int(size_mb * MB), tier=tier, item_ids=[f"{dataset}_{age_hours}"])
+
+
+def _targets(placements):
+    return {p.item_ids[0]: p.target_tier for p in placements}
+
+
+@pytest.mark.unit
+class TestStorageTiering:
+
+    def test_access_rate_decays_with_half_life(self):
+        tracker = AccessTracker(half_life_seconds=HOUR)
+        for _ in range(10):
+            tracker.record("pools", 0, now=0)
+        fresh = tracker.rate_per_hour("pools", 0, now=0)
+        assert tracker.rate_per_hour("pools", 0, now=HOUR) == pytest.approx(fresh / 2)
+
+        restored = AccessTracker.from_dict(tracker.to_dict())
+        assert restored.rate_per_hour("pools", 0, now=HOUR) == pytest.approx(fresh / 2)
+
+    def test_recent_windows_hot_and_idle_archive_cold(self):
+        planner = StorageTierPlanner(TierCostModel())
+        placements = planner.plan([_segment(1), _segment(12), _segment(72)], now=NOW)
+        assert _targets(placements) == {
+            "animation_data_1": "hot",      # 近期窗口
+            "animation_data_12": "warm",    # 未滿冷層年齡
+            "animation_data_72": "cold",    # 閒置歸檔
+        }
+
+    def test_frequently_read_archive_is_promoted(self):
+        planner = StorageTierPlanner(TierCostModel())
+        segment = _segment(72, tier="cold")
+        for _ in range(200):
+            planner.tracker.record(segment.dataset, segment.bucket_start, now=NOW)
+        placement = planner.plan([segment], now=NOW)[0]
+        assert placement.target_tier in ("hot", "warm") and placement.needs_migration
+
+    def test_hot_capacity_and_warm_budget(self):
+        model = TierCostModel(hot_max_bytes=int(2.5 * MB), warm_max_bytes=int(1.5 * MB))
+        planner = StorageTierPlanner(model)
+        segments = [_segment(1), _segment(2), _segment(30), _segment(40)]
+        for _ in range(20):
+            planner.tracker.record("animation_data", segments[2].bucket_start, now=NOW)
+            planner.tracker.record("animation_data", segments[3].bucket_start, now=NOW)
+        for _ in range(40):
+            planner.tracker.record("animation_data", segments[3].bucket_start, now=NOW)
+
+        placements = planner.plan(segments, now=NOW)
+        targets = _targets(placements)
+        assert sum(p.size_bytes for p in placements if p.target_tier == "hot") <= model.hot_max_bytes
+        assert sum(p.size_bytes for p in placements if p.target_tier == "warm") <= model.warm_max_bytes
+        # 熱層容量依節省密度分配，超出溫層預算時存取較少的舊窗口先被降級
+        assert targets["animation_data_40"] == "hot"
+        assert sorted([targets["animation_data_1"], targets["animation_data_2"]]) == ["hot", "warm"]
+        assert targets["animation_data_30"] == "cold"
+        assert storage_tiering.placement_summary(placements)["pending_migrations"] >= 1
+
+    @pytest.mark.parametrize("prefer_parquet", [True, False])
+    def test_columnar_round_trip_is_lossless(self, tmp_path, prefer_parquet):
+        if prefer_parquet:
+            pytest.importorskip("pyarrow")
+        data = {
+            "data_id": "animation_data_x",
+            "data": {
+                "frames": [
+                    {"t": i, "el": i * 0.5, "sats": [{"id": "a"}], "opt": None if i % 3 else 1.5,
+                     **({"extra": "y"} if i % 2 else {})}
+                    for i in range(500)
+                ],
+                "summary": {"count": 500},
+            },
+            "metadata": {},
+        }
+        path = storage_tiering.write_columnar(tmp_path / "animation_data_x", data, prefer_parquet)
+        assert storage_tiering.is_cold_file(path)
+        assert storage_tiering.read_columnar(path) == data
+
+    def test_hot_store_returns_independent_copies(self):
+        store = storage_tiering.HotTierStore(max_bytes=64)
+        assert store.put("a", {"data": [1, 2]})
+        store.get("a")["data"].append(3)
+        assert store.get("a") == {"data": [1, 2]}
+        assert not store.put("big", {"data": "x" * 100})
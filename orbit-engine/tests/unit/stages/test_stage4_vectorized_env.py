@@ -0,0 +1,100 @@
+"""
+Stage 4 批次向量化換手環境測試
+"""
+
+import importlib.util
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+# 直接載入模組，避免 stage4 套件初始化時載入完整處理器
+_MODULE_PATH = (Path(__file__).parent.parent.parent.parent / "src" / "stages"
+                / "stage4_optimization" / "vectorized_handover_env.py")
+_spec = importlib.util.spec_from_file_location("stage4_vectorized_env", _MODULE_PATH)
+vectorized_env = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(vectorized_env)
+
+VectorizedHandoverEnv = vectorized_env.VectorizedHandoverEnv
+
+
+def _passes(num_satellites=12, num_times=200, seed=0):
+    """每顆衛星一段拋物線仰角過境"""
+    rng = np.random.default_rng(seed)
+    t = np.arange(num_times)
+    centers = rng.uniform(0, num_times, size=num_satellites)
+    elevation = 70.0 - ((t[None, :] - centers[:, None]) / 12.0) ** 2
+    rsrp = -125.0 + 0.4 * np.clip(elevation, 0, None)
+    return rsrp, elevation
+
+
+@pytest.mark.unit
+class TestVectorizedHandoverEnv:
+
+    def test_observation_and_reward_arrays(self):
+        rsrp, elevation = _passes()
+        env = VectorizedHandoverEnv(rsrp, elevation, num_envs=64, config={'episode_length': 30}, seed=1)
+        obs, _ = env.reset()
+        assert obs.shape == (64, env.observation_size) and obs.dtype == np.float32
+        assert obs.flags['C_CONTIGUOUS']
+
+        obs, rewards, terminated, truncated, info = env.step(np.full(64, env.candidate_slots))
+        assert rewards.shape == (64,) and rewards.dtype == np.float32
+        assert not terminated.any() and not truncated.any()
+        assert not info['handover'].any()
+
+    def test_seeding_is_deterministic(self):
+        rsrp, elevation = _passes()
+        runs = []
+        for _ in range(2):
+            env = VectorizedHandoverEnv(rsrp, elevation, num_envs=32, config={'episode_length': 20})
+            obs, _ = env.reset(seed=7)
+            actions = np.random.default_rng(3)
+            total = np.zeros(32)
+            for _ in range(50):
+                obs, rewards, _, _, _ = env.step(actions.integers(0, env.action_size, size=32))
+                total += rewards
+            runs.append((obs, total))
+        np.testing.assert_array_equal(runs[0][0], runs[1][0])
+        np.testing.assert_array_equal(runs[0][1], runs[1][1])
+
+    def test_auto_reset_reports_final_observation(self):
+        rsrp, elevation = _passes()
+        env = VectorizedHandoverEnv(rsrp, elevation, num_envs=8, config={'episode_length': 5}, seed=2)
+        env.reset()
+        for _ in range(4):
+            _, _, _, truncated, info = env.step(np.zeros(8, dtype=np.int64))
+            assert not truncated.any()
+        obs, _, _, truncated, info = env.step(np.zeros(8, dtype=np.int64))
+
+        assert truncated.all()
+        assert info['final_observation'].shape == (8, env.observation_size)
+        assert (env.steps == 0).all()
+        # 重置後服務衛星為起始時最強的可見衛星
+        assert (obs[:, 2] == 1.0).all()
+        assert env.get_environment_info()['statistics']['episodes_completed'] == 8
+
+    def test_handover_action_switches_serving_and_costs(self):
+        rsrp, elevation = _passes(num_satellites=20)
+        env = VectorizedHandoverEnv(rsrp, elevation, num_envs=16,
+                                    config={'episode_length': 50, 'outage_penalty': 0.0}, seed=4)
+        env.reset()
+        slot = 1
+        expected = env.top_candidates[env.time_index, slot]
+        _, _, _, _, info = env.step(np.full(16, slot))
+        switched = info['handover']
+        assert switched.any()
+        np.testing.assert_array_equal(env.serving[switched], expected[switched])
+
+    def test_from_candidates_uses_position_timeseries(self):
+        candidates = [
+            {'satellite_id': f"sat_{i}",
+             'signal_analysis': {'average_signal_strength': -100.0 - i},
+             'position_timeseries': [{'elevation_deg': 20.0 + i} for _ in range(10)]}
+            for i in range(3)
+        ]
+        env = VectorizedHandoverEnv.from_candidates(candidates, num_envs=4, seed=0)
+        obs, _ = env.reset()
+        assert env.satellite_ids == ["sat_0", "sat_1", "sat_2"]
+        assert (env.top_candidates[:, 0] == 0).all()
+        assert obs[0, 0] == pytest.approx((-100.0 - vectorized_env.RSRP_FLOOR_DBM) / vectorized_env.RSRP_SPAN_DB)
@@ -0,0 +1,148 @@
+"""
+Stage 5 PostgreSQL 背景批次寫入器測試
+"""
+
+import csv
+import importlib.util
+import io
+import threading
+from pathlib import Path
+
+import pytest
+
+# 直接載入模組，避免 stage5 套件初始化時載入完整處理器
+_MODULE_PATH = (Path(__file__).parent.parent.parent.parent / "src" / "stages"
+                / "stage5_data_integration" / "postgresql_batch_writer.py")
+_spec = importlib.util.spec_from_file_location("stage5_batch_writer", _MODULE_PATH)
+batch_writer = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(batch_writer)
+
+PostgreSQLBatchWriter = batch_writer.PostgreSQLBatchWriter
+
+
+class _FakeDatabase:
+    """記錄已提交批次的假數據庫 (外鍵檢查：子表列的 satellite_id 必須已提交)"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.committed = {"satellite_metadata": {}, "signal_statistics": [], "handover_events": []}
+        self.connections = 0
+        self.fail_table = None
+
+    def connect(self):
+        with self.lock:
+            self.connections += 1
+        return _FakeConnection(self)
+
+
+class _FakeCursor:
+
+    def __init__(self, connection):
+        self.connection = connection
+
+    def copy_expert(self, sql, stream):
+        table = sql.split()[1]
+        rows = list(csv.reader(io.StringIO(stream.read())))
+        self.connection.staged.append((table, [row[0] for row in rows]))
+
+    def execute(self, sql, params):
+        width = len(batch_writer.STAGE5_TABLE_SPECS["satellite_metadata"].columns)
+        rows = [params[i:i + width] for i in range(0, len(params), width)]
+        self.connection.staged.append(("satellite_metadata", rows))
+
+    def close(self):
+        pass
+
+
+class _FakeConnection:
+    closed = 0
+
+    def __init__(self, database):
+        self.database = database
+        self.staged = []
+
+    def cursor(self):
+        return _FakeCursor(self)
+
+    def commit(self):
+        db = self.database
+        with db.lock:
+            for table, rows in self.staged:
+                if table == db.fail_table:
+                    self.staged = []
+                    raise RuntimeError("simulated failure")
+                if table == "satellite_metadata":
+                    for row in rows:
+                        db.committed[table][row[0]] = row
+                else:
+                    missing = [sid for sid in rows if sid not in db.committed["satellite_metadata"]]
+                    assert not missing, f"foreign key violation: {missing}"
+                    db.committed[table].extend(rows)
+        self.staged = []
+
+    def rollback(self):
+        self.staged = []
+
+    def close(self):
+        pass
+
+
+def _metadata(sid, rate=0.5):
+    return {"satellite_id": sid, "constellation": "starlink", "visibility_rate": rate}
+
+
+@pytest.mark.unit
+class TestPostgreSQLBatchWriter:
+
+    def test_batches_respect_parent_table_order(self):
+        db = _FakeDatabase()
+        writer = PostgreSQLBatchWriter(db.connect, config={"batch_size": 16, "pool_size": 3}).start()
+        for i in range(200):
+            sid = f"sat_{i}"
+            writer.put("satellite_metadata", _metadata(sid))
+            writer.put("signal_statistics", {"satellite_id": sid, "avg_rsrp_dbm": -95.5})
+            writer.put_many("handover_events", [{"satellite_id": sid, "event_type": "A4"}] * 3)
+
+        result = writer.flush(timeout=10)
+        stats = writer.get_statistics()
+        writer.close()
+
+        assert result == {"success": True, "errors": []}
+        assert len(db.committed["satellite_metadata"]) == 200
+        assert len(db.committed["signal_statistics"]) == 200
+        assert len(db.committed["handover_events"]) == 600
+        assert stats["rows_written"] == stats["rows_enqueued"] == 1000
+        assert stats["batches_written"] <= 13 + 13 + 38 + 3
+        assert db.connections <= 3
+
+    def test_upsert_batch_keeps_last_row_per_key(self):
+        db = _FakeDatabase()
+        writer = PostgreSQLBatchWriter(db.connect, config={"batch_size": 100}).start()
+        writer.put("satellite_metadata", _metadata("sat_1", 0.1))
+        writer.put("satellite_metadata", _metadata("sat_1", 0.9))
+        writer.close()
+        assert db.committed["satellite_metadata"]["sat_1"][6] == 0.9
+
+    def test_flush_reports_failed_batches(self):
+        db = _FakeDatabase()
+        db.fail_table = "handover_events"
+        writer = PostgreSQLBatchWriter(db.connect, config={"batch_size": 8}).start()
+        writer.put("satellite_metadata", _metadata("sat_1"))
+        writer.put_many("handover_events", [("sat_1",) + (None,) * 11] * 5)
+        result = writer.flush(timeout=10)
+        stats = writer.get_statistics()
+        writer.close()
+
+        assert not result["success"] and "handover_events" in result["errors"][0]
+        assert stats["rows_failed"] == 5 and stats["rows_by_table"]["satellite_metadata"] == 1
+        # 錯誤僅報告一次
+        assert writer.flush() == {"success": True, "errors": []}
+
+    def test_copy_encoding_distinguishes_null_and_quotes(self):
+        text = batch_writer.encode_copy_rows([("a,\"b\"", None, 1.5, "", True)])
+        assert text == '"a,""b""",,1.5,"",t\n'
+
+    def test_put_requires_started_writer(self):
+        writer = PostgreSQLBatchWriter(_FakeDatabase().connect)
+        with pytest.raises(RuntimeError):
+            writer.put("satellite_metadata", _metadata("sat_1"))
@@ -0,0 +1,173 @@
+"""
+Stage 6 世代化 API 結果快取測試
+"""
+
+import asyncio
+import importlib.util
+import sys
+import threading
+import types
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+
+import pytest
+
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.append(str(_SRC))
+
+# 直接載入模組，避免 stage6 套件初始化時載入完整處理器
+_MODULE_PATH = _SRC / "stages" / "stage6_dynamic_pool_planning" / "result_cache.py"
+_spec = importlib.util.spec_from_file_location("stage6_result_cache", _MODULE_PATH)
+result_cache = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(result_cache)
+
+# api_service 以相對匯入取得 result_cache：以輕量套件註冊，不執行 stage6 __init__
+_PACKAGE = "stage6_result_cache_pkg"
+_package = types.ModuleType(_PACKAGE)
+_package.__path__ = [str(_MODULE_PATH.parent)]
+sys.modules.setdefault(_PACKAGE, _package)
+sys.modules.setdefault(f"{_PACKAGE}.result_cache", result_cache)
+_api_spec = importlib.util.spec_from_file_location(f"{_PACKAGE}.api_service",
+                                                   _MODULE_PATH.parent / "api_service.py")
+api_service = importlib.util.module_from_spec(_api_spec)
+_api_spec.loader.exec_module(api_service)
+
+Stage6ResultCache = result_cache.Stage6ResultCache
+Stage6Sources = result_cache.Stage6Sources
+
+T0 = datetime(2025, 1, 1, tzinfo=timezone.utc)
+
+
+def _sources():
+    pools = [
+        {'data_id': f'pool_{i}', 'metadata': {'constellation': ('starlink', 'oneweb')[i % 2],
+                                              'quality_grade': 'good' if i < 4 else 'fair'}}
+        for i in range(10)
+    ]
+    frames = [
+        {'timestamp': (T0 + timedelta(seconds=30 * k)).isoformat().replace('+00:00', 'Z'),
+         'satellites': [{'id': f'sat_{j}', 'quality_grade': ('good', 'fair')[j % 2]} for j in range(3)]}
+        for k in range(240)
+    ]
+    events = [
+        {'timestamp': (T0 + timedelta(minutes=10 * k)).isoformat(),
+         'from_satellite': f'sat_{k % 3}', 'to_satellite': f'sat_{(k + 1) % 3}'}
+        for k in range(12)
+    ]
+    return Stage6Sources(pools=pools, animation_frames=frames, handover_events=events)
+
+
+def _envelope(view, data):
+    return {'success': True, 'data': data, 'message': view}
+
+
+@pytest.mark.unit
+class TestStage6ResultCache:
+
+    def test_pool_filters(self):
+        cache = Stage6ResultCache()
+        generation = cache.build(_sources(), _envelope)
+        result = generation.view('satellite_pools', limit=2, offset=0,
+                                 constellation='starlink', quality_grade='good')
+        assert result['total'] == 2
+        assert [item['data_id'] for item in result['pools']] == ['pool_0', 'pool_2']
+
+    def test_animation_time_window_and_grade(self):
+        generation = Stage6ResultCache().build(_sources(), _envelope)
+        window = f"{(T0 + timedelta(minutes=10)).isoformat()},{(T0 + timedelta(minutes=20)).isoformat()}"
+        result = generation.view('animation_data', time_range=window.replace('+00:00', 'Z'))
+        assert result['total_frames'] == 21
+
+        graded = generation.view('animation_data', quality_grade='fair', satellite_ids='sat_1,sat_2')
+        assert graded['total_frames'] == 240
+        assert all(sat['id'] == 'sat_1' for frame in graded['animation_frames'] for sat in frame['satellites'])
+
+    def test_handover_index_matches_linear_filter(self):
+        sources = _sources()
+        generation = Stage6ResultCache().build(sources, _envelope)
+        result = generation.view('handover_events', limit=100, satellite_id='sat_1',
+                                 time_start=(T0 + timedelta(minutes=30)).isoformat(), time_end=None)
+        expected = sorted(
+            (event for event in sources.handover_events
+             if 'sat_1' in (event['from_satellite'], event['to_satellite'])
+             and event['timestamp'] >= (T0 + timedelta(minutes=30)).isoformat()),
+            key=lambda event: event['timestamp'], reverse=True
+        )
+        assert result['events'] == expected
+
+    def test_common_variants_are_precomputed_and_encoded(self):
+        generation = Stage6ResultCache({'time_window_minutes': 60}).build(_sources(), _envelope)
+        # 星座 (全部 + 2) × 等級 (全部 + 2)、動畫 (全部 + 2 個窗口) × 等級 (全部 + 2)、換手 (全部 + 2 個窗口)
+        assert generation.stats['precomputed'] == 9 + 9 + 3
+        if generation.encoded is not None:
+            assert len(generation.encoded) == generation.stats['precomputed']
+
+    def test_publish_replaces_generation(self):
+        cache = Stage6ResultCache()
+        first = cache.build(_sources(), _envelope)
+        cache.publish(first)
+        key = first.normalize('animation_data')
+        second = cache.build(_sources(), _envelope)
+        assert cache.current is first
+        cache.publish(second)
+        assert cache.generation == second.number == first.number + 1
+        assert first.etag_parts('animation_data', key) != second.etag_parts('animation_data', key)
+        cache.invalidate()
+        assert cache.current is None and cache.generation == 0
+
+
+@pytest.mark.unit
+class TestColdResultCache:
+
+    def test_concurrent_cold_requests_share_one_refresh(self):
+        service = api_service.APIService()
+        release = threading.Event()
+        loads = []
+
+        def load_sources():
+            loads.append(threading.current_thread().name)
+            assert release.wait(5)
+            return _sources()
+
+        service._load_result_sources = load_sources
+
+        async def run():
+            requests = [asyncio.create_task(service._get_satellite_pools_data(5, 0, None))
+                        for _ in range(4)]
+            # 重建在執行緒池中進行，事件迴圈仍可排程其他協程
+            for _ in range(20):
+                await asyncio.sleep(0.01)
+                if loads:
+                    break
+            ticks = 0
+            for _ in range(5):
+                await asyncio.sleep(0)
+                ticks += 1
+            release.set()
+            return ticks, await asyncio.gather(*requests)
+
+        ticks, results = asyncio.run(run())
+        assert ticks == 5
+        assert len(loads) == 1 and loads[0] != threading.main_thread().name
+        assert all(result['total'] == 10 for result in results)
+        assert service.result_cache.generation == 1
+
+    def test_failed_refresh_is_retried(self):
+        service = api_service.APIService()
+        attempts = []
+
+        def load_sources():
+            attempts.append(1)
+            if len(attempts) == 1:
+                raise RuntimeError("storage unavailable")
+            return _sources()
+
+        service._load_result_sources = load_sources
+
+        async def run():
+            with pytest.raises(RuntimeError):
+                await service._get_handover_events(10, None, None, None)
+            return await service._get_handover_events(10, None, None, None)
+
+        assert asyncio.run(run())['events']
+        assert len(attempts) == 2
@@ -0,0 +1,77 @@
+"""
+Stage 6 存儲管理器分層行為測試 (熱層副本隔離、背景遷移生命週期)
+"""
+
+import gc
+import importlib.util
+import sys
+import time
+from pathlib import Path
+
+import pytest
+
+_SRC = Path(__file__).parent.parent.parent.parent / "src"
+sys.path.append(str(_SRC))
+
+# 直接載入模組，避免 stage6 套件初始化時載入完整處理器
+_MODULE_PATH = _SRC / "stages" / "stage6_dynamic_pool_planning" / "storage_manager.py"
+_spec = importlib.util.spec_from_file_location("stage6_storage_manager", _MODULE_PATH)
+storage_manager = importlib.util.module_from_spec(_spec)
+_spec.loader.exec_module(storage_manager)
+
+StorageManager = storage_manager.StorageManager
+
+
+def _manager(tmp_path, **tiering):
+    return StorageManager({
+        'primary_storage_path': str(tmp_path / "storage"),
+        'backup_storage_path': str(tmp_path / "backups"),
+        'tiering': tiering,
+    })
+
+
+@pytest.mark.unit
+@pytest.mark.skipif(not storage_manager.TIERING_AVAILABLE, reason="storage_tiering 無法載入")
+class TestStage6StorageManagerTiering:
+
+    def test_hot_hits_are_isolated_from_caller_mutation(self, tmp_path):
+        manager = _manager(tmp_path)
+        data_id = manager.store_data('animation_data', {'frames': [{'t': 0}, {'t': 1}]})
+        manager.run_tier_migration()
+        assert data_id in manager.hot_store
+
+        first = manager.retrieve_data(data_id)
+        first['data']['frames'].append({'t': 99})
+        first['data_id'] = 'corrupted'
+
+        again = manager.retrieve_data(data_id)
+        assert again['data_id'] == data_id
+        assert again['data']['frames'] == [{'t': 0}, {'t': 1}]
+
+        # 降級到冷層時寫出的仍是原始內容
+        manager._migrate_item(data_id, 'cold')
+        assert data_id not in manager.hot_store
+        assert manager.retrieve_data(data_id)['data']['frames'] == [{'t': 0}, {'t': 1}]
+
+    def test_background_migration_is_opt_in(self, tmp_path):
+        manager = _manager(tmp_path)
+        assert manager._tier_thread is None
+        assert manager.get_tiering_statistics()['background_migration'] is False
+
+    def test_close_stops_background_migration(self, tmp_path):
+        manager = _manager(tmp_path, background_migration=True, migration_interval_seconds=0.01)
+        thread = manager._tier_thread
+        assert thread is not None and thread.is_alive()
+        manager.close(timeout=2)
+        assert not thread.is_alive()
+        assert manager._tier_state_path.exists()
+
+    def test_thread_exits_when_owner_is_collected(self, tmp_path):
+        manager = _manager(tmp_path, background_migration=True, migration_interval_seconds=0.01)
+        thread = manager._tier_thread
+        del manager
+        gc.collect()
+        deadline = time.time() + 2
+        while thread.is_alive() and time.time() < deadline:
+            time.sleep(0.01)
+        assert not thread.is_alive()
@@ -187,10 +187,23 @@ async def lifespan(app: FastAPI):
             "Redis unavailable, skipping Starlink/Kuiper TLE synchronization and scheduler"
         )
 
+    # 跟隨 NetStack 共享模擬時鐘 (回放 / 暫停 / 跳轉)
+    try:
+        from app.services.simulation_clock import SimulationClockSync
+
+        app.state.simulation_clock_sync = SimulationClockSync()
+        app.state.simulation_clock_sync.start()
+    except Exception as e:
+        app.state.simulation_clock_sync = None
+        logger.warning(f"Simulation clock sync unavailable, using wall clock: {e}")
+
     logger.info("Application startup complete.")
 
     yield
 
+    if getattr(app.state, "simulation_clock_sync", None) is not None:
+        await app.state.simulation_clock_sync.stop()
+
     # 在應用程式關閉前執行
     try:
         # 停止衛星數據調度器
@@ -37,9 +37,12 @@ class OrbitServiceInterface(ABC):
 
     @abstractmethod
     async def get_current_position(
-        self, satellite_id: int, observer_location: Optional[GeoCoordinate] = None
+        self,
+        satellite_id: int,
+        observer_location: Optional[GeoCoordinate] = None,
+        at_time: Optional[datetime] = None,
     ) -> Dict[str, Any]:
-        """獲取衛星當前位置"""
+        """獲取衛星當前位置 (at_time 指定模擬時刻，預設為牆鐘現在)"""
         pass
 
     @abstractmethod
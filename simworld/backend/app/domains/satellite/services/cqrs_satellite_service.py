@@ -12,7 +12,7 @@ import asyncio
 import json
 import time
 import uuid
-from datetime import datetime, timedelta
+from datetime import datetime, timedelta, timezone
 from typing import Dict, List, Optional, Any, Tuple, Union
 from dataclasses import dataclass
 from enum import Enum
@@ -23,6 +23,29 @@ from app.domains.coordinates.models.coordinate_model import GeoCoordinate
 
 logger = structlog.get_logger(__name__)
 
+# 共享模擬時鐘 (與 NetStack 同一實作)；不可用時退回牆鐘
+try:
+    from app.services.simulation_clock import ReplayWindowPrefetcher, get_simulation_clock
+    SIMULATION_CLOCK_AVAILABLE = True
+except ImportError as e:
+    SIMULATION_CLOCK_AVAILABLE = False
+    logger.warning("共享模擬時鐘不可用，使用牆鐘", error=str(e))
+
+
+class WallClock:
+    """共享模擬時鐘不可用時的牆鐘替代，提供與模擬時鐘相同的讀取介面 (永不處於回放模式)"""
+
+    is_replay = False
+
+    def now(self) -> datetime:
+        return datetime.now(timezone.utc)
+
+    def utcnow(self) -> datetime:
+        return self.now().replace(tzinfo=None)
+
+    def status(self) -> Dict[str, Any]:
+        return {"mode": "wall_clock", "simulation_time": self.now().isoformat(), "rate": 1.0, "paused": False}
+
 
 class SatelliteEventType(Enum):
     """衛星事件類型"""
@@ -169,6 +192,7 @@ class SatellitePositionCache:
 
         self.max_positions = max_positions
         self.ttl_seconds = ttl_seconds
+        self.clock = get_simulation_clock() if SIMULATION_CLOCK_AVAILABLE else WallClock()
         self._lock = asyncio.Lock()
 
         # 快取統計
@@ -185,6 +209,12 @@ class SatellitePositionCache:
             return "global"
         return f"{observer.latitude:.6f},{observer.longitude:.6f},{observer.altitude or 0:.1f}"
 
+    def age_seconds(self, timestamp: datetime) -> float:
+        """位置時間戳與模擬時鐘目前時刻的距離 (秒)；回放跳轉後可能位於「未來」，取絕對值"""
+        if timestamp.tzinfo is None:
+            timestamp = timestamp.replace(tzinfo=timezone.utc)
+        return abs((self.clock.now() - timestamp).total_seconds())
+
     def _timestamp_key(self, timestamp: datetime) -> str:
         """生成時間戳鍵（分鐘級別）"""
         return timestamp.strftime("%Y%m%d%H%M")
@@ -201,18 +231,14 @@ class SatellitePositionCache:
                 if cache_key in self.observer_positions:
                     position = self.observer_positions[cache_key]
                     # 檢查 TTL
-                    if (
-                        datetime.utcnow() - position.timestamp
-                    ).total_seconds() <= self.ttl_seconds:
+                    if self.age_seconds(position.timestamp) <= self.ttl_seconds:
                         self.stats["hits"] += 1
                         return position
             else:
                 if satellite_id in self.current_positions:
                     position = self.current_positions[satellite_id]
                     # 檢查 TTL
-                    if (
-                        datetime.utcnow() - position.timestamp
-                    ).total_seconds() <= self.ttl_seconds:
+                    if self.age_seconds(position.timestamp) <= self.ttl_seconds:
                         self.stats["hits"] += 1
                         return position
 
@@ -351,8 +377,25 @@ class SatelliteCommandService:
         self.orbit_service = orbit_service
         self.event_store = event_store
         self.position_cache = position_cache
+        self.clock = position_cache.clock
         self.logger = logger.bind(service="satellite_command")
 
+        # 回放模式：依模擬時鐘預取已追蹤衛星的軌道傳播時間窗
+        # (即 calculate_orbit_propagation 寫入 batch_positions 的 orbit_* 預計算窗)
+        self.replay_window_seconds = 300
+        self.replay_step_seconds = 10
+        self._tracked_satellites: set = set()
+        self.orbit_prefetcher = (
+            ReplayWindowPrefetcher(
+                "simworld_cqrs_orbit_windows",
+                self._load_orbit_window,
+                self.replay_window_seconds,
+                clock=self.clock,
+            )
+            if SIMULATION_CLOCK_AVAILABLE
+            else None
+        )
+
         # 命令統計
         self.stats = {
             "position_updates": 0,
@@ -379,9 +422,18 @@ class SatelliteCommandService:
                 if cached_position:
                     return cached_position
 
-            # 計算新位置
+            if self.clock.is_replay:
+                position = await self._replay_position(satellite_id, observer)
+                if position is not None:
+                    await self.position_cache.set_current_position(position)
+                    await self._publish_position_event(position)
+                    self.stats["position_updates"] += 1
+                    return position
+
+            # 計算新位置 (回放時計算模擬時鐘時刻的位置)
             position_data = await self.orbit_service.get_current_position(
-                satellite_id, observer
+                satellite_id, observer,
+                at_time=self.clock.now() if self.clock.is_replay else None,
             )
 
             # 創建位置對象
@@ -423,6 +475,38 @@ class SatelliteCommandService:
             )
             raise
 
+    async def _load_orbit_window(self, window_start: datetime) -> Dict[int, List[SatellitePosition]]:
+        """預取器載入函數：對已追蹤衛星計算單一時間窗的軌道傳播"""
+        window_end = window_start + timedelta(seconds=self.replay_window_seconds)
+        window: Dict[int, List[SatellitePosition]] = {}
+        for satellite_id in list(self._tracked_satellites):
+            try:
+                window[satellite_id] = await self.calculate_orbit_propagation(
+                    satellite_id, window_start, window_end, self.replay_step_seconds
+                )
+            except Exception as e:
+                self.logger.warning("預取軌道時間窗失敗", satellite_id=satellite_id, error=str(e))
+        return window
+
+    async def _replay_position(
+        self, satellite_id: int, observer: Optional[GeoCoordinate]
+    ) -> Optional[SatellitePosition]:
+        """
+        回放模式下從預取的軌道時間窗取模擬時刻最近的取樣點
+
+        觀測者相關量 (仰角 / 方位角) 不在傳播結果中，含觀測者的查詢回傳 None 由呼叫端直接計算；
+        新追蹤的衛星在下一個時間窗才會被預取，本窗同樣回傳 None。
+        """
+        if observer is not None or self.orbit_prefetcher is None:
+            return None
+        self._tracked_satellites.add(satellite_id)
+        self.orbit_prefetcher.start()
+        now = self.clock.now()
+        positions = (await self.orbit_prefetcher.get(now)).get(satellite_id)
+        if not positions:
+            return None
+        return min(positions, key=lambda p: self.position_cache.age_seconds(p.timestamp))
+
     async def batch_update_positions(
         self, satellite_ids: List[int], observer: Optional[GeoCoordinate] = None
     ) -> List[SatellitePosition]:
@@ -537,7 +621,7 @@ class SatelliteCommandService:
         """生成批量操作鍵"""
         ids_str = ",".join(map(str, sorted(satellite_ids)))
         observer_str = self.position_cache._observer_hash(observer)
-        timestamp_str = datetime.utcnow().strftime("%Y%m%d%H%M")
+        timestamp_str = self.position_cache.clock.utcnow().strftime("%Y%m%d%H%M")
         return f"batch_{ids_str}_{observer_str}_{timestamp_str}"
 
     async def _publish_position_event(self, position: SatellitePosition):
@@ -546,7 +630,7 @@ class SatelliteCommandService:
             id=f"evt_{uuid.uuid4().hex}",
             event_type=SatelliteEventType.POSITION_UPDATED,
             satellite_id=position.satellite_id,
-            timestamp=datetime.utcnow(),
+            timestamp=self.clock.utcnow(),
             data=position.to_dict(),
         )
 
@@ -558,7 +642,7 @@ class SatelliteCommandService:
             id=f"evt_{uuid.uuid4().hex}",
             event_type=SatelliteEventType.BATCH_POSITIONS_UPDATED,
             satellite_id=0,  # 批量操作
-            timestamp=datetime.utcnow(),
+            timestamp=self.clock.utcnow(),
             data={
                 "satellite_ids": satellite_ids,
                 "success_count": success_count,
@@ -580,7 +664,7 @@ class SatelliteCommandService:
             id=f"evt_{uuid.uuid4().hex}",
             event_type=SatelliteEventType.ORBIT_CALCULATED,
             satellite_id=satellite_id,
-            timestamp=datetime.utcnow(),
+            timestamp=self.clock.utcnow(),
             data={
                 "start_time": start_time.isoformat(),
                 "end_time": end_time.isoformat(),
@@ -720,7 +804,7 @@ class SatelliteQueryService:
         """生成批量查詢鍵"""
         ids_str = ",".join(map(str, sorted(satellite_ids)))
         observer_str = self.position_cache._observer_hash(observer)
-        timestamp_str = datetime.utcnow().strftime("%Y%m%d%H%M")
+        timestamp_str = self.position_cache.clock.utcnow().strftime("%Y%m%d%H%M")
         return f"batch_{ids_str}_{observer_str}_{timestamp_str}"
 
     def _calculate_distance(
@@ -802,6 +886,8 @@ class CQRSSatelliteService:
     async def stop(self):
         """停止 CQRS 服務"""
         self.running = False
+        if self.command_service.orbit_prefetcher is not None:
+            await self.command_service.orbit_prefetcher.stop()
 
         # 停止後台任務
         for task in self.background_tasks:
@@ -913,6 +999,12 @@ class CQRSSatelliteService:
             },
             "background_tasks": len(self.background_tasks),
             "running": self.running,
+            "simulation_clock": self.position_cache.clock.status(),
+            "orbit_prefetcher": (
+                self.command_service.orbit_prefetcher.stats()
+                if self.command_service.orbit_prefetcher is not None
+                else None
+            ),
         }
 
     async def _cache_maintenance_loop(self):
@@ -933,15 +1025,10 @@ class CQRSSatelliteService:
 
     async def _perform_cache_maintenance(self):
         """執行快取維護"""
-        # 清理過期的快取項目
-        current_time = datetime.utcnow()
-
-        # 清理過期的當前位置
+        # 清理過期的快取項目 (以模擬時鐘時刻判斷)
         expired_satellites = []
         for satellite_id, position in self.position_cache.current_positions.items():
-            if (
-                current_time - position.timestamp
-            ).total_seconds() > self.position_cache.ttl_seconds:
+            if self.position_cache.age_seconds(position.timestamp) > self.position_cache.ttl_seconds:
                 expired_satellites.append(satellite_id)
 
         for satellite_id in expired_satellites:
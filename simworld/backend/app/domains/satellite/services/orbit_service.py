@@ -240,9 +240,12 @@ class OrbitService(OrbitServiceInterface):
             return "poor"
 
     async def get_current_position(
-        self, satellite_id: int, observer_location: Optional[GeoCoordinate] = None
+        self,
+        satellite_id: int,
+        observer_location: Optional[GeoCoordinate] = None,
+        at_time: Optional[datetime] = None,
     ) -> Dict[str, Any]:
-        """獲取衛星當前位置"""
+        """獲取衛星當前位置 (at_time 指定模擬時刻，預設為牆鐘現在)"""
         if ts is None:
             raise RuntimeError("Skyfield 時間尺度不可用，無法獲取衛星位置")
 
@@ -261,8 +264,13 @@ class OrbitService(OrbitServiceInterface):
             tle_data.line1, tle_data.line2
         )
 
-        # 當前時間
-        t = ts.now()
+        # 當前時間 (回放時由呼叫端傳入模擬時鐘時刻)
+        if at_time is None:
+            t = ts.now()
+        else:
+            if at_time.tzinfo is None:
+                at_time = at_time.replace(tzinfo=utc)
+            t = ts.from_datetime(at_time)
 
         # 計算衛星位置
         geocentric = sf_satellite.at(t)
@@ -3,13 +3,15 @@
 按照衛星數據架構文檔，SimWorld 應該使用 Docker Volume 本地數據而非直接 API 調用
 """
 
+import bisect
 import json
 import logging
 import math
 import sys
 from pathlib import Path
-from typing import Dict, List, Any, Optional
-from datetime import datetime
+from collections import OrderedDict
+from typing import Dict, List, Any, Optional, Tuple
+from datetime import datetime, timezone
 
 # 導入統一配置系統 (Phase 1 改進)
 # 由於 simworld 容器需要訪問 netstack 配置，添加路徑
@@ -24,6 +26,30 @@ except ImportError:
     CONFIG_AVAILABLE = False
     logger.warning("⚠️ 統一配置系統不可用，使用預設值")
 
+# 共享模擬時鐘 (與 NetStack 同一實作)；不可用時退回牆鐘
+try:
+    from .simulation_clock import ReplayWindowPrefetcher, get_simulation_clock
+    SIMULATION_CLOCK_AVAILABLE = True
+except ImportError as e:
+    SIMULATION_CLOCK_AVAILABLE = False
+    logger.warning(f"⚠️ 共享模擬時鐘不可用，使用牆鐘: {e}")
+
+
+def _position_timestamp(pos: Dict[str, Any]) -> Optional[float]:
+    """預處理位置點的取樣時刻 (Unix 秒)；'time' / 'timestamp' 可為 ISO 字串或秒數"""
+    value = pos.get('time', pos.get('timestamp'))
+    if value is None:
+        return None
+    if isinstance(value, (int, float)):
+        return float(value)
+    try:
+        parsed = datetime.fromisoformat(str(value).replace('Z', '+00:00'))
+    except ValueError:
+        return None
+    if parsed.tzinfo is None:
+        parsed = parsed.replace(tzinfo=timezone.utc)
+    return parsed.timestamp()
+
 
 class LocalVolumeDataService:
     """本地 Docker Volume 數據服務 - 遵循衛星數據架構"""
@@ -39,6 +65,15 @@ class LocalVolumeDataService:
         self.time_interval_seconds = 10
         self.total_time_points = 720
 
+        # 預處理數據解析快取 (依檔案 mtime 失效) 與可見衛星查詢結果快取
+        self._enhanced_data_cache: Optional[Tuple[float, Dict[str, Any]]] = None
+        self._visible_query_cache: "OrderedDict[tuple, List[Dict[str, Any]]]" = OrderedDict()
+        self._visible_query_cache_size = 64
+
+        # 預處理位置的時間索引與回放時間窗預取器 (皆依檔案 mtime 重建)
+        self._position_index: Optional[Tuple[float, Dict[str, Dict[str, Any]]]] = None
+        self._position_prefetcher = None
+
         # 檢查路徑是否存在
         self._check_volume_paths()
 
@@ -262,19 +297,28 @@ class LocalVolumeDataService:
                 logger.warning(f"預處理數據文件不存在: {main_data_file}")
                 return None
             
-            logger.info(f"📊 載入預處理數據: {main_data_file}")
+            mtime = main_data_file.stat().st_mtime
+            target_constellation = constellation.lower() if constellation else 'starlink'
+            data = self._load_enhanced_satellite_data(main_data_file, mtime)
+            
+            # 模擬時鐘目前時刻所在的預處理時間窗 (由預取器在回放游標前方預先載入)
+            window_key, positions_at_time = await self._positions_at_clock_time(
+                data, mtime, target_constellation
+            )
             
-            with open(main_data_file, "r", encoding="utf-8") as f:
-                data = json.load(f)
+            # 同一份預處理檔案、同一時間窗、同一觀測點與門檻的查詢直接回傳先前結果
+            query_key = (mtime, window_key, target_constellation, float(min_elevation_deg), bool(global_view),
+                         round(observer_lat, 4), round(observer_lon, 4))
+            cached = self._visible_query_cache.get(query_key)
+            if cached is not None:
+                self._visible_query_cache.move_to_end(query_key)
+                return [dict(sat) for sat in cached]
             
             # 新的數據格式：data['constellations'][constellation]['orbit_data']['satellites']
             if 'constellations' not in data:
                 logger.warning("預處理數據缺少 constellations 欄位")
                 return None
             
-            # 決定要載入的星座
-            target_constellation = constellation.lower() if constellation else 'starlink'
-            
             if target_constellation not in data['constellations']:
                 logger.warning(f"找不到星座數據: {target_constellation}")
                 return None
@@ -297,29 +341,17 @@ class LocalVolumeDataService:
                 if not positions:
                     continue
                 
-                # 🔥 修復：尋找當前時間最適合的可見位置（而非隨機最後一個位置）
-                current_time = datetime.utcnow()
-                best_pos = None
-                
-                # 優先尋找仰角 >= min_elevation_deg 的位置
-                for pos in positions:
-                    if pos.get('elevation_deg', -90) >= min_elevation_deg:
-                        if not global_view:  # 非全球視野時，嚴格應用仰角門檻
-                            if best_pos is None or pos.get('elevation_deg', -90) > best_pos.get('elevation_deg', -90):
-                                best_pos = pos
-                        else:  # 全球視野時，任何可見位置都可以
-                            best_pos = pos
-                            break
-                
-                # 如果沒有找到可見位置，跳過此衛星（除非是全球視野模式）
-                if best_pos is None:
-                    if global_view:
-                        # 全球視野模式：使用最高仰角位置（即使是負數）
-                        best_pos = max(positions, key=lambda p: p.get('elevation_deg', -90))
-                    else:
-                        continue  # 跳過不可見的衛星
-                
-                latest_pos = best_pos
+                if positions_at_time is not None:
+                    # 模擬時鐘落在預處理時間範圍內：取該時刻的位置
+                    latest_pos = positions_at_time.get(norad_id)
+                    if latest_pos is None:
+                        continue
+                    if not global_view and latest_pos.get('elevation_deg', -90) < min_elevation_deg:
+                        continue
+                else:
+                    latest_pos = self._best_elevation_position(positions, min_elevation_deg, global_view)
+                    if latest_pos is None:
+                        continue
                 
                 # 提取位置信息
                 sat_lat = latest_pos.get('lat', 0)
@@ -392,7 +424,11 @@ class LocalVolumeDataService:
             visible_satellites.sort(key=lambda x: x["elevation_deg"], reverse=True)
             
             logger.info(f"✅ 從預處理數據獲取 {len(visible_satellites)} 顆可見衛星")
-            return visible_satellites
+            
+            self._visible_query_cache[query_key] = visible_satellites
+            while len(self._visible_query_cache) > self._visible_query_cache_size:
+                self._visible_query_cache.popitem(last=False)
+            return [dict(sat) for sat in visible_satellites]
             
         except Exception as e:
             logger.error(f"❌ 從預處理數據獲取可見衛星失敗: {e}")
@@ -400,6 +436,122 @@ class LocalVolumeDataService:
             logger.error(traceback.format_exc())
             return None
 
+    def _load_enhanced_satellite_data(self, data_file: Path, mtime: float) -> Dict[str, Any]:
+        """載入預處理數據，檔案未變更時重用已解析的內容"""
+        if self._enhanced_data_cache is not None and self._enhanced_data_cache[0] == mtime:
+            return self._enhanced_data_cache[1]
+
+        logger.info(f"📊 載入預處理數據: {data_file}")
+        with open(data_file, "r", encoding="utf-8") as f:
+            data = json.load(f)
+
+        self._enhanced_data_cache = (mtime, data)
+        self._visible_query_cache.clear()
+        return data
+
+    @staticmethod
+    def _best_elevation_position(
+        positions: List[Dict[str, Any]], min_elevation_deg: float, global_view: bool
+    ) -> Optional[Dict[str, Any]]:
+        """模擬時刻不在預處理範圍內時的退路：取最佳仰角位置"""
+        best_pos = None
+        # 優先尋找仰角 >= min_elevation_deg 的位置
+        for pos in positions:
+            if pos.get('elevation_deg', -90) >= min_elevation_deg:
+                if not global_view:  # 非全球視野時，嚴格應用仰角門檻
+                    if best_pos is None or pos.get('elevation_deg', -90) > best_pos.get('elevation_deg', -90):
+                        best_pos = pos
+                else:  # 全球視野時，任何可見位置都可以
+                    return pos
+        if best_pos is None and global_view:
+            # 全球視野模式：使用最高仰角位置（即使是負數）
+            best_pos = max(positions, key=lambda p: p.get('elevation_deg', -90))
+        return best_pos
+
+    def _get_position_index(self, data: Dict[str, Any], mtime: float) -> Dict[str, Dict[str, Any]]:
+        """
+        建立 {星座: {start, end, interval, satellites: {norad: (取樣時刻, 位置)}}} 時間索引
+
+        檔案未變更時重用；檔案變更時一併重建回放預取器，讓時間窗對齊新的取樣點。
+        """
+        if self._position_index is not None and self._position_index[0] == mtime:
+            return self._position_index[1]
+
+        index: Dict[str, Dict[str, Any]] = {}
+        for name, constellation_data in data.get('constellations', {}).items():
+            satellites = constellation_data.get('orbit_data', {}).get('satellites', {})
+            entries: Dict[str, Tuple[List[float], List[Dict[str, Any]]]] = {}
+            start, end, interval = math.inf, -math.inf, math.inf
+            for norad_id, sat_data in satellites.items():
+                timed = [(_position_timestamp(pos), pos) for pos in sat_data.get('positions', [])]
+                timed = sorted((item for item in timed if item[0] is not None), key=lambda item: item[0])
+                if not timed:
+                    continue
+                times = [t for t, _ in timed]
+                entries[norad_id] = (times, [pos for _, pos in timed])
+                start, end = min(start, times[0]), max(end, times[-1])
+                steps = [b - a for a, b in zip(times, times[1:]) if b > a]
+                if steps:
+                    interval = min(interval, min(steps))
+            if entries:
+                if not math.isfinite(interval):
+                    interval = float(self.time_interval_seconds)
+                index[name] = {'start': start, 'end': end, 'interval': interval, 'satellites': entries}
+
+        self._position_index = (mtime, index)
+        self._reset_position_prefetcher(index)
+        return index
+
+    def _reset_position_prefetcher(self, index: Dict[str, Dict[str, Any]]):
+        if self._position_prefetcher is not None:
+            self._position_prefetcher.detach()
+            self._position_prefetcher = None
+        if not SIMULATION_CLOCK_AVAILABLE or not index:
+            return
+
+        # 時間窗 = 預處理取樣間隔，起點對齊最早取樣點
+        window_seconds = min(entry['interval'] for entry in index.values())
+        origin = min(entry['start'] for entry in index.values())
+
+        def load_window(window_start: datetime) -> Dict[str, Dict[str, Dict[str, Any]]]:
+            ts = window_start.timestamp()
+            window: Dict[str, Dict[str, Dict[str, Any]]] = {}
+            for name, entry in index.items():
+                if not (entry['start'] <= ts <= entry['end']):
+                    continue
+                tolerance = entry['interval']
+                positions = {}
+                for norad_id, (times, sat_positions) in entry['satellites'].items():
+                    i = bisect.bisect_right(times, ts) - 1
+                    if i >= 0 and ts - times[i] < tolerance:
+                        positions[norad_id] = sat_positions[i]
+                window[name] = positions
+            return window
+
+        self._position_prefetcher = ReplayWindowPrefetcher(
+            "simworld_precomputed_positions", load_window, window_seconds,
+            clock=get_simulation_clock(), window_origin=origin,
+        )
+
+    async def _positions_at_clock_time(
+        self, data: Dict[str, Any], mtime: float, constellation: str
+    ) -> Tuple[Optional[float], Optional[Dict[str, Dict[str, Any]]]]:
+        """
+        回傳 (時間窗鍵, {norad: 位置})；模擬時刻不在該星座預處理範圍內時回傳 (None, None)
+        """
+        if not SIMULATION_CLOCK_AVAILABLE:
+            return None, None
+        entry = self._get_position_index(data, mtime).get(constellation)
+        prefetcher = self._position_prefetcher
+        if entry is None or prefetcher is None:
+            return None, None
+        now = prefetcher.clock.timestamp()
+        if not (entry['start'] <= now <= entry['end']):
+            return None, None
+        prefetcher.start()
+        window = await prefetcher.get(now)
+        return prefetcher.window_key(now), window.get(constellation)
+
     async def check_data_freshness(self) -> Dict[str, Any]:
         """檢查本地數據的新鮮度"""
         try:
@@ -586,10 +738,10 @@ class LocalVolumeDataService:
                 f"📍 參考位置: {reference_location['latitude']:.4f}°N, {reference_location['longitude']:.4f}°E"
             )
 
-            # 當前時間作為起始點
-            from datetime import datetime, timezone, timedelta
+            # 模擬時鐘目前時刻作為起始點
+            from datetime import timedelta
 
-            start_time = datetime.now(timezone.utc)
+            start_time = get_simulation_clock().now() if SIMULATION_CLOCK_AVAILABLE else datetime.now(timezone.utc)
 
             satellites_timeseries = []
 
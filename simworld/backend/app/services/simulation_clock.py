@@ -0,0 +1,117 @@
+"""
+共享模擬時鐘 (SimWorld 端)
+
+SimulationClock / ReplayWindowPrefetcher 的唯一實作位於
+netstack/netstack_api/services/simulation_clock.py，容器內以唯讀方式掛載於
+/app/netstack/netstack_api/services/ (見 docker-compose.yml)。此模組直接載入該檔案，
+並以 SimulationClockSync 輪詢 NetStack 的 /api/v1/simulation-clock/status，
+讓 SimWorld 的「目前時間」跟隨 NetStack 的回放 / 暫停 / 跳轉。
+"""
+
+import asyncio
+import importlib.util
+import logging
+import os
+import sys
+from pathlib import Path
+from typing import Any, Dict, Optional
+
+logger = logging.getLogger(__name__)
+
+_MODULE_NAME = "netstack_simulation_clock"
+_RELATIVE_PATH = Path("netstack_api") / "services" / "simulation_clock.py"
+
+
+def _candidate_paths():
+    override = os.getenv("NETSTACK_SOURCE_DIR")
+    if override:
+        yield Path(override) / _RELATIVE_PATH
+    yield Path("/app/netstack") / _RELATIVE_PATH  # Docker 唯讀掛載
+    # 原始碼樹：simworld/backend/app/services -> 專案根目錄
+    yield Path(__file__).resolve().parents[4] / "netstack" / _RELATIVE_PATH
+
+
+def _load_shared_module():
+    if _MODULE_NAME in sys.modules:
+        return sys.modules[_MODULE_NAME]
+    for path in _candidate_paths():
+        if path.is_file():
+            spec = importlib.util.spec_from_file_location(_MODULE_NAME, path)
+            module = importlib.util.module_from_spec(spec)
+            sys.modules[_MODULE_NAME] = module
+            try:
+                spec.loader.exec_module(module)
+            except Exception:
+                del sys.modules[_MODULE_NAME]
+                raise
+            logger.info(f"共享模擬時鐘載入自 {path}")
+            return module
+    raise ImportError(
+        "找不到 netstack simulation_clock.py，請確認唯讀掛載或設定 NETSTACK_SOURCE_DIR"
+    )
+
+
+_shared = _load_shared_module()
+
+SimulationClock = _shared.SimulationClock
+ReplayWindowPrefetcher = _shared.ReplayWindowPrefetcher
+get_simulation_clock = _shared.get_simulation_clock
+
+
+class SimulationClockSync:
+    """輪詢 NetStack 時鐘狀態並套用至本地共享時鐘"""
+
+    STATUS_PATH = "/api/v1/simulation-clock/status"
+
+    def __init__(self, clock: Optional[SimulationClock] = None,
+                 base_url: Optional[str] = None, poll_interval: float = 1.0,
+                 timeout: float = 2.0):
+        self.clock = clock or get_simulation_clock()
+        self.base_url = (base_url or os.getenv("NETSTACK_API_URL", "http://netstack-api:8080")).rstrip("/")
+        self.poll_interval = poll_interval
+        self.timeout = timeout
+        self._task: Optional[asyncio.Task] = None
+        self._client = None
+        self.failures = 0
+
+    async def sync_once(self) -> Optional[Dict[str, Any]]:
+        """拉取一次遠端狀態；有變更時回傳通知內容"""
+        import httpx
+
+        if self._client is None:
+            self._client = httpx.AsyncClient(timeout=self.timeout)
+        response = await self._client.get(self.base_url + self.STATUS_PATH)
+        response.raise_for_status()
+        return self.clock.follow(response.json())
+
+    async def _run(self):
+        while True:
+            try:
+                await self.sync_once()
+                if self.failures:
+                    logger.info(f"模擬時鐘同步恢復 (先前失敗 {self.failures} 次)")
+                self.failures = 0
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                self.failures += 1
+                if self.failures == 1:
+                    logger.warning(f"模擬時鐘同步失敗，沿用本地時鐘: {e}")
+            await asyncio.sleep(self.poll_interval)
+
+    def start(self):
+        if self._task is None or self._task.done():
+            self._task = asyncio.get_running_loop().create_task(self._run())
+            logger.info(f"模擬時鐘同步已啟動: {self.base_url}{self.STATUS_PATH}")
+
+    async def stop(self):
+        if self._task is not None:
+            self._task.cancel()
+            try:
+                await self._task
+            except asyncio.CancelledError:
+                pass
+            self._task = None
+        if self._client is not None:
+            await self._client.aclose()
+            self._client = None